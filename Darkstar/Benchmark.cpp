@@ -0,0 +1,171 @@
+#include "Benchmark.h"
+
+Benchmark::Benchmark()
+{
+	m_Graphics = 0;
+	m_frameCount = 0;
+	m_heapAllocations = 0;
+	m_allocatingFrames = 0;
+	m_frameBytes = 0;
+	m_frameOverflows = 0;
+}
+
+Benchmark::Benchmark(const Benchmark & other)
+{
+}
+
+Benchmark::~Benchmark()
+{
+}
+
+bool Benchmark::Initialize(const char * sceneFile, int frameCount)
+{
+	int screenWidth, screenHeight;
+	bool result;
+
+	m_sceneName = sceneFile ? sceneFile : "demo";
+	m_frameCount = frameCount;
+
+	screenWidth = BENCHMARK_WIDTH;
+	screenHeight = BENCHMARK_HEIGHT;
+
+	//Create the graphics object
+	m_Graphics = new Graphics;
+	if (!m_Graphics)
+	{
+		return false;
+	}
+
+	//Init the graphics without a window, draws only go to the counting render context
+	result = m_Graphics->Initialize(screenWidth, screenHeight, NULL, true, sceneFile);
+	if (!result)
+	{
+		return false;
+	}
+
+	m_timings.reserve(m_frameCount);
+	m_counters.reserve(m_frameCount);
+
+	return true;
+}
+
+void Benchmark::Shutdown()
+{
+	//Release the graphics object
+	if (m_Graphics)
+	{
+		m_Graphics->Shutdown();
+		delete m_Graphics;
+		m_Graphics = 0;
+	}
+}
+
+void Benchmark::MoveCamera(int frame, float & rotationY)
+{
+	float t;
+
+	//Turn once around while pulling back from the start position and returning to it
+	t = m_frameCount > 1 ? (float)frame / (float)(m_frameCount - 1) : 0.0f;
+
+	rotationY = t * 360.0f;
+	m_Graphics->SetCameraPosition(0.0f, 0.0f, -5.0f - sinf(t * XM_PI) * 10.0f);
+}
+
+bool Benchmark::Run()
+{
+	NullRenderCounters counters;
+	ProfileSummary gpuTimings[GPU_TIMER_MAX_SCOPES];
+	long long heapStart, heapEnd;
+	float rotationY;
+	bool result;
+	int i, j, gpuCount;
+
+	for (i = 0; i < BENCHMARK_WARMUP_FRAMES + m_frameCount; i++)
+	{
+		//Warmup frames stay at the start of the path
+		MoveCamera(i < BENCHMARK_WARMUP_FRAMES ? 0 : i - BENCHMARK_WARMUP_FRAMES, rotationY);
+
+		//Count only what the frame itself allocates, not the results kept below
+		heapStart = HeapCounter::GetAllocations();
+
+		//One simulation step per frame keeps every run the same
+		m_Graphics->Simulate(BENCHMARK_FRAME_TIME);
+
+		result = m_Graphics->Frame(rotationY, 0, 0, 0, 0, BENCHMARK_FRAME_TIME, 1.0f);
+
+		heapEnd = HeapCounter::GetAllocations();
+
+		if (!result)
+		{
+			return false;
+		}
+
+		Profiler::EndFrame();
+		Stats::EndFrame();
+
+		if (i < BENCHMARK_WARMUP_FRAMES)
+		{
+			continue;
+		}
+
+		m_timings.push_back(m_Graphics->GetFrameTimings());
+
+		m_heapAllocations += heapEnd - heapStart;
+		if (heapEnd != heapStart)
+		{
+			m_allocatingFrames++;
+		}
+		m_frameBytes += Stats::Get(STAT_FRAME_BYTES);
+		m_frameOverflows += Stats::Get(STAT_FRAME_OVERFLOWS);
+
+		m_Graphics->GetSubmissionCounters(counters);
+		m_counters.push_back(counters);
+
+		gpuCount = m_Graphics->GetGpuTimings(gpuTimings, GPU_TIMER_MAX_SCOPES);
+		for (j = 0; j < gpuCount; j++)
+		{
+			m_gpuTimes[gpuTimings[j].name].push_back(gpuTimings[j].time);
+		}
+	}
+
+	return true;
+}
+
+bool Benchmark::WriteResults(const char * filename)
+{
+	std::ofstream fout;
+	std::map<std::string, std::vector<float> >::iterator gpuTime;
+
+	fout.open(filename);
+	if (fout.fail())
+	{
+		return false;
+	}
+
+	fout << "{\n";
+	fout << "\t\"scene\": \"" << BenchmarkStats::Escape(m_sceneName) << "\",\n";
+	fout << "\t\"frames\": " << m_timings.size() << ",\n";
+	fout << "\t\"warmupFrames\": " << BENCHMARK_WARMUP_FRAMES << ",\n";
+	fout << "\t\"width\": " << BENCHMARK_WIDTH << ",\n";
+	fout << "\t\"height\": " << BENCHMARK_HEIGHT << ",\n";
+	BenchmarkStats::WritePhases(fout, m_timings);
+	fout << "\t\"gpu\": {\n";
+	for (gpuTime = m_gpuTimes.begin(); gpuTime != m_gpuTimes.end(); ++gpuTime)
+	{
+		BenchmarkStats::WriteStatistics(fout, gpuTime->first.c_str(), gpuTime->second, std::next(gpuTime) == m_gpuTimes.end());
+	}
+	fout << "\t},\n";
+	BenchmarkStats::WriteSubmission(fout, "submission", m_counters, false);
+	BenchmarkStats::WriteMemory(fout, (int)m_timings.size(), m_heapAllocations, m_allocatingFrames, m_frameBytes, m_frameOverflows,
+		true);
+	fout << "}\n";
+
+	fout.close();
+
+	return !fout.fail();
+}
+
+int Benchmark::GetAllocatingFrames()
+{
+	return m_allocatingFrames;
+}
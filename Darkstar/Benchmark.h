@@ -0,0 +1,57 @@
+#pragma once
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+#include "Graphics.h"
+#include "BenchmarkStats.h"
+#include "HeapCounter.h"
+
+#define BENCHMARK_WIDTH 1280
+#define BENCHMARK_HEIGHT 720
+
+// Frames at the start that are left out of the results, they still upload assets and warm the caches.
+#define BENCHMARK_WARMUP_FRAMES 10
+
+// Frame time handed to the graphics every frame, so the animation is the same no matter how fast it runs.
+#define BENCHMARK_FRAME_TIME 16.0f
+
+// Runs the graphics headless along a fixed camera path and writes the CPU time of every frame phase and the
+// gpu time of every pass as percentiles to a JSON file, so runs on different builds can be compared. The heap
+// allocations and frame memory per frame go with them.
+class Benchmark
+{
+private:
+	Graphics* m_Graphics;
+
+	std::string m_sceneName;
+	int m_frameCount;
+
+	std::vector<FrameTimings> m_timings;
+	std::vector<NullRenderCounters> m_counters;
+	// Gpu time of every pass, a few frames late since the timer never waits for the gpu.
+	std::map<std::string, std::vector<float> > m_gpuTimes;
+	// Totals over the measured frames. The heap allocations are the ones of the engine dll.
+	long long m_heapAllocations;
+	int m_allocatingFrames;
+	long long m_frameBytes;
+	long long m_frameOverflows;
+
+	void MoveCamera(int frame, float& rotationY);
+public:
+	Benchmark();
+	Benchmark(const Benchmark& other);
+	~Benchmark();
+
+	// A scene file of 0 runs the 50 model demo.
+	bool Initialize(const char* sceneFile, int frameCount);
+	void Shutdown();
+
+	bool Run();
+	bool WriteResults(const char* filename);
+
+	// Measured frames in which Update or Submit allocated on the heap, a steady frame must not.
+	int GetAllocatingFrames();
+};
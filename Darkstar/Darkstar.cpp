@@ -4,9 +4,10 @@
 
 bool Darkstar::Frame()
 {
-	bool result, keyDown;
-	float rotationY;
-	int mouseX, mouseY;
+	PROFILE_ZONE("Darkstar::Frame");
+	bool result;
+	float rotationX, rotationY, rotationZ, difference, interpolation;
+	int mouseX, mouseY, steps, i;
 	//Update the system stats
 	m_Timer->Frame();
 	m_Fps->Frame();
@@ -19,8 +20,60 @@ bool Darkstar::Frame()
 		return false;
 	}
 
-	//Set the grame time for calculating the update position
-	m_Position->SetFrameTime(m_Timer->GetTime());
+	//Run as many fixed simulation steps as the time of the last frame adds up to
+	steps = m_Scheduler->Advance(m_Timer->GetTime());
+	for (i = 0; i < steps; i++)
+	{
+		Simulate();
+	}
+
+	//Draw the view point between the last two steps, the short way around where the rotation wraps
+	interpolation = m_Scheduler->GetInterpolation();
+	m_Position->GetRotation(rotationX, rotationY, rotationZ);
+
+	difference = rotationY - m_previousRotationY;
+	if (difference > 180.0f)
+	{
+		difference -= 360.0f;
+	}
+	else if (difference < -180.0f)
+	{
+		difference += 360.0f;
+	}
+
+	rotationY = m_previousRotationY + difference * interpolation;
+
+	// Get the location of the mouse from the input object,
+	m_Input->GetMouseLocation(mouseX, mouseY);
+
+	//F1 toggles the profiler and its overlay, F2 saves a trace of what it recorded, F3 starts and stops
+	//writing the counters of every frame to a csv file, F4 toggles the debug lines
+	HandleProfilerKeys();
+
+	//Stop once the render thread could not draw a frame
+	if (m_RenderThread->HasFailed())
+	{
+		return false;
+	}
+
+	//Build the snapshot of this frame and hand it to the render thread, which may still be drawing the last one
+	m_Graphics->Update(rotationY, mouseX, mouseY, m_Fps->GetFps(), m_Cpu->GetCpuPercentage(), m_Timer->GetTime(), interpolation,
+		m_RenderThread->GetSnapshot());
+	m_RenderThread->Publish();
+
+	return true;
+}
+
+void Darkstar::Simulate()
+{
+	bool keyDown;
+	float rotationX, rotationZ;
+
+	//Keep the rotation of the last step to interpolate from
+	m_Position->GetRotation(rotationX, m_previousRotationY, rotationZ);
+
+	//Every step moves by the same time, whatever the frame rate
+	m_Position->SetFrameTime(m_Scheduler->GetStepTime());
 
 	// Check if the left or right arrow key has been pressed, if so rotate the camera accordingly.
 	keyDown = m_Input->IsLeftArrowPressed();
@@ -29,22 +82,41 @@ bool Darkstar::Frame()
 	keyDown = m_Input->IsRightArrowPressed();
 	m_Position->TurnRight(keyDown);
 
-	float tempX, tempZ;
+	m_Graphics->Simulate(m_Scheduler->GetStepTime());
+}
 
-	//Get current view point rotation
-	m_Position->GetRotation(tempX, rotationY, tempZ);
+void Darkstar::HandleProfilerKeys()
+{
+	bool keyDown;
 
-	// Get the location of the mouse from the input object,
-	m_Input->GetMouseLocation(mouseX, mouseY);
+	keyDown = m_Input->IsF1Pressed();
+	if (keyDown && !m_profilerKeyDown)
+	{
+		Profiler::SetEnabled(!Profiler::IsEnabled());
+	}
+	m_profilerKeyDown = keyDown;
 
-	//Do the frame processing for the graphics object.
-	result = m_Graphics->Frame(rotationY, mouseX, mouseY, m_Fps->GetFps(), m_Cpu->GetCpuPercentage(), m_Timer->GetTime());
-	if (!result)
+	//The render thread writes the files between two of its frames, zones recorded meanwhile go into the next trace
+	keyDown = m_Input->IsF2Pressed();
+	if (keyDown && !m_traceKeyDown)
 	{
-		return false;
+		m_RenderThread->RequestTrace("trace.json");
 	}
+	m_traceKeyDown = keyDown;
 
-	return true;
+	keyDown = m_Input->IsF3Pressed();
+	if (keyDown && !m_statsKeyDown)
+	{
+		m_RenderThread->RequestCsvToggle("stats.csv");
+	}
+	m_statsKeyDown = keyDown;
+
+	keyDown = m_Input->IsF4Pressed();
+	if (keyDown && !m_debugDrawKeyDown)
+	{
+		DebugDraw::SetEnabled(!DebugDraw::IsEnabled());
+	}
+	m_debugDrawKeyDown = keyDown;
 }
 
 void Darkstar::InitializeWindows(int & screenWidth, int & screenHeight)
@@ -156,6 +228,14 @@ Darkstar::Darkstar()
 	m_Cpu = 0;
 	m_Timer = 0;
 	m_Position = 0;
+	m_Scheduler = 0;
+	m_RenderThread = 0;
+	m_previousRotationY = 0.0f;
+
+	m_profilerKeyDown = false;
+	m_traceKeyDown = false;
+	m_statsKeyDown = false;
+	m_debugDrawKeyDown = false;
 }
 
 Darkstar::Darkstar(const Darkstar& other)
@@ -178,11 +258,16 @@ void Darkstar::Run()
 	done = false;
 	while (!done)
 	{
-		//Handlw the windows messages
-		if (PeekMessage(&msg, NULL, 0, 0, PM_REMOVE))
+		//Handle every waiting windows message, a capped frame rate would otherwise only get to one per frame
+		while (PeekMessage(&msg, NULL, 0, 0, PM_REMOVE))
 		{
 			TranslateMessage(&msg);
 			DispatchMessage(&msg);
+
+			if (msg.message == WM_QUIT)
+			{
+				break;
+			}
 		}
 
 		//if windows signals to end the application then exit out
@@ -199,6 +284,9 @@ void Darkstar::Run()
 				MessageBox(m_hwnd, L"Frame Processing Failed", L"Error", MB_OK);
 				done = true;
 			}
+
+			//Give the time left to the frame cap back instead of spinning through the loop
+			m_Scheduler->WaitForNextFrame();
 		}
 
 		//Check if the user pressed escape and want to quit
@@ -211,6 +299,22 @@ void Darkstar::Run()
 
 void Darkstar::Shutdown()
 {
+	// Stop the render thread before anything it draws with is released.
+	if (m_RenderThread)
+	{
+		m_RenderThread->Shutdown();
+		delete m_RenderThread;
+		m_RenderThread = 0;
+	}
+
+	// Release the frame scheduler object.
+	if (m_Scheduler)
+	{
+		m_Scheduler->Shutdown();
+		delete m_Scheduler;
+		m_Scheduler = 0;
+	}
+
 	// Release the position object.
 	if (m_Position)
 	{
@@ -256,6 +360,12 @@ void Darkstar::Shutdown()
 		m_Input = 0;
 	}
 
+	//Release the zones the profiler recorded, the debug lines, the frame memory and close the counter file
+	Profiler::Shutdown();
+	DebugDraw::Shutdown();
+	FrameMemory::Shutdown();
+	Stats::CloseCsv();
+
 	//Shutdown the window
 	ShutdownWindows();
 }
@@ -336,6 +446,36 @@ bool Darkstar::Initialize()
 		return false;
 	}
 
+	// Create the frame scheduler object.
+	m_Scheduler = new FrameScheduler;
+	if (!m_Scheduler)
+	{
+		return false;
+	}
+
+	// Initialize the frame scheduler object.
+	result = m_Scheduler->Initialize(FRAME_SCHEDULER_STEP_TIME, FRAME_SCHEDULER_FRAME_CAP);
+	if (!result)
+	{
+		MessageBox(m_hwnd, L"Could not initialize the frame scheduler object.", L"Error", MB_OK);
+		return false;
+	}
+
+	// Create the render thread object.
+	m_RenderThread = new RenderThread;
+	if (!m_RenderThread)
+	{
+		return false;
+	}
+
+	// Start drawing the frames on the render thread.
+	result = m_RenderThread->Initialize(m_Graphics);
+	if (!result)
+	{
+		MessageBox(m_hwnd, L"Could not initialize the render thread object.", L"Error", MB_OK);
+		return false;
+	}
+
 	return true;
 }
 
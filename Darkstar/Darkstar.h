@@ -8,6 +8,8 @@
 #include "CpuCounter.h"
 #include "Timer.h"
 #include "Position.h"
+#include "FrameScheduler.h"
+#include "RenderThread.h"
 
 class Darkstar
 {
@@ -23,10 +25,19 @@ private:
 	CpuCounter* m_Cpu;
 	Timer* m_Timer;
 	Position* m_Position;
+	FrameScheduler* m_Scheduler;
+	RenderThread* m_RenderThread;
+	//Rotation of the view point at the second to last simulation step
+	float m_previousRotationY;
+
+	//Keys that act once per press
+	bool m_profilerKeyDown, m_traceKeyDown, m_statsKeyDown, m_debugDrawKeyDown;
 
 	bool Frame();
+	void Simulate();
 	void InitializeWindows(int& screenWidth, int& screenHeight);
 	void ShutdownWindows();
+	void HandleProfilerKeys();
 public:
 	Darkstar();
 	Darkstar(const Darkstar& other);
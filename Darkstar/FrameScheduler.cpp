@@ -0,0 +1,137 @@
+#include "FrameScheduler.h"
+
+FrameScheduler::FrameScheduler()
+{
+	m_frequency = 0;
+	m_frameTicks = 0;
+	m_nextFrame = 0;
+	m_stepTime = FRAME_SCHEDULER_STEP_TIME;
+	m_accumulator = 0.0f;
+	m_periodSet = false;
+}
+
+FrameScheduler::FrameScheduler(const FrameScheduler & other)
+{
+}
+
+FrameScheduler::~FrameScheduler()
+{
+}
+
+bool FrameScheduler::Initialize(float stepTime, float frameCap)
+{
+	QueryPerformanceFrequency((LARGE_INTEGER*)&m_frequency);
+	if (m_frequency == 0 || stepTime <= 0.0f)
+	{
+		return false;
+	}
+
+	m_stepTime = stepTime;
+	m_accumulator = 0.0f;
+
+	// Let Sleep wake up within a millisecond instead of the default scheduler tick.
+	m_periodSet = timeBeginPeriod(1) == TIMERR_NOERROR;
+
+	SetFrameCap(frameCap);
+
+	return true;
+}
+
+void FrameScheduler::Shutdown()
+{
+	if (m_periodSet)
+	{
+		timeEndPeriod(1);
+		m_periodSet = false;
+	}
+}
+
+void FrameScheduler::SetFrameCap(float framesPerSecond)
+{
+	m_frameTicks = framesPerSecond > 0.0f ? (INT64)((double)m_frequency / framesPerSecond) : 0;
+	m_nextFrame = 0;
+}
+
+int FrameScheduler::Advance(float frameTime)
+{
+	int steps;
+
+	// Drop what is past the most steps a frame may take, so a hitch is not caught up over the next frames.
+	if (frameTime > m_stepTime * FRAME_SCHEDULER_MAX_STEPS)
+	{
+		frameTime = m_stepTime * FRAME_SCHEDULER_MAX_STEPS;
+	}
+
+	if (frameTime > 0.0f)
+	{
+		m_accumulator += frameTime;
+	}
+
+	steps = (int)(m_accumulator / m_stepTime);
+	if (steps > FRAME_SCHEDULER_MAX_STEPS)
+	{
+		steps = FRAME_SCHEDULER_MAX_STEPS;
+	}
+
+	m_accumulator -= steps * m_stepTime;
+	if (m_accumulator < 0.0f)
+	{
+		m_accumulator = 0.0f;
+	}
+
+	return steps;
+}
+
+float FrameScheduler::GetStepTime()
+{
+	return m_stepTime;
+}
+
+float FrameScheduler::GetInterpolation()
+{
+	float interpolation;
+
+	interpolation = m_accumulator / m_stepTime;
+	return interpolation < 1.0f ? interpolation : 1.0f;
+}
+
+void FrameScheduler::WaitForNextFrame()
+{
+	PROFILE_FUNCTION();
+	INT64 now;
+	float remaining;
+
+	if (m_frameTicks == 0)
+	{
+		return;
+	}
+
+	QueryPerformanceCounter((LARGE_INTEGER*)&now);
+
+	// The first frame, or one that ran more than a frame late, starts the pacing over instead of rushing the
+	// next frames to catch up.
+	if (m_nextFrame == 0 || now > m_nextFrame + m_frameTicks)
+	{
+		m_nextFrame = now + m_frameTicks;
+		return;
+	}
+
+	while (now < m_nextFrame)
+	{
+		remaining = (float)((double)(m_nextFrame - now) * 1000.0 / (double)m_frequency);
+
+		// Sleep while the wake up can not be late, then spin the last part.
+		if (remaining > FRAME_SCHEDULER_SPIN_TIME)
+		{
+			Sleep((DWORD)(remaining - FRAME_SCHEDULER_SPIN_TIME));
+		}
+		else
+		{
+			YieldProcessor();
+		}
+
+		QueryPerformanceCounter((LARGE_INTEGER*)&now);
+	}
+
+	m_nextFrame += m_frameTicks;
+}
@@ -0,0 +1,50 @@
+#pragma once
+#pragma comment(lib, "winmm.lib")
+
+#include <Windows.h>
+#include <mmsystem.h>
+#include "Profiler.h"
+
+// Milliseconds of simulation every fixed step, 60 steps a second.
+#define FRAME_SCHEDULER_STEP_TIME (1000.0f / 60.0f)
+// Steps one frame may run at most. A frame that took longer slows the simulation down instead of making the
+// next frame even longer.
+#define FRAME_SCHEDULER_MAX_STEPS 5
+// Frames per second the loop is capped to, zero renders as fast as it can.
+#define FRAME_SCHEDULER_FRAME_CAP 144.0f
+// Milliseconds before the next frame at which the wait stops sleeping and spins, Sleep can overshoot by about
+// a millisecond even with a one millisecond timer period.
+#define FRAME_SCHEDULER_SPIN_TIME 2.0f
+
+// Runs the simulation in fixed steps independent of the frame rate and paces the frames. Advance turns the
+// time of a frame into a number of fixed steps and keeps the rest, which GetInterpolation gives as the
+// fraction of a step the frame is past the last step. WaitForNextFrame sleeps most of the time left until the
+// frame cap allows the next frame and spins the last part.
+class FrameScheduler
+{
+private:
+	INT64 m_frequency;
+	INT64 m_frameTicks;
+	INT64 m_nextFrame;
+	float m_stepTime;
+	float m_accumulator;
+	bool m_periodSet;
+public:
+	FrameScheduler();
+	FrameScheduler(const FrameScheduler&);
+	~FrameScheduler();
+
+	bool Initialize(float stepTime, float frameCap);
+	void Shutdown();
+
+	// Zero turns the cap off.
+	void SetFrameCap(float framesPerSecond);
+
+	// Adds the milliseconds the last frame took and returns how many steps to simulate.
+	int Advance(float frameTime);
+	float GetStepTime();
+	// Between 0 and 1, how far the frame is from the second to last step towards the last one.
+	float GetInterpolation();
+
+	void WaitForNextFrame();
+};
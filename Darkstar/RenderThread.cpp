@@ -0,0 +1,159 @@
+#include "RenderThread.h"
+
+RenderThread::RenderThread()
+{
+	m_Graphics = 0;
+	m_Snapshots = 0;
+	m_published = false;
+	m_quit = false;
+	m_failed = false;
+	m_traceFile = 0;
+	m_csvFile = 0;
+}
+
+RenderThread::RenderThread(const RenderThread & other)
+{
+}
+
+RenderThread::~RenderThread()
+{
+}
+
+bool RenderThread::Initialize(Graphics * graphics)
+{
+	m_Graphics = graphics;
+
+	// Create the snapshots the two threads pass between them.
+	m_Snapshots = new TripleBuffer<FrameSnapshot>;
+	if (!m_Snapshots)
+	{
+		return false;
+	}
+
+	m_published = false;
+	m_quit = false;
+	m_failed = false;
+
+	m_thread = std::thread(&RenderThread::RenderLoop, this);
+
+	return true;
+}
+
+void RenderThread::Shutdown()
+{
+	// Wake the render thread up and wait for it to leave its loop.
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_quit = true;
+	}
+	m_publishedCondition.notify_one();
+
+	if (m_thread.joinable())
+	{
+		m_thread.join();
+	}
+
+	// Release the snapshots.
+	if (m_Snapshots)
+	{
+		delete m_Snapshots;
+		m_Snapshots = 0;
+	}
+
+	m_Graphics = 0;
+}
+
+FrameSnapshot & RenderThread::GetSnapshot()
+{
+	return m_Snapshots->GetWriteBuffer();
+}
+
+void RenderThread::Publish()
+{
+	m_Snapshots->Publish();
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_published = true;
+	}
+	m_publishedCondition.notify_one();
+}
+
+bool RenderThread::HasFailed()
+{
+	return m_failed;
+}
+
+void RenderThread::RequestTrace(const char * filename)
+{
+	m_traceFile = filename;
+}
+
+void RenderThread::RequestCsvToggle(const char * filename)
+{
+	m_csvFile = filename;
+}
+
+void RenderThread::RenderLoop()
+{
+	bool result;
+
+	while (true)
+	{
+		// Sleep until the game thread published a snapshot or until the thread shuts down.
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_publishedCondition.wait(lock, [&] { return m_quit || m_published; });
+
+			if (m_quit)
+			{
+				return;
+			}
+
+			m_published = false;
+		}
+
+		// Every publish wakes the thread, but a few of them may have been taken together already.
+		if (!m_Snapshots->Acquire())
+		{
+			continue;
+		}
+
+		result = m_Graphics->Submit(m_Snapshots->GetReadBuffer());
+		if (!result)
+		{
+			m_failed = true;
+			return;
+		}
+
+		EndFrame();
+	}
+}
+
+void RenderThread::EndFrame()
+{
+	const char* filename;
+
+	//Summarize the zones and counters of the frame for the overlay
+	Profiler::EndFrame();
+	Stats::EndFrame();
+
+	filename = m_traceFile.exchange(0);
+	if (filename)
+	{
+		Profiler::WriteChromeTrace(filename);
+	}
+
+	filename = m_csvFile.exchange(0);
+	if (filename)
+	{
+		if (Stats::IsCsvOpen())
+		{
+			Stats::CloseCsv();
+		}
+		else
+		{
+			Stats::OpenCsv(filename);
+		}
+	}
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include "Graphics.h"
+#include "TripleBuffer.h"
+#include "Profiler.h"
+#include "Stats.h"
+
+// Submits the frames on a thread of its own, so the game thread simulates frame N + 1 while frame N is submitted.
+// The game thread fills the write snapshot with Graphics::Update and publishes it, the render thread takes the
+// newest snapshot and draws it with Graphics::Submit. The snapshots go through a triple buffer, so neither
+// thread waits for the other and snapshots the renderer could not keep up with are skipped. The render thread
+// also closes every frame of the profiler and the counters.
+class RenderThread
+{
+private:
+	Graphics* m_Graphics;
+	TripleBuffer<FrameSnapshot>* m_Snapshots;
+	std::thread m_thread;
+
+	// Only wakes the render thread up, the snapshots themselves need no lock.
+	std::mutex m_mutex;
+	std::condition_variable m_publishedCondition;
+	bool m_published;
+	bool m_quit;
+
+	std::atomic<bool> m_failed;
+	// Files the game thread asked for, written by the render thread between two frames. Zero when nothing
+	// is asked for.
+	std::atomic<const char*> m_traceFile;
+	std::atomic<const char*> m_csvFile;
+
+	void RenderLoop();
+	void EndFrame();
+public:
+	RenderThread();
+	RenderThread(const RenderThread&);
+	~RenderThread();
+
+	bool Initialize(Graphics* graphics);
+	// Waits for the frame the render thread is on, the graphics object can be released afterwards.
+	void Shutdown();
+
+	// Snapshot the game thread fills for the next frame, only valid until Publish.
+	FrameSnapshot& GetSnapshot();
+	void Publish();
+
+	// True once a frame failed to render, the render thread has stopped then.
+	bool HasFailed();
+
+	// Writes the chrome trace of the profiler after the current frame.
+	void RequestTrace(const char* filename);
+	// Starts or stops writing the counters of every frame to a csv file after the current frame.
+	void RequestCsvToggle(const char* filename);
+};
@@ -1,16 +1,137 @@
 #include <Windows.h>
+#include <shellapi.h>
 #include "Darkstar.h"
+#include "Benchmark.h"
 #define _CRTDBG_MAP_ALLOC 
 
+//Runs the benchmark for "-benchmark [-scene file] [-frames count] [-out file] [-trace file] [-stats file]" and returns true, or returns false
+//for any other command line. The exit code is 1 when the benchmark failed or a measured frame allocated on the heap
+static bool RunBenchmark(PWSTR pCmdLine, int& exitCode)
+{
+	Benchmark* benchmark;
+	LPWSTR* arguments;
+	char scene[MAX_PATH], output[MAX_PATH], trace[MAX_PATH], stats[MAX_PATH];
+	bool hasScene, hasTrace;
+	int argumentCount, frameCount, i;
+
+	arguments = CommandLineToArgvW(pCmdLine, &argumentCount);
+	if (!arguments)
+	{
+		return false;
+	}
+
+	if (argumentCount < 1 || wcscmp(arguments[0], L"-benchmark") != 0)
+	{
+		LocalFree(arguments);
+		return false;
+	}
+
+	//Default to the 50 model demo
+	hasScene = false;
+	hasTrace = false;
+	frameCount = 1000;
+	strcpy_s(output, MAX_PATH, "benchmark.json");
+
+	for (i = 1; i + 1 < argumentCount; i += 2)
+	{
+		if (wcscmp(arguments[i], L"-scene") == 0)
+		{
+			WideCharToMultiByte(CP_UTF8, 0, arguments[i + 1], -1, scene, MAX_PATH, NULL, NULL);
+			hasScene = true;
+		}
+		else if (wcscmp(arguments[i], L"-frames") == 0)
+		{
+			frameCount = _wtoi(arguments[i + 1]);
+		}
+		else if (wcscmp(arguments[i], L"-out") == 0)
+		{
+			WideCharToMultiByte(CP_UTF8, 0, arguments[i + 1], -1, output, MAX_PATH, NULL, NULL);
+		}
+		else if (wcscmp(arguments[i], L"-trace") == 0)
+		{
+			WideCharToMultiByte(CP_UTF8, 0, arguments[i + 1], -1, trace, MAX_PATH, NULL, NULL);
+			hasTrace = true;
+		}
+		else if (wcscmp(arguments[i], L"-stats") == 0)
+		{
+			//The counters of every frame go to this csv file
+			WideCharToMultiByte(CP_UTF8, 0, arguments[i + 1], -1, stats, MAX_PATH, NULL, NULL);
+			Stats::OpenCsv(stats);
+		}
+	}
+
+	LocalFree(arguments);
+
+	exitCode = 1;
+
+	//Create the benchmark object
+	benchmark = new Benchmark;
+	if (!benchmark)
+	{
+		return true;
+	}
+
+	//Record the zones as well when a trace was asked for, this costs some time in every phase
+	Profiler::SetEnabled(hasTrace);
+
+	//Run the camera path and write the results
+	if (benchmark->Initialize(hasScene ? scene : 0, frameCount > 0 ? frameCount : 1))
+	{
+		if (benchmark->Run())
+		{
+			benchmark->WriteResults(output);
+
+			if (hasTrace)
+			{
+				Profiler::WriteChromeTrace(trace);
+			}
+
+			//The results are written either way, so the file shows how much the frames allocated
+			if (benchmark->GetAllocatingFrames() > 0)
+			{
+				OutputDebugStringA("Benchmark: measured frames allocated on the heap\n");
+			}
+			else
+			{
+				exitCode = 0;
+			}
+		}
+	}
+
+	//Shutdown and release the benchmark object
+	benchmark->Shutdown();
+	delete benchmark;
+	benchmark = 0;
+
+	Profiler::Shutdown();
+	DebugDraw::Shutdown();
+	FrameMemory::Shutdown();
+	Stats::CloseCsv();
+
+	return true;
+}
+
 int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, PWSTR pCmdLine, int nCmdShow) {
 	_CrtSetDbgFlag(_CRTDBG_ALLOC_MEM_DF | _CRTDBG_LEAK_CHECK_DF);
 	//_CrtSetBreakAlloc(118289);
 	Darkstar* system;
+	int exitCode;
+
+	//Start the worker threads every part of the engine shares
+	JobSystem::Initialize(JobSystem::GetDefaultWorkerCount());
+
+	//Run the headless benchmark instead of the engine when asked for on the command line
+	if (RunBenchmark(pCmdLine, exitCode))
+	{
+		JobSystem::Shutdown();
+		return exitCode;
+	}
 
 	//Create the engine object
 	system = new Darkstar;
 	if (!system)
 	{
+		JobSystem::Shutdown();
 		return 0;
 	}
 
@@ -25,5 +146,7 @@ int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, PWSTR pCmdLine
 	delete system;
 	system = 0;
 
+	JobSystem::Shutdown();
+
 	return 0;
 }
\ No newline at end of file
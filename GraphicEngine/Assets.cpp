@@ -58,8 +58,10 @@
 		return result;
 	}
 
+	static int nextAssetID = 0;
+
 	Asset::Asset()
-		: referenceCount( 0 )
+		: referenceCount( 0 ), id( nextAssetID++ )
 	{
 	}
 
@@ -96,8 +98,13 @@
 		return referenceCount;
 	}
 
-	AssetID::AssetID( std::string p, size_t h )
-		: path( p ), hash( h )
+	int Asset::getID()
+	{
+		return id;
+	}
+
+	AssetID::AssetID( std::string p, std::type_index t )
+		: path( p ), type( t )
 	{
 	}
 
@@ -108,14 +115,14 @@
 	AssetID& AssetID::operator=( const AssetID& ref )
 	{
 		path = ref.path;
-		hash = ref.hash;
+		type = ref.type;
 
 		return *this;
 	}
 
 	bool AssetID::operator==( const AssetID& ref ) const
 	{
-		return ( path == ref.path && hash == ref.hash );
+		return ( path == ref.path && type == ref.type );
 	}
 
 	bool AssetID::operator!=( const AssetID& ref ) const
@@ -128,7 +135,7 @@
 		bool result = false;
 
 		if( path == ref.path )
-			result = ( hash < ref.hash );
+			result = ( type < ref.type );
 		else
 			result = ( path < ref.path );
 
@@ -140,7 +147,7 @@
 		bool result = false;
 
 		if( path == ref.path )
-			result = ( hash > ref.hash );
+			result = ( type > ref.type );
 		else
 			result = ( path > ref.path );
 
@@ -159,11 +166,11 @@
 		bool done = false;
 		while( !done )
 		{
-			std::map<AssetID, Asset*>::iterator it = assets.begin();
+			std::map<AssetID, AssetEntry>::iterator it = assets.begin();
 			if( it != assets.end() )
 			{
-				it->second->unload();
-				delete it->second;
+				resolve( it->second )->unload();
+				it->second.pool->release( it->second.index, it->second.generation );
 				assets.erase( it );
 			}
 			else
@@ -171,29 +178,44 @@
 		}
 
 		assets.clear();
+
+		for( std::map<std::type_index, AssetPool*>::iterator it = pools.begin(); it != pools.end(); it++ )
+			delete it->second;
+
+		pools.clear();
 	}
 
 	void Assets::upload()
 	{
+		PROFILE_ZONE("Assets::upload");
+		// Assets evicted before they got here are skipped.
 		for( int i=0; i<pending.size(); i++ )
-			pending.at(i)->upload();
+		{
+			Asset* asset = resolve( pending.at(i) );
+			if( asset )
+				asset->upload();
+		}
 
 		pending.clear();
 	}
 
 	void Assets::checkHotload( float dt )
 	{
+		PROFILE_ZONE("Assets::checkHotload");
 		elapsedTime += dt;
 		if( elapsedTime >= ASSETS_HOTLOAD_DELAY )
 		{
 			elapsedTime = 0.0f;
 
-			for( std::map<AssetID, Asset*>::iterator it = assets.begin(); it != assets.end(); it++ )
+			// Reloading happens in place, so the handles to the asset stay valid.
+			for( std::map<AssetID, AssetEntry>::iterator it = assets.begin(); it != assets.end(); it++ )
 			{
-				if( it->second->getFileInfo()->hasChanged() )
+				Asset* asset = resolve( it->second );
+				if( asset->getFileInfo()->hasChanged() )
 				{
-					it->second->unload();
-					it->second->load( it->second->getFileInfo()->getPath(), this );
+					asset->unload();
+					asset->load( asset->getFileInfo()->getPath(), this );
+					Stats::Add( STAT_ASSETS_LOADED, 1 );
 				}
 			}
 		}
@@ -201,12 +223,13 @@
 
 	void Assets::checkReferences()
 	{
+		PROFILE_ZONE("Assets::checkReferences");
 		for( int i=0; i<unloads.size(); i++ )
 		{
-			std::map<AssetID, Asset*>::iterator it = assets.find( unloads[i] );
+			std::map<AssetID, AssetEntry>::iterator it = assets.find( unloads[i] );
 			if( it != assets.end() )
 			{
-				it->second->decrementReferenceCount();
+				resolve( it->second )->decrementReferenceCount();
 			}
 		}
 
@@ -230,23 +253,30 @@
 			assets.erase( removes[i] );
 		}*/
 
-		for( std::map<AssetID, Asset*>::iterator it = assets.begin(); it != assets.end(); it++ )
+		for( std::map<AssetID, AssetEntry>::iterator it = assets.begin(); it != assets.end(); it++ )
 		{
-			if( it->second->getReferenceCount() <= 0 )
+			if( resolve( it->second )->getReferenceCount() <= 0 )
 				removes.push_back( it );
 		}
 
+		// Freeing moves the generation of the slot on, the handles to the asset go stale.
 		for( int i=0; i<removes.size(); i++ )
 		{
-			removes[i]->second->unload();
-			delete removes[i]->second;
+			resolve( removes[i]->second )->unload();
+			removes[i]->second.pool->release( removes[i]->second.index, removes[i]->second.generation );
 			assets.erase( removes[i] );
 		}
 
+		Stats::Add( STAT_ASSETS_EVICTED, (long long)removes.size() );
 		removes.clear();
 	}
 
-	const std::map<AssetID, Asset*>& Assets::getAssets() const
+	const std::map<AssetID, AssetEntry>& Assets::getAssets() const
 	{
 		return assets;
 	}
+
+	Asset* Assets::resolve( const AssetEntry& entry )
+	{
+		return entry.pool->get( entry.index, entry.generation );
+	}
@@ -1,13 +1,20 @@
 #pragma once
 
 #include <map>
+#include <typeindex>
 #include <Windows.h>
 #include <d3d11.h>
 #include <vector>
 #include "Util.h"
+#include "Profiler.h"
+#include "Stats.h"
+#include "RenderContext.h"
+#include "ObjectPool.h"
 
 #define ASSETS_HOTLOAD_DELAY 0.5f
 #define ASSETS_MAX_UNLOAD_PER_FRAME 5
+// Assets of one type per block of its pool, a full pool adds another block.
+#define ASSETS_POOL_BLOCK_SIZE 64
 
 
 	class FileInfo
@@ -47,18 +54,22 @@
 		GRAPHIC_API FileInfo* getFileInfo();
 		GRAPHIC_API int getReferenceCount();
 
+		// Small number unique to this asset, used to group draws by their resources.
+		GRAPHIC_API int getID();
+
 	protected:
 		Assets* assets;
 		int referenceCount;
 
 	private:
 		FileInfo fileInfo;
+		int id;
 	};
 
 	class AssetID
 	{
 	public:
-		GRAPHIC_API AssetID( std::string path, size_t hash );
+		GRAPHIC_API AssetID( std::string path, std::type_index type );
 		GRAPHIC_API ~AssetID();
 
 		GRAPHIC_API AssetID& operator=( const AssetID& ref );
@@ -69,7 +80,56 @@
 
 	private:
 		std::string path;
-		size_t hash;
+		std::type_index type;
+	};
+
+	// Pool of one asset type, seen through its Asset base so Assets can go over every type the same way.
+	class AssetPool
+	{
+	public:
+		virtual ~AssetPool() {}
+
+		virtual Asset* get( unsigned int index, unsigned int generation ) = 0;
+		virtual void release( unsigned int index, unsigned int generation ) = 0;
+	};
+
+	template<typename T>
+	class TypedAssetPool : public AssetPool
+	{
+	public:
+		ObjectPool<T> objects;
+
+		~TypedAssetPool()
+		{
+			objects.Shutdown();
+		}
+
+		Asset* get( unsigned int index, unsigned int generation ) override
+		{
+			return objects.Get( makeHandle( index, generation ) );
+		}
+
+		void release( unsigned int index, unsigned int generation ) override
+		{
+			objects.Free( makeHandle( index, generation ) );
+		}
+
+	private:
+		static Handle<T> makeHandle( unsigned int index, unsigned int generation )
+		{
+			Handle<T> handle;
+			handle.index = index;
+			handle.generation = generation;
+			return handle;
+		}
+	};
+
+	// Where a loaded asset lives, resolved through its pool so an evicted asset is never touched.
+	struct AssetEntry
+	{
+		AssetPool* pool;
+		unsigned int index;
+		unsigned int generation;
 	};
 
 	class Assets
@@ -78,48 +138,65 @@
 		GRAPHIC_API Assets();
 		GRAPHIC_API virtual ~Assets();
 
+		// Returns an invalid handle when the asset could not be loaded.
 		template<typename T>
-		T* load( std::string path )
+		Handle<T> load( std::string path )
 		{
-			T* result = nullptr;
+			Handle<T> result;
+			T* asset = nullptr;
+			TypedAssetPool<T>* pool = getPool<T>();
 
-			// NOTE: Since hash_code is a hash, it is not guaranteed to be unique.
-			// But it should be good enough for our limited purposes
-			AssetID id( path, typeid(T).hash_code() );
+			AssetID id( path, std::type_index( typeid(T) ) );
 
-			std::map<AssetID, Asset*>::iterator it = assets.find( id );
+			std::map<AssetID, AssetEntry>::iterator it = assets.find( id );
 			if( it != assets.end() )
-				result = (T*)it->second;
+			{
+				result.index = it->second.index;
+				result.generation = it->second.generation;
+				asset = pool->objects.Get( result );
+			}
 			else
 			{
-				result = new T();
-				if( result->load( path, this ) )
+				result = pool->objects.Allocate();
+				asset = pool->objects.Get( result );
+				if( asset && asset->load( path, this ) )
 				{
-					result->getFileInfo()->setPath( path );
-					assets.insert( std::pair<AssetID, Asset*>( id, result ) );
-					pending.push_back( result );
+					AssetEntry entry = { pool, result.index, result.generation };
+
+					asset->getFileInfo()->setPath( path );
+					assets.insert( std::pair<AssetID, AssetEntry>( id, entry ) );
+					pending.push_back( entry );
+					Stats::Add( STAT_ASSETS_LOADED, 1 );
 				}
 				else
 				{
 					//printf( "Failed to load asset \"%s\"\n", path.c_str() );
-					delete result;
-					result = nullptr;
+					pool->objects.Free( result );
+					result = Handle<T>();
+					asset = nullptr;
 				}
 			}
 
-			if( result )
+			if( asset )
 			{
-				result->setAssets( this );
-				result->incrementReferenceCount();
+				asset->setAssets( this );
+				asset->incrementReferenceCount();
 			}
 
 			return result;
 		}
 
+		// Returns nullptr once the asset of the handle was evicted.
+		template<typename T>
+		T* get( Handle<T> handle )
+		{
+			return getPool<T>()->objects.Get( handle );
+		}
+
 		template<typename T>
 		void unload( std::string path )
 		{
-			AssetID id( path, typeid(T).hash_code() );
+			AssetID id( path, std::type_index( typeid(T) ) );
 
 			/*std::map<AssetID, Asset*>::iterator it = assets.find( id );
 			if( it != assets.end() )
@@ -130,10 +207,10 @@
 			unloads.push_back( id );
 		}
 
-		void bind(ID3D11Device* device, ID3D11DeviceContext* deviceContext)
+		void bind(ID3D11Device* device, RenderContext* renderContext)
 		{
 			m_device = device;
-			m_deviceContext = deviceContext;
+			m_renderContext = renderContext;
 		}
 
 		GRAPHIC_API void upload();
@@ -141,22 +218,42 @@
 		GRAPHIC_API void checkHotload( float dt );
 		GRAPHIC_API void checkReferences();
 
-		GRAPHIC_API const std::map<AssetID, Asset*>& getAssets() const;
+		GRAPHIC_API const std::map<AssetID, AssetEntry>& getAssets() const;
+		GRAPHIC_API Asset* resolve( const AssetEntry& entry );
 
 		ID3D11Device* GetDevice() {
 			return m_device;
 		}
-		ID3D11DeviceContext* GetDeviceContext() {
-			return m_deviceContext;
+		RenderContext* GetRenderContext() {
+			return m_renderContext;
 		}
 
 	private:
+		template<typename T>
+		TypedAssetPool<T>* getPool()
+		{
+			TypedAssetPool<T>* pool;
+
+			// Only the pool of T is stored under the index of T.
+			std::map<std::type_index, AssetPool*>::iterator it = pools.find( std::type_index( typeid(T) ) );
+			if( it != pools.end() )
+				return static_cast<TypedAssetPool<T>*>( it->second );
+
+			pool = new TypedAssetPool<T>();
+			pool->objects.Initialize( ASSETS_POOL_BLOCK_SIZE );
+			pools.insert( std::pair<std::type_index, AssetPool*>( std::type_index( typeid(T) ), pool ) );
+
+			return pool;
+		}
+
 		float elapsedTime;
-		std::map<AssetID, Asset*> assets;
-		std::vector<Asset*> pending;
+		std::map<AssetID, AssetEntry> assets;
+		// One pool per asset type.
+		std::map<std::type_index, AssetPool*> pools;
+		std::vector<AssetEntry> pending;
 		std::vector<AssetID> unloads;
-		std::vector<std::map<AssetID, Asset*>::iterator> removes;
+		std::vector<std::map<AssetID, AssetEntry>::iterator> removes;
 
 		ID3D11Device* m_device;
-		ID3D11DeviceContext* m_deviceContext;
+		RenderContext* m_renderContext;
 	};
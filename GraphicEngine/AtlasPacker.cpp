@@ -0,0 +1,167 @@
+#include "AtlasPacker.h"
+
+AtlasPacker::AtlasPacker()
+{
+	m_width = 0;
+	m_height = 0;
+	m_nextShelfY = 0;
+}
+
+AtlasPacker::~AtlasPacker()
+{
+}
+
+void AtlasPacker::Initialize(int width, int height)
+{
+	m_width = width;
+	m_height = height;
+
+	Clear();
+}
+
+void AtlasPacker::Clear()
+{
+	m_shelves.clear();
+	m_nextShelfY = 0;
+}
+
+bool AtlasPacker::Allocate(int width, int height, AtlasRect & rect)
+{
+	Shelf shelf;
+	Span span;
+	int shelfHeight, i, j;
+
+	if (width <= 0 || height <= 0 || width > m_width)
+	{
+		return false;
+	}
+
+	shelfHeight = (height + ATLAS_SHELF_ALIGNMENT - 1) / ATLAS_SHELF_ALIGNMENT * ATLAS_SHELF_ALIGNMENT;
+
+	// Take the first free span that is wide enough on a shelf of the same height.
+	for (i = 0; i < (int)m_shelves.size(); i++)
+	{
+		if (m_shelves[i].height != shelfHeight)
+		{
+			continue;
+		}
+
+		for (j = 0; j < (int)m_shelves[i].free.size(); j++)
+		{
+			Span& free = m_shelves[i].free[j];
+			if (free.width < width)
+			{
+				continue;
+			}
+
+			rect.x = free.x;
+			rect.y = m_shelves[i].y;
+			rect.width = width;
+			rect.height = height;
+
+			free.x += width;
+			free.width -= width;
+			if (free.width == 0)
+			{
+				m_shelves[i].free.erase(m_shelves[i].free.begin() + j);
+			}
+
+			return true;
+		}
+	}
+
+	// A shelf that was emptied again can take rectangles of a lower height as well.
+	for (i = 0; i < (int)m_shelves.size(); i++)
+	{
+		if (m_shelves[i].height < shelfHeight || m_shelves[i].free.size() != 1 || m_shelves[i].free[0].width != m_width)
+		{
+			continue;
+		}
+
+		rect.x = 0;
+		rect.y = m_shelves[i].y;
+		rect.width = width;
+		rect.height = height;
+
+		m_shelves[i].free[0].x = width;
+		m_shelves[i].free[0].width = m_width - width;
+		if (m_shelves[i].free[0].width == 0)
+		{
+			m_shelves[i].free.clear();
+		}
+
+		return true;
+	}
+
+	// Open a new shelf below the others.
+	if (m_nextShelfY + shelfHeight > m_height)
+	{
+		return false;
+	}
+
+	shelf.y = m_nextShelfY;
+	shelf.height = shelfHeight;
+
+	span.x = width;
+	span.width = m_width - width;
+	if (span.width > 0)
+	{
+		shelf.free.push_back(span);
+	}
+
+	m_shelves.push_back(shelf);
+	m_nextShelfY += shelfHeight;
+
+	rect.x = 0;
+	rect.y = shelf.y;
+	rect.width = width;
+	rect.height = height;
+
+	return true;
+}
+
+void AtlasPacker::Free(const AtlasRect & rect)
+{
+	std::vector<Span>* free;
+	Span span;
+	int i, j;
+
+	for (i = 0; i < (int)m_shelves.size(); i++)
+	{
+		if (m_shelves[i].y != rect.y)
+		{
+			continue;
+		}
+
+		// Keep the free spans sorted by position so a span can merge with the ones on either side.
+		free = &m_shelves[i].free;
+		j = 0;
+		while (j < (int)free->size() && (*free)[j].x < rect.x)
+		{
+			j++;
+		}
+
+		span.x = rect.x;
+		span.width = rect.width;
+		free->insert(free->begin() + j, span);
+
+		if (j + 1 < (int)free->size() && (*free)[j].x + (*free)[j].width == (*free)[j + 1].x)
+		{
+			(*free)[j].width += (*free)[j + 1].width;
+			free->erase(free->begin() + j + 1);
+		}
+
+		if (j > 0 && (*free)[j - 1].x + (*free)[j - 1].width == (*free)[j].x)
+		{
+			(*free)[j - 1].width += (*free)[j].width;
+			free->erase(free->begin() + j);
+		}
+
+		return;
+	}
+}
+
+int AtlasPacker::GetShelfCount()
+{
+	return (int)m_shelves.size();
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include <vector>
+
+// Shelf heights are rounded up to this, so glyphs of similar height share shelves.
+#define ATLAS_SHELF_ALIGNMENT 8
+
+struct AtlasRect
+{
+	int x, y, width, height;
+};
+
+// Hands out rectangles of an atlas page on shelves that run across the page. Every shelf keeps a list of its free
+// spans, so freed rectangles are reused by later ones of the same shelf height and neighbouring free spans merge
+// again. Nothing in here touches Direct3D.
+class AtlasPacker
+{
+private:
+	struct Span
+	{
+		int x, width;
+	};
+
+	struct Shelf
+	{
+		int y, height;
+		std::vector<Span> free;
+	};
+
+	int m_width, m_height;
+	int m_nextShelfY;
+	std::vector<Shelf> m_shelves;
+public:
+	AtlasPacker();
+	~AtlasPacker();
+
+	void Initialize(int width, int height);
+	// Forgets every rectangle.
+	void Clear();
+
+	// Returns false when no shelf has room and there is no room left for a new one.
+	bool Allocate(int width, int height, AtlasRect& rect);
+	// Gives back a rectangle Allocate returned.
+	void Free(const AtlasRect& rect);
+
+	int GetShelfCount();
+};
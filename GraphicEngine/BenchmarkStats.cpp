@@ -0,0 +1,142 @@
+#include "BenchmarkStats.h"
+#include <math.h>
+#include <algorithm>
+
+float BenchmarkStats::Percentile(const std::vector<float>& sortedValues, float percentile)
+{
+	int rank;
+
+	if (sortedValues.empty())
+	{
+		return 0.0f;
+	}
+
+	rank = (int)ceilf(percentile / 100.0f * (float)sortedValues.size()) - 1;
+	if (rank < 0)
+	{
+		rank = 0;
+	}
+
+	if (rank > (int)sortedValues.size() - 1)
+	{
+		rank = (int)sortedValues.size() - 1;
+	}
+
+	return sortedValues[rank];
+}
+
+void BenchmarkStats::WriteStatistics(std::ofstream & fout, const char * name, std::vector<float>& values, bool last)
+{
+	double sum;
+	size_t i;
+
+	sum = 0.0;
+	for (i = 0; i < values.size(); i++)
+	{
+		sum += values[i];
+	}
+
+	std::sort(values.begin(), values.end());
+
+	fout << "\t\t\"" << name << "\": { ";
+	fout << "\"mean\": " << (values.empty() ? 0.0 : sum / values.size()) << ", ";
+	fout << "\"p50\": " << Percentile(values, 50.0f) << ", ";
+	fout << "\"p90\": " << Percentile(values, 90.0f) << ", ";
+	fout << "\"p95\": " << Percentile(values, 95.0f) << ", ";
+	fout << "\"p99\": " << Percentile(values, 99.0f) << ", ";
+	fout << "\"max\": " << (values.empty() ? 0.0f : values.back()) << " }";
+	fout << (last ? "\n" : ",\n");
+}
+
+void BenchmarkStats::WritePhase(std::ofstream & fout, const char * name, const std::vector<FrameTimings>& timings,
+	float FrameTimings::* phase, bool last)
+{
+	std::vector<float> values;
+	size_t i;
+
+	values.resize(timings.size());
+
+	for (i = 0; i < timings.size(); i++)
+	{
+		values[i] = timings[i].*phase;
+	}
+
+	WriteStatistics(fout, name, values, last);
+}
+
+void BenchmarkStats::WritePhases(std::ofstream & fout, const std::vector<FrameTimings>& timings)
+{
+	//All times are in milliseconds
+	fout << "\t\"phases\": {\n";
+	WritePhase(fout, "upload", timings, &FrameTimings::upload, false);
+	WritePhase(fout, "cull", timings, &FrameTimings::cull, false);
+	WritePhase(fout, "sort", timings, &FrameTimings::sort, false);
+	WritePhase(fout, "submit", timings, &FrameTimings::submit, false);
+	WritePhase(fout, "text", timings, &FrameTimings::text, false);
+	WritePhase(fout, "total", timings, &FrameTimings::total, true);
+	fout << "\t},\n";
+}
+
+void BenchmarkStats::WriteSubmission(std::ofstream & fout, const char * name, const std::vector<NullRenderCounters>& counters,
+	bool last)
+{
+	double draws, stateChanges, calls, bytesUploaded;
+	size_t i;
+
+	draws = stateChanges = calls = bytesUploaded = 0.0;
+	for (i = 0; i < counters.size(); i++)
+	{
+		draws += counters[i].draws;
+		stateChanges += counters[i].stateChanges;
+		calls += counters[i].calls;
+		bytesUploaded += (double)counters[i].bytesUploaded;
+	}
+
+	if (!counters.empty())
+	{
+		draws /= counters.size();
+		stateChanges /= counters.size();
+		calls /= counters.size();
+		bytesUploaded /= counters.size();
+	}
+
+	fout << "\t\"" << name << "\": {\n";
+	fout << "\t\t\"draws\": " << draws << ",\n";
+	fout << "\t\t\"stateChanges\": " << stateChanges << ",\n";
+	fout << "\t\t\"calls\": " << calls << ",\n";
+	fout << "\t\t\"bytesUploaded\": " << bytesUploaded << "\n";
+	fout << (last ? "\t}\n" : "\t},\n");
+}
+
+void BenchmarkStats::WriteMemory(std::ofstream & fout, int frames, long long heapAllocations, int allocatingFrames,
+	long long frameBytes, long long frameOverflows, bool last)
+{
+	double count;
+
+	//Per frame, a steady frame should not touch the heap at all
+	count = frames > 0 ? (double)frames : 1.0;
+
+	fout << "\t\"memory\": {\n";
+	fout << "\t\t\"heapAllocations\": " << (double)heapAllocations / count << ",\n";
+	fout << "\t\t\"allocatingFrames\": " << allocatingFrames << ",\n";
+	fout << "\t\t\"frameBytes\": " << (double)frameBytes / count << ",\n";
+	fout << "\t\t\"frameOverflows\": " << (double)frameOverflows / count << "\n";
+	fout << (last ? "\t}\n" : "\t},\n");
+}
+
+std::string BenchmarkStats::Escape(const std::string & text)
+{
+	std::string escaped;
+	size_t i;
+
+	for (i = 0; i < text.size(); i++)
+	{
+		if (text[i] == '\\' || text[i] == '"')
+		{
+			escaped += '\\';
+		}
+		escaped += text[i];
+	}
+
+	return escaped;
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include <fstream>
+#include <string>
+#include <vector>
+#include "Util.h"
+#include "FrameTimings.h"
+#include "NullRenderContext.h"
+
+// Writes the results of the engine benchmark and the headless benchmark, so both report their frames in the same
+// JSON. Statistics are the mean, the nearest rank percentiles and the maximum, in the unit the values came in. Every
+// entry ends with a comma unless last is set.
+class BenchmarkStats
+{
+public:
+	// Nearest rank, so every reported value is a frame that really happened. 0 when there are no values.
+	GRAPHIC_API static float Percentile(const std::vector<float>& sortedValues, float percentile);
+
+	// Sorts the values and writes their statistics as one member of an object.
+	GRAPHIC_API static void WriteStatistics(std::ofstream& fout, const char* name, std::vector<float>& values, bool last);
+	// The statistics of one phase over the frames.
+	GRAPHIC_API static void WritePhase(std::ofstream& fout, const char* name, const std::vector<FrameTimings>& timings,
+		float FrameTimings::* phase, bool last);
+	// Every phase of the frame timings as the phases object.
+	GRAPHIC_API static void WritePhases(std::ofstream& fout, const std::vector<FrameTimings>& timings);
+	// The average submission of a frame.
+	GRAPHIC_API static void WriteSubmission(std::ofstream& fout, const char* name, const std::vector<NullRenderCounters>& counters,
+		bool last);
+	// Heap allocations and frame memory as averages over the frames, and how many of the frames allocated at all.
+	GRAPHIC_API static void WriteMemory(std::ofstream& fout, int frames, long long heapAllocations, int allocatingFrames,
+		long long frameBytes, long long frameOverflows, bool last);
+
+	// The text as the contents of a JSON string, scene paths use backslashes on Windows.
+	GRAPHIC_API static std::string Escape(const std::string& text);
+};
@@ -1,46 +0,0 @@
-#pragma once
-#include <d3d11.h>
-#include <DirectXMath.h>
-
-#include "TextureAsset.h"
-
-using namespace std;
-using namespace DirectX;
-
-class Bitmap
-{
-private:
-	struct VertexType
-	{
-		XMFLOAT3 position;
-		XMFLOAT2 texture;
-	};
-
-	ID3D11Buffer *m_vertexBuffer, *m_indexBuffer;
-	int m_vertexCount, m_indexCount;
-	//TextureAsset* m_texture;
-
-	int m_screenWidth, m_screenHeight;
-	int m_bitmapWidth, m_bitmapHeight;
-	int m_previousPosX, m_previousPosY;
-
-	bool InitializeBuffers(ID3D11Device* device);
-	void ShutdownBuffers();
-	bool UpdateBuffers(ID3D11DeviceContext* deviceContext, int positionX, int positionY);
-	void RenderBuffers(ID3D11DeviceContext* deviceContext);
-
-	bool LoadTexture(ID3D11Device *device, ID3D11DeviceContext *deviceContext, char *filename);
-	void ReleaseTexture();
-
-public:
-	Bitmap();
-	Bitmap(const Bitmap&);
-	~Bitmap();
-
-	bool Initialize(ID3D11Device* device, ID3D11DeviceContext *deviceContext, int screenWidth, int screenHeight, char* textureFilename, int bitmapWidth, int bitmapHeight);
-	void Shutdown();
-	bool Render(ID3D11DeviceContext* deviceContext, int positionX, int positionY);
-
-	int GetIndexCount();
-	ID3D11ShaderResourceView* GetTexture();
-};
\ No newline at end of file
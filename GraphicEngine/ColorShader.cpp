@@ -189,7 +189,7 @@ void ColorShader::OutputShaderErrorMessage(ID3D10Blob* errorMessage, HWND hwnd,
 	MessageBox(hwnd, L"Error compiling shader.  Check shader-error.txt for message.", shaderFilename, MB_OK);
 }
 
-bool ColorShader::SetShaderParameters(ID3D11DeviceContext* deviceContext, XMMATRIX worldMatrix, XMMATRIX viewMatrix,
+bool ColorShader::SetShaderParameters(RenderContext* deviceContext, XMMATRIX worldMatrix, XMMATRIX viewMatrix,
 	XMMATRIX projectionMatrix)
 {
 	HRESULT result;
@@ -209,6 +209,8 @@ bool ColorShader::SetShaderParameters(ID3D11DeviceContext* deviceContext, XMMATR
 		return false;
 	}
 
+	Stats::Add(STAT_CONSTANT_BYTES, sizeof(MatrixBufferType));
+
 	// Get a pointer to the data in the constant buffer.
 	dataPtr = (MatrixBufferType*)mappedResource.pData;
 
@@ -229,7 +231,7 @@ bool ColorShader::SetShaderParameters(ID3D11DeviceContext* deviceContext, XMMATR
 	return true;
 }
 
-void ColorShader::RenderShader(ID3D11DeviceContext* deviceContext, int indexCount)
+void ColorShader::RenderShader(RenderContext* deviceContext, int indexCount, int baseVertex)
 {
 	// Set the vertex input layout.
 	deviceContext->IASetInputLayout(m_layout);
@@ -239,7 +241,7 @@ void ColorShader::RenderShader(ID3D11DeviceContext* deviceContext, int indexCoun
 	deviceContext->PSSetShader(m_pixelShader, NULL, 0);
 
 	// Render the triangle.
-	deviceContext->DrawIndexed(indexCount, 0, 0);
+	deviceContext->DrawIndexed(indexCount, 0, baseVertex);
 
 }
 
@@ -248,7 +250,7 @@ ColorShader::ColorShader()
 	m_vertexShader = 0;
 	m_pixelShader = 0;
 	m_layout = 0;
-	m_matrixBuffer;
+	m_matrixBuffer = 0;
 }
 
 ColorShader::ColorShader(const ColorShader & other)
@@ -280,7 +282,7 @@ void ColorShader::Shutdown()
 	ShutdownShader();
 }
 
-bool ColorShader::Render(ID3D11DeviceContext* deviceContext, int indexCount, XMMATRIX worldMatrix, XMMATRIX viewMatrix,
+bool ColorShader::Render(RenderContext* deviceContext, int indexCount, int baseVertex, XMMATRIX worldMatrix, XMMATRIX viewMatrix,
 	XMMATRIX projectionMatrix)
 {
 	bool result;
@@ -294,7 +296,7 @@ bool ColorShader::Render(ID3D11DeviceContext* deviceContext, int indexCount, XMM
 	}
 
 	// Now render the prepared buffers with the shader.
-	RenderShader(deviceContext, indexCount);
+	RenderShader(deviceContext, indexCount, baseVertex);
 
 	return true;
 }
@@ -3,6 +3,7 @@
 #include<d3dcompiler.h>
 #include<DirectXMath.h>
 #include<fstream>
+#include "RenderContext.h"
 using namespace DirectX;
 using namespace std;
 
@@ -25,9 +26,9 @@ private:
 	void ShutdownShader();
 	void OutputShaderErrorMessage(ID3D10Blob* errorMessage, HWND hwnd, WCHAR* shaderFilename);
 
-	bool SetShaderParameters(ID3D11DeviceContext* deviceContext, XMMATRIX worldMatrix, XMMATRIX viewMatrix,
+	bool SetShaderParameters(RenderContext* deviceContext, XMMATRIX worldMatrix, XMMATRIX viewMatrix,
 		XMMATRIX projectionMatrix);
-	void RenderShader(ID3D11DeviceContext* deviceContext, int indexCount);
+	void RenderShader(RenderContext* deviceContext, int indexCount, int baseVertex);
 public:
 	ColorShader();
 	ColorShader(const ColorShader& other);
@@ -35,7 +36,8 @@ public:
 
 	bool Initialize(ID3D11Device* device, HWND hwnd);
 	void Shutdown();
-	bool Render(ID3D11DeviceContext* deviceContext, int indexCount, XMMATRIX worldMatrix, XMMATRIX viewMatrix,
+	// The vertex buffer, index buffer and topology are set by the caller.
+	bool Render(RenderContext* deviceContext, int indexCount, int baseVertex, XMMATRIX worldMatrix, XMMATRIX viewMatrix,
 		XMMATRIX projectionMatrix);
 };
 
@@ -0,0 +1,356 @@
+#include "CommandRecorder.h"
+
+int SplitRecordChunks(int count, int maxChunks, int minChunkSize, RecordChunk* chunks)
+{
+	int chunkCount, size, remainder, first, i;
+
+	if (count <= 0 || maxChunks <= 0)
+	{
+		return 0;
+	}
+
+	// Use as many chunks as there are workers, but never make a chunk smaller than the minimum.
+	chunkCount = minChunkSize > 0 ? count / minChunkSize : count;
+	if (chunkCount > maxChunks)
+	{
+		chunkCount = maxChunks;
+	}
+
+	if (chunkCount < 1)
+	{
+		chunkCount = 1;
+	}
+
+	// Spread the remainder over the first chunks so they differ by at most one item.
+	size = count / chunkCount;
+	remainder = count % chunkCount;
+	first = 0;
+
+	for (i = 0; i < chunkCount; i++)
+	{
+		chunks[i].first = first;
+		chunks[i].count = size + (i < remainder ? 1 : 0);
+		first += chunks[i].count;
+	}
+
+	return chunkCount;
+}
+
+CommandRecorder::CommandRecorder()
+{
+	int i;
+
+	for (i = 0; i < COMMAND_RECORDER_MAX_WORKERS; i++)
+	{
+		m_workers[i].deferredContext = 0;
+		m_workers[i].stateCache = 0;
+		m_workers[i].commandList = 0;
+		m_workers[i].result = false;
+	}
+
+	m_workerCount = 0;
+	m_driverCommandLists = false;
+
+	m_chunkCount = 0;
+	m_function = 0;
+	m_userData = 0;
+
+	m_renderTarget = 0;
+	m_depthStencil = 0;
+	m_depthStencilState = 0;
+	m_stencilRef = 0;
+	m_blendState = 0;
+	m_sampleMask = 0xffffffff;
+	m_rasterState = 0;
+}
+
+CommandRecorder::CommandRecorder(const CommandRecorder & other)
+{
+}
+
+CommandRecorder::~CommandRecorder()
+{
+}
+
+bool CommandRecorder::Initialize(ID3D11Device * device, RenderContext * immediateContext, int workerCount)
+{
+	HRESULT result;
+	D3D11_FEATURE_DATA_THREADING threading;
+	int i;
+
+	if (workerCount > COMMAND_RECORDER_MAX_WORKERS)
+	{
+		workerCount = COMMAND_RECORDER_MAX_WORKERS;
+	}
+
+	// The runtime emulates command lists when the driver does not record them itself, which still works but saves less.
+	m_driverCommandLists = false;
+	result = device->CheckFeatureSupport(D3D11_FEATURE_THREADING, &threading, sizeof(threading));
+	if (SUCCEEDED(result))
+	{
+		m_driverCommandLists = threading.DriverCommandLists != 0;
+	}
+
+	// Create a deferred context of the same backend and a state cache in front of it for every worker.
+	for (i = 0; i < workerCount; i++)
+	{
+		m_workers[i].deferredContext = immediateContext->CreateDeferredContext();
+		if (!m_workers[i].deferredContext)
+		{
+			return false;
+		}
+
+		m_workers[i].stateCache = new RenderStateCache;
+		if (!m_workers[i].stateCache)
+		{
+			return false;
+		}
+
+		m_workers[i].stateCache->Initialize(m_workers[i].deferredContext);
+	}
+
+	m_workerCount = workerCount;
+
+	return true;
+}
+
+void CommandRecorder::Shutdown()
+{
+	int i;
+
+	// Release the command lists, state caches and deferred contexts.
+	for (i = 0; i < COMMAND_RECORDER_MAX_WORKERS; i++)
+	{
+		if (m_workers[i].commandList)
+		{
+			m_workers[i].commandList->Release();
+			m_workers[i].commandList = 0;
+		}
+
+		if (m_workers[i].stateCache)
+		{
+			m_workers[i].stateCache->Shutdown();
+			delete m_workers[i].stateCache;
+			m_workers[i].stateCache = 0;
+		}
+
+		if (m_workers[i].deferredContext)
+		{
+			m_workers[i].deferredContext->Shutdown();
+			delete m_workers[i].deferredContext;
+			m_workers[i].deferredContext = 0;
+		}
+	}
+
+	ReleaseOutputState();
+
+	m_workerCount = 0;
+	m_chunkCount = 0;
+}
+
+void CommandRecorder::RecordWorkerChunks(void * data, int begin, int end)
+{
+	CommandRecorder* recorder;
+	int i;
+
+	recorder = (CommandRecorder*)data;
+
+	for (i = begin; i < end; i++)
+	{
+		recorder->RecordWorkerChunk(i);
+	}
+}
+
+void CommandRecorder::RecordWorkerChunk(int index)
+{
+	PROFILE_ZONE("CommandRecorder::RecordWorkerChunk");
+	Worker& worker = m_workers[index];
+	RenderContext* context;
+	HRESULT result;
+
+	context = worker.deferredContext;
+
+	// A deferred context starts every command list with default state, so set up the output first.
+	context->OMSetRenderTargets(1, &m_renderTarget, m_depthStencil);
+	context->OMSetDepthStencilState(m_depthStencilState, m_stencilRef);
+	context->OMSetBlendState(m_blendState, m_blendFactor, m_sampleMask);
+	context->RSSetState(m_rasterState);
+	context->RSSetViewports(1, &m_viewport);
+
+	worker.stateCache->Invalidate();
+	worker.stateCache->ResetCounters();
+
+	worker.result = m_function(m_userData, worker.stateCache, m_chunks[index]);
+
+	worker.counters = worker.stateCache->GetCounters();
+
+	// Close the command list even after a failure so the context is ready for the next frame.
+	result = context->FinishCommandList(FALSE, &worker.commandList);
+	if (FAILED(result))
+	{
+		worker.commandList = 0;
+		worker.result = false;
+	}
+}
+
+void CommandRecorder::CaptureOutputState(RenderContext * immediateContext)
+{
+	unsigned int viewportCount;
+
+	// Every get call adds a reference, they are released again after recording.
+	immediateContext->OMGetRenderTargets(1, &m_renderTarget, &m_depthStencil);
+	immediateContext->OMGetDepthStencilState(&m_depthStencilState, &m_stencilRef);
+	immediateContext->OMGetBlendState(&m_blendState, m_blendFactor, &m_sampleMask);
+	immediateContext->RSGetState(&m_rasterState);
+
+	viewportCount = 1;
+	immediateContext->RSGetViewports(&viewportCount, &m_viewport);
+}
+
+void CommandRecorder::ReleaseOutputState()
+{
+	if (m_renderTarget)
+	{
+		m_renderTarget->Release();
+		m_renderTarget = 0;
+	}
+
+	if (m_depthStencil)
+	{
+		m_depthStencil->Release();
+		m_depthStencil = 0;
+	}
+
+	if (m_depthStencilState)
+	{
+		m_depthStencilState->Release();
+		m_depthStencilState = 0;
+	}
+
+	if (m_blendState)
+	{
+		m_blendState->Release();
+		m_blendState = 0;
+	}
+
+	if (m_rasterState)
+	{
+		m_rasterState->Release();
+		m_rasterState = 0;
+	}
+}
+
+bool CommandRecorder::Record(RenderContext * immediateContext, int count, RecordFunction function, void * userData)
+{
+	bool result;
+	int i;
+
+	if (m_workerCount == 0)
+	{
+		return false;
+	}
+
+	// Drop command lists that were recorded but never executed.
+	for (i = 0; i < m_chunkCount; i++)
+	{
+		if (m_workers[i].commandList)
+		{
+			m_workers[i].commandList->Release();
+			m_workers[i].commandList = 0;
+		}
+	}
+
+	CaptureOutputState(immediateContext);
+
+	// Record every chunk as a job of its own and wait for all of them.
+	m_chunkCount = SplitRecordChunks(count, m_workerCount, COMMAND_RECORDER_MIN_CHUNK, m_chunks);
+	m_function = function;
+	m_userData = userData;
+
+	JobSystem::ParallelFor(m_chunkCount, 1, RecordWorkerChunks, this);
+
+	ReleaseOutputState();
+
+	result = true;
+	for (i = 0; i < m_chunkCount; i++)
+	{
+		result = result && m_workers[i].result;
+	}
+
+	if (!result)
+	{
+		for (i = 0; i < m_chunkCount; i++)
+		{
+			if (m_workers[i].commandList)
+			{
+				m_workers[i].commandList->Release();
+				m_workers[i].commandList = 0;
+			}
+		}
+
+		m_chunkCount = 0;
+	}
+
+	return result;
+}
+
+void CommandRecorder::Execute(RenderContext * immediateContext)
+{
+	int i;
+
+	// Play the chunks back in order and restore the immediate context state after each one, so the state
+	// cache of the immediate context stays valid.
+	for (i = 0; i < m_chunkCount; i++)
+	{
+		if (m_workers[i].commandList)
+		{
+			immediateContext->ExecuteCommandList(m_workers[i].commandList, TRUE);
+
+			m_workers[i].commandList->Release();
+			m_workers[i].commandList = 0;
+		}
+	}
+}
+
+void CommandRecorder::MergeCounters(RenderStateCache * stateCache)
+{
+	int i;
+
+	for (i = 0; i < m_chunkCount; i++)
+	{
+		stateCache->AddCounters(m_workers[i].counters);
+	}
+}
+
+int CommandRecorder::GetWorkerCount()
+{
+	return m_workerCount;
+}
+
+int CommandRecorder::GetChunkCount()
+{
+	return m_chunkCount;
+}
+
+bool CommandRecorder::HasDriverCommandLists()
+{
+	return m_driverCommandLists;
+}
+
+int CommandRecorder::GetDefaultWorkerCount()
+{
+	int count;
+
+	count = JobSystem::GetWorkerCount();
+	if (count > 0)
+	{
+		count++;
+	}
+
+	if (count > COMMAND_RECORDER_MAX_WORKERS)
+	{
+		count = COMMAND_RECORDER_MAX_WORKERS;
+	}
+
+	return count;
+}
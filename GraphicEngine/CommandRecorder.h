@@ -0,0 +1,95 @@
+#pragma once
+#include <d3d11.h>
+#include "RenderStateCache.h"
+#include "RenderContext.h"
+#include "JobSystem.h"
+#include "Profiler.h"
+
+#define COMMAND_RECORDER_MAX_WORKERS 8
+
+// Below this many items a chunk costs more to record and play back than it saves.
+#define COMMAND_RECORDER_MIN_CHUNK 32
+
+// A contiguous range of the items that one deferred context records.
+struct RecordChunk
+{
+	int first;
+	int count;
+};
+
+// Splits count items into at most maxChunks contiguous chunks of at least minChunkSize items, except when there
+// are fewer items than that in total. Chunks are in item order and differ in size by at most one. Returns the
+// number of chunks.
+int SplitRecordChunks(int count, int maxChunks, int minChunkSize, RecordChunk* chunks);
+
+// Records the items of one chunk through the state cache of a worker, which starts out with nothing bound
+// except the output state of the immediate context.
+typedef bool(*RecordFunction)(void* userData, RenderStateCache* stateCache, const RecordChunk& chunk);
+
+// Records draws into deferred contexts on the job system. Record splits the items into one chunk per worker, every
+// chunk is a job that records into the command list of its worker, and Execute plays the command lists back on the
+// immediate context in chunk order, so the result is the same as recording everything on one thread. A worker is
+// a deferred context with a state cache in front of it, not a thread.
+class CommandRecorder
+{
+private:
+	struct Worker
+	{
+		RenderContext* deferredContext;
+		RenderStateCache* stateCache;
+		ID3D11CommandList* commandList;
+		RenderStateCounters counters;
+		bool result;
+	};
+
+	Worker m_workers[COMMAND_RECORDER_MAX_WORKERS];
+	int m_workerCount;
+	bool m_driverCommandLists;
+
+	RecordChunk m_chunks[COMMAND_RECORDER_MAX_WORKERS];
+	int m_chunkCount;
+	RecordFunction m_function;
+	void* m_userData;
+
+	// Output state of the immediate context, every deferred context starts from it.
+	ID3D11RenderTargetView* m_renderTarget;
+	ID3D11DepthStencilView* m_depthStencil;
+	ID3D11DepthStencilState* m_depthStencilState;
+	unsigned int m_stencilRef;
+	ID3D11BlendState* m_blendState;
+	float m_blendFactor[4];
+	unsigned int m_sampleMask;
+	ID3D11RasterizerState* m_rasterState;
+	D3D11_VIEWPORT m_viewport;
+
+	static void RecordWorkerChunks(void* data, int begin, int end);
+	void RecordWorkerChunk(int index);
+	void CaptureOutputState(RenderContext* immediateContext);
+	void ReleaseOutputState();
+public:
+	CommandRecorder();
+	CommandRecorder(const CommandRecorder&);
+	~CommandRecorder();
+
+	// A worker count of zero leaves the recorder without deferred contexts, Record then always fails.
+	bool Initialize(ID3D11Device* device, RenderContext* immediateContext, int workerCount);
+	void Shutdown();
+
+	// Records count items on the workers and waits until all of them are done. Returns false if any chunk failed,
+	// the command lists that were recorded are dropped in that case.
+	bool Record(RenderContext* immediateContext, int count, RecordFunction function, void* userData);
+	// Plays back the command lists of the last Record in order. The state of the immediate context is kept.
+	void Execute(RenderContext* immediateContext);
+
+	// Adds the state changes and draws of the workers during the last Record to a state cache.
+	void MergeCounters(RenderStateCache* stateCache);
+
+	int GetWorkerCount();
+	int GetChunkCount();
+	// False when the runtime emulates command lists because the driver does not support them.
+	bool HasDriverCommandLists();
+
+	// One worker per thread of the job system, the thread that records waits for the chunks and records some of
+	// them. Zero without job system workers, recording on one thread is slower than drawing directly.
+	static int GetDefaultWorkerCount();
+};
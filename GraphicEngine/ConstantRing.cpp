@@ -0,0 +1,229 @@
+#include "ConstantRing.h"
+
+ConstantRing::ConstantRing()
+{
+	m_buffer = 0;
+	m_drawBuffer = 0;
+	m_shadow = 0;
+	m_mapped = 0;
+	m_size = 0;
+	m_maxAllocation = 0;
+	m_head = 0;
+	m_reservedEnd = 0;
+	m_useOffsets = false;
+	m_mapCount = 0;
+}
+
+ConstantRing::ConstantRing(const ConstantRing & other)
+{
+}
+
+ConstantRing::~ConstantRing()
+{
+}
+
+bool ConstantRing::Initialize(ID3D11Device * device, RenderStateCache * stateCache, unsigned int size, unsigned int maxAllocation)
+{
+	HRESULT result;
+	D3D11_FEATURE_DATA_D3D11_OPTIONS options;
+	D3D11_BUFFER_DESC bufferDesc;
+
+	m_size = Align(size);
+	m_maxAllocation = Align(maxAllocation);
+	m_head = 0;
+	m_reservedEnd = 0;
+
+	// Offsets need the 11.1 context and a driver that allows them together with no overwrite maps of constant buffers.
+	m_useOffsets = false;
+	if (stateCache->SupportsConstantOffsets())
+	{
+		result = device->CheckFeatureSupport(D3D11_FEATURE_D3D11_OPTIONS, &options, sizeof(options));
+		if (SUCCEEDED(result))
+		{
+			m_useOffsets = options.ConstantBufferOffsetting && options.MapNoOverwriteOnDynamicConstantBuffer;
+		}
+	}
+
+	bufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+	bufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+	bufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+	bufferDesc.MiscFlags = 0;
+	bufferDesc.StructureByteStride = 0;
+
+	if (m_useOffsets)
+	{
+		// Create the ring itself.
+		bufferDesc.ByteWidth = m_size;
+
+		result = device->CreateBuffer(&bufferDesc, NULL, &m_buffer);
+		if (FAILED(result))
+		{
+			return false;
+		}
+	}
+	else
+	{
+		// Collect the constants in memory and create the buffer every draw copies its part into.
+		m_shadow = new unsigned char[m_size];
+		if (!m_shadow)
+		{
+			return false;
+		}
+
+		bufferDesc.ByteWidth = m_maxAllocation;
+
+		result = device->CreateBuffer(&bufferDesc, NULL, &m_drawBuffer);
+		if (FAILED(result))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void ConstantRing::Shutdown()
+{
+	// Release the per draw buffer and its memory copy.
+	if (m_drawBuffer)
+	{
+		m_drawBuffer->Release();
+		m_drawBuffer = 0;
+	}
+
+	if (m_shadow)
+	{
+		delete[] m_shadow;
+		m_shadow = 0;
+	}
+
+	// Release the ring.
+	if (m_buffer)
+	{
+		m_buffer->Release();
+		m_buffer = 0;
+	}
+
+	m_mapped = 0;
+}
+
+bool ConstantRing::Map(RenderContext * deviceContext, unsigned int size)
+{
+	HRESULT result;
+	D3D11_MAPPED_SUBRESOURCE mappedResource;
+	D3D11_MAP mapType;
+
+	size = Align(size);
+	if (size > m_size)
+	{
+		return false;
+	}
+
+	if (!m_useOffsets)
+	{
+		// The memory copy is only read while this frame is drawn, so it can always start at the front.
+		m_mapped = m_shadow;
+		m_head = 0;
+		m_reservedEnd = size;
+		return true;
+	}
+
+	// Append behind the constants of earlier frames the gpu may still read, or start over on a fresh buffer.
+	mapType = D3D11_MAP_WRITE_NO_OVERWRITE;
+	if (m_head + size > m_size)
+	{
+		mapType = D3D11_MAP_WRITE_DISCARD;
+		m_head = 0;
+	}
+
+	result = deviceContext->Map(m_buffer, 0, mapType, 0, &mappedResource);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	m_mapped = (unsigned char*)mappedResource.pData;
+	m_reservedEnd = m_head + size;
+	m_mapCount++;
+
+	// Only the reserved range is written, not the whole ring.
+	Stats::Add(STAT_CONSTANT_BYTES, size);
+
+	return true;
+}
+
+void * ConstantRing::Allocate(unsigned int size, unsigned int & offset)
+{
+	size = Align(size);
+	if (!m_mapped || m_head + size > m_reservedEnd)
+	{
+		return 0;
+	}
+
+	offset = m_head;
+	m_head += size;
+
+	return m_mapped + offset;
+}
+
+void ConstantRing::Unmap(RenderContext * deviceContext)
+{
+	if (m_useOffsets && m_mapped)
+	{
+		deviceContext->Unmap(m_buffer, 0);
+	}
+
+	m_mapped = 0;
+}
+
+bool ConstantRing::BindVS(RenderStateCache * stateCache, unsigned int slot, unsigned int offset, unsigned int size)
+{
+	HRESULT result;
+	D3D11_MAPPED_SUBRESOURCE mappedResource;
+
+	size = Align(size);
+
+	if (m_useOffsets)
+	{
+		stateCache->SetVSConstantBufferRange(slot, m_buffer, offset / 16, size / 16);
+		return true;
+	}
+
+	// Copy the allocation into the per draw buffer, this is the map per draw the ring avoids.
+	result = stateCache->GetRenderContext()->Map(m_drawBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	memcpy(mappedResource.pData, m_shadow + offset, size);
+	Stats::Add(STAT_CONSTANT_BYTES, size);
+
+	stateCache->GetRenderContext()->Unmap(m_drawBuffer, 0);
+
+	m_mapCount++;
+
+	stateCache->SetVSConstantBuffer(slot, m_drawBuffer);
+
+	return true;
+}
+
+unsigned int ConstantRing::Align(unsigned int size)
+{
+	return (size + CONSTANT_RING_ALIGNMENT - 1) & ~(CONSTANT_RING_ALIGNMENT - 1);
+}
+
+bool ConstantRing::UsesOffsets()
+{
+	return m_useOffsets;
+}
+
+int ConstantRing::GetMapCount()
+{
+	return m_mapCount;
+}
+
+void ConstantRing::ResetMapCount()
+{
+	m_mapCount = 0;
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include <d3d11.h>
+#include "RenderStateCache.h"
+
+// Offsets into the ring have to be a multiple of 16 constants.
+#define CONSTANT_RING_ALIGNMENT 256
+
+// Sub-allocates per object constants from one large dynamic constant buffer. A frame reserves its range
+// with a single Map, using WRITE_NO_OVERWRITE while the range fits behind the data of earlier frames and
+// WRITE_DISCARD when the ring wraps around. Draws then bind their part with VSSetConstantBuffers1.
+// Without the 11.1 runtime the constants are collected in memory and copied into a small buffer per draw.
+class ConstantRing
+{
+private:
+	ID3D11Buffer* m_buffer;
+	ID3D11Buffer* m_drawBuffer;
+	unsigned char* m_shadow;
+	unsigned char* m_mapped;
+	unsigned int m_size;
+	unsigned int m_maxAllocation;
+	unsigned int m_head;
+	unsigned int m_reservedEnd;
+	bool m_useOffsets;
+	int m_mapCount;
+public:
+	ConstantRing();
+	ConstantRing(const ConstantRing&);
+	~ConstantRing();
+
+	// maxAllocation is the largest single allocation, used for the per draw buffer of the fallback path.
+	bool Initialize(ID3D11Device* device, RenderStateCache* stateCache, unsigned int size, unsigned int maxAllocation);
+	void Shutdown();
+
+	// Reserves size bytes for the allocations that follow, they have to be written before Unmap.
+	bool Map(RenderContext* deviceContext, unsigned int size);
+	void* Allocate(unsigned int size, unsigned int& offset);
+	void Unmap(RenderContext* deviceContext);
+
+	// Binds an allocation to a vertex shader slot.
+	bool BindVS(RenderStateCache* stateCache, unsigned int slot, unsigned int offset, unsigned int size);
+
+	// Rounds a size up to the granularity of the ring.
+	static unsigned int Align(unsigned int size);
+
+	bool UsesOffsets();
+	int GetMapCount();
+	void ResetMapCount();
+};
@@ -7,10 +7,15 @@ D3D::D3D()
 	m_swapChain = 0;
 	m_device = 0;
 	m_deviceContext = 0;
+	m_renderContext = 0;
+	m_nullContext = 0;
+	m_headless = false;
+	m_renderTargetBuffer = 0;
 	m_renderTargetView = 0;
 	m_depthStencilBuffer = 0;
 	m_depthStencilState = 0;
 	m_depthStencilView = 0;
+	m_depthShaderResourceView = 0;
 	m_rasterState = 0;
 	m_depthDisabledStencilState = 0;
 	m_alphaDisableBlendingState = 0;
@@ -38,17 +43,10 @@ bool D3D::Initialize(int screenWidth, int screenHeight, bool vsync, HWND hwnd, b
 	DXGI_SWAP_CHAIN_DESC swapChainDesc;
 	D3D_FEATURE_LEVEL featureLevel;
 	ID3D11Texture2D* backBufferPtr;
-	D3D11_TEXTURE2D_DESC depthBufferDesc;
-	D3D11_DEPTH_STENCIL_DESC depthStencilDesc;
-	D3D11_DEPTH_STENCIL_VIEW_DESC depthStencilViewDesc;
-	D3D11_RASTERIZER_DESC rasterDesc;
-	D3D11_VIEWPORT viewport;
-	float fieldOfView, screenAspect;
-	D3D11_DEPTH_STENCIL_DESC depthDisabledStencilDesc;
-	D3D11_BLEND_DESC blendStateDescription;
 
 	// Store the vsync setting.
 	m_vsync_enabled = vsync;
+	m_headless = false;
 
 	// Create a DirectX graphics interface factory.
 	result = CreateDXGIFactory(__uuidof(IDXGIFactory), (void**)&factory);
@@ -223,6 +221,103 @@ bool D3D::Initialize(int screenWidth, int screenHeight, bool vsync, HWND hwnd, b
 	backBufferPtr->Release();
 	backBufferPtr = 0;
 
+	return InitializeOutput(screenWidth, screenHeight, screenDepth, screenNear, false);
+}
+
+bool D3D::InitializeHeadless(int screenWidth, int screenHeight, float screenDepth, float screenNear)
+{
+	HRESULT result;
+	D3D_FEATURE_LEVEL featureLevel;
+	D3D11_TEXTURE2D_DESC renderTargetDesc;
+
+	m_vsync_enabled = false;
+	m_headless = true;
+	m_videoCardMemory = 0;
+	strcpy_s(m_videoCardDescription, 128, "Headless");
+
+	// Set the feature level to DirectX 11.
+	featureLevel = D3D_FEATURE_LEVEL_11_0;
+
+	// Create the device without a window or swap chain, the software rasterizer will do where there is no video card.
+	// Resources are real so the engine can create them as usual, only the submission goes to the null context.
+	result = D3D11CreateDevice(NULL, D3D_DRIVER_TYPE_HARDWARE, NULL, 0, &featureLevel, 1, D3D11_SDK_VERSION, &m_device, NULL,
+		&m_deviceContext);
+	if (FAILED(result))
+	{
+		result = D3D11CreateDevice(NULL, D3D_DRIVER_TYPE_WARP, NULL, 0, &featureLevel, 1, D3D11_SDK_VERSION, &m_device, NULL,
+			&m_deviceContext);
+		if (FAILED(result))
+		{
+			return false;
+		}
+	}
+
+	// Create a texture that stands in for the back buffer.
+	ZeroMemory(&renderTargetDesc, sizeof(renderTargetDesc));
+	renderTargetDesc.Width = screenWidth;
+	renderTargetDesc.Height = screenHeight;
+	renderTargetDesc.MipLevels = 1;
+	renderTargetDesc.ArraySize = 1;
+	renderTargetDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+	renderTargetDesc.SampleDesc.Count = 1;
+	renderTargetDesc.SampleDesc.Quality = 0;
+	renderTargetDesc.Usage = D3D11_USAGE_DEFAULT;
+	renderTargetDesc.BindFlags = D3D11_BIND_RENDER_TARGET;
+
+	result = m_device->CreateTexture2D(&renderTargetDesc, NULL, &m_renderTargetBuffer);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	// Create the render target view of the stand in back buffer.
+	result = m_device->CreateRenderTargetView(m_renderTargetBuffer, NULL, &m_renderTargetView);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	return InitializeOutput(screenWidth, screenHeight, screenDepth, screenNear, true);
+}
+
+bool D3D::InitializeOutput(int screenWidth, int screenHeight, float screenDepth, float screenNear, bool headless)
+{
+	HRESULT result;
+	D3D11RenderContext* renderContext;
+	D3D11_TEXTURE2D_DESC depthBufferDesc;
+	D3D11_DEPTH_STENCIL_DESC depthStencilDesc;
+	D3D11_DEPTH_STENCIL_VIEW_DESC depthStencilViewDesc;
+	D3D11_SHADER_RESOURCE_VIEW_DESC depthShaderResourceViewDesc;
+	D3D11_RASTERIZER_DESC rasterDesc;
+	D3D11_VIEWPORT viewport;
+	float fieldOfView, screenAspect;
+	D3D11_DEPTH_STENCIL_DESC depthDisabledStencilDesc;
+	D3D11_BLEND_DESC blendStateDescription;
+
+	// Everything the engine submits goes through the render context, which only counts the calls when headless.
+	if (headless)
+	{
+		m_nullContext = new NullRenderContext;
+		if (!m_nullContext)
+		{
+			return false;
+		}
+
+		m_nullContext->Initialize();
+		m_renderContext = m_nullContext;
+	}
+	else
+	{
+		renderContext = new D3D11RenderContext;
+		if (!renderContext)
+		{
+			return false;
+		}
+
+		renderContext->Initialize(m_deviceContext);
+		m_renderContext = renderContext;
+	}
+
 	// Initialize the description of the depth buffer.
 	ZeroMemory(&depthBufferDesc, sizeof(depthBufferDesc));
 
@@ -231,11 +326,11 @@ bool D3D::Initialize(int screenWidth, int screenHeight, bool vsync, HWND hwnd, b
 	depthBufferDesc.Height = screenHeight;
 	depthBufferDesc.MipLevels = 1;
 	depthBufferDesc.ArraySize = 1;
-	depthBufferDesc.Format = DXGI_FORMAT_D24_UNORM_S8_UINT;
+	depthBufferDesc.Format = DXGI_FORMAT_R24G8_TYPELESS;
 	depthBufferDesc.SampleDesc.Count = 1;
 	depthBufferDesc.SampleDesc.Quality = 0;
 	depthBufferDesc.Usage = D3D11_USAGE_DEFAULT;
-	depthBufferDesc.BindFlags = D3D11_BIND_DEPTH_STENCIL;
+	depthBufferDesc.BindFlags = D3D11_BIND_DEPTH_STENCIL | D3D11_BIND_SHADER_RESOURCE;
 	depthBufferDesc.CPUAccessFlags = 0;
 	depthBufferDesc.MiscFlags = 0;
 
@@ -278,7 +373,7 @@ bool D3D::Initialize(int screenWidth, int screenHeight, bool vsync, HWND hwnd, b
 	}
 
 	// Set the depth stencil state.
-	m_deviceContext->OMSetDepthStencilState(m_depthStencilState, 1);
+	m_renderContext->OMSetDepthStencilState(m_depthStencilState, 1);
 
 	// Initialize the depth stencil view.
 	ZeroMemory(&depthStencilViewDesc, sizeof(depthStencilViewDesc));
@@ -295,8 +390,22 @@ bool D3D::Initialize(int screenWidth, int screenHeight, bool vsync, HWND hwnd, b
 		return false;
 	}
 
+	// Set up a view that reads the depth part of the buffer, used by the light culling pass.
+	ZeroMemory(&depthShaderResourceViewDesc, sizeof(depthShaderResourceViewDesc));
+	depthShaderResourceViewDesc.Format = DXGI_FORMAT_R24_UNORM_X8_TYPELESS;
+	depthShaderResourceViewDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
+	depthShaderResourceViewDesc.Texture2D.MostDetailedMip = 0;
+	depthShaderResourceViewDesc.Texture2D.MipLevels = 1;
+
+	// Create the depth shader resource view.
+	result = m_device->CreateShaderResourceView(m_depthStencilBuffer, &depthShaderResourceViewDesc, &m_depthShaderResourceView);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
 	// Bind the render target view and depth stencil buffer to the output render pipeline.
-	m_deviceContext->OMSetRenderTargets(1, &m_renderTargetView, m_depthStencilView);
+	m_renderContext->OMSetRenderTargets(1, &m_renderTargetView, m_depthStencilView);
 
 	// Setup the raster description which will determine how and what polygons will be drawn.
 	rasterDesc.AntialiasedLineEnable = false;
@@ -318,7 +427,7 @@ bool D3D::Initialize(int screenWidth, int screenHeight, bool vsync, HWND hwnd, b
 	}
 
 	// Now set the rasterizer state.
-	m_deviceContext->RSSetState(m_rasterState);
+	m_renderContext->RSSetState(m_rasterState);
 
 	// Setup the viewport for rendering.
 	viewport.Width = (float)screenWidth;
@@ -329,7 +438,7 @@ bool D3D::Initialize(int screenWidth, int screenHeight, bool vsync, HWND hwnd, b
 	viewport.TopLeftY = 0.0f;
 
 	// Create the viewport.
-	m_deviceContext->RSSetViewports(1, &viewport);
+	m_renderContext->RSSetViewports(1, &viewport);
 
 	// Setup the projection matrix.
 	fieldOfView = 3.141592654f / 4.0f;
@@ -442,6 +551,12 @@ void D3D::Shutdown()
 		m_rasterState = 0;
 	}
 
+	if (m_depthShaderResourceView)
+	{
+		m_depthShaderResourceView->Release();
+		m_depthShaderResourceView = 0;
+	}
+
 	if (m_depthStencilView)
 	{
 		m_depthStencilView->Release();
@@ -466,6 +581,20 @@ void D3D::Shutdown()
 		m_renderTargetView = 0;
 	}
 
+	if (m_renderTargetBuffer)
+	{
+		m_renderTargetBuffer->Release();
+		m_renderTargetBuffer = 0;
+	}
+
+	if (m_renderContext)
+	{
+		m_renderContext->Shutdown();
+		delete m_renderContext;
+		m_renderContext = 0;
+		m_nullContext = 0;
+	}
+
 	if (m_deviceContext)
 	{
 		m_deviceContext->Release();
@@ -496,15 +625,21 @@ void D3D::BeginScene(float red, float green, float blue, float alpha)
 	color[3] = alpha;
 
 	//Clear the back buffer
-	m_deviceContext->ClearRenderTargetView(m_renderTargetView, color);
+	m_renderContext->ClearRenderTargetView(m_renderTargetView, color);
 
 	//Clear the depth buffer
-	m_deviceContext->ClearDepthStencilView(m_depthStencilView, D3D11_CLEAR_DEPTH, 1.0f, 0);
+	m_renderContext->ClearDepthStencilView(m_depthStencilView, D3D11_CLEAR_DEPTH, 1.0f, 0);
 
 }
 
 void D3D::EndScene()
 {
+	//There is no screen to present to without a window
+	if (m_headless)
+	{
+		return;
+	}
+
 	//Present the bacl buffer to the screen since rendering is complete
 	if (m_vsync_enabled)
 	{
@@ -528,6 +663,40 @@ ID3D11DeviceContext * D3D::GetDeviceContext()
 	return m_deviceContext;
 }
 
+RenderContext * D3D::GetRenderContext()
+{
+	return m_renderContext;
+}
+
+bool D3D::IsHeadless()
+{
+	return m_headless;
+}
+
+NullRenderContext * D3D::GetNullRenderContext()
+{
+	return m_nullContext;
+}
+
+ID3D11ShaderResourceView * D3D::GetDepthShaderResourceView()
+{
+	return m_depthShaderResourceView;
+}
+
+void D3D::SetBackBufferRenderTarget()
+{
+	//Bind the render target view and depth stencil buffer to the output render pipeline
+	m_renderContext->OMSetRenderTargets(1, &m_renderTargetView, m_depthStencilView);
+}
+
+void D3D::GetRenderTargets(RenderTargets & targets)
+{
+	targets.renderTarget = m_renderTargetView;
+	targets.depthStencil = m_depthStencilView;
+	targets.depthView = m_depthShaderResourceView;
+	targets.depthState = m_depthStencilState;
+}
+
 void D3D::GetProjectionMatrix(XMMATRIX &projectionMatrix)
 {
 	projectionMatrix = m_projectionMatrix;
@@ -551,12 +720,12 @@ void D3D::GetVideoCardInfo(char *cardName, int &memory)
 
 void D3D::TurnZBufferOn()
 {
-	m_deviceContext->OMSetDepthStencilState(m_depthStencilState, 1);
+	m_renderContext->OMSetDepthStencilState(m_depthStencilState, 1);
 }
 
 void D3D::TurnZBufferOff()
 {
-	m_deviceContext->OMSetDepthStencilState(m_depthDisabledStencilState, 1);
+	m_renderContext->OMSetDepthStencilState(m_depthDisabledStencilState, 1);
 }
 
 void D3D::TurnOnAlphaBlending()
@@ -571,7 +740,7 @@ void D3D::TurnOnAlphaBlending()
 	blendFactor[3] = 0.0f;
 
 	// Turn on the alpha blending.
-	m_deviceContext->OMSetBlendState(m_alphaEnableBlendingState, blendFactor, 0xffffffff);
+	m_renderContext->OMSetBlendState(m_alphaEnableBlendingState, blendFactor, 0xffffffff);
 }
 
 void D3D::TurnOffAlphaBlending()
@@ -586,5 +755,5 @@ void D3D::TurnOffAlphaBlending()
 	blendFactor[3] = 0.0f;
 
 	// Turn off the alpha blending.
-	m_deviceContext->OMSetBlendState(m_alphaDisableBlendingState, blendFactor, 0xffffffff);
+	m_renderContext->OMSetBlendState(m_alphaDisableBlendingState, blendFactor, 0xffffffff);
 }
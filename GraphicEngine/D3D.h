@@ -6,6 +6,8 @@
 
 #include <d3d11.h>
 #include <DirectXMath.h>
+#include "D3D11RenderContext.h"
+#include "NullRenderContext.h"
 using namespace DirectX;
 
 class D3D
@@ -17,10 +19,15 @@ private:
 	IDXGISwapChain* m_swapChain;
 	ID3D11Device* m_device;
 	ID3D11DeviceContext* m_deviceContext;
+	RenderContext* m_renderContext;
+	NullRenderContext* m_nullContext;
+	bool m_headless;
+	ID3D11Texture2D* m_renderTargetBuffer;
 	ID3D11RenderTargetView* m_renderTargetView;
 	ID3D11Texture2D* m_depthStencilBuffer;
 	ID3D11DepthStencilState* m_depthStencilState;
 	ID3D11DepthStencilView* m_depthStencilView;
+	ID3D11ShaderResourceView* m_depthShaderResourceView;
 	ID3D11RasterizerState* m_rasterState;
 	XMMATRIX m_projectionMatrix;
 	XMMATRIX m_worldMatrix;
@@ -29,6 +36,8 @@ private:
 	ID3D11DepthStencilState* m_depthDisabledStencilState;
 	ID3D11BlendState* m_alphaEnableBlendingState;
 	ID3D11BlendState* m_alphaDisableBlendingState;
+
+	bool InitializeOutput(int screenWidth, int screenHeight, float screenDepth, float screenNear, bool headless);
 public:
 	D3D();
 	D3D(const D3D& other);
@@ -36,6 +45,8 @@ public:
 
 	bool Initialize(int screenWidth, int screenHeight, bool vsync, HWND hwnd, bool fullscreen,
 		float screenDepth, float screenNear);
+	//Renders into a texture instead of a window and submits to a NullRenderContext, for benchmarks
+	bool InitializeHeadless(int screenWidth, int screenHeight, float screenDepth, float screenNear);
 	void Shutdown();
 
 	void BeginScene(float red, float green, float blue, float alpha);
@@ -43,6 +54,17 @@ public:
 
 	ID3D11Device* GetDevice();
 	ID3D11DeviceContext* GetDeviceContext();
+	//Everything the engine submits goes through the render context
+	RenderContext* GetRenderContext();
+	bool IsHeadless();
+	//Only set when headless
+	NullRenderContext* GetNullRenderContext();
+
+	//The depth buffer can be read by shaders while it is not bound for output
+	ID3D11ShaderResourceView* GetDepthShaderResourceView();
+	void SetBackBufferRenderTarget();
+	//The back buffer, the depth buffer and the regular depth state, for the passes that rebind them
+	void GetRenderTargets(RenderTargets& targets);
 
 	void GetProjectionMatrix(XMMATRIX& projectionMatrix);
 	void GetWorldMatrix(XMMATRIX& worldMatrix);
@@ -0,0 +1,297 @@
+#include "D3D11RenderContext.h"
+
+D3D11RenderContext::D3D11RenderContext()
+{
+	m_deviceContext = 0;
+	m_deviceContext1 = 0;
+}
+
+D3D11RenderContext::D3D11RenderContext(const D3D11RenderContext & other)
+{
+}
+
+D3D11RenderContext::~D3D11RenderContext()
+{
+}
+
+void D3D11RenderContext::Initialize(ID3D11DeviceContext * deviceContext)
+{
+	HRESULT result;
+
+	m_deviceContext = deviceContext;
+	m_deviceContext->AddRef();
+
+	// Constant buffer offsets need the 11.1 interface of the context, older runtimes do not have it.
+	result = deviceContext->QueryInterface(__uuidof(ID3D11DeviceContext1), (void**)&m_deviceContext1);
+	if (FAILED(result))
+	{
+		m_deviceContext1 = 0;
+	}
+}
+
+void D3D11RenderContext::Shutdown()
+{
+	// Release the 11.1 interface of the context.
+	if (m_deviceContext1)
+	{
+		m_deviceContext1->Release();
+		m_deviceContext1 = 0;
+	}
+
+	// Release the context.
+	if (m_deviceContext)
+	{
+		m_deviceContext->Release();
+		m_deviceContext = 0;
+	}
+}
+
+void D3D11RenderContext::IASetInputLayout(ID3D11InputLayout * inputLayout)
+{
+	m_deviceContext->IASetInputLayout(inputLayout);
+}
+
+void D3D11RenderContext::IASetVertexBuffers(UINT startSlot, UINT bufferCount, ID3D11Buffer * const * vertexBuffers,
+	const UINT * strides, const UINT * offsets)
+{
+	m_deviceContext->IASetVertexBuffers(startSlot, bufferCount, vertexBuffers, strides, offsets);
+}
+
+void D3D11RenderContext::IASetIndexBuffer(ID3D11Buffer * indexBuffer, DXGI_FORMAT format, UINT offset)
+{
+	m_deviceContext->IASetIndexBuffer(indexBuffer, format, offset);
+}
+
+void D3D11RenderContext::IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY topology)
+{
+	m_deviceContext->IASetPrimitiveTopology(topology);
+}
+
+void D3D11RenderContext::VSSetShader(ID3D11VertexShader * vertexShader, ID3D11ClassInstance * const * classInstances,
+	UINT classInstanceCount)
+{
+	m_deviceContext->VSSetShader(vertexShader, classInstances, classInstanceCount);
+}
+
+void D3D11RenderContext::VSSetConstantBuffers(UINT startSlot, UINT bufferCount, ID3D11Buffer * const * constantBuffers)
+{
+	m_deviceContext->VSSetConstantBuffers(startSlot, bufferCount, constantBuffers);
+}
+
+void D3D11RenderContext::VSSetConstantBuffers1(UINT startSlot, UINT bufferCount, ID3D11Buffer * const * constantBuffers,
+	const UINT * firstConstants, const UINT * constantCounts)
+{
+	m_deviceContext1->VSSetConstantBuffers1(startSlot, bufferCount, constantBuffers, firstConstants, constantCounts);
+}
+
+void D3D11RenderContext::PSSetShader(ID3D11PixelShader * pixelShader, ID3D11ClassInstance * const * classInstances, UINT classInstanceCount)
+{
+	m_deviceContext->PSSetShader(pixelShader, classInstances, classInstanceCount);
+}
+
+void D3D11RenderContext::PSSetConstantBuffers(UINT startSlot, UINT bufferCount, ID3D11Buffer * const * constantBuffers)
+{
+	m_deviceContext->PSSetConstantBuffers(startSlot, bufferCount, constantBuffers);
+}
+
+void D3D11RenderContext::PSSetShaderResources(UINT startSlot, UINT viewCount, ID3D11ShaderResourceView * const * shaderResourceViews)
+{
+	Stats::Add(STAT_SRV_BINDS, viewCount);
+	m_deviceContext->PSSetShaderResources(startSlot, viewCount, shaderResourceViews);
+}
+
+void D3D11RenderContext::PSSetSamplers(UINT startSlot, UINT samplerCount, ID3D11SamplerState * const * samplers)
+{
+	m_deviceContext->PSSetSamplers(startSlot, samplerCount, samplers);
+}
+
+void D3D11RenderContext::CSSetShader(ID3D11ComputeShader * computeShader, ID3D11ClassInstance * const * classInstances,
+	UINT classInstanceCount)
+{
+	m_deviceContext->CSSetShader(computeShader, classInstances, classInstanceCount);
+}
+
+void D3D11RenderContext::CSSetConstantBuffers(UINT startSlot, UINT bufferCount, ID3D11Buffer * const * constantBuffers)
+{
+	m_deviceContext->CSSetConstantBuffers(startSlot, bufferCount, constantBuffers);
+}
+
+void D3D11RenderContext::CSSetShaderResources(UINT startSlot, UINT viewCount, ID3D11ShaderResourceView * const * shaderResourceViews)
+{
+	Stats::Add(STAT_SRV_BINDS, viewCount);
+	m_deviceContext->CSSetShaderResources(startSlot, viewCount, shaderResourceViews);
+}
+
+void D3D11RenderContext::CSSetUnorderedAccessViews(UINT startSlot, UINT viewCount,
+	ID3D11UnorderedAccessView * const * unorderedAccessViews, const UINT * initialCounts)
+{
+	m_deviceContext->CSSetUnorderedAccessViews(startSlot, viewCount, unorderedAccessViews, initialCounts);
+}
+
+void D3D11RenderContext::OMSetRenderTargets(UINT viewCount, ID3D11RenderTargetView * const * renderTargetViews,
+	ID3D11DepthStencilView * depthStencilView)
+{
+	m_deviceContext->OMSetRenderTargets(viewCount, renderTargetViews, depthStencilView);
+}
+
+void D3D11RenderContext::OMSetDepthStencilState(ID3D11DepthStencilState * depthStencilState, UINT stencilRef)
+{
+	m_deviceContext->OMSetDepthStencilState(depthStencilState, stencilRef);
+}
+
+void D3D11RenderContext::OMSetBlendState(ID3D11BlendState * blendState, const FLOAT blendFactor[4], UINT sampleMask)
+{
+	m_deviceContext->OMSetBlendState(blendState, blendFactor, sampleMask);
+}
+
+void D3D11RenderContext::RSSetState(ID3D11RasterizerState * rasterizerState)
+{
+	m_deviceContext->RSSetState(rasterizerState);
+}
+
+void D3D11RenderContext::RSSetViewports(UINT viewportCount, const D3D11_VIEWPORT * viewports)
+{
+	m_deviceContext->RSSetViewports(viewportCount, viewports);
+}
+
+void D3D11RenderContext::OMGetRenderTargets(UINT viewCount, ID3D11RenderTargetView ** renderTargetViews,
+	ID3D11DepthStencilView ** depthStencilView)
+{
+	m_deviceContext->OMGetRenderTargets(viewCount, renderTargetViews, depthStencilView);
+}
+
+void D3D11RenderContext::OMGetDepthStencilState(ID3D11DepthStencilState ** depthStencilState, UINT * stencilRef)
+{
+	m_deviceContext->OMGetDepthStencilState(depthStencilState, stencilRef);
+}
+
+void D3D11RenderContext::OMGetBlendState(ID3D11BlendState ** blendState, FLOAT blendFactor[4], UINT * sampleMask)
+{
+	m_deviceContext->OMGetBlendState(blendState, blendFactor, sampleMask);
+}
+
+void D3D11RenderContext::RSGetState(ID3D11RasterizerState ** rasterizerState)
+{
+	m_deviceContext->RSGetState(rasterizerState);
+}
+
+void D3D11RenderContext::RSGetViewports(UINT * viewportCount, D3D11_VIEWPORT * viewports)
+{
+	m_deviceContext->RSGetViewports(viewportCount, viewports);
+}
+
+void D3D11RenderContext::ClearRenderTargetView(ID3D11RenderTargetView * renderTargetView, const FLOAT color[4])
+{
+	m_deviceContext->ClearRenderTargetView(renderTargetView, color);
+}
+
+void D3D11RenderContext::ClearDepthStencilView(ID3D11DepthStencilView * depthStencilView, UINT clearFlags, FLOAT depth, UINT8 stencil)
+{
+	m_deviceContext->ClearDepthStencilView(depthStencilView, clearFlags, depth, stencil);
+}
+
+void D3D11RenderContext::DrawIndexed(UINT indexCount, UINT startIndex, INT baseVertex)
+{
+	Stats::CountDraw(indexCount, 1);
+	m_deviceContext->DrawIndexed(indexCount, startIndex, baseVertex);
+}
+
+void D3D11RenderContext::DrawIndexedInstanced(UINT indexCount, UINT instanceCount, UINT startIndex, INT baseVertex, UINT startInstance)
+{
+	Stats::CountDraw(indexCount, instanceCount);
+	m_deviceContext->DrawIndexedInstanced(indexCount, instanceCount, startIndex, baseVertex, startInstance);
+}
+
+void D3D11RenderContext::Dispatch(UINT groupCountX, UINT groupCountY, UINT groupCountZ)
+{
+	m_deviceContext->Dispatch(groupCountX, groupCountY, groupCountZ);
+}
+
+HRESULT D3D11RenderContext::Map(ID3D11Resource * resource, UINT subresource, D3D11_MAP mapType, UINT mapFlags,
+	D3D11_MAPPED_SUBRESOURCE * mappedResource)
+{
+	Stats::Add(STAT_MAPS, 1);
+	return m_deviceContext->Map(resource, subresource, mapType, mapFlags, mappedResource);
+}
+
+void D3D11RenderContext::Unmap(ID3D11Resource * resource, UINT subresource)
+{
+	m_deviceContext->Unmap(resource, subresource);
+}
+
+void D3D11RenderContext::UpdateSubresource(ID3D11Resource * resource, UINT subresource, const D3D11_BOX * box, const void * data,
+	UINT rowPitch, UINT depthPitch)
+{
+	m_deviceContext->UpdateSubresource(resource, subresource, box, data, rowPitch, depthPitch);
+}
+
+void D3D11RenderContext::GenerateMips(ID3D11ShaderResourceView * shaderResourceView)
+{
+	m_deviceContext->GenerateMips(shaderResourceView);
+}
+
+void D3D11RenderContext::Begin(ID3D11Asynchronous * async)
+{
+	m_deviceContext->Begin(async);
+}
+
+void D3D11RenderContext::End(ID3D11Asynchronous * async)
+{
+	m_deviceContext->End(async);
+}
+
+HRESULT D3D11RenderContext::GetData(ID3D11Asynchronous * async, void * data, UINT dataSize, UINT getDataFlags)
+{
+	return m_deviceContext->GetData(async, data, dataSize, getDataFlags);
+}
+
+HRESULT D3D11RenderContext::FinishCommandList(BOOL restoreDeferredContextState, ID3D11CommandList ** commandList)
+{
+	return m_deviceContext->FinishCommandList(restoreDeferredContextState, commandList);
+}
+
+void D3D11RenderContext::ExecuteCommandList(ID3D11CommandList * commandList, BOOL restoreContextState)
+{
+	m_deviceContext->ExecuteCommandList(commandList, restoreContextState);
+}
+
+RenderContext * D3D11RenderContext::CreateDeferredContext()
+{
+	HRESULT result;
+	ID3D11Device* device;
+	ID3D11DeviceContext* deferredContext;
+	D3D11RenderContext* context;
+
+	// Create the deferred context on the device of this one.
+	m_deviceContext->GetDevice(&device);
+
+	result = device->CreateDeferredContext(0, &deferredContext);
+	device->Release();
+	if (FAILED(result))
+	{
+		return 0;
+	}
+
+	context = new D3D11RenderContext;
+	if (!context)
+	{
+		deferredContext->Release();
+		return 0;
+	}
+
+	// The wrapper holds its own reference.
+	context->Initialize(deferredContext);
+	deferredContext->Release();
+
+	return context;
+}
+
+bool D3D11RenderContext::SupportsConstantOffsets()
+{
+	return m_deviceContext1 != 0;
+}
+
+ID3D11DeviceContext * D3D11RenderContext::GetDeviceContext()
+{
+	return m_deviceContext;
+}
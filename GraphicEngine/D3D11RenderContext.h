@@ -0,0 +1,70 @@
+#pragma once
+#include <d3d11.h>
+#include <d3d11_1.h>
+#include "RenderContext.h"
+
+// Forwards every call to a Direct3D 11 device context, immediate or deferred.
+class D3D11RenderContext : public RenderContext
+{
+private:
+	ID3D11DeviceContext* m_deviceContext;
+	ID3D11DeviceContext1* m_deviceContext1;
+public:
+	D3D11RenderContext();
+	D3D11RenderContext(const D3D11RenderContext&);
+	~D3D11RenderContext();
+
+	// Keeps a reference to the device context until Shutdown.
+	void Initialize(ID3D11DeviceContext* deviceContext);
+	void Shutdown() override;
+
+	void IASetInputLayout(ID3D11InputLayout* inputLayout) override;
+	void IASetVertexBuffers(UINT startSlot, UINT bufferCount, ID3D11Buffer* const* vertexBuffers, const UINT* strides,
+		const UINT* offsets) override;
+	void IASetIndexBuffer(ID3D11Buffer* indexBuffer, DXGI_FORMAT format, UINT offset) override;
+	void IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY topology) override;
+	void VSSetShader(ID3D11VertexShader* vertexShader, ID3D11ClassInstance* const* classInstances, UINT classInstanceCount) override;
+	void VSSetConstantBuffers(UINT startSlot, UINT bufferCount, ID3D11Buffer* const* constantBuffers) override;
+	void VSSetConstantBuffers1(UINT startSlot, UINT bufferCount, ID3D11Buffer* const* constantBuffers, const UINT* firstConstants,
+		const UINT* constantCounts) override;
+	void PSSetShader(ID3D11PixelShader* pixelShader, ID3D11ClassInstance* const* classInstances, UINT classInstanceCount) override;
+	void PSSetConstantBuffers(UINT startSlot, UINT bufferCount, ID3D11Buffer* const* constantBuffers) override;
+	void PSSetShaderResources(UINT startSlot, UINT viewCount, ID3D11ShaderResourceView* const* shaderResourceViews) override;
+	void PSSetSamplers(UINT startSlot, UINT samplerCount, ID3D11SamplerState* const* samplers) override;
+	void CSSetShader(ID3D11ComputeShader* computeShader, ID3D11ClassInstance* const* classInstances, UINT classInstanceCount) override;
+	void CSSetConstantBuffers(UINT startSlot, UINT bufferCount, ID3D11Buffer* const* constantBuffers) override;
+	void CSSetShaderResources(UINT startSlot, UINT viewCount, ID3D11ShaderResourceView* const* shaderResourceViews) override;
+	void CSSetUnorderedAccessViews(UINT startSlot, UINT viewCount, ID3D11UnorderedAccessView* const* unorderedAccessViews,
+		const UINT* initialCounts) override;
+	void OMSetRenderTargets(UINT viewCount, ID3D11RenderTargetView* const* renderTargetViews,
+		ID3D11DepthStencilView* depthStencilView) override;
+	void OMSetDepthStencilState(ID3D11DepthStencilState* depthStencilState, UINT stencilRef) override;
+	void OMSetBlendState(ID3D11BlendState* blendState, const FLOAT blendFactor[4], UINT sampleMask) override;
+	void RSSetState(ID3D11RasterizerState* rasterizerState) override;
+	void RSSetViewports(UINT viewportCount, const D3D11_VIEWPORT* viewports) override;
+	void OMGetRenderTargets(UINT viewCount, ID3D11RenderTargetView** renderTargetViews, ID3D11DepthStencilView** depthStencilView) override;
+	void OMGetDepthStencilState(ID3D11DepthStencilState** depthStencilState, UINT* stencilRef) override;
+	void OMGetBlendState(ID3D11BlendState** blendState, FLOAT blendFactor[4], UINT* sampleMask) override;
+	void RSGetState(ID3D11RasterizerState** rasterizerState) override;
+	void RSGetViewports(UINT* viewportCount, D3D11_VIEWPORT* viewports) override;
+	void ClearRenderTargetView(ID3D11RenderTargetView* renderTargetView, const FLOAT color[4]) override;
+	void ClearDepthStencilView(ID3D11DepthStencilView* depthStencilView, UINT clearFlags, FLOAT depth, UINT8 stencil) override;
+	void DrawIndexed(UINT indexCount, UINT startIndex, INT baseVertex) override;
+	void DrawIndexedInstanced(UINT indexCount, UINT instanceCount, UINT startIndex, INT baseVertex, UINT startInstance) override;
+	void Dispatch(UINT groupCountX, UINT groupCountY, UINT groupCountZ) override;
+	HRESULT Map(ID3D11Resource* resource, UINT subresource, D3D11_MAP mapType, UINT mapFlags,
+		D3D11_MAPPED_SUBRESOURCE* mappedResource) override;
+	void Unmap(ID3D11Resource* resource, UINT subresource) override;
+	void UpdateSubresource(ID3D11Resource* resource, UINT subresource, const D3D11_BOX* box, const void* data, UINT rowPitch,
+		UINT depthPitch) override;
+	void GenerateMips(ID3D11ShaderResourceView* shaderResourceView) override;
+	void Begin(ID3D11Asynchronous* async) override;
+	void End(ID3D11Asynchronous* async) override;
+	HRESULT GetData(ID3D11Asynchronous* async, void* data, UINT dataSize, UINT getDataFlags) override;
+	HRESULT FinishCommandList(BOOL restoreDeferredContextState, ID3D11CommandList** commandList) override;
+	void ExecuteCommandList(ID3D11CommandList* commandList, BOOL restoreContextState) override;
+	RenderContext* CreateDeferredContext() override;
+	bool SupportsConstantOffsets() override;
+
+	ID3D11DeviceContext* GetDeviceContext();
+};
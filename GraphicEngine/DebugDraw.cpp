@@ -0,0 +1,245 @@
+#include "DebugDraw.h"
+#include <math.h>
+#include <atomic>
+#include <mutex>
+
+namespace
+{
+	struct DebugThread
+	{
+		std::vector<DebugVertex> depthTested;
+		std::vector<DebugVertex> overlay;
+	};
+
+	std::atomic<bool> s_enabled(false);
+	std::mutex s_threadMutex;
+	DebugThread* s_threads[DEBUG_DRAW_MAX_THREADS];
+	std::atomic<int> s_threadCount(0);
+
+	thread_local DebugThread* t_thread = 0;
+
+	DebugThread* GetThread()
+	{
+		DebugThread* thread;
+
+		if (t_thread)
+		{
+			return t_thread;
+		}
+
+		// First line of this thread, give it arrays of its own.
+		std::lock_guard<std::mutex> lock(s_threadMutex);
+
+		if (s_threadCount >= DEBUG_DRAW_MAX_THREADS)
+		{
+			return 0;
+		}
+
+		thread = new DebugThread;
+		if (!thread)
+		{
+			return 0;
+		}
+
+		s_threads[s_threadCount] = thread;
+		s_threadCount++;
+
+		t_thread = thread;
+		return thread;
+	}
+
+	void PushLine(DebugThread* thread, const XMFLOAT3& from, const XMFLOAT3& to, const XMFLOAT4& color, bool depthTest)
+	{
+		std::vector<DebugVertex>& lines = depthTest ? thread->depthTested : thread->overlay;
+		DebugVertex vertex;
+
+		vertex.color = color;
+
+		vertex.position = from;
+		lines.push_back(vertex);
+
+		vertex.position = to;
+		lines.push_back(vertex);
+	}
+
+	// The 12 edges of a box with the corners numbered by their x, y and z bits.
+	void PushBox(DebugThread* thread, const XMFLOAT3* corners, const XMFLOAT4& color, bool depthTest)
+	{
+		static const int edges[12][2] =
+		{
+			{ 0, 1 }, { 2, 3 }, { 4, 5 }, { 6, 7 },
+			{ 0, 2 }, { 1, 3 }, { 4, 6 }, { 5, 7 },
+			{ 0, 4 }, { 1, 5 }, { 2, 6 }, { 3, 7 }
+		};
+		int i;
+
+		for (i = 0; i < 12; i++)
+		{
+			PushLine(thread, corners[edges[i][0]], corners[edges[i][1]], color, depthTest);
+		}
+	}
+}
+
+void DebugDraw::SetEnabled(bool enabled)
+{
+	s_enabled = enabled;
+}
+
+bool DebugDraw::IsEnabled()
+{
+	return s_enabled;
+}
+
+void DebugDraw::AddLine(const XMFLOAT3 & from, const XMFLOAT3 & to, const XMFLOAT4 & color, bool depthTest)
+{
+	DebugThread* thread;
+
+	if (!s_enabled.load(std::memory_order_relaxed))
+	{
+		return;
+	}
+
+	thread = GetThread();
+	if (!thread)
+	{
+		return;
+	}
+
+	PushLine(thread, from, to, color, depthTest);
+}
+
+void DebugDraw::AddBox(const XMFLOAT3 & minimum, const XMFLOAT3 & maximum, const XMFLOAT4 & color, bool depthTest)
+{
+	DebugThread* thread;
+	XMFLOAT3 corners[8];
+	int i;
+
+	if (!s_enabled.load(std::memory_order_relaxed))
+	{
+		return;
+	}
+
+	thread = GetThread();
+	if (!thread)
+	{
+		return;
+	}
+
+	for (i = 0; i < 8; i++)
+	{
+		corners[i].x = (i & 1) ? maximum.x : minimum.x;
+		corners[i].y = (i & 2) ? maximum.y : minimum.y;
+		corners[i].z = (i & 4) ? maximum.z : minimum.z;
+	}
+
+	PushBox(thread, corners, color, depthTest);
+}
+
+void DebugDraw::AddSphere(const XMFLOAT3 & center, float radius, const XMFLOAT4 & color, bool depthTest)
+{
+	DebugThread* thread;
+	XMFLOAT3 previous[3], current[3];
+	float angle, sine, cosine;
+	int segment, axis;
+
+	if (!s_enabled.load(std::memory_order_relaxed))
+	{
+		return;
+	}
+
+	thread = GetThread();
+	if (!thread)
+	{
+		return;
+	}
+
+	for (segment = 0; segment <= DEBUG_DRAW_CIRCLE_SEGMENTS; segment++)
+	{
+		angle = XM_2PI * (float)segment / (float)DEBUG_DRAW_CIRCLE_SEGMENTS;
+		sine = sinf(angle) * radius;
+		cosine = cosf(angle) * radius;
+
+		// Circles in the yz, xz and xy planes.
+		current[0] = XMFLOAT3(center.x, center.y + cosine, center.z + sine);
+		current[1] = XMFLOAT3(center.x + cosine, center.y, center.z + sine);
+		current[2] = XMFLOAT3(center.x + cosine, center.y + sine, center.z);
+
+		if (segment > 0)
+		{
+			for (axis = 0; axis < 3; axis++)
+			{
+				PushLine(thread, previous[axis], current[axis], color, depthTest);
+			}
+		}
+
+		for (axis = 0; axis < 3; axis++)
+		{
+			previous[axis] = current[axis];
+		}
+	}
+}
+
+void DebugDraw::AddFrustum(CXMMATRIX viewMatrix, CXMMATRIX projectionMatrix, const XMFLOAT4 & color, bool depthTest)
+{
+	DebugThread* thread;
+	XMMATRIX inverse;
+	XMVECTOR corner;
+	XMFLOAT3 corners[8];
+	int i;
+
+	if (!s_enabled.load(std::memory_order_relaxed))
+	{
+		return;
+	}
+
+	thread = GetThread();
+	if (!thread)
+	{
+		return;
+	}
+
+	// Take the corners of clip space back to world space, the depth of Direct3D goes from 0 to 1.
+	inverse = XMMatrixInverse(NULL, XMMatrixMultiply(viewMatrix, projectionMatrix));
+	for (i = 0; i < 8; i++)
+	{
+		corner = XMVectorSet((i & 1) ? 1.0f : -1.0f, (i & 2) ? 1.0f : -1.0f, (i & 4) ? 1.0f : 0.0f, 1.0f);
+		XMStoreFloat3(&corners[i], XMVector3TransformCoord(corner, inverse));
+	}
+
+	PushBox(thread, corners, color, depthTest);
+}
+
+void DebugDraw::Collect(std::vector<DebugVertex>& depthTested, std::vector<DebugVertex>& overlay)
+{
+	DebugThread* thread;
+	int i;
+
+	for (i = 0; i < s_threadCount; i++)
+	{
+		thread = s_threads[i];
+
+		depthTested.insert(depthTested.end(), thread->depthTested.begin(), thread->depthTested.end());
+		overlay.insert(overlay.end(), thread->overlay.begin(), thread->overlay.end());
+
+		// Clearing keeps the capacity, so a steady amount of lines stops allocating after the first frames.
+		thread->depthTested.clear();
+		thread->overlay.clear();
+	}
+}
+
+void DebugDraw::Shutdown()
+{
+	int i;
+
+	s_enabled = false;
+
+	std::lock_guard<std::mutex> lock(s_threadMutex);
+
+	for (i = 0; i < s_threadCount; i++)
+	{
+		delete s_threads[i];
+		s_threads[i] = 0;
+	}
+
+	s_threadCount = 0;
+}
@@ -0,0 +1,43 @@
+#pragma once
+#include <DirectXMath.h>
+#include <vector>
+#include "Util.h"
+using namespace DirectX;
+
+// Threads that can add lines, the lines of further threads are dropped.
+#define DEBUG_DRAW_MAX_THREADS 16
+// Lines a circle of a sphere is made of.
+#define DEBUG_DRAW_CIRCLE_SEGMENTS 24
+
+// Layout of the color shader.
+struct DebugVertex
+{
+	XMFLOAT3 position;
+	XMFLOAT4 color;
+};
+
+// Immediate mode debug lines in world space. Every thread adds to line arrays of its own, so adding needs no
+// lock, and Collect merges them between frames. While disabled every call only checks a flag, so the calls can
+// stay in production builds. Lines either go through the depth test or are drawn on top of the scene.
+class DebugDraw
+{
+public:
+	// Starts disabled.
+	GRAPHIC_API static void SetEnabled(bool enabled);
+	GRAPHIC_API static bool IsEnabled();
+
+	GRAPHIC_API static void AddLine(const XMFLOAT3& from, const XMFLOAT3& to, const XMFLOAT4& color, bool depthTest);
+	// Axis aligned box between the two corners.
+	GRAPHIC_API static void AddBox(const XMFLOAT3& minimum, const XMFLOAT3& maximum, const XMFLOAT4& color, bool depthTest);
+	// One circle around each axis.
+	GRAPHIC_API static void AddSphere(const XMFLOAT3& center, float radius, const XMFLOAT4& color, bool depthTest);
+	// The volume a view and projection matrix can see, from its near to its far plane.
+	GRAPHIC_API static void AddFrustum(CXMMATRIX viewMatrix, CXMMATRIX projectionMatrix, const XMFLOAT4& color, bool depthTest);
+
+	// Appends the line vertices of every thread, two per line, and empties the threads for the next frame.
+	// Only call while no other thread adds lines.
+	GRAPHIC_API static void Collect(std::vector<DebugVertex>& depthTested, std::vector<DebugVertex>& overlay);
+
+	// Frees the arrays of every thread, no line may be added afterwards.
+	GRAPHIC_API static void Shutdown();
+};
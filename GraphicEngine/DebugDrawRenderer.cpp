@@ -0,0 +1,194 @@
+#include "DebugDrawRenderer.h"
+#include <string.h>
+
+DebugDrawRenderer::DebugDrawRenderer()
+{
+	m_ColorShader = 0;
+	m_vertexBuffer = 0;
+	m_indexBuffer = 0;
+	m_depthTestedCount = 0;
+	m_overlayCount = 0;
+}
+
+DebugDrawRenderer::DebugDrawRenderer(const DebugDrawRenderer & other)
+{
+}
+
+DebugDrawRenderer::~DebugDrawRenderer()
+{
+}
+
+bool DebugDrawRenderer::Initialize(ID3D11Device * device, HWND hwnd)
+{
+	unsigned short* indices;
+	D3D11_BUFFER_DESC vertexBufferDesc, indexBufferDesc;
+	D3D11_SUBRESOURCE_DATA indexData;
+	HRESULT hresult;
+	bool result;
+	int i;
+
+	// Create the color shader object.
+	m_ColorShader = new ColorShader;
+	if (!m_ColorShader)
+	{
+		return false;
+	}
+
+	result = m_ColorShader->Initialize(device, hwnd);
+	if (!result)
+	{
+		return false;
+	}
+
+	vertexBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+	vertexBufferDesc.ByteWidth = sizeof(DebugVertex) * DEBUG_DRAW_MAX_VERTICES;
+	vertexBufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+	vertexBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+	vertexBufferDesc.MiscFlags = 0;
+	vertexBufferDesc.StructureByteStride = 0;
+
+	hresult = device->CreateBuffer(&vertexBufferDesc, NULL, &m_vertexBuffer);
+	if (FAILED(hresult))
+	{
+		return false;
+	}
+
+	// The lines are drawn in order, so the indices just count up and the base vertex picks the part.
+	indices = new unsigned short[DEBUG_DRAW_MAX_VERTICES];
+	if (!indices)
+	{
+		return false;
+	}
+
+	for (i = 0; i < DEBUG_DRAW_MAX_VERTICES; i++)
+	{
+		indices[i] = (unsigned short)i;
+	}
+
+	indexBufferDesc.Usage = D3D11_USAGE_IMMUTABLE;
+	indexBufferDesc.ByteWidth = sizeof(unsigned short) * DEBUG_DRAW_MAX_VERTICES;
+	indexBufferDesc.BindFlags = D3D11_BIND_INDEX_BUFFER;
+	indexBufferDesc.CPUAccessFlags = 0;
+	indexBufferDesc.MiscFlags = 0;
+	indexBufferDesc.StructureByteStride = 0;
+
+	indexData.pSysMem = indices;
+	indexData.SysMemPitch = 0;
+	indexData.SysMemSlicePitch = 0;
+
+	hresult = device->CreateBuffer(&indexBufferDesc, &indexData, &m_indexBuffer);
+
+	delete[] indices;
+	indices = 0;
+
+	if (FAILED(hresult))
+	{
+		return false;
+	}
+
+	return true;
+}
+
+void DebugDrawRenderer::Shutdown()
+{
+	// Release the index buffer.
+	if (m_indexBuffer)
+	{
+		m_indexBuffer->Release();
+		m_indexBuffer = 0;
+	}
+
+	// Release the vertex buffer.
+	if (m_vertexBuffer)
+	{
+		m_vertexBuffer->Release();
+		m_vertexBuffer = 0;
+	}
+
+	// Release the color shader object.
+	if (m_ColorShader)
+	{
+		m_ColorShader->Shutdown();
+		delete m_ColorShader;
+		m_ColorShader = 0;
+	}
+}
+
+bool DebugDrawRenderer::Upload(RenderContext * deviceContext, const std::vector<DebugVertex>& depthTested,
+	const std::vector<DebugVertex>& overlay)
+{
+	PROFILE_FUNCTION();
+	D3D11_MAPPED_SUBRESOURCE mappedResource;
+	DebugVertex* vertexPtr;
+	HRESULT result;
+
+	// Drop whatever does not fit, the depth tested lines first get their room.
+	m_depthTestedCount = (int)depthTested.size();
+	if (m_depthTestedCount > DEBUG_DRAW_MAX_VERTICES)
+	{
+		m_depthTestedCount = DEBUG_DRAW_MAX_VERTICES;
+	}
+
+	m_overlayCount = (int)overlay.size();
+	if (m_overlayCount > DEBUG_DRAW_MAX_VERTICES - m_depthTestedCount)
+	{
+		m_overlayCount = DEBUG_DRAW_MAX_VERTICES - m_depthTestedCount;
+	}
+
+	// Nothing to draw, do not touch the buffer.
+	if (m_depthTestedCount + m_overlayCount == 0)
+	{
+		return true;
+	}
+
+	result = deviceContext->Map(m_vertexBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	vertexPtr = (DebugVertex*)mappedResource.pData;
+
+	if (m_depthTestedCount > 0)
+	{
+		memcpy(vertexPtr, &depthTested[0], sizeof(DebugVertex) * m_depthTestedCount);
+	}
+
+	if (m_overlayCount > 0)
+	{
+		memcpy(vertexPtr + m_depthTestedCount, &overlay[0], sizeof(DebugVertex) * m_overlayCount);
+	}
+
+	deviceContext->Unmap(m_vertexBuffer, 0);
+
+	return true;
+}
+
+bool DebugDrawRenderer::Render(RenderContext * deviceContext, bool depthTested, XMMATRIX worldMatrix, XMMATRIX viewMatrix,
+	XMMATRIX projectionMatrix)
+{
+	unsigned int stride, offset;
+	int vertexCount, baseVertex;
+
+	vertexCount = depthTested ? m_depthTestedCount : m_overlayCount;
+	baseVertex = depthTested ? 0 : m_depthTestedCount;
+
+	if (vertexCount == 0)
+	{
+		return true;
+	}
+
+	stride = sizeof(DebugVertex);
+	offset = 0;
+
+	deviceContext->IASetVertexBuffers(0, 1, &m_vertexBuffer, &stride, &offset);
+	deviceContext->IASetIndexBuffer(m_indexBuffer, DXGI_FORMAT_R16_UINT, 0);
+	deviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_LINELIST);
+
+	return m_ColorShader->Render(deviceContext, vertexCount, baseVertex, worldMatrix, viewMatrix, projectionMatrix);
+}
+
+int DebugDrawRenderer::GetLineCount()
+{
+	return (m_depthTestedCount + m_overlayCount) / 2;
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include <d3d11.h>
+#include <DirectXMath.h>
+#include <vector>
+#include "RenderContext.h"
+#include "ColorShader.h"
+#include "DebugDraw.h"
+#include "Profiler.h"
+using namespace DirectX;
+
+// Line vertices a frame can draw, the lines past it are dropped. The 16 bit indices reach this far.
+#define DEBUG_DRAW_MAX_VERTICES 65536
+
+// Draws the lines DebugDraw collected with the color shader. Upload copies the lines of a frame into one dynamic
+// vertex buffer with one map, the depth tested lines first and the overlay behind them, then each of the two parts
+// is one draw.
+class DebugDrawRenderer
+{
+private:
+	ColorShader* m_ColorShader;
+	ID3D11Buffer* m_vertexBuffer;
+	ID3D11Buffer* m_indexBuffer;
+	int m_depthTestedCount;
+	int m_overlayCount;
+public:
+	DebugDrawRenderer();
+	DebugDrawRenderer(const DebugDrawRenderer&);
+	~DebugDrawRenderer();
+
+	bool Initialize(ID3D11Device* device, HWND hwnd);
+	void Shutdown();
+
+	// Takes the lines DebugDraw::Collect returned for the frame, once per frame.
+	bool Upload(RenderContext* deviceContext, const std::vector<DebugVertex>& depthTested, const std::vector<DebugVertex>& overlay);
+	// Draws the depth tested lines or the overlay of the last upload with whatever depth state is set.
+	bool Render(RenderContext* deviceContext, bool depthTested, XMMATRIX worldMatrix, XMMATRIX viewMatrix, XMMATRIX projectionMatrix);
+
+	int GetLineCount();
+};
@@ -0,0 +1,151 @@
+#include "DistanceField.h"
+#include <math.h>
+#include <vector>
+
+namespace
+{
+	// Offset from a pixel to the closest seed pixel found so far.
+	struct SeedOffset
+	{
+		int dx, dy;
+	};
+
+	const int FAR_AWAY = 1 << 14;
+
+	int LengthSquared(const SeedOffset& offset)
+	{
+		return offset.dx * offset.dx + offset.dy * offset.dy;
+	}
+
+	void Compare(std::vector<SeedOffset>& grid, int width, int height, int x, int y, int offsetX, int offsetY)
+	{
+		SeedOffset candidate;
+		int nx, ny;
+
+		nx = x + offsetX;
+		ny = y + offsetY;
+		if (nx < 0 || ny < 0 || nx >= width || ny >= height)
+		{
+			return;
+		}
+
+		candidate = grid[ny * width + nx];
+		candidate.dx += offsetX;
+		candidate.dy += offsetY;
+
+		if (LengthSquared(candidate) < LengthSquared(grid[y * width + x]))
+		{
+			grid[y * width + x] = candidate;
+		}
+	}
+
+	// Eight point sequential euclidean distance transform, one pass down and one pass up.
+	void Propagate(std::vector<SeedOffset>& grid, int width, int height)
+	{
+		int x, y;
+
+		for (y = 0; y < height; y++)
+		{
+			for (x = 0; x < width; x++)
+			{
+				Compare(grid, width, height, x, y, -1, 0);
+				Compare(grid, width, height, x, y, 0, -1);
+				Compare(grid, width, height, x, y, -1, -1);
+				Compare(grid, width, height, x, y, 1, -1);
+			}
+
+			for (x = width - 1; x >= 0; x--)
+			{
+				Compare(grid, width, height, x, y, 1, 0);
+			}
+		}
+
+		for (y = height - 1; y >= 0; y--)
+		{
+			for (x = width - 1; x >= 0; x--)
+			{
+				Compare(grid, width, height, x, y, 1, 0);
+				Compare(grid, width, height, x, y, 0, 1);
+				Compare(grid, width, height, x, y, -1, 1);
+				Compare(grid, width, height, x, y, 1, 1);
+			}
+
+			for (x = 0; x < width; x++)
+			{
+				Compare(grid, width, height, x, y, -1, 0);
+			}
+		}
+	}
+}
+
+void BuildDistanceField(const unsigned char * coverage, int width, int height, int scale, float spread, unsigned char * field)
+{
+	std::vector<SeedOffset> toInside, toOutside;
+	SeedOffset seed, empty;
+	int fieldWidth, fieldHeight, x, y, i, j, index;
+	float distance, sum, value;
+	bool inside;
+
+	seed.dx = 0;
+	seed.dy = 0;
+	empty.dx = FAR_AWAY;
+	empty.dy = FAR_AWAY;
+
+	// Every pixel is a seed of the grid that measures the distance to its own side.
+	toInside.resize(width * height);
+	toOutside.resize(width * height);
+	for (i = 0; i < width * height; i++)
+	{
+		inside = coverage[i] >= 128;
+		toInside[i] = inside ? seed : empty;
+		toOutside[i] = inside ? empty : seed;
+	}
+
+	Propagate(toInside, width, height);
+	Propagate(toOutside, width, height);
+
+	fieldWidth = width / scale;
+	fieldHeight = height / scale;
+
+	for (y = 0; y < fieldHeight; y++)
+	{
+		for (x = 0; x < fieldWidth; x++)
+		{
+			sum = 0.0f;
+
+			for (j = 0; j < scale; j++)
+			{
+				for (i = 0; i < scale; i++)
+				{
+					index = (y * scale + j) * width + x * scale + i;
+
+					// The edge runs half way between an inside and an outside pixel.
+					if (coverage[index] >= 128)
+					{
+						distance = sqrtf((float)LengthSquared(toOutside[index])) - 0.5f;
+					}
+					else
+					{
+						distance = 0.5f - sqrtf((float)LengthSquared(toInside[index]));
+					}
+
+					sum += distance;
+				}
+			}
+
+			// Average in coverage pixels, then map [-spread, spread] field pixels onto the byte range.
+			value = 0.5f + (sum / (float)(scale * scale * scale)) / (2.0f * spread);
+			if (value < 0.0f)
+			{
+				value = 0.0f;
+			}
+
+			if (value > 1.0f)
+			{
+				value = 1.0f;
+			}
+
+			field[y * fieldWidth + x] = (unsigned char)(value * 255.0f + 0.5f);
+		}
+	}
+}
@@ -0,0 +1,9 @@
+#pragma once
+
+// Signed distance fields for the font atlas. Nothing in here touches Windows or Direct3D.
+
+// Converts a coverage bitmap of width * height pixels, where 128 and up counts as inside, into a distance field
+// that is scale times smaller in both directions. Each field pixel averages the signed distance of the scale *
+// scale coverage pixels it covers, measured in field pixels. 128 is the edge, 255 is spread field pixels or more
+// inside and 0 is spread field pixels or more outside. width and height have to be multiples of scale.
+void BuildDistanceField(const unsigned char* coverage, int width, int height, int scale, float spread, unsigned char* field);
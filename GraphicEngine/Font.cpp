@@ -1,67 +1,146 @@
 #include "Font.h"
+#include <string.h>
+#include "TextBatcher.h"
 
 bool Font::LoadFontData(char * filename)
 {
-	ifstream fin;
-	int i;
-	char temp;
+	PROFILE_ZONE("Font::LoadFontData");
+	FontImportSettings settings;
+	bool result;
 
-	// Create the font spacing buffer.
-	m_Font = new FontType[95];
+	// Create the font table.
+	m_Font = new FontTable;
 	if (!m_Font)
 	{
 		return false;
 	}
 
-	// Read in the font size and spacing between chars.
-	fin.open(filename);
-	if (fin.fail())
+	// Read in the metrics, kerning pairs and atlas.
+	result = m_Font->Read(filename);
+	if (result)
+	{
+		return true;
+	}
+
+	// Import the font file from the default font if there is none yet, then read it back in.
+	GetDefaultFontImportSettings(settings);
+
+	result = ImportFont(settings, filename);
+	if (!result)
 	{
 		return false;
 	}
 
-	// Read in the 95 used ascii characters for text.
-	for (i = 0; i<95; i++)
+	return m_Font->Read(filename);
+}
+
+bool Font::RasterizeGlyph(unsigned int codepoint, GlyphBitmap & glyph)
+{
+	PROFILE_FUNCTION();
+	GlyphCoverage coverage;
+	bool result;
+
+	// The rasterizer is only created once a character is missing from the font file.
+	if (!m_Rasterizer)
 	{
-		fin.get(temp);
-		while (temp != ' ')
+		if (m_rasterizerFailed)
 		{
-			fin.get(temp);
+			return false;
 		}
-		fin.get(temp);
-		while (temp != ' ')
+
+		// Rasterize at the size and range of the font file, so the glyphs match the imported ones.
+		GetDefaultFontImportSettings(m_settings);
+		m_settings.pixelSize = m_Font->GetHeader().pixelSize;
+		m_settings.distanceRange = m_Font->GetHeader().distanceRange;
+
+		m_Rasterizer = new GlyphRasterizer;
+		if (!m_Rasterizer)
 		{
-			fin.get(temp);
+			m_rasterizerFailed = true;
+			return false;
 		}
 
-		fin >> m_Font[i].left;
-		fin >> m_Font[i].right;
-		fin >> m_Font[i].size;
+		result = m_Rasterizer->Initialize(m_settings);
+		if (!result)
+		{
+			m_Rasterizer->Shutdown();
+			delete m_Rasterizer;
+			m_Rasterizer = 0;
+			m_rasterizerFailed = true;
+			return false;
+		}
+	}
+
+	result = m_Rasterizer->Rasterize(codepoint, coverage);
+	if (!result)
+	{
+		return false;
+	}
+
+	memset(&glyph.metrics, 0, sizeof(glyph.metrics));
+	glyph.metrics.codepoint = codepoint;
+	glyph.metrics.offsetX = coverage.offsetX;
+	glyph.metrics.offsetY = coverage.offsetY;
+	glyph.metrics.advance = coverage.advance;
+	glyph.width = coverage.width / m_settings.supersample;
+	glyph.height = coverage.height / m_settings.supersample;
+	glyph.pixels.clear();
+
+	if (glyph.width > 0)
+	{
+		glyph.pixels.resize(glyph.width * glyph.height);
+		BuildDistanceField(&coverage.pixels[0], coverage.width, coverage.height, m_settings.supersample, m_settings.distanceRange,
+			&glyph.pixels[0]);
 	}
 
-	// Close the file.
-	fin.close();
+	glyph.metrics.width = (float)glyph.width;
+	glyph.metrics.height = (float)glyph.height;
 
 	return true;
 }
 
 void Font::ReleaseFontData()
 {
-	// Release the font data array.
+	// Release the font table.
 	if (m_Font)
 	{
-		delete[] m_Font;
+		delete m_Font;
 		m_Font = 0;
 	}
 }
 
-bool Font::LoadTexture(Assets* assets, char * filename)
+bool Font::LoadTexture(ID3D11Device * device)
 {
-	bool result;
+	D3D11_TEXTURE2D_DESC textureDesc;
+	D3D11_SUBRESOURCE_DATA textureData;
+	HRESULT result;
+
+	// The page only holds the distance to the outline, one channel is enough.
+	textureDesc.Width = m_Cache->GetPageWidth();
+	textureDesc.Height = m_Cache->GetPageHeight();
+	textureDesc.MipLevels = 1;
+	textureDesc.ArraySize = 1;
+	textureDesc.Format = DXGI_FORMAT_R8_UNORM;
+	textureDesc.SampleDesc.Count = 1;
+	textureDesc.SampleDesc.Quality = 0;
+	// The cache writes new glyphs into the page while the font is in use.
+	textureDesc.Usage = D3D11_USAGE_DEFAULT;
+	textureDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+	textureDesc.CPUAccessFlags = 0;
+	textureDesc.MiscFlags = 0;
+
+	textureData.pSysMem = m_Cache->GetPage();
+	textureData.SysMemPitch = textureDesc.Width;
+	textureData.SysMemSlicePitch = 0;
 
-	//Create the texture object
-	m_Texture = assets->load<TextureAsset>(filename);
-	if (!m_Texture)
+	result = device->CreateTexture2D(&textureDesc, &textureData, &m_texture);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	result = device->CreateShaderResourceView(m_texture, NULL, &m_textureView);
+	if (FAILED(result))
 	{
 		return false;
 	}
@@ -69,29 +148,59 @@ bool Font::LoadTexture(Assets* assets, char * filename)
 	return true;
 }
 
+void Font::ReleaseTexture()
+{
+	// Release the texture view.
+	if (m_textureView)
+	{
+		m_textureView->Release();
+		m_textureView = 0;
+	}
+
+	// Release the texture.
+	if (m_texture)
+	{
+		m_texture->Release();
+		m_texture = 0;
+	}
+}
+
 Font::Font()
 {
 	m_Font = 0;
-	m_Texture = 0;
+	m_Cache = 0;
+	m_Rasterizer = 0;
+	m_rasterizerFailed = false;
+	m_texture = 0;
+	m_textureView = 0;
 }
 
 Font::~Font()
 {
 }
 
-bool Font::Initialize(Assets* assets, char * fontFilename, char* textureFilename)
+bool Font::Initialize(Assets* assets, char * fontFilename)
 {
 	bool result;
 
-	//Load in the text file containint the font data
+	//Load in the font file, importing it first if needed
 	result = LoadFontData(fontFilename);
 	if (!result)
 	{
 		return false;
 	}
 
-	//Load the texture that has the font characters on it
-	result = LoadTexture(assets, textureFilename);
+	//Create the glyph cache, it loads the characters as they are drawn
+	m_Cache = new GlyphCache;
+	if (!m_Cache)
+	{
+		return false;
+	}
+
+	m_Cache->Initialize(this, m_Font->GetHeader(), FONT_PAGE_WIDTH, FONT_PAGE_HEIGHT);
+
+	//Create the texture that has the distance field of the cached characters on it
+	result = LoadTexture(assets->GetDevice());
 	if (!result)
 	{
 		return false;
@@ -101,70 +210,81 @@ bool Font::Initialize(Assets* assets, char * fontFilename, char* textureFilename
 
 void Font::Shutdown()
 {
+	//Release the page texture
+	ReleaseTexture();
+
+	//Release the glyph cache
+	if (m_Cache)
+	{
+		m_Cache->Shutdown();
+		delete m_Cache;
+		m_Cache = 0;
+	}
+
+	//Release the rasterizer
+	if (m_Rasterizer)
+	{
+		m_Rasterizer->Shutdown();
+		delete m_Rasterizer;
+		m_Rasterizer = 0;
+	}
+
 	//Release the font data
 	ReleaseFontData();
 }
 
+void Font::Upload(RenderContext * deviceContext)
+{
+	TextBatcher::UploadGlyphs(deviceContext, m_Cache, m_texture);
+}
+
+void Font::BeginFrame()
+{
+	m_Cache->BeginFrame();
+}
+
 ID3D11ShaderResourceView * Font::GetTexture()
 {
-	return m_Texture->GetTexture();
+	return m_textureView;
 }
 
-void Font::BuildVertexArray(void* vertices, char* sentence, float drawX, float drawY)
+GlyphCache * Font::GetCache()
 {
-	VertexType* vertexPtr;
-	int numLetters, index, i, letter;
+	return m_Cache;
+}
 
+bool Font::LoadGlyph(unsigned int codepoint, GlyphBitmap & glyph)
+{
+	const FontGlyph* entry;
+	const unsigned char* atlas;
+	int atlasWidth, x, y, row;
 
-	// Coerce the input vertices into a VertexType structure.
-	vertexPtr = (VertexType*)vertices;
+	entry = m_Font->FindGlyph(codepoint);
+	if (!entry)
+	{
+		return RasterizeGlyph(codepoint, glyph);
+	}
 
-	// Get the number of letters in the sentence.
-	numLetters = (int)strlen(sentence);
+	// Copy the field of the glyph out of the atlas of the font file.
+	glyph.metrics = *entry;
+	glyph.width = (int)entry->width;
+	glyph.height = (int)entry->height;
+	glyph.pixels.resize(glyph.width * glyph.height);
 
-	// Initialize the index to the vertex array.
-	index = 0;
+	atlas = m_Font->GetAtlas();
+	atlasWidth = (int)m_Font->GetHeader().atlasWidth;
+	x = (int)(entry->u0 * atlasWidth + 0.5f);
+	y = (int)(entry->v0 * m_Font->GetHeader().atlasHeight + 0.5f);
 
-	// Draw each letter onto a quad.
-	for (i = 0; i<numLetters; i++)
+	for (row = 0; row < glyph.height; row++)
 	{
-		letter = ((int)sentence[i]) - 32;
-
-		// If the letter is a space then just move over three pixels.
-		if (letter == 0)
-		{
-			drawX = drawX + 3.0f;
-		}
-		else
-		{
-			// First triangle in quad.
-			vertexPtr[index].position = XMFLOAT3(drawX, drawY, 0.0f);  // Top left.
-			vertexPtr[index].texture = XMFLOAT2(m_Font[letter].left, 0.0f);
-			index++;
-
-			vertexPtr[index].position = XMFLOAT3((drawX + m_Font[letter].size), (drawY - 16), 0.0f);  // Bottom right.
-			vertexPtr[index].texture = XMFLOAT2(m_Font[letter].right, 1.0f);
-			index++;
-
-			vertexPtr[index].position = XMFLOAT3(drawX, (drawY - 16), 0.0f);  // Bottom left.
-			vertexPtr[index].texture = XMFLOAT2(m_Font[letter].left, 1.0f);
-			index++;
-
-			// Second triangle in quad.
-			vertexPtr[index].position = XMFLOAT3(drawX, drawY, 0.0f);  // Top left.
-			vertexPtr[index].texture = XMFLOAT2(m_Font[letter].left, 0.0f);
-			index++;
-
-			vertexPtr[index].position = XMFLOAT3(drawX + m_Font[letter].size, drawY, 0.0f);  // Top right.
-			vertexPtr[index].texture = XMFLOAT2(m_Font[letter].right, 0.0f);
-			index++;
-
-			vertexPtr[index].position = XMFLOAT3((drawX + m_Font[letter].size), (drawY - 16), 0.0f);  // Bottom right.
-			vertexPtr[index].texture = XMFLOAT2(m_Font[letter].right, 1.0f);
-			index++;
-
-			// Update the x location for drawing by the size of the letter and one pixel.
-			drawX = drawX + m_Font[letter].size + 1.0f;
-		}
+		memcpy(&glyph.pixels[row * glyph.width], &atlas[(y + row) * atlasWidth + x], glyph.width);
 	}
+
+	return true;
+}
+
+float Font::GetKerning(unsigned int first, unsigned int second)
+{
+	return m_Font->GetKerning(first, second);
 }
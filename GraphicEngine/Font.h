@@ -5,41 +5,52 @@
 using namespace std;
 using namespace DirectX;
 
-#include "TextureAsset.h"
 #include "Assets.h"
-
-class Font
+#include "FontTable.h"
+#include "FontImporter.h"
+#include "GlyphCache.h"
+
+// Size of the atlas page the glyph cache packs the drawn glyphs into.
+#define FONT_PAGE_WIDTH 1024
+#define FONT_PAGE_HEIGHT 1024
+
+// A distance field font. The glyph metrics, kerning pairs and fields come from one binary font file, which is
+// imported from an installed font the first time it is missing. Characters the file does not have are
+// rasterized from the installed font when they are first drawn. The glyphs in use live in one page of the glyph
+// cache and only the parts of the page that changed are uploaded.
+class Font : public GlyphLoader
 {
 private:
-	struct FontType
-	{
-		float left, right;
-		int size;
-	};
-
-	struct VertexType
-	{
-		XMFLOAT3 position;
-		XMFLOAT2 texture;
-	};
-
-	FontType* m_Font;
-	TextureAsset* m_Texture;
+	FontTable* m_Font;
+	GlyphCache* m_Cache;
+	GlyphRasterizer* m_Rasterizer;
+	FontImportSettings m_settings;
+	bool m_rasterizerFailed;
+	ID3D11Texture2D* m_texture;
+	ID3D11ShaderResourceView* m_textureView;
 
 	bool LoadFontData(char* filename);
 	void ReleaseFontData();
-	bool LoadTexture(Assets* assets, char * filename);
+	bool LoadTexture(ID3D11Device* device);
+	void ReleaseTexture();
+	bool RasterizeGlyph(unsigned int codepoint, GlyphBitmap& glyph);
 public:
 	Font();
 	~Font();
 
-	bool Initialize(Assets* assets, char * fontFilename, char* textureFilename);
+	bool Initialize(Assets* assets, char * fontFilename);
 	void Shutdown();
 
-	ID3D11ShaderResourceView* GetTexture();
+	// Copies the parts of the page the cache wrote since the last upload to the texture.
+	void Upload(RenderContext* deviceContext);
+	// Call after the text of a frame is drawn.
+	void BeginFrame();
 
-	void BuildVertexArray(void* vertices, char* sentence, float drawX, float drawY);
+	ID3D11ShaderResourceView* GetTexture();
 
-private:
+	// Glyphs and kerning of the characters for LayoutText.
+	GlyphCache* GetCache();
 
-};
\ No newline at end of file
+	bool LoadGlyph(unsigned int codepoint, GlyphBitmap& glyph);
+	float GetKerning(unsigned int first, unsigned int second);
+};
@@ -0,0 +1,365 @@
+#include "FontImporter.h"
+#include <math.h>
+#include <string.h>
+
+namespace
+{
+	int AlignUp(int value, int alignment)
+	{
+		return (value + alignment - 1) / alignment * alignment;
+	}
+
+	struct FieldJob
+	{
+		const std::vector<GlyphCoverage>* glyphs;
+		std::vector<std::vector<unsigned char>>* fields;
+		int supersample;
+		float distanceRange;
+	};
+
+	void BuildFields(void* data, int begin, int end)
+	{
+		FieldJob* job;
+		int index;
+
+		job = (FieldJob*)data;
+
+		for (index = begin; index < end; index++)
+		{
+			const GlyphCoverage& glyph = (*job->glyphs)[index];
+			if (glyph.width == 0)
+			{
+				continue;
+			}
+
+			(*job->fields)[index].resize((glyph.width / job->supersample) * (glyph.height / job->supersample));
+			BuildDistanceField(&glyph.pixels[0], glyph.width, glyph.height, job->supersample, job->distanceRange,
+				&(*job->fields)[index][0]);
+		}
+	}
+}
+
+GlyphRasterizer::GlyphRasterizer()
+{
+	m_dc = 0;
+	m_font = 0;
+	m_oldFont = 0;
+	m_supersample = 1;
+	m_padding = 0;
+	m_lineHeight = 0.0f;
+	m_ascent = 0.0f;
+}
+
+GlyphRasterizer::GlyphRasterizer(const GlyphRasterizer & other)
+{
+}
+
+GlyphRasterizer::~GlyphRasterizer()
+{
+}
+
+bool GlyphRasterizer::Initialize(const FontImportSettings & settings)
+{
+	TEXTMETRICW textMetrics;
+	int height;
+
+	m_supersample = settings.supersample;
+	m_padding = (int)ceilf(settings.distanceRange) * m_supersample;
+
+	m_dc = CreateCompatibleDC(NULL);
+	if (!m_dc)
+	{
+		return false;
+	}
+
+	// A negative height asks for the em size instead of the cell height.
+	height = (int)(settings.pixelSize * m_supersample + 0.5f);
+	m_font = CreateFontW(-height, 0, 0, 0, FW_NORMAL, FALSE, FALSE, FALSE, DEFAULT_CHARSET, OUT_TT_PRECIS, CLIP_DEFAULT_PRECIS,
+		ANTIALIASED_QUALITY, DEFAULT_PITCH | FF_DONTCARE, settings.faceName);
+	if (!m_font)
+	{
+		return false;
+	}
+
+	m_oldFont = SelectObject(m_dc, m_font);
+
+	if (!GetTextMetricsW(m_dc, &textMetrics))
+	{
+		return false;
+	}
+
+	m_lineHeight = (float)(textMetrics.tmHeight + textMetrics.tmExternalLeading) / m_supersample;
+	m_ascent = (float)textMetrics.tmAscent / m_supersample;
+
+	return true;
+}
+
+void GlyphRasterizer::Shutdown()
+{
+	if (m_dc && m_oldFont)
+	{
+		SelectObject(m_dc, m_oldFont);
+		m_oldFont = 0;
+	}
+
+	if (m_font)
+	{
+		DeleteObject(m_font);
+		m_font = 0;
+	}
+
+	if (m_dc)
+	{
+		DeleteDC(m_dc);
+		m_dc = 0;
+	}
+}
+
+bool GlyphRasterizer::Rasterize(unsigned int codepoint, GlyphCoverage & glyph)
+{
+	GLYPHMETRICS metrics;
+	MAT2 identity;
+	std::vector<unsigned char> bitmap;
+	WCHAR character;
+	WORD index;
+	DWORD size;
+	int pitch, x, y;
+
+	// GDI only looks characters up in the basic multilingual plane.
+	if (codepoint > 0xffff)
+	{
+		return false;
+	}
+
+	character = (WCHAR)codepoint;
+	if (GetGlyphIndicesW(m_dc, &character, 1, &index, GGI_MARK_NONEXISTING_GLYPHS) == GDI_ERROR || index == 0xffff)
+	{
+		return false;
+	}
+
+	memset(&identity, 0, sizeof(identity));
+	identity.eM11.value = 1;
+	identity.eM22.value = 1;
+
+	size = GetGlyphOutlineW(m_dc, codepoint, GGO_GRAY8_BITMAP, &metrics, 0, NULL, &identity);
+	if (size == GDI_ERROR)
+	{
+		return false;
+	}
+
+	glyph.codepoint = codepoint;
+	glyph.advance = (float)metrics.gmCellIncX / m_supersample;
+
+	// Nothing to draw, the glyph only moves the pen.
+	if (size == 0)
+	{
+		glyph.width = 0;
+		glyph.height = 0;
+		glyph.pixels.clear();
+		glyph.offsetX = 0.0f;
+		glyph.offsetY = 0.0f;
+		return true;
+	}
+
+	bitmap.resize(size);
+	if (GetGlyphOutlineW(m_dc, codepoint, GGO_GRAY8_BITMAP, &metrics, size, &bitmap[0], &identity) == GDI_ERROR)
+	{
+		return false;
+	}
+
+	// Leave room for the distance range on every side and round up to whole atlas pixels.
+	glyph.width = AlignUp((int)metrics.gmBlackBoxX + 2 * m_padding, m_supersample);
+	glyph.height = AlignUp((int)metrics.gmBlackBoxY + 2 * m_padding, m_supersample);
+	glyph.pixels.assign(glyph.width * glyph.height, 0);
+
+	// The rows of the bitmap are dword aligned and the coverage goes from 0 to 64.
+	pitch = ((int)metrics.gmBlackBoxX + 3) & ~3;
+	for (y = 0; y < (int)metrics.gmBlackBoxY; y++)
+	{
+		for (x = 0; x < (int)metrics.gmBlackBoxX; x++)
+		{
+			glyph.pixels[(y + m_padding) * glyph.width + x + m_padding] = (unsigned char)(bitmap[y * pitch + x] * 255 / 64);
+		}
+	}
+
+	glyph.offsetX = (float)(metrics.gmptGlyphOrigin.x - m_padding) / m_supersample;
+	glyph.offsetY = (float)(metrics.gmptGlyphOrigin.y + m_padding) / m_supersample;
+
+	return true;
+}
+
+void GlyphRasterizer::GetKerning(unsigned int first, unsigned int last, std::vector<FontKerning>& kerning)
+{
+	std::vector<KERNINGPAIR> pairs;
+	FontKerning entry;
+	DWORD count, i;
+
+	kerning.clear();
+
+	count = GetKerningPairsW(m_dc, 0, NULL);
+	if (count == 0 || count == GDI_ERROR)
+	{
+		return;
+	}
+
+	pairs.resize(count);
+	count = GetKerningPairsW(m_dc, count, &pairs[0]);
+	if (count == GDI_ERROR)
+	{
+		return;
+	}
+
+	for (i = 0; i < count; i++)
+	{
+		if (pairs[i].wFirst < first || pairs[i].wFirst > last || pairs[i].wSecond < first || pairs[i].wSecond > last)
+		{
+			continue;
+		}
+
+		entry.first = pairs[i].wFirst;
+		entry.second = pairs[i].wSecond;
+		entry.amount = (float)pairs[i].iKernAmount / m_supersample;
+		kerning.push_back(entry);
+	}
+}
+
+float GlyphRasterizer::GetLineHeight()
+{
+	return m_lineHeight;
+}
+
+float GlyphRasterizer::GetAscent()
+{
+	return m_ascent;
+}
+
+void GetDefaultFontImportSettings(FontImportSettings & settings)
+{
+	settings.faceName = FONT_IMPORT_FACE;
+	settings.pixelSize = FONT_IMPORT_PIXEL_SIZE;
+	settings.supersample = FONT_IMPORT_SUPERSAMPLE;
+	settings.distanceRange = FONT_IMPORT_DISTANCE_RANGE;
+	settings.firstCodepoint = 32;
+	settings.lastCodepoint = 126;
+	settings.atlasWidth = FONT_IMPORT_ATLAS_WIDTH;
+}
+
+bool ImportFont(const FontImportSettings & settings, const char * filename)
+{
+	PROFILE_FUNCTION();
+	GlyphRasterizer rasterizer;
+	std::vector<GlyphCoverage> coverage;
+	std::vector<std::vector<unsigned char>> fields;
+	std::vector<FontGlyph> glyphs;
+	std::vector<FontKerning> kerning;
+	std::vector<unsigned char> atlas;
+	std::vector<int> positionX, positionY;
+	FontTableHeader header;
+	FontTable table;
+	GlyphCoverage glyph;
+	FontGlyph entry;
+	FieldJob fieldJob;
+	unsigned int codepoint;
+	int fieldWidth, fieldHeight, x, y, rowHeight, atlasHeight, i, row;
+	bool result;
+
+	result = rasterizer.Initialize(settings);
+	if (!result)
+	{
+		rasterizer.Shutdown();
+		return false;
+	}
+
+	// GDI is not thread safe, so the outlines are rasterized here and only the transforms go to the job system.
+	for (codepoint = settings.firstCodepoint; codepoint <= settings.lastCodepoint; codepoint++)
+	{
+		if (rasterizer.Rasterize(codepoint, glyph))
+		{
+			coverage.push_back(glyph);
+		}
+	}
+
+	rasterizer.GetKerning(settings.firstCodepoint, settings.lastCodepoint, kerning);
+
+	header.pixelSize = settings.pixelSize;
+	header.lineHeight = rasterizer.GetLineHeight();
+	header.ascent = rasterizer.GetAscent();
+	header.distanceRange = settings.distanceRange;
+
+	rasterizer.Shutdown();
+
+	// One glyph per job, the glyphs differ a lot in size.
+	fields.resize(coverage.size());
+	fieldJob.glyphs = &coverage;
+	fieldJob.fields = &fields;
+	fieldJob.supersample = settings.supersample;
+	fieldJob.distanceRange = settings.distanceRange;
+	JobSystem::ParallelFor((int)coverage.size(), 1, BuildFields, &fieldJob);
+
+	// Pack the fields into rows from left to right with a pixel between them, so filtering never reads a neighbour.
+	positionX.resize(coverage.size());
+	positionY.resize(coverage.size());
+	x = 1;
+	y = 1;
+	rowHeight = 0;
+
+	for (i = 0; i < (int)coverage.size(); i++)
+	{
+		fieldWidth = coverage[i].width / settings.supersample;
+		fieldHeight = coverage[i].height / settings.supersample;
+
+		if (fieldWidth + 2 > settings.atlasWidth)
+		{
+			return false;
+		}
+
+		if (x + fieldWidth + 1 > settings.atlasWidth)
+		{
+			x = 1;
+			y += rowHeight + 1;
+			rowHeight = 0;
+		}
+
+		positionX[i] = x;
+		positionY[i] = y;
+
+		x += fieldWidth + 1;
+		if (fieldHeight > rowHeight)
+		{
+			rowHeight = fieldHeight;
+		}
+	}
+
+	atlasHeight = AlignUp(y + rowHeight + 1, 4);
+	atlas.assign(settings.atlasWidth * atlasHeight, 0);
+
+	for (i = 0; i < (int)coverage.size(); i++)
+	{
+		fieldWidth = coverage[i].width / settings.supersample;
+		fieldHeight = coverage[i].height / settings.supersample;
+
+		for (row = 0; row < fieldHeight; row++)
+		{
+			memcpy(&atlas[(positionY[i] + row) * settings.atlasWidth + positionX[i]], &fields[i][row * fieldWidth], fieldWidth);
+		}
+
+		entry.codepoint = coverage[i].codepoint;
+		entry.u0 = (float)positionX[i] / settings.atlasWidth;
+		entry.v0 = (float)positionY[i] / atlasHeight;
+		entry.u1 = (float)(positionX[i] + fieldWidth) / settings.atlasWidth;
+		entry.v1 = (float)(positionY[i] + fieldHeight) / atlasHeight;
+		entry.offsetX = coverage[i].offsetX;
+		entry.offsetY = coverage[i].offsetY;
+		entry.width = (float)fieldWidth;
+		entry.height = (float)fieldHeight;
+		entry.advance = coverage[i].advance;
+		glyphs.push_back(entry);
+	}
+
+	header.atlasWidth = settings.atlasWidth;
+	header.atlasHeight = atlasHeight;
+
+	table.Set(header, glyphs, kerning, atlas);
+
+	return table.Write(filename);
+}
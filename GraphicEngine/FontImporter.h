@@ -0,0 +1,73 @@
+#pragma once
+#include <Windows.h>
+#include <vector>
+#include "FontTable.h"
+#include "DistanceField.h"
+#include "JobSystem.h"
+#include "Profiler.h"
+
+// Font the engine imports when its font file is missing.
+#define FONT_IMPORT_FACE L"Segoe UI"
+#define FONT_IMPORT_PIXEL_SIZE 32.0f
+#define FONT_IMPORT_SUPERSAMPLE 4
+#define FONT_IMPORT_DISTANCE_RANGE 4.0f
+#define FONT_IMPORT_ATLAS_WIDTH 512
+
+struct FontImportSettings
+{
+	const wchar_t* faceName;
+	// Pixels per em of the atlas glyphs.
+	float pixelSize;
+	// The outlines are rasterized this many times larger than the atlas before the distance transform.
+	int supersample;
+	float distanceRange;
+	unsigned int firstCodepoint;
+	unsigned int lastCodepoint;
+	int atlasWidth;
+};
+
+// A rasterized glyph with room for the distance range around it. The size is a multiple of the supersampling,
+// the metrics are already in atlas pixels.
+struct GlyphCoverage
+{
+	unsigned int codepoint;
+	int width, height;
+	std::vector<unsigned char> pixels;
+	float offsetX, offsetY;
+	float advance;
+};
+
+// Rasterizes glyph outlines of an installed font with GDI. Not thread safe, only the distance transform is.
+class GlyphRasterizer
+{
+private:
+	HDC m_dc;
+	HFONT m_font;
+	HGDIOBJ m_oldFont;
+	int m_supersample;
+	int m_padding;
+	float m_lineHeight;
+	float m_ascent;
+public:
+	GlyphRasterizer();
+	GlyphRasterizer(const GlyphRasterizer&);
+	~GlyphRasterizer();
+
+	bool Initialize(const FontImportSettings& settings);
+	void Shutdown();
+
+	// Returns false when the font has no glyph for the codepoint. Glyphs without an outline, like the space,
+	// come back with a width and height of zero.
+	bool Rasterize(unsigned int codepoint, GlyphCoverage& glyph);
+	// Kerning pairs between codepoints of [first, last], in atlas pixels.
+	void GetKerning(unsigned int first, unsigned int last, std::vector<FontKerning>& kerning);
+
+	float GetLineHeight();
+	float GetAscent();
+};
+
+void GetDefaultFontImportSettings(FontImportSettings& settings);
+
+// Rasterizes every codepoint of the settings, runs the distance transforms on the job system, packs the fields
+// into one atlas and writes the font table.
+bool ImportFont(const FontImportSettings& settings, const char* filename);
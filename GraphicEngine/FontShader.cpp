@@ -6,11 +6,10 @@ bool FontShader::InitializeShader(ID3D11Device * device, HWND hwnd, WCHAR * vsFi
 	ID3D10Blob* errorMessage;
 	ID3D10Blob* vertexShaderBuffer;
 	ID3D10Blob* pixelShaderBuffer;
-	D3D11_INPUT_ELEMENT_DESC polygonLayout[2];
+	D3D11_INPUT_ELEMENT_DESC polygonLayout[3];
 	unsigned int numElements;
 	D3D11_BUFFER_DESC constantBufferDesc;
 	D3D11_SAMPLER_DESC samplerDesc;
-	D3D11_BUFFER_DESC pixelBufferDesc;
 
 
 	// Initialize the pointers this function will use to null.
@@ -71,7 +70,7 @@ bool FontShader::InitializeShader(ID3D11Device * device, HWND hwnd, WCHAR * vsFi
 	}
 
 	// Create the vertex input layout description.
-	// This setup needs to match the VertexType stucture in the ModelClass and in the shader.
+	// This setup needs to match the TextVertex structure and the shader.
 	polygonLayout[0].SemanticName = "POSITION";
 	polygonLayout[0].SemanticIndex = 0;
 	polygonLayout[0].Format = DXGI_FORMAT_R32G32B32_FLOAT;
@@ -88,6 +87,14 @@ bool FontShader::InitializeShader(ID3D11Device * device, HWND hwnd, WCHAR * vsFi
 	polygonLayout[1].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
 	polygonLayout[1].InstanceDataStepRate = 0;
 
+	polygonLayout[2].SemanticName = "COLOR";
+	polygonLayout[2].SemanticIndex = 0;
+	polygonLayout[2].Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+	polygonLayout[2].InputSlot = 0;
+	polygonLayout[2].AlignedByteOffset = D3D11_APPEND_ALIGNED_ELEMENT;
+	polygonLayout[2].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
+	polygonLayout[2].InstanceDataStepRate = 0;
+
 	// Get a count of the elements in the layout.
 	numElements = sizeof(polygonLayout) / sizeof(polygonLayout[0]);
 
@@ -123,9 +130,9 @@ bool FontShader::InitializeShader(ID3D11Device * device, HWND hwnd, WCHAR * vsFi
 
 	//Create the texture sampler state description
 	samplerDesc.Filter = D3D11_FILTER_MIN_MAG_MIP_LINEAR;
-	samplerDesc.AddressU = D3D11_TEXTURE_ADDRESS_WRAP;
-	samplerDesc.AddressV = D3D11_TEXTURE_ADDRESS_WRAP;
-	samplerDesc.AddressW = D3D11_TEXTURE_ADDRESS_WRAP;
+	samplerDesc.AddressU = D3D11_TEXTURE_ADDRESS_CLAMP;
+	samplerDesc.AddressV = D3D11_TEXTURE_ADDRESS_CLAMP;
+	samplerDesc.AddressW = D3D11_TEXTURE_ADDRESS_CLAMP;
 	samplerDesc.MipLODBias = 0.0f;
 	samplerDesc.MaxAnisotropy = 1;
 	samplerDesc.ComparisonFunc = D3D11_COMPARISON_ALWAYS;
@@ -143,33 +150,11 @@ bool FontShader::InitializeShader(ID3D11Device * device, HWND hwnd, WCHAR * vsFi
 		return false;
 	}
 
-	//Setup the description of the dynamic pixel constant buffer
-	pixelBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
-	pixelBufferDesc.ByteWidth = sizeof(PixelBufferType);
-	pixelBufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
-	pixelBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-	pixelBufferDesc.MiscFlags = 0;
-	pixelBufferDesc.StructureByteStride = 0;
-
-	//Creat the pixel constant buffer pointer
-	result = device->CreateBuffer(&pixelBufferDesc, NULL, &m_pixelBuffer);
-	if (FAILED(result))
-	{
-		return false;
-	}
-
 	return true;
 }
 
 void FontShader::ShutdownShader()
 {
-	// Release the pixel constant buffer.
-	if (m_pixelBuffer)
-	{
-		m_pixelBuffer->Release();
-		m_pixelBuffer = 0;
-	}
-
 	// Release the sampler state.
 	if (m_sampleState)
 	{
@@ -240,13 +225,12 @@ void FontShader::OutputShaderErrorMessage(ID3D10Blob * errorMessage, HWND hwnd,
 	MessageBox(hwnd, L"Error compiling shader.  Check shader-error.txt for message.", shaderFilename, MB_OK);
 }
 
-bool FontShader::SetShaderParameters(ID3D11DeviceContext * deviceContext, XMMATRIX worldMatrix, XMMATRIX viewMatrix, XMMATRIX projectionMatrix, ID3D11ShaderResourceView * texture, XMFLOAT4 pixelColor)
+bool FontShader::SetShaderParameters(RenderContext * deviceContext, XMMATRIX worldMatrix, XMMATRIX viewMatrix, XMMATRIX projectionMatrix, ID3D11ShaderResourceView * texture)
 {
 	HRESULT result;
 	D3D11_MAPPED_SUBRESOURCE mappedResource;
 	ConstantBufferType* dataPtr;
 	unsigned int bufferNumber;
-	PixelBufferType* dataPtr2;
 
 
 	// Lock the constant buffer so it can be written to.
@@ -256,6 +240,8 @@ bool FontShader::SetShaderParameters(ID3D11DeviceContext * deviceContext, XMMATR
 		return false;
 	}
 
+	Stats::Add(STAT_CONSTANT_BYTES, sizeof(ConstantBufferType));
+
 	// Get a pointer to the data in the constant buffer.
 	dataPtr = (ConstantBufferType*)mappedResource.pData;
 
@@ -281,32 +267,10 @@ bool FontShader::SetShaderParameters(ID3D11DeviceContext * deviceContext, XMMATR
 	// Set shader texture resource in the pixel shader.
 	deviceContext->PSSetShaderResources(0, 1, &texture);
 
-	// Lock the pixel constant buffer so it can be written to.
-	result = deviceContext->Map(m_pixelBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
-	if (FAILED(result))
-	{
-		return false;
-	}
-
-	// Get a pointer to the data in the pixel constant buffer.
-	dataPtr2 = (PixelBufferType*)mappedResource.pData;
-
-	// Copy the pixel color into the pixel constant buffer.
-	dataPtr2->pixelColor = pixelColor;
-
-	// Unlock the pixel constant buffer.
-	deviceContext->Unmap(m_pixelBuffer, 0);
-
-	// Set the position of the pixel constant buffer in the pixel shader.
-	bufferNumber = 0;
-
-	// Now set the pixel constant buffer in the pixel shader with the updated value.
-	deviceContext->PSSetConstantBuffers(bufferNumber, 1, &m_pixelBuffer);
-
 	return true;
 }
 
-void FontShader::RenderShader(ID3D11DeviceContext * deviceContext, int indexCount)
+void FontShader::RenderShader(RenderContext * deviceContext, int indexCount, int baseVertex)
 {
 	// Set the vertex input layout.
 	deviceContext->IASetInputLayout(m_layout);
@@ -319,7 +283,7 @@ void FontShader::RenderShader(ID3D11DeviceContext * deviceContext, int indexCoun
 	deviceContext->PSSetSamplers(0, 1, &m_sampleState);
 
 	// Render the triangles.
-	deviceContext->DrawIndexed(indexCount, 0, 0);
+	deviceContext->DrawIndexed(indexCount, 0, baseVertex);
 }
 
 FontShader::FontShader()
@@ -329,7 +293,6 @@ FontShader::FontShader()
 	m_layout = 0;
 	m_matrixBuffer = 0;
 	m_sampleState = 0;
-	m_pixelBuffer = 0;
 }
 
 FontShader::~FontShader()
@@ -356,21 +319,21 @@ void FontShader::Shutdown()
 	ShutdownShader();
 }
 
-bool FontShader::Render(ID3D11DeviceContext * deviceContext, int indexCount, XMMATRIX worldMatrix, XMMATRIX viewMatrix, 
-						XMMATRIX projectionMatrix, ID3D11ShaderResourceView * texture, XMFLOAT4 pixelColor)
+bool FontShader::Render(RenderContext * deviceContext, int indexCount, int baseVertex, XMMATRIX worldMatrix, XMMATRIX viewMatrix, 
+						XMMATRIX projectionMatrix, ID3D11ShaderResourceView * texture)
 {
 	bool result;
 
 
 	// Set the shader parameters that it will use for rendering.
-	result = SetShaderParameters(deviceContext, worldMatrix, viewMatrix, projectionMatrix, texture, pixelColor);
+	result = SetShaderParameters(deviceContext, worldMatrix, viewMatrix, projectionMatrix, texture);
 	if (!result)
 	{
 		return false;
 	}
 
 	// Now render the prepared buffers with the shader.
-	RenderShader(deviceContext, indexCount);
+	RenderShader(deviceContext, indexCount, baseVertex);
 
 	return true;
 }
@@ -3,6 +3,7 @@
 #include<d3dcompiler.h>
 #include<DirectXMath.h>
 #include<fstream>
+#include "RenderContext.h"
 using namespace DirectX;
 using namespace std;
 
@@ -16,25 +17,19 @@ private:
 		XMMATRIX projection;
 	};
 
-	struct PixelBufferType
-	{
-		XMFLOAT4 pixelColor;
-	};
-
 	ID3D11VertexShader* m_vertexShader;
 	ID3D11PixelShader* m_pixelShader;
 	ID3D11InputLayout* m_layout;
 	ID3D11Buffer* m_matrixBuffer;
 	ID3D11SamplerState* m_sampleState;
-	ID3D11Buffer* m_pixelBuffer;
 
 	bool InitializeShader(ID3D11Device* device, HWND hwnd, WCHAR* vsFilename, WCHAR* psFilename);
 	void ShutdownShader();
 	void OutputShaderErrorMessage(ID3D10Blob* errorMessage, HWND hwnd, WCHAR* shaderFilename);
 
-	bool SetShaderParameters(ID3D11DeviceContext* deviceContext, XMMATRIX worldMatrix, XMMATRIX viewMatrix,
-		XMMATRIX projectionMatrix, ID3D11ShaderResourceView* texture, XMFLOAT4 pixelColor);
-	void RenderShader(ID3D11DeviceContext* deviceContext, int indexCount);
+	bool SetShaderParameters(RenderContext* deviceContext, XMMATRIX worldMatrix, XMMATRIX viewMatrix,
+		XMMATRIX projectionMatrix, ID3D11ShaderResourceView* texture);
+	void RenderShader(RenderContext* deviceContext, int indexCount, int baseVertex);
 
 public:
 	FontShader();
@@ -42,6 +37,7 @@ public:
 
 	bool Initialize(ID3D11Device* device, HWND hwnd);
 	void Shutdown();
-	bool Render(ID3D11DeviceContext* deviceContext, int indexCount, XMMATRIX worldMatrix, XMMATRIX viewMatrix,
-		XMMATRIX projectionMatrix, ID3D11ShaderResourceView* texture, XMFLOAT4 pixelColor);
+	// Draws text vertices, the color comes with every vertex.
+	bool Render(RenderContext* deviceContext, int indexCount, int baseVertex, XMMATRIX worldMatrix, XMMATRIX viewMatrix,
+		XMMATRIX projectionMatrix, ID3D11ShaderResourceView* texture);
 };
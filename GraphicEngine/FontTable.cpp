@@ -0,0 +1,164 @@
+#include "FontTable.h"
+#include <string.h>
+#include <fstream>
+#include <algorithm>
+
+namespace
+{
+	bool GlyphLess(const FontGlyph& a, const FontGlyph& b)
+	{
+		return a.codepoint < b.codepoint;
+	}
+
+	bool KerningLess(const FontKerning& a, const FontKerning& b)
+	{
+		return a.first < b.first || (a.first == b.first && a.second < b.second);
+	}
+}
+
+FontTable::FontTable()
+{
+	memset(&m_header, 0, sizeof(m_header));
+}
+
+FontTable::~FontTable()
+{
+}
+
+bool FontTable::Read(const char * filename)
+{
+	std::ifstream fin;
+	size_t atlasSize;
+
+	fin.open(filename, std::ios::binary);
+	if (fin.fail())
+	{
+		return false;
+	}
+
+	fin.read((char*)&m_header, sizeof(m_header));
+	if (fin.fail() || m_header.magic != FONT_TABLE_MAGIC || m_header.version != FONT_TABLE_VERSION)
+	{
+		return false;
+	}
+
+	atlasSize = (size_t)m_header.atlasWidth * m_header.atlasHeight;
+
+	m_glyphs.resize(m_header.glyphCount);
+	m_kerning.resize(m_header.kerningCount);
+	m_atlas.resize(atlasSize);
+
+	// The tables are stored exactly as they are kept in memory.
+	if (!m_glyphs.empty())
+	{
+		fin.read((char*)&m_glyphs[0], sizeof(FontGlyph) * m_glyphs.size());
+	}
+
+	if (!m_kerning.empty())
+	{
+		fin.read((char*)&m_kerning[0], sizeof(FontKerning) * m_kerning.size());
+	}
+
+	if (!m_atlas.empty())
+	{
+		fin.read((char*)&m_atlas[0], m_atlas.size());
+	}
+
+	return !fin.fail();
+}
+
+bool FontTable::Write(const char * filename)
+{
+	std::ofstream fout;
+
+	fout.open(filename, std::ios::binary);
+	if (fout.fail())
+	{
+		return false;
+	}
+
+	fout.write((const char*)&m_header, sizeof(m_header));
+
+	if (!m_glyphs.empty())
+	{
+		fout.write((const char*)&m_glyphs[0], sizeof(FontGlyph) * m_glyphs.size());
+	}
+
+	if (!m_kerning.empty())
+	{
+		fout.write((const char*)&m_kerning[0], sizeof(FontKerning) * m_kerning.size());
+	}
+
+	if (!m_atlas.empty())
+	{
+		fout.write((const char*)&m_atlas[0], m_atlas.size());
+	}
+
+	fout.close();
+
+	return !fout.fail();
+}
+
+void FontTable::Set(const FontTableHeader & header, const std::vector<FontGlyph>& glyphs, const std::vector<FontKerning>& kerning,
+	const std::vector<unsigned char>& atlas)
+{
+	m_header = header;
+	m_glyphs = glyphs;
+	m_kerning = kerning;
+	m_atlas = atlas;
+
+	// Lookups are binary searches.
+	std::sort(m_glyphs.begin(), m_glyphs.end(), GlyphLess);
+	std::sort(m_kerning.begin(), m_kerning.end(), KerningLess);
+
+	m_header.magic = FONT_TABLE_MAGIC;
+	m_header.version = FONT_TABLE_VERSION;
+	m_header.glyphCount = (unsigned int)m_glyphs.size();
+	m_header.kerningCount = (unsigned int)m_kerning.size();
+}
+
+const FontGlyph * FontTable::FindGlyph(unsigned int codepoint) const
+{
+	std::vector<FontGlyph>::const_iterator it;
+	FontGlyph key;
+
+	key.codepoint = codepoint;
+	it = std::lower_bound(m_glyphs.begin(), m_glyphs.end(), key, GlyphLess);
+	if (it == m_glyphs.end() || it->codepoint != codepoint)
+	{
+		return 0;
+	}
+
+	return &*it;
+}
+
+float FontTable::GetKerning(unsigned int first, unsigned int second) const
+{
+	std::vector<FontKerning>::const_iterator it;
+	FontKerning key;
+
+	if (m_kerning.empty())
+	{
+		return 0.0f;
+	}
+
+	key.first = first;
+	key.second = second;
+	it = std::lower_bound(m_kerning.begin(), m_kerning.end(), key, KerningLess);
+	if (it == m_kerning.end() || it->first != first || it->second != second)
+	{
+		return 0.0f;
+	}
+
+	return it->amount;
+}
+
+const FontTableHeader & FontTable::GetHeader() const
+{
+	return m_header;
+}
+
+const unsigned char * FontTable::GetAtlas() const
+{
+	return m_atlas.empty() ? 0 : &m_atlas[0];
+}
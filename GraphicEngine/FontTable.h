@@ -0,0 +1,68 @@
+#pragma once
+#include <vector>
+
+// Compact binary font file: a header, the glyphs sorted by codepoint, the kerning pairs sorted by first and
+// second codepoint and the one channel distance field atlas, row by row. Nothing in here touches Windows or
+// Direct3D.
+
+#define FONT_TABLE_MAGIC 0x4e465344
+#define FONT_TABLE_VERSION 1
+
+struct FontTableHeader
+{
+	unsigned int magic;
+	unsigned int version;
+	unsigned int glyphCount;
+	unsigned int kerningCount;
+	// Size the metrics are given in, in pixels per em.
+	float pixelSize;
+	float lineHeight;
+	float ascent;
+	// Atlas pixels between the edge and a field value of 0 or 255.
+	float distanceRange;
+	unsigned int atlasWidth;
+	unsigned int atlasHeight;
+};
+
+// Metrics in pixels at the size of the table. The quad of a glyph starts offsetX right of the pen and reaches
+// offsetY above the baseline, it includes the distance range around the outline.
+struct FontGlyph
+{
+	unsigned int codepoint;
+	float u0, v0, u1, v1;
+	float offsetX, offsetY;
+	float width, height;
+	float advance;
+};
+
+struct FontKerning
+{
+	unsigned int first, second;
+	float amount;
+};
+
+class FontTable
+{
+private:
+	FontTableHeader m_header;
+	std::vector<FontGlyph> m_glyphs;
+	std::vector<FontKerning> m_kerning;
+	std::vector<unsigned char> m_atlas;
+public:
+	FontTable();
+	~FontTable();
+
+	bool Read(const char* filename);
+	bool Write(const char* filename);
+
+	// Takes over the tables and sorts them, the atlas is atlasWidth * atlasHeight bytes.
+	void Set(const FontTableHeader& header, const std::vector<FontGlyph>& glyphs, const std::vector<FontKerning>& kerning,
+		const std::vector<unsigned char>& atlas);
+
+	// Returns 0 when the font has no glyph for the codepoint.
+	const FontGlyph* FindGlyph(unsigned int codepoint) const;
+	float GetKerning(unsigned int first, unsigned int second) const;
+
+	const FontTableHeader& GetHeader() const;
+	const unsigned char* GetAtlas() const;
+};
@@ -3,19 +3,53 @@
 ForwardRenderer::ForwardRenderer()
 {
 	m_Shader = 0;
-	m_frameLights = 0;
-	m_frameModels = 0;
-	m_Model = 0;
+	m_Instancer = 0;
+	m_Clusters = 0;
+	m_ObjectConstants = 0;
+	m_objectOffsets = 0;
+	m_Recorder = 0;
+	m_GpuTimer = 0;
+
+	m_cullShader = 0;
+	m_cullBuffer = 0;
+	m_tileBuffer = 0;
+	m_pointLightBuffer = 0;
+	m_pointLightView = 0;
+	m_tileLightBuffer = 0;
+	m_tileLightView = 0;
+	m_tileLightAccess = 0;
+	m_clusterRangeBuffer = 0;
+	m_clusterRangeView = 0;
+	m_clusterIndexBuffer = 0;
+	m_clusterIndexView = 0;
+	m_depthEqualState = 0;
+	m_depthPrePass = true;
+	m_multithreaded = true;
+
+	m_Lights = 0;
+	m_lightingMode = LIGHTING_TILED;
+
+	m_screenWidth = 0;
+	m_screenHeight = 0;
+	m_tilesX = 0;
+	m_tilesY = 0;
 }
 
 ForwardRenderer::~ForwardRenderer()
 {
 }
 
-bool ForwardRenderer::Initialize(ID3D11Device* device, HWND hwnd)
+bool ForwardRenderer::Initialize(ID3D11Device* device, RenderStateCache* stateCache, HWND hwnd, int screenWidth, int screenHeight, float screenNear,
+	float screenDepth, int maxDraws)
 {
 	bool result;
 
+	//Store the screen size and the number of light tiles that cover it
+	m_screenWidth = screenWidth;
+	m_screenHeight = screenHeight;
+	m_tilesX = GetLightTileCount(screenWidth);
+	m_tilesY = GetLightTileCount(screenHeight);
+
 	// Create the light shader object.
 	m_Shader = new LightShader;
 	if (!m_Shader)
@@ -23,21 +57,489 @@ bool ForwardRenderer::Initialize(ID3D11Device* device, HWND hwnd)
 		return false;
 	}
 
-
-	// Initialize the texture shader object.
-	result = m_Shader->Initialize(device, hwnd);
+	// Initialize the light shader object.
+	result = m_Shader->Initialize(device, hwnd, maxDraws);
 	if (!result)
 	{
 		MessageBox(hwnd, L"Could not initialize the light shader object.", L"Error", MB_OK);
 		return false;
 	}
 
+	// Create the instance batcher object.
+	m_Instancer = new InstanceBatcher;
+	if (!m_Instancer)
+	{
+		return false;
+	}
+
+	// Initialize the instance batcher with room for as many instances as the light shader can take.
+	result = m_Instancer->Initialize(maxDraws);
+	if (!result)
+	{
+		MessageBox(hwnd, L"Could not initialize the instance batcher object.", L"Error", MB_OK);
+		return false;
+	}
+
+	// Create the per object constant ring.
+	m_ObjectConstants = new ConstantRing;
+	if (!m_ObjectConstants)
+	{
+		return false;
+	}
+
+	// Initialize the ring with room for a few frames worth of single draws.
+	result = m_ObjectConstants->Initialize(device, stateCache, OBJECT_CONSTANT_RING_FRAMES * maxDraws * CONSTANT_RING_ALIGNMENT,
+		sizeof(LightShader::ObjectBufferType));
+	if (!result)
+	{
+		MessageBox(hwnd, L"Could not initialize the object constant ring.", L"Error", MB_OK);
+		return false;
+	}
+
+	// Create the ring offset of every batch.
+	m_objectOffsets = new unsigned int[maxDraws];
+	if (!m_objectOffsets)
+	{
+		return false;
+	}
+
+	// Create the command recorder object.
+	m_Recorder = new CommandRecorder;
+	if (!m_Recorder)
+	{
+		return false;
+	}
+
+	// Initialize the command recorder with a worker for every spare hardware thread.
+	result = m_Recorder->Initialize(device, stateCache->GetRenderContext(), CommandRecorder::GetDefaultWorkerCount());
+	if (!result)
+	{
+		MessageBox(hwnd, L"Could not initialize the command recorder object.", L"Error", MB_OK);
+		return false;
+	}
+
+	// Create the light manager object.
+	m_Lights = new LightManager;
+	if (!m_Lights)
+	{
+		return false;
+	}
+
+	// Initialize the light manager with room for every light the light buffer can hold.
+	result = m_Lights->Initialize(LIGHT_MAX_LIGHTS);
+	if (!result)
+	{
+		MessageBox(hwnd, L"Could not initialize the light manager object.", L"Error", MB_OK);
+		return false;
+	}
+
+	// Create the light cluster builder object.
+	m_Clusters = new LightClusterBuilder;
+	if (!m_Clusters)
+	{
+		return false;
+	}
+
+	// Initialize the light cluster builder for every light the point light buffer can hold.
+	result = m_Clusters->Initialize(screenWidth, screenHeight, screenNear, screenDepth, LIGHT_MAX_LIGHTS);
+	if (!result)
+	{
+		MessageBox(hwnd, L"Could not initialize the light cluster builder object.", L"Error", MB_OK);
+		return false;
+	}
+
+	// Initialize the light culling stage.
+	result = InitializeCulling(device, hwnd, L"../GraphicEngine/Shaders/light_cull_cs.hlsl");
+	if (!result)
+	{
+		MessageBox(hwnd, L"Could not initialize the light culling stage.", L"Error", MB_OK);
+		return false;
+	}
+
+	// Initialize the cluster lists of the clustered mode.
+	result = InitializeClusters(device);
+	if (!result)
+	{
+		MessageBox(hwnd, L"Could not initialize the light clusters.", L"Error", MB_OK);
+		return false;
+	}
+
 	return true;
 }
 
+bool ForwardRenderer::InitializeCulling(ID3D11Device * device, HWND hwnd, WCHAR * csFilename)
+{
+	HRESULT result;
+	ID3D10Blob* errorMessage;
+	ID3D10Blob* computeShaderBuffer;
+	D3D11_BUFFER_DESC bufferDesc;
+	D3D11_SUBRESOURCE_DATA tileData;
+	D3D11_SHADER_RESOURCE_VIEW_DESC viewDesc;
+	D3D11_UNORDERED_ACCESS_VIEW_DESC accessDesc;
+	D3D11_DEPTH_STENCIL_DESC depthStencilDesc;
+	TileBufferType tileBuffer;
+
+	//Initialize the pointers this function will use to null
+	errorMessage = 0;
+	computeShaderBuffer = 0;
+
+	// Compile the light culling compute shader code.
+	result = D3DCompileFromFile(csFilename, NULL, D3D_COMPILE_STANDARD_FILE_INCLUDE, "LightCullComputeShader", "cs_5_0", D3D10_SHADER_ENABLE_STRICTNESS, 0,
+		&computeShaderBuffer, &errorMessage);
+	if (FAILED(result))
+	{
+		// If the shader failed to compile it should have writen something to the error message.
+		if (errorMessage)
+		{
+			OutputShaderErrorMessage(errorMessage, hwnd, csFilename);
+		}
+		// If there was nothing in the error message then it simply could not find the shader file itself.
+		else
+		{
+			MessageBox(hwnd, csFilename, L"Missing Shader File", MB_OK);
+		}
+
+		return false;
+	}
+
+	// Create the compute shader from the buffer.
+	result = device->CreateComputeShader(computeShaderBuffer->GetBufferPointer(), computeShaderBuffer->GetBufferSize(), NULL, &m_cullShader);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	computeShaderBuffer->Release();
+	computeShaderBuffer = 0;
+
+	// Setup the dynamic constant buffer of the culling pass.
+	bufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+	bufferDesc.ByteWidth = sizeof(CullBufferType);
+	bufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+	bufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+	bufferDesc.MiscFlags = 0;
+	bufferDesc.StructureByteStride = 0;
+
+	result = device->CreateBuffer(&bufferDesc, NULL, &m_cullBuffer);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	// The pixel shader only needs the size of the tile and cluster grids, that never changes.
+	tileBuffer.tilesX = m_tilesX;
+	tileBuffer.clusterTilesX = m_Clusters->GetTilesX();
+	tileBuffer.clusterTilesY = m_Clusters->GetTilesY();
+	tileBuffer.padding = 0.0f;
+	tileBuffer.sliceParameters = m_Clusters->GetSliceParameters();
+	tileBuffer.slicePadding = XMFLOAT2(0.0f, 0.0f);
+
+	tileData.pSysMem = &tileBuffer;
+	tileData.SysMemPitch = 0;
+	tileData.SysMemSlicePitch = 0;
+
+	bufferDesc.Usage = D3D11_USAGE_IMMUTABLE;
+	bufferDesc.ByteWidth = sizeof(TileBufferType);
+	bufferDesc.CPUAccessFlags = 0;
+
+	result = device->CreateBuffer(&bufferDesc, &tileData, &m_tileBuffer);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	// Setup the structured buffer that holds the lights, only the changed range is updated each frame.
+	bufferDesc.Usage = D3D11_USAGE_DEFAULT;
+	bufferDesc.ByteWidth = sizeof(PointLight) * LIGHT_MAX_LIGHTS;
+	bufferDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+	bufferDesc.CPUAccessFlags = 0;
+	bufferDesc.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
+	bufferDesc.StructureByteStride = sizeof(PointLight);
+
+	result = device->CreateBuffer(&bufferDesc, NULL, &m_pointLightBuffer);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	viewDesc.Format = DXGI_FORMAT_UNKNOWN;
+	viewDesc.ViewDimension = D3D11_SRV_DIMENSION_BUFFER;
+	viewDesc.Buffer.FirstElement = 0;
+	viewDesc.Buffer.NumElements = LIGHT_MAX_LIGHTS;
+
+	result = device->CreateShaderResourceView(m_pointLightBuffer, &viewDesc, &m_pointLightView);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	// Setup the per tile light lists, written by the compute shader and read by the pixel shader.
+	bufferDesc.Usage = D3D11_USAGE_DEFAULT;
+	bufferDesc.ByteWidth = sizeof(unsigned int) * m_tilesX * m_tilesY * LIGHT_TILE_STRIDE;
+	bufferDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_UNORDERED_ACCESS;
+	bufferDesc.CPUAccessFlags = 0;
+	bufferDesc.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
+	bufferDesc.StructureByteStride = sizeof(unsigned int);
+
+	result = device->CreateBuffer(&bufferDesc, NULL, &m_tileLightBuffer);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	viewDesc.Buffer.NumElements = m_tilesX * m_tilesY * LIGHT_TILE_STRIDE;
+
+	result = device->CreateShaderResourceView(m_tileLightBuffer, &viewDesc, &m_tileLightView);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	accessDesc.Format = DXGI_FORMAT_UNKNOWN;
+	accessDesc.ViewDimension = D3D11_UAV_DIMENSION_BUFFER;
+	accessDesc.Buffer.FirstElement = 0;
+	accessDesc.Buffer.NumElements = m_tilesX * m_tilesY * LIGHT_TILE_STRIDE;
+	accessDesc.Buffer.Flags = 0;
+
+	result = device->CreateUnorderedAccessView(m_tileLightBuffer, &accessDesc, &m_tileLightAccess);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	// The shading pass only passes the pixels that won the pre-pass and does not write the depth again.
+	ZeroMemory(&depthStencilDesc, sizeof(depthStencilDesc));
+	depthStencilDesc.DepthEnable = true;
+	depthStencilDesc.DepthWriteMask = D3D11_DEPTH_WRITE_MASK_ZERO;
+	depthStencilDesc.DepthFunc = D3D11_COMPARISON_EQUAL;
+	depthStencilDesc.StencilEnable = false;
+
+	result = device->CreateDepthStencilState(&depthStencilDesc, &m_depthEqualState);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	return true;
+}
+
+bool ForwardRenderer::InitializeClusters(ID3D11Device * device)
+{
+	HRESULT result;
+	D3D11_BUFFER_DESC bufferDesc;
+	D3D11_SHADER_RESOURCE_VIEW_DESC viewDesc;
+
+	// Setup the offset and count of every cluster, rewritten every frame the clustered mode is used.
+	bufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+	bufferDesc.ByteWidth = sizeof(unsigned int) * 2 * m_Clusters->GetClusterCount();
+	bufferDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+	bufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+	bufferDesc.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
+	bufferDesc.StructureByteStride = sizeof(unsigned int) * 2;
+
+	result = device->CreateBuffer(&bufferDesc, NULL, &m_clusterRangeBuffer);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	viewDesc.Format = DXGI_FORMAT_UNKNOWN;
+	viewDesc.ViewDimension = D3D11_SRV_DIMENSION_BUFFER;
+	viewDesc.Buffer.FirstElement = 0;
+	viewDesc.Buffer.NumElements = m_Clusters->GetClusterCount();
+
+	result = device->CreateShaderResourceView(m_clusterRangeBuffer, &viewDesc, &m_clusterRangeView);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	// Setup the compact light index list the cluster ranges point into.
+	bufferDesc.ByteWidth = sizeof(unsigned int) * LIGHT_CLUSTER_MAX_INDICES;
+	bufferDesc.StructureByteStride = sizeof(unsigned int);
+
+	result = device->CreateBuffer(&bufferDesc, NULL, &m_clusterIndexBuffer);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	viewDesc.Buffer.NumElements = LIGHT_CLUSTER_MAX_INDICES;
+
+	result = device->CreateShaderResourceView(m_clusterIndexBuffer, &viewDesc, &m_clusterIndexView);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	return true;
+}
+
+void ForwardRenderer::OutputShaderErrorMessage(ID3D10Blob * errorMessage, HWND hwnd, WCHAR * shaderFilename)
+{
+	char* compileErrors;
+	unsigned long bufferSize, i;
+	ofstream fout;
+
+	// Get a pointer to the error message text buffer.
+	compileErrors = (char*)(errorMessage->GetBufferPointer());
+
+	// Get the length of the message.
+	bufferSize = errorMessage->GetBufferSize();
+
+	// Open a file to write the error message to.
+	fout.open("shader-error.txt");
+
+	// Write out the error message.
+	for (i = 0; i<bufferSize; i++)
+	{
+		fout << compileErrors[i];
+	}
+
+	// Close the file.
+	fout.close();
+
+	// Release the error message.
+	errorMessage->Release();
+	errorMessage = 0;
+
+	// Pop a message up on the screen to notify the user to check the text file for compile errors.
+	MessageBox(hwnd, L"Error compiling shader.  Check shader-error.txt for message.", shaderFilename, MB_OK);
+}
+
 void ForwardRenderer::Shutdown()
 {
-	// Release the color shader object.
+	// Release the depth state of the shading pass.
+	if (m_depthEqualState)
+	{
+		m_depthEqualState->Release();
+		m_depthEqualState = 0;
+	}
+
+	// Release the cluster light lists.
+	if (m_clusterIndexView)
+	{
+		m_clusterIndexView->Release();
+		m_clusterIndexView = 0;
+	}
+
+	if (m_clusterIndexBuffer)
+	{
+		m_clusterIndexBuffer->Release();
+		m_clusterIndexBuffer = 0;
+	}
+
+	if (m_clusterRangeView)
+	{
+		m_clusterRangeView->Release();
+		m_clusterRangeView = 0;
+	}
+
+	if (m_clusterRangeBuffer)
+	{
+		m_clusterRangeBuffer->Release();
+		m_clusterRangeBuffer = 0;
+	}
+
+	// Release the tile light lists.
+	if (m_tileLightAccess)
+	{
+		m_tileLightAccess->Release();
+		m_tileLightAccess = 0;
+	}
+
+	if (m_tileLightView)
+	{
+		m_tileLightView->Release();
+		m_tileLightView = 0;
+	}
+
+	if (m_tileLightBuffer)
+	{
+		m_tileLightBuffer->Release();
+		m_tileLightBuffer = 0;
+	}
+
+	// Release the point light buffer.
+	if (m_pointLightView)
+	{
+		m_pointLightView->Release();
+		m_pointLightView = 0;
+	}
+
+	if (m_pointLightBuffer)
+	{
+		m_pointLightBuffer->Release();
+		m_pointLightBuffer = 0;
+	}
+
+	// Release the constant buffers.
+	if (m_tileBuffer)
+	{
+		m_tileBuffer->Release();
+		m_tileBuffer = 0;
+	}
+
+	if (m_cullBuffer)
+	{
+		m_cullBuffer->Release();
+		m_cullBuffer = 0;
+	}
+
+	// Release the light culling compute shader.
+	if (m_cullShader)
+	{
+		m_cullShader->Release();
+		m_cullShader = 0;
+	}
+
+	// Release the light manager object.
+	if (m_Lights)
+	{
+		m_Lights->Shutdown();
+		delete m_Lights;
+		m_Lights = 0;
+	}
+
+	// Release the light cluster builder object.
+	if (m_Clusters)
+	{
+		m_Clusters->Shutdown();
+		delete m_Clusters;
+		m_Clusters = 0;
+	}
+
+	// Release the command recorder object.
+	if (m_Recorder)
+	{
+		m_Recorder->Shutdown();
+		delete m_Recorder;
+		m_Recorder = 0;
+	}
+
+	// Release the per object constant ring.
+	if (m_objectOffsets)
+	{
+		delete[] m_objectOffsets;
+		m_objectOffsets = 0;
+	}
+
+	if (m_ObjectConstants)
+	{
+		m_ObjectConstants->Shutdown();
+		delete m_ObjectConstants;
+		m_ObjectConstants = 0;
+	}
+
+	// Release the instance batcher object.
+	if (m_Instancer)
+	{
+		m_Instancer->Shutdown();
+		delete m_Instancer;
+		m_Instancer = 0;
+	}
+
+	// Release the light shader object.
 	if (m_Shader)
 	{
 		m_Shader->Shutdown();
@@ -46,49 +548,457 @@ void ForwardRenderer::Shutdown()
 	}
 }
 
-bool ForwardRenderer::SetupData(ModelList* modelList, Light* light, ModelAsset* model)
+LightManager * ForwardRenderer::GetLightManager()
+{
+	return m_Lights;
+}
+
+void ForwardRenderer::SetLightingMode(LightingMode mode)
+{
+	m_lightingMode = mode;
+	m_Shader->SetClustered(mode == LIGHTING_CLUSTERED);
+}
+
+LightingMode ForwardRenderer::GetLightingMode()
+{
+	return m_lightingMode;
+}
+
+void ForwardRenderer::SetDepthPrePass(bool enabled)
+{
+	m_depthPrePass = enabled;
+}
+
+bool ForwardRenderer::IsDepthPrePassEnabled()
+{
+	return m_depthPrePass || m_lightingMode == LIGHTING_TILED;
+}
+
+void ForwardRenderer::SetMultithreadedRecording(bool enabled)
+{
+	m_multithreaded = enabled;
+}
+
+bool ForwardRenderer::IsMultithreadedRecordingEnabled()
+{
+	return m_multithreaded;
+}
+
+void ForwardRenderer::SetGpuTimer(GpuTimer * gpuTimer)
+{
+	m_GpuTimer = gpuTimer;
+}
+
+int ForwardRenderer::BeginGpuScope(RenderContext * deviceContext, const char * name)
+{
+	if (!m_GpuTimer)
+	{
+		return -1;
+	}
+
+	return m_GpuTimer->BeginScope(deviceContext, name);
+}
+
+void ForwardRenderer::EndGpuScope(RenderContext * deviceContext, int scope)
 {
-	m_frameModels = modelList;
-	m_frameLights = light;
-	m_Model = model;
+	if (m_GpuTimer)
+	{
+		m_GpuTimer->EndScope(deviceContext, scope);
+	}
+}
+
+int ForwardRenderer::GetPointLightCount()
+{
+	return m_Lights->GetLightCount();
+}
+
+bool ForwardRenderer::WriteObjectConstants(RenderContext * deviceContext, RenderQueue * renderQueue)
+{
+	bool result;
+	void* destination;
+	int index, singleCount;
+
+	//Batches of more than one instance take their world matrices from the instance buffer
+	singleCount = 0;
+	for (index = 0; index < m_Instancer->GetBatchCount(); index++)
+	{
+		if (m_Instancer->GetBatch(index).instanceCount == 1)
+		{
+			singleCount++;
+		}
+	}
+
+	if (singleCount == 0)
+	{
+		return true;
+	}
+
+	//Write the constants of every single draw with one map of the ring
+	result = m_ObjectConstants->Map(deviceContext, singleCount * ConstantRing::Align(sizeof(LightShader::ObjectBufferType)));
+	if (!result)
+	{
+		return false;
+	}
+
+	for (index = 0; index < m_Instancer->GetBatchCount(); index++)
+	{
+		const InstanceBatch& batch = m_Instancer->GetBatch(index);
+		if (batch.instanceCount != 1)
+		{
+			continue;
+		}
+
+		const DrawCall& queued = renderQueue->GetDraw(batch.firstDraw);
+
+		destination = m_ObjectConstants->Allocate(sizeof(LightShader::ObjectBufferType), m_objectOffsets[index]);
+		LightShader::WriteObjectConstants(destination, XMLoadFloat4x4(&queued.worldMatrix), queued.color);
+	}
+
+	m_ObjectConstants->Unmap(deviceContext);
 
 	return true;
 }
 
-bool ForwardRenderer::Render(D3D* directX, Camera* camera)
+bool ForwardRenderer::RenderDepth(RenderStateCache * stateCache, RenderQueue* renderQueue)
 {
 	bool result;
-	XMMATRIX worldMatrix, viewMatrix, projectionMatrix;
-	float positionX, positionY, positionZ, radius;
+	int order, index;
+
+	//Lay down the depth of every batch front to back, nothing is shaded yet
+	for (order = 0; order < m_Instancer->GetBatchCount(); order++)
+	{
+		index = m_Instancer->GetDepthOrderedBatch(order);
+
+		const InstanceBatch& batch = m_Instancer->GetBatch(index);
+		const DrawCall& queued = renderQueue->GetDraw(batch.firstDraw);
+
+		//Only the positions are needed, which keeps the vertex fetch small
+		stateCache->SetVertexBuffer(0, queued.mesh->positionBuffer, queued.mesh->positionStride, 0);
+		stateCache->SetIndexBuffer(queued.mesh->indexBuffer, queued.mesh->indexFormat);
+		stateCache->SetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+
+		if (batch.instanceCount == 1)
+		{
+			result = m_Shader->RenderDepth(stateCache, m_ObjectConstants, m_objectOffsets[index], queued.indexCount);
+			if (!result)
+			{
+				return false;
+			}
+		}
+		else
+		{
+			m_Shader->RenderInstancedDepth(stateCache, queued.indexCount, batch.instanceCount, batch.firstInstance);
+		}
+	}
+
+	return true;
+}
+
+bool ForwardRenderer::RenderShading(RenderStateCache * stateCache, RenderQueue * renderQueue, bool prePass, int firstBatch, int batchCount)
+{
+	bool result;
+	int order, index;
+
+	//Bind the per frame state, a deferred context starts without any of it
+	m_Shader->BindFrameResources(stateCache);
+
+	stateCache->SetPSShaderResource(1, m_pointLightView);
+	stateCache->SetPSShaderResource(2, m_tileLightView);
+	stateCache->SetPSShaderResource(3, m_clusterRangeView);
+	stateCache->SetPSShaderResource(4, m_clusterIndexView);
+	stateCache->SetPSConstantBuffer(1, m_tileBuffer);
+
+	for (order = firstBatch; order < firstBatch + batchCount; order++)
+	{
+		//With the pre-pass the depth test rejects the hidden pixels anyway, so keep the state order,
+		//without it draw front to back so the early depth test rejects what is hidden
+		index = prePass ? order : m_Instancer->GetDepthOrderedBatch(order);
+
+		const InstanceBatch& batch = m_Instancer->GetBatch(index);
+		const DrawCall& queued = renderQueue->GetDraw(batch.firstDraw);
+
+		//Put the mesh vertex and index buffer on the graphics pipeline, the cache drops them when they are already bound
+		stateCache->SetVertexBuffer(0, queued.mesh->vertexBuffer, queued.mesh->vertexStride, 0);
+		stateCache->SetIndexBuffer(queued.mesh->indexBuffer, queued.mesh->indexFormat);
+		stateCache->SetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+
+		//Render the batch using the light shader, the texture is the only per material state
+		if (batch.instanceCount == 1)
+		{
+			result = m_Shader->Render(stateCache, m_ObjectConstants, m_objectOffsets[index], queued.indexCount, queued.texture);
+			if (!result)
+			{
+				return false;
+			}
+		}
+		else
+		{
+			m_Shader->RenderInstanced(stateCache, queued.indexCount, batch.instanceCount, batch.firstInstance, queued.texture);
+		}
+	}
+
+	return true;
+}
+
+bool ForwardRenderer::RecordShading(void * userData, RenderStateCache * stateCache, const RecordChunk & chunk)
+{
+	ShadingJob* job;
+
+	//Runs on a worker thread, everything it reads stays unchanged until all workers are done
+	job = (ShadingJob*)userData;
 
-	for (int i = 0; i < m_frameModels->GetModelCount(); i++)
+	return job->renderer->RenderShading(stateCache, job->renderQueue, job->prePass, chunk.first, chunk.count);
+}
+
+bool ForwardRenderer::UploadPointLights(RenderContext * deviceContext)
+{
+	D3D11_BOX box;
+	int first, count;
+
+	//Only upload the lights that changed since the last frame
+	if (!m_Lights->GetDirtyRange(first, count))
 	{
+		return true;
+	}
+
+	box.left = first * sizeof(PointLight);
+	box.right = (first + count) * sizeof(PointLight);
+	box.top = 0;
+	box.bottom = 1;
+	box.front = 0;
+	box.back = 1;
+
+	deviceContext->UpdateSubresource(m_pointLightBuffer, 0, &box, m_Lights->GetLights() + first, 0, 0);
+
+	m_Lights->ClearDirtyRange();
+
+	return true;
+}
+
+bool ForwardRenderer::BuildClusters(RenderContext * deviceContext, XMMATRIX viewMatrix, XMMATRIX projectionMatrix)
+{
+	HRESULT result;
+	D3D11_MAPPED_SUBRESOURCE mappedResource;
+
+	//Assign the point lights to the clusters they touch, this does not need the pre-pass depth
+	m_Clusters->Build(m_Lights->GetLights(), m_Lights->GetLightCount(), viewMatrix, projectionMatrix);
+	if (m_Clusters->HasOverflowed())
+	{
+		//The clusters past the end of the index list miss some of their lights
+		Stats::Add(STAT_CLUSTER_INDICES_DROPPED, m_Clusters->GetDroppedIndexCount());
+	}
+
+	//Upload the cluster ranges and the light indices they point into
+	result = deviceContext->Map(m_clusterRangeBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	memcpy(mappedResource.pData, m_Clusters->GetClusterRanges(), sizeof(unsigned int) * 2 * m_Clusters->GetClusterCount());
+
+	deviceContext->Unmap(m_clusterRangeBuffer, 0);
+
+	result = deviceContext->Map(m_clusterIndexBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	memcpy(mappedResource.pData, m_Clusters->GetLightIndices(), sizeof(unsigned int) * m_Clusters->GetLightIndexCount());
 
+	deviceContext->Unmap(m_clusterIndexBuffer, 0);
+
+	return true;
+}
+
+bool ForwardRenderer::CullLights(RenderStateCache* stateCache, const RenderTargets& targets, XMMATRIX viewMatrix, XMMATRIX projectionMatrix)
+{
+	HRESULT result;
+	RenderContext* deviceContext;
+	D3D11_MAPPED_SUBRESOURCE mappedResource;
+	CullBufferType* dataPtr;
+	ID3D11ShaderResourceView* resources[2];
+	ID3D11UnorderedAccessView* nullAccess;
+	ID3D11ShaderResourceView* nullResources[2];
+
+	deviceContext = stateCache->GetRenderContext();
+
+	//Lock the culling constant buffer so it can be written to
+	result = deviceContext->Map(m_cullBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
+	if (FAILED(result))
+	{
+		return false;
 	}
-	//Get the view and projection matrices
+
+	Stats::Add(STAT_CONSTANT_BYTES, sizeof(CullBufferType));
+
+	dataPtr = (CullBufferType*)mappedResource.pData;
+	dataPtr->view = XMMatrixTranspose(viewMatrix);
+	dataPtr->projection = GetLightTileProjection(projectionMatrix);
+	dataPtr->lightCount = m_Lights->GetLightCount();
+	dataPtr->tilesX = m_tilesX;
+	dataPtr->screenWidth = m_screenWidth;
+	dataPtr->screenHeight = m_screenHeight;
+
+	deviceContext->Unmap(m_cullBuffer, 0);
+
+	//The depth buffer can not be read while it is bound for output and the tile lists can not be written
+	//while the pixel shader still has them bound from the last frame
+	deviceContext->OMSetRenderTargets(0, NULL, NULL);
+	stateCache->SetPSShaderResource(2, NULL);
+
+	//Run one thread group per tile
+	resources[0] = targets.depthView;
+	resources[1] = m_pointLightView;
+
+	deviceContext->CSSetShader(m_cullShader, NULL, 0);
+	deviceContext->CSSetConstantBuffers(0, 1, &m_cullBuffer);
+	deviceContext->CSSetShaderResources(0, 2, resources);
+	deviceContext->CSSetUnorderedAccessViews(0, 1, &m_tileLightAccess, NULL);
+
+	deviceContext->Dispatch(m_tilesX, m_tilesY, 1);
+
+	//Unbind everything again so the depth buffer and the tile lists can be used by the shading pass
+	nullAccess = NULL;
+	nullResources[0] = NULL;
+	nullResources[1] = NULL;
+
+	deviceContext->CSSetUnorderedAccessViews(0, 1, &nullAccess, NULL);
+	deviceContext->CSSetShaderResources(0, 2, nullResources);
+	deviceContext->CSSetShader(NULL, NULL, 0);
+
+	deviceContext->OMSetRenderTargets(1, &targets.renderTarget, targets.depthStencil);
+
+	return true;
+}
+
+bool ForwardRenderer::Render(RenderStateCache* stateCache, const RenderTargets& targets, RenderQueue* renderQueue, Camera* camera, Light* light,
+	XMMATRIX projectionMatrix)
+{
+	PROFILE_ZONE("ForwardRenderer::Render");
+	bool result, prePass, recorded;
+	XMMATRIX viewMatrix;
+	RenderContext* deviceContext;
+	ShadingJob job;
+	int gpuScope;
+
+	//Get the view matrix, the projection comes from the caller
 	camera->GetViewMatrix(viewMatrix);
-	directX->GetProjectionMatrix(projectionMatrix);
+	deviceContext = stateCache->GetRenderContext();
 
-	for (int index = 0; index < m_frameModels->GetModelCount(); index++)
+	//Other objects use the device context directly, so nothing bound before this point can be trusted
+	stateCache->Invalidate();
+	stateCache->ResetCounters();
+	m_ObjectConstants->ResetMapCount();
+
+	//Write the camera and the directional light once for the whole frame
+	result = m_Shader->SetFrameParameters(stateCache, viewMatrix, projectionMatrix, camera->GetPosition(), light->GetDirection(),
+		light->GetDiffuseColor(), light->GetAmbientColor(), light->GetSpecularColor(), light->GetSpecularPower());
+	if (!result)
 	{
-		//Reset the view matrix for the next model
-		directX->GetWorldMatrix(worldMatrix);
+		return false;
+	}
 
-		//Move the model to the location it should be rendered at
-		worldMatrix = worldMatrix * XMMatrixTranslation(positionX, positionY, positionZ);
+	//Group the sorted draws that share mesh and texture into instance batches and upload their instances
+	m_Instancer->Build(renderQueue);
+	m_Instancer->SortByDepth();
+	Stats::Add(STAT_DRAWS_DROPPED, m_Instancer->GetDroppedCount());
 
-		//Put the model vertex and index buffer on the graphics pipeline to prepare them for drawing
-		m_Model->Render(directX->GetDeviceContext());
+	result = m_Shader->SetInstances(stateCache, m_Instancer->GetInstances(), m_Instancer->GetInstanceCount());
+	if (!result)
+	{
+		return false;
+	}
 
-		////Render the model using the light shader
-		//result = m_Shader->Render(directX->GetDeviceContext(), m_Model->GetIndexCount(), worldMatrix, viewMatrix, projectionMatrix,
-		//	m_Model->GetTexture(), m_frameLights->GetDirection(), m_frameLights->GetDiffuseColor(), m_frameLights->GetAmbientColor(),
-		//	camera->GetPosition(), m_frameLights->GetSpecularColor(), m_frameLights->GetSpecularPower());
-		//if (!result)
-		//{
-		//	return false;
-		//}
+	//Batches of a single draw get their world matrix from the constant ring instead
+	result = WriteObjectConstants(deviceContext, renderQueue);
+	if (!result)
+	{
+		return false;
 	}
 
+	prePass = IsDepthPrePassEnabled();
+
+	//Depth pre-pass
+	if (prePass)
+	{
+		gpuScope = BeginGpuScope(deviceContext, "GPU Depth pre-pass");
+		result = RenderDepth(stateCache, renderQueue);
+		EndGpuScope(deviceContext, gpuScope);
+		if (!result)
+		{
+			return false;
+		}
+	}
+
+	result = UploadPointLights(deviceContext);
+	if (!result)
+	{
+		return false;
+	}
+
+	if (m_lightingMode == LIGHTING_CLUSTERED)
+	{
+		//Build the per cluster light lists on the cpu
+		result = BuildClusters(deviceContext, viewMatrix, projectionMatrix);
+	}
+	else
+	{
+		//Build the per tile light lists from the depth of the pre-pass
+		gpuScope = BeginGpuScope(deviceContext, "GPU Light culling");
+		result = CullLights(stateCache, targets, viewMatrix, projectionMatrix);
+		EndGpuScope(deviceContext, gpuScope);
+	}
+
+	if (!result)
+	{
+		return false;
+	}
+
+	//Shade against the pre-pass depth with the point lights and tile lists bound to the pixel shader
+	if (prePass)
+	{
+		deviceContext->OMSetDepthStencilState(m_depthEqualState, 1);
+	}
+
+	gpuScope = BeginGpuScope(deviceContext, "GPU Main pass");
+
+	job.renderer = this;
+	job.renderQueue = renderQueue;
+	job.prePass = prePass;
+
+	//Constant ring allocations can be bound from any context, the per draw copies of the fallback can not
+	recorded = false;
+	if (m_multithreaded && m_ObjectConstants->UsesOffsets() && m_Instancer->GetBatchCount() >= 2 * COMMAND_RECORDER_MIN_CHUNK)
+	{
+		recorded = m_Recorder->Record(deviceContext, m_Instancer->GetBatchCount(), RecordShading, &job);
+	}
+
+	if (recorded)
+	{
+		//Play the chunks back in order, which draws the same as recording them here
+		m_Recorder->Execute(deviceContext);
+		m_Recorder->MergeCounters(stateCache);
+	}
+	else
+	{
+		result = RenderShading(stateCache, renderQueue, prePass, 0, m_Instancer->GetBatchCount());
+		if (!result)
+		{
+			return false;
+		}
+	}
+
+	EndGpuScope(deviceContext, gpuScope);
+
+	//Go back to the regular depth state
+	deviceContext->OMSetDepthStencilState(targets.depthState, 1);
+
 	return true;
 }
+
+int ForwardRenderer::GetConstantMapCount()
+{
+	return m_ObjectConstants->GetMapCount();
+}
\ No newline at end of file
@@ -1,30 +1,143 @@
 #pragma once
 #include <d3d11.h>
+#include <d3dcompiler.h>
+#include <fstream>
 
 #include "Camera.h"
-#include "D3D.h"
-#include "ModelAsset.h"
 #include "Light.h"
-#include "ModelList.h"
 #include "LightShader.h"
+#include "LightCulling.h"
+#include "LightClusters.h"
+#include "LightManager.h"
+#include "RenderQueue.h"
+#include "RenderStateCache.h"
+#include "InstanceBatcher.h"
+#include "ConstantRing.h"
+#include "CommandRecorder.h"
+#include "GpuTimer.h"
+using namespace std;
 
+// The object constant ring has room for this many frames in which every batch is a single draw.
+#define OBJECT_CONSTANT_RING_FRAMES 3
+
+// How the point lights are assigned to the pixels that they can reach.
+enum LightingMode
+{
+	LIGHTING_TILED,		// Per screen tile lists, culled on the gpu against the pre-pass depth.
+	LIGHTING_CLUSTERED	// Per cluster lists, screen tiles split into exponential depth slices and built on the cpu.
+};
+
+// Forward+ renderer. Every frame runs a depth pre-pass, culls the point lights into per tile lists
+// with a compute shader and then shades the scene, where each pixel only loops over the lights of its tile.
+// The clustered mode replaces the tile lists with per cluster lists that also hold up in deep scenes,
+// and can run without the pre-pass, in which case the scene is shaded front to back.
+// Large scenes record the shading pass on worker threads into deferred contexts.
 class ForwardRenderer
 {
 public:
 	ForwardRenderer();
 	~ForwardRenderer();
 
-	bool Initialize(ID3D11Device* device, HWND hwnd);
+	// maxDraws is the capacity of the render queue, the instancing is sized so that every draw of it fits.
+	bool Initialize(ID3D11Device* device, RenderStateCache* stateCache, HWND hwnd, int screenWidth, int screenHeight, float screenNear,
+		float screenDepth, int maxDraws);
 	void Shutdown();
 
-	bool SetupData(ModelList* modelList, Light* light, ModelAsset* model);
-	bool Render(D3D* directX, Camera* camera);
+	// Point and spot lights are added, moved and removed through the light manager.
+	LightManager* GetLightManager();
+	// Draws the sorted queue into the targets through the context of the state cache and leaves the regular depth state bound.
+	bool Render(RenderStateCache* stateCache, const RenderTargets& targets, RenderQueue* renderQueue, Camera* camera, Light* light,
+		XMMATRIX projectionMatrix);
+
+	void SetLightingMode(LightingMode mode);
+	LightingMode GetLightingMode();
+
+	// The tiled mode culls against the pre-pass depth and always runs it.
+	void SetDepthPrePass(bool enabled);
+	bool IsDepthPrePassEnabled();
+
+	// Records the shading pass on the workers of the command recorder when the scene is large enough.
+	void SetMultithreadedRecording(bool enabled);
+	bool IsMultithreadedRecordingEnabled();
+
+	// Times the depth pre-pass, the light culling and the main pass when set, 0 turns it off.
+	void SetGpuTimer(GpuTimer* gpuTimer);
+
+	int GetPointLightCount();
+
+	// Maps of the object constant ring during the last frame.
+	int GetConstantMapCount();
 
 private:
-	ModelList* m_frameModels;
-	Light* m_frameLights;
+	struct CullBufferType
+	{
+		XMMATRIX view;
+		XMFLOAT4 projection;
+		unsigned int lightCount;
+		unsigned int tilesX;
+		unsigned int screenWidth;
+		unsigned int screenHeight;
+	};
+
+	// What the workers need to record their part of the shading pass.
+	struct ShadingJob
+	{
+		ForwardRenderer* renderer;
+		RenderQueue* renderQueue;
+		bool prePass;
+	};
+
+	struct TileBufferType
+	{
+		unsigned int tilesX;
+		unsigned int clusterTilesX;
+		unsigned int clusterTilesY;
+		float padding;
+		XMFLOAT2 sliceParameters;
+		XMFLOAT2 slicePadding;
+	};
+
+	bool InitializeCulling(ID3D11Device* device, HWND hwnd, WCHAR* csFilename);
+	bool InitializeClusters(ID3D11Device* device);
+	void OutputShaderErrorMessage(ID3D10Blob* errorMessage, HWND hwnd, WCHAR* shaderFilename);
+
+	bool WriteObjectConstants(RenderContext* deviceContext, RenderQueue* renderQueue);
+	bool RenderDepth(RenderStateCache* stateCache, RenderQueue* renderQueue);
+	bool RenderShading(RenderStateCache* stateCache, RenderQueue* renderQueue, bool prePass, int firstBatch, int batchCount);
+	static bool RecordShading(void* userData, RenderStateCache* stateCache, const RecordChunk& chunk);
+	bool CullLights(RenderStateCache* stateCache, const RenderTargets& targets, XMMATRIX viewMatrix, XMMATRIX projectionMatrix);
+	bool UploadPointLights(RenderContext* deviceContext);
+	bool BuildClusters(RenderContext* deviceContext, XMMATRIX viewMatrix, XMMATRIX projectionMatrix);
+	int BeginGpuScope(RenderContext* deviceContext, const char* name);
+	void EndGpuScope(RenderContext* deviceContext, int scope);
 
-	//TEMP
-	ModelAsset* m_Model;
 	LightShader* m_Shader;
+	InstanceBatcher* m_Instancer;
+	LightClusterBuilder* m_Clusters;
+	ConstantRing* m_ObjectConstants;
+	CommandRecorder* m_Recorder;
+	GpuTimer* m_GpuTimer;
+	unsigned int* m_objectOffsets;
+
+	ID3D11ComputeShader* m_cullShader;
+	ID3D11Buffer* m_cullBuffer;
+	ID3D11Buffer* m_tileBuffer;
+	ID3D11Buffer* m_pointLightBuffer;
+	ID3D11ShaderResourceView* m_pointLightView;
+	ID3D11Buffer* m_tileLightBuffer;
+	ID3D11ShaderResourceView* m_tileLightView;
+	ID3D11UnorderedAccessView* m_tileLightAccess;
+	ID3D11Buffer* m_clusterRangeBuffer;
+	ID3D11ShaderResourceView* m_clusterRangeView;
+	ID3D11Buffer* m_clusterIndexBuffer;
+	ID3D11ShaderResourceView* m_clusterIndexView;
+	ID3D11DepthStencilState* m_depthEqualState;
+
+	LightManager* m_Lights;
+	LightingMode m_lightingMode;
+	bool m_depthPrePass;
+	bool m_multithreaded;
+
+	int m_screenWidth, m_screenHeight;
+	int m_tilesX, m_tilesY;
 };
\ No newline at end of file
@@ -0,0 +1,89 @@
+#include "FrameArena.h"
+
+FrameArena::FrameArena()
+{
+	m_memory = 0;
+	m_size = 0;
+	m_offset = 0;
+	m_peak = 0;
+}
+
+FrameArena::FrameArena(const FrameArena & other)
+{
+}
+
+FrameArena::~FrameArena()
+{
+}
+
+bool FrameArena::Initialize(size_t size)
+{
+	m_memory = new unsigned char[size];
+	if (!m_memory)
+	{
+		return false;
+	}
+
+	m_size = size;
+	m_offset = 0;
+	m_peak = 0;
+
+	return true;
+}
+
+void FrameArena::Shutdown()
+{
+	if (m_memory)
+	{
+		delete[] m_memory;
+		m_memory = 0;
+	}
+
+	m_size = 0;
+	m_offset = 0;
+}
+
+void * FrameArena::Allocate(size_t size, size_t alignment)
+{
+	size_t start;
+
+	// Align the address, not just the offset, the block itself is only aligned for the largest basic type.
+	start = (((size_t)m_memory + m_offset + alignment - 1) & ~(alignment - 1)) - (size_t)m_memory;
+	if (!m_memory || start + size > m_size)
+	{
+		return 0;
+	}
+
+	m_offset = start + size;
+	if (m_offset > m_peak)
+	{
+		m_peak = m_offset;
+	}
+
+	return m_memory + start;
+}
+
+void FrameArena::Reset()
+{
+	m_offset = 0;
+}
+
+bool FrameArena::Contains(const void * pointer)
+{
+	return m_memory && (const unsigned char*)pointer >= m_memory && (const unsigned char*)pointer < m_memory + m_size;
+}
+
+size_t FrameArena::GetUsed()
+{
+	return m_offset;
+}
+
+size_t FrameArena::GetPeak()
+{
+	return m_peak;
+}
+
+size_t FrameArena::GetSize()
+{
+	return m_size;
+}
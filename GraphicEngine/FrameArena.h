@@ -0,0 +1,30 @@
+#pragma once
+#include <stddef.h>
+
+// Linear allocator over one block of memory. Allocating only moves an offset forward and Reset frees everything
+// at once, single allocations are never freed. Not thread safe. Nothing in here touches Windows or Direct3D.
+class FrameArena
+{
+private:
+	unsigned char* m_memory;
+	size_t m_size;
+	size_t m_offset;
+	// Most bytes in use since Initialize, to size the block.
+	size_t m_peak;
+public:
+	FrameArena();
+	FrameArena(const FrameArena&);
+	~FrameArena();
+
+	bool Initialize(size_t size);
+	void Shutdown();
+
+	// Returns 0 when the rest of the block is too small. The alignment has to be a power of two.
+	void* Allocate(size_t size, size_t alignment);
+	void Reset();
+
+	bool Contains(const void* pointer);
+	size_t GetUsed();
+	size_t GetPeak();
+	size_t GetSize();
+};
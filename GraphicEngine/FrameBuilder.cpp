@@ -0,0 +1,206 @@
+#include "FrameBuilder.h"
+
+FrameBuilder::FrameBuilder()
+{
+	m_ModelList = 0;
+	m_Transforms = 0;
+	m_modelNodes = 0;
+	m_Frustum = 0;
+	m_screenDepth = 0.0f;
+}
+
+FrameBuilder::FrameBuilder(const FrameBuilder & other)
+{
+}
+
+FrameBuilder::~FrameBuilder()
+{
+}
+
+bool FrameBuilder::Initialize(ModelList * models, TransformHierarchy * transforms, const int * modelNodes, float screenDepth)
+{
+	m_ModelList = models;
+	m_Transforms = transforms;
+	m_modelNodes = modelNodes;
+	m_screenDepth = screenDepth;
+
+	//Create the frustum object
+	m_Frustum = new Frustum;
+	if (!m_Frustum)
+	{
+		return false;
+	}
+
+	//The far plane of the culling is the one of the projection
+	m_Frustum->Initialize(screenDepth);
+
+	return true;
+}
+
+void FrameBuilder::Shutdown()
+{
+	//Release the frustum object
+	if (m_Frustum)
+	{
+		delete m_Frustum;
+		m_Frustum = 0;
+	}
+
+	m_ModelList = 0;
+	m_Transforms = 0;
+	m_modelNodes = 0;
+}
+
+void FrameBuilder::Build(XMMATRIX viewMatrix, XMMATRIX projectionMatrix, LightManager * lights, unsigned int frame, FrameSnapshot & snapshot)
+{
+	PROFILE_ZONE("FrameBuilder::Build");
+	XMFLOAT4 color;
+	VisibleModel visible;
+	FrameVector<unsigned char> modelVisible{ FrameAllocator<unsigned char>(frame) };
+	CullJob cullJob;
+	int modelCount, index;
+	float positionX, positionY, positionZ;
+
+	modelCount = m_ModelList->GetModelCount();
+
+	m_Transforms->Update();
+
+	//Contstruct the frustum
+	m_Frustum->ConstructFrustum(projectionMatrix, viewMatrix);
+
+	//Test the models against the frustum on the job system, the results only live for this frame
+	modelVisible.resize(modelCount);
+	cullJob.builder = this;
+	cullJob.visible = modelVisible.data();
+	JobSystem::ParallelFor(modelCount, CULL_GRAIN_SIZE, CullModels, &cullJob);
+
+	//Go through all the models and keep only the ones that can be seen by the camera view. There is room for all of
+	//them, so a frame that sees more models than the ones before does not allocate
+	snapshot.visibleModels.clear();
+	snapshot.visibleModels.reserve(modelCount);
+	for (index = 0; index < modelCount; index++)
+	{
+		if (!modelVisible[index])
+		{
+			continue;
+		}
+
+		//Get the postion and color of the spehere model at this index
+		m_ModelList->GetData(index, positionX, positionY, positionZ, color);
+
+		visible.index = index;
+		visible.color = color;
+
+		//Distance from the camera used to order draws with the same state front to back
+		visible.depth = RenderQueue::ComputeViewDepth(XMVectorSet(positionX, positionY, positionZ, 1.0f), viewMatrix, m_screenDepth);
+
+		//Get the cached world matrix of this model from the transform hierarchy
+		XMStoreFloat4x4(&visible.worldMatrix, m_Transforms->GetWorldMatrix(m_modelNodes[index]));
+
+		snapshot.visibleModels.push_back(visible);
+	}
+
+	snapshot.objectsVisible = (int)snapshot.visibleModels.size();
+	snapshot.objectsCulled = modelCount - snapshot.objectsVisible;
+
+	//The debug lines of this frame go along with it, the renderer never adds any
+	if (DebugDraw::IsEnabled())
+	{
+		AddDebugLines(modelVisible.data(), lights);
+	}
+
+	snapshot.debugDepthTested.clear();
+	snapshot.debugOverlay.clear();
+	DebugDraw::Collect(snapshot.debugDepthTested, snapshot.debugOverlay);
+}
+
+void FrameBuilder::QueueModels(const FrameSnapshot & snapshot, DrawSource * source, RenderQueue * renderQueue)
+{
+	PROFILE_ZONE("FrameBuilder::QueueModels");
+	const VisibleModel* visible;
+	DrawCall draw;
+	unsigned int meshID, textureID;
+	int index;
+
+	//Start a new list of draws for this frame and queue the models the snapshot found visible
+	renderQueue->Clear();
+
+	for (index = 0; index < (int)snapshot.visibleModels.size(); index++)
+	{
+		visible = &snapshot.visibleModels[index];
+
+		if (!source->GetDraw(visible->index, draw, meshID, textureID))
+		{
+			continue;
+		}
+
+		draw.color = visible->color;
+		draw.key = RenderQueue::MakeKey(0, 0, meshID, textureID, visible->depth);
+		draw.worldMatrix = visible->worldMatrix;
+
+		//The queue holds every model, a draw that still does not fit is counted
+		if (!renderQueue->Add(draw))
+		{
+			Stats::Add(STAT_DRAWS_DROPPED, 1);
+		}
+	}
+
+	//Order the draws so the ones sharing state follow each other
+	renderQueue->Sort();
+}
+
+void FrameBuilder::AddDebugLines(const unsigned char * modelVisible, LightManager * lights)
+{
+	const PointLight* light;
+	XMFLOAT4 color;
+	float positionX, positionY, positionZ;
+	int modelCount, index;
+
+	//Bounding sphere of every model, green when it passed the frustum test and red when it was culled
+	modelCount = m_ModelList->GetModelCount();
+	for (index = 0; index < modelCount; index++)
+	{
+		m_ModelList->GetData(index, positionX, positionY, positionZ, color);
+
+		if (modelVisible[index])
+		{
+			color = XMFLOAT4(0.0f, 1.0f, 0.0f, 1.0f);
+		}
+		else
+		{
+			color = XMFLOAT4(1.0f, 0.0f, 0.0f, 1.0f);
+		}
+
+		DebugDraw::AddSphere(XMFLOAT3(positionX, positionY, positionZ), 1.0f, color, true);
+	}
+
+	if (!lights)
+	{
+		return;
+	}
+
+	//Range of every light in its own color
+	for (index = 0; index < lights->GetLightCount(); index++)
+	{
+		light = &lights->GetLights()[index];
+		DebugDraw::AddSphere(light->position, light->range, XMFLOAT4(light->color.x, light->color.y, light->color.z, 1.0f), true);
+	}
+}
+
+void FrameBuilder::CullModels(void * data, int begin, int end)
+{
+	CullJob* job;
+	XMFLOAT4 color;
+	float positionX, positionY, positionZ;
+	int index;
+
+	job = (CullJob*)data;
+
+	for (index = begin; index < end; index++)
+	{
+		job->builder->m_ModelList->GetData(index, positionX, positionY, positionZ, color);
+
+		//Check if the sphere model with a radius of 1.0 is in the view frustum
+		job->visible[index] = job->builder->m_Frustum->CheckSphere(positionX, positionY, positionZ, 1.0f) ? 1 : 0;
+	}
+}
@@ -0,0 +1,66 @@
+#pragma once
+#include <DirectXMath.h>
+#include "Frustum.h"
+#include "FrameMemory.h"
+#include "FrameSnapshot.h"
+#include "JobSystem.h"
+#include "LightManager.h"
+#include "ModelList.h"
+#include "Profiler.h"
+#include "RenderQueue.h"
+#include "Stats.h"
+#include "TransformHierarchy.h"
+using namespace DirectX;
+
+// Models one culling job tests.
+#define CULL_GRAIN_SIZE 256
+
+// Where the draws of the visible models come from. Graphics looks its models up in the assets, the headless
+// benchmark has meshes of its own.
+class DrawSource
+{
+public:
+	virtual ~DrawSource() {}
+
+	// Fills the mesh, texture and index count of the draw of a model of the list and the ids its key sorts by.
+	// Returns false for a model that can not be drawn right now, like one whose assets were evicted.
+	virtual bool GetDraw(int model, DrawCall& draw, unsigned int& meshID, unsigned int& textureID) = 0;
+};
+
+// The cpu side of a frame that does not depend on the device: the transform update, the frustum culling on the job
+// system, the visible models and debug lines of the snapshot, and queueing and sorting the draws of a snapshot.
+// Graphics and the headless benchmark both build their frames with it.
+class FrameBuilder
+{
+private:
+	// What the culling jobs work on, the frustum test result of every model goes to visible.
+	struct CullJob
+	{
+		FrameBuilder* builder;
+		unsigned char* visible;
+	};
+
+	ModelList* m_ModelList;
+	TransformHierarchy* m_Transforms;
+	const int* m_modelNodes;
+	Frustum* m_Frustum;
+	float m_screenDepth;
+
+	void AddDebugLines(const unsigned char* modelVisible, LightManager* lights);
+	static void CullModels(void* data, int begin, int end);
+public:
+	FrameBuilder();
+	FrameBuilder(const FrameBuilder& other);
+	~FrameBuilder();
+
+	// modelNodes holds the transform node of every model of the list, the builder keeps the pointers.
+	bool Initialize(ModelList* models, TransformHierarchy* transforms, const int* modelNodes, float screenDepth);
+	void Shutdown();
+
+	// Updates the transforms and fills the visible models, their counts and the debug lines of the snapshot.
+	// The per frame arrays come from the frame memory of frame. The lights only add debug lines, they can be 0.
+	void Build(XMMATRIX viewMatrix, XMMATRIX projectionMatrix, LightManager* lights, unsigned int frame, FrameSnapshot& snapshot);
+
+	// Clears the queue, adds a draw for every visible model of the snapshot the source can draw and sorts them.
+	static void QueueModels(const FrameSnapshot& snapshot, DrawSource* source, RenderQueue* renderQueue);
+};
@@ -0,0 +1,167 @@
+#include "FrameMemory.h"
+#include <atomic>
+#include <mutex>
+
+namespace
+{
+	struct FrameThread
+	{
+		FrameArena arenas[2];
+		// Newest frame each arena holds memory of.
+		unsigned int frames[2];
+		// Arena the thread allocates from.
+		int current;
+	};
+
+	std::mutex s_threadMutex;
+	FrameThread* s_threads[FRAME_MEMORY_MAX_THREADS];
+	std::atomic<int> s_threadCount(0);
+
+	// Every frame before this one has ended.
+	std::atomic<unsigned int> s_endedFrames(0);
+
+	// Goes up with every Shutdown, which frees the arenas of all threads, so a thread that still points at its
+	// arenas of an earlier run knows to get new ones.
+	std::atomic<unsigned int> s_generation(0);
+
+	thread_local FrameThread* t_thread = 0;
+	thread_local unsigned int t_generation = 0;
+
+	FrameThread* GetThread()
+	{
+		FrameThread* thread;
+
+		if (t_thread && t_generation == s_generation.load(std::memory_order_acquire))
+		{
+			return t_thread;
+		}
+
+		// First allocation of this thread, give it arenas. Threads past the maximum get none.
+		std::lock_guard<std::mutex> lock(s_threadMutex);
+
+		t_thread = 0;
+		t_generation = s_generation.load(std::memory_order_relaxed);
+
+		if (s_threadCount >= FRAME_MEMORY_MAX_THREADS)
+		{
+			return 0;
+		}
+
+		thread = new FrameThread;
+		if (!thread)
+		{
+			return 0;
+		}
+
+		if (!thread->arenas[0].Initialize(FRAME_MEMORY_ARENA_SIZE) || !thread->arenas[1].Initialize(FRAME_MEMORY_ARENA_SIZE))
+		{
+			thread->arenas[0].Shutdown();
+			thread->arenas[1].Shutdown();
+			delete thread;
+			return 0;
+		}
+
+		thread->frames[0] = 0;
+		thread->frames[1] = 0;
+		thread->current = 0;
+
+		s_threads[s_threadCount] = thread;
+		s_threadCount++;
+
+		t_thread = thread;
+		return thread;
+	}
+
+	// An arena may be emptied once no frame it holds memory of is still running. Frame numbers may wrap around.
+	bool IsDone(FrameThread* thread, int arena, unsigned int endedFrames)
+	{
+		return thread->arenas[arena].GetUsed() == 0 || (int)(endedFrames - thread->frames[arena]) > 0;
+	}
+}
+
+void * FrameMemory::Allocate(size_t size, size_t alignment, unsigned int frame)
+{
+	FrameThread* thread;
+	unsigned int endedFrames;
+	int other;
+	void* memory;
+
+	thread = GetThread();
+	if (!thread)
+	{
+		return 0;
+	}
+
+	// A newer frame moves to the other arena when the frames in it are over, or starts the current one over when
+	// those are. Otherwise it shares the current arena with the frames that still run. Older frames always do.
+	if ((int)(frame - thread->frames[thread->current]) > 0)
+	{
+		endedFrames = s_endedFrames.load(std::memory_order_acquire);
+		other = 1 - thread->current;
+
+		if (IsDone(thread, other, endedFrames))
+		{
+			thread->arenas[other].Reset();
+			thread->current = other;
+		}
+		else if (IsDone(thread, thread->current, endedFrames))
+		{
+			thread->arenas[thread->current].Reset();
+		}
+
+		thread->frames[thread->current] = frame;
+	}
+
+	memory = thread->arenas[thread->current].Allocate(size, alignment);
+	if (memory)
+	{
+		Stats::Add(STAT_FRAME_BYTES, (long long)size);
+	}
+
+	return memory;
+}
+
+void FrameMemory::EndFrame(unsigned int frame)
+{
+	// The threads that allocate read this before they empty an arena, what the frame wrote happened before.
+	if ((int)(frame + 1 - s_endedFrames.load(std::memory_order_relaxed)) > 0)
+	{
+		s_endedFrames.store(frame + 1, std::memory_order_release);
+	}
+}
+
+bool FrameMemory::Contains(const void * pointer)
+{
+	int count, i;
+
+	count = s_threadCount.load(std::memory_order_acquire);
+	for (i = 0; i < count; i++)
+	{
+		if (s_threads[i]->arenas[0].Contains(pointer) || s_threads[i]->arenas[1].Contains(pointer))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void FrameMemory::Shutdown()
+{
+	int i;
+
+	std::lock_guard<std::mutex> lock(s_threadMutex);
+
+	for (i = 0; i < s_threadCount; i++)
+	{
+		s_threads[i]->arenas[0].Shutdown();
+		s_threads[i]->arenas[1].Shutdown();
+		delete s_threads[i];
+		s_threads[i] = 0;
+	}
+
+	s_threadCount = 0;
+	s_endedFrames.store(0, std::memory_order_relaxed);
+	s_generation.fetch_add(1, std::memory_order_release);
+	t_thread = 0;
+}
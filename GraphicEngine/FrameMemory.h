@@ -0,0 +1,93 @@
+#pragma once
+#include <stddef.h>
+#include <new>
+#include <vector>
+#include "Util.h"
+#include "FrameArena.h"
+#include "Stats.h"
+
+// Bytes of each of the two arenas of a thread.
+#define FRAME_MEMORY_ARENA_SIZE (512 * 1024)
+// Threads that get arenas, further threads always allocate from the heap.
+#define FRAME_MEMORY_MAX_THREADS 32
+
+// Transient memory for the work of a frame. Every thread allocates from arenas of its own, so allocating needs no
+// lock, and nothing is freed before the frame is over. Every allocation names the frame it is for, the game thread
+// and the render thread work on different frames at the same time. A thread has two arenas and moves to the other
+// one when it allocates for a newer frame, but only empties it once every frame in it has ended. Until then the
+// newer frame shares the arena with the older ones, so no thread ever reuses memory of a frame that did not end.
+class FrameMemory
+{
+public:
+	// Returns 0 when the arena of the calling thread is full. The alignment has to be a power of two.
+	GRAPHIC_API static void* Allocate(size_t size, size_t alignment, unsigned int frame);
+	// Once the frame is done on every thread, its memory and the memory of every earlier frame may be reused.
+	GRAPHIC_API static void EndFrame(unsigned int frame);
+	// True for memory of any arena.
+	GRAPHIC_API static bool Contains(const void* pointer);
+
+	// Frees the arenas of every thread and starts the frames over. Nothing may be allocated afterwards until the
+	// frames of the next run start, a thread that allocated before then gets new arenas.
+	GRAPHIC_API static void Shutdown();
+};
+
+// Lets standard containers allocate from frame memory of one frame. What does not fit the arena comes from the
+// heap and is counted, it goes back to the heap on deallocate while arena memory goes with the frame. A container
+// has to be done with its memory by the time its frame ends.
+template<typename T>
+class FrameAllocator
+{
+public:
+	typedef T value_type;
+
+	unsigned int frame;
+
+	explicit FrameAllocator(unsigned int frameNumber)
+	{
+		frame = frameNumber;
+	}
+
+	template<typename U>
+	FrameAllocator(const FrameAllocator<U>& other)
+	{
+		frame = other.frame;
+	}
+
+	T* allocate(size_t count)
+	{
+		void* memory;
+
+		memory = FrameMemory::Allocate(sizeof(T) * count, alignof(T), frame);
+		if (!memory)
+		{
+			Stats::Add(STAT_FRAME_OVERFLOWS, 1);
+			memory = ::operator new(sizeof(T) * count);
+		}
+
+		return (T*)memory;
+	}
+
+	void deallocate(T* pointer, size_t count)
+	{
+		if (!FrameMemory::Contains(pointer))
+		{
+			::operator delete(pointer);
+		}
+	}
+};
+
+template<typename T, typename U>
+bool operator==(const FrameAllocator<T>& a, const FrameAllocator<U>& b)
+{
+	return true;
+}
+
+template<typename T, typename U>
+bool operator!=(const FrameAllocator<T>& a, const FrameAllocator<U>& b)
+{
+	return false;
+}
+
+// Vector for data that only lives for the frame.
+template<typename T>
+using FrameVector = std::vector<T, FrameAllocator<T>>;
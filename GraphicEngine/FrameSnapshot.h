@@ -0,0 +1,40 @@
+#pragma once
+#include <DirectXMath.h>
+#include <vector>
+#include "DebugDraw.h"
+using namespace DirectX;
+
+// A model that passed the frustum test, index is its entry in the model list.
+struct VisibleModel
+{
+	int index;
+	XMFLOAT4X4 worldMatrix;
+	XMFLOAT4 color;
+	// Distance from the camera the draws are ordered by.
+	float depth;
+};
+
+// Everything Graphics::Submit needs from one simulated frame. Graphics::Update fills it on the game thread and
+// nothing writes it again until the renderer is done with it. The arrays keep their capacity when a snapshot is
+// filled again, so once the scene settled building one does not allocate.
+struct FrameSnapshot
+{
+	XMFLOAT3 cameraPosition;
+	XMFLOAT3 cameraRotation;
+	// Spin of the models between the last two simulation steps.
+	float modelRotation;
+	int mouseX, mouseY;
+	int fps, cpu;
+	float frameTime;
+	// Frame number its frame memory is allocated for, it ends once Submit drew the snapshot.
+	unsigned int frame;
+	// Time and counts of the Update that built the snapshot. The timings and counters of a frame are closed on
+	// the render thread, so Submit reports them with the frame that draws the snapshot.
+	float updateTime;
+	int objectsVisible;
+	int objectsCulled;
+	std::vector<VisibleModel> visibleModels;
+	// Debug lines added while the snapshot was built.
+	std::vector<DebugVertex> debugDepthTested;
+	std::vector<DebugVertex> debugOverlay;
+};
@@ -0,0 +1,14 @@
+#pragma once
+
+// CPU time in milliseconds that the last Graphics::Frame spent in each phase. The total also holds the
+// time between the phases, like presenting. The cull time is all of the Graphics::Update that built the
+// snapshot of the frame, the transform update included, and the sort time includes queueing the visible models.
+struct FrameTimings
+{
+	float upload;
+	float cull;
+	float sort;
+	float submit;
+	float text;
+	float total;
+};
@@ -0,0 +1,212 @@
+#include "GlyphCache.h"
+#include <string.h>
+
+bool GlyphCache::Pack(int width, int height, AtlasRect & rect)
+{
+	// Make room by evicting the least recently used glyphs until the rectangle fits.
+	while (!m_packer.Allocate(width, height, rect))
+	{
+		if (!EvictOldest())
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool GlyphCache::EvictOldest()
+{
+	std::unordered_map<unsigned int, Entry>::iterator it;
+
+	if (m_uses.empty())
+	{
+		return false;
+	}
+
+	// Everything older is gone already when the oldest glyph was used this frame.
+	it = m_entries.find(m_uses.back());
+	if (it->second.lastFrame == m_frame)
+	{
+		return false;
+	}
+
+	if (it->second.packed)
+	{
+		m_packer.Free(it->second.rect);
+	}
+
+	m_uses.pop_back();
+	m_entries.erase(it);
+	m_evictions++;
+
+	return true;
+}
+
+GlyphCache::GlyphCache()
+{
+	m_loader = 0;
+	memset(&m_header, 0, sizeof(m_header));
+	m_frame = 1;
+	m_evictions = 0;
+}
+
+GlyphCache::GlyphCache(const GlyphCache & other)
+{
+}
+
+GlyphCache::~GlyphCache()
+{
+}
+
+void GlyphCache::Initialize(GlyphLoader * loader, const FontTableHeader & header, int pageWidth, int pageHeight)
+{
+	m_loader = loader;
+	m_header = header;
+	m_header.atlasWidth = pageWidth;
+	m_header.atlasHeight = pageHeight;
+
+	m_packer.Initialize(pageWidth, pageHeight);
+	m_page.assign(pageWidth * pageHeight, 0);
+
+	m_frame = 1;
+	m_evictions = 0;
+}
+
+void GlyphCache::Shutdown()
+{
+	m_entries.clear();
+	m_uses.clear();
+	m_missing.clear();
+	m_dirty.clear();
+	m_page.clear();
+	m_packer.Clear();
+	m_loader = 0;
+}
+
+void GlyphCache::BeginFrame()
+{
+	m_frame++;
+}
+
+const FontGlyph * GlyphCache::GetGlyph(unsigned int codepoint)
+{
+	std::unordered_map<unsigned int, Entry>::iterator it;
+	GlyphBitmap bitmap;
+	Entry entry;
+	AtlasRect rect;
+	int row, pageWidth;
+
+	// A cached glyph moves to the front of the list.
+	it = m_entries.find(codepoint);
+	if (it != m_entries.end())
+	{
+		m_uses.splice(m_uses.begin(), m_uses, it->second.use);
+		it->second.lastFrame = m_frame;
+		return &it->second.glyph;
+	}
+
+	if (m_missing.count(codepoint) || !m_loader)
+	{
+		return 0;
+	}
+
+	if (!m_loader->LoadGlyph(codepoint, bitmap))
+	{
+		m_missing.insert(codepoint);
+		return 0;
+	}
+
+	entry.glyph = bitmap.metrics;
+	entry.glyph.codepoint = codepoint;
+	entry.glyph.u0 = 0.0f;
+	entry.glyph.v0 = 0.0f;
+	entry.glyph.u1 = 0.0f;
+	entry.glyph.v1 = 0.0f;
+	entry.packed = false;
+	entry.lastFrame = m_frame;
+
+	if (bitmap.width > 0)
+	{
+		// Keep a pixel free right of and below the glyph, so filtering never reads a neighbour.
+		if (!Pack(bitmap.width + 1, bitmap.height + 1, rect))
+		{
+			return 0;
+		}
+
+		entry.rect = rect;
+		entry.packed = true;
+
+		// Write the glyph and clear the gap, an evicted glyph may have left something there.
+		pageWidth = (int)m_header.atlasWidth;
+		for (row = 0; row < rect.height; row++)
+		{
+			memset(&m_page[(rect.y + row) * pageWidth + rect.x], 0, rect.width);
+			if (row < bitmap.height)
+			{
+				memcpy(&m_page[(rect.y + row) * pageWidth + rect.x], &bitmap.pixels[row * bitmap.width], bitmap.width);
+			}
+		}
+
+		m_dirty.push_back(rect);
+
+		entry.glyph.u0 = (float)rect.x / m_header.atlasWidth;
+		entry.glyph.v0 = (float)rect.y / m_header.atlasHeight;
+		entry.glyph.u1 = (float)(rect.x + bitmap.width) / m_header.atlasWidth;
+		entry.glyph.v1 = (float)(rect.y + bitmap.height) / m_header.atlasHeight;
+		entry.glyph.width = (float)bitmap.width;
+		entry.glyph.height = (float)bitmap.height;
+	}
+
+	m_uses.push_front(codepoint);
+	entry.use = m_uses.begin();
+
+	it = m_entries.insert(std::make_pair(codepoint, entry)).first;
+
+	return &it->second.glyph;
+}
+
+float GlyphCache::GetKerning(unsigned int first, unsigned int second)
+{
+	return m_loader ? m_loader->GetKerning(first, second) : 0.0f;
+}
+
+const FontTableHeader & GlyphCache::GetHeader()
+{
+	return m_header;
+}
+
+const unsigned char * GlyphCache::GetPage()
+{
+	return m_page.empty() ? 0 : &m_page[0];
+}
+
+int GlyphCache::GetPageWidth()
+{
+	return (int)m_header.atlasWidth;
+}
+
+int GlyphCache::GetPageHeight()
+{
+	return (int)m_header.atlasHeight;
+}
+
+const std::vector<AtlasRect>& GlyphCache::GetDirty()
+{
+	return m_dirty;
+}
+
+void GlyphCache::ClearDirty()
+{
+	m_dirty.clear();
+}
+
+int GlyphCache::GetEvictionCount()
+{
+	return m_evictions;
+}
+
+int GlyphCache::GetGlyphCount()
+{
+	return (int)m_entries.size();
+}
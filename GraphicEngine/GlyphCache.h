@@ -0,0 +1,90 @@
+#pragma once
+#include <list>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "FontTable.h"
+#include "AtlasPacker.h"
+
+// A glyph as the loader hands it to the cache: metrics in pixels at the size of the font, u and v are ignored,
+// and width * height distance field pixels. Glyphs without an outline have no pixels.
+struct GlyphBitmap
+{
+	FontGlyph metrics;
+	int width, height;
+	std::vector<unsigned char> pixels;
+};
+
+// Where the glyphs come from when they are not cached yet.
+class GlyphLoader
+{
+public:
+	virtual ~GlyphLoader() {}
+
+	// Returns false when the font has no glyph for the codepoint.
+	virtual bool LoadGlyph(unsigned int codepoint, GlyphBitmap& glyph) = 0;
+	virtual float GetKerning(unsigned int first, unsigned int second) = 0;
+};
+
+// Keeps the glyphs that were drawn recently in one atlas page, keyed by codepoint. A glyph that is not cached
+// is loaded and packed into the page, and when the page is full the least recently used glyphs make room. The
+// glyphs used in the current frame are never evicted, so the quads already laid out this frame stay valid. The
+// page is kept in memory and every glyph written to it adds a dirty rectangle for the upload. Nothing in here
+// touches Direct3D.
+class GlyphCache
+{
+private:
+	struct Entry
+	{
+		FontGlyph glyph;
+		AtlasRect rect;
+		bool packed;
+		unsigned int lastFrame;
+		std::list<unsigned int>::iterator use;
+	};
+
+	GlyphLoader* m_loader;
+	FontTableHeader m_header;
+	AtlasPacker m_packer;
+	std::vector<unsigned char> m_page;
+	std::unordered_map<unsigned int, Entry> m_entries;
+	// Most recently used codepoint first.
+	std::list<unsigned int> m_uses;
+	// Codepoints the font does not have, so they are not loaded again every frame.
+	std::unordered_set<unsigned int> m_missing;
+	std::vector<AtlasRect> m_dirty;
+	unsigned int m_frame;
+	int m_evictions;
+
+	bool Pack(int width, int height, AtlasRect& rect);
+	bool EvictOldest();
+public:
+	GlyphCache();
+	GlyphCache(const GlyphCache&);
+	~GlyphCache();
+
+	// The header gives the size, ascent and line height of the font, the page is pageWidth * pageHeight pixels.
+	void Initialize(GlyphLoader* loader, const FontTableHeader& header, int pageWidth, int pageHeight);
+	void Shutdown();
+
+	// Starts a new frame, the glyphs of earlier frames can be evicted again.
+	void BeginFrame();
+
+	// Returns the glyph with its place in the page, or 0 when the font does not have it or the page is full of
+	// glyphs of this frame.
+	const FontGlyph* GetGlyph(unsigned int codepoint);
+	float GetKerning(unsigned int first, unsigned int second);
+
+	const FontTableHeader& GetHeader();
+	const unsigned char* GetPage();
+	int GetPageWidth();
+	int GetPageHeight();
+
+	// Rectangles of the page written since the last ClearDirty.
+	const std::vector<AtlasRect>& GetDirty();
+	void ClearDirty();
+
+	// Goes up whenever glyphs were evicted, quads laid out before that may point at another glyph now.
+	int GetEvictionCount();
+	int GetGlyphCount();
+};
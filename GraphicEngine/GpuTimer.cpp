@@ -0,0 +1,245 @@
+#include "GpuTimer.h"
+
+GpuTimer::GpuTimer()
+{
+	int i, j;
+
+	for (i = 0; i < GPU_TIMER_FRAMES; i++)
+	{
+		m_frames[i].disjoint = 0;
+		for (j = 0; j < GPU_TIMER_MAX_SCOPES; j++)
+		{
+			m_frames[i].begin[j] = 0;
+			m_frames[i].end[j] = 0;
+			m_frames[i].names[j] = 0;
+		}
+		m_frames[i].scopeCount = 0;
+		m_frames[i].pending = false;
+	}
+
+	m_current = 0;
+	m_inFrame = false;
+	m_resultCount = 0;
+	m_droppedFrames = 0;
+}
+
+GpuTimer::GpuTimer(const GpuTimer & other)
+{
+}
+
+GpuTimer::~GpuTimer()
+{
+}
+
+bool GpuTimer::Initialize(ID3D11Device * device)
+{
+	D3D11_QUERY_DESC queryDesc;
+	HRESULT result;
+	int i, j;
+
+	queryDesc.MiscFlags = 0;
+
+	// A disjoint query per frame tells the timestamp frequency and whether it changed during the frame.
+	for (i = 0; i < GPU_TIMER_FRAMES; i++)
+	{
+		queryDesc.Query = D3D11_QUERY_TIMESTAMP_DISJOINT;
+		result = device->CreateQuery(&queryDesc, &m_frames[i].disjoint);
+		if (FAILED(result))
+		{
+			return false;
+		}
+
+		queryDesc.Query = D3D11_QUERY_TIMESTAMP;
+		for (j = 0; j < GPU_TIMER_MAX_SCOPES; j++)
+		{
+			result = device->CreateQuery(&queryDesc, &m_frames[i].begin[j]);
+			if (FAILED(result))
+			{
+				return false;
+			}
+
+			result = device->CreateQuery(&queryDesc, &m_frames[i].end[j]);
+			if (FAILED(result))
+			{
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+void GpuTimer::Shutdown()
+{
+	int i, j;
+
+	for (i = 0; i < GPU_TIMER_FRAMES; i++)
+	{
+		if (m_frames[i].disjoint)
+		{
+			m_frames[i].disjoint->Release();
+			m_frames[i].disjoint = 0;
+		}
+
+		for (j = 0; j < GPU_TIMER_MAX_SCOPES; j++)
+		{
+			if (m_frames[i].begin[j])
+			{
+				m_frames[i].begin[j]->Release();
+				m_frames[i].begin[j] = 0;
+			}
+
+			if (m_frames[i].end[j])
+			{
+				m_frames[i].end[j]->Release();
+				m_frames[i].end[j] = 0;
+			}
+		}
+	}
+}
+
+HRESULT GpuTimer::ReadFrame(RenderContext * renderContext, FrameQueries & frame)
+{
+	D3D11_QUERY_DATA_TIMESTAMP_DISJOINT disjoint;
+	UINT64 begin[GPU_TIMER_MAX_SCOPES], end[GPU_TIMER_MAX_SCOPES];
+	HRESULT result;
+	int i;
+
+	// Never flush, a query that is not done yet is simply asked again next frame.
+	result = renderContext->GetData(frame.disjoint, &disjoint, sizeof(disjoint), D3D11_ASYNC_GETDATA_DONOTFLUSH);
+	if (result != S_OK)
+	{
+		return result;
+	}
+
+	for (i = 0; i < frame.scopeCount; i++)
+	{
+		result = renderContext->GetData(frame.begin[i], &begin[i], sizeof(UINT64), D3D11_ASYNC_GETDATA_DONOTFLUSH);
+		if (result != S_OK)
+		{
+			return result;
+		}
+
+		result = renderContext->GetData(frame.end[i], &end[i], sizeof(UINT64), D3D11_ASYNC_GETDATA_DONOTFLUSH);
+		if (result != S_OK)
+		{
+			return result;
+		}
+	}
+
+	// The timestamps of a frame whose clock changed mean nothing, keep the previous results.
+	if (disjoint.Disjoint || disjoint.Frequency == 0)
+	{
+		return S_OK;
+	}
+
+	for (i = 0; i < frame.scopeCount; i++)
+	{
+		m_results[i].name = frame.names[i];
+		m_results[i].time = (float)((double)(end[i] - begin[i]) * 1000.0 / (double)disjoint.Frequency);
+		m_results[i].calls = 1;
+		m_results[i].depth = 0;
+	}
+
+	m_resultCount = frame.scopeCount;
+
+	return S_OK;
+}
+
+void GpuTimer::BeginFrame(RenderContext * renderContext)
+{
+	FrameQueries* frame;
+	HRESULT result;
+	int i;
+
+	// Read the pending frames oldest first, the current slot is the oldest of the ring.
+	for (i = 0; i < GPU_TIMER_FRAMES; i++)
+	{
+		frame = &m_frames[(m_current + i) % GPU_TIMER_FRAMES];
+		if (!frame->pending)
+		{
+			continue;
+		}
+
+		result = ReadFrame(renderContext, *frame);
+		if (result != S_OK)
+		{
+			break;
+		}
+
+		frame->pending = false;
+	}
+
+	// The queries of the current slot are about to be reused, so whatever they still hold is lost.
+	frame = &m_frames[m_current];
+	if (frame->pending)
+	{
+		frame->pending = false;
+		m_droppedFrames++;
+	}
+
+	frame->scopeCount = 0;
+	renderContext->Begin(frame->disjoint);
+	m_inFrame = true;
+}
+
+void GpuTimer::EndFrame(RenderContext * renderContext)
+{
+	if (!m_inFrame)
+	{
+		return;
+	}
+
+	renderContext->End(m_frames[m_current].disjoint);
+
+	m_frames[m_current].pending = true;
+	m_current = (m_current + 1) % GPU_TIMER_FRAMES;
+	m_inFrame = false;
+}
+
+int GpuTimer::BeginScope(RenderContext * renderContext, const char * name)
+{
+	FrameQueries& frame = m_frames[m_current];
+	int scope;
+
+	if (!m_inFrame || frame.scopeCount == GPU_TIMER_MAX_SCOPES)
+	{
+		return -1;
+	}
+
+	scope = frame.scopeCount;
+	frame.names[scope] = name;
+	frame.scopeCount++;
+
+	renderContext->End(frame.begin[scope]);
+
+	return scope;
+}
+
+void GpuTimer::EndScope(RenderContext * renderContext, int scope)
+{
+	if (scope < 0)
+	{
+		return;
+	}
+
+	renderContext->End(m_frames[m_current].end[scope]);
+}
+
+int GpuTimer::GetResults(ProfileSummary * results, int maxCount)
+{
+	int i, count;
+
+	count = m_resultCount < maxCount ? m_resultCount : maxCount;
+	for (i = 0; i < count; i++)
+	{
+		results[i] = m_results[i];
+	}
+
+	return count;
+}
+
+int GpuTimer::GetDroppedFrames()
+{
+	return m_droppedFrames;
+}
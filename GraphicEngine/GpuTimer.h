@@ -0,0 +1,54 @@
+#pragma once
+#include <d3d11.h>
+#include "RenderContext.h"
+#include "Profiler.h"
+
+// Frames of queries in flight. Results are read this many frames late, by then the gpu is done with them.
+#define GPU_TIMER_FRAMES 4
+#define GPU_TIMER_MAX_SCOPES 8
+
+// Times passes on the gpu with timestamp queries. Every frame uses its own set of queries from a ring, and
+// BeginFrame only reads back frames that are already finished, so reading never waits for the gpu. A frame
+// whose queries are still not done when its set comes around again is dropped.
+class GpuTimer
+{
+private:
+	struct FrameQueries
+	{
+		ID3D11Query* disjoint;
+		ID3D11Query* begin[GPU_TIMER_MAX_SCOPES];
+		ID3D11Query* end[GPU_TIMER_MAX_SCOPES];
+		const char* names[GPU_TIMER_MAX_SCOPES];
+		int scopeCount;
+		bool pending;
+	};
+
+	FrameQueries m_frames[GPU_TIMER_FRAMES];
+	int m_current;
+	bool m_inFrame;
+
+	ProfileSummary m_results[GPU_TIMER_MAX_SCOPES];
+	int m_resultCount;
+	int m_droppedFrames;
+
+	HRESULT ReadFrame(RenderContext* renderContext, FrameQueries& frame);
+public:
+	GpuTimer();
+	GpuTimer(const GpuTimer&);
+	~GpuTimer();
+
+	bool Initialize(ID3D11Device* device);
+	void Shutdown();
+
+	// Picks up the results of finished frames and starts timing a new one.
+	void BeginFrame(RenderContext* renderContext);
+	void EndFrame(RenderContext* renderContext);
+
+	// Returns the scope to pass to EndScope, or -1 when there is no room left, EndScope ignores that.
+	int BeginScope(RenderContext* renderContext, const char* name);
+	void EndScope(RenderContext* renderContext, int scope);
+
+	// Scope times in milliseconds of the newest finished frame, in the order the scopes began.
+	int GetResults(ProfileSummary* results, int maxCount);
+	int GetDroppedFrames();
+};
@@ -3,13 +3,24 @@
 Graphics::Graphics() {
 	m_Direct3D = 0;
 	m_Camera = 0;
-	m_Model = 0;
+	m_UpdateCamera = 0;
 	m_ColorShader = 0;
 	m_TextureShader = 0;
-	m_LightShader = 0;
 	m_Light = 0;
-	m_Bitmap = 0;
+	m_SpriteBatch = 0;
 	m_Text = 0;
+	m_ModelList = 0;
+	m_FrameBuilder = 0;
+	m_Transforms = 0;
+	m_modelNodes = 0;
+	m_RenderQueue = 0;
+	m_StateCache = 0;
+	m_GpuTimer = 0;
+	m_DebugDraw = 0;
+	m_sceneModels = 0;
+	m_rotation = 0.0f;
+	m_previousRotation = 0.0f;
+	m_frame = 0;
 
 	m_Renderer = 0;
 }
@@ -20,18 +31,29 @@ Graphics::~Graphics() {
 
 }
 
-bool Graphics::Initialize(int & width, int & height, HWND hwnd)
+bool Graphics::Initialize(int & width, int & height, HWND hwnd, bool headless, const char * sceneFile)
 {
 	bool result;
 	XMMATRIX baseViewMatrix;
-	
+
+	//Frequency of the counter the frame phases are timed with
+	QueryPerformanceFrequency((LARGE_INTEGER*)&m_timerFrequency);
+	memset(&m_timings, 0, sizeof(m_timings));
+
 	//Create the Direct3D object
 	m_Direct3D = new D3D;
 	if (!m_Direct3D)
 		return false;
 
-	//Init the Direct3D object
-	result = m_Direct3D->Initialize(width, height, VSYNC_ENABLED, hwnd, FULL_SCREEN, SCREEN_DEPTH, SCREEN_NEAR);
+	//Init the Direct3D object, either for the window or for an offscreen target when headless
+	if (headless)
+	{
+		result = m_Direct3D->InitializeHeadless(width, height, SCREEN_DEPTH, SCREEN_NEAR);
+	}
+	else
+	{
+		result = m_Direct3D->Initialize(width, height, VSYNC_ENABLED, hwnd, FULL_SCREEN, SCREEN_DEPTH, SCREEN_NEAR);
+	}
 	if (!result)
 	{
 		MessageBox(hwnd, L"Could not initialize Direct3D", L"Error", MB_OK);
@@ -46,7 +68,7 @@ bool Graphics::Initialize(int & width, int & height, HWND hwnd)
 	}
 
 	//Initialize the assets object
-	m_Assets->bind(m_Direct3D->GetDevice(), m_Direct3D->GetDeviceContext());
+	m_Assets->bind(m_Direct3D->GetDevice(), m_Direct3D->GetRenderContext());
 
 	// Create the camera object.
 	m_Camera = new Camera;
@@ -68,7 +90,7 @@ bool Graphics::Initialize(int & width, int & height, HWND hwnd)
 	}
 
 	// Initialize the text object.
-	result = m_Text->Initialize(m_Direct3D->GetDevice(), m_Direct3D->GetDeviceContext(), hwnd, width, height, baseViewMatrix, m_Assets);
+	result = m_Text->Initialize(m_Direct3D->GetDevice(), hwnd, width, height, baseViewMatrix, m_Assets);
 	if (!result)
 	{
 		MessageBox(hwnd, L"Could not initialize the text object.", L"Error", MB_OK);
@@ -79,9 +101,18 @@ bool Graphics::Initialize(int & width, int & height, HWND hwnd)
 	// Set the initial position of the camera.
 	m_Camera->SetPosition(0.0f, 0.0f, -5.0f);
 
+	// Create the camera object the snapshots are built with.
+	m_UpdateCamera = new Camera;
+	if (!m_UpdateCamera)
+	{
+		return false;
+	}
+
+	m_UpdateCamera->SetPosition(0.0f, 0.0f, -5.0f);
+
 	//Create and initialize the model object.
 	m_Model = m_Assets->load<ModelAsset>("../Data/Models/testing2.obj");
-	if (!m_Model)
+	if (!m_Model.IsValid())
 	{
 		MessageBox(hwnd, L"Could not initialize the model object.", L"Error", MB_OK);
 		return false;
@@ -105,33 +136,26 @@ bool Graphics::Initialize(int & width, int & height, HWND hwnd)
 		return false;
 	}
 
-	// Create the light shader object.
-	m_LightShader = new LightShader;
-	if (!m_LightShader)
+	//Create the sprite batch object
+	m_SpriteBatch = new SpriteBatch;
+	if (!m_SpriteBatch)
 	{
 		return false;
 	}
 
-	// Initialize the light shader object.
-	result = m_LightShader->Initialize(m_Direct3D->GetDevice(), hwnd);
+	//Initialize the sprite batch object
+	result = m_SpriteBatch->Initialize(m_Direct3D->GetDevice(), hwnd, width, height, SPRITE_BATCH_MAX_SPRITES);
 	if (!result)
 	{
-		MessageBox(hwnd, L"Could not initialize the light shader object.", L"Error", MB_OK);
-		return false;
-	}
-
-	//Create the bitmap object
-	m_Bitmap = new Bitmap;
-	if (!m_Bitmap)
-	{
+		MessageBox(hwnd, L"Could not initialize the sprite batch object.", L"Error", MB_OK);
 		return false;
 	}
 
-	//Initialize the bitmap object
-	result = m_Bitmap->Initialize(m_Direct3D->GetDevice(), m_Direct3D->GetDeviceContext(), width, height, "../Data/stone01.tga", 100, 100);
-	if (!result)
+	//Load the texture of the hud sprite
+	m_spriteTexture = m_Assets->load<TextureAsset>("../Data/stone01.tga");
+	if (!m_spriteTexture.IsValid())
 	{
-		MessageBox(hwnd, L"Could not initialize th bitmap boject", L"Error", MB_OK);
+		MessageBox(hwnd, L"Could not load the sprite texture.", L"Error", MB_OK);
 		return false;
 	}
 
@@ -156,21 +180,114 @@ bool Graphics::Initialize(int & width, int & height, HWND hwnd)
 		return false;
 	}
 
-	//Initialize th model list object
-	result = m_ModelList->Initialize(50);
+	//Initialize th model list object, either from the scene file or with random positions
+	if (sceneFile)
+	{
+		result = m_ModelList->Initialize(sceneFile);
+	}
+	else
+	{
+		result = m_ModelList->Initialize(50);
+	}
 	if (!result)
 	{
 		MessageBox(hwnd, L"Could not initialize the model list object.", L"Error", MB_OK);
 		return false;
 	}
 
-	//Create the frustum object
-	m_Frustum = new Frustum;
-	if (!m_Frustum)
+	//Load the model and texture of every scene entry, the assets object shares the ones used more than once
+	if (sceneFile)
+	{
+		m_sceneModels = new Model[m_ModelList->GetModelCount()];
+		if (!m_sceneModels)
+		{
+			return false;
+		}
+
+		for (int i = 0; i < m_ModelList->GetModelCount(); i++)
+		{
+			result = m_sceneModels[i].Initialize(m_Assets, m_ModelList->GetModelPath(i).c_str(), m_ModelList->GetTexturePath(i).c_str());
+			if (!result)
+			{
+				MessageBox(hwnd, L"Could not initialize the scene models.", L"Error", MB_OK);
+				return false;
+			}
+		}
+	}
+
+	//Create the transform hierarchy object
+	m_Transforms = new TransformHierarchy;
+	if (!m_Transforms)
 	{
 		return false;
 	}
 
+	//Initialize the transform hierarchy with room for every model in the list
+	result = m_Transforms->Initialize(m_ModelList->GetModelCount());
+	if (!result)
+	{
+		MessageBox(hwnd, L"Could not initialize the transform hierarchy object.", L"Error", MB_OK);
+		return false;
+	}
+
+	//Create a transform node for each model in the list
+	m_modelNodes = new int[m_ModelList->GetModelCount()];
+	if (!m_modelNodes)
+	{
+		return false;
+	}
+
+	for (int i = 0; i < m_ModelList->GetModelCount(); i++)
+	{
+		float positionX, positionY, positionZ;
+		XMFLOAT4 color;
+
+		m_ModelList->GetData(i, positionX, positionY, positionZ, color);
+
+		m_modelNodes[i] = m_Transforms->CreateNode(-1);
+		m_Transforms->SetPosition(m_modelNodes[i], positionX, positionY, positionZ);
+	}
+
+	//Create the render queue object
+	m_RenderQueue = new RenderQueue;
+	if (!m_RenderQueue)
+	{
+		return false;
+	}
+
+	//Initialize the render queue with room for every model in the list
+	result = m_RenderQueue->Initialize(m_ModelList->GetModelCount());
+	if (!result)
+	{
+		MessageBox(hwnd, L"Could not initialize the render queue object.", L"Error", MB_OK);
+		return false;
+	}
+
+	//Create the render state cache object
+	m_StateCache = new RenderStateCache;
+	if (!m_StateCache)
+	{
+		return false;
+	}
+
+	//Initialize the render state cache with the device context it submits to
+	m_StateCache->Initialize(m_Direct3D->GetRenderContext());
+
+	//Create the frame builder object
+	m_FrameBuilder = new FrameBuilder;
+	if (!m_FrameBuilder)
+	{
+		return false;
+	}
+
+	//Initialize the frame builder with the models and their transform nodes, it culls up to the far plane
+	result = m_FrameBuilder->Initialize(m_ModelList, m_Transforms, m_modelNodes, SCREEN_DEPTH);
+	if (!result)
+	{
+		MessageBox(hwnd, L"Could not initialize the frame builder object.", L"Error", MB_OK);
+		return false;
+	}
+
 	//Create the renderer object
 	m_Renderer = new ForwardRenderer;
 	if (!m_Renderer)
@@ -179,64 +296,219 @@ bool Graphics::Initialize(int & width, int & height, HWND hwnd)
 	}
 
 	//Initialize the renderer object
-	result = m_Renderer->Initialize(m_Direct3D->GetDevice(), hwnd);
+	result = m_Renderer->Initialize(m_Direct3D->GetDevice(), m_StateCache, hwnd, width, height, SCREEN_NEAR, SCREEN_DEPTH,
+		m_RenderQueue->GetMaxDraws());
 	if (!result)
 	{
 		MessageBox(hwnd, L"Could not initialize the renderer object", L"Error", MB_OK);
 		return false;
 	}
 
+	//Create the gpu timer object
+	m_GpuTimer = new GpuTimer;
+	if (!m_GpuTimer)
+	{
+		return false;
+	}
+
+	//Initialize the gpu timer and let the renderer time its passes with it
+	result = m_GpuTimer->Initialize(m_Direct3D->GetDevice());
+	if (!result)
+	{
+		MessageBox(hwnd, L"Could not initialize the gpu timer object", L"Error", MB_OK);
+		return false;
+	}
+
+	m_Renderer->SetGpuTimer(m_GpuTimer);
+
+	//Create the debug draw object
+	m_DebugDraw = new DebugDrawRenderer;
+	if (!m_DebugDraw)
+	{
+		return false;
+	}
+
+	//Initialize the debug draw object
+	result = m_DebugDraw->Initialize(m_Direct3D->GetDevice(), hwnd);
+	if (!result)
+	{
+		MessageBox(hwnd, L"Could not initialize the debug draw object.", L"Error", MB_OK);
+		return false;
+	}
+
+	//Scatter point lights through the model field
+	result = m_Renderer->GetLightManager()->AddRandomLights(256);
+	if (!result)
+	{
+		MessageBox(hwnd, L"Could not initialize the point lights", L"Error", MB_OK);
+		return false;
+	}
+
 	return true;
 }
 
-bool Graphics::Frame(float rotationY, int mouseX, int mouseY, int fps, int cpu, float frameTime)
+void Graphics::Simulate(float stepTime)
+{
+	m_previousRotation = m_rotation;
+
+	//Update the rotation variable each step
+	m_rotation += ((float)XM_PI / 5000.0f) * stepTime;
+	if (m_rotation > 360.0f)
+	{
+		//Wrap both, so the interpolation between them does not spin back once around
+		m_rotation -= 360.0f;
+		m_previousRotation -= 360.0f;
+	}
+}
+
+void Graphics::Update(float rotationY, int mouseX, int mouseY, int fps, int cpu, float frameTime, float interpolation,
+	FrameSnapshot & snapshot)
+{
+	PROFILE_ZONE("Graphics::Update");
+	XMMATRIX viewMatrix, projectionMatrix;
+	INT64 phaseStart;
+	int modelCount, index;
+	float rotation;
+
+	QueryPerformanceCounter((LARGE_INTEGER*)&phaseStart);
+
+	//Rotate the camera and generate its view matrix
+	m_UpdateCamera->SetRotation(0.0f, rotationY, 0.0f);
+	m_UpdateCamera->Render();
+
+	m_UpdateCamera->GetViewMatrix(viewMatrix);
+	m_Direct3D->GetProjectionMatrix(projectionMatrix);
+
+	//Draw the models between the last two simulation steps
+	rotation = m_previousRotation + (m_rotation - m_previousRotation) * interpolation;
+
+	//Get the number of models thar will be rendered
+	modelCount = m_ModelList->GetModelCount();
+
+	//The random demo models spin, the models of a scene file stay where they were placed and cost nothing to update
+	if (!m_sceneModels)
+	{
+		for (index = 0; index < modelCount; index++)
+		{
+			m_Transforms->SetRotation(m_modelNodes[index], 0.0f, rotation, 0.0f);
+		}
+	}
+
+	//Update the transforms, cull the models and collect the debug lines, the same for the headless benchmark
+	m_FrameBuilder->Build(viewMatrix, projectionMatrix, m_Renderer->GetLightManager(), m_frame, snapshot);
+
+	snapshot.cameraPosition = m_UpdateCamera->GetPosition();
+	snapshot.cameraRotation = m_UpdateCamera->GetRotation();
+	snapshot.modelRotation = rotation;
+	snapshot.mouseX = mouseX;
+	snapshot.mouseY = mouseY;
+	snapshot.fps = fps;
+	snapshot.cpu = cpu;
+	snapshot.frameTime = frameTime;
+
+	snapshot.frame = m_frame;
+	snapshot.updateTime = ElapsedTime(phaseStart);
+
+	m_frame++;
+}
+
+bool Graphics::Submit(const FrameSnapshot & snapshot)
 {
+	PROFILE_ZONE("Graphics::Submit");
 	bool result;
+	INT64 frameStart, phaseStart;
+	ProfileSummary profile[TEXT_PROFILE_LINES];
+	int profileCount, gpuCount;
 
-	static float rotation = 0.0f;
+	QueryPerformanceCounter((LARGE_INTEGER*)&frameStart);
+	phaseStart = frameStart;
+
+	//Update ran on the game thread, count its work with the frame that draws it
+	m_timings.cull = snapshot.updateTime;
+	Stats::Add(STAT_OBJECTS_VISIBLE, snapshot.objectsVisible);
+	Stats::Add(STAT_OBJECTS_CULLED, snapshot.objectsCulled);
 
 	//Run assets reference checks
 	m_Assets->upload();
 	m_Assets->checkReferences();
+	m_timings.upload = ElapsedTime(phaseStart);
 
-	//Rotate the camera 
-	m_Camera->SetRotation(0.0f, rotationY, 0.0f);
-
-	//Update the rotation variable each frame
-	rotation += ((float)XM_PI / 5000.0f) * frameTime;
-	if (rotation > 360.0f)
-	{
-		rotation -= 360.0f;
-	}
+	//Look from where the snapshot was taken
+	m_Camera->SetPosition(snapshot.cameraPosition.x, snapshot.cameraPosition.y, snapshot.cameraPosition.z);
+	m_Camera->SetRotation(snapshot.cameraRotation.x, snapshot.cameraRotation.y, snapshot.cameraRotation.z);
 
-	model.SetRotation(0.0f, rotation, 0.0f);
+	model.SetRotation(0.0f, snapshot.modelRotation, 0.0f);
 
 	// Set the frames per second.
-	result = m_Text->SetFps(fps, m_Direct3D->GetDeviceContext());
+	result = m_Text->SetFps(snapshot.fps);
 	if (!result)
 	{
 		return false;
 	}
 
 	// Set the cpu usage.
-	result = m_Text->SetCpu(cpu, m_Direct3D->GetDeviceContext());
+	result = m_Text->SetCpu(snapshot.cpu);
+	if (!result)
+	{
+		return false;
+	}
+
+	// Show the gpu passes and the most expensive zones of the last frame while the profiler is recording.
+	profileCount = 0;
+	if (Profiler::IsEnabled())
+	{
+		gpuCount = m_GpuTimer->GetResults(profile, TEXT_PROFILE_LINES / 2);
+		profileCount = gpuCount + Profiler::GetSummary(profile + gpuCount, TEXT_PROFILE_LINES - gpuCount);
+	}
+	result = m_Text->SetProfile(profile, profileCount);
 	if (!result)
 	{
 		return false;
 	}
 
+	// The engine counters go with the profiler overlay.
+	result = m_Text->SetStats(Profiler::IsEnabled());
 	if (!result)
 	{
 		return false;
 	}
+	m_timings.text = ElapsedTime(phaseStart);
 
 	// Render the graphics scene.
-	result = Render(rotation);
+	result = Render(snapshot);
 	if (!result)
 	{
 		return false;
 	}
-	m_Assets->checkHotload(frameTime);
+	m_Assets->checkHotload(snapshot.frameTime);
+
+	//Nothing uses the frame memory of the snapshot after it was drawn
+	FrameMemory::EndFrame(snapshot.frame);
+
+	m_timings.total = ElapsedTime(frameStart);
+
+	return true;
+}
+
+bool Graphics::Frame(float rotationY, int mouseX, int mouseY, int fps, int cpu, float frameTime, float interpolation)
+{
+	PROFILE_ZONE("Graphics::Frame");
+	bool result;
+	INT64 frameStart;
+
+	QueryPerformanceCounter((LARGE_INTEGER*)&frameStart);
+
+	Update(rotationY, mouseX, mouseY, fps, cpu, frameTime, interpolation, m_snapshot);
+
+	result = Submit(m_snapshot);
+	if (!result)
+	{
+		return false;
+	}
+
+	m_timings.total = ElapsedTime(frameStart);
+
+	return true;
 }
 
 void Graphics::Shutdown()
@@ -249,12 +521,20 @@ void Graphics::Shutdown()
 		m_Text = 0;
 	}
 
-	//Release the bitmap object
-	if (m_Bitmap)
+	//Release the sprite batch object
+	if (m_SpriteBatch)
+	{
+		m_SpriteBatch->Shutdown();
+		delete m_SpriteBatch;
+		m_SpriteBatch = 0;
+	}
+
+	//Release the debug draw object
+	if (m_DebugDraw)
 	{
-		m_Bitmap->Shutdown();
-		delete m_Bitmap;
-		m_Bitmap = 0;
+		m_DebugDraw->Shutdown();
+		delete m_DebugDraw;
+		m_DebugDraw = 0;
 	}
 
 	// Release the light object.
@@ -264,14 +544,6 @@ void Graphics::Shutdown()
 		m_Light = 0;
 	}
 
-	// Release the light shader object.
-	if (m_LightShader)
-	{
-		m_LightShader->Shutdown();
-		delete m_LightShader;
-		m_LightShader = 0;
-	}
-
 	// Release the color shader object.
 	if (m_TextureShader)
 	{
@@ -280,7 +552,13 @@ void Graphics::Shutdown()
 		m_TextureShader = 0;
 	}
 
-	// Release the camera object.
+	// Release the camera objects.
+	if (m_UpdateCamera)
+	{
+		delete m_UpdateCamera;
+		m_UpdateCamera = 0;
+	}
+
 	if (m_Camera)
 	{
 		delete m_Camera;
@@ -294,11 +572,50 @@ void Graphics::Shutdown()
 		m_Direct3D = 0;
 	}
 
-	// Release the frustum object
-	if (m_Frustum)
+	// Release the frame builder object
+	if (m_FrameBuilder)
+	{
+		m_FrameBuilder->Shutdown();
+		delete m_FrameBuilder;
+		m_FrameBuilder = 0;
+	}
+
+	// Release the transform hierarchy object
+	if (m_Transforms)
 	{
-		delete m_Frustum;
-		m_Frustum = 0;
+		m_Transforms->Shutdown();
+		delete m_Transforms;
+		m_Transforms = 0;
+	}
+
+	// Release the render state cache object
+	if (m_StateCache)
+	{
+		m_StateCache->Shutdown();
+		delete m_StateCache;
+		m_StateCache = 0;
+	}
+
+	// Release the render queue object
+	if (m_RenderQueue)
+	{
+		m_RenderQueue->Shutdown();
+		delete m_RenderQueue;
+		m_RenderQueue = 0;
+	}
+
+	// Release the model node list
+	if (m_modelNodes)
+	{
+		delete[] m_modelNodes;
+		m_modelNodes = 0;
+	}
+
+	// Release the scene models
+	if (m_sceneModels)
+	{
+		delete[] m_sceneModels;
+		m_sceneModels = 0;
 	}
 
 	// Release the modellist object
@@ -317,6 +634,14 @@ void Graphics::Shutdown()
 		m_Renderer = 0;
 	}
 
+	// Release the gpu timer object
+	if (m_GpuTimer)
+	{
+		m_GpuTimer->Shutdown();
+		delete m_GpuTimer;
+		m_GpuTimer = 0;
+	}
+
 
 	if (m_Assets)
 	{
@@ -325,18 +650,29 @@ void Graphics::Shutdown()
 	}
 }
 
-bool Graphics::Render(float rotation)
+bool Graphics::Render(const FrameSnapshot & snapshot)
 {
+	PROFILE_ZONE("Graphics::Render");
 	XMMATRIX worldMatrix, viewMatrix, projectionMatrix, orthoMatrix;
-	XMFLOAT4 color;
 	bool result = true;
-	bool renderModel;
-	int modelCount, renderCount, index;
-	float positionX, positionY, positionZ, radius;
+	RenderTargets targets;
+	TextureAsset* textureAsset;
+	INT64 phaseStart;
+	int gpuScope;
+	SpriteRect spriteRect, spriteUV;
+
+	//Count the submissions of this frame only
+	if (m_Direct3D->IsHeadless())
+	{
+		m_Direct3D->GetNullRenderContext()->ResetCounters();
+	}
 
 	// Clear the buffers to begin the scene.
 	m_Direct3D->BeginScene(0.0f, 0.0f, 0.0f, 1.0f);
 
+	//Pick up the gpu times of finished frames and start timing this one
+	m_GpuTimer->BeginFrame(m_Direct3D->GetRenderContext());
+
 	//Generate the view matrix based on camera's position
 	m_Camera->Render();
 
@@ -346,60 +682,39 @@ bool Graphics::Render(float rotation)
 	m_Direct3D->GetProjectionMatrix(projectionMatrix);
 	m_Direct3D->GetOrthoMatrix(orthoMatrix);
 
-	//Contstruct the frustum
-	m_Frustum->ConstructFrustum(projectionMatrix, viewMatrix);
-
-	//Get the number of models thar will be rendered
-	modelCount = m_ModelList->GetModelCount();
+	QueryPerformanceCounter((LARGE_INTEGER*)&phaseStart);
 
-	//Initialize the count of models that have been rendered
-	renderCount = 0;
+	//Queue the models the snapshot found visible and order the draws so the ones sharing state follow each other
+	FrameBuilder::QueueModels(snapshot, this, m_RenderQueue);
+	m_timings.sort = ElapsedTime(phaseStart);
 
-	//Go through all the models and render them only if they can be seen by the camera view
-	for (index = 0; index < modelCount; index++)
+	//Render the sorted draws with the forward+ renderer
+	m_Direct3D->GetRenderTargets(targets);
+	result = m_Renderer->Render(m_StateCache, targets, m_RenderQueue, m_Camera, m_Light, projectionMatrix);
+	if (!result)
 	{
-		//Get the postion and color of the spehere model at this index
-		m_ModelList->GetData(index, positionX, positionY, positionZ, color);
-
-		//Set the radius of the sphere to 1.0;
-		radius = 1.0f;
-
-		//Check if the sphere model is in the view frustum
-		renderModel = m_Frustum->CheckSphere(positionX, positionY, positionZ, radius);
-
-		//If it can be seen then render it if not skip this model and check the next sphere
-		if (renderModel)
-		{
-			m_Direct3D->GetWorldMatrix(worldMatrix);
-
-			//Rotate the world matrix by the rotation value so that the tiangle will spin
-			worldMatrix = worldMatrix * XMMatrixRotationY(rotation);
-
-			//Move the model to the location it should be rendered at
-			worldMatrix = worldMatrix * XMMatrixTranslation(positionX, positionY, positionZ);
-
-			//Put the model vertex and index buffer on the graphics pipeline to prepare them for drawing
-			model.Render(m_Direct3D->GetDeviceContext());
+		return false;
+	}
+	m_timings.submit = ElapsedTime(phaseStart);
 
-			//Render the model using the light shader
-			result = m_LightShader->Render(m_Direct3D->GetDeviceContext(), model.GetIndexCount(), model.GetWorldMatrix(), viewMatrix, projectionMatrix,
-				model.GetTexture(), m_Light->GetDirection(), m_Light->GetDiffuseColor(), m_Light->GetAmbientColor(),
-				m_Camera->GetPosition(), m_Light->GetSpecularColor(), m_Light->GetSpecularPower());
-			if (!result)
-			{
-				return false;
-			}
+	//Draw the debug lines that go through the depth test while the scene depth is still on
+	result = m_DebugDraw->Upload(m_Direct3D->GetRenderContext(), snapshot.debugDepthTested, snapshot.debugOverlay);
+	if (!result)
+	{
+		return false;
+	}
 
-			//Since this model was rendered increment the count
-			renderCount++;
-		}
+	result = m_DebugDraw->Render(m_Direct3D->GetRenderContext(), true, worldMatrix, viewMatrix, projectionMatrix);
+	if (!result)
+	{
+		return false;
 	}
 
 	//Turn of the Z buffer to begin all 2D rendering
 	m_Direct3D->TurnZBufferOff();
 
-	//Put the bitmap vertex and index buffer on the graphics pipeling to prepeare them for rendering
-	//result = m_Bitmap->Render(m_Direct3D->GetDeviceContext(), 325, 25);
+	//The rest of the debug lines go on top of the scene
+	result = m_DebugDraw->Render(m_Direct3D->GetRenderContext(), false, worldMatrix, viewMatrix, projectionMatrix);
 	if (!result)
 	{
 		return false;
@@ -408,22 +723,40 @@ bool Graphics::Render(float rotation)
 	//Get a new world matrix
 	m_Direct3D->GetWorldMatrix(worldMatrix);
 
-	//Render the bitmap with the texture shader
-	//result = m_TextureShader->Render(m_Direct3D->GetDeviceContext(), m_Bitmap->GetIndexCount(), worldMatrix, m_Camera->GetBaseViewMatrix(), orthoMatrix, m_Bitmap->GetTexture());
-	if (!result)
+	//Turn on the alpha blending before rendring the sprites and text
+	m_Direct3D->TurnOnAlphaBlending();
+
+	//Collect the hud sprites of this frame, they are drawn together with one draw per texture
+	m_SpriteBatch->Begin();
+
+	spriteRect.x = 325.0f;
+	spriteRect.y = 25.0f;
+	spriteRect.width = 100.0f;
+	spriteRect.height = 100.0f;
+	spriteUV.x = 0.0f;
+	spriteUV.y = 0.0f;
+	spriteUV.width = 1.0f;
+	spriteUV.height = 1.0f;
+	textureAsset = m_Assets->get(m_spriteTexture);
+	if (textureAsset)
 	{
-		return false;
+		m_SpriteBatch->Draw(textureAsset->GetTexture(), spriteRect, spriteUV, PackTextColor(1.0f, 1.0f, 1.0f, 1.0f));
 	}
 
-	//Turn on the alpha blending before rendring text
-	m_Direct3D->TurnOnAlphaBlending();
-
-	//Render the text strings
-	result = m_Text->Render(m_Direct3D->GetDeviceContext(), worldMatrix, orthoMatrix);
+	//Render the sprites and the text strings
+	ElapsedTime(phaseStart);
+	gpuScope = m_GpuTimer->BeginScope(m_Direct3D->GetRenderContext(), "GPU UI pass");
+	result = m_SpriteBatch->End(m_Direct3D->GetRenderContext(), worldMatrix, m_Camera->GetBaseViewMatrix(), orthoMatrix);
+	if (result)
+	{
+		result = m_Text->Render(m_Direct3D->GetRenderContext(), worldMatrix, orthoMatrix);
+	}
+	m_GpuTimer->EndScope(m_Direct3D->GetRenderContext(), gpuScope);
 	if (!result)
 	{
 		return false;
 	}
+	m_timings.text += ElapsedTime(phaseStart);
 
 	//Turn off alpha blendinng after rendering the text
 	m_Direct3D->TurnOffAlphaBlending();
@@ -431,7 +764,92 @@ bool Graphics::Render(float rotation)
 	//Turn the Z buffer back on now that all 2D rendering has completed
 	m_Direct3D->TurnZBufferOn();
 
+	m_GpuTimer->EndFrame(m_Direct3D->GetRenderContext());
+
 	// Present the rendered scene to the screen.
 	m_Direct3D->EndScene();
 	return true;
 }
+
+bool Graphics::GetDraw(int modelIndex, DrawCall & draw, unsigned int & meshID, unsigned int & textureID)
+{
+	Model* drawModel;
+	ModelAsset* modelAsset;
+	TextureAsset* textureAsset;
+
+	drawModel = m_sceneModels ? &m_sceneModels[modelIndex] : &model;
+
+	modelAsset = drawModel->GetModelAsset();
+	textureAsset = drawModel->GetTextureAsset();
+	if (!modelAsset || !textureAsset)
+	{
+		return false;
+	}
+
+	draw.mesh = modelAsset->GetBuffers();
+	draw.texture = textureAsset->GetTexture();
+	draw.indexCount = modelAsset->GetIndexCount();
+	meshID = modelAsset->getID();
+	textureID = textureAsset->getID();
+
+	return true;
+}
+
+float Graphics::ElapsedTime(INT64 & start)
+{
+	INT64 currentTime;
+	float elapsed;
+
+	//Milliseconds since start, which then moves on to now for the next phase
+	QueryPerformanceCounter((LARGE_INTEGER*)&currentTime);
+	elapsed = (float)((double)(currentTime - start) * 1000.0 / (double)m_timerFrequency);
+	start = currentTime;
+
+	return elapsed;
+}
+
+const RenderStateCounters & Graphics::GetRenderStateCounters()
+{
+	return m_StateCache->GetCounters();
+}
+
+void Graphics::SetCameraPosition(float x, float y, float z)
+{
+	m_UpdateCamera->SetPosition(x, y, z);
+}
+
+void Graphics::SetLightingMode(LightingMode mode)
+{
+	m_Renderer->SetLightingMode(mode);
+}
+
+void Graphics::SetDepthPrePass(bool enabled)
+{
+	m_Renderer->SetDepthPrePass(enabled);
+}
+
+void Graphics::SetMultithreadedRecording(bool enabled)
+{
+	m_Renderer->SetMultithreadedRecording(enabled);
+}
+
+bool Graphics::GetSubmissionCounters(NullRenderCounters & counters)
+{
+	if (!m_Direct3D->IsHeadless())
+	{
+		return false;
+	}
+
+	counters = m_Direct3D->GetNullRenderContext()->GetCounters();
+	return true;
+}
+
+const FrameTimings & Graphics::GetFrameTimings()
+{
+	return m_timings;
+}
+
+int Graphics::GetGpuTimings(ProfileSummary * timings, int maxCount)
+{
+	return m_GpuTimer->GetResults(timings, maxCount);
+}
\ No newline at end of file
@@ -7,16 +7,25 @@
 #include "TextureShader.h"
 #include "LightShader.h"
 #include "Light.h"
-#include "Bitmap.h"
+#include "SpriteBatch.h"
 #include "Text.h"
 #include "ModelList.h"
-#include "Frustum.h"
+#include "FrameBuilder.h"
 
 #include "ForwardRenderer.h"
 #include "TextureAsset.h"
 #include "Assets.h"
 #include "Model.h"
 #include "ObjLoader.h"
+#include "TransformHierarchy.h"
+#include "RenderQueue.h"
+#include "RenderStateCache.h"
+#include "FrameTimings.h"
+#include "GpuTimer.h"
+#include "DebugDrawRenderer.h"
+#include "FrameSnapshot.h"
+#include "JobSystem.h"
+#include "FrameMemory.h"
 
 //Globals
 const bool FULL_SCREEN = false;
@@ -24,32 +33,86 @@ const bool VSYNC_ENABLED = false;
 const float SCREEN_DEPTH = 1000.0f;
 const float SCREEN_NEAR = 0.1f;
 
-class Graphics
+//The draws of the models come from the assets, FrameBuilder queues them through GetDraw
+class Graphics : public DrawSource
 {
 private:
 	D3D* m_Direct3D;
 	Camera* m_Camera;
-	ModelAsset* m_Model;
+	//Camera Update culls with, the one of Submit follows it through the snapshots
+	Camera* m_UpdateCamera;
+	Handle<ModelAsset> m_Model;
 	ColorShader* m_ColorShader;
 	TextureShader* m_TextureShader;
-	LightShader* m_LightShader;
 	Light* m_Light;
-	Bitmap* m_Bitmap;
+	SpriteBatch* m_SpriteBatch;
+	Handle<TextureAsset> m_spriteTexture;
 	Text* m_Text;
 	ModelList* m_ModelList;
-	Frustum* m_Frustum;
+	FrameBuilder* m_FrameBuilder;
 	TextureAsset* m_texture;
+	TransformHierarchy* m_Transforms;
+	int* m_modelNodes;
+	RenderQueue* m_RenderQueue;
+	RenderStateCache* m_StateCache;
+	GpuTimer* m_GpuTimer;
+	DebugDrawRenderer* m_DebugDraw;
 
 	ForwardRenderer* m_Renderer;
 	Assets* m_Assets;
 	Model model;
+	//One model per entry when a scene file was loaded
+	Model* m_sceneModels;
 
-	bool Render(float rotation);
+	//Only Submit writes the timings, the time of Update comes with the snapshot
+	FrameTimings m_timings;
+	INT64 m_timerFrequency;
+
+	//Spin of the models at the last two simulation steps
+	float m_rotation, m_previousRotation;
+	//Number of the frame the next Update builds, the frame memory of Update and Submit is for it
+	unsigned int m_frame;
+
+	//Snapshot Frame passes from Update to Submit
+	FrameSnapshot m_snapshot;
+
+	bool Render(const FrameSnapshot& snapshot);
+	float ElapsedTime(INT64& start);
+	//Skips the models whose assets were evicted since the snapshot was taken
+	bool GetDraw(int modelIndex, DrawCall& draw, unsigned int& meshID, unsigned int& textureID) override;
 public:
 	GRAPHIC_API Graphics();
 	GRAPHIC_API Graphics(const Graphics& other);
 	GRAPHIC_API ~Graphics();
-	GRAPHIC_API bool Initialize(int& width, int& height, HWND hwnd);
-	GRAPHIC_API bool Frame(float rotationY, int mouseX, int mouseY, int fps, int cpu, float frameTime);
+	// Headless runs without a window and only counts what would have been submitted. Without a scene file
+	// the random 50 model demo is shown.
+	GRAPHIC_API bool Initialize(int& width, int& height, HWND hwnd, bool headless = false, const char* sceneFile = 0);
+	// Advances the scene by one fixed simulation step of stepTime milliseconds.
+	GRAPHIC_API void Simulate(float stepTime);
+	// Builds the snapshot of the scene at interpolation of the way from the second to last step to the last one:
+	// the camera, the transforms, the visible models and the debug lines. Only Simulate, Update and
+	// SetCameraPosition touch this side of the scene, so they can run on another thread than Submit.
+	GRAPHIC_API void Update(float rotationY, int mouseX, int mouseY, int fps, int cpu, float frameTime, float interpolation,
+		FrameSnapshot& snapshot);
+	// Draws a snapshot Update built. Everything that touches the device, the assets and the text happens here.
+	GRAPHIC_API bool Submit(const FrameSnapshot& snapshot);
+	// Update and Submit on the calling thread.
+	GRAPHIC_API bool Frame(float rotationY, int mouseX, int mouseY, int fps, int cpu, float frameTime, float interpolation);
 	GRAPHIC_API void Shutdown();
+
+	GRAPHIC_API void SetCameraPosition(float x, float y, float z);
+
+	//State changes issued and dropped while rendering the last frame
+	GRAPHIC_API const RenderStateCounters& GetRenderStateCounters();
+
+	//Switch between tiled and clustered point light assignment
+	GRAPHIC_API void SetLightingMode(LightingMode mode);
+	GRAPHIC_API void SetDepthPrePass(bool enabled);
+	GRAPHIC_API void SetMultithreadedRecording(bool enabled);
+	// Calls, uploads and state changes of the last frame, returns false when not headless.
+	GRAPHIC_API bool GetSubmissionCounters(NullRenderCounters& counters);
+	//Time spent in each phase of the last frame, read it on the thread that submits
+	GRAPHIC_API const FrameTimings& GetFrameTimings();
+	//Gpu time of each pass of the newest frame the gpu has finished, a few frames behind
+	GRAPHIC_API int GetGpuTimings(ProfileSummary* timings, int maxCount);
 };
\ No newline at end of file
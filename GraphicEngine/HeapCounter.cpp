@@ -0,0 +1,77 @@
+#include "HeapCounter.h"
+#include <stdlib.h>
+#include <atomic>
+#include <new>
+
+namespace
+{
+	// Constant initialized, so allocations of static constructors that run before it are counted as well.
+	std::atomic<long long> s_allocations(0);
+}
+
+void* operator new(size_t size)
+{
+	void* memory;
+
+	s_allocations.fetch_add(1, std::memory_order_relaxed);
+
+	memory = malloc(size > 0 ? size : 1);
+	if (!memory)
+	{
+		throw std::bad_alloc();
+	}
+
+	return memory;
+}
+
+void* operator new[](size_t size)
+{
+	return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+	s_allocations.fetch_add(1, std::memory_order_relaxed);
+
+	return malloc(size > 0 ? size : 1);
+}
+
+void* operator new[](size_t size, const std::nothrow_t& nothrow) noexcept
+{
+	return operator new(size, nothrow);
+}
+
+void operator delete(void* pointer) noexcept
+{
+	free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept
+{
+	free(pointer);
+}
+
+void operator delete(void* pointer, size_t size) noexcept
+{
+	free(pointer);
+}
+
+void operator delete[](void* pointer, size_t size) noexcept
+{
+	free(pointer);
+}
+
+void operator delete(void* pointer, const std::nothrow_t&) noexcept
+{
+	free(pointer);
+}
+
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept
+{
+	free(pointer);
+}
+
+long long HeapCounter::GetAllocations()
+{
+	return s_allocations.load(std::memory_order_relaxed);
+}
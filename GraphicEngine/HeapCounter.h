@@ -0,0 +1,12 @@
+#pragma once
+#include "Util.h"
+
+// Counts every operator new of the engine, in every build. HeapCounter.cpp replaces the global operator new and
+// delete, which covers the module it is linked into, the engine dll or a test executable. Allocations of other
+// modules and plain malloc are not counted.
+class HeapCounter
+{
+public:
+	// Allocations since the start, take the difference around the code to measure.
+	GRAPHIC_API static long long GetAllocations();
+};
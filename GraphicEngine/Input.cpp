@@ -235,3 +235,44 @@ bool Input::IsRightArrowPressed()
 
 	return false;
 }
+
+
+bool Input::IsF1Pressed()
+{
+	if (m_keyboardState[DIK_F1] & 0x80)
+	{
+		return true;
+	}
+
+	return false;
+}
+
+bool Input::IsF2Pressed()
+{
+	if (m_keyboardState[DIK_F2] & 0x80)
+	{
+		return true;
+	}
+
+	return false;
+}
+
+bool Input::IsF3Pressed()
+{
+	if (m_keyboardState[DIK_F3] & 0x80)
+	{
+		return true;
+	}
+
+	return false;
+}
+
+bool Input::IsF4Pressed()
+{
+	if (m_keyboardState[DIK_F4] & 0x80)
+	{
+		return true;
+	}
+
+	return false;
+}
\ No newline at end of file
@@ -37,4 +37,8 @@ public:
 	void GetMouseLocation(int& mouseX, int& mouseY);
 	bool IsLeftArrowPressed();
 	bool IsRightArrowPressed();
+	bool IsF1Pressed();
+	bool IsF2Pressed();
+	bool IsF3Pressed();
+	bool IsF4Pressed();
 };
\ No newline at end of file
@@ -0,0 +1,223 @@
+#include "InstanceBatcher.h"
+
+#include <string.h>
+
+InstanceBatcher::InstanceBatcher()
+{
+	m_instances = 0;
+	m_batches = 0;
+	m_depthOrder = 0;
+	m_depthScratch = 0;
+	m_maxInstances = 0;
+	m_instanceCount = 0;
+	m_batchCount = 0;
+	m_droppedCount = 0;
+}
+
+InstanceBatcher::InstanceBatcher(const InstanceBatcher & other)
+{
+}
+
+InstanceBatcher::~InstanceBatcher()
+{
+}
+
+bool InstanceBatcher::Initialize(int maxInstances)
+{
+	m_maxInstances = maxInstances;
+
+	// Create the instance list, in the worst case every instance is a batch of its own.
+	m_instances = new InstanceData[maxInstances];
+	if (!m_instances)
+	{
+		return false;
+	}
+
+	m_batches = new InstanceBatch[maxInstances];
+	if (!m_batches)
+	{
+		return false;
+	}
+
+	// Create the two buffers the depth sort ping pongs between.
+	m_depthOrder = new int[maxInstances];
+	if (!m_depthOrder)
+	{
+		return false;
+	}
+
+	m_depthScratch = new int[maxInstances];
+	if (!m_depthScratch)
+	{
+		return false;
+	}
+
+	return true;
+}
+
+void InstanceBatcher::Shutdown()
+{
+	// Release the depth order.
+	if (m_depthScratch)
+	{
+		delete[] m_depthScratch;
+		m_depthScratch = 0;
+	}
+
+	if (m_depthOrder)
+	{
+		delete[] m_depthOrder;
+		m_depthOrder = 0;
+	}
+
+	// Release the batch list.
+	if (m_batches)
+	{
+		delete[] m_batches;
+		m_batches = 0;
+	}
+
+	// Release the instance list.
+	if (m_instances)
+	{
+		delete[] m_instances;
+		m_instances = 0;
+	}
+
+	m_maxInstances = 0;
+	m_instanceCount = 0;
+	m_batchCount = 0;
+}
+
+bool InstanceBatcher::CanBatch(const DrawCall & first, const DrawCall & draw)
+{
+	// The state bits of the key have to match, the depth bits are free to differ.
+	if ((first.key >> RENDER_KEY_DEPTH_BITS) != (draw.key >> RENDER_KEY_DEPTH_BITS))
+	{
+		return false;
+	}
+
+	// Compare the resources themselves as well, the ids in the key are truncated.
+	return first.mesh == draw.mesh && first.texture == draw.texture && first.indexCount == draw.indexCount;
+}
+
+void InstanceBatcher::Build(RenderQueue * renderQueue)
+{
+	InstanceBatch* batch;
+	int drawCount, i;
+
+	m_instanceCount = 0;
+	m_batchCount = 0;
+	m_droppedCount = 0;
+	batch = 0;
+
+	drawCount = renderQueue->GetDrawCount();
+	if (drawCount > m_maxInstances)
+	{
+		m_droppedCount = drawCount - m_maxInstances;
+		drawCount = m_maxInstances;
+	}
+
+	for (i = 0; i < drawCount; i++)
+	{
+		const DrawCall& draw = renderQueue->GetDraw(i);
+
+		// Start a new batch when the state differs from the draw that opened the current one.
+		if (!batch || !CanBatch(renderQueue->GetDraw(batch->firstDraw), draw))
+		{
+			batch = &m_batches[m_batchCount++];
+			batch->firstDraw = i;
+			batch->firstInstance = m_instanceCount;
+			batch->instanceCount = 0;
+			batch->depth = RenderQueue::GetKeyDepth(draw.key);
+		}
+
+		m_instances[m_instanceCount].worldMatrix = draw.worldMatrix;
+		m_instances[m_instanceCount].color = draw.color;
+		m_instanceCount++;
+
+		batch->instanceCount++;
+	}
+}
+
+void InstanceBatcher::SortByDepth()
+{
+	unsigned int histogram[256];
+	unsigned int offset, count;
+	unsigned char digit;
+	int* source;
+	int* destination;
+	int* swap;
+	int i, pass;
+
+	for (i = 0; i < m_batchCount; i++)
+	{
+		m_depthOrder[i] = i;
+	}
+
+	source = m_depthOrder;
+	destination = m_depthScratch;
+
+	// Same LSD radix sort as the render queue, over the depth bits only.
+	for (pass = 0; pass < RENDER_KEY_DEPTH_BITS / 8; pass++)
+	{
+		memset(histogram, 0, sizeof(histogram));
+		for (i = 0; i < m_batchCount; i++)
+		{
+			histogram[(m_batches[source[i]].depth >> (pass * 8)) & 0xff]++;
+		}
+
+		offset = 0;
+		for (i = 0; i < 256; i++)
+		{
+			count = histogram[i];
+			histogram[i] = offset;
+			offset += count;
+		}
+
+		for (i = 0; i < m_batchCount; i++)
+		{
+			digit = (unsigned char)((m_batches[source[i]].depth >> (pass * 8)) & 0xff);
+			destination[histogram[digit]++] = source[i];
+		}
+
+		swap = source;
+		source = destination;
+		destination = swap;
+	}
+
+	if (source != m_depthOrder)
+	{
+		memcpy(m_depthOrder, source, sizeof(int) * m_batchCount);
+	}
+}
+
+int InstanceBatcher::GetBatchCount()
+{
+	return m_batchCount;
+}
+
+const InstanceBatch & InstanceBatcher::GetBatch(int index)
+{
+	return m_batches[index];
+}
+
+int InstanceBatcher::GetDepthOrderedBatch(int index)
+{
+	return m_depthOrder[index];
+}
+
+int InstanceBatcher::GetInstanceCount()
+{
+	return m_instanceCount;
+}
+
+const InstanceData * InstanceBatcher::GetInstances()
+{
+	return m_instances;
+}
+
+int InstanceBatcher::GetDroppedCount()
+{
+	return m_droppedCount;
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <DirectXMath.h>
+#include "RenderQueue.h"
+using namespace DirectX;
+
+// Per instance vertex data, laid out as the WORLD and COLOR inputs of light_instanced_vs.hlsl.
+struct InstanceData
+{
+	XMFLOAT4X4 worldMatrix;
+	XMFLOAT4 color;
+};
+
+// A run of sorted draws that share mesh and texture and can go out in one DrawIndexedInstanced.
+struct InstanceBatch
+{
+	int firstDraw;
+	int firstInstance;
+	int instanceCount;
+
+	// Quantized depth of the nearest instance, the instances of a batch are in front to back order.
+	unsigned int depth;
+};
+
+// Turns a sorted render queue into instance batches. Only touches memory, so it can be used
+// without a device.
+class InstanceBatcher
+{
+private:
+	InstanceData* m_instances;
+	InstanceBatch* m_batches;
+	int* m_depthOrder;
+	int* m_depthScratch;
+	int m_maxInstances;
+	int m_instanceCount;
+	int m_batchCount;
+	int m_droppedCount;
+
+	bool CanBatch(const DrawCall& first, const DrawCall& draw);
+public:
+	InstanceBatcher();
+	InstanceBatcher(const InstanceBatcher&);
+	~InstanceBatcher();
+
+	// The renderer sizes the batcher to the capacity of its render queue, so nothing is dropped.
+	bool Initialize(int maxInstances);
+	void Shutdown();
+
+	// Walks the queue in sorted order, draws beyond the instance limit are dropped and counted.
+	void Build(RenderQueue* renderQueue);
+
+	// Orders the batches front to back by their nearest instance, without touching the state order.
+	void SortByDepth();
+
+	int GetBatchCount();
+	const InstanceBatch& GetBatch(int index);
+	// Index of the batch at a position of the front to back order.
+	int GetDepthOrderedBatch(int index);
+	int GetInstanceCount();
+	const InstanceData* GetInstances();
+	// Draws of the last Build that did not fit.
+	int GetDroppedCount();
+};
@@ -0,0 +1,373 @@
+#include "JobSystem.h"
+#include "WorkStealingDeque.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+namespace
+{
+	struct Job
+	{
+		JobFunction function;
+		void* data;
+		int begin;
+		int end;
+		// Zero runs the range in one call.
+		int grainSize;
+		JobCounter* counter;
+	};
+
+	// A job in the ring of the thread that pushed it. The slot stays taken from the push until the thread that took
+	// the job out of the deque copied it, a thief may still be about to copy a job that already left the deque.
+	struct JobSlot
+	{
+		Job job;
+		std::atomic<bool> taken;
+	};
+
+	struct JobThread
+	{
+		WorkStealingDeque<JobSlot, JOB_SYSTEM_MAX_JOBS> deque;
+		// Slots are used in turn, twice as many as the deque holds so the copies have time to finish. A slot that
+		// is still taken when its turn comes runs its new job right away instead.
+		JobSlot jobs[JOB_SYSTEM_MAX_JOBS * 2];
+		unsigned int nextJob;
+		// Thread the next steal starts at, so the thieves spread over the deques.
+		int nextVictim;
+	};
+
+	std::mutex s_threadMutex;
+	JobThread* s_threads[JOB_SYSTEM_MAX_THREADS];
+	std::atomic<int> s_threadCount(0);
+
+	std::thread s_workers[JOB_SYSTEM_MAX_THREADS];
+	int s_workerCount = 0;
+
+	// Pushed jobs no thread took yet, the workers sleep while there are none.
+	std::mutex s_sleepMutex;
+	std::condition_variable s_wakeCondition;
+	std::atomic<int> s_queued(0);
+	std::atomic<int> s_sleeping(0);
+	bool s_quit = false;
+
+	// Goes up with every Shutdown, which frees the deques of all threads, so a thread that still points at its
+	// deque of an earlier run knows to get a new one.
+	std::atomic<unsigned int> s_generation(0);
+
+	thread_local JobThread* t_thread = 0;
+	thread_local unsigned int t_generation = 0;
+
+	JobThread* GetThread()
+	{
+		JobThread* thread;
+		int i;
+
+		if (t_thread && t_generation == s_generation.load(std::memory_order_acquire))
+		{
+			return t_thread;
+		}
+
+		// First job of this thread, give it a deque. Threads past the maximum run their jobs right away.
+		std::lock_guard<std::mutex> lock(s_threadMutex);
+
+		t_thread = 0;
+		t_generation = s_generation.load(std::memory_order_relaxed);
+
+		if (s_threadCount >= JOB_SYSTEM_MAX_THREADS)
+		{
+			return 0;
+		}
+
+		thread = new JobThread;
+		if (!thread)
+		{
+			return 0;
+		}
+
+		for (i = 0; i < JOB_SYSTEM_MAX_JOBS * 2; i++)
+		{
+			thread->jobs[i].taken.store(false, std::memory_order_relaxed);
+		}
+
+		thread->nextJob = 0;
+		thread->nextVictim = s_threadCount;
+
+		s_threads[s_threadCount] = thread;
+		s_threadCount++;
+
+		t_thread = thread;
+		return thread;
+	}
+
+	void Execute(Job* job);
+
+	void Push(JobFunction function, void* data, int begin, int end, int grainSize, JobCounter* counter)
+	{
+		JobThread* thread;
+		JobSlot* slot;
+		Job job;
+
+		if (counter)
+		{
+			counter->fetch_add(1, std::memory_order_relaxed);
+		}
+
+		job.function = function;
+		job.data = data;
+		job.begin = begin;
+		job.end = end;
+		job.grainSize = grainSize;
+		job.counter = counter;
+
+		// Acquire so the copy of the thread that took the old job of the slot is done before it is written.
+		thread = s_workerCount > 0 ? GetThread() : 0;
+		slot = thread ? &thread->jobs[thread->nextJob % (JOB_SYSTEM_MAX_JOBS * 2)] : 0;
+		if (!slot || slot->taken.load(std::memory_order_acquire))
+		{
+			Execute(&job);
+			return;
+		}
+
+		slot->job = job;
+		slot->taken.store(true, std::memory_order_relaxed);
+
+		if (!thread->deque.Push(slot))
+		{
+			slot->taken.store(false, std::memory_order_relaxed);
+			Execute(&job);
+			return;
+		}
+
+		thread->nextJob++;
+
+		// Wake a worker up if one sleeps. The sleeper counts itself before it checks for jobs and the job is
+		// counted here before the sleepers are checked, so at least one of the two sees the other.
+		s_queued.fetch_add(1);
+		if (s_sleeping.load() > 0)
+		{
+			{
+				std::lock_guard<std::mutex> lock(s_sleepMutex);
+			}
+			s_wakeCondition.notify_one();
+		}
+	}
+
+	void Execute(Job* job)
+	{
+		int middle;
+
+		// Leave the upper half of a big range to another thread until the rest is small enough.
+		while (job->grainSize > 0 && job->end - job->begin > job->grainSize)
+		{
+			middle = job->begin + (job->end - job->begin) / 2;
+			Push(job->function, job->data, middle, job->end, job->grainSize, job->counter);
+			job->end = middle;
+		}
+
+		job->function(job->data, job->begin, job->end);
+
+		// Release so the thread that waits sees everything the job wrote.
+		if (job->counter)
+		{
+			job->counter->fetch_sub(1, std::memory_order_release);
+		}
+	}
+
+	JobSlot* FindJob(JobThread* thread)
+	{
+		JobSlot* job;
+		int count, start, i;
+
+		// Own jobs newest first, they are the most likely to still be in the cache.
+		if (thread)
+		{
+			job = thread->deque.Pop();
+			if (job)
+			{
+				return job;
+			}
+		}
+
+		count = s_threadCount.load(std::memory_order_acquire);
+		start = thread ? thread->nextVictim : 0;
+
+		for (i = 0; i < count; i++)
+		{
+			if (s_threads[(start + i) % count] == thread)
+			{
+				continue;
+			}
+
+			job = s_threads[(start + i) % count]->deque.Steal();
+			if (job)
+			{
+				if (thread)
+				{
+					thread->nextVictim = (start + i) % count;
+				}
+				return job;
+			}
+		}
+
+		return 0;
+	}
+
+	bool RunJob(JobThread* thread)
+	{
+		JobSlot* found;
+		Job job;
+
+		found = FindJob(thread);
+		if (!found)
+		{
+			return false;
+		}
+
+		// Run a copy and give the slot back, release so the thread that pushed the job only reuses it afterwards.
+		job = found->job;
+		found->taken.store(false, std::memory_order_release);
+
+		s_queued.fetch_sub(1);
+		Execute(&job);
+
+		return true;
+	}
+
+	void WorkerLoop()
+	{
+		JobThread* thread;
+
+		thread = GetThread();
+
+		while (true)
+		{
+			if (RunJob(thread))
+			{
+				continue;
+			}
+
+			// Sleep until a job is pushed or until the job system shuts down.
+			std::unique_lock<std::mutex> lock(s_sleepMutex);
+			s_sleeping.fetch_add(1);
+			s_wakeCondition.wait(lock, [] { return s_quit || s_queued.load() > 0; });
+			s_sleeping.fetch_sub(1);
+
+			if (s_quit)
+			{
+				return;
+			}
+		}
+	}
+}
+
+bool JobSystem::Initialize(int workerCount)
+{
+	int i;
+
+	if (workerCount > JOB_SYSTEM_MAX_THREADS - 1)
+	{
+		workerCount = JOB_SYSTEM_MAX_THREADS - 1;
+	}
+
+	s_quit = false;
+	s_workerCount = workerCount;
+
+	for (i = 0; i < workerCount; i++)
+	{
+		s_workers[i] = std::thread(WorkerLoop);
+	}
+
+	return true;
+}
+
+void JobSystem::Shutdown()
+{
+	int i;
+
+	// Wake the workers up and wait for them to leave their loop.
+	{
+		std::lock_guard<std::mutex> lock(s_sleepMutex);
+		s_quit = true;
+	}
+	s_wakeCondition.notify_all();
+
+	for (i = 0; i < JOB_SYSTEM_MAX_THREADS; i++)
+	{
+		if (s_workers[i].joinable())
+		{
+			s_workers[i].join();
+		}
+	}
+
+	s_workerCount = 0;
+
+	// Free the deques of every thread.
+	std::lock_guard<std::mutex> lock(s_threadMutex);
+
+	for (i = 0; i < s_threadCount; i++)
+	{
+		delete s_threads[i];
+		s_threads[i] = 0;
+	}
+
+	s_threadCount = 0;
+	s_generation.fetch_add(1, std::memory_order_release);
+	t_thread = 0;
+}
+
+void JobSystem::Run(JobFunction function, void * data, JobCounter * counter)
+{
+	Push(function, data, 0, 1, 0, counter);
+}
+
+void JobSystem::ParallelFor(int count, int grainSize, JobFunction function, void * data)
+{
+	JobCounter counter(0);
+
+	if (count <= 0)
+	{
+		return;
+	}
+
+	Push(function, data, 0, count, grainSize > 0 ? grainSize : 1, &counter);
+	Wait(&counter);
+}
+
+void JobSystem::Wait(JobCounter * counter)
+{
+	JobThread* thread;
+
+	thread = s_workerCount > 0 ? GetThread() : 0;
+
+	// Acquire so the jobs that finished wrote everything before this returns.
+	while (counter->load(std::memory_order_acquire) > 0)
+	{
+		if (!RunJob(thread))
+		{
+			std::this_thread::yield();
+		}
+	}
+}
+
+int JobSystem::GetWorkerCount()
+{
+	return s_workerCount;
+}
+
+int JobSystem::GetDefaultWorkerCount()
+{
+	int count;
+
+	count = (int)std::thread::hardware_concurrency() - 1;
+	if (count < 0)
+	{
+		count = 0;
+	}
+
+	if (count > JOB_SYSTEM_MAX_THREADS - 1)
+	{
+		count = JOB_SYSTEM_MAX_THREADS - 1;
+	}
+
+	return count;
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <atomic>
+#include "Util.h"
+
+// Threads that can start or run jobs: the workers and every thread that started a job or waited for one. Jobs of
+// threads past it run right away on the thread that starts them.
+#define JOB_SYSTEM_MAX_THREADS 32
+// Jobs every thread can have waiting in its deque, a power of two. A job that does not fit any more runs right
+// away on the thread that starts it.
+#define JOB_SYSTEM_MAX_JOBS 4096
+
+// Runs the items [begin, end) of a job.
+typedef void(*JobFunction)(void* data, int begin, int end);
+
+// Jobs started with the counter that did not finish yet.
+typedef std::atomic<int> JobCounter;
+
+// Shared pool of worker threads. Every thread pushes the jobs it starts to a work stealing deque of its own and
+// pops them again newest first, threads that ran out of jobs steal the oldest ones of the other threads. Workers
+// without anything to steal sleep until a job is pushed. A thread that waits for jobs runs jobs meanwhile, so a job
+// can start more jobs and wait for them, which is how a job depends on others.
+class JobSystem
+{
+public:
+	// Without workers every job runs right away on the thread that starts it.
+	GRAPHIC_API static bool Initialize(int workerCount);
+	// Waits for the workers to leave their loop. No job may be started afterwards until the next Initialize, which
+	// gives every thread that started or waited for jobs before a new deque.
+	GRAPHIC_API static void Shutdown();
+
+	// Calls function(data, 0, 1) on any thread. The counter goes up by one until the job finished, it may be 0.
+	GRAPHIC_API static void Run(JobFunction function, void* data, JobCounter* counter);
+	// Calls function for ranges of at most grainSize items that together cover [0, count) and returns once all of
+	// them finished. Jobs split their range in halves until it is small enough, so thieves take the big halves.
+	GRAPHIC_API static void ParallelFor(int count, int grainSize, JobFunction function, void* data);
+	// Runs jobs until the counter is zero.
+	GRAPHIC_API static void Wait(JobCounter* counter);
+
+	GRAPHIC_API static int GetWorkerCount();
+	// One worker less than the hardware threads, the thread that waits for the jobs runs them as well.
+	GRAPHIC_API static int GetDefaultWorkerCount();
+};
@@ -0,0 +1,434 @@
+#include "LightClusters.h"
+
+#include <math.h>
+#include <string.h>
+#include <emmintrin.h>
+
+LightClusterBuilder::LightClusterBuilder()
+{
+	m_minTileX = 0;
+	m_maxTileX = 0;
+	m_minTileY = 0;
+	m_maxTileY = 0;
+	m_minSlice = 0;
+	m_maxSlice = 0;
+	m_clusterRanges = 0;
+	m_clusterCursors = 0;
+	m_lightIndices = 0;
+	m_maxLights = 0;
+	m_lightIndexCount = 0;
+	m_overflow = false;
+	m_droppedIndexCount = 0;
+}
+
+LightClusterBuilder::LightClusterBuilder(const LightClusterBuilder & other)
+{
+}
+
+LightClusterBuilder::~LightClusterBuilder()
+{
+}
+
+bool LightClusterBuilder::Initialize(int screenWidth, int screenHeight, float screenNear, float screenDepth, int maxLights)
+{
+	int i;
+
+	m_screenWidth = screenWidth;
+	m_screenHeight = screenHeight;
+	m_screenNear = screenNear;
+	m_screenDepth = screenDepth;
+	m_maxLights = maxLights;
+
+	m_tilesX = (screenWidth + LIGHT_CLUSTER_TILE_SIZE - 1) / LIGHT_CLUSTER_TILE_SIZE;
+	m_tilesY = (screenHeight + LIGHT_CLUSTER_TILE_SIZE - 1) / LIGHT_CLUSTER_TILE_SIZE;
+	m_clusterCount = m_tilesX * m_tilesY * LIGHT_CLUSTER_SLICES;
+
+	// Every slice is the same factor deeper than the one in front of it.
+	for (i = 0; i <= LIGHT_CLUSTER_SLICES; i++)
+	{
+		m_sliceBoundaries[i] = screenNear * powf(screenDepth / screenNear, (float)i / (float)LIGHT_CLUSTER_SLICES);
+	}
+
+	// Create the per light bounds.
+	m_minTileX = new int[maxLights];
+	m_maxTileX = new int[maxLights];
+	m_minTileY = new int[maxLights];
+	m_maxTileY = new int[maxLights];
+	m_minSlice = new int[maxLights];
+	m_maxSlice = new int[maxLights];
+	if (!m_minTileX || !m_maxTileX || !m_minTileY || !m_maxTileY || !m_minSlice || !m_maxSlice)
+	{
+		return false;
+	}
+
+	// Create the cluster lists.
+	m_clusterRanges = new unsigned int[m_clusterCount * 2];
+	if (!m_clusterRanges)
+	{
+		return false;
+	}
+
+	m_clusterCursors = new unsigned int[m_clusterCount];
+	if (!m_clusterCursors)
+	{
+		return false;
+	}
+
+	m_lightIndices = new unsigned int[LIGHT_CLUSTER_MAX_INDICES];
+	if (!m_lightIndices)
+	{
+		return false;
+	}
+
+	memset(m_clusterRanges, 0, sizeof(unsigned int) * m_clusterCount * 2);
+	m_lightIndexCount = 0;
+
+	return true;
+}
+
+void LightClusterBuilder::Shutdown()
+{
+	// Release the cluster lists.
+	if (m_lightIndices)
+	{
+		delete[] m_lightIndices;
+		m_lightIndices = 0;
+	}
+
+	if (m_clusterCursors)
+	{
+		delete[] m_clusterCursors;
+		m_clusterCursors = 0;
+	}
+
+	if (m_clusterRanges)
+	{
+		delete[] m_clusterRanges;
+		m_clusterRanges = 0;
+	}
+
+	// Release the per light bounds.
+	if (m_maxSlice)
+	{
+		delete[] m_maxSlice;
+		m_maxSlice = 0;
+	}
+
+	if (m_minSlice)
+	{
+		delete[] m_minSlice;
+		m_minSlice = 0;
+	}
+
+	if (m_maxTileY)
+	{
+		delete[] m_maxTileY;
+		m_maxTileY = 0;
+	}
+
+	if (m_minTileY)
+	{
+		delete[] m_minTileY;
+		m_minTileY = 0;
+	}
+
+	if (m_maxTileX)
+	{
+		delete[] m_maxTileX;
+		m_maxTileX = 0;
+	}
+
+	if (m_minTileX)
+	{
+		delete[] m_minTileX;
+		m_minTileX = 0;
+	}
+}
+
+int LightClusterBuilder::ComputeSlice(float depth)
+{
+	int slice, i;
+
+	// Count the boundaries in front of the depth, the same way the vector path does it.
+	slice = 0;
+	for (i = 1; i < LIGHT_CLUSTER_SLICES; i++)
+	{
+		if (m_sliceBoundaries[i] <= depth)
+		{
+			slice++;
+		}
+	}
+
+	return slice;
+}
+
+void LightClusterBuilder::ComputeBounds(const PointLight* lights, int first, const XMFLOAT4X4& view, const XMFLOAT4X4& projection)
+{
+	float x, y, z, radius, centerX, centerY, centerZ, nearZ, farZ;
+	float left, right, bottom, top, tileScaleX, tileScaleY;
+	bool visible;
+
+	x = lights[first].position.x;
+	y = lights[first].position.y;
+	z = lights[first].position.z;
+	radius = lights[first].range;
+
+	// Move the light to view space.
+	centerX = x * view._11 + y * view._21 + z * view._31 + view._41;
+	centerY = x * view._12 + y * view._22 + z * view._32 + view._42;
+	centerZ = x * view._13 + y * view._23 + z * view._33 + view._43;
+
+	// Depth range of the bounding box, clamped to the near plane.
+	nearZ = centerZ - radius > m_screenNear ? centerZ - radius : m_screenNear;
+	farZ = centerZ + radius > m_screenNear ? centerZ + radius : m_screenNear;
+
+	// Project the box, the extremes are at its nearest or farthest corners.
+	left = fminf(projection._11 * (centerX - radius) / nearZ, projection._11 * (centerX - radius) / farZ);
+	right = fmaxf(projection._11 * (centerX + radius) / nearZ, projection._11 * (centerX + radius) / farZ);
+	bottom = fminf(projection._22 * (centerY - radius) / nearZ, projection._22 * (centerY - radius) / farZ);
+	top = fmaxf(projection._22 * (centerY + radius) / nearZ, projection._22 * (centerY + radius) / farZ);
+
+	visible = centerZ + radius > m_screenNear && centerZ - radius < m_screenDepth;
+	visible = visible && left <= 1.0f && right >= -1.0f && bottom <= 1.0f && top >= -1.0f;
+
+	if (!visible)
+	{
+		m_minTileX[first] = m_minTileY[first] = m_minSlice[first] = LIGHT_CLUSTER_SLICES;
+		m_maxTileX[first] = m_maxTileY[first] = m_maxSlice[first] = -1;
+		return;
+	}
+
+	left = fmaxf(left, -1.0f);
+	right = fminf(right, 1.0f);
+	bottom = fmaxf(bottom, -1.0f);
+	top = fminf(top, 1.0f);
+
+	// Screen y runs down while normalized device y runs up.
+	tileScaleX = 0.5f * (float)m_screenWidth / (float)LIGHT_CLUSTER_TILE_SIZE;
+	tileScaleY = 0.5f * (float)m_screenHeight / (float)LIGHT_CLUSTER_TILE_SIZE;
+
+	m_minTileX[first] = (int)fminf((left + 1.0f) * tileScaleX, (float)(m_tilesX - 1));
+	m_maxTileX[first] = (int)fminf((right + 1.0f) * tileScaleX, (float)(m_tilesX - 1));
+	m_minTileY[first] = (int)fminf((1.0f - top) * tileScaleY, (float)(m_tilesY - 1));
+	m_maxTileY[first] = (int)fminf((1.0f - bottom) * tileScaleY, (float)(m_tilesY - 1));
+
+	m_minSlice[first] = ComputeSlice(nearZ);
+	m_maxSlice[first] = ComputeSlice(farZ);
+}
+
+void LightClusterBuilder::ComputeBoundsSSE(const PointLight* lights, int first, const XMFLOAT4X4& view, const XMFLOAT4X4& projection)
+{
+	__m128 x, y, z, radius, centerX, centerY, centerZ, nearZ, farZ, screenNear, one, minusOne;
+	__m128 low, high, left, right, bottom, top, visible, tileScaleX, tileScaleY, maxTileX, maxTileY, boundary;
+	__m128i minSlice, maxSlice, hidden, shown;
+	const PointLight* light;
+	int i;
+
+	// Gather four lights into structure of arrays form.
+	light = lights + first;
+	x = _mm_setr_ps(light[0].position.x, light[1].position.x, light[2].position.x, light[3].position.x);
+	y = _mm_setr_ps(light[0].position.y, light[1].position.y, light[2].position.y, light[3].position.y);
+	z = _mm_setr_ps(light[0].position.z, light[1].position.z, light[2].position.z, light[3].position.z);
+	radius = _mm_setr_ps(light[0].range, light[1].range, light[2].range, light[3].range);
+
+	// Move the lights to view space.
+	centerX = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(view._11)), _mm_mul_ps(y, _mm_set1_ps(view._21))),
+		_mm_add_ps(_mm_mul_ps(z, _mm_set1_ps(view._31)), _mm_set1_ps(view._41)));
+	centerY = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(view._12)), _mm_mul_ps(y, _mm_set1_ps(view._22))),
+		_mm_add_ps(_mm_mul_ps(z, _mm_set1_ps(view._32)), _mm_set1_ps(view._42)));
+	centerZ = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(view._13)), _mm_mul_ps(y, _mm_set1_ps(view._23))),
+		_mm_add_ps(_mm_mul_ps(z, _mm_set1_ps(view._33)), _mm_set1_ps(view._43)));
+
+	// Depth range of the bounding boxes, clamped to the near plane.
+	screenNear = _mm_set1_ps(m_screenNear);
+	nearZ = _mm_max_ps(_mm_sub_ps(centerZ, radius), screenNear);
+	farZ = _mm_max_ps(_mm_add_ps(centerZ, radius), screenNear);
+
+	// Project the boxes, the extremes are at their nearest or farthest corners.
+	low = _mm_mul_ps(_mm_set1_ps(projection._11), _mm_sub_ps(centerX, radius));
+	high = _mm_mul_ps(_mm_set1_ps(projection._11), _mm_add_ps(centerX, radius));
+	left = _mm_min_ps(_mm_div_ps(low, nearZ), _mm_div_ps(low, farZ));
+	right = _mm_max_ps(_mm_div_ps(high, nearZ), _mm_div_ps(high, farZ));
+
+	low = _mm_mul_ps(_mm_set1_ps(projection._22), _mm_sub_ps(centerY, radius));
+	high = _mm_mul_ps(_mm_set1_ps(projection._22), _mm_add_ps(centerY, radius));
+	bottom = _mm_min_ps(_mm_div_ps(low, nearZ), _mm_div_ps(low, farZ));
+	top = _mm_max_ps(_mm_div_ps(high, nearZ), _mm_div_ps(high, farZ));
+
+	one = _mm_set1_ps(1.0f);
+	minusOne = _mm_set1_ps(-1.0f);
+
+	visible = _mm_and_ps(_mm_cmpgt_ps(_mm_add_ps(centerZ, radius), screenNear), _mm_cmplt_ps(_mm_sub_ps(centerZ, radius), _mm_set1_ps(m_screenDepth)));
+	visible = _mm_and_ps(visible, _mm_and_ps(_mm_cmple_ps(left, one), _mm_cmpge_ps(right, minusOne)));
+	visible = _mm_and_ps(visible, _mm_and_ps(_mm_cmple_ps(bottom, one), _mm_cmpge_ps(top, minusOne)));
+
+	left = _mm_max_ps(left, minusOne);
+	right = _mm_min_ps(right, one);
+	bottom = _mm_max_ps(bottom, minusOne);
+	top = _mm_min_ps(top, one);
+
+	// Screen y runs down while normalized device y runs up.
+	tileScaleX = _mm_set1_ps(0.5f * (float)m_screenWidth / (float)LIGHT_CLUSTER_TILE_SIZE);
+	tileScaleY = _mm_set1_ps(0.5f * (float)m_screenHeight / (float)LIGHT_CLUSTER_TILE_SIZE);
+	maxTileX = _mm_set1_ps((float)(m_tilesX - 1));
+	maxTileY = _mm_set1_ps((float)(m_tilesY - 1));
+
+	left = _mm_min_ps(_mm_mul_ps(_mm_add_ps(left, one), tileScaleX), maxTileX);
+	right = _mm_min_ps(_mm_mul_ps(_mm_add_ps(right, one), tileScaleX), maxTileX);
+	top = _mm_min_ps(_mm_mul_ps(_mm_sub_ps(one, top), tileScaleY), maxTileY);
+	bottom = _mm_min_ps(_mm_mul_ps(_mm_sub_ps(one, bottom), tileScaleY), maxTileY);
+
+	// Count the slice boundaries in front of each depth, a compare gives -1 for every one that is.
+	minSlice = _mm_setzero_si128();
+	maxSlice = _mm_setzero_si128();
+	for (i = 1; i < LIGHT_CLUSTER_SLICES; i++)
+	{
+		boundary = _mm_set1_ps(m_sliceBoundaries[i]);
+		minSlice = _mm_sub_epi32(minSlice, _mm_castps_si128(_mm_cmple_ps(boundary, nearZ)));
+		maxSlice = _mm_sub_epi32(maxSlice, _mm_castps_si128(_mm_cmple_ps(boundary, farZ)));
+	}
+
+	// Lights that can not be seen get an empty range.
+	shown = _mm_castps_si128(visible);
+	hidden = _mm_set1_epi32(LIGHT_CLUSTER_SLICES);
+
+	_mm_storeu_si128((__m128i*)(m_minTileX + first), _mm_or_si128(_mm_and_si128(shown, _mm_cvttps_epi32(left)), _mm_andnot_si128(shown, hidden)));
+	_mm_storeu_si128((__m128i*)(m_minTileY + first), _mm_or_si128(_mm_and_si128(shown, _mm_cvttps_epi32(top)), _mm_andnot_si128(shown, hidden)));
+	_mm_storeu_si128((__m128i*)(m_minSlice + first), _mm_or_si128(_mm_and_si128(shown, minSlice), _mm_andnot_si128(shown, hidden)));
+
+	hidden = _mm_set1_epi32(-1);
+
+	_mm_storeu_si128((__m128i*)(m_maxTileX + first), _mm_or_si128(_mm_and_si128(shown, _mm_cvttps_epi32(right)), _mm_andnot_si128(shown, hidden)));
+	_mm_storeu_si128((__m128i*)(m_maxTileY + first), _mm_or_si128(_mm_and_si128(shown, _mm_cvttps_epi32(bottom)), _mm_andnot_si128(shown, hidden)));
+	_mm_storeu_si128((__m128i*)(m_maxSlice + first), _mm_or_si128(_mm_and_si128(shown, maxSlice), _mm_andnot_si128(shown, hidden)));
+}
+
+void LightClusterBuilder::Build(const PointLight* lights, int lightCount, CXMMATRIX viewMatrix, CXMMATRIX projectionMatrix)
+{
+	XMFLOAT4X4 view, projection;
+	unsigned int offset, count, available;
+	int i, slice, tileX, tileY, cluster;
+
+	XMStoreFloat4x4(&view, viewMatrix);
+	XMStoreFloat4x4(&projection, projectionMatrix);
+
+	if (lightCount > m_maxLights)
+	{
+		lightCount = m_maxLights;
+	}
+
+	// Find the cluster range of every light, four at a time and the remainder one by one.
+	for (i = 0; i + 4 <= lightCount; i += 4)
+	{
+		ComputeBoundsSSE(lights, i, view, projection);
+	}
+
+	for (; i < lightCount; i++)
+	{
+		ComputeBounds(lights, i, view, projection);
+	}
+
+	// Count the lights of every cluster.
+	memset(m_clusterCursors, 0, sizeof(unsigned int) * m_clusterCount);
+
+	for (i = 0; i < lightCount; i++)
+	{
+		for (slice = m_minSlice[i]; slice <= m_maxSlice[i]; slice++)
+		{
+			for (tileY = m_minTileY[i]; tileY <= m_maxTileY[i]; tileY++)
+			{
+				cluster = (slice * m_tilesY + tileY) * m_tilesX;
+				for (tileX = m_minTileX[i]; tileX <= m_maxTileX[i]; tileX++)
+				{
+					m_clusterCursors[cluster + tileX]++;
+				}
+			}
+		}
+	}
+
+	// Turn the counts into ranges of the index list, clusters past the end of the list are cut short.
+	offset = 0;
+	for (cluster = 0; cluster < m_clusterCount; cluster++)
+	{
+		count = m_clusterCursors[cluster];
+
+		m_clusterRanges[cluster * 2] = offset < LIGHT_CLUSTER_MAX_INDICES ? offset : LIGHT_CLUSTER_MAX_INDICES;
+		available = LIGHT_CLUSTER_MAX_INDICES - m_clusterRanges[cluster * 2];
+		m_clusterRanges[cluster * 2 + 1] = count < available ? count : available;
+
+		m_clusterCursors[cluster] = m_clusterRanges[cluster * 2];
+		offset += count;
+	}
+
+	m_overflow = offset > LIGHT_CLUSTER_MAX_INDICES;
+	m_lightIndexCount = m_overflow ? LIGHT_CLUSTER_MAX_INDICES : offset;
+	m_droppedIndexCount = (int)offset - m_lightIndexCount;
+
+	// Write the light indices, in light order within every cluster.
+	for (i = 0; i < lightCount; i++)
+	{
+		for (slice = m_minSlice[i]; slice <= m_maxSlice[i]; slice++)
+		{
+			for (tileY = m_minTileY[i]; tileY <= m_maxTileY[i]; tileY++)
+			{
+				cluster = (slice * m_tilesY + tileY) * m_tilesX;
+				for (tileX = m_minTileX[i]; tileX <= m_maxTileX[i]; tileX++)
+				{
+					if (m_clusterCursors[cluster + tileX] < m_clusterRanges[(cluster + tileX) * 2] + m_clusterRanges[(cluster + tileX) * 2 + 1])
+					{
+						m_lightIndices[m_clusterCursors[cluster + tileX]++] = i;
+					}
+				}
+			}
+		}
+	}
+}
+
+int LightClusterBuilder::GetTilesX()
+{
+	return m_tilesX;
+}
+
+int LightClusterBuilder::GetTilesY()
+{
+	return m_tilesY;
+}
+
+int LightClusterBuilder::GetClusterCount()
+{
+	return m_clusterCount;
+}
+
+const unsigned int * LightClusterBuilder::GetClusterRanges()
+{
+	return m_clusterRanges;
+}
+
+const unsigned int * LightClusterBuilder::GetLightIndices()
+{
+	return m_lightIndices;
+}
+
+int LightClusterBuilder::GetLightIndexCount()
+{
+	return m_lightIndexCount;
+}
+
+bool LightClusterBuilder::HasOverflowed()
+{
+	return m_overflow;
+}
+
+int LightClusterBuilder::GetDroppedIndexCount()
+{
+	return m_droppedIndexCount;
+}
+
+XMFLOAT2 LightClusterBuilder::GetSliceParameters()
+{
+	float scale;
+
+	scale = (float)LIGHT_CLUSTER_SLICES / log2f(m_screenDepth / m_screenNear);
+
+	return XMFLOAT2(scale, -log2f(m_screenNear) * scale);
+}
@@ -0,0 +1,69 @@
+#pragma once
+#include <DirectXMath.h>
+#include "LightCulling.h"
+using namespace DirectX;
+
+// Has to match Shaders/forward_plus.hlsli.
+#define LIGHT_CLUSTER_TILE_SIZE 64
+#define LIGHT_CLUSTER_SLICES 16
+#define LIGHT_CLUSTER_MAX_INDICES (256 * 1024)
+
+// Assigns point lights to clusters, screen tiles split into exponentially growing depth slices, so deep
+// scenes do not pile every light along a tile's depth range into one list. The result is a compact index
+// list together with an (offset, count) pair for every cluster. Bounds of four lights at a time are
+// computed with SSE. Only uses memory so it runs without a device.
+class LightClusterBuilder
+{
+private:
+	int m_screenWidth, m_screenHeight;
+	int m_tilesX, m_tilesY;
+	int m_clusterCount;
+	float m_screenNear, m_screenDepth;
+	float m_sliceBoundaries[LIGHT_CLUSTER_SLICES + 1];
+
+	int m_maxLights;
+	int* m_minTileX;
+	int* m_maxTileX;
+	int* m_minTileY;
+	int* m_maxTileY;
+	int* m_minSlice;
+	int* m_maxSlice;
+
+	unsigned int* m_clusterRanges;
+	unsigned int* m_clusterCursors;
+	unsigned int* m_lightIndices;
+	int m_lightIndexCount;
+	bool m_overflow;
+	int m_droppedIndexCount;
+
+	void ComputeBounds(const PointLight* lights, int first, const XMFLOAT4X4& view, const XMFLOAT4X4& projection);
+	void ComputeBoundsSSE(const PointLight* lights, int first, const XMFLOAT4X4& view, const XMFLOAT4X4& projection);
+	int ComputeSlice(float depth);
+public:
+	LightClusterBuilder();
+	LightClusterBuilder(const LightClusterBuilder&);
+	~LightClusterBuilder();
+
+	bool Initialize(int screenWidth, int screenHeight, float screenNear, float screenDepth, int maxLights);
+	void Shutdown();
+
+	// Lights beyond the count given to Initialize are ignored.
+	void Build(const PointLight* lights, int lightCount, CXMMATRIX viewMatrix, CXMMATRIX projectionMatrix);
+
+	int GetTilesX();
+	int GetTilesY();
+	int GetClusterCount();
+
+	// Two values per cluster, the offset into the light index list and the number of lights.
+	const unsigned int* GetClusterRanges();
+	const unsigned int* GetLightIndices();
+	int GetLightIndexCount();
+
+	// True when the last build had more cluster entries than LIGHT_CLUSTER_MAX_INDICES, the rest were dropped.
+	bool HasOverflowed();
+	// Cluster entries the last build dropped, the renderer reports them in the stats.
+	int GetDroppedIndexCount();
+
+	// (scale, bias) so that slice = floor(log2(viewDepth) * scale + bias), used by the pixel shader.
+	XMFLOAT2 GetSliceParameters();
+};
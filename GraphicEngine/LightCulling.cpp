@@ -0,0 +1,156 @@
+#include "LightCulling.h"
+
+#include <math.h>
+
+static float ViewDepth(float depth, const XMFLOAT4& projection)
+{
+	// Inverse of depth = _33 + _43 / z.
+	return projection.w / (depth - projection.z);
+}
+
+static bool SphereInTile(const XMFLOAT3& center, float radius, const XMFLOAT3* planes, float minDepth, float maxDepth)
+{
+	int i;
+
+	if (center.z + radius < minDepth || center.z - radius > maxDepth)
+	{
+		return false;
+	}
+
+	// The side planes go through the camera so only the normal is needed.
+	for (i = 0; i < 4; i++)
+	{
+		if (planes[i].x * center.x + planes[i].y * center.y + planes[i].z * center.z < -radius)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static void BuildTilePlanes(int tileX, int tileY, int width, int height, const XMFLOAT4& projection, XMFLOAT3* planes)
+{
+	float left, right, top, bottom, length;
+	int i;
+
+	// Edges of the tile in normalized device coordinates.
+	left = (float)(tileX * LIGHT_TILE_SIZE) / (float)width * 2.0f - 1.0f;
+	right = (float)((tileX + 1) * LIGHT_TILE_SIZE) / (float)width * 2.0f - 1.0f;
+	top = 1.0f - (float)(tileY * LIGHT_TILE_SIZE) / (float)height * 2.0f;
+	bottom = 1.0f - (float)((tileY + 1) * LIGHT_TILE_SIZE) / (float)height * 2.0f;
+
+	// A view space point is inside when _11 * x / z lies between left and right, same for y.
+	planes[0] = XMFLOAT3(projection.x, 0.0f, -left);
+	planes[1] = XMFLOAT3(-projection.x, 0.0f, right);
+	planes[2] = XMFLOAT3(0.0f, projection.y, -bottom);
+	planes[3] = XMFLOAT3(0.0f, -projection.y, top);
+
+	for (i = 0; i < 4; i++)
+	{
+		length = sqrtf(planes[i].x * planes[i].x + planes[i].y * planes[i].y + planes[i].z * planes[i].z);
+		planes[i].x /= length;
+		planes[i].y /= length;
+		planes[i].z /= length;
+	}
+}
+
+int GetLightTileCount(int pixels)
+{
+	return (pixels + LIGHT_TILE_SIZE - 1) / LIGHT_TILE_SIZE;
+}
+
+XMFLOAT4 GetLightTileProjection(CXMMATRIX projectionMatrix)
+{
+	XMFLOAT4X4 projection;
+
+	XMStoreFloat4x4(&projection, projectionMatrix);
+
+	return XMFLOAT4(projection._11, projection._22, projection._33, projection._43);
+}
+
+void ComputeTileDepthBounds(const float* depth, int width, int height, float* tileMinDepth, float* tileMaxDepth)
+{
+	int tilesX, tilesY, tile, x, y;
+	float value;
+
+	tilesX = GetLightTileCount(width);
+	tilesY = GetLightTileCount(height);
+
+	for (tile = 0; tile < tilesX * tilesY; tile++)
+	{
+		tileMinDepth[tile] = 1.0f;
+		tileMaxDepth[tile] = 0.0f;
+	}
+
+	for (y = 0; y < height; y++)
+	{
+		for (x = 0; x < width; x++)
+		{
+			tile = (y / LIGHT_TILE_SIZE) * tilesX + x / LIGHT_TILE_SIZE;
+			value = depth[y * width + x];
+
+			if (value < tileMinDepth[tile])
+			{
+				tileMinDepth[tile] = value;
+			}
+			if (value > tileMaxDepth[tile])
+			{
+				tileMaxDepth[tile] = value;
+			}
+		}
+	}
+}
+
+void BinLightsToTiles(const PointLight* lights, int lightCount, CXMMATRIX viewMatrix, const XMFLOAT4& projection,
+	const float* tileMinDepth, const float* tileMaxDepth, int width, int height, unsigned int* tileLightIndices)
+{
+	XMFLOAT3* centers;
+	XMFLOAT3 planes[4];
+	unsigned int* tileLights;
+	unsigned int count;
+	float minDepth, maxDepth;
+	int tilesX, tilesY, tileX, tileY, i;
+
+	if (lightCount > LIGHT_MAX_LIGHTS)
+	{
+		lightCount = LIGHT_MAX_LIGHTS;
+	}
+
+	// Move the light centers to view space once instead of once per tile.
+	centers = new XMFLOAT3[lightCount > 0 ? lightCount : 1];
+	for (i = 0; i < lightCount; i++)
+	{
+		XMStoreFloat3(&centers[i], XMVector3TransformCoord(XMLoadFloat3(&lights[i].position), viewMatrix));
+	}
+
+	tilesX = GetLightTileCount(width);
+	tilesY = GetLightTileCount(height);
+
+	for (tileY = 0; tileY < tilesY; tileY++)
+	{
+		for (tileX = 0; tileX < tilesX; tileX++)
+		{
+			BuildTilePlanes(tileX, tileY, width, height, projection, planes);
+
+			minDepth = ViewDepth(tileMinDepth[tileY * tilesX + tileX], projection);
+			maxDepth = ViewDepth(tileMaxDepth[tileY * tilesX + tileX], projection);
+
+			tileLights = tileLightIndices + (tileY * tilesX + tileX) * LIGHT_TILE_STRIDE;
+			count = 0;
+
+			for (i = 0; i < lightCount && count < LIGHT_MAX_PER_TILE; i++)
+			{
+				if (SphereInTile(centers[i], lights[i].range, planes, minDepth, maxDepth))
+				{
+					tileLights[1 + count] = i;
+					count++;
+				}
+			}
+
+			tileLights[0] = count;
+		}
+	}
+
+	delete[] centers;
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include <DirectXMath.h>
+using namespace DirectX;
+
+// Has to match Shaders/forward_plus.hlsli.
+#define LIGHT_TILE_SIZE 16
+#define LIGHT_MAX_LIGHTS 1024
+#define LIGHT_MAX_PER_TILE 255
+
+// Every tile owns a block of LIGHT_TILE_STRIDE indices, the light count first and then the light indices.
+#define LIGHT_TILE_STRIDE (LIGHT_MAX_PER_TILE + 1)
+
+// Cone cosine of lights that shine in every direction.
+#define LIGHT_POINT_SPOT_COSINE -1.0f
+
+// Layout of one light in the gpu light buffer, 48 bytes. Spot lights use the same layout with a cone
+// around direction and are culled by their range sphere like point lights.
+struct PointLight
+{
+	XMFLOAT3 position;
+	float range;
+	XMFLOAT3 color;
+	float intensity;
+	XMFLOAT3 direction;
+	float spotCosine;
+};
+
+int GetLightTileCount(int pixels);
+
+// The projection terms the tile tests need, (_11, _22, _33, _43) of a perspective projection.
+XMFLOAT4 GetLightTileProjection(CXMMATRIX projectionMatrix);
+
+// Reduces a depth buffer of width * height values to the min and max depth of every tile.
+void ComputeTileDepthBounds(const float* depth, int width, int height, float* tileMinDepth, float* tileMaxDepth);
+
+// Reference version of light_cull_cs.hlsl. Fills tileLightIndices the same way as the compute shader,
+// with the difference that the indices of a tile are in ascending order here while the compute shader
+// writes them in whatever order its threads finish. When more than LIGHT_MAX_PER_TILE lights touch a tile
+// both keep that many, but not necessarily the same ones.
+void BinLightsToTiles(const PointLight* lights, int lightCount, CXMMATRIX viewMatrix, const XMFLOAT4& projection,
+	const float* tileMinDepth, const float* tileMaxDepth, int width, int height, unsigned int* tileLightIndices);
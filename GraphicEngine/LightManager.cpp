@@ -0,0 +1,299 @@
+#include "LightManager.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+LightManager::LightManager()
+{
+	m_lights = 0;
+	m_handleToIndex = 0;
+	m_indexToHandle = 0;
+	m_freeHandles = 0;
+	m_maxLights = 0;
+	m_lightCount = 0;
+	m_freeHandleCount = 0;
+	m_dirtyFirst = 0;
+	m_dirtyLast = -1;
+}
+
+LightManager::LightManager(const LightManager & other)
+{
+}
+
+LightManager::~LightManager()
+{
+}
+
+bool LightManager::Initialize(int maxLights)
+{
+	m_maxLights = maxLights;
+
+	// Create the packed light list.
+	m_lights = new PointLight[maxLights];
+	if (!m_lights)
+	{
+		return false;
+	}
+
+	// Create the tables that map handles to list positions and back.
+	m_handleToIndex = new int[maxLights];
+	if (!m_handleToIndex)
+	{
+		return false;
+	}
+
+	m_indexToHandle = new int[maxLights];
+	if (!m_indexToHandle)
+	{
+		return false;
+	}
+
+	m_freeHandles = new int[maxLights];
+	if (!m_freeHandles)
+	{
+		return false;
+	}
+
+	Clear();
+
+	return true;
+}
+
+void LightManager::Shutdown()
+{
+	// Release the handle tables.
+	if (m_freeHandles)
+	{
+		delete[] m_freeHandles;
+		m_freeHandles = 0;
+	}
+
+	if (m_indexToHandle)
+	{
+		delete[] m_indexToHandle;
+		m_indexToHandle = 0;
+	}
+
+	if (m_handleToIndex)
+	{
+		delete[] m_handleToIndex;
+		m_handleToIndex = 0;
+	}
+
+	// Release the light list.
+	if (m_lights)
+	{
+		delete[] m_lights;
+		m_lights = 0;
+	}
+
+	m_maxLights = 0;
+	m_lightCount = 0;
+	m_freeHandleCount = 0;
+}
+
+void LightManager::MarkDirty(int index)
+{
+	if (index < m_dirtyFirst)
+	{
+		m_dirtyFirst = index;
+	}
+
+	if (index > m_dirtyLast)
+	{
+		m_dirtyLast = index;
+	}
+}
+
+int LightManager::AddLight(const PointLight & light)
+{
+	int handle;
+
+	if (m_freeHandleCount == 0)
+	{
+		return LIGHT_INVALID_HANDLE;
+	}
+
+	// New lights always go to the end of the list.
+	handle = m_freeHandles[--m_freeHandleCount];
+
+	m_lights[m_lightCount] = light;
+	m_handleToIndex[handle] = m_lightCount;
+	m_indexToHandle[m_lightCount] = handle;
+
+	MarkDirty(m_lightCount);
+	m_lightCount++;
+
+	return handle;
+}
+
+int LightManager::AddPointLight(XMFLOAT3 position, float range, XMFLOAT3 color, float intensity)
+{
+	PointLight light;
+
+	light.position = position;
+	light.range = range;
+	light.color = color;
+	light.intensity = intensity;
+	light.direction = XMFLOAT3(0.0f, 0.0f, 1.0f);
+	light.spotCosine = LIGHT_POINT_SPOT_COSINE;
+
+	return AddLight(light);
+}
+
+int LightManager::AddSpotLight(XMFLOAT3 position, XMFLOAT3 direction, float range, float coneAngle, XMFLOAT3 color, float intensity)
+{
+	PointLight light;
+
+	light.position = position;
+	light.range = range;
+	light.color = color;
+	light.intensity = intensity;
+	XMStoreFloat3(&light.direction, XMVector3Normalize(XMLoadFloat3(&direction)));
+	light.spotCosine = cosf(coneAngle * 0.5f);
+
+	return AddLight(light);
+}
+
+bool LightManager::AddRandomLights(int lightCount)
+{
+	XMFLOAT3 position, color;
+	float range;
+	int i, handle;
+
+	for (i = 0; i < lightCount; i++)
+	{
+		position.x = (((float)rand() - (float)rand()) / RAND_MAX) * 10.0f;
+		position.y = (((float)rand() - (float)rand()) / RAND_MAX) * 10.0f;
+		position.z = ((((float)rand() - (float)rand()) / RAND_MAX) * 10.0f) + 5.0f;
+		range = 1.5f + ((float)rand() / RAND_MAX) * 2.5f;
+
+		color.x = (float)rand() / RAND_MAX;
+		color.y = (float)rand() / RAND_MAX;
+		color.z = (float)rand() / RAND_MAX;
+
+		if (i % 4 == 0)
+		{
+			handle = AddSpotLight(position, XMFLOAT3(0.0f, -1.0f, 0.0f), range * 2.0f, XM_PIDIV4, color, 1.0f);
+		}
+		else
+		{
+			handle = AddPointLight(position, range, color, 1.0f);
+		}
+
+		if (handle == LIGHT_INVALID_HANDLE)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void LightManager::RemoveLight(int handle)
+{
+	int index, last;
+
+	if (handle < 0 || handle >= m_maxLights || m_handleToIndex[handle] < 0)
+	{
+		return;
+	}
+
+	index = m_handleToIndex[handle];
+	last = m_lightCount - 1;
+
+	// Fill the hole with the last light, the buffer past the new count is never read so only the hole is dirty.
+	if (index != last)
+	{
+		m_lights[index] = m_lights[last];
+		m_indexToHandle[index] = m_indexToHandle[last];
+		m_handleToIndex[m_indexToHandle[index]] = index;
+
+		MarkDirty(index);
+	}
+
+	m_handleToIndex[handle] = -1;
+	m_freeHandles[m_freeHandleCount++] = handle;
+	m_lightCount--;
+
+	if (m_dirtyLast >= m_lightCount)
+	{
+		m_dirtyLast = m_lightCount - 1;
+	}
+}
+
+void LightManager::Clear()
+{
+	int i;
+
+	// Hand out the low handles first.
+	for (i = 0; i < m_maxLights; i++)
+	{
+		m_handleToIndex[i] = -1;
+		m_freeHandles[i] = m_maxLights - 1 - i;
+	}
+
+	m_freeHandleCount = m_maxLights;
+	m_lightCount = 0;
+
+	ClearDirtyRange();
+}
+
+void LightManager::SetPosition(int handle, XMFLOAT3 position)
+{
+	m_lights[m_handleToIndex[handle]].position = position;
+	MarkDirty(m_handleToIndex[handle]);
+}
+
+void LightManager::SetDirection(int handle, XMFLOAT3 direction)
+{
+	XMStoreFloat3(&m_lights[m_handleToIndex[handle]].direction, XMVector3Normalize(XMLoadFloat3(&direction)));
+	MarkDirty(m_handleToIndex[handle]);
+}
+
+void LightManager::SetRange(int handle, float range)
+{
+	m_lights[m_handleToIndex[handle]].range = range;
+	MarkDirty(m_handleToIndex[handle]);
+}
+
+void LightManager::SetColor(int handle, XMFLOAT3 color, float intensity)
+{
+	m_lights[m_handleToIndex[handle]].color = color;
+	m_lights[m_handleToIndex[handle]].intensity = intensity;
+	MarkDirty(m_handleToIndex[handle]);
+}
+
+const PointLight * LightManager::GetLights()
+{
+	return m_lights;
+}
+
+int LightManager::GetLightCount()
+{
+	return m_lightCount;
+}
+
+int LightManager::GetMaxLights()
+{
+	return m_maxLights;
+}
+
+bool LightManager::GetDirtyRange(int & first, int & count)
+{
+	if (m_dirtyLast < m_dirtyFirst)
+	{
+		return false;
+	}
+
+	first = m_dirtyFirst;
+	count = m_dirtyLast - m_dirtyFirst + 1;
+
+	return true;
+}
+
+void LightManager::ClearDirtyRange()
+{
+	m_dirtyFirst = m_maxLights;
+	m_dirtyLast = -1;
+}
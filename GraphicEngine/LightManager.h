@@ -0,0 +1,57 @@
+#pragma once
+#include <DirectXMath.h>
+#include "LightCulling.h"
+using namespace DirectX;
+
+#define LIGHT_INVALID_HANDLE -1
+
+// Owns the point and spot lights of a scene. The lights are kept tightly packed in the layout of the
+// gpu light buffer, handles stay valid while lights are removed and moved around inside the list.
+// Every change widens one dirty range, so only that part of the buffer has to be uploaded again.
+class LightManager
+{
+private:
+	PointLight* m_lights;
+	int* m_handleToIndex;
+	int* m_indexToHandle;
+	int* m_freeHandles;
+	int m_maxLights;
+	int m_lightCount;
+	int m_freeHandleCount;
+	int m_dirtyFirst;
+	int m_dirtyLast;
+
+	int AddLight(const PointLight& light);
+	void MarkDirty(int index);
+public:
+	LightManager();
+	LightManager(const LightManager&);
+	~LightManager();
+
+	bool Initialize(int maxLights);
+	void Shutdown();
+
+	// Both return LIGHT_INVALID_HANDLE when the list is full.
+	int AddPointLight(XMFLOAT3 position, float range, XMFLOAT3 color, float intensity);
+	int AddSpotLight(XMFLOAT3 position, XMFLOAT3 direction, float range, float coneAngle, XMFLOAT3 color, float intensity);
+	// Scatters lights of random colors through the volume of the random model list, every fourth one a spot light
+	// shining down into it. Returns false when the list fills up before all of them were added.
+	bool AddRandomLights(int lightCount);
+
+	// Moves the last light into the freed slot, so removing is constant time.
+	void RemoveLight(int handle);
+	void Clear();
+
+	void SetPosition(int handle, XMFLOAT3 position);
+	void SetDirection(int handle, XMFLOAT3 direction);
+	void SetRange(int handle, float range);
+	void SetColor(int handle, XMFLOAT3 color, float intensity);
+
+	const PointLight* GetLights();
+	int GetLightCount();
+	int GetMaxLights();
+
+	// The lights [first, first + count) changed since the last upload, false when nothing did.
+	bool GetDirtyRange(int& first, int& count);
+	void ClearDirtyRange();
+};
@@ -10,15 +10,20 @@ bool LightShader::InitializeShader(ID3D11Device * device, HWND hwnd, WCHAR * vsF
 	D3D11_INPUT_ELEMENT_DESC polygonLayout[3];
 	unsigned int numElements;
 	D3D11_SAMPLER_DESC samplerDesc;
-	D3D11_BUFFER_DESC matrixBufferDesc;
-	D3D11_BUFFER_DESC cameraBufferDesc;
+	D3D11_BUFFER_DESC frameBufferDesc;
 	D3D11_BUFFER_DESC lightBufferDesc;
+	D3D_SHADER_MACRO clusteredDefines[2];
 
 	//Initialize the pointers this function will use to null
 	errorMessage = 0;
 	vertexShaderBuffer = 0;
 	pixelShaderBuffer = 0;
 
+	clusteredDefines[0].Name = "CLUSTERED";
+	clusteredDefines[0].Definition = "1";
+	clusteredDefines[1].Name = NULL;
+	clusteredDefines[1].Definition = NULL;
+
 	// Compile the vertex shader code.
 	result = D3DCompileFromFile(vsFilename, NULL, NULL, "LightVertexShader", "vs_5_0", D3D10_SHADER_ENABLE_STRICTNESS, 0,
 		&vertexShaderBuffer, &errorMessage);
@@ -39,7 +44,7 @@ bool LightShader::InitializeShader(ID3D11Device * device, HWND hwnd, WCHAR * vsF
 	}
 
 	// Compile the pixel shader code.
-	result = D3DCompileFromFile(psFilename, NULL, NULL, "LightPixelShader", "ps_5_0", D3D10_SHADER_ENABLE_STRICTNESS, 0,
+	result = D3DCompileFromFile(psFilename, NULL, D3D_COMPILE_STANDARD_FILE_INCLUDE, "LightPixelShader", "ps_5_0", D3D10_SHADER_ENABLE_STRICTNESS, 0,
 		&pixelShaderBuffer, &errorMessage);
 	if (FAILED(result))
 	{
@@ -71,6 +76,32 @@ bool LightShader::InitializeShader(ID3D11Device * device, HWND hwnd, WCHAR * vsF
 		return false;
 	}
 
+	pixelShaderBuffer->Release();
+	pixelShaderBuffer = 0;
+
+	// Compile the pixel shader a second time, reading the point lights from the cluster lists instead of the tile lists.
+	result = D3DCompileFromFile(psFilename, clusteredDefines, D3D_COMPILE_STANDARD_FILE_INCLUDE, "LightPixelShader", "ps_5_0", D3D10_SHADER_ENABLE_STRICTNESS, 0,
+		&pixelShaderBuffer, &errorMessage);
+	if (FAILED(result))
+	{
+		if (errorMessage)
+		{
+			OutputShaderErrorMessage(errorMessage, hwnd, psFilename);
+		}
+		else
+		{
+			MessageBox(hwnd, psFilename, L"Missing Shader File", MB_OK);
+		}
+
+		return false;
+	}
+
+	result = device->CreatePixelShader(pixelShaderBuffer->GetBufferPointer(), pixelShaderBuffer->GetBufferSize(), NULL, &m_clusteredPixelShader);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
 	//Create the vertex input layout description
 	polygonLayout[0].SemanticName = "POSITION";
 	polygonLayout[0].SemanticIndex = 0;
@@ -129,31 +160,16 @@ bool LightShader::InitializeShader(ID3D11Device * device, HWND hwnd, WCHAR * vsF
 	samplerDesc.MinLOD = 0;
 	samplerDesc.MaxLOD = D3D11_FLOAT32_MAX;
 
-	// Setup the description of the dynamic matrix constant buffer that is in the vertex shader.
-	matrixBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
-	matrixBufferDesc.ByteWidth = sizeof(MatrixBufferType);
-	matrixBufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
-	matrixBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-	matrixBufferDesc.MiscFlags = 0;
-	matrixBufferDesc.StructureByteStride = 0;
+	// Setup the description of the per frame constant buffer that is in the vertex shader.
+	frameBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+	frameBufferDesc.ByteWidth = sizeof(FrameBufferType);
+	frameBufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+	frameBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+	frameBufferDesc.MiscFlags = 0;
+	frameBufferDesc.StructureByteStride = 0;
 
 	// Create the constant buffer pointer so we can access the vertex shader constant buffer from within this class.
-	result = device->CreateBuffer(&matrixBufferDesc, NULL, &m_matrixBuffer);
-	if (FAILED(result))
-	{
-		return false;
-	}
-
-	// Setup the description of the camera dynamic constant buffer that is in the vertex shader.
-	cameraBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
-	cameraBufferDesc.ByteWidth = sizeof(CameraBufferType);
-	cameraBufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
-	cameraBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-	cameraBufferDesc.MiscFlags = 0;
-	cameraBufferDesc.StructureByteStride = 0;
-
-	// Create the camera constant buffer pointer so we can access the vertex shader constant buffer from within this class.
-	result = device->CreateBuffer(&cameraBufferDesc, NULL, &m_cameraBuffer);
+	result = device->CreateBuffer(&frameBufferDesc, NULL, &m_frameBuffer);
 	if (FAILED(result))
 	{
 		return false;
@@ -177,14 +193,256 @@ bool LightShader::InitializeShader(ID3D11Device * device, HWND hwnd, WCHAR * vsF
 	return true;
 }
 
+bool LightShader::InitializeInstancedShader(ID3D11Device * device, HWND hwnd, WCHAR * vsFilename, int maxInstances)
+{
+	HRESULT result;
+	ID3D10Blob* errorMessage;
+	ID3D10Blob* vertexShaderBuffer;
+	D3D11_INPUT_ELEMENT_DESC polygonLayout[8];
+	D3D11_BUFFER_DESC instanceBufferDesc;
+	unsigned int numElements, i;
+
+	//Initialize the pointers this function will use to null
+	errorMessage = 0;
+	vertexShaderBuffer = 0;
+
+	// Compile the instanced vertex shader code, it shares the pixel shader with the single draws.
+	result = D3DCompileFromFile(vsFilename, NULL, NULL, "LightVertexShader", "vs_5_0", D3D10_SHADER_ENABLE_STRICTNESS, 0,
+		&vertexShaderBuffer, &errorMessage);
+	if (FAILED(result))
+	{
+		if (errorMessage)
+		{
+			OutputShaderErrorMessage(errorMessage, hwnd, vsFilename);
+		}
+		else
+		{
+			MessageBox(hwnd, vsFilename, L"Missing Shader File", MB_OK);
+		}
+
+		return false;
+	}
+
+	// Create the vertex shader from the buffer.
+	result = device->CreateVertexShader(vertexShaderBuffer->GetBufferPointer(), vertexShaderBuffer->GetBufferSize(), NULL, &m_instancedVertexShader);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	//The per vertex part of the layout is the same as for single draws
+	polygonLayout[0].SemanticName = "POSITION";
+	polygonLayout[0].Format = DXGI_FORMAT_R32G32B32_FLOAT;
+	polygonLayout[1].SemanticName = "TEXCOORD";
+	polygonLayout[1].Format = DXGI_FORMAT_R32G32_FLOAT;
+	polygonLayout[2].SemanticName = "NORMAL";
+	polygonLayout[2].Format = DXGI_FORMAT_R32G32B32_FLOAT;
+
+	for (i = 0; i < 3; i++)
+	{
+		polygonLayout[i].SemanticIndex = 0;
+		polygonLayout[i].InputSlot = 0;
+		polygonLayout[i].AlignedByteOffset = i == 0 ? 0 : D3D11_APPEND_ALIGNED_ELEMENT;
+		polygonLayout[i].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
+		polygonLayout[i].InstanceDataStepRate = 0;
+	}
+
+	//The world matrix rows and the color come from the instance buffer in the second slot
+	for (i = 3; i < 8; i++)
+	{
+		polygonLayout[i].SemanticName = i < 7 ? "WORLD" : "COLOR";
+		polygonLayout[i].SemanticIndex = i < 7 ? i - 3 : 0;
+		polygonLayout[i].Format = DXGI_FORMAT_R32G32B32A32_FLOAT;
+		polygonLayout[i].InputSlot = 1;
+		polygonLayout[i].AlignedByteOffset = i == 3 ? 0 : D3D11_APPEND_ALIGNED_ELEMENT;
+		polygonLayout[i].InputSlotClass = D3D11_INPUT_PER_INSTANCE_DATA;
+		polygonLayout[i].InstanceDataStepRate = 1;
+	}
+
+	// Get a count of the elements in the layout.
+	numElements = sizeof(polygonLayout) / sizeof(polygonLayout[0]);
+
+	// Create the instanced vertex input layout.
+	result = device->CreateInputLayout(polygonLayout, numElements, vertexShaderBuffer->GetBufferPointer(), vertexShaderBuffer->GetBufferSize(),
+		&m_instancedLayout);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	//Release the vertex shader buffer since it is no longer needed.
+	vertexShaderBuffer->Release();
+	vertexShaderBuffer = 0;
+
+	// Setup the description of the dynamic instance buffer, it is rewritten every frame.
+	instanceBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+	instanceBufferDesc.ByteWidth = sizeof(InstanceData) * maxInstances;
+	instanceBufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+	instanceBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+	instanceBufferDesc.MiscFlags = 0;
+	instanceBufferDesc.StructureByteStride = 0;
+
+	// Create the instance buffer.
+	result = device->CreateBuffer(&instanceBufferDesc, NULL, &m_instanceBuffer);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	m_maxInstances = maxInstances;
+
+	return true;
+}
+
+bool LightShader::InitializeDepthShader(ID3D11Device * device, HWND hwnd, WCHAR * vsFilename)
+{
+	HRESULT result;
+	ID3D10Blob* errorMessage;
+	ID3D10Blob* vertexShaderBuffer;
+	ID3D10Blob* instancedShaderBuffer;
+	D3D11_INPUT_ELEMENT_DESC polygonLayout[5];
+	unsigned int i;
+
+	//Initialize the pointers this function will use to null
+	errorMessage = 0;
+	vertexShaderBuffer = 0;
+	instancedShaderBuffer = 0;
+
+	// Compile both depth only vertex shaders, the depth pass has no pixel shader.
+	result = D3DCompileFromFile(vsFilename, NULL, NULL, "DepthVertexShader", "vs_5_0", D3D10_SHADER_ENABLE_STRICTNESS, 0,
+		&vertexShaderBuffer, &errorMessage);
+	if (SUCCEEDED(result))
+	{
+		result = D3DCompileFromFile(vsFilename, NULL, NULL, "DepthInstancedVertexShader", "vs_5_0", D3D10_SHADER_ENABLE_STRICTNESS, 0,
+			&instancedShaderBuffer, &errorMessage);
+	}
+	if (FAILED(result))
+	{
+		if (errorMessage)
+		{
+			OutputShaderErrorMessage(errorMessage, hwnd, vsFilename);
+		}
+		else
+		{
+			MessageBox(hwnd, vsFilename, L"Missing Shader File", MB_OK);
+		}
+
+		return false;
+	}
+
+	// Create the vertex shaders from the buffers.
+	result = device->CreateVertexShader(vertexShaderBuffer->GetBufferPointer(), vertexShaderBuffer->GetBufferSize(), NULL, &m_depthVertexShader);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	result = device->CreateVertexShader(instancedShaderBuffer->GetBufferPointer(), instancedShaderBuffer->GetBufferSize(), NULL,
+		&m_depthInstancedVertexShader);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	//Only the position is read, from the position stream of the model
+	polygonLayout[0].SemanticName = "POSITION";
+	polygonLayout[0].SemanticIndex = 0;
+	polygonLayout[0].Format = DXGI_FORMAT_R32G32B32_FLOAT;
+	polygonLayout[0].InputSlot = 0;
+	polygonLayout[0].AlignedByteOffset = 0;
+	polygonLayout[0].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
+	polygonLayout[0].InstanceDataStepRate = 0;
+
+	// Create the single draw depth layout.
+	result = device->CreateInputLayout(polygonLayout, 1, vertexShaderBuffer->GetBufferPointer(), vertexShaderBuffer->GetBufferSize(),
+		&m_depthLayout);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	//The world matrix rows come from the instance buffer in the second slot, the color behind them is skipped
+	for (i = 1; i < 5; i++)
+	{
+		polygonLayout[i].SemanticName = "WORLD";
+		polygonLayout[i].SemanticIndex = i - 1;
+		polygonLayout[i].Format = DXGI_FORMAT_R32G32B32A32_FLOAT;
+		polygonLayout[i].InputSlot = 1;
+		polygonLayout[i].AlignedByteOffset = i == 1 ? 0 : D3D11_APPEND_ALIGNED_ELEMENT;
+		polygonLayout[i].InputSlotClass = D3D11_INPUT_PER_INSTANCE_DATA;
+		polygonLayout[i].InstanceDataStepRate = 1;
+	}
+
+	// Create the instanced depth layout.
+	result = device->CreateInputLayout(polygonLayout, 5, instancedShaderBuffer->GetBufferPointer(), instancedShaderBuffer->GetBufferSize(),
+		&m_depthInstancedLayout);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	//Release the vertex shader buffers since they are no longer needed.
+	vertexShaderBuffer->Release();
+	vertexShaderBuffer = 0;
+
+	instancedShaderBuffer->Release();
+	instancedShaderBuffer = 0;
+
+	return true;
+}
+
 void LightShader::ShutdownShader()
 {
-	// Release the camera constant buffer.
-	if (m_cameraBuffer)
+	// Release the depth only layouts and vertex shaders.
+	if (m_depthInstancedLayout)
+	{
+		m_depthInstancedLayout->Release();
+		m_depthInstancedLayout = 0;
+	}
+
+	if (m_depthLayout)
+	{
+		m_depthLayout->Release();
+		m_depthLayout = 0;
+	}
+
+	if (m_depthInstancedVertexShader)
+	{
+		m_depthInstancedVertexShader->Release();
+		m_depthInstancedVertexShader = 0;
+	}
+
+	if (m_depthVertexShader)
 	{
-		m_cameraBuffer->Release();
-		m_cameraBuffer = 0;
+		m_depthVertexShader->Release();
+		m_depthVertexShader = 0;
 	}
+
+	// Release the instance buffer.
+	if (m_instanceBuffer)
+	{
+		m_instanceBuffer->Release();
+		m_instanceBuffer = 0;
+	}
+
+	// Release the instanced layout.
+	if (m_instancedLayout)
+	{
+		m_instancedLayout->Release();
+		m_instancedLayout = 0;
+	}
+
+	// Release the instanced vertex shader.
+	if (m_instancedVertexShader)
+	{
+		m_instancedVertexShader->Release();
+		m_instancedVertexShader = 0;
+	m_depthVertexShader = 0;
+	m_depthInstancedVertexShader = 0;
+	m_depthLayout = 0;
+	m_depthInstancedLayout = 0;
+	}
+
 	// Release the light constant buffer.
 	if (m_lightBuffer)
 	{
@@ -192,11 +450,11 @@ void LightShader::ShutdownShader()
 		m_lightBuffer = 0;
 	}
 
-	// Release the matrix constant buffer.
-	if (m_matrixBuffer)
+	// Release the per frame constant buffer.
+	if (m_frameBuffer)
 	{
-		m_matrixBuffer->Release();
-		m_matrixBuffer = 0;
+		m_frameBuffer->Release();
+		m_frameBuffer = 0;
 	}
 
 	// Release the sampler state.
@@ -214,6 +472,12 @@ void LightShader::ShutdownShader()
 	}
 
 	// Release the pixel shader.
+	if (m_clusteredPixelShader)
+	{
+		m_clusteredPixelShader->Release();
+		m_clusteredPixelShader = 0;
+	}
+
 	if (m_pixelShader)
 	{
 		m_pixelShader->Release();
@@ -261,48 +525,125 @@ void LightShader::OutputShaderErrorMessage(ID3D10Blob * errorMessage, HWND hwnd,
 	MessageBox(hwnd, L"Error compiling shader.  Check shader-error.txt for message.", shaderFilename, MB_OK);
 }
 
-bool LightShader::SetShaderParameters(ID3D11DeviceContext* deviceContext, int indexCount, XMMATRIX worldMatrix, XMMATRIX viewMatrix,
-										XMMATRIX projectionMatrix, ID3D11ShaderResourceView* texture, XMFLOAT3 lightDirection, XMFLOAT4 diffuseColor,
-										XMFLOAT4 ambientColors, XMFLOAT3 cameraPosition, XMFLOAT4 specularColor, float specularPower)
+void LightShader::RenderShader(RenderStateCache * stateCache, int indexCount)
+{
+	//Set the vertex input layout
+	stateCache->SetInputLayout(m_layout);
+
+	//Set the vertex and pixel shaders that will be used to render this triangle
+	stateCache->SetVertexShader(m_vertexShader);
+	stateCache->SetPixelShader(m_clustered ? m_clusteredPixelShader : m_pixelShader);
+
+	//Set the sampler state in the pixel shader
+	stateCache->SetPSSampler(0, m_sampleState);
+
+	//Render the triangle
+	stateCache->DrawIndexed(indexCount, 0, 0);
+}
+
+void LightShader::RenderInstancedShader(RenderStateCache * stateCache, int indexCount, int instanceCount, int startInstance)
+{
+	//Set the instanced vertex input layout
+	stateCache->SetInputLayout(m_instancedLayout);
+
+	//Set the instanced vertex shader and the shared pixel shader of the current light assignment
+	stateCache->SetVertexShader(m_instancedVertexShader);
+	stateCache->SetPixelShader(m_clustered ? m_clusteredPixelShader : m_pixelShader);
+
+	//Set the sampler state in the pixel shader
+	stateCache->SetPSSampler(0, m_sampleState);
+
+	//Render every instance of the range
+	stateCache->DrawIndexedInstanced(indexCount, instanceCount, 0, 0, startInstance);
+}
+
+LightShader::LightShader()
+{
+	m_vertexShader = 0;
+	m_pixelShader = 0;
+	m_clusteredPixelShader = 0;
+	m_clustered = false;
+	m_layout = 0;
+	m_sampleState = 0;
+	m_frameBuffer = 0;
+	m_lightBuffer = 0;
+	m_instancedVertexShader = 0;
+	m_instancedLayout = 0;
+	m_instanceBuffer = 0;
+	m_maxInstances = 0;
+}
+
+LightShader::LightShader(const LightShader & other)
+{
+}
+
+LightShader::~LightShader()
+{
+}
+
+bool LightShader::Initialize(ID3D11Device * device, HWND hwnd, int maxInstances)
+{
+	bool result;
+
+	//Initialize the vertex and pixel shaders.
+	result = InitializeShader(device, hwnd, L"../GraphicEngine/Shaders/light_vs.hlsl", L"../GraphicEngine/Shaders/light_ps.hlsl");
+	if (!result)
+	{
+		return false;
+	}
+
+	//Initialize the instanced vertex shader.
+	result = InitializeInstancedShader(device, hwnd, L"../GraphicEngine/Shaders/light_instanced_vs.hlsl", maxInstances);
+	if (!result)
+	{
+		return false;
+	}
+
+	//Initialize the depth only vertex shaders of the depth pre-pass.
+	result = InitializeDepthShader(device, hwnd, L"../GraphicEngine/Shaders/depth_vs.hlsl");
+	if (!result)
+	{
+		return false;
+	}
+
+	return true;
+}
+
+void LightShader::Shutdown()
+{
+	ShutdownShader();
+}
+
+bool LightShader::SetFrameParameters(RenderStateCache * stateCache, XMMATRIX viewMatrix, XMMATRIX projectionMatrix, XMFLOAT3 cameraPosition,
+	XMFLOAT3 lightDirection, XMFLOAT4 diffuseColor, XMFLOAT4 ambientColors, XMFLOAT4 specularColor, float specularPower)
 {
 	HRESULT result;
+	RenderContext* deviceContext;
 	D3D11_MAPPED_SUBRESOURCE mappedResource;
-	MatrixBufferType* dataPtr;
+	FrameBufferType* dataPtr;
 	LightBufferType* dataPtr2;
-	CameraBufferType* dataPtr3;
-	unsigned int bufferNumber;
 
-	// Transpose the matrices to prepare them for the shader.
-	worldMatrix = XMMatrixTranspose(worldMatrix);
-	viewMatrix = XMMatrixTranspose(viewMatrix);
-	projectionMatrix = XMMatrixTranspose(projectionMatrix);
+	// The per frame constant buffers are still mapped on the context directly.
+	deviceContext = stateCache->GetRenderContext();
 
-	// Lock the constant buffer so it can be written to.
-	result = deviceContext->Map(m_matrixBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
+	// Lock the per frame constant buffer so it can be written to.
+	result = deviceContext->Map(m_frameBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
 	if (FAILED(result))
 	{
 		return false;
 	}
 
-	// Get a pointer to the data in the constant buffer.
-	dataPtr = (MatrixBufferType*)mappedResource.pData;
+	Stats::Add(STAT_CONSTANT_BYTES, sizeof(FrameBufferType));
 
-	// Copy the matrices into the constant buffer.
-	dataPtr->world = worldMatrix;
-	dataPtr->view = viewMatrix;
-	dataPtr->projection = projectionMatrix;
+	// Copy the transposed matrices and the camera position into the constant buffer.
+	dataPtr = (FrameBufferType*)mappedResource.pData;
+	dataPtr->view = XMMatrixTranspose(viewMatrix);
+	dataPtr->projection = XMMatrixTranspose(projectionMatrix);
+	dataPtr->cameraPosition = cameraPosition;
+	dataPtr->padding = 0.0f;
 
 	// Unlock the constant buffer.
-	deviceContext->Unmap(m_matrixBuffer, 0);
-
-	// Set the position of the constant buffer in the vertex shader.
-	bufferNumber = 0;
-
-	// Finanly set the constant buffer in the vertex shader with the updated values.
-	deviceContext->VSSetConstantBuffers(bufferNumber, 1, &m_matrixBuffer);
-
-	//Set shader texture resource in the pixel shader
-	deviceContext->PSSetShaderResources(0, 1, &texture);
+	deviceContext->Unmap(m_frameBuffer, 0);
 
 	//Lock the light constant buffer so it can be written to
 	result = deviceContext->Map(m_lightBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
@@ -311,10 +652,10 @@ bool LightShader::SetShaderParameters(ID3D11DeviceContext* deviceContext, int in
 		return false;
 	}
 
-	//Get a pointer to the data in the constant buffer
-	dataPtr2 = (LightBufferType*)mappedResource.pData;
+	Stats::Add(STAT_CONSTANT_BYTES, sizeof(LightBufferType));
 
 	//Copy the lighting variables into the constant buffer
+	dataPtr2 = (LightBufferType*)mappedResource.pData;
 	dataPtr2->ambioentColor = ambientColors;
 	dataPtr2->diffuseColor = diffuseColor;
 	dataPtr2->lightDirection = lightDirection;
@@ -324,107 +665,121 @@ bool LightShader::SetShaderParameters(ID3D11DeviceContext* deviceContext, int in
 	//Unlock the constant buffer
 	deviceContext->Unmap(m_lightBuffer, 0);
 
-	//Set the positiion of the light constant buffer in the pixel shader
-	bufferNumber = 0;
-
-	//finally set the light constant buffer in the pixel shader with the updated values
-	deviceContext->PSSetConstantBuffers(bufferNumber, 1, &m_lightBuffer);
-
-	//Lock the camera constant buffer so it can be written to
-	result = deviceContext->Map(m_cameraBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
-	if (FAILED(result))
-	{
-		return false;
-	}
-
-	//Get a pointer ot the data in the constant buffer
-	dataPtr3 = (CameraBufferType*)mappedResource.pData;
-
-	//Copy the camera position into the constant buffer
-	dataPtr3->cameraPosition = cameraPosition;
-	dataPtr3->padding = 0.0f;
-
-	//Unlock the camera constant buffer
-	deviceContext->Unmap(m_cameraBuffer, 0);
-
-	//Set the position of the camera constant buffer in the vertex shader
-	bufferNumber = 1;
-
-	//Now set the camera constant buffer in the vertex shader
-	deviceContext->VSSetConstantBuffers(bufferNumber, 1, &m_cameraBuffer);
+	//Both stay bound for the whole frame, the per frame buffer in the first slot of the vertex shader
+	//and the light buffer in the first slot of the pixel shader
+	stateCache->SetVSConstantBuffer(0, m_frameBuffer);
+	stateCache->SetPSConstantBuffer(0, m_lightBuffer);
 
 	return true;
 }
 
-void LightShader::RenderShader(ID3D11DeviceContext * deviceContext, int indexCount)
+void LightShader::BindFrameResources(RenderStateCache * stateCache)
 {
-	//Set the vertex input layout
-	deviceContext->IASetInputLayout(m_layout);
-
-	//Set the vertex and pixel shaders that will be used to render this triangle
-	deviceContext->VSSetShader(m_vertexShader, NULL, 0);
-	deviceContext->PSSetShader(m_pixelShader, NULL, 0);
-
-	//Set the sampler state in the pixel shader
-	deviceContext->PSSetSamplers(0, 1, &m_sampleState);
-
-	//Render the triangle
-	deviceContext->DrawIndexed(indexCount, 0, 0);
+	//The buffers were written on the immediate context, only the bindings are missing
+	stateCache->SetVSConstantBuffer(0, m_frameBuffer);
+	stateCache->SetPSConstantBuffer(0, m_lightBuffer);
+	stateCache->SetVertexBuffer(1, m_instanceBuffer, sizeof(InstanceData), 0);
 }
 
-LightShader::LightShader()
+void LightShader::WriteObjectConstants(void * destination, XMMATRIX worldMatrix, XMFLOAT4 color)
 {
-	m_vertexShader = 0;
-	m_pixelShader = 0;
-	m_layout = 0;
-	m_sampleState = 0;
-	m_matrixBuffer = 0;
-	m_lightBuffer = 0;
-	m_cameraBuffer = 0;
-}
+	ObjectBufferType* dataPtr;
 
-LightShader::LightShader(const LightShader & other)
-{
+	dataPtr = (ObjectBufferType*)destination;
+	dataPtr->world = XMMatrixTranspose(worldMatrix);
+	dataPtr->color = color;
 }
 
-LightShader::~LightShader()
+bool LightShader::Render(RenderStateCache * stateCache, ConstantRing * objectConstants, unsigned int objectOffset, int indexCount,
+	ID3D11ShaderResourceView * texture)
 {
+	bool result;
+
+	//Bind the constants of this object to the second slot of the vertex shader
+	result = objectConstants->BindVS(stateCache, 1, objectOffset, sizeof(ObjectBufferType));
+	if (!result)
+	{
+		return false;
+	}
+
+	//Set shader texture resource in the pixel shader
+	stateCache->SetPSShaderResource(0, texture);
+
+	RenderShader(stateCache, indexCount);
+
+	return true;
 }
 
-bool LightShader::Initialize(ID3D11Device * device, HWND hwnd)
+bool LightShader::RenderDepth(RenderStateCache * stateCache, ConstantRing * objectConstants, unsigned int objectOffset, int indexCount)
 {
 	bool result;
 
-	//Initialize the vertex and pixel shaders.
-	result = InitializeShader(device, hwnd, L"../GraphicEngine/Shaders/light_vs.hlsl", L"../GraphicEngine/Shaders/light_ps.hlsl");
+	result = objectConstants->BindVS(stateCache, 1, objectOffset, sizeof(ObjectBufferType));
 	if (!result)
 	{
 		return false;
 	}
 
+	//Set the position only layout and vertex shader without a pixel shader
+	stateCache->SetInputLayout(m_depthLayout);
+	stateCache->SetVertexShader(m_depthVertexShader);
+	stateCache->SetPixelShader(NULL);
+
+	stateCache->DrawIndexed(indexCount, 0, 0);
+
 	return true;
 }
 
-void LightShader::Shutdown()
+bool LightShader::SetInstances(RenderStateCache * stateCache, const InstanceData * instances, int instanceCount)
 {
-	ShutdownShader();
-}
+	HRESULT result;
+	D3D11_MAPPED_SUBRESOURCE mappedResource;
 
-bool LightShader::Render(ID3D11DeviceContext* deviceContext, int indexCount, XMMATRIX worldMatrix, XMMATRIX viewMatrix,
-						XMMATRIX projectionMatrix, ID3D11ShaderResourceView* texture, XMFLOAT3 lightDirection, XMFLOAT4 diffuseColor, 
-						XMFLOAT4 ambientColors, XMFLOAT3 cameraPosition, XMFLOAT4 specularColor, float specularPower)
-{
-	bool result;
+	if (instanceCount > m_maxInstances)
+	{
+		instanceCount = m_maxInstances;
+	}
 
-	//Set the shader parameters that it will use for rendering.
-	result = SetShaderParameters(deviceContext,	indexCount, worldMatrix, viewMatrix, projectionMatrix, texture, lightDirection, diffuseColor, ambientColors, 
-									cameraPosition, specularColor, specularPower);
-	if (!result)
+	//Lock the instance buffer so it can be written to
+	result = stateCache->GetRenderContext()->Map(m_instanceBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
+	if (FAILED(result))
 	{
 		return false;
 	}
 
-	RenderShader(deviceContext, indexCount);
+	//Copy the instances into the buffer
+	memcpy(mappedResource.pData, instances, sizeof(InstanceData) * instanceCount);
+
+	//Unlock the instance buffer
+	stateCache->GetRenderContext()->Unmap(m_instanceBuffer, 0);
+
+	//Put the instance buffer in the second input slot
+	stateCache->SetVertexBuffer(1, m_instanceBuffer, sizeof(InstanceData), 0);
 
 	return true;
 }
+
+void LightShader::RenderInstanced(RenderStateCache * stateCache, int indexCount, int instanceCount, int startInstance,
+	ID3D11ShaderResourceView * texture)
+{
+	//The per frame constants are already bound and the world matrices come from the instance buffer
+	stateCache->SetPSShaderResource(0, texture);
+
+	RenderInstancedShader(stateCache, indexCount, instanceCount, startInstance);
+}
+
+void LightShader::RenderInstancedDepth(RenderStateCache * stateCache, int indexCount, int instanceCount, int startInstance)
+{
+	//Set the position only instanced layout and vertex shader without a pixel shader
+	stateCache->SetInputLayout(m_depthInstancedLayout);
+	stateCache->SetVertexShader(m_depthInstancedVertexShader);
+	stateCache->SetPixelShader(NULL);
+
+	//Render every instance of the range into the depth buffer
+	stateCache->DrawIndexedInstanced(indexCount, instanceCount, 0, 0, startInstance);
+}
+
+void LightShader::SetClustered(bool clustered)
+{
+	m_clustered = clustered;
+}
@@ -3,21 +3,31 @@
 #include <DirectXMath.h>
 #include <d3dcompiler.h>
 #include <fstream>
+#include "RenderStateCache.h"
+#include "InstanceBatcher.h"
+#include "ConstantRing.h"
 using namespace DirectX;
 using namespace std;
 
+// Constants are split by how often they change. The per frame buffers hold the camera and the directional
+// light and are written once per frame, the texture is the only per material state, and the per object
+// constants of single draws are sub-allocated from a ConstantRing. Instanced draws read their world
+// matrices from the instance buffer instead.
 class LightShader
 {
-private:
-	struct MatrixBufferType
+public:
+	// Layout of the per object constants in the ring.
+	struct ObjectBufferType
 	{
 		XMMATRIX world;
-		XMMATRIX view;
-		XMMATRIX projection;
+		XMFLOAT4 color;
 	};
 
-	struct CameraBufferType
+private:
+	struct FrameBufferType
 	{
+		XMMATRIX view;
+		XMMATRIX projection;
 		XMFLOAT3 cameraPosition;
 		float padding;
 	};
@@ -33,28 +43,64 @@ private:
 
 	ID3D11VertexShader* m_vertexShader;
 	ID3D11PixelShader* m_pixelShader;
+	ID3D11PixelShader* m_clusteredPixelShader;
+	bool m_clustered;
 	ID3D11InputLayout* m_layout;
 	ID3D11SamplerState* m_sampleState;
-	ID3D11Buffer* m_matrixBuffer;
+	ID3D11Buffer* m_frameBuffer;
 	ID3D11Buffer* m_lightBuffer;
-	ID3D11Buffer* m_cameraBuffer;
+
+	ID3D11VertexShader* m_instancedVertexShader;
+	ID3D11InputLayout* m_instancedLayout;
+	ID3D11Buffer* m_instanceBuffer;
+	int m_maxInstances;
+
+	ID3D11VertexShader* m_depthVertexShader;
+	ID3D11VertexShader* m_depthInstancedVertexShader;
+	ID3D11InputLayout* m_depthLayout;
+	ID3D11InputLayout* m_depthInstancedLayout;
 
 	bool InitializeShader(ID3D11Device* device, HWND hwnd, WCHAR* vsFilename, WCHAR* psFilename);
+	bool InitializeInstancedShader(ID3D11Device* device, HWND hwnd, WCHAR* vsFilename, int maxInstances);
+	bool InitializeDepthShader(ID3D11Device* device, HWND hwnd, WCHAR* vsFilename);
 	void ShutdownShader();
 	void OutputShaderErrorMessage(ID3D10Blob* errorMessage, HWND hwnd, WCHAR* shaderFilename);
 
-	bool SetShaderParameters(ID3D11DeviceContext* deviceContext, int indexCount, XMMATRIX worldMatrix, XMMATRIX viewMatrix,
-		XMMATRIX projectionMatrix, ID3D11ShaderResourceView* texture, XMFLOAT3 lightDirection, XMFLOAT4 diffuseColor,
-		XMFLOAT4 ambientColors, XMFLOAT3 cameraPosition, XMFLOAT4 specularColor, float specularPower);
-	void RenderShader(ID3D11DeviceContext* deviceContext, int indexCount);
+	void RenderShader(RenderStateCache* stateCache, int indexCount);
+	void RenderInstancedShader(RenderStateCache* stateCache, int indexCount, int instanceCount, int startInstance);
 public:
 	LightShader();
 	LightShader(const LightShader&);
 	~LightShader();
 
-	bool Initialize(ID3D11Device* device, HWND hwnd);
+	// The instance buffer holds maxInstances instances.
+	bool Initialize(ID3D11Device* device, HWND hwnd, int maxInstances);
 	void Shutdown();
-	bool Render(ID3D11DeviceContext* deviceContext, int indexCount, XMMATRIX worldMatrix, XMMATRIX viewMatrix,
-		XMMATRIX projectionMatrix, ID3D11ShaderResourceView* texture, XMFLOAT3 lightDirection, XMFLOAT4 diffuseColor, 
-		XMFLOAT4 ambientColors, XMFLOAT3 cameraPosition, XMFLOAT4 specularColor, float specularPower);
+
+	// Writes the camera and the directional light, once per frame before any draw.
+	bool SetFrameParameters(RenderStateCache* stateCache, XMMATRIX viewMatrix, XMMATRIX projectionMatrix, XMFLOAT3 cameraPosition,
+		XMFLOAT3 lightDirection, XMFLOAT4 diffuseColor, XMFLOAT4 ambientColors, XMFLOAT4 specularColor, float specularPower);
+
+	// Binds the per frame constants and the instance buffer, for state caches of other contexts.
+	void BindFrameResources(RenderStateCache* stateCache);
+
+	// Fills one ObjectBufferType allocation of the ring.
+	static void WriteObjectConstants(void* destination, XMMATRIX worldMatrix, XMFLOAT4 color);
+
+	// Single draws, the object constants are an allocation of the ring written with WriteObjectConstants.
+	bool Render(RenderStateCache* stateCache, ConstantRing* objectConstants, unsigned int objectOffset, int indexCount,
+		ID3D11ShaderResourceView* texture);
+	// Depth only, the position buffer of the mesh has to be bound instead of its full vertex.
+	bool RenderDepth(RenderStateCache* stateCache, ConstantRing* objectConstants, unsigned int objectOffset, int indexCount);
+
+	// Uploads the instances of a frame, the instanced draws then refer to ranges of this list.
+	bool SetInstances(RenderStateCache* stateCache, const InstanceData* instances, int instanceCount);
+	void RenderInstanced(RenderStateCache* stateCache, int indexCount, int instanceCount, int startInstance,
+		ID3D11ShaderResourceView* texture);
+
+	// Writes only depth from the position stream, used by the depth pre-pass.
+	void RenderInstancedDepth(RenderStateCache* stateCache, int indexCount, int instanceCount, int startInstance);
+
+	// Selects the pixel shader that reads the point lights from the cluster lists instead of the tile lists.
+	void SetClustered(bool clustered);
 };
\ No newline at end of file
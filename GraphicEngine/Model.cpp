@@ -2,11 +2,11 @@
 
 Model::Model()
 {
-	m_modelAsset = 0;
-	m_textureAsset = 0;
+	m_assets = 0;
 	m_positionX = m_positionY = m_positionZ = 0;
 	m_rotationX = m_rotationY = m_rotationZ = 0;
 	m_scaleX = m_scaleY = m_scaleZ = 1;
+	m_worldDirty = true;
 }
 
 Model::~Model()
@@ -15,15 +15,22 @@ Model::~Model()
 
 bool Model::Initialize(Assets* assets, const char* filepath)
 {
+	return Initialize(assets, filepath, "../Data/stone01.tga");
+}
+
+bool Model::Initialize(Assets * assets, const char * filepath, const char * texturePath)
+{
+	m_assets = assets;
+
 	//Set model and texture asset for the model
 	m_modelAsset = assets->load<ModelAsset>(filepath);
-	if (!m_modelAsset)
+	if (!m_modelAsset.IsValid())
 	{
 		return false;
 	}
 
-	m_textureAsset = assets->load<TextureAsset>("../Data/stone01.tga");
-	if (!m_textureAsset)
+	m_textureAsset = assets->load<TextureAsset>(texturePath);
+	if (!m_textureAsset.IsValid())
 	{
 		return false;
 	}
@@ -35,14 +42,24 @@ void Model::Shutdown()
 {
 }
 
-void Model::Render(ID3D11DeviceContext * deviceContext)
+void Model::Render(RenderContext * deviceContext)
 {
-	m_modelAsset->Render(deviceContext);
+	ModelAsset* modelAsset;
+
+	modelAsset = GetModelAsset();
+	if (modelAsset)
+	{
+		modelAsset->Render(deviceContext);
+	}
 }
 
 int Model::GetIndexCount()
 {
-	return m_modelAsset->GetIndexCount();
+	ModelAsset* modelAsset;
+
+	modelAsset = GetModelAsset();
+
+	return modelAsset ? modelAsset->GetIndexCount() : 0;
 }
 
 void Model::SetPosition(float positionX, float positionY, float positionZ)
@@ -50,6 +67,7 @@ void Model::SetPosition(float positionX, float positionY, float positionZ)
 	m_positionX = positionX;
 	m_positionY = positionY;
 	m_positionZ = positionZ;
+	m_worldDirty = true;
 }
 
 void Model::GetPosition(float & positionX, float & positionY, float & positionZ)
@@ -64,6 +82,7 @@ void Model::SetRotation(float rotationX, float rotationY, float rotationZ)
 	m_rotationX = rotationX;
 	m_rotationY = rotationY;
 	m_rotationZ = rotationZ;
+	m_worldDirty = true;
 }
 
 void Model::GetRotation(float & rotationX, float & rotationY, float & rotationZ)
@@ -78,6 +97,7 @@ void Model::SetScale(float scaleX, float scaleY, float scaleZ)
 	m_scaleX = scaleX;
 	m_scaleY = scaleY;
 	m_scaleZ = scaleZ;
+	m_worldDirty = true;
 }
 
 void Model::GetScale(float & scaleX, float & scaleY, float & scaleZ)
@@ -89,10 +109,31 @@ void Model::GetScale(float & scaleX, float & scaleY, float & scaleZ)
 
 XMMATRIX Model::GetWorldMatrix()
 {
-	return XMMatrixScaling(m_scaleX, m_scaleY, m_scaleZ) * XMMatrixRotationRollPitchYaw(m_rotationX, m_rotationY, m_rotationZ) * XMMatrixTranslation(m_positionX, m_positionY, m_positionZ);
+	//Only rebuild the world matrix when the transform has changed since the last call
+	if (m_worldDirty)
+	{
+		XMStoreFloat4x4(&m_worldMatrix, XMMatrixScaling(m_scaleX, m_scaleY, m_scaleZ) * XMMatrixRotationRollPitchYaw(m_rotationX, m_rotationY, m_rotationZ) * XMMatrixTranslation(m_positionX, m_positionY, m_positionZ));
+		m_worldDirty = false;
+	}
+
+	return XMLoadFloat4x4(&m_worldMatrix);
 }
 
 ID3D11ShaderResourceView * Model::GetTexture()
 {
-	return m_textureAsset->GetTexture();
+	TextureAsset* textureAsset;
+
+	textureAsset = GetTextureAsset();
+
+	return textureAsset ? textureAsset->GetTexture() : 0;
+}
+
+ModelAsset * Model::GetModelAsset()
+{
+	return m_assets ? m_assets->get(m_modelAsset) : 0;
+}
+
+TextureAsset * Model::GetTextureAsset()
+{
+	return m_assets ? m_assets->get(m_textureAsset) : 0;
 }
@@ -13,15 +13,21 @@ private:
 	float m_rotationX, m_rotationY, m_rotationZ;
 	float m_scaleX, m_scaleY, m_scaleZ;
 
-	ModelAsset* m_modelAsset;
-	TextureAsset* m_textureAsset;
+	XMFLOAT4X4 m_worldMatrix;
+	bool m_worldDirty;
+
+	//The assets are looked up every time, so an evicted asset is never drawn
+	Assets* m_assets;
+	Handle<ModelAsset> m_modelAsset;
+	Handle<TextureAsset> m_textureAsset;
 public:
 	Model();
 	~Model();
 
 	bool Initialize(Assets* assets, const char* filepath);
+	bool Initialize(Assets* assets, const char* filepath, const char* texturePath);
 	void Shutdown();
-	void Render(ID3D11DeviceContext* deviceContext);
+	void Render(RenderContext* deviceContext);
 
 	int GetIndexCount();
 
@@ -36,6 +42,10 @@ public:
 
 	XMMATRIX GetWorldMatrix();
 	ID3D11ShaderResourceView* GetTexture();
+
+	//Return 0 once the asset was evicted
+	ModelAsset* GetModelAsset();
+	TextureAsset* GetTextureAsset();
 private:
 
 };
\ No newline at end of file
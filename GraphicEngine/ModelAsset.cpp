@@ -54,6 +54,7 @@ void AddObjFace(objTriangleList& objTriangleList, const ObjMesh& objMesh,
 bool ModelAsset::InitializeBuffers(ID3D11Device *device)
 {
 	VertexType* vertices;
+	XMFLOAT3* positions;
 	unsigned long* indices;
 	D3D11_BUFFER_DESC vertexBufferDesc, indexBufferDesc;
 	D3D11_SUBRESOURCE_DATA vertexData, indexData;
@@ -81,6 +82,13 @@ bool ModelAsset::InitializeBuffers(ID3D11Device *device)
 		return false;
 	}
 
+	//Create the position array, the depth pre-pass only reads these
+	positions = new XMFLOAT3[m_vertexCount];
+	if (!positions)
+	{
+		return false;
+	}
+
 	//Create the index array
 	indices = new unsigned long[m_vertexCount];
 	if (!indices)
@@ -99,6 +107,7 @@ bool ModelAsset::InitializeBuffers(ID3D11Device *device)
 			vertices[index].position = mesh.vertices[tri.vertex[j].iPos];
 			vertices[index].texture = mesh.texCoords[tri.vertex[j].iTex];
 			vertices[index].normal = mesh.normals[tri.vertex[j].iNormal];
+			positions[index] = vertices[index].position;
 
 			indices[index] = index;
 			index++;
@@ -130,7 +139,17 @@ bool ModelAsset::InitializeBuffers(ID3D11Device *device)
 	vertexData.SysMemSlicePitch = 0;
 
 	//Now create the vertex buffer
-	result = device->CreateBuffer(&vertexBufferDesc, &vertexData, &m_vertexBuffer);
+	result = device->CreateBuffer(&vertexBufferDesc, &vertexData, &m_buffers.vertexBuffer);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	//The position stream uses the same description with a smaller vertex
+	vertexBufferDesc.ByteWidth = sizeof(XMFLOAT3) * m_vertexCount;
+	vertexData.pSysMem = positions;
+
+	result = device->CreateBuffer(&vertexBufferDesc, &vertexData, &m_buffers.positionBuffer);
 	if (FAILED(result))
 	{
 		return false;
@@ -150,7 +169,7 @@ bool ModelAsset::InitializeBuffers(ID3D11Device *device)
 	indexData.SysMemSlicePitch = 0;
 
 	//Create the index buffer
-	result = device->CreateBuffer(&indexBufferDesc, &indexData, &m_indexBuffer);
+	result = device->CreateBuffer(&indexBufferDesc, &indexData, &m_buffers.indexBuffer);
 	if (FAILED(result))
 	{
 		return false;
@@ -160,6 +179,9 @@ bool ModelAsset::InitializeBuffers(ID3D11Device *device)
 	delete[] vertices;
 	vertices = 0;
 
+	delete[] positions;
+	positions = 0;
+
 	delete[] indices;
 	indices = 0;
 
@@ -168,21 +190,21 @@ bool ModelAsset::InitializeBuffers(ID3D11Device *device)
 	return true;
 }
 
-void ModelAsset::RenderBuffers(ID3D11DeviceContext* deviceContext)
+void ModelAsset::RenderBuffers(RenderContext* deviceContext)
 {
 	unsigned int stride;
 	unsigned int offset;
 
 
 	// Set vertex buffer stride and offset.
-	stride = sizeof(VertexType);
+	stride = m_buffers.vertexStride;
 	offset = 0;
 
 	// Set the vertex buffer to active in the input assembler so it can be rendered.
-	deviceContext->IASetVertexBuffers(0, 1, &m_vertexBuffer, &stride, &offset);
+	deviceContext->IASetVertexBuffers(0, 1, &m_buffers.vertexBuffer, &stride, &offset);
 
 	// Set the index buffer to active in the input assembler so it can be rendered.
-	deviceContext->IASetIndexBuffer(m_indexBuffer, DXGI_FORMAT_R32_UINT, 0);
+	deviceContext->IASetIndexBuffer(m_buffers.indexBuffer, m_buffers.indexFormat, 0);
 
 	// Set the type of primitive that should be rendered from this vertex buffer, in this case triangles.
 	deviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
@@ -195,8 +217,12 @@ bool ModelAsset::LoadModel(const char * modelname)
 
 ModelAsset::ModelAsset()
 {
-	m_vertexBuffer = 0;
-	m_indexBuffer = 0;
+	m_buffers.vertexBuffer = 0;
+	m_buffers.vertexStride = sizeof(VertexType);
+	m_buffers.positionBuffer = 0;
+	m_buffers.positionStride = sizeof(XMFLOAT3);
+	m_buffers.indexBuffer = 0;
+	m_buffers.indexFormat = DXGI_FORMAT_R32_UINT;
 }
 
 
@@ -206,6 +232,7 @@ ModelAsset::~ModelAsset()
 
 bool ModelAsset::load(std::string path, Assets * assets)
 {
+	PROFILE_ZONE("ModelAsset::load");
 	bool result;
 
 	//Initialize the model data
@@ -228,16 +255,22 @@ bool ModelAsset::load(std::string path, Assets * assets)
 void ModelAsset::unload()
 {
 	//Release the index buffer
-	if (m_indexBuffer)
+	if (m_buffers.indexBuffer)
+	{
+		m_buffers.indexBuffer->Release();
+		m_buffers.indexBuffer = 0;
+	}
+	//Release the position buffer
+	if (m_buffers.positionBuffer)
 	{
-		m_indexBuffer->Release();
-		m_indexBuffer = 0;
+		m_buffers.positionBuffer->Release();
+		m_buffers.positionBuffer = 0;
 	}
 	//Release the vertex buffer
-	if (m_vertexBuffer)
+	if (m_buffers.vertexBuffer)
 	{
-		m_vertexBuffer->Release();
-		m_vertexBuffer = 0;
+		m_buffers.vertexBuffer->Release();
+		m_buffers.vertexBuffer = 0;
 	}
 }
 
@@ -246,12 +279,17 @@ void ModelAsset::upload()
 	
 }
 
-void ModelAsset::Render(ID3D11DeviceContext *deviceContext)
+void ModelAsset::Render(RenderContext *deviceContext)
 {
 	//Put the vertex and index buffers on the graphics pipeline to prepare them for drawing
 	RenderBuffers(deviceContext);
 }
 
+const MeshBuffers * ModelAsset::GetBuffers()
+{
+	return &m_buffers;
+}
+
 int ModelAsset::GetIndexCount()
 {
 	return m_indexCount;
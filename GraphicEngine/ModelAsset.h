@@ -4,6 +4,8 @@
 #include <fstream>
 #include "Assets.h"
 #include "ObjLoader.h"
+#include "RenderContext.h"
+#include "RenderQueue.h"
 
 
 using namespace DirectX;
@@ -26,7 +28,7 @@ private:
 		XMFLOAT3 normal;
 	};
 
-	ID3D11Buffer *m_vertexBuffer, *m_indexBuffer;
+	MeshBuffers m_buffers;
 	int m_vertexCount, m_indexCount;
 
 	unsigned int triangleCount;
@@ -34,7 +36,7 @@ private:
 	ObjMesh mesh;
 
 	bool InitializeBuffers(ID3D11Device* device);
-	void RenderBuffers(ID3D11DeviceContext* deviceContext);
+	void RenderBuffers(RenderContext* deviceContext);
 
 	bool LoadModel(const char* modelname);
 public:
@@ -45,7 +47,9 @@ public:
 	GRAPHIC_API void unload() override;
 	GRAPHIC_API void upload() override;
 
-	GRAPHIC_API void Render(ID3D11DeviceContext* deviceContext);
+	GRAPHIC_API void Render(RenderContext* deviceContext);
+	// What the draws of this model are queued with, valid until it is unloaded.
+	GRAPHIC_API const MeshBuffers* GetBuffers();
 
 	GRAPHIC_API int GetIndexCount();
 
@@ -45,6 +45,64 @@ bool ModelList::Initialize(int numModels)
 	return true;
 }
 
+bool ModelList::Initialize(const char * filename)
+{
+	std::ifstream fin;
+	char input;
+	int i;
+
+	fin.open(filename);
+	if (fin.fail())
+	{
+		return false;
+	}
+
+	//Read up to the value of the model count
+	fin.get(input);
+	while (input != ':' && !fin.fail())
+	{
+		fin.get(input);
+	}
+
+	fin >> m_modelCount;
+	if (fin.fail() || m_modelCount <= 0)
+	{
+		return false;
+	}
+
+	//Create a list array of the model information
+	m_ModelInfoList = new ModelInfoType[m_modelCount];
+	if (!m_ModelInfoList)
+	{
+		return false;
+	}
+
+	//Read up to the beginning of the data
+	fin.get(input);
+	while (input != ':' && !fin.fail())
+	{
+		fin.get(input);
+	}
+
+	//Every model is drawn in white so the texture shows as it is
+	for (i = 0; i < m_modelCount; i++)
+	{
+		fin >> m_ModelInfoList[i].modelPath >> m_ModelInfoList[i].texturePath;
+		fin >> m_ModelInfoList[i].positionX >> m_ModelInfoList[i].positionY >> m_ModelInfoList[i].positionZ;
+
+		m_ModelInfoList[i].color = XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f);
+	}
+
+	if (fin.fail())
+	{
+		return false;
+	}
+
+	fin.close();
+
+	return true;
+}
+
 void ModelList::Shutdown()
 {
 	// Release the model information list.
@@ -69,3 +127,13 @@ void ModelList::GetData(int index, float &positionX, float &positionY, float &po
 
 	color = m_ModelInfoList[index].color;
 }
+
+const std::string & ModelList::GetModelPath(int index)
+{
+	return m_ModelInfoList[index].modelPath;
+}
+
+const std::string & ModelList::GetTexturePath(int index)
+{
+	return m_ModelInfoList[index].texturePath;
+}
@@ -3,6 +3,8 @@
 #include <DirectXMath.h>
 #include <stdlib.h>
 #include <time.h>
+#include <fstream>
+#include <string>
 using namespace DirectX;
 
 class ModelList
@@ -12,16 +14,23 @@ private:
 	{
 		XMFLOAT4 color;
 		float positionX, positionY, positionZ;
+		std::string modelPath;
+		std::string texturePath;
 	};
 public:
 	ModelList();
 	~ModelList();
 
 	bool Initialize(int numModels);
+	// Reads the models of a scene file: "Model Count: n", "Data:" and then one "model texture x y z" line per model.
+	bool Initialize(const char* filename);
 	void Shutdown();
 
 	int GetModelCount();
 	void GetData(int index, float &positionX, float &positionY, float &positionZ, XMFLOAT4 &color);
+	// Empty for the random list, the caller uses its own model then.
+	const std::string& GetModelPath(int index);
+	const std::string& GetTexturePath(int index);
 
 private:
 	int m_modelCount;
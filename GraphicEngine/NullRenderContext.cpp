@@ -0,0 +1,595 @@
+#include "NullRenderContext.h"
+
+NullCommandList::NullCommandList(const NullRenderCounters & counters)
+{
+	m_references = 1;
+	m_counters = counters;
+}
+
+NullCommandList::NullCommandList(const NullCommandList & other)
+{
+}
+
+NullCommandList::~NullCommandList()
+{
+}
+
+const NullRenderCounters & NullCommandList::GetCounters()
+{
+	return m_counters;
+}
+
+HRESULT NullCommandList::QueryInterface(REFIID riid, void ** object)
+{
+	*object = 0;
+
+	return E_NOINTERFACE;
+}
+
+ULONG NullCommandList::AddRef()
+{
+	return ++m_references;
+}
+
+ULONG NullCommandList::Release()
+{
+	ULONG references;
+
+	references = --m_references;
+	if (references == 0)
+	{
+		delete this;
+	}
+
+	return references;
+}
+
+void NullCommandList::GetDevice(ID3D11Device ** device)
+{
+	*device = 0;
+}
+
+HRESULT NullCommandList::GetPrivateData(REFGUID guid, UINT * dataSize, void * data)
+{
+	return E_FAIL;
+}
+
+HRESULT NullCommandList::SetPrivateData(REFGUID guid, UINT dataSize, const void * data)
+{
+	return E_FAIL;
+}
+
+HRESULT NullCommandList::SetPrivateDataInterface(REFGUID guid, const IUnknown * data)
+{
+	return E_FAIL;
+}
+
+UINT NullCommandList::GetContextFlags()
+{
+	return 0;
+}
+
+void NullRenderContext::CountState()
+{
+	m_counters.calls++;
+	m_counters.stateChanges++;
+}
+
+void NullRenderContext::AddCounters(const NullRenderCounters & counters)
+{
+	m_counters.calls += counters.calls;
+	m_counters.stateChanges += counters.stateChanges;
+	m_counters.draws += counters.draws;
+	m_counters.dispatches += counters.dispatches;
+	m_counters.maps += counters.maps;
+	m_counters.clears += counters.clears;
+	m_counters.commandLists += counters.commandLists;
+	m_counters.bytesUploaded += counters.bytesUploaded;
+}
+
+unsigned int NullRenderContext::GetUploadSize(ID3D11Resource * resource, UINT subresource, const D3D11_BOX * box, UINT rowPitch)
+{
+	D3D11_RESOURCE_DIMENSION dimension;
+	D3D11_BUFFER_DESC bufferDesc;
+	D3D11_TEXTURE2D_DESC textureDesc;
+	unsigned int height;
+
+	// The resources themselves are real, so their size can be asked for.
+	resource->GetType(&dimension);
+
+	if (dimension == D3D11_RESOURCE_DIMENSION_BUFFER)
+	{
+		if (box)
+		{
+			return box->right - box->left;
+		}
+
+		((ID3D11Buffer*)resource)->GetDesc(&bufferDesc);
+		return bufferDesc.ByteWidth;
+	}
+
+	if (dimension == D3D11_RESOURCE_DIMENSION_TEXTURE2D)
+	{
+		((ID3D11Texture2D*)resource)->GetDesc(&textureDesc);
+
+		if (box)
+		{
+			height = box->bottom - box->top;
+		}
+		else
+		{
+			height = textureDesc.Height >> (subresource % textureDesc.MipLevels);
+		}
+
+		// Without a row pitch assume four bytes per texel.
+		if (rowPitch == 0)
+		{
+			rowPitch = (textureDesc.Width >> (subresource % textureDesc.MipLevels)) * 4;
+		}
+
+		return rowPitch * (height > 0 ? height : 1);
+	}
+
+	return 0;
+}
+
+NullRenderContext::NullRenderContext()
+{
+	m_scratch = 0;
+	m_scratchSize = 0;
+
+	m_renderTarget = 0;
+	m_depthStencil = 0;
+	m_depthStencilState = 0;
+	m_stencilRef = 0;
+	m_blendState = 0;
+	m_sampleMask = 0xffffffff;
+	m_rasterState = 0;
+
+	memset(m_blendFactor, 0, sizeof(m_blendFactor));
+	memset(&m_viewport, 0, sizeof(m_viewport));
+
+	ResetCounters();
+}
+
+NullRenderContext::NullRenderContext(const NullRenderContext & other)
+{
+}
+
+NullRenderContext::~NullRenderContext()
+{
+}
+
+void NullRenderContext::Initialize()
+{
+	ResetCounters();
+}
+
+void NullRenderContext::Shutdown()
+{
+	// Release the scratch memory of the maps.
+	if (m_scratch)
+	{
+		delete[] m_scratch;
+		m_scratch = 0;
+	}
+
+	m_scratchSize = 0;
+
+	m_queryTimes.clear();
+}
+
+void NullRenderContext::IASetInputLayout(ID3D11InputLayout * inputLayout)
+{
+	CountState();
+}
+
+void NullRenderContext::IASetVertexBuffers(UINT startSlot, UINT bufferCount, ID3D11Buffer * const * vertexBuffers,
+	const UINT * strides, const UINT * offsets)
+{
+	CountState();
+}
+
+void NullRenderContext::IASetIndexBuffer(ID3D11Buffer * indexBuffer, DXGI_FORMAT format, UINT offset)
+{
+	CountState();
+}
+
+void NullRenderContext::IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY topology)
+{
+	CountState();
+}
+
+void NullRenderContext::VSSetShader(ID3D11VertexShader * vertexShader, ID3D11ClassInstance * const * classInstances,
+	UINT classInstanceCount)
+{
+	CountState();
+}
+
+void NullRenderContext::VSSetConstantBuffers(UINT startSlot, UINT bufferCount, ID3D11Buffer * const * constantBuffers)
+{
+	CountState();
+}
+
+void NullRenderContext::VSSetConstantBuffers1(UINT startSlot, UINT bufferCount, ID3D11Buffer * const * constantBuffers,
+	const UINT * firstConstants, const UINT * constantCounts)
+{
+	CountState();
+}
+
+void NullRenderContext::PSSetShader(ID3D11PixelShader * pixelShader, ID3D11ClassInstance * const * classInstances, UINT classInstanceCount)
+{
+	CountState();
+}
+
+void NullRenderContext::PSSetConstantBuffers(UINT startSlot, UINT bufferCount, ID3D11Buffer * const * constantBuffers)
+{
+	CountState();
+}
+
+void NullRenderContext::PSSetShaderResources(UINT startSlot, UINT viewCount, ID3D11ShaderResourceView * const * shaderResourceViews)
+{
+	CountState();
+	Stats::Add(STAT_SRV_BINDS, viewCount);
+}
+
+void NullRenderContext::PSSetSamplers(UINT startSlot, UINT samplerCount, ID3D11SamplerState * const * samplers)
+{
+	CountState();
+}
+
+void NullRenderContext::CSSetShader(ID3D11ComputeShader * computeShader, ID3D11ClassInstance * const * classInstances,
+	UINT classInstanceCount)
+{
+	CountState();
+}
+
+void NullRenderContext::CSSetConstantBuffers(UINT startSlot, UINT bufferCount, ID3D11Buffer * const * constantBuffers)
+{
+	CountState();
+}
+
+void NullRenderContext::CSSetShaderResources(UINT startSlot, UINT viewCount, ID3D11ShaderResourceView * const * shaderResourceViews)
+{
+	CountState();
+	Stats::Add(STAT_SRV_BINDS, viewCount);
+}
+
+void NullRenderContext::CSSetUnorderedAccessViews(UINT startSlot, UINT viewCount,
+	ID3D11UnorderedAccessView * const * unorderedAccessViews, const UINT * initialCounts)
+{
+	CountState();
+}
+
+void NullRenderContext::OMSetRenderTargets(UINT viewCount, ID3D11RenderTargetView * const * renderTargetViews,
+	ID3D11DepthStencilView * depthStencilView)
+{
+	CountState();
+
+	m_renderTarget = viewCount > 0 ? renderTargetViews[0] : 0;
+	m_depthStencil = depthStencilView;
+}
+
+void NullRenderContext::OMSetDepthStencilState(ID3D11DepthStencilState * depthStencilState, UINT stencilRef)
+{
+	CountState();
+
+	m_depthStencilState = depthStencilState;
+	m_stencilRef = stencilRef;
+}
+
+void NullRenderContext::OMSetBlendState(ID3D11BlendState * blendState, const FLOAT blendFactor[4], UINT sampleMask)
+{
+	CountState();
+
+	m_blendState = blendState;
+	if (blendFactor)
+	{
+		memcpy(m_blendFactor, blendFactor, sizeof(m_blendFactor));
+	}
+	m_sampleMask = sampleMask;
+}
+
+void NullRenderContext::RSSetState(ID3D11RasterizerState * rasterizerState)
+{
+	CountState();
+
+	m_rasterState = rasterizerState;
+}
+
+void NullRenderContext::RSSetViewports(UINT viewportCount, const D3D11_VIEWPORT * viewports)
+{
+	CountState();
+
+	if (viewportCount > 0)
+	{
+		m_viewport = viewports[0];
+	}
+}
+
+void NullRenderContext::OMGetRenderTargets(UINT viewCount, ID3D11RenderTargetView ** renderTargetViews,
+	ID3D11DepthStencilView ** depthStencilView)
+{
+	m_counters.calls++;
+
+	if (viewCount > 0 && renderTargetViews)
+	{
+		renderTargetViews[0] = m_renderTarget;
+		if (m_renderTarget)
+		{
+			m_renderTarget->AddRef();
+		}
+	}
+
+	if (depthStencilView)
+	{
+		*depthStencilView = m_depthStencil;
+		if (m_depthStencil)
+		{
+			m_depthStencil->AddRef();
+		}
+	}
+}
+
+void NullRenderContext::OMGetDepthStencilState(ID3D11DepthStencilState ** depthStencilState, UINT * stencilRef)
+{
+	m_counters.calls++;
+
+	*depthStencilState = m_depthStencilState;
+	if (m_depthStencilState)
+	{
+		m_depthStencilState->AddRef();
+	}
+	*stencilRef = m_stencilRef;
+}
+
+void NullRenderContext::OMGetBlendState(ID3D11BlendState ** blendState, FLOAT blendFactor[4], UINT * sampleMask)
+{
+	m_counters.calls++;
+
+	*blendState = m_blendState;
+	if (m_blendState)
+	{
+		m_blendState->AddRef();
+	}
+	memcpy(blendFactor, m_blendFactor, sizeof(m_blendFactor));
+	*sampleMask = m_sampleMask;
+}
+
+void NullRenderContext::RSGetState(ID3D11RasterizerState ** rasterizerState)
+{
+	m_counters.calls++;
+
+	*rasterizerState = m_rasterState;
+	if (m_rasterState)
+	{
+		m_rasterState->AddRef();
+	}
+}
+
+void NullRenderContext::RSGetViewports(UINT * viewportCount, D3D11_VIEWPORT * viewports)
+{
+	m_counters.calls++;
+
+	if (*viewportCount > 0 && viewports)
+	{
+		viewports[0] = m_viewport;
+	}
+	*viewportCount = 1;
+}
+
+void NullRenderContext::ClearRenderTargetView(ID3D11RenderTargetView * renderTargetView, const FLOAT color[4])
+{
+	m_counters.calls++;
+	m_counters.clears++;
+}
+
+void NullRenderContext::ClearDepthStencilView(ID3D11DepthStencilView * depthStencilView, UINT clearFlags, FLOAT depth, UINT8 stencil)
+{
+	m_counters.calls++;
+	m_counters.clears++;
+}
+
+void NullRenderContext::DrawIndexed(UINT indexCount, UINT startIndex, INT baseVertex)
+{
+	m_counters.calls++;
+	m_counters.draws++;
+	Stats::CountDraw(indexCount, 1);
+}
+
+void NullRenderContext::DrawIndexedInstanced(UINT indexCount, UINT instanceCount, UINT startIndex, INT baseVertex, UINT startInstance)
+{
+	m_counters.calls++;
+	m_counters.draws++;
+	Stats::CountDraw(indexCount, instanceCount);
+}
+
+void NullRenderContext::Dispatch(UINT groupCountX, UINT groupCountY, UINT groupCountZ)
+{
+	m_counters.calls++;
+	m_counters.dispatches++;
+}
+
+HRESULT NullRenderContext::Map(ID3D11Resource * resource, UINT subresource, D3D11_MAP mapType, UINT mapFlags,
+	D3D11_MAPPED_SUBRESOURCE * mappedResource)
+{
+	unsigned int size;
+
+	m_counters.calls++;
+	Stats::Add(STAT_MAPS, 1);
+
+	// Hand out scratch memory that is large enough for the whole resource.
+	size = GetUploadSize(resource, subresource, 0, 0);
+	if (size == 0)
+	{
+		return E_FAIL;
+	}
+
+	if (!ReserveScratch(size))
+	{
+		return E_FAIL;
+	}
+
+	mappedResource->pData = m_scratch;
+	mappedResource->RowPitch = size;
+	mappedResource->DepthPitch = size;
+
+	m_counters.maps++;
+
+	// The ring maps its buffer without overwrite and counts the bytes it writes itself.
+	if (mapType == D3D11_MAP_WRITE_DISCARD)
+	{
+		m_counters.bytesUploaded += size;
+	}
+
+	return S_OK;
+}
+
+void NullRenderContext::Unmap(ID3D11Resource * resource, UINT subresource)
+{
+	m_counters.calls++;
+}
+
+void NullRenderContext::UpdateSubresource(ID3D11Resource * resource, UINT subresource, const D3D11_BOX * box, const void * data,
+	UINT rowPitch, UINT depthPitch)
+{
+	m_counters.calls++;
+	m_counters.bytesUploaded += GetUploadSize(resource, subresource, box, rowPitch);
+}
+
+void NullRenderContext::GenerateMips(ID3D11ShaderResourceView * shaderResourceView)
+{
+	m_counters.calls++;
+}
+
+void NullRenderContext::Begin(ID3D11Asynchronous * async)
+{
+	m_counters.calls++;
+}
+
+void NullRenderContext::End(ID3D11Asynchronous * async)
+{
+	INT64 time;
+
+	m_counters.calls++;
+
+	QueryPerformanceCounter((LARGE_INTEGER*)&time);
+	m_queryTimes[async] = (UINT64)time;
+}
+
+HRESULT NullRenderContext::GetData(ID3D11Asynchronous * async, void * data, UINT dataSize, UINT getDataFlags)
+{
+	D3D11_QUERY_DATA_TIMESTAMP_DISJOINT* disjoint;
+	std::map<ID3D11Asynchronous*, UINT64>::iterator it;
+	INT64 frequency;
+
+	m_counters.calls++;
+
+	// Only timestamp queries are used, the disjoint query is told apart by the size of its data.
+	if (dataSize == sizeof(D3D11_QUERY_DATA_TIMESTAMP_DISJOINT))
+	{
+		QueryPerformanceFrequency((LARGE_INTEGER*)&frequency);
+
+		disjoint = (D3D11_QUERY_DATA_TIMESTAMP_DISJOINT*)data;
+		disjoint->Frequency = (UINT64)frequency;
+		disjoint->Disjoint = FALSE;
+
+		return S_OK;
+	}
+
+	it = m_queryTimes.find(async);
+	if (it == m_queryTimes.end() || dataSize != sizeof(UINT64))
+	{
+		return S_FALSE;
+	}
+
+	*(UINT64*)data = it->second;
+
+	return S_OK;
+}
+
+HRESULT NullRenderContext::FinishCommandList(BOOL restoreDeferredContextState, ID3D11CommandList ** commandList)
+{
+	NullCommandList* list;
+
+	m_counters.calls++;
+	m_counters.commandLists++;
+
+	// The list takes what was counted since the last one, the deferred context starts over like a real one.
+	list = new NullCommandList(m_counters);
+	if (!list)
+	{
+		*commandList = 0;
+		return E_OUTOFMEMORY;
+	}
+
+	ResetCounters();
+	*commandList = list;
+
+	return S_OK;
+}
+
+void NullRenderContext::ExecuteCommandList(ID3D11CommandList * commandList, BOOL restoreContextState)
+{
+	m_counters.calls++;
+
+	// Only lists of deferred null contexts ever reach a null context.
+	if (commandList)
+	{
+		AddCounters(((NullCommandList*)commandList)->GetCounters());
+	}
+}
+
+RenderContext * NullRenderContext::CreateDeferredContext()
+{
+	NullRenderContext* context;
+
+	context = new NullRenderContext;
+	if (!context)
+	{
+		return 0;
+	}
+
+	context->Initialize();
+
+	return context;
+}
+
+bool NullRenderContext::SupportsConstantOffsets()
+{
+	return true;
+}
+
+const NullRenderCounters & NullRenderContext::GetCounters()
+{
+	return m_counters;
+}
+
+void NullRenderContext::ResetCounters()
+{
+	memset(&m_counters, 0, sizeof(m_counters));
+}
+
+bool NullRenderContext::ReserveScratch(unsigned int size)
+{
+	if (size <= m_scratchSize)
+	{
+		return true;
+	}
+
+	if (m_scratch)
+	{
+		delete[] m_scratch;
+	}
+
+	m_scratch = new unsigned char[size];
+	if (!m_scratch)
+	{
+		m_scratchSize = 0;
+		return false;
+	}
+
+	m_scratchSize = size;
+
+	return true;
+}
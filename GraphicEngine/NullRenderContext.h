@@ -0,0 +1,137 @@
+#pragma once
+#include <d3d11.h>
+#include <map>
+#include "RenderContext.h"
+
+// What a NullRenderContext was asked to do since the counters were last reset.
+struct NullRenderCounters
+{
+	int calls;
+	int stateChanges;
+	int draws;
+	int dispatches;
+	int maps;
+	int clears;
+	int commandLists;
+
+	// Discard maps count the whole buffer, updates the bytes inside the box. No overwrite maps only add to a
+	// buffer that is in use, the callers count what they write into it.
+	unsigned long long bytesUploaded;
+};
+
+// Command list of a deferred NullRenderContext. It carries what the deferred context counted while it was
+// recorded, and executing it adds that to the immediate context. Freed with its last Release.
+class NullCommandList : public ID3D11CommandList
+{
+private:
+	ULONG m_references;
+	NullRenderCounters m_counters;
+public:
+	NullCommandList(const NullRenderCounters& counters);
+	NullCommandList(const NullCommandList&);
+	virtual ~NullCommandList();
+
+	const NullRenderCounters& GetCounters();
+
+	HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid, void** object);
+	ULONG STDMETHODCALLTYPE AddRef();
+	ULONG STDMETHODCALLTYPE Release();
+	void STDMETHODCALLTYPE GetDevice(ID3D11Device** device);
+	HRESULT STDMETHODCALLTYPE GetPrivateData(REFGUID guid, UINT* dataSize, void* data);
+	HRESULT STDMETHODCALLTYPE SetPrivateData(REFGUID guid, UINT dataSize, const void* data);
+	HRESULT STDMETHODCALLTYPE SetPrivateDataInterface(REFGUID guid, const IUnknown* data);
+	UINT STDMETHODCALLTYPE GetContextFlags();
+};
+
+// Backend that submits nothing and only counts the calls, so a frame can run without a gpu doing the work
+// and the cpu cost of the engine can be measured on its own. Maps hand out scratch memory, which only
+// works when a single resource is mapped at a time, as the engine always does. The output state is kept
+// so it can be read back with the get calls. Deferred contexts count on their own until their command list
+// is executed, then their counts are added to the immediate context. Timestamp queries return the cpu time they were ended at, so
+// a pass is timed by how long the engine took to submit it.
+class NullRenderContext : public RenderContext
+{
+private:
+	NullRenderCounters m_counters;
+	unsigned char* m_scratch;
+	unsigned int m_scratchSize;
+
+	ID3D11RenderTargetView* m_renderTarget;
+	ID3D11DepthStencilView* m_depthStencil;
+	ID3D11DepthStencilState* m_depthStencilState;
+	UINT m_stencilRef;
+	ID3D11BlendState* m_blendState;
+	FLOAT m_blendFactor[4];
+	UINT m_sampleMask;
+	ID3D11RasterizerState* m_rasterState;
+	D3D11_VIEWPORT m_viewport;
+
+	// Time every timestamp query was ended at.
+	std::map<ID3D11Asynchronous*, UINT64> m_queryTimes;
+
+	void CountState();
+	void AddCounters(const NullRenderCounters& counters);
+	unsigned int GetUploadSize(ID3D11Resource* resource, UINT subresource, const D3D11_BOX* box, UINT rowPitch);
+public:
+	NullRenderContext();
+	NullRenderContext(const NullRenderContext&);
+	~NullRenderContext();
+
+	void Initialize();
+	void Shutdown() override;
+
+	void IASetInputLayout(ID3D11InputLayout* inputLayout) override;
+	void IASetVertexBuffers(UINT startSlot, UINT bufferCount, ID3D11Buffer* const* vertexBuffers, const UINT* strides,
+		const UINT* offsets) override;
+	void IASetIndexBuffer(ID3D11Buffer* indexBuffer, DXGI_FORMAT format, UINT offset) override;
+	void IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY topology) override;
+	void VSSetShader(ID3D11VertexShader* vertexShader, ID3D11ClassInstance* const* classInstances, UINT classInstanceCount) override;
+	void VSSetConstantBuffers(UINT startSlot, UINT bufferCount, ID3D11Buffer* const* constantBuffers) override;
+	void VSSetConstantBuffers1(UINT startSlot, UINT bufferCount, ID3D11Buffer* const* constantBuffers, const UINT* firstConstants,
+		const UINT* constantCounts) override;
+	void PSSetShader(ID3D11PixelShader* pixelShader, ID3D11ClassInstance* const* classInstances, UINT classInstanceCount) override;
+	void PSSetConstantBuffers(UINT startSlot, UINT bufferCount, ID3D11Buffer* const* constantBuffers) override;
+	void PSSetShaderResources(UINT startSlot, UINT viewCount, ID3D11ShaderResourceView* const* shaderResourceViews) override;
+	void PSSetSamplers(UINT startSlot, UINT samplerCount, ID3D11SamplerState* const* samplers) override;
+	void CSSetShader(ID3D11ComputeShader* computeShader, ID3D11ClassInstance* const* classInstances, UINT classInstanceCount) override;
+	void CSSetConstantBuffers(UINT startSlot, UINT bufferCount, ID3D11Buffer* const* constantBuffers) override;
+	void CSSetShaderResources(UINT startSlot, UINT viewCount, ID3D11ShaderResourceView* const* shaderResourceViews) override;
+	void CSSetUnorderedAccessViews(UINT startSlot, UINT viewCount, ID3D11UnorderedAccessView* const* unorderedAccessViews,
+		const UINT* initialCounts) override;
+	void OMSetRenderTargets(UINT viewCount, ID3D11RenderTargetView* const* renderTargetViews,
+		ID3D11DepthStencilView* depthStencilView) override;
+	void OMSetDepthStencilState(ID3D11DepthStencilState* depthStencilState, UINT stencilRef) override;
+	void OMSetBlendState(ID3D11BlendState* blendState, const FLOAT blendFactor[4], UINT sampleMask) override;
+	void RSSetState(ID3D11RasterizerState* rasterizerState) override;
+	void RSSetViewports(UINT viewportCount, const D3D11_VIEWPORT* viewports) override;
+	void OMGetRenderTargets(UINT viewCount, ID3D11RenderTargetView** renderTargetViews, ID3D11DepthStencilView** depthStencilView) override;
+	void OMGetDepthStencilState(ID3D11DepthStencilState** depthStencilState, UINT* stencilRef) override;
+	void OMGetBlendState(ID3D11BlendState** blendState, FLOAT blendFactor[4], UINT* sampleMask) override;
+	void RSGetState(ID3D11RasterizerState** rasterizerState) override;
+	void RSGetViewports(UINT* viewportCount, D3D11_VIEWPORT* viewports) override;
+	void ClearRenderTargetView(ID3D11RenderTargetView* renderTargetView, const FLOAT color[4]) override;
+	void ClearDepthStencilView(ID3D11DepthStencilView* depthStencilView, UINT clearFlags, FLOAT depth, UINT8 stencil) override;
+	void DrawIndexed(UINT indexCount, UINT startIndex, INT baseVertex) override;
+	void DrawIndexedInstanced(UINT indexCount, UINT instanceCount, UINT startIndex, INT baseVertex, UINT startInstance) override;
+	void Dispatch(UINT groupCountX, UINT groupCountY, UINT groupCountZ) override;
+	HRESULT Map(ID3D11Resource* resource, UINT subresource, D3D11_MAP mapType, UINT mapFlags,
+		D3D11_MAPPED_SUBRESOURCE* mappedResource) override;
+	void Unmap(ID3D11Resource* resource, UINT subresource) override;
+	void UpdateSubresource(ID3D11Resource* resource, UINT subresource, const D3D11_BOX* box, const void* data, UINT rowPitch,
+		UINT depthPitch) override;
+	void GenerateMips(ID3D11ShaderResourceView* shaderResourceView) override;
+	void Begin(ID3D11Asynchronous* async) override;
+	void End(ID3D11Asynchronous* async) override;
+	HRESULT GetData(ID3D11Asynchronous* async, void* data, UINT dataSize, UINT getDataFlags) override;
+	HRESULT FinishCommandList(BOOL restoreDeferredContextState, ID3D11CommandList** commandList) override;
+	void ExecuteCommandList(ID3D11CommandList* commandList, BOOL restoreContextState) override;
+	RenderContext* CreateDeferredContext() override;
+	bool SupportsConstantOffsets() override;
+
+	const NullRenderCounters& GetCounters();
+	void ResetCounters();
+
+	// Grows the scratch of the maps to size bytes up front, so the first map of a large buffer does not allocate
+	// in the middle of a run. Returns false when the memory could not be allocated.
+	bool ReserveScratch(unsigned int size);
+};
@@ -173,6 +173,7 @@ INT PathFromFileName(LPCTSTR sFileName)
 // file was loaded but the associated mtl file was not found.
 bool LoadObj(const char* filename, ObjMesh* pOutObjMesh)
 {
+	PROFILE_ZONE("LoadObj");
 	CHAR buffer[LINE_BUFF_SIZE];
 
 	ObjMesh& obj = *pOutObjMesh;
@@ -3,6 +3,7 @@
 #include <vector>
 #include <d3d11.h>
 #include <DirectXMath.h>
+#include "Profiler.h"
 
 using namespace DirectX;
 
@@ -0,0 +1,229 @@
+#pragma once
+#include <cstddef>
+#include <new>
+#include <vector>
+
+// Refers to an object of an ObjectPool by its slot and the generation of the slot. Freeing an object moves the
+// generation of its slot on, so handles to it go stale instead of pointing at whatever takes the slot next.
+// Generation 0 is never used, a default handle refers to nothing.
+template<typename T>
+struct Handle
+{
+	unsigned int index;
+	unsigned int generation;
+
+	Handle()
+	{
+		index = 0;
+		generation = 0;
+	}
+
+	bool IsValid() const
+	{
+		return generation != 0;
+	}
+
+	bool operator==(const Handle& other) const
+	{
+		return index == other.index && generation == other.generation;
+	}
+
+	bool operator!=(const Handle& other) const
+	{
+		return !operator==(other);
+	}
+};
+
+// Objects of one type in blocks of a fixed number of objects. Allocating and freeing take the first slot of a
+// free list and put it back, a full pool adds another block, so objects never move while they are alive. Not
+// thread safe. Nothing in here touches Windows or Direct3D.
+template<typename T>
+class ObjectPool
+{
+private:
+	struct Slot
+	{
+		unsigned int generation;
+		int nextFree;
+		bool alive;
+	};
+
+	std::vector<unsigned char*> m_blocks;
+	std::vector<Slot> m_slots;
+	int m_blockSize;
+	int m_count;
+	// First free slot, -1 when every slot is in use.
+	int m_firstFree;
+
+	T* ObjectAt(int index)
+	{
+		return (T*)(m_blocks[index / m_blockSize] + sizeof(T) * (index % m_blockSize));
+	}
+
+	// Only called when the pool is full, the slots of the new block become the whole free list.
+	bool AddBlock()
+	{
+		unsigned char* block;
+		Slot slot;
+		int first, i;
+
+		// The block of new is only aligned for the largest basic type.
+		static_assert(alignof(T) <= alignof(std::max_align_t), "ObjectPool only holds types with basic alignment");
+
+		block = new unsigned char[sizeof(T) * m_blockSize];
+		if (!block)
+		{
+			return false;
+		}
+
+		m_blocks.push_back(block);
+
+		// Chain the slots in order so the first objects end up next to each other.
+		first = (int)m_slots.size();
+		for (i = 0; i < m_blockSize; i++)
+		{
+			slot.generation = 1;
+			slot.nextFree = i + 1 < m_blockSize ? first + i + 1 : -1;
+			slot.alive = false;
+			m_slots.push_back(slot);
+		}
+
+		m_firstFree = first;
+
+		return true;
+	}
+public:
+	ObjectPool()
+	{
+		m_blockSize = 0;
+		m_count = 0;
+		m_firstFree = -1;
+	}
+
+	// The blocks belong to one pool, copies would free them twice.
+	ObjectPool(const ObjectPool&) = delete;
+	ObjectPool& operator=(const ObjectPool&) = delete;
+
+	~ObjectPool()
+	{
+	}
+
+	// Allocates the first block, the pool grows by blockSize objects whenever it is full.
+	bool Initialize(int blockSize)
+	{
+		if (blockSize <= 0)
+		{
+			return false;
+		}
+
+		m_blockSize = blockSize;
+		m_count = 0;
+		m_firstFree = -1;
+
+		return AddBlock();
+	}
+
+	// Destroys the objects that are still alive.
+	void Shutdown()
+	{
+		size_t i;
+
+		for (i = 0; i < m_slots.size(); i++)
+		{
+			if (m_slots[i].alive)
+			{
+				ObjectAt((int)i)->~T();
+			}
+		}
+
+		for (i = 0; i < m_blocks.size(); i++)
+		{
+			delete[] m_blocks[i];
+		}
+
+		m_blocks.clear();
+		m_slots.clear();
+		m_blockSize = 0;
+		m_count = 0;
+		m_firstFree = -1;
+	}
+
+	// Default constructs an object in a free slot. Returns an invalid handle when the pool is full and no block
+	// could be added.
+	Handle<T> Allocate()
+	{
+		Handle<T> handle;
+		int index;
+
+		if (m_firstFree < 0 && (m_blockSize <= 0 || !AddBlock()))
+		{
+			return handle;
+		}
+
+		index = m_firstFree;
+		m_firstFree = m_slots[index].nextFree;
+
+		new (ObjectAt(index)) T();
+		m_slots[index].alive = true;
+		m_count++;
+
+		handle.index = (unsigned int)index;
+		handle.generation = m_slots[index].generation;
+
+		return handle;
+	}
+
+	// Destroys the object and puts its slot back on the free list. Stale handles are ignored.
+	void Free(Handle<T> handle)
+	{
+		int index;
+
+		if (!Get(handle))
+		{
+			return;
+		}
+
+		index = (int)handle.index;
+		ObjectAt(index)->~T();
+
+		m_slots[index].alive = false;
+		m_slots[index].generation++;
+		if (m_slots[index].generation == 0)
+		{
+			m_slots[index].generation = 1;
+		}
+
+		m_slots[index].nextFree = m_firstFree;
+		m_firstFree = index;
+		m_count--;
+	}
+
+	// Returns 0 when the object of the handle was freed.
+	T* Get(Handle<T> handle)
+	{
+		if (handle.index >= (unsigned int)m_slots.size() || !m_slots[handle.index].alive ||
+			m_slots[handle.index].generation != handle.generation)
+		{
+			return 0;
+		}
+
+		return ObjectAt((int)handle.index);
+	}
+
+	// Object of a slot, 0 when the slot is free. Going over every slot reads the objects in memory order.
+	T* GetAt(int index)
+	{
+		return m_slots[index].alive ? ObjectAt(index) : 0;
+	}
+
+	int GetCount()
+	{
+		return m_count;
+	}
+
+	// Slots of all blocks, a multiple of the block size.
+	int GetCapacity()
+	{
+		return (int)m_slots.size();
+	}
+};
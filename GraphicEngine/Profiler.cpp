@@ -0,0 +1,354 @@
+#include "Profiler.h"
+#include <atomic>
+#include <mutex>
+#include <fstream>
+#include <algorithm>
+
+namespace
+{
+	// A zone in the ring. The fields are atomic because the render thread copies zones out while their thread
+	// keeps recording, a copy that may have been overwritten meanwhile is dropped by ReadEvent.
+	struct ProfileSlot
+	{
+		std::atomic<const char*> name;
+		std::atomic<INT64> start;
+		std::atomic<INT64> end;
+		std::atomic<int> depth;
+	};
+
+	struct ProfileThread
+	{
+		ProfileSlot events[PROFILER_RING_SIZE];
+		// Zones written so far, only the last PROFILER_RING_SIZE are still in the ring.
+		std::atomic<unsigned int> written;
+		unsigned int summarized;
+		int depth;
+		unsigned long threadId;
+	};
+
+	std::atomic<bool> s_enabled(false);
+	std::mutex s_threadMutex;
+	ProfileThread* s_threads[PROFILER_MAX_THREADS];
+	std::atomic<int> s_threadCount(0);
+
+	// Set by the first SetEnabled, the epoch before the frequency, which the other threads check for.
+	std::atomic<INT64> s_frequency(0);
+	std::atomic<INT64> s_epoch(0);
+
+	ProfileSummary s_summary[PROFILER_MAX_SUMMARY];
+	int s_summaryCount = 0;
+
+	// Goes up with every Shutdown, which frees the rings of all threads, so a thread that still points at its
+	// ring of an earlier run knows to get a new one.
+	std::atomic<unsigned int> s_generation(0);
+
+	thread_local ProfileThread* t_thread = 0;
+	thread_local unsigned int t_generation = 0;
+
+	ProfileThread* GetThread()
+	{
+		ProfileThread* thread;
+
+		if (t_thread && t_generation == s_generation.load(std::memory_order_acquire))
+		{
+			return t_thread;
+		}
+
+		// First zone of this thread, give it a ring. Threads past the maximum are not recorded.
+		std::lock_guard<std::mutex> lock(s_threadMutex);
+
+		t_thread = 0;
+		t_generation = s_generation.load(std::memory_order_relaxed);
+
+		if (s_threadCount >= PROFILER_MAX_THREADS)
+		{
+			return 0;
+		}
+
+		thread = new ProfileThread;
+		if (!thread)
+		{
+			return 0;
+		}
+
+		thread->written = 0;
+		thread->summarized = 0;
+		thread->depth = 0;
+		thread->threadId = GetCurrentThreadId();
+
+		s_threads[s_threadCount] = thread;
+		s_threadCount++;
+
+		t_thread = thread;
+		return thread;
+	}
+
+	float TicksToMs(INT64 ticks)
+	{
+		return (float)((double)ticks * 1000.0 / (double)s_frequency.load(std::memory_order_relaxed));
+	}
+
+	// Double so the start of a zone keeps microsecond precision in long traces.
+	double TicksToUs(INT64 ticks)
+	{
+		return (double)ticks * 1000000.0 / (double)s_frequency.load(std::memory_order_relaxed);
+	}
+
+	// Copies a zone out of the ring of a thread that may still be recording. The thread writes a slot before it
+	// counts the zone, so once it has counted index + PROFILER_RING_SIZE zones the slot may hold parts of a newer
+	// zone and the copy is dropped.
+	bool ReadEvent(ProfileThread* thread, unsigned int index, ProfileEvent& event)
+	{
+		ProfileSlot* slot;
+
+		// Pairs with the stores in ~ProfileZone, seeing any part of a newer zone means seeing the count it was
+		// written at as well.
+		slot = &thread->events[index % PROFILER_RING_SIZE];
+		event.name = slot->name.load(std::memory_order_acquire);
+		event.start = slot->start.load(std::memory_order_acquire);
+		event.end = slot->end.load(std::memory_order_acquire);
+		event.depth = slot->depth.load(std::memory_order_acquire);
+
+		return thread->written.load(std::memory_order_relaxed) - index < PROFILER_RING_SIZE;
+	}
+
+	bool CompareSummary(const ProfileSummary& a, const ProfileSummary& b)
+	{
+		return a.time > b.time;
+	}
+}
+
+void Profiler::SetEnabled(bool enabled)
+{
+	INT64 frequency, now;
+
+	if (enabled && s_frequency.load(std::memory_order_acquire) == 0)
+	{
+		QueryPerformanceFrequency((LARGE_INTEGER*)&frequency);
+		QueryPerformanceCounter((LARGE_INTEGER*)&now);
+		s_epoch.store(now, std::memory_order_relaxed);
+		s_frequency.store(frequency, std::memory_order_release);
+	}
+
+	s_enabled = enabled;
+}
+
+bool Profiler::IsEnabled()
+{
+	return s_enabled;
+}
+
+void Profiler::EndFrame()
+{
+	ProfileThread* thread;
+	ProfileEvent event;
+	unsigned int written, first, i;
+	int threadIndex, index;
+
+	if (!s_enabled)
+	{
+		return;
+	}
+
+	s_summaryCount = 0;
+
+	for (threadIndex = 0; threadIndex < s_threadCount; threadIndex++)
+	{
+		thread = s_threads[threadIndex];
+
+		// Only the zones since the last summary, as far as the ring still holds them.
+		written = thread->written.load(std::memory_order_acquire);
+		first = thread->summarized;
+		if (written - first > PROFILER_RING_SIZE)
+		{
+			first = written - PROFILER_RING_SIZE;
+		}
+
+		for (i = first; i < written; i++)
+		{
+			if (!ReadEvent(thread, i, event))
+			{
+				continue;
+			}
+
+			// Group by the name pointer, the same zone always passes the same literal.
+			for (index = 0; index < s_summaryCount; index++)
+			{
+				if (s_summary[index].name == event.name)
+				{
+					break;
+				}
+			}
+
+			if (index == s_summaryCount)
+			{
+				if (s_summaryCount == PROFILER_MAX_SUMMARY)
+				{
+					continue;
+				}
+
+				s_summary[index].name = event.name;
+				s_summary[index].time = 0.0f;
+				s_summary[index].calls = 0;
+				s_summary[index].depth = event.depth;
+				s_summaryCount++;
+			}
+
+			s_summary[index].time += TicksToMs(event.end - event.start);
+			s_summary[index].calls++;
+		}
+
+		thread->summarized = written;
+	}
+
+	std::sort(s_summary, s_summary + s_summaryCount, CompareSummary);
+}
+
+int Profiler::GetSummary(ProfileSummary * summary, int maxCount)
+{
+	int i, count;
+
+	count = s_summaryCount < maxCount ? s_summaryCount : maxCount;
+	for (i = 0; i < count; i++)
+	{
+		summary[i] = s_summary[i];
+	}
+
+	return count;
+}
+
+bool Profiler::WriteChromeTrace(const char * filename)
+{
+	std::ofstream fout;
+	ProfileThread* thread;
+	ProfileEvent event;
+	unsigned int written, first, i;
+	INT64 epoch;
+	int threadIndex;
+	bool firstEvent;
+
+	if (s_frequency.load(std::memory_order_acquire) == 0)
+	{
+		return false;
+	}
+
+	epoch = s_epoch.load(std::memory_order_relaxed);
+
+	fout.open(filename);
+	if (fout.fail())
+	{
+		return false;
+	}
+
+	// Complete events with the start and duration in microseconds since the profiler was first enabled.
+	fout << "{\"traceEvents\":[\n";
+
+	firstEvent = true;
+	fout.setf(std::ios::fixed);
+	fout.precision(3);
+
+	for (threadIndex = 0; threadIndex < s_threadCount; threadIndex++)
+	{
+		thread = s_threads[threadIndex];
+
+		written = thread->written.load(std::memory_order_acquire);
+		first = written > PROFILER_RING_SIZE ? written - PROFILER_RING_SIZE : 0;
+
+		// Zones the thread records meanwhile are left for the next trace, the ones it overwrites are dropped.
+		for (i = first; i < written; i++)
+		{
+			if (!ReadEvent(thread, i, event))
+			{
+				continue;
+			}
+
+			if (!firstEvent)
+			{
+				fout << ",\n";
+			}
+			firstEvent = false;
+
+			fout << "{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << thread->threadId;
+			fout << ",\"ts\":" << TicksToUs(event.start - epoch);
+			fout << ",\"dur\":" << TicksToUs(event.end - event.start) << "}";
+		}
+	}
+
+	fout << "\n]}\n";
+	fout.close();
+
+	return !fout.fail();
+}
+
+void Profiler::Shutdown()
+{
+	int i;
+
+	s_enabled = false;
+
+	std::lock_guard<std::mutex> lock(s_threadMutex);
+
+	for (i = 0; i < s_threadCount; i++)
+	{
+		delete s_threads[i];
+		s_threads[i] = 0;
+	}
+
+	s_threadCount = 0;
+	s_summaryCount = 0;
+	s_generation.fetch_add(1, std::memory_order_release);
+	t_thread = 0;
+}
+
+ProfileZone::ProfileZone(const char * name)
+{
+	ProfileThread* thread;
+
+	m_active = false;
+	if (!s_enabled.load(std::memory_order_relaxed))
+	{
+		return;
+	}
+
+	thread = GetThread();
+	if (!thread)
+	{
+		return;
+	}
+
+	m_name = name;
+	m_active = true;
+	thread->depth++;
+
+	QueryPerformanceCounter((LARGE_INTEGER*)&m_start);
+}
+
+ProfileZone::~ProfileZone()
+{
+	ProfileThread* thread;
+	ProfileSlot* slot;
+	unsigned int written;
+	INT64 end;
+
+	if (!m_active)
+	{
+		return;
+	}
+
+	QueryPerformanceCounter((LARGE_INTEGER*)&end);
+
+	// Zones are written when they end, so a parent always follows its children in the ring. The ring is the one
+	// the zone started in, Shutdown is not called while a zone is open.
+	thread = t_thread;
+	written = thread->written.load(std::memory_order_relaxed);
+
+	// Release stores, so a reader that sees one of them also sees the count of the zones before this one.
+	slot = &thread->events[written % PROFILER_RING_SIZE];
+	slot->name.store(m_name, std::memory_order_release);
+	slot->start.store(m_start, std::memory_order_release);
+	slot->end.store(end, std::memory_order_release);
+	slot->depth.store(thread->depth - 1, std::memory_order_release);
+
+	thread->depth--;
+	thread->written.store(written + 1, std::memory_order_release);
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include <Windows.h>
+#include "Util.h"
+
+// Builds without the profiler define this to 0, every zone macro then compiles to nothing.
+#ifndef PROFILER_ENABLED
+#define PROFILER_ENABLED 1
+#endif
+
+// Zones every thread keeps, the oldest are overwritten once a thread has recorded more.
+#define PROFILER_RING_SIZE 16384
+#define PROFILER_MAX_THREADS 16
+// Different zones in the per frame summary.
+#define PROFILER_MAX_SUMMARY 16
+
+// One finished zone, times are performance counter ticks.
+struct ProfileEvent
+{
+	const char* name;
+	INT64 start;
+	INT64 end;
+	int depth;
+};
+
+// Time of one zone over the last frame, summed over every thread and every time it was entered.
+struct ProfileSummary
+{
+	const char* name;
+	float time;
+	int calls;
+	int depth;
+};
+
+// Scoped zone profiler. Every thread records the zones it leaves into a ring of its own, so recording
+// needs no lock. The summary and the trace are read by one thread while the others keep recording, zones
+// a thread overwrites while they are read are left out.
+class Profiler
+{
+public:
+	// Recording starts disabled, a zone then only costs the check of this flag.
+	GRAPHIC_API static void SetEnabled(bool enabled);
+	GRAPHIC_API static bool IsEnabled();
+
+	// Closes the frame and builds the summary of the zones that ended during it.
+	GRAPHIC_API static void EndFrame();
+	// Returns the number of zones written to summary, most expensive first.
+	GRAPHIC_API static int GetSummary(ProfileSummary* summary, int maxCount);
+
+	// Writes every zone still in the rings as complete events of the chrome trace event format, which
+	// chrome://tracing and Perfetto open.
+	GRAPHIC_API static bool WriteChromeTrace(const char* filename);
+
+	// Frees the rings, no zone may be recorded afterwards.
+	GRAPHIC_API static void Shutdown();
+};
+
+// Records the time from its construction to its destruction as a zone. The name must outlive the profiler,
+// the zones keep the pointer and the summary groups zones by it.
+class ProfileZone
+{
+private:
+	const char* m_name;
+	INT64 m_start;
+	bool m_active;
+public:
+	GRAPHIC_API ProfileZone(const char* name);
+	GRAPHIC_API ~ProfileZone();
+};
+
+#if PROFILER_ENABLED
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_ZONE(name) ProfileZone PROFILE_CONCAT(profileZone, __LINE__)(name)
+#define PROFILE_FUNCTION() PROFILE_ZONE(__FUNCTION__)
+#else
+#define PROFILE_ZONE(name)
+#define PROFILE_FUNCTION()
+#endif
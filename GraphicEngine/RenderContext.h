@@ -0,0 +1,89 @@
+#pragma once
+#include <d3d11.h>
+#include "Stats.h"
+
+// Submission interface of the engine. Everything that would go to an ID3D11DeviceContext goes through
+// a RenderContext instead, so the same frame can be sent to Direct3D or to a backend that only counts
+// what it is given. The methods keep the names and arguments of the device context calls they stand for.
+// Every backend adds its draws, shader resource binds and maps to the Stats counters.
+class RenderContext
+{
+public:
+	virtual ~RenderContext() {}
+
+	virtual void Shutdown() = 0;
+
+	virtual void IASetInputLayout(ID3D11InputLayout* inputLayout) = 0;
+	virtual void IASetVertexBuffers(UINT startSlot, UINT bufferCount, ID3D11Buffer* const* vertexBuffers, const UINT* strides,
+		const UINT* offsets) = 0;
+	virtual void IASetIndexBuffer(ID3D11Buffer* indexBuffer, DXGI_FORMAT format, UINT offset) = 0;
+	virtual void IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY topology) = 0;
+
+	virtual void VSSetShader(ID3D11VertexShader* vertexShader, ID3D11ClassInstance* const* classInstances, UINT classInstanceCount) = 0;
+	virtual void VSSetConstantBuffers(UINT startSlot, UINT bufferCount, ID3D11Buffer* const* constantBuffers) = 0;
+	// Only available when SupportsConstantOffsets returns true.
+	virtual void VSSetConstantBuffers1(UINT startSlot, UINT bufferCount, ID3D11Buffer* const* constantBuffers, const UINT* firstConstants,
+		const UINT* constantCounts) = 0;
+
+	virtual void PSSetShader(ID3D11PixelShader* pixelShader, ID3D11ClassInstance* const* classInstances, UINT classInstanceCount) = 0;
+	virtual void PSSetConstantBuffers(UINT startSlot, UINT bufferCount, ID3D11Buffer* const* constantBuffers) = 0;
+	virtual void PSSetShaderResources(UINT startSlot, UINT viewCount, ID3D11ShaderResourceView* const* shaderResourceViews) = 0;
+	virtual void PSSetSamplers(UINT startSlot, UINT samplerCount, ID3D11SamplerState* const* samplers) = 0;
+
+	virtual void CSSetShader(ID3D11ComputeShader* computeShader, ID3D11ClassInstance* const* classInstances, UINT classInstanceCount) = 0;
+	virtual void CSSetConstantBuffers(UINT startSlot, UINT bufferCount, ID3D11Buffer* const* constantBuffers) = 0;
+	virtual void CSSetShaderResources(UINT startSlot, UINT viewCount, ID3D11ShaderResourceView* const* shaderResourceViews) = 0;
+	virtual void CSSetUnorderedAccessViews(UINT startSlot, UINT viewCount, ID3D11UnorderedAccessView* const* unorderedAccessViews,
+		const UINT* initialCounts) = 0;
+
+	virtual void OMSetRenderTargets(UINT viewCount, ID3D11RenderTargetView* const* renderTargetViews, ID3D11DepthStencilView* depthStencilView) = 0;
+	virtual void OMSetDepthStencilState(ID3D11DepthStencilState* depthStencilState, UINT stencilRef) = 0;
+	virtual void OMSetBlendState(ID3D11BlendState* blendState, const FLOAT blendFactor[4], UINT sampleMask) = 0;
+	virtual void RSSetState(ID3D11RasterizerState* rasterizerState) = 0;
+	virtual void RSSetViewports(UINT viewportCount, const D3D11_VIEWPORT* viewports) = 0;
+
+	// The get calls add a reference to every object they return, like the device context does.
+	virtual void OMGetRenderTargets(UINT viewCount, ID3D11RenderTargetView** renderTargetViews, ID3D11DepthStencilView** depthStencilView) = 0;
+	virtual void OMGetDepthStencilState(ID3D11DepthStencilState** depthStencilState, UINT* stencilRef) = 0;
+	virtual void OMGetBlendState(ID3D11BlendState** blendState, FLOAT blendFactor[4], UINT* sampleMask) = 0;
+	virtual void RSGetState(ID3D11RasterizerState** rasterizerState) = 0;
+	virtual void RSGetViewports(UINT* viewportCount, D3D11_VIEWPORT* viewports) = 0;
+
+	virtual void ClearRenderTargetView(ID3D11RenderTargetView* renderTargetView, const FLOAT color[4]) = 0;
+	virtual void ClearDepthStencilView(ID3D11DepthStencilView* depthStencilView, UINT clearFlags, FLOAT depth, UINT8 stencil) = 0;
+
+	virtual void DrawIndexed(UINT indexCount, UINT startIndex, INT baseVertex) = 0;
+	virtual void DrawIndexedInstanced(UINT indexCount, UINT instanceCount, UINT startIndex, INT baseVertex, UINT startInstance) = 0;
+	virtual void Dispatch(UINT groupCountX, UINT groupCountY, UINT groupCountZ) = 0;
+
+	virtual HRESULT Map(ID3D11Resource* resource, UINT subresource, D3D11_MAP mapType, UINT mapFlags, D3D11_MAPPED_SUBRESOURCE* mappedResource) = 0;
+	virtual void Unmap(ID3D11Resource* resource, UINT subresource) = 0;
+	virtual void UpdateSubresource(ID3D11Resource* resource, UINT subresource, const D3D11_BOX* box, const void* data, UINT rowPitch,
+		UINT depthPitch) = 0;
+	virtual void GenerateMips(ID3D11ShaderResourceView* shaderResourceView) = 0;
+
+	// Queries, GetData only works on the immediate context.
+	virtual void Begin(ID3D11Asynchronous* async) = 0;
+	virtual void End(ID3D11Asynchronous* async) = 0;
+	virtual HRESULT GetData(ID3D11Asynchronous* async, void* data, UINT dataSize, UINT getDataFlags) = 0;
+
+	virtual HRESULT FinishCommandList(BOOL restoreDeferredContextState, ID3D11CommandList** commandList) = 0;
+	virtual void ExecuteCommandList(ID3D11CommandList* commandList, BOOL restoreContextState) = 0;
+
+	// Creates a context of the same backend that records command lists for this one, or returns 0.
+	// The caller shuts it down and deletes it.
+	virtual RenderContext* CreateDeferredContext() = 0;
+
+	virtual bool SupportsConstantOffsets() = 0;
+};
+
+// The output of the frame, for passes that unbind it to read the depth buffer and bind it again afterwards.
+struct RenderTargets
+{
+	ID3D11RenderTargetView* renderTarget;
+	ID3D11DepthStencilView* depthStencil;
+	// The depth buffer as a shader input, only valid while it is not bound for output.
+	ID3D11ShaderResourceView* depthView;
+	// The regular depth test, passes that change it go back to this one.
+	ID3D11DepthStencilState* depthState;
+};
@@ -0,0 +1,210 @@
+#include "RenderQueue.h"
+#include "Profiler.h"
+
+#include <string.h>
+
+RenderQueue::RenderQueue()
+{
+	m_draws = 0;
+	m_items = 0;
+	m_scratch = 0;
+	m_maxDraws = 0;
+	m_drawCount = 0;
+}
+
+RenderQueue::RenderQueue(const RenderQueue & other)
+{
+}
+
+RenderQueue::~RenderQueue()
+{
+}
+
+bool RenderQueue::Initialize(int maxDraws)
+{
+	m_maxDraws = maxDraws;
+	m_drawCount = 0;
+
+	// Create the draw list and the two buffers the radix sort ping pongs between.
+	m_draws = new DrawCall[maxDraws];
+	if (!m_draws)
+	{
+		return false;
+	}
+
+	m_items = new SortItem[maxDraws];
+	if (!m_items)
+	{
+		return false;
+	}
+
+	m_scratch = new SortItem[maxDraws];
+	if (!m_scratch)
+	{
+		return false;
+	}
+
+	return true;
+}
+
+void RenderQueue::Shutdown()
+{
+	// Release the sort buffers.
+	if (m_scratch)
+	{
+		delete[] m_scratch;
+		m_scratch = 0;
+	}
+
+	if (m_items)
+	{
+		delete[] m_items;
+		m_items = 0;
+	}
+
+	// Release the draw list.
+	if (m_draws)
+	{
+		delete[] m_draws;
+		m_draws = 0;
+	}
+
+	m_maxDraws = 0;
+	m_drawCount = 0;
+}
+
+void RenderQueue::Clear()
+{
+	m_drawCount = 0;
+}
+
+bool RenderQueue::Add(const DrawCall & draw)
+{
+	if (m_drawCount >= m_maxDraws)
+	{
+		return false;
+	}
+
+	m_draws[m_drawCount] = draw;
+	m_items[m_drawCount].key = draw.key;
+	m_items[m_drawCount].index = m_drawCount;
+	m_drawCount++;
+
+	return true;
+}
+
+void RenderQueue::Sort()
+{
+	PROFILE_ZONE("RenderQueue::Sort");
+	unsigned int histograms[8][256];
+	unsigned int offset, count;
+	unsigned char digit;
+	SortItem* source;
+	SortItem* destination;
+	SortItem* swap;
+	int i, pass;
+
+	if (m_drawCount < 2)
+	{
+		return;
+	}
+
+	// Build the histograms of all eight digits in a single pass over the keys.
+	memset(histograms, 0, sizeof(histograms));
+	for (i = 0; i < m_drawCount; i++)
+	{
+		for (pass = 0; pass < 8; pass++)
+		{
+			histograms[pass][(m_items[i].key >> (pass * 8)) & 0xff]++;
+		}
+	}
+
+	source = m_items;
+	destination = m_scratch;
+
+	for (pass = 0; pass < 8; pass++)
+	{
+		// Skip the digit when every key has the same value in it, the order would not change.
+		digit = (unsigned char)((source[0].key >> (pass * 8)) & 0xff);
+		if (histograms[pass][digit] == (unsigned int)m_drawCount)
+		{
+			continue;
+		}
+
+		// Turn the counts into start offsets.
+		offset = 0;
+		for (i = 0; i < 256; i++)
+		{
+			count = histograms[pass][i];
+			histograms[pass][i] = offset;
+			offset += count;
+		}
+
+		// Scatter the items, keeping the order of equal digits so earlier passes stay sorted.
+		for (i = 0; i < m_drawCount; i++)
+		{
+			digit = (unsigned char)((source[i].key >> (pass * 8)) & 0xff);
+			destination[histograms[pass][digit]++] = source[i];
+		}
+
+		swap = source;
+		source = destination;
+		destination = swap;
+	}
+
+	// Make sure the sorted order ends up in the item list.
+	if (source != m_items)
+	{
+		memcpy(m_items, source, sizeof(SortItem) * m_drawCount);
+	}
+}
+
+int RenderQueue::GetDrawCount()
+{
+	return m_drawCount;
+}
+
+int RenderQueue::GetMaxDraws()
+{
+	return m_maxDraws;
+}
+
+const DrawCall & RenderQueue::GetDraw(int index)
+{
+	return m_draws[m_items[index].index];
+}
+
+unsigned long long RenderQueue::MakeKey(unsigned int layer, unsigned int shader, unsigned int mesh, unsigned int texture, float depth)
+{
+	unsigned long long key;
+	unsigned int depthBits;
+
+	// Quantize the depth, anything outside of the range is clamped. NaN fails every comparison and ends up at 0.
+	if (!(depth > 0.0f))
+	{
+		depth = 0.0f;
+	}
+	if (depth > 1.0f)
+	{
+		depth = 1.0f;
+	}
+	depthBits = (unsigned int)(depth * (float)((1 << RENDER_KEY_DEPTH_BITS) - 1));
+
+	key = (unsigned long long)(layer & ((1 << RENDER_KEY_LAYER_BITS) - 1));
+	key = (key << RENDER_KEY_SHADER_BITS) | (shader & ((1 << RENDER_KEY_SHADER_BITS) - 1));
+	key = (key << RENDER_KEY_MESH_BITS) | (mesh & ((1 << RENDER_KEY_MESH_BITS) - 1));
+	key = (key << RENDER_KEY_TEXTURE_BITS) | (texture & ((1 << RENDER_KEY_TEXTURE_BITS) - 1));
+	key = (key << RENDER_KEY_DEPTH_BITS) | depthBits;
+
+	return key;
+}
+
+unsigned int RenderQueue::GetKeyDepth(unsigned long long key)
+{
+	return (unsigned int)(key & ((1 << RENDER_KEY_DEPTH_BITS) - 1));
+}
+
+float RenderQueue::ComputeViewDepth(FXMVECTOR position, CXMMATRIX viewMatrix, float screenDepth)
+{
+	return XMVectorGetZ(XMVector3TransformCoord(position, viewMatrix)) / screenDepth;
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include <d3d11.h>
+#include <DirectXMath.h>
+using namespace DirectX;
+
+// Bit layout of a sort key, from the most to the least significant bits. The models have no materials beyond their
+// texture, so the draws of one mesh are grouped by the id of the mesh asset.
+#define RENDER_KEY_LAYER_BITS 4
+#define RENDER_KEY_SHADER_BITS 8
+#define RENDER_KEY_MESH_BITS 12
+#define RENDER_KEY_TEXTURE_BITS 16
+#define RENDER_KEY_DEPTH_BITS 24
+
+// The buffers a mesh is drawn from, the full vertex for shading and the positions alone for the depth pre-pass.
+// Whoever owns the mesh keeps them alive while its draws are queued, draws of the same mesh point to the same buffers.
+struct MeshBuffers
+{
+	ID3D11Buffer* vertexBuffer;
+	unsigned int vertexStride;
+	ID3D11Buffer* positionBuffer;
+	unsigned int positionStride;
+	ID3D11Buffer* indexBuffer;
+	DXGI_FORMAT indexFormat;
+};
+
+struct DrawCall
+{
+	unsigned long long key;
+	const MeshBuffers* mesh;
+	ID3D11ShaderResourceView* texture;
+	int indexCount;
+	XMFLOAT4X4 worldMatrix;
+	XMFLOAT4 color;
+};
+
+// Collects the draws of a frame and orders them by their 64 bit key so draws that share state
+// end up next to each other. The keys are sorted with an 8 bit LSD radix sort.
+class RenderQueue
+{
+private:
+	struct SortItem
+	{
+		unsigned long long key;
+		int index;
+	};
+
+	DrawCall* m_draws;
+	SortItem* m_items;
+	SortItem* m_scratch;
+	int m_maxDraws;
+	int m_drawCount;
+public:
+	RenderQueue();
+	RenderQueue(const RenderQueue&);
+	~RenderQueue();
+
+	bool Initialize(int maxDraws);
+	void Shutdown();
+
+	void Clear();
+	bool Add(const DrawCall& draw);
+	void Sort();
+
+	int GetDrawCount();
+	// Most draws the queue takes in one frame, Add fails beyond it.
+	int GetMaxDraws();
+	const DrawCall& GetDraw(int index);
+
+	// Depth is the view space distance mapped to [0, 1], nearer draws get smaller keys.
+	static unsigned long long MakeKey(unsigned int layer, unsigned int shader, unsigned int mesh, unsigned int texture, float depth);
+	static unsigned int GetKeyDepth(unsigned long long key);
+
+	// View space depth of a point mapped to [0, 1] by the far plane, computed while culling.
+	static float ComputeViewDepth(FXMVECTOR position, CXMMATRIX viewMatrix, float screenDepth);
+};
@@ -0,0 +1,237 @@
+#include "RenderStateCache.h"
+
+bool RenderStateCache::Changed(bool changed, int & counter)
+{
+	// Keep track of both the forwarded and the dropped calls.
+	if (changed)
+	{
+		m_counters.stateChanges++;
+		counter++;
+	}
+	else
+	{
+		m_counters.redundantChanges++;
+	}
+
+	return changed;
+}
+
+RenderStateCache::RenderStateCache()
+{
+	m_renderContext = 0;
+
+	Invalidate();
+	ResetCounters();
+}
+
+RenderStateCache::~RenderStateCache()
+{
+}
+
+void RenderStateCache::Initialize(RenderContext * renderContext)
+{
+	m_renderContext = renderContext;
+
+	Invalidate();
+	ResetCounters();
+}
+
+void RenderStateCache::Shutdown()
+{
+	// The render context belongs to whoever created it.
+	m_renderContext = 0;
+}
+
+void RenderStateCache::Invalidate()
+{
+	int i;
+
+	// Use an address that never belongs to a real object so the next set call always goes through.
+	m_inputLayout = (ID3D11InputLayout*)-1;
+	m_vertexShader = (ID3D11VertexShader*)-1;
+	m_pixelShader = (ID3D11PixelShader*)-1;
+	m_indexBuffer = (ID3D11Buffer*)-1;
+	m_indexFormat = DXGI_FORMAT_UNKNOWN;
+	m_topology = D3D11_PRIMITIVE_TOPOLOGY_UNDEFINED;
+
+	for (i = 0; i < STATE_CACHE_VERTEX_SLOTS; i++)
+	{
+		m_vertexBuffers[i] = (ID3D11Buffer*)-1;
+		m_vertexStrides[i] = 0;
+		m_vertexOffsets[i] = 0;
+	}
+
+	for (i = 0; i < STATE_CACHE_CONSTANT_SLOTS; i++)
+	{
+		m_vsConstantBuffers[i] = (ID3D11Buffer*)-1;
+		m_vsConstantFirst[i] = 0;
+		m_vsConstantCount[i] = 0;
+		m_psConstantBuffers[i] = (ID3D11Buffer*)-1;
+	}
+
+	for (i = 0; i < STATE_CACHE_RESOURCE_SLOTS; i++)
+	{
+		m_psResources[i] = (ID3D11ShaderResourceView*)-1;
+	}
+
+	for (i = 0; i < STATE_CACHE_SAMPLER_SLOTS; i++)
+	{
+		m_psSamplers[i] = (ID3D11SamplerState*)-1;
+	}
+}
+
+void RenderStateCache::ResetCounters()
+{
+	memset(&m_counters, 0, sizeof(m_counters));
+}
+
+void RenderStateCache::AddCounters(const RenderStateCounters & counters)
+{
+	m_counters.stateChanges += counters.stateChanges;
+	m_counters.redundantChanges += counters.redundantChanges;
+	m_counters.draws += counters.draws;
+
+	m_counters.inputLayoutChanges += counters.inputLayoutChanges;
+	m_counters.topologyChanges += counters.topologyChanges;
+	m_counters.shaderChanges += counters.shaderChanges;
+	m_counters.vertexBufferChanges += counters.vertexBufferChanges;
+	m_counters.indexBufferChanges += counters.indexBufferChanges;
+	m_counters.constantBufferChanges += counters.constantBufferChanges;
+	m_counters.resourceChanges += counters.resourceChanges;
+	m_counters.samplerChanges += counters.samplerChanges;
+}
+
+void RenderStateCache::SetInputLayout(ID3D11InputLayout * inputLayout)
+{
+	if (Changed(m_inputLayout != inputLayout, m_counters.inputLayoutChanges))
+	{
+		m_inputLayout = inputLayout;
+		m_renderContext->IASetInputLayout(inputLayout);
+	}
+}
+
+void RenderStateCache::SetVertexShader(ID3D11VertexShader * vertexShader)
+{
+	if (Changed(m_vertexShader != vertexShader, m_counters.shaderChanges))
+	{
+		m_vertexShader = vertexShader;
+		m_renderContext->VSSetShader(vertexShader, NULL, 0);
+	}
+}
+
+void RenderStateCache::SetPixelShader(ID3D11PixelShader * pixelShader)
+{
+	if (Changed(m_pixelShader != pixelShader, m_counters.shaderChanges))
+	{
+		m_pixelShader = pixelShader;
+		m_renderContext->PSSetShader(pixelShader, NULL, 0);
+	}
+}
+
+void RenderStateCache::SetVertexBuffer(unsigned int slot, ID3D11Buffer * vertexBuffer, unsigned int stride, unsigned int offset)
+{
+	if (Changed(m_vertexBuffers[slot] != vertexBuffer || m_vertexStrides[slot] != stride || m_vertexOffsets[slot] != offset, m_counters.vertexBufferChanges))
+	{
+		m_vertexBuffers[slot] = vertexBuffer;
+		m_vertexStrides[slot] = stride;
+		m_vertexOffsets[slot] = offset;
+		m_renderContext->IASetVertexBuffers(slot, 1, &vertexBuffer, &stride, &offset);
+	}
+}
+
+void RenderStateCache::SetIndexBuffer(ID3D11Buffer * indexBuffer, DXGI_FORMAT format)
+{
+	if (Changed(m_indexBuffer != indexBuffer || m_indexFormat != format, m_counters.indexBufferChanges))
+	{
+		m_indexBuffer = indexBuffer;
+		m_indexFormat = format;
+		m_renderContext->IASetIndexBuffer(indexBuffer, format, 0);
+	}
+}
+
+void RenderStateCache::SetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY topology)
+{
+	if (Changed(m_topology != topology, m_counters.topologyChanges))
+	{
+		m_topology = topology;
+		m_renderContext->IASetPrimitiveTopology(topology);
+	}
+}
+
+void RenderStateCache::SetVSConstantBuffer(unsigned int slot, ID3D11Buffer * buffer)
+{
+	// A count of zero stands for the whole buffer.
+	if (Changed(m_vsConstantBuffers[slot] != buffer || m_vsConstantCount[slot] != 0, m_counters.constantBufferChanges))
+	{
+		m_vsConstantBuffers[slot] = buffer;
+		m_vsConstantFirst[slot] = 0;
+		m_vsConstantCount[slot] = 0;
+		m_renderContext->VSSetConstantBuffers(slot, 1, &buffer);
+	}
+}
+
+void RenderStateCache::SetVSConstantBufferRange(unsigned int slot, ID3D11Buffer * buffer, unsigned int firstConstant, unsigned int constantCount)
+{
+	if (Changed(m_vsConstantBuffers[slot] != buffer || m_vsConstantFirst[slot] != firstConstant || m_vsConstantCount[slot] != constantCount,
+		m_counters.constantBufferChanges))
+	{
+		m_vsConstantBuffers[slot] = buffer;
+		m_vsConstantFirst[slot] = firstConstant;
+		m_vsConstantCount[slot] = constantCount;
+		m_renderContext->VSSetConstantBuffers1(slot, 1, &buffer, &firstConstant, &constantCount);
+	}
+}
+
+void RenderStateCache::SetPSConstantBuffer(unsigned int slot, ID3D11Buffer * buffer)
+{
+	if (Changed(m_psConstantBuffers[slot] != buffer, m_counters.constantBufferChanges))
+	{
+		m_psConstantBuffers[slot] = buffer;
+		m_renderContext->PSSetConstantBuffers(slot, 1, &buffer);
+	}
+}
+
+void RenderStateCache::SetPSShaderResource(unsigned int slot, ID3D11ShaderResourceView * resource)
+{
+	if (Changed(m_psResources[slot] != resource, m_counters.resourceChanges))
+	{
+		m_psResources[slot] = resource;
+		m_renderContext->PSSetShaderResources(slot, 1, &resource);
+	}
+}
+
+void RenderStateCache::SetPSSampler(unsigned int slot, ID3D11SamplerState * sampler)
+{
+	if (Changed(m_psSamplers[slot] != sampler, m_counters.samplerChanges))
+	{
+		m_psSamplers[slot] = sampler;
+		m_renderContext->PSSetSamplers(slot, 1, &sampler);
+	}
+}
+
+void RenderStateCache::DrawIndexed(unsigned int indexCount, unsigned int startIndex, int baseVertex)
+{
+	m_counters.draws++;
+	m_renderContext->DrawIndexed(indexCount, startIndex, baseVertex);
+}
+
+void RenderStateCache::DrawIndexedInstanced(unsigned int indexCount, unsigned int instanceCount, unsigned int startIndex, int baseVertex, unsigned int startInstance)
+{
+	m_counters.draws++;
+	m_renderContext->DrawIndexedInstanced(indexCount, instanceCount, startIndex, baseVertex, startInstance);
+}
+
+RenderContext * RenderStateCache::GetRenderContext()
+{
+	return m_renderContext;
+}
+
+bool RenderStateCache::SupportsConstantOffsets()
+{
+	return m_renderContext->SupportsConstantOffsets();
+}
+
+const RenderStateCounters & RenderStateCache::GetCounters()
+{
+	return m_counters;
+}
@@ -0,0 +1,88 @@
+#pragma once
+#include <d3d11.h>
+#include <string.h>
+#include "RenderContext.h"
+
+#define STATE_CACHE_VERTEX_SLOTS 2
+#define STATE_CACHE_CONSTANT_SLOTS 4
+#define STATE_CACHE_RESOURCE_SLOTS 8
+#define STATE_CACHE_SAMPLER_SLOTS 4
+
+// Counts how many pipeline state calls reached the render context and how many were dropped
+// because the same state was already bound.
+struct RenderStateCounters
+{
+	int stateChanges;
+	int redundantChanges;
+	int draws;
+
+	int inputLayoutChanges;
+	int topologyChanges;
+	int shaderChanges;
+	int vertexBufferChanges;
+	int indexBufferChanges;
+	int constantBufferChanges;
+	int resourceChanges;
+	int samplerChanges;
+};
+
+// Submission layer in front of the render context. Every set call is compared with the state
+// that is already bound and only forwarded when something actually changes.
+class RenderStateCache
+{
+private:
+	RenderContext* m_renderContext;
+
+	ID3D11InputLayout* m_inputLayout;
+	ID3D11VertexShader* m_vertexShader;
+	ID3D11PixelShader* m_pixelShader;
+	ID3D11Buffer* m_vertexBuffers[STATE_CACHE_VERTEX_SLOTS];
+	unsigned int m_vertexStrides[STATE_CACHE_VERTEX_SLOTS];
+	unsigned int m_vertexOffsets[STATE_CACHE_VERTEX_SLOTS];
+	ID3D11Buffer* m_indexBuffer;
+	DXGI_FORMAT m_indexFormat;
+	D3D11_PRIMITIVE_TOPOLOGY m_topology;
+	ID3D11Buffer* m_vsConstantBuffers[STATE_CACHE_CONSTANT_SLOTS];
+	unsigned int m_vsConstantFirst[STATE_CACHE_CONSTANT_SLOTS];
+	unsigned int m_vsConstantCount[STATE_CACHE_CONSTANT_SLOTS];
+	ID3D11Buffer* m_psConstantBuffers[STATE_CACHE_CONSTANT_SLOTS];
+	ID3D11ShaderResourceView* m_psResources[STATE_CACHE_RESOURCE_SLOTS];
+	ID3D11SamplerState* m_psSamplers[STATE_CACHE_SAMPLER_SLOTS];
+
+	RenderStateCounters m_counters;
+
+	bool Changed(bool changed, int& counter);
+public:
+	RenderStateCache();
+	~RenderStateCache();
+
+	void Initialize(RenderContext* renderContext);
+	void Shutdown();
+
+	// Forget the bound state, needed after anything else has used the render context directly.
+	void Invalidate();
+	void ResetCounters();
+	// Adds the counters of another cache, used for the caches of deferred contexts.
+	void AddCounters(const RenderStateCounters& counters);
+
+	void SetInputLayout(ID3D11InputLayout* inputLayout);
+	void SetVertexShader(ID3D11VertexShader* vertexShader);
+	void SetPixelShader(ID3D11PixelShader* pixelShader);
+	void SetVertexBuffer(unsigned int slot, ID3D11Buffer* vertexBuffer, unsigned int stride, unsigned int offset);
+	void SetIndexBuffer(ID3D11Buffer* indexBuffer, DXGI_FORMAT format);
+	void SetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY topology);
+	void SetVSConstantBuffer(unsigned int slot, ID3D11Buffer* buffer);
+	// Binds constants [firstConstant, firstConstant + constantCount) of a larger buffer, both multiples of 16.
+	// Needs a context that supports offsets, see SupportsConstantOffsets.
+	void SetVSConstantBufferRange(unsigned int slot, ID3D11Buffer* buffer, unsigned int firstConstant, unsigned int constantCount);
+	void SetPSConstantBuffer(unsigned int slot, ID3D11Buffer* buffer);
+	void SetPSShaderResource(unsigned int slot, ID3D11ShaderResourceView* resource);
+	void SetPSSampler(unsigned int slot, ID3D11SamplerState* sampler);
+
+	void DrawIndexed(unsigned int indexCount, unsigned int startIndex, int baseVertex);
+	void DrawIndexedInstanced(unsigned int indexCount, unsigned int instanceCount, unsigned int startIndex, int baseVertex, unsigned int startInstance);
+
+	RenderContext* GetRenderContext();
+	bool SupportsConstantOffsets();
+	const RenderStateCounters& GetCounters();
+};
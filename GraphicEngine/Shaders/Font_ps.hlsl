@@ -2,39 +2,29 @@
 Texture2D shaderTexture;
 SamplerState SampleType;
 
-cbuffer PixelBuffer
-{
-    float4 pixelColor;
-};
-
 //TYPEDEFS
 
 struct PixelInputType
 {
     float4 position : SV_POSITION;
     float2 tex : TEXCOORD0;
+    float4 color : COLOR;
 };
 
 float4 FontPixelShader(PixelInputType input) : SV_Target
 {
-    float4 color;
+    float distance;
+    float width;
+    float alpha;
 	
 	
-    // Sample the texture pixel at this location.
-    color = shaderTexture.Sample(SampleType, input.tex);
+    // The atlas holds the distance to the outline, 0.5 is the edge and larger values are inside.
+    distance = shaderTexture.Sample(SampleType, input.tex).r;
 	
-    // If the color is black on the texture then treat this pixel as transparent.
-    if (color.r == 0.0f)
-    {
-        color.a = 0.0f;
-    }
+    // Blend across about one screen pixel around the edge, whatever size the text is drawn at.
+    width = max(fwidth(distance) * 0.7f, 0.001f);
+    alpha = smoothstep(0.5f - width, 0.5f + width, distance) * input.color.a;
 	
-    // If the color is other than black on the texture then this is a pixel in the font so draw it using the font pixel color.
-    else
-    {
-        color.a = 1.0f;
-        color = color * pixelColor;
-    }
-
-    return color;
+    // The blend state expects premultiplied alpha.
+    return float4(input.color.rgb * alpha, alpha);
 }
\ No newline at end of file
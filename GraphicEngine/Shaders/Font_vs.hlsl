@@ -11,12 +11,14 @@ struct vertexInputType
 {
     float4 position : POSITION;
     float2 tex : TEXCOORD0;
+    float4 color : COLOR;
 };
 
 struct PixelInputType
 {
     float4 position : SV_POSITION;
     float2 tex : TEXCOORD0;
+    float4 color : COLOR;
 };
 
 PixelInputType FontVertexShader(vertexInputType input)
@@ -33,6 +35,9 @@ PixelInputType FontVertexShader(vertexInputType input)
     
     // Store the texture coordinates for the pixel shader.
     output.tex = input.tex;
+
+    // Every string brings its own color, so all of them can be drawn at once.
+    output.color = input.color;
     
     return output;
 }
\ No newline at end of file
@@ -0,0 +1,59 @@
+//GLOBALS
+//Same buffers as light_vs.hlsl, the depth has to come out bit for bit the same for the EQUAL depth test
+cbuffer FrameBuffer : register(b0)
+{
+    matrix viewMatrix;
+    matrix projectionMatrix;
+    float3 cameraPosition;
+    float padding;
+};
+
+cbuffer ObjectBuffer : register(b1)
+{
+    matrix worldMatrix;
+    float4 objectColor;
+};
+
+//TYPEDEFS
+struct VertexInputType
+{
+    float3 position : POSITION;
+};
+
+struct InstancedVertexInputType
+{
+    float3 position : POSITION;
+
+    //Per instance data, the rows of the world matrix
+    float4 world0 : WORLD0;
+    float4 world1 : WORLD1;
+    float4 world2 : WORLD2;
+    float4 world3 : WORLD3;
+};
+
+//Vertex Shader for single draws, matches LightVertexShader in light_vs.hlsl
+float4 DepthVertexShader(VertexInputType input) : SV_Position
+{
+    precise float4 position;
+
+    position = mul(float4(input.position, 1.0f), worldMatrix);
+    position = mul(position, viewMatrix);
+    position = mul(position, projectionMatrix);
+
+    return position;
+}
+
+//Vertex Shader for instanced draws, matches LightVertexShader in light_instanced_vs.hlsl
+float4 DepthInstancedVertexShader(InstancedVertexInputType input) : SV_Position
+{
+    precise float4 position;
+    float4x4 instanceWorld;
+
+    instanceWorld = float4x4(input.world0, input.world1, input.world2, input.world3);
+
+    position = mul(float4(input.position, 1.0f), instanceWorld);
+    position = mul(position, viewMatrix);
+    position = mul(position, projectionMatrix);
+
+    return position;
+}
\ No newline at end of file
@@ -0,0 +1,21 @@
+//Shared by the light culling compute shader and the light pixel shader, has to match LightCulling.h
+#define TILE_SIZE 16
+#define MAX_LIGHTS_PER_TILE 255
+
+//Every tile owns TILE_STRIDE indices, the light count first and then the light indices
+#define TILE_STRIDE (MAX_LIGHTS_PER_TILE + 1)
+
+//Clustered light assignment, has to match LightClusters.h
+#define CLUSTER_TILE_SIZE 64
+#define CLUSTER_SLICES 16
+
+//Spot lights share the layout, point lights have a spotCosine of -1
+struct PointLight
+{
+    float3 position;
+    float range;
+    float3 color;
+    float intensity;
+    float3 direction;
+    float spotCosine;
+};
\ No newline at end of file
@@ -0,0 +1,110 @@
+#include "forward_plus.hlsli"
+
+//GLOBALS
+cbuffer CullBuffer : register(b0)
+{
+    matrix viewMatrix;
+    float4 projection;
+    uint lightCount;
+    uint tilesX;
+    uint screenWidth;
+    uint screenHeight;
+};
+
+Texture2D<float> depthTexture : register(t0);
+StructuredBuffer<PointLight> pointLights : register(t1);
+RWStructuredBuffer<uint> tileLightIndices : register(u0);
+
+groupshared uint tileMinDepth;
+groupshared uint tileMaxDepth;
+groupshared uint tileLightCount;
+groupshared uint tileLights[MAX_LIGHTS_PER_TILE];
+
+float ViewDepth(float depth)
+{
+    //Inverse of depth = _33 + _43 / z
+    return projection.w / (depth - projection.z);
+}
+
+//Compute Shader
+[numthreads(TILE_SIZE, TILE_SIZE, 1)]
+void LightCullComputeShader(uint3 groupId : SV_GroupID, uint3 dispatchId : SV_DispatchThreadID, uint threadIndex : SV_GroupIndex)
+{
+    float depth, minDepth, maxDepth, left, right, top, bottom;
+    float3 planes[4];
+    float3 center;
+    uint i, slot, count, tileOffset;
+    bool inside;
+
+    if (threadIndex == 0)
+    {
+        tileMinDepth = asuint(1.0f);
+        tileMaxDepth = 0;
+        tileLightCount = 0;
+    }
+
+    GroupMemoryBarrierWithGroupSync();
+
+    //Positive floats keep their order as integers so the depth bounds can be found with atomics
+    if (dispatchId.x < screenWidth && dispatchId.y < screenHeight)
+    {
+        depth = depthTexture.Load(int3(dispatchId.xy, 0));
+
+        InterlockedMin(tileMinDepth, asuint(depth));
+        InterlockedMax(tileMaxDepth, asuint(depth));
+    }
+
+    GroupMemoryBarrierWithGroupSync();
+
+    minDepth = ViewDepth(asfloat(tileMinDepth));
+    maxDepth = ViewDepth(asfloat(tileMaxDepth));
+
+    //Edges of the tile in normalized device coordinates
+    left = (float)(groupId.x * TILE_SIZE) / (float)screenWidth * 2.0f - 1.0f;
+    right = (float)((groupId.x + 1) * TILE_SIZE) / (float)screenWidth * 2.0f - 1.0f;
+    top = 1.0f - (float)(groupId.y * TILE_SIZE) / (float)screenHeight * 2.0f;
+    bottom = 1.0f - (float)((groupId.y + 1) * TILE_SIZE) / (float)screenHeight * 2.0f;
+
+    //Side planes of the tile frustum, they all go through the camera
+    planes[0] = normalize(float3(projection.x, 0.0f, -left));
+    planes[1] = normalize(float3(-projection.x, 0.0f, right));
+    planes[2] = normalize(float3(0.0f, projection.y, -bottom));
+    planes[3] = normalize(float3(0.0f, -projection.y, top));
+
+    //Every thread of the tile tests a share of the lights
+    for (i = threadIndex; i < lightCount; i += TILE_SIZE * TILE_SIZE)
+    {
+        center = mul(float4(pointLights[i].position, 1.0f), viewMatrix).xyz;
+
+        inside = center.z + pointLights[i].range >= minDepth && center.z - pointLights[i].range <= maxDepth;
+        inside = inside && dot(planes[0], center) >= -pointLights[i].range;
+        inside = inside && dot(planes[1], center) >= -pointLights[i].range;
+        inside = inside && dot(planes[2], center) >= -pointLights[i].range;
+        inside = inside && dot(planes[3], center) >= -pointLights[i].range;
+
+        if (inside)
+        {
+            InterlockedAdd(tileLightCount, 1, slot);
+            if (slot < MAX_LIGHTS_PER_TILE)
+            {
+                tileLights[slot] = i;
+            }
+        }
+    }
+
+    GroupMemoryBarrierWithGroupSync();
+
+    //Write the light list of the tile out
+    tileOffset = (groupId.y * tilesX + groupId.x) * TILE_STRIDE;
+    count = min(tileLightCount, MAX_LIGHTS_PER_TILE);
+
+    if (threadIndex == 0)
+    {
+        tileLightIndices[tileOffset] = count;
+    }
+
+    for (i = threadIndex; i < count; i += TILE_SIZE * TILE_SIZE)
+    {
+        tileLightIndices[tileOffset + 1 + i] = tileLights[i];
+    }
+}
\ No newline at end of file
@@ -0,0 +1,77 @@
+//GLOBALS
+//Written once per frame
+cbuffer FrameBuffer : register(b0)
+{
+    matrix viewMatrix;
+    matrix projectionMatrix;
+    float3 cameraPosition;
+    float padding;
+};
+
+//TYPEDEFS
+struct VertexInputType
+{
+    float4 position : POSITION;
+    float2 tex : TEXCOORD0;
+    float3 normal : NORMAL;
+
+    //Per instance data, the rows of the world matrix and a color
+    float4 world0 : WORLD0;
+    float4 world1 : WORLD1;
+    float4 world2 : WORLD2;
+    float4 world3 : WORLD3;
+    float4 color : COLOR;
+};
+
+struct PixelInputType
+{
+    float4 position : SV_Position;
+    float2 tex : TEXCOORD0;
+    float3 normal : NORMAL;
+    float3 viewDirection : TEXCOORD1;
+    float3 worldPosition : TEXCOORD2;
+    float4 color : COLOR;
+};
+
+//Vertex Shader
+PixelInputType LightVertexShader(VertexInputType input)
+{
+    PixelInputType output;
+    precise float4 worldPosition;
+    precise float4 position;
+    float4x4 instanceWorld;
+
+    //Build the world matrix of this instance, there is no per object constant buffer
+    instanceWorld = float4x4(input.world0, input.world1, input.world2, input.world3);
+
+    //Change the position vector to be 4 units for proper matrix calculations.
+    input.position.w = 1.0f;
+
+    //Calculate the position of the vertex in the world
+    worldPosition = mul(input.position, instanceWorld);
+
+    //Calcualte the postion of the vertex against the view and projection matrices.
+    //Precise keeps the math the same as in depth_vs.hlsl so the depth pre-pass matches.
+    position = mul(worldPosition, viewMatrix);
+    position = mul(position, projectionMatrix);
+    output.position = position;
+
+    //Store the texture coordinates for the pixel shader
+    output.tex = input.tex;
+
+    //Calcuate the normal vector against the world matrix only and normalize it.
+    output.normal = mul(input.normal, (float3x3)instanceWorld);
+    output.normal = normalize(output.normal);
+
+    //Determine the viewing direction based on the position of the camera and the position of the vertex in the world
+    output.viewDirection = cameraPosition.xyz - worldPosition.xyz;
+    output.viewDirection = normalize(output.viewDirection);
+
+    //Keep the world position for the point lights
+    output.worldPosition = worldPosition.xyz;
+
+    //Pass the instance color on to the pixel shader
+    output.color = input.color;
+
+    return output;
+}
\ No newline at end of file
@@ -1,8 +1,18 @@
+#include "forward_plus.hlsli"
+
 //GLOBALS
-Texture2D shaderTexture;
-SamplerState SampleType;
+Texture2D shaderTexture : register(t0);
+SamplerState SampleType : register(s0);
+
+//Point lights and the per tile light lists written by the light culling pass
+StructuredBuffer<PointLight> pointLights : register(t1);
+StructuredBuffer<uint> tileLightIndices : register(t2);
 
-cbuffer LightBuffer
+//Offset and count of every cluster and the light indices they point into, built on the cpu
+StructuredBuffer<uint2> clusterRanges : register(t3);
+StructuredBuffer<uint> clusterLightIndices : register(t4);
+
+cbuffer LightBuffer : register(b0)
 {
     float4 ambientColor;
     //-------------------------- ( 16 bytes )
@@ -15,6 +25,18 @@ cbuffer LightBuffer
     //-------------------------- ( 16 bytes )
 };  //-------------------------- ( 16 * 4 = 64 bytes )
 
+cbuffer TileBuffer : register(b1)
+{
+    uint tilesX;
+    uint clusterTilesX;
+    uint clusterTilesY;
+    float tilePadding;
+    //-------------------------- ( 16 bytes )
+    float2 sliceParameters;
+    float2 slicePadding;
+    //-------------------------- ( 16 bytes )
+};
+
 //TYPEDEFS
 struct PixelInputType
 {
@@ -22,8 +44,34 @@ struct PixelInputType
     float2 tex : TEXCOORD0;
     float3 normal : NORMAL;
     float3 viewDirection : TEXCOORD1;
+    float3 worldPosition : TEXCOORD2;
+    float4 color : COLOR;
 };
 
+//Light a pixel with one point or spot light
+float3 ShadePointLight(PointLight light, PixelInputType input)
+{
+    float3 toLight;
+    float lightDistance;
+    float attenuation;
+
+    toLight = light.position - input.worldPosition;
+    lightDistance = length(toLight);
+    toLight = toLight / lightDistance;
+
+    //Fade the light out towards the edge of its range
+    attenuation = saturate(1.0f - lightDistance / light.range);
+    attenuation = attenuation * attenuation;
+
+    //Fade spot lights out towards the edge of their cone
+    if (light.spotCosine > -1.0f)
+    {
+        attenuation *= smoothstep(light.spotCosine, lerp(light.spotCosine, 1.0f, 0.2f), dot(-toLight, light.direction));
+    }
+
+    return light.color * light.intensity * attenuation * saturate(dot(input.normal, toLight));
+}
+
 //Pixel Shader
 float4 LightPixelShader(PixelInputType input) : SV_Target
 {
@@ -33,6 +81,16 @@ float4 LightPixelShader(PixelInputType input) : SV_Target
     float4 color;
     float3 reflection;
     float4 specular;
+    float3 pointColor;
+    uint2 tile;
+    uint i;
+#ifdef CLUSTERED
+    uint slice;
+    uint2 clusterRange;
+#else
+    uint tileOffset;
+    uint tileLightCount;
+#endif
 
     //Sample the pixel color from the texture using the sampler at this texture coordinate location
     textureColor = shaderTexture.Sample(SampleType, input.tex);
@@ -64,7 +122,33 @@ float4 LightPixelShader(PixelInputType input) : SV_Target
         specular = pow(saturate(dot(reflection, input.viewDirection)), specularPower);
     }
 
-    color = color * textureColor;
+    pointColor = float3(0.0f, 0.0f, 0.0f);
+
+#ifdef CLUSTERED
+    //Find the cluster of this pixel, the depth slices are spaced logarithmically between the near and far plane
+    tile = uint2(input.position.xy) / CLUSTER_TILE_SIZE;
+    slice = (uint)clamp(floor(log2(input.position.w) * sliceParameters.x + sliceParameters.y), 0.0f, CLUSTER_SLICES - 1.0f);
+    clusterRange = clusterRanges[(slice * clusterTilesY + tile.y) * clusterTilesX + tile.x];
+
+    for (i = 0; i < clusterRange.y; i++)
+    {
+        pointColor += ShadePointLight(pointLights[clusterLightIndices[clusterRange.x + i]], input);
+    }
+#else
+    //Add the point lights the culling pass found for the tile of this pixel
+    tile = uint2(input.position.xy) / TILE_SIZE;
+    tileOffset = (tile.y * tilesX + tile.x) * TILE_STRIDE;
+    tileLightCount = tileLightIndices[tileOffset];
+
+    for (i = 0; i < tileLightCount; i++)
+    {
+        pointColor += ShadePointLight(pointLights[tileLightIndices[tileOffset + 1 + i]], input);
+    }
+#endif
+
+    color = saturate(color + float4(pointColor, 0.0f));
+
+    color = color * textureColor * input.color;
 
     //Satureate the final color
     color = saturate(color + specular);
@@ -1,15 +1,18 @@
 //GLOBALS
-cbuffer MatrixBuffer
+//Written once per frame
+cbuffer FrameBuffer : register(b0)
 {
-    matrix worldMatrix;
     matrix viewMatrix;
     matrix projectionMatrix;
+    float3 cameraPosition;
+    float padding;
 };
 
-cbuffer CameraBuffer
+//Written per object into the constant ring
+cbuffer ObjectBuffer : register(b1)
 {
-    float3 cameraPosition;
-    float padding;
+    matrix worldMatrix;
+    float4 objectColor;
 };
 
 //TYPEDEFS
@@ -26,6 +29,8 @@ struct PixelInputType
     float2 tex : TEXCOORD0;
     float3 normal : NORMAL;
     float3 viewDirection : TEXCOORD1;
+    float3 worldPosition : TEXCOORD2;
+    float4 color : COLOR;
 };
 
 //Vertex Shader
@@ -33,14 +38,17 @@ PixelInputType LightVertexShader(VertexInputType input)
 {
     PixelInputType output;
     float4 worldPosition;
+    precise float4 position;
 
     //Change the position vector to be 4 units for proper matrix calculations.
     input.position.w = 1.0f;
 
     //Calcualte the postion of the vertex against the world, view and projection matrices.
-    output.position = mul(input.position, worldMatrix);
-    output.position = mul(output.position, viewMatrix);
-    output.position = mul(output.position, projectionMatrix);
+    //Precise keeps the math the same as in depth_vs.hlsl so the depth pre-pass matches.
+    position = mul(input.position, worldMatrix);
+    position = mul(position, viewMatrix);
+    position = mul(position, projectionMatrix);
+    output.position = position;
 
     //Store the texture coordinates for the pixel shader
     output.tex = input.tex;
@@ -60,5 +68,11 @@ PixelInputType LightVertexShader(VertexInputType input)
     //Normalize the viewing direction vector
     output.viewDirection = normalize(output.viewDirection);
 
+    //Keep the world position for the point lights
+    output.worldPosition = worldPosition.xyz;
+
+    //Pass the object color on to the pixel shader
+    output.color = objectColor;
+
     return output;
 }
\ No newline at end of file
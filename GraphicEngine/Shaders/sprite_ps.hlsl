@@ -0,0 +1,20 @@
+Texture2D shaderTexture;
+SamplerState SampleType;
+
+struct PixelInputType
+{
+    float4 position : SV_POSITION;
+    float2 tex : TEXCOORD0;
+    float4 color : COLOR;
+};
+
+float4 SpritePixelShader(PixelInputType input) : SV_TARGET
+{
+    float4 textureColor;
+
+    //Sample the texture and tint it with the color of the sprite
+    textureColor = shaderTexture.Sample(SampleType, input.tex) * input.color;
+
+    // The blend state expects premultiplied alpha.
+    return float4(textureColor.rgb * textureColor.a, textureColor.a);
+}
\ No newline at end of file
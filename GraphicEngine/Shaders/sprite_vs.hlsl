@@ -0,0 +1,43 @@
+//GLOBALS
+cbuffer perFrameBuffer
+{
+    matrix worldMatrix;
+    matrix viewMatrix;
+    matrix projectionMatrix;
+};
+
+//TYPEDEFS
+struct vertexInputType
+{
+    float4 position : POSITION;
+    float2 tex : TEXCOORD0;
+    float4 color : COLOR;
+};
+
+struct PixelInputType
+{
+    float4 position : SV_POSITION;
+    float2 tex : TEXCOORD0;
+    float4 color : COLOR;
+};
+
+PixelInputType SpriteVertexShader(vertexInputType input)
+{
+    PixelInputType output;
+
+    //Change the position vector to be 4 units of matrix calculations
+    input.position.w = 1.0f;
+
+    // Calculate the position of the vertex against the world, view, and projection matrices.
+    output.position = mul(input.position, worldMatrix);
+    output.position = mul(output.position, viewMatrix);
+    output.position = mul(output.position, projectionMatrix);
+    
+    // Store the texture coordinates for the pixel shader.
+    output.tex = input.tex;
+
+    // Every sprite brings its own tint, so sprites of one texture can be drawn at once.
+    output.color = input.color;
+    
+    return output;
+}
\ No newline at end of file
@@ -0,0 +1,246 @@
+#include "SpriteBatch.h"
+
+SpriteBatch::SpriteBatch()
+{
+	m_Shader = 0;
+	m_vertexBuffer = 0;
+	m_indexBuffer = 0;
+	m_vertices = 0;
+	m_maxSprites = 0;
+	m_ringVertices = 0;
+	m_head = 0;
+	m_screenWidth = 0;
+	m_screenHeight = 0;
+}
+
+SpriteBatch::SpriteBatch(const SpriteBatch & other)
+{
+}
+
+SpriteBatch::~SpriteBatch()
+{
+}
+
+bool SpriteBatch::Initialize(ID3D11Device * device, HWND hwnd, int screenWidth, int screenHeight, int maxSprites)
+{
+	unsigned short* indices;
+	D3D11_BUFFER_DESC vertexBufferDesc, indexBufferDesc;
+	D3D11_SUBRESOURCE_DATA indexData;
+	HRESULT hresult;
+	bool result;
+
+	// The indices are 16 bit and always start at the base vertex of the upload.
+	if (maxSprites <= 0 || maxSprites * TEXT_QUAD_VERTICES > 65536)
+	{
+		return false;
+	}
+
+	m_screenWidth = screenWidth;
+	m_screenHeight = screenHeight;
+	m_maxSprites = maxSprites;
+
+	m_list.Initialize(maxSprites);
+
+	// Create the sprite shader.
+	m_Shader = new SpriteShader;
+	if (!m_Shader)
+	{
+		return false;
+	}
+
+	result = m_Shader->Initialize(device, hwnd);
+	if (!result)
+	{
+		return false;
+	}
+
+	// The quads are built here and copied to the ring in one go.
+	m_vertices = new TextVertex[maxSprites * TEXT_QUAD_VERTICES];
+	if (!m_vertices)
+	{
+		return false;
+	}
+
+	// Leave room for a few frames of sprites before the ring has to discard.
+	m_ringVertices = maxSprites * TEXT_QUAD_VERTICES * SPRITE_BATCH_RING_FRAMES;
+
+	vertexBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+	vertexBufferDesc.ByteWidth = sizeof(TextVertex) * m_ringVertices;
+	vertexBufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+	vertexBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+	vertexBufferDesc.MiscFlags = 0;
+	vertexBufferDesc.StructureByteStride = 0;
+
+	hresult = device->CreateBuffer(&vertexBufferDesc, NULL, &m_vertexBuffer);
+	if (FAILED(hresult))
+	{
+		return false;
+	}
+
+	// Put the head at the end so the first upload discards.
+	m_head = m_ringVertices;
+
+	// Every quad uses the same pattern, so one index buffer covers every run.
+	indices = new unsigned short[maxSprites * TEXT_QUAD_INDICES];
+	if (!indices)
+	{
+		return false;
+	}
+
+	BuildQuadIndices(indices, maxSprites);
+
+	indexBufferDesc.Usage = D3D11_USAGE_IMMUTABLE;
+	indexBufferDesc.ByteWidth = sizeof(unsigned short) * maxSprites * TEXT_QUAD_INDICES;
+	indexBufferDesc.BindFlags = D3D11_BIND_INDEX_BUFFER;
+	indexBufferDesc.CPUAccessFlags = 0;
+	indexBufferDesc.MiscFlags = 0;
+	indexBufferDesc.StructureByteStride = 0;
+
+	indexData.pSysMem = indices;
+	indexData.SysMemPitch = 0;
+	indexData.SysMemSlicePitch = 0;
+
+	hresult = device->CreateBuffer(&indexBufferDesc, &indexData, &m_indexBuffer);
+
+	delete[] indices;
+	indices = 0;
+
+	if (FAILED(hresult))
+	{
+		return false;
+	}
+
+	return true;
+}
+
+void SpriteBatch::Shutdown()
+{
+	// Release the index buffer.
+	if (m_indexBuffer)
+	{
+		m_indexBuffer->Release();
+		m_indexBuffer = 0;
+	}
+
+	// Release the vertex ring.
+	if (m_vertexBuffer)
+	{
+		m_vertexBuffer->Release();
+		m_vertexBuffer = 0;
+	}
+
+	// Release the quads.
+	if (m_vertices)
+	{
+		delete[] m_vertices;
+		m_vertices = 0;
+	}
+
+	// Release the sprite shader.
+	if (m_Shader)
+	{
+		m_Shader->Shutdown();
+		delete m_Shader;
+		m_Shader = 0;
+	}
+
+	m_list.Clear();
+}
+
+void SpriteBatch::Begin()
+{
+	m_list.Clear();
+}
+
+bool SpriteBatch::Draw(ID3D11ShaderResourceView * texture, const SpriteRect & rect, const SpriteRect & uv, unsigned int color)
+{
+	return m_list.Add(texture, rect, uv, color);
+}
+
+bool SpriteBatch::Upload(RenderContext * deviceContext, int quadCount, int & baseVertex)
+{
+	HRESULT result;
+	D3D11_MAPPED_SUBRESOURCE mappedResource;
+	D3D11_MAP mapType;
+
+	// Append behind the vertices the gpu may still read, or start over on a fresh buffer.
+	mapType = D3D11_MAP_WRITE_NO_OVERWRITE;
+	if (m_head + quadCount * TEXT_QUAD_VERTICES > m_ringVertices)
+	{
+		mapType = D3D11_MAP_WRITE_DISCARD;
+		m_head = 0;
+	}
+
+	result = deviceContext->Map(m_vertexBuffer, 0, mapType, 0, &mappedResource);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	memcpy((TextVertex*)mappedResource.pData + m_head, m_vertices, sizeof(TextVertex) * quadCount * TEXT_QUAD_VERTICES);
+
+	deviceContext->Unmap(m_vertexBuffer, 0);
+
+	baseVertex = m_head;
+	m_head += quadCount * TEXT_QUAD_VERTICES;
+
+	return true;
+}
+
+bool SpriteBatch::End(RenderContext * deviceContext, XMMATRIX worldMatrix, XMMATRIX viewMatrix, XMMATRIX orthoMatrix)
+{
+	PROFILE_FUNCTION();
+	unsigned int stride, offset;
+	int quadCount, baseVertex, i;
+	bool result;
+
+	// Sort by texture and build the quads.
+	quadCount = m_list.Build(m_screenWidth, m_screenHeight, m_vertices);
+
+	Stats::Add(STAT_SPRITES, quadCount);
+	Stats::Add(STAT_SPRITE_RUNS, m_list.GetRunCount());
+
+	// Nothing to draw, keep the ring as it is.
+	if (quadCount == 0)
+	{
+		return true;
+	}
+
+	result = Upload(deviceContext, quadCount, baseVertex);
+	if (!result)
+	{
+		return false;
+	}
+
+	stride = sizeof(TextVertex);
+	offset = 0;
+
+	deviceContext->IASetVertexBuffers(0, 1, &m_vertexBuffer, &stride, &offset);
+	deviceContext->IASetIndexBuffer(m_indexBuffer, DXGI_FORMAT_R16_UINT, 0);
+	deviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+
+	result = m_Shader->Begin(deviceContext, worldMatrix, viewMatrix, orthoMatrix);
+	if (!result)
+	{
+		return false;
+	}
+
+	// One draw per texture, every run starts at its first quad in the shared index buffer.
+	for (i = 0; i < m_list.GetRunCount(); i++)
+	{
+		const SpriteRun& run = m_list.GetRun(i);
+		m_Shader->Render(deviceContext, run.quadCount * TEXT_QUAD_INDICES, run.firstQuad * TEXT_QUAD_INDICES, baseVertex, run.texture);
+	}
+
+	return true;
+}
+
+int SpriteBatch::GetSpriteCount()
+{
+	return m_list.GetSpriteCount();
+}
+
+int SpriteBatch::GetRunCount()
+{
+	return m_list.GetRunCount();
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <d3d11.h>
+#include <string.h>
+#include "RenderContext.h"
+#include "SpriteList.h"
+#include "SpriteShader.h"
+#include "Profiler.h"
+
+// The 16 bit indices reach 65536 vertices, four per sprite.
+#define SPRITE_BATCH_MAX_SPRITES 4096
+// Frames of sprites the vertex ring holds before it wraps around and discards.
+#define SPRITE_BATCH_RING_FRAMES 3
+
+// Draws the 2D sprites of a frame from one dynamic vertex buffer. Draw only collects, End sorts the sprites by
+// texture, appends their quads to the vertex ring in one map and draws every texture with one DrawIndexed from
+// the shared static index buffer. The sprites come out in the order SpriteList sorts them in.
+class SpriteBatch
+{
+private:
+	SpriteList m_list;
+	SpriteShader* m_Shader;
+	ID3D11Buffer* m_vertexBuffer;
+	ID3D11Buffer* m_indexBuffer;
+	TextVertex* m_vertices;
+	int m_maxSprites;
+	int m_ringVertices;
+	int m_head;
+	int m_screenWidth, m_screenHeight;
+
+	bool Upload(RenderContext* deviceContext, int quadCount, int& baseVertex);
+public:
+	SpriteBatch();
+	SpriteBatch(const SpriteBatch&);
+	~SpriteBatch();
+
+	bool Initialize(ID3D11Device* device, HWND hwnd, int screenWidth, int screenHeight, int maxSprites);
+	void Shutdown();
+
+	// Starts collecting the sprites of a frame.
+	void Begin();
+	// Rect is in pixels from the top left corner of the screen, uv is in texture coordinates and the color
+	// tints the texture. Returns false when the batch is full.
+	bool Draw(ID3D11ShaderResourceView* texture, const SpriteRect& rect, const SpriteRect& uv, unsigned int color);
+	// Draws every sprite since Begin.
+	bool End(RenderContext* deviceContext, XMMATRIX worldMatrix, XMMATRIX viewMatrix, XMMATRIX orthoMatrix);
+
+	// Sprites and draws of the last End.
+	int GetSpriteCount();
+	int GetRunCount();
+};
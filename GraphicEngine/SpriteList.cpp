@@ -0,0 +1,142 @@
+#include "SpriteList.h"
+#include <algorithm>
+#include <functional>
+
+bool SpriteList::SpriteLess(const Sprite & a, const Sprite & b)
+{
+	// The order breaks ties, so a sort that is not stable keeps the sprites of a texture in order too.
+	if (a.texture != b.texture)
+	{
+		return std::less<ID3D11ShaderResourceView*>()(a.texture, b.texture);
+	}
+
+	return a.order < b.order;
+}
+
+SpriteList::SpriteList()
+{
+	m_maxSprites = 0;
+	m_dropped = 0;
+}
+
+SpriteList::~SpriteList()
+{
+}
+
+void SpriteList::Initialize(int maxSprites)
+{
+	m_maxSprites = maxSprites;
+	m_sprites.reserve(maxSprites);
+	m_runs.reserve(maxSprites);
+
+	Clear();
+}
+
+void SpriteList::Clear()
+{
+	m_sprites.clear();
+	m_runs.clear();
+	m_dropped = 0;
+}
+
+bool SpriteList::Add(ID3D11ShaderResourceView * texture, const SpriteRect & rect, const SpriteRect & uv, unsigned int color)
+{
+	Sprite sprite;
+
+	if ((int)m_sprites.size() >= m_maxSprites)
+	{
+		m_dropped++;
+		return false;
+	}
+
+	sprite.texture = texture;
+	sprite.rect = rect;
+	sprite.uv = uv;
+	sprite.color = color;
+	sprite.order = (int)m_sprites.size();
+	m_sprites.push_back(sprite);
+
+	return true;
+}
+
+int SpriteList::Build(int screenWidth, int screenHeight, TextVertex * vertices)
+{
+	TextVertex* vertex;
+	float left, right, top, bottom;
+	int i;
+
+	std::sort(m_sprites.begin(), m_sprites.end(), SpriteLess);
+
+	m_runs.clear();
+
+	vertex = vertices;
+	for (i = 0; i < (int)m_sprites.size(); i++)
+	{
+		const Sprite& sprite = m_sprites[i];
+
+		// Start a new run whenever the texture changes.
+		if (m_runs.empty() || m_runs.back().texture != sprite.texture)
+		{
+			SpriteRun run;
+			run.texture = sprite.texture;
+			run.firstQuad = i;
+			run.quadCount = 0;
+			m_runs.push_back(run);
+		}
+
+		m_runs.back().quadCount++;
+
+		left = sprite.rect.x - (float)(screenWidth / 2);
+		right = left + sprite.rect.width;
+		top = (float)(screenHeight / 2) - sprite.rect.y;
+		bottom = top - sprite.rect.height;
+
+		// Top left, top right, bottom left and bottom right, the order BuildQuadIndices expects.
+		vertex[0].x = left;
+		vertex[0].y = top;
+		vertex[0].u = sprite.uv.x;
+		vertex[0].v = sprite.uv.y;
+
+		vertex[1].x = right;
+		vertex[1].y = top;
+		vertex[1].u = sprite.uv.x + sprite.uv.width;
+		vertex[1].v = sprite.uv.y;
+
+		vertex[2].x = left;
+		vertex[2].y = bottom;
+		vertex[2].u = sprite.uv.x;
+		vertex[2].v = sprite.uv.y + sprite.uv.height;
+
+		vertex[3].x = right;
+		vertex[3].y = bottom;
+		vertex[3].u = sprite.uv.x + sprite.uv.width;
+		vertex[3].v = sprite.uv.y + sprite.uv.height;
+
+		vertex[0].z = vertex[1].z = vertex[2].z = vertex[3].z = 0.0f;
+		vertex[0].color = vertex[1].color = vertex[2].color = vertex[3].color = sprite.color;
+
+		vertex += TEXT_QUAD_VERTICES;
+	}
+
+	return (int)m_sprites.size();
+}
+
+int SpriteList::GetSpriteCount()
+{
+	return (int)m_sprites.size();
+}
+
+int SpriteList::GetDroppedCount()
+{
+	return m_dropped;
+}
+
+int SpriteList::GetRunCount()
+{
+	return (int)m_runs.size();
+}
+
+const SpriteRun & SpriteList::GetRun(int index)
+{
+	return m_runs[index];
+}
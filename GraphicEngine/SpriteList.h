@@ -0,0 +1,65 @@
+#pragma once
+#include <vector>
+#include "TextLayout.h"
+
+// Sorting and expanding of the sprite batch. Nothing in here touches Direct3D, the textures are only compared,
+// so it builds and runs on its own.
+
+struct ID3D11ShaderResourceView;
+
+struct SpriteRect
+{
+	float x, y;
+	float width, height;
+};
+
+// A run of quads that share a texture and are drawn with one DrawIndexed.
+struct SpriteRun
+{
+	ID3D11ShaderResourceView* texture;
+	int firstQuad;
+	int quadCount;
+};
+
+// Collects the sprites of a frame. Build sorts them by texture, keeping the order they were added in within a
+// texture, writes one quad per sprite and one run per texture. Sprites of different textures do not keep their
+// order, so sprites that have to overlap a certain way should share a texture or go into separate frames.
+class SpriteList
+{
+private:
+	struct Sprite
+	{
+		ID3D11ShaderResourceView* texture;
+		SpriteRect rect;
+		SpriteRect uv;
+		unsigned int color;
+		int order;
+	};
+
+	std::vector<Sprite> m_sprites;
+	std::vector<SpriteRun> m_runs;
+	int m_maxSprites;
+	int m_dropped;
+
+	static bool SpriteLess(const Sprite& a, const Sprite& b);
+public:
+	SpriteList();
+	~SpriteList();
+
+	void Initialize(int maxSprites);
+	void Clear();
+
+	// Rect is in pixels from the top left corner of the screen, uv is in texture coordinates. Returns false
+	// and drops the sprite when the list is full.
+	bool Add(ID3D11ShaderResourceView* texture, const SpriteRect& rect, const SpriteRect& uv, unsigned int color);
+
+	// Writes the quads in screen space with the origin in the center and y pointing up, like the text, and
+	// returns how many were written. The vertices have room for every sprite added.
+	int Build(int screenWidth, int screenHeight, TextVertex* vertices);
+
+	int GetSpriteCount();
+	int GetDroppedCount();
+	// Runs of the last Build.
+	int GetRunCount();
+	const SpriteRun& GetRun(int index);
+};
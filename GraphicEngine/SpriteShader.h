@@ -0,0 +1,43 @@
+#pragma once
+#include<d3d11.h>
+#include<d3dcompiler.h>
+#include<DirectXMath.h>
+#include<fstream>
+#include "RenderContext.h"
+using namespace DirectX;
+using namespace std;
+
+// Draws textured quads tinted by their vertex color. The quads use the text vertex layout.
+class SpriteShader
+{
+private:
+	struct ConstantBufferType
+	{
+		XMMATRIX world;
+		XMMATRIX view;
+		XMMATRIX projection;
+	};
+
+	ID3D11VertexShader* m_vertexShader;
+	ID3D11PixelShader* m_pixelShader;
+	ID3D11InputLayout* m_layout;
+	ID3D11Buffer* m_matrixBuffer;
+	ID3D11SamplerState* m_sampleState;
+
+	bool InitializeShader(ID3D11Device* device, HWND hwnd, WCHAR* vsFilename, WCHAR* psFilename);
+	void ShutdownShader();
+	void OutputShaderErrorMessage(ID3D10Blob* errorMessage, HWND hwnd, WCHAR* shaderFilename);
+
+	bool SetShaderParameters(RenderContext* deviceContext, XMMATRIX worldMatrix, XMMATRIX viewMatrix,
+		XMMATRIX projectionMatrix);
+
+public:
+	SpriteShader();
+	~SpriteShader();
+
+	bool Initialize(ID3D11Device* device, HWND hwnd);
+	void Shutdown();
+	// Sets the matrices, shaders and sampler once, then every run only binds its texture and draws.
+	bool Begin(RenderContext* deviceContext, XMMATRIX worldMatrix, XMMATRIX viewMatrix, XMMATRIX projectionMatrix);
+	void Render(RenderContext* deviceContext, int indexCount, int startIndex, int baseVertex, ID3D11ShaderResourceView* texture);
+};
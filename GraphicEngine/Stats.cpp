@@ -0,0 +1,111 @@
+#include "Stats.h"
+#include <atomic>
+#include <fstream>
+
+namespace
+{
+	const char* s_names[STAT_COUNT] =
+	{
+		"draws",
+		"instances",
+		"triangles",
+		"objectsVisible",
+		"objectsCulled",
+		"constantBytes",
+		"srvBinds",
+		"maps",
+		"assetsLoaded",
+		"assetsEvicted",
+		"sprites",
+		"spriteRuns",
+		"frameBytes",
+		"frameOverflows",
+		"drawsDropped",
+		"clusterIndicesDropped"
+	};
+
+	std::atomic<long long> s_current[STAT_COUNT];
+	long long s_last[STAT_COUNT];
+	int s_frame = 0;
+
+	std::ofstream s_csv;
+}
+
+void Stats::Add(StatCounter counter, long long amount)
+{
+	s_current[counter].fetch_add(amount, std::memory_order_relaxed);
+}
+
+void Stats::CountDraw(unsigned int indexCount, unsigned int instanceCount)
+{
+	s_current[STAT_DRAWS].fetch_add(1, std::memory_order_relaxed);
+	s_current[STAT_INSTANCES].fetch_add(instanceCount, std::memory_order_relaxed);
+	s_current[STAT_TRIANGLES].fetch_add((long long)(indexCount / 3) * instanceCount, std::memory_order_relaxed);
+}
+
+void Stats::EndFrame()
+{
+	int i;
+
+	for (i = 0; i < STAT_COUNT; i++)
+	{
+		s_last[i] = s_current[i].exchange(0, std::memory_order_relaxed);
+	}
+
+	if (s_csv.is_open())
+	{
+		s_csv << s_frame;
+		for (i = 0; i < STAT_COUNT; i++)
+		{
+			s_csv << ',' << s_last[i];
+		}
+		s_csv << '\n';
+	}
+
+	s_frame++;
+}
+
+long long Stats::Get(StatCounter counter)
+{
+	return s_last[counter];
+}
+
+const char * Stats::GetName(StatCounter counter)
+{
+	return s_names[counter];
+}
+
+bool Stats::OpenCsv(const char * filename)
+{
+	int i;
+
+	CloseCsv();
+
+	s_csv.open(filename);
+	if (s_csv.fail())
+	{
+		return false;
+	}
+
+	s_csv << "frame";
+	for (i = 0; i < STAT_COUNT; i++)
+	{
+		s_csv << ',' << s_names[i];
+	}
+	s_csv << '\n';
+
+	return true;
+}
+
+void Stats::CloseCsv()
+{
+	if (s_csv.is_open())
+	{
+		s_csv.close();
+	}
+}
+
+bool Stats::IsCsvOpen()
+{
+	return s_csv.is_open();
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include "Util.h"
+
+// Everything the engine counts per frame.
+enum StatCounter
+{
+	STAT_DRAWS,
+	STAT_INSTANCES,
+	STAT_TRIANGLES,
+	STAT_OBJECTS_VISIBLE,
+	STAT_OBJECTS_CULLED,
+	STAT_CONSTANT_BYTES,
+	STAT_SRV_BINDS,
+	STAT_MAPS,
+	STAT_ASSETS_LOADED,
+	STAT_ASSETS_EVICTED,
+	STAT_SPRITES,
+	STAT_SPRITE_RUNS,
+	STAT_FRAME_BYTES,
+	STAT_FRAME_OVERFLOWS,
+	STAT_DRAWS_DROPPED,
+	STAT_CLUSTER_INDICES_DROPPED,
+	STAT_COUNT
+};
+
+// Per frame counters that any thread can add to. EndFrame keeps the totals of the frame that just ended for
+// the overlay and starts counting from zero again, and writes them as a row of a CSV file while one is open.
+class Stats
+{
+public:
+	GRAPHIC_API static void Add(StatCounter counter, long long amount);
+	// Counts a draw with its instances and triangles, for triangle lists.
+	GRAPHIC_API static void CountDraw(unsigned int indexCount, unsigned int instanceCount);
+
+	GRAPHIC_API static void EndFrame();
+	// Total of the last frame that ended.
+	GRAPHIC_API static long long Get(StatCounter counter);
+	GRAPHIC_API static const char* GetName(StatCounter counter);
+
+	// Starts a CSV file with a header line, every following EndFrame adds a row to it.
+	GRAPHIC_API static bool OpenCsv(const char* filename);
+	GRAPHIC_API static void CloseCsv();
+	GRAPHIC_API static bool IsCsvOpen();
+};
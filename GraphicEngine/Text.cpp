@@ -1,244 +1,54 @@
 #include "Text.h"
 
-bool Text::InitializeSentence(SentenceType ** sentence, int maxLength, ID3D11Device * device)
+bool Text::InitializeSentence(int * sentence, int maxLength)
 {
-	VertexType* vertices;
-	unsigned long* indices;
-	D3D11_BUFFER_DESC vertexBufferDesc, indexBufferDesc;
-	D3D11_SUBRESOURCE_DATA vertexData, indexData;
-	HRESULT result;
-	int i;
-
-
-	// Create a new sentence object.
-	*sentence = new SentenceType;
-	if (!*sentence)
-	{
-		return false;
-	}
-
-	// Initialize the sentence buffers to null.
-	(*sentence)->vertexBuffer = 0;
-	(*sentence)->indexBuffer = 0;
-
-	// Set the maximum length of the sentence.
-	(*sentence)->maxLength = maxLength;
-
-	// Set the number of vertices in the vertex array.
-	(*sentence)->vertexCount = 6 * maxLength;
-
-	// Set the number of indexes in the index array.
-	(*sentence)->indexCount = (*sentence)->vertexCount;
-
-	// Create the vertex array.
-	vertices = new VertexType[(*sentence)->vertexCount];
-	if (!vertices)
-	{
-		return false;
-	}
-
-	// Create the index array.
-	indices = new unsigned long[(*sentence)->indexCount];
-	if (!indices)
-	{
-		return false;
-	}
-
-	// Initialize vertex array to zeros at first.
-	memset(vertices, 0, (sizeof(VertexType) * (*sentence)->vertexCount));
-
-	// Initialize the index array.
-	for (i = 0; i<(*sentence)->indexCount; i++)
-	{
-		indices[i] = i;
-	}
-
-	// Set up the description of the dynamic vertex buffer.
-	vertexBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
-	vertexBufferDesc.ByteWidth = sizeof(VertexType) * (*sentence)->vertexCount;
-	vertexBufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-	vertexBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-	vertexBufferDesc.MiscFlags = 0;
-	vertexBufferDesc.StructureByteStride = 0;
-
-	// Give the subresource structure a pointer to the vertex data.
-	vertexData.pSysMem = vertices;
-	vertexData.SysMemPitch = 0;
-	vertexData.SysMemSlicePitch = 0;
-
-	// Create the vertex buffer.
-	result = device->CreateBuffer(&vertexBufferDesc, &vertexData, &(*sentence)->vertexBuffer);
-	if (FAILED(result))
+	// Reserve room for the sentence in the batcher, it stays hidden until it gets a text.
+	*sentence = m_Batcher->AddString(maxLength);
+	if (*sentence < 0)
 	{
 		return false;
 	}
 
-	// Set up the description of the static index buffer.
-	indexBufferDesc.Usage = D3D11_USAGE_DEFAULT;
-	indexBufferDesc.ByteWidth = sizeof(unsigned long) * (*sentence)->indexCount;
-	indexBufferDesc.BindFlags = D3D11_BIND_INDEX_BUFFER;
-	indexBufferDesc.CPUAccessFlags = 0;
-	indexBufferDesc.MiscFlags = 0;
-	indexBufferDesc.StructureByteStride = 0;
-
-	// Give the subresource structure a pointer to the index data.
-	indexData.pSysMem = indices;
-	indexData.SysMemPitch = 0;
-	indexData.SysMemSlicePitch = 0;
-
-	// Create the index buffer.
-	result = device->CreateBuffer(&indexBufferDesc, &indexData, &(*sentence)->indexBuffer);
-	if (FAILED(result))
-	{
-		return false;
-	}
-
-	// Release the vertex array as it is no longer needed.
-	delete[] vertices;
-	vertices = 0;
-
-	// Release the index array as it is no longer needed.
-	delete[] indices;
-	indices = 0;
-
 	return true;
 }
 
-bool Text::UpdateSentence(SentenceType * sentence, char * text, int positionX, int positionY, float red, float green, float blue, ID3D11DeviceContext * deviceContext)
+bool Text::UpdateSentence(int sentence, char * text, int positionX, int positionY, float red, float green, float blue)
 {
-	int numLetters;
-	VertexType* vertices;
 	float drawX, drawY;
-	HRESULT result;
-	D3D11_MAPPED_SUBRESOURCE mappedResource;
-	VertexType* verticesPtr;
-
-	// Store the color of the sentence.
-	sentence->red = red;
-	sentence->green = green;
-	sentence->blue = blue;
-
-	// Get the number of letters in the sentence.
-	numLetters = (int)strlen(text);
-
-	// Check for possible buffer overflow.
-	if (numLetters > sentence->maxLength)
-	{
-		return false;
-	}
-
-	// Create the vertex array.
-	vertices = new VertexType[sentence->vertexCount];
-	if (!vertices)
-	{
-		return false;
-	}
-
-	// Initialize vertex array to zeros at first.
-	memset(vertices, 0, (sizeof(VertexType) * sentence->vertexCount));
 
 	// Calculate the X and Y pixel position on the screen to start drawing to.
 	drawX = (float)(((m_screenWidth / 2) * -1) + positionX);
 	drawY = (float)((m_screenHeight / 2) - positionY);
 
-	// Use the font class to build the vertex array from the sentence text and sentence draw location.
-	m_Font->BuildVertexArray((void*)vertices, text, drawX, drawY);
-
-	// Lock the vertex buffer so it can be written to.
-	result = deviceContext->Map(sentence->vertexBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
-	if (FAILED(result))
-	{
-		return false;
-	}
-
-	// Get a pointer to the data in the vertex buffer.
-	verticesPtr = (VertexType*)mappedResource.pData;
-
-	// Copy the data into the vertex buffer.
-	memcpy(verticesPtr, (void*)vertices, (sizeof(VertexType) * sentence->vertexCount));
-
-	// Unlock the vertex buffer.
-	deviceContext->Unmap(sentence->vertexBuffer, 0);
-
-	// Release the vertex array as it is no longer needed.
-	delete[] vertices;
-	vertices = 0;
-
-	return true;
+	// The batcher keeps the quads of a sentence that did not change.
+	return m_Batcher->SetString(sentence, text, drawX, drawY, PackTextColor(red, green, blue, 1.0f));
 }
 
-void Text::ReleaseSentence(SentenceType ** sentence)
+Text::Text()
 {
-	if (*sentence)
-	{
-		// Release the sentence vertex buffer.
-		if ((*sentence)->vertexBuffer)
-		{
-			(*sentence)->vertexBuffer->Release();
-			(*sentence)->vertexBuffer = 0;
-		}
+	m_Font = 0;
+	m_FontShader = 0;
+	m_Batcher = 0;
 
-		// Release the sentence index buffer.
-		if ((*sentence)->indexBuffer)
-		{
-			(*sentence)->indexBuffer->Release();
-			(*sentence)->indexBuffer = 0;
-		}
+	m_sentence1 = -1;
+	m_sentence2 = -1;
 
-		// Release the sentence.
-		delete *sentence;
-		*sentence = 0;
+	for (int i = 0; i < TEXT_PROFILE_LINES; i++)
+	{
+		m_profileSentences[i] = -1;
 	}
-}
-
-bool Text::RenderSentence(ID3D11DeviceContext * deviceContext, SentenceType * sentence, XMMATRIX worldMatrix, XMMATRIX orthoMatrix)
-{
-	unsigned int stride, offset;
-	XMFLOAT4 pixelColor;
-	bool result;
-
-
-	// Set vertex buffer stride and offset.
-	stride = sizeof(VertexType);
-	offset = 0;
-
-	// Set the vertex buffer to active in the input assembler so it can be rendered.
-	deviceContext->IASetVertexBuffers(0, 1, &sentence->vertexBuffer, &stride, &offset);
-
-	// Set the index buffer to active in the input assembler so it can be rendered.
-	deviceContext->IASetIndexBuffer(sentence->indexBuffer, DXGI_FORMAT_R32_UINT, 0);
 
-	// Set the type of primitive that should be rendered from this vertex buffer, in this case triangles.
-	deviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-
-	// Create a pixel color vector with the input sentence color.
-	pixelColor = XMFLOAT4(sentence->red, sentence->green, sentence->blue, 1.0f);
-
-	// Render the text using the font shader.
-	result = m_FontShader->Render(deviceContext, sentence->indexCount, worldMatrix, m_baseViewMatrix, orthoMatrix, m_Font->GetTexture(),
-		pixelColor);
-	if (!result)
+	for (int i = 0; i < TEXT_STATS_LINES; i++)
 	{
-		return false;
+		m_statsSentences[i] = -1;
 	}
-
-	return true;
-}
-
-Text::Text()
-{
-	m_Font = 0;
-	m_FontShader = 0;
-
-	m_sentence1 = 0;
-	m_sentence2 = 0;
 }
 
 Text::~Text()
 {
 }
 
-bool Text::Initialize(ID3D11Device * device, ID3D11DeviceContext * deviceContext, HWND hwnd, int screenWidth, int screenHeight, XMMATRIX baseViewMatrix, Assets* assets)
+bool Text::Initialize(ID3D11Device * device, HWND hwnd, int screenWidth, int screenHeight, XMMATRIX baseViewMatrix, Assets* assets)
 {
 	bool result;
 
@@ -257,7 +67,7 @@ bool Text::Initialize(ID3D11Device * device, ID3D11DeviceContext * deviceContext
 	}
 
 	// Initialize the font object.
-	result = m_Font->Initialize(assets, "../Data/Fonts/fontdata.txt", "../Data/Fonts/font.tga");
+	result = m_Font->Initialize(assets, "../Data/Fonts/font.sdf");
 	if (!result)
 	{
 		MessageBox(hwnd, L"Could not initialize the font object.", L"Error", MB_OK);
@@ -279,44 +89,81 @@ bool Text::Initialize(ID3D11Device * device, ID3D11DeviceContext * deviceContext
 		return false;
 	}
 
+	// Create the batcher that draws all sentences together.
+	m_Batcher = new TextBatcher;
+	if (!m_Batcher)
+	{
+		return false;
+	}
+
+	// Initialize the batcher with room for every sentence.
+	result = m_Batcher->Initialize(device, m_Font->GetCache(), TEXT_FONT_SIZE, TEXT_MAX_QUADS);
+	if (!result)
+	{
+		MessageBox(hwnd, L"Could not initialize the text batcher object.", L"Error", MB_OK);
+		return false;
+	}
+
 	// Initialize the first sentence.
-	result = InitializeSentence(&m_sentence1, 16, device);
+	result = InitializeSentence(&m_sentence1, TEXT_SENTENCE_LENGTH);
 	if (!result)
 	{
 		return false;
 	}
 
-	// Now update the sentence vertex buffer with the new string information.
-	result = UpdateSentence(m_sentence1, "Hello", 100, 100, 1.0f, 1.0f, 1.0f, deviceContext);
+	// Now give the sentence its text.
+	result = UpdateSentence(m_sentence1, "Hello", 100, 100, 1.0f, 1.0f, 1.0f);
 	if (!result)
 	{
 		return false;
 	}
 
-	// Initialize the first sentence.
-	result = InitializeSentence(&m_sentence2, 16, device);
+	// Initialize the second sentence.
+	result = InitializeSentence(&m_sentence2, TEXT_SENTENCE_LENGTH);
 	if (!result)
 	{
 		return false;
 	}
 
-	// Now update the sentence vertex buffer with the new string information.
-	result = UpdateSentence(m_sentence2, "Goodbye", 100, 200, 1.0f, 1.0f, 0.0f, deviceContext);
+	// Now give the sentence its text.
+	result = UpdateSentence(m_sentence2, "Goodbye", 100, 200, 1.0f, 1.0f, 0.0f);
 	if (!result)
 	{
 		return false;
 	}
 
+	// Initialize the profiler summary lines, they stay hidden until there is a summary.
+	for (int i = 0; i < TEXT_PROFILE_LINES; i++)
+	{
+		result = InitializeSentence(&m_profileSentences[i], TEXT_PROFILE_LENGTH);
+		if (!result)
+		{
+			return false;
+		}
+	}
+
+	// Initialize the counter lines, hidden as well.
+	for (int i = 0; i < TEXT_STATS_LINES; i++)
+	{
+		result = InitializeSentence(&m_statsSentences[i], TEXT_PROFILE_LENGTH);
+		if (!result)
+		{
+			return false;
+		}
+	}
+
 	return true;
 }
 
 void Text::Shutdown()
 {
-	// Release the first sentence.
-	ReleaseSentence(&m_sentence1);
-
-	// Release the second sentence.
-	ReleaseSentence(&m_sentence2);
+	// Release the batcher, the sentences go with it.
+	if (m_Batcher)
+	{
+		m_Batcher->Shutdown();
+		delete m_Batcher;
+		m_Batcher = 0;
+	}
 
 	// Release the font shader object.
 	if (m_FontShader)
@@ -335,29 +182,43 @@ void Text::Shutdown()
 	}
 }
 
-bool Text::Render(ID3D11DeviceContext * deviceContext, XMMATRIX worldMatrix, XMMATRIX orthoMatrix)
+bool Text::Render(RenderContext * deviceContext, XMMATRIX worldMatrix, XMMATRIX orthoMatrix)
 {
 	bool result;
 
 
-	// Draw the first sentence.
-	result = RenderSentence(deviceContext, m_sentence1, worldMatrix, orthoMatrix);
+	// Upload the sentences that changed and put the buffers on the input assembler.
+	result = m_Batcher->Render(deviceContext);
 	if (!result)
 	{
 		return false;
 	}
 
-	// Draw the second sentence.
-	result = RenderSentence(deviceContext, m_sentence2, worldMatrix, orthoMatrix);
+	// Copy the glyphs the layout added to the page.
+	m_Font->Upload(deviceContext);
+
+	// Nothing is visible.
+	if (m_Batcher->GetIndexCount() == 0)
+	{
+		m_Font->BeginFrame();
+		return true;
+	}
+
+	// Draw every sentence with one draw call.
+	result = m_FontShader->Render(deviceContext, m_Batcher->GetIndexCount(), m_Batcher->GetBaseVertex(), worldMatrix, m_baseViewMatrix,
+		orthoMatrix, m_Font->GetTexture());
 	if (!result)
 	{
 		return false;
 	}
 
+	// The glyphs of this frame are drawn, they can be evicted again.
+	m_Font->BeginFrame();
+
 	return true;
 }
 
-bool Text::SetFps(int fps, ID3D11DeviceContext * deviceContext)
+bool Text::SetFps(int fps)
 {
 	char tempString[16];
 	char fpsString[16];
@@ -402,8 +263,8 @@ bool Text::SetFps(int fps, ID3D11DeviceContext * deviceContext)
 		blue = 0.0f;
 	}
 
-	// Update the sentence vertex buffer with the new string information.
-	result = UpdateSentence(m_sentence1, fpsString, 20, 20, red, green, blue, deviceContext);
+	// Update the sentence with the new string information.
+	result = UpdateSentence(m_sentence1, fpsString, 20, 20, red, green, blue);
 	if (!result)
 	{
 		return false;
@@ -412,7 +273,7 @@ bool Text::SetFps(int fps, ID3D11DeviceContext * deviceContext)
 	return true;
 }
 
-bool Text::SetCpu(int cpu, ID3D11DeviceContext * deviceContext)
+bool Text::SetCpu(int cpu)
 {
 	char tempString[16];
 	char cpuString[16];
@@ -427,8 +288,8 @@ bool Text::SetCpu(int cpu, ID3D11DeviceContext * deviceContext)
 	strcat_s(cpuString, tempString);
 	strcat_s(cpuString, "%");
 
-	// Update the sentence vertex buffer with the new string information.
-	result = UpdateSentence(m_sentence2, cpuString, 20, 40, 0.0f, 1.0f, 0.0f, deviceContext);
+	// Update the sentence with the new string information.
+	result = UpdateSentence(m_sentence2, cpuString, 20, 40, 0.0f, 1.0f, 0.0f);
 	if (!result)
 	{
 		return false;
@@ -437,3 +298,78 @@ bool Text::SetCpu(int cpu, ID3D11DeviceContext * deviceContext)
 	return true;
 }
 
+
+
+bool Text::SetProfile(const ProfileSummary * summary, int count)
+{
+	char lineString[64];
+	bool result;
+	int i;
+
+	if (count > TEXT_PROFILE_LINES)
+	{
+		count = TEXT_PROFILE_LINES;
+	}
+
+	// One line per zone with its time and how often it was entered, the name is cut to fit.
+	for (i = 0; i < count; i++)
+	{
+		sprintf_s(lineString, "%-24.24s %6.2fms %3d", summary[i].name, summary[i].time, summary[i].calls);
+		lineString[TEXT_PROFILE_LENGTH] = 0;
+
+		result = UpdateSentence(m_profileSentences[i], lineString, 20, 70 + i * 18, 1.0f, 1.0f, 1.0f);
+		if (!result)
+		{
+			return false;
+		}
+	}
+
+	// Hide the lines the summary does not use.
+	for (; i < TEXT_PROFILE_LINES; i++)
+	{
+		m_Batcher->SetVisible(m_profileSentences[i], false);
+	}
+
+	return true;
+}
+
+bool Text::SetStats(bool visible)
+{
+	char lineStrings[TEXT_STATS_LINES][64];
+	bool result;
+	int i;
+
+	if (!visible)
+	{
+		for (i = 0; i < TEXT_STATS_LINES; i++)
+		{
+			m_Batcher->SetVisible(m_statsSentences[i], false);
+		}
+
+		return true;
+	}
+
+	sprintf_s(lineStrings[0], "Draws %lld Instances %lld", Stats::Get(STAT_DRAWS), Stats::Get(STAT_INSTANCES));
+	sprintf_s(lineStrings[1], "Triangles %lld", Stats::Get(STAT_TRIANGLES));
+	sprintf_s(lineStrings[2], "Visible %lld Culled %lld", Stats::Get(STAT_OBJECTS_VISIBLE), Stats::Get(STAT_OBJECTS_CULLED));
+	sprintf_s(lineStrings[3], "Constants %lldB Srvs %lld Maps %lld", Stats::Get(STAT_CONSTANT_BYTES), Stats::Get(STAT_SRV_BINDS),
+		Stats::Get(STAT_MAPS));
+	sprintf_s(lineStrings[4], "Assets loaded %lld evicted %lld", Stats::Get(STAT_ASSETS_LOADED), Stats::Get(STAT_ASSETS_EVICTED));
+	sprintf_s(lineStrings[5], "Sprites %lld Runs %lld", Stats::Get(STAT_SPRITES), Stats::Get(STAT_SPRITE_RUNS));
+	sprintf_s(lineStrings[6], "Frame memory %lldB overflows %lld", Stats::Get(STAT_FRAME_BYTES), Stats::Get(STAT_FRAME_OVERFLOWS));
+	sprintf_s(lineStrings[7], "Dropped draws %lld lights %lld", Stats::Get(STAT_DRAWS_DROPPED), Stats::Get(STAT_CLUSTER_INDICES_DROPPED));
+
+	// Below the profiler summary, in a light blue so they stand apart from it.
+	for (i = 0; i < TEXT_STATS_LINES; i++)
+	{
+		lineStrings[i][TEXT_PROFILE_LENGTH] = 0;
+
+		result = UpdateSentence(m_statsSentences[i], lineStrings[i], 20, 80 + (TEXT_PROFILE_LINES + i) * 18, 0.5f, 0.8f, 1.0f);
+		if (!result)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
\ No newline at end of file
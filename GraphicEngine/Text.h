@@ -1,44 +1,51 @@
 #pragma once
 #include "Font.h"
 #include "FontShader.h"
+#include "TextBatcher.h"
+#include "Profiler.h"
+
+// Lines of the profiler summary and the characters of each line.
+#define TEXT_PROFILE_LINES 8
+#define TEXT_PROFILE_LENGTH 40
+// Lines of the engine counters below the profiler summary.
+#define TEXT_STATS_LINES 8
+// Pixels per em of the overlay text.
+#define TEXT_FONT_SIZE 16.0f
+// Characters of the fps and cpu lines.
+#define TEXT_SENTENCE_LENGTH 16
+// Characters of all lines together.
+#define TEXT_MAX_QUADS (2 * TEXT_SENTENCE_LENGTH + (TEXT_PROFILE_LINES + TEXT_STATS_LINES) * TEXT_PROFILE_LENGTH)
 
 class Text
 {
 private:
-	struct SentenceType
-	{
-		ID3D11Buffer *vertexBuffer, *indexBuffer;
-		int vertexCount, indexCount, maxLength;
-		float red, green, blue;
-	};
-
-	struct VertexType
-	{
-		XMFLOAT3 position;
-		XMFLOAT2 texture;
-	};
-
 	Font* m_Font;
 	FontShader* m_FontShader;
+	TextBatcher* m_Batcher;
 	int m_screenWidth, m_screenHeight;
 	XMMATRIX m_baseViewMatrix;
 
-	SentenceType* m_sentence1;
-	SentenceType* m_sentence2;
+	// Handles of the batcher strings.
+	int m_sentence1;
+	int m_sentence2;
+	int m_profileSentences[TEXT_PROFILE_LINES];
+	int m_statsSentences[TEXT_STATS_LINES];
 
-	bool InitializeSentence(SentenceType** sentence, int maxLength, ID3D11Device* device);
-	bool UpdateSentence(SentenceType* sentence, char* text, int positionX, int positionY, float red, float green, float blue,
-		ID3D11DeviceContext* deviceContext);
-	void ReleaseSentence(SentenceType** sentence);
-	bool RenderSentence(ID3D11DeviceContext* deviceContext, SentenceType* sentence, XMMATRIX worldMatrix,
-		XMMATRIX orthoMatrix);
+	bool InitializeSentence(int* sentence, int maxLength);
+	// Positions are in pixels from the top left corner of the screen.
+	bool UpdateSentence(int sentence, char* text, int positionX, int positionY, float red, float green, float blue);
 public:
 	Text();
 	~Text();
 
-	bool Initialize(ID3D11Device * device, ID3D11DeviceContext * deviceContext, HWND hwnd, int screenWidth, int screenHeight, XMMATRIX baseViewMatrix, Assets* assets);
+	bool Initialize(ID3D11Device * device, HWND hwnd, int screenWidth, int screenHeight, XMMATRIX baseViewMatrix, Assets* assets);
 	void Shutdown();
-	bool Render(ID3D11DeviceContext* deviceContext, XMMATRIX worldMatrix, XMMATRIX orthoMatrix);
-	bool SetFps(int, ID3D11DeviceContext* deviceContext);
-	bool SetCpu(int, ID3D11DeviceContext* deviceContext);
+	bool Render(RenderContext* deviceContext, XMMATRIX worldMatrix, XMMATRIX orthoMatrix);
+	// The set calls only lay out lines whose text changed, Render uploads and draws all lines at once.
+	bool SetFps(int);
+	bool SetCpu(int);
+	// Shows one line per zone below the fps and cpu, a count of zero hides the summary.
+	bool SetProfile(const ProfileSummary* summary, int count);
+	// Shows the counters of the last frame that ended, or hides them.
+	bool SetStats(bool visible);
 };
\ No newline at end of file
@@ -0,0 +1,360 @@
+#include "TextBatcher.h"
+
+TextBatcher::TextBatcher()
+{
+	int i;
+
+	for (i = 0; i < TEXT_BATCHER_MAX_STRINGS; i++)
+	{
+		m_strings[i].text = 0;
+		m_strings[i].vertices = 0;
+	}
+
+	m_font = 0;
+	m_size = 0.0f;
+	m_stringCount = 0;
+	m_maxQuads = 0;
+	m_reservedQuads = 0;
+
+	m_vertexBuffer = 0;
+	m_indexBuffer = 0;
+	m_ringVertices = 0;
+	m_head = 0;
+	m_changed = false;
+
+	m_baseVertex = 0;
+	m_quadCount = 0;
+}
+
+TextBatcher::TextBatcher(const TextBatcher & other)
+{
+}
+
+TextBatcher::~TextBatcher()
+{
+}
+
+bool TextBatcher::Initialize(ID3D11Device * device, GlyphCache * font, float size, int maxQuads)
+{
+	unsigned short* indices;
+	D3D11_BUFFER_DESC vertexBufferDesc, indexBufferDesc;
+	D3D11_SUBRESOURCE_DATA indexData;
+	HRESULT result;
+
+	// The indices are 16 bit and always start at the base vertex of the upload.
+	if (maxQuads <= 0 || maxQuads * TEXT_QUAD_VERTICES > 65536)
+	{
+		return false;
+	}
+
+	m_font = font;
+	m_size = size;
+	m_maxQuads = maxQuads;
+
+	// Leave room for a few frames of changes before the ring has to discard.
+	m_ringVertices = maxQuads * TEXT_QUAD_VERTICES * TEXT_BATCHER_RING_FRAMES;
+
+	vertexBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+	vertexBufferDesc.ByteWidth = sizeof(TextVertex) * m_ringVertices;
+	vertexBufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+	vertexBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+	vertexBufferDesc.MiscFlags = 0;
+	vertexBufferDesc.StructureByteStride = 0;
+
+	result = device->CreateBuffer(&vertexBufferDesc, NULL, &m_vertexBuffer);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	// Put the head at the end so the first upload discards.
+	m_head = m_ringVertices;
+
+	// Every quad uses the same pattern, so one index buffer covers every batch.
+	indices = new unsigned short[maxQuads * TEXT_QUAD_INDICES];
+	if (!indices)
+	{
+		return false;
+	}
+
+	BuildQuadIndices(indices, maxQuads);
+
+	indexBufferDesc.Usage = D3D11_USAGE_IMMUTABLE;
+	indexBufferDesc.ByteWidth = sizeof(unsigned short) * maxQuads * TEXT_QUAD_INDICES;
+	indexBufferDesc.BindFlags = D3D11_BIND_INDEX_BUFFER;
+	indexBufferDesc.CPUAccessFlags = 0;
+	indexBufferDesc.MiscFlags = 0;
+	indexBufferDesc.StructureByteStride = 0;
+
+	indexData.pSysMem = indices;
+	indexData.SysMemPitch = 0;
+	indexData.SysMemSlicePitch = 0;
+
+	result = device->CreateBuffer(&indexBufferDesc, &indexData, &m_indexBuffer);
+
+	delete[] indices;
+	indices = 0;
+
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	return true;
+}
+
+void TextBatcher::Shutdown()
+{
+	int i;
+
+	// Release the strings.
+	for (i = 0; i < m_stringCount; i++)
+	{
+		if (m_strings[i].text)
+		{
+			delete[] m_strings[i].text;
+			m_strings[i].text = 0;
+		}
+
+		if (m_strings[i].vertices)
+		{
+			delete[] m_strings[i].vertices;
+			m_strings[i].vertices = 0;
+		}
+	}
+
+	m_stringCount = 0;
+	m_reservedQuads = 0;
+
+	// Release the index buffer.
+	if (m_indexBuffer)
+	{
+		m_indexBuffer->Release();
+		m_indexBuffer = 0;
+	}
+
+	// Release the vertex ring.
+	if (m_vertexBuffer)
+	{
+		m_vertexBuffer->Release();
+		m_vertexBuffer = 0;
+	}
+}
+
+int TextBatcher::AddString(int maxLength)
+{
+	StringType* string;
+
+	if (m_stringCount >= TEXT_BATCHER_MAX_STRINGS || maxLength <= 0 || m_reservedQuads + maxLength > m_maxQuads)
+	{
+		return -1;
+	}
+
+	string = &m_strings[m_stringCount];
+
+	string->text = new char[maxLength + 1];
+	if (!string->text)
+	{
+		return -1;
+	}
+
+	string->vertices = new TextVertex[maxLength * TEXT_QUAD_VERTICES];
+	if (!string->vertices)
+	{
+		return -1;
+	}
+
+	string->text[0] = 0;
+	string->maxLength = maxLength;
+	string->x = 0.0f;
+	string->y = 0.0f;
+	string->color = 0;
+	string->visible = false;
+	string->quadCount = 0;
+	string->evictions = 0;
+
+	m_reservedQuads += maxLength;
+
+	return m_stringCount++;
+}
+
+bool TextBatcher::SetString(int handle, const char * text, float x, float y, unsigned int color)
+{
+	StringType* string;
+	int length;
+
+	string = &m_strings[handle];
+
+	length = (int)strlen(text);
+	if (length > string->maxLength)
+	{
+		return false;
+	}
+
+	if (!string->visible)
+	{
+		string->visible = true;
+		m_changed = true;
+	}
+
+	// Most strings show the same thing as last frame, keep their quads.
+	if (string->x == x && string->y == y && string->color == color && strcmp(string->text, text) == 0)
+	{
+		return true;
+	}
+
+	memcpy(string->text, text, length + 1);
+	string->x = x;
+	string->y = y;
+	string->color = color;
+
+	Layout(string);
+
+	return true;
+}
+
+void TextBatcher::SetVisible(int handle, bool visible)
+{
+	if (m_strings[handle].visible != visible)
+	{
+		m_strings[handle].visible = visible;
+		m_changed = true;
+	}
+}
+
+void TextBatcher::Layout(StringType * string)
+{
+	string->evictions = m_font->GetEvictionCount();
+	string->quadCount = LayoutText(m_font, string->text, string->x, string->y, m_size, string->color, string->vertices, string->maxLength);
+
+	m_changed = true;
+}
+
+bool TextBatcher::Upload(RenderContext * deviceContext)
+{
+	PROFILE_FUNCTION();
+	HRESULT result;
+	D3D11_MAPPED_SUBRESOURCE mappedResource;
+	D3D11_MAP mapType;
+	TextVertex* vertexPtr;
+	int quadCount, i;
+
+	quadCount = 0;
+	for (i = 0; i < m_stringCount; i++)
+	{
+		if (m_strings[i].visible)
+		{
+			quadCount += m_strings[i].quadCount;
+		}
+	}
+
+	// Nothing to draw, keep the ring as it is.
+	if (quadCount == 0)
+	{
+		m_quadCount = 0;
+		m_changed = false;
+		return true;
+	}
+
+	// Append behind the vertices the gpu may still read, or start over on a fresh buffer.
+	mapType = D3D11_MAP_WRITE_NO_OVERWRITE;
+	if (m_head + quadCount * TEXT_QUAD_VERTICES > m_ringVertices)
+	{
+		mapType = D3D11_MAP_WRITE_DISCARD;
+		m_head = 0;
+	}
+
+	result = deviceContext->Map(m_vertexBuffer, 0, mapType, 0, &mappedResource);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	// Copy the visible strings one after the other.
+	vertexPtr = (TextVertex*)mappedResource.pData + m_head;
+	for (i = 0; i < m_stringCount; i++)
+	{
+		if (m_strings[i].visible && m_strings[i].quadCount > 0)
+		{
+			memcpy(vertexPtr, m_strings[i].vertices, sizeof(TextVertex) * m_strings[i].quadCount * TEXT_QUAD_VERTICES);
+			vertexPtr += m_strings[i].quadCount * TEXT_QUAD_VERTICES;
+		}
+	}
+
+	deviceContext->Unmap(m_vertexBuffer, 0);
+
+	m_baseVertex = m_head;
+	m_quadCount = quadCount;
+	m_head += quadCount * TEXT_QUAD_VERTICES;
+	m_changed = false;
+
+	return true;
+}
+
+bool TextBatcher::Render(RenderContext * deviceContext)
+{
+	unsigned int stride, offset;
+	bool result;
+	int i;
+
+	// Quads laid out before an eviction may point at the place of another glyph now.
+	for (i = 0; i < m_stringCount; i++)
+	{
+		if (m_strings[i].visible && m_strings[i].evictions != m_font->GetEvictionCount())
+		{
+			Layout(&m_strings[i]);
+		}
+	}
+
+	// The last upload stays valid as long as nothing changed, later uploads only ever write behind it.
+	if (m_changed)
+	{
+		result = Upload(deviceContext);
+		if (!result)
+		{
+			return false;
+		}
+	}
+
+	stride = sizeof(TextVertex);
+	offset = 0;
+
+	deviceContext->IASetVertexBuffers(0, 1, &m_vertexBuffer, &stride, &offset);
+	deviceContext->IASetIndexBuffer(m_indexBuffer, DXGI_FORMAT_R16_UINT, 0);
+	deviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+
+	return true;
+}
+
+int TextBatcher::GetIndexCount()
+{
+	return m_quadCount * TEXT_QUAD_INDICES;
+}
+
+int TextBatcher::GetBaseVertex()
+{
+	return m_baseVertex;
+}
+
+void TextBatcher::UploadGlyphs(RenderContext * deviceContext, GlyphCache * font, ID3D11Resource * texture)
+{
+	const std::vector<AtlasRect>& dirty = font->GetDirty();
+	D3D11_BOX box;
+	int pageWidth, i;
+
+	pageWidth = font->GetPageWidth();
+
+	for (i = 0; i < (int)dirty.size(); i++)
+	{
+		box.left = dirty[i].x;
+		box.top = dirty[i].y;
+		box.front = 0;
+		box.right = dirty[i].x + dirty[i].width;
+		box.bottom = dirty[i].y + dirty[i].height;
+		box.back = 1;
+
+		deviceContext->UpdateSubresource(texture, 0, &box, font->GetPage() + dirty[i].y * pageWidth + dirty[i].x, pageWidth, 0);
+	}
+
+	font->ClearDirty();
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include <d3d11.h>
+#include <string.h>
+#include "RenderContext.h"
+#include "TextLayout.h"
+#include "Profiler.h"
+
+#define TEXT_BATCHER_MAX_STRINGS 32
+// Frames of text the vertex ring holds before it wraps around and discards.
+#define TEXT_BATCHER_RING_FRAMES 3
+
+// Draws every string with one DrawIndexed. Each string keeps its laid out quads in memory and is only laid out
+// again when its text, position or color changes, or when the glyph cache evicted glyphs since. When anything
+// changed the visible quads are appended to a dynamic vertex ring with WRITE_NO_OVERWRITE, or with WRITE_DISCARD
+// when the ring wraps around, and frames without changes do not map at all. All quads share one static index
+// buffer and the draw starts at the base vertex of the last upload.
+class TextBatcher
+{
+private:
+	struct StringType
+	{
+		char* text;
+		int maxLength;
+		float x, y;
+		unsigned int color;
+		bool visible;
+		TextVertex* vertices;
+		int quadCount;
+		// Evictions of the glyph cache when the string was laid out.
+		int evictions;
+	};
+
+	GlyphCache* m_font;
+	float m_size;
+	StringType m_strings[TEXT_BATCHER_MAX_STRINGS];
+	int m_stringCount;
+	int m_maxQuads;
+	int m_reservedQuads;
+
+	ID3D11Buffer* m_vertexBuffer;
+	ID3D11Buffer* m_indexBuffer;
+	int m_ringVertices;
+	int m_head;
+	bool m_changed;
+
+	int m_baseVertex;
+	int m_quadCount;
+
+	void Layout(StringType* string);
+	bool Upload(RenderContext* deviceContext);
+public:
+	TextBatcher();
+	TextBatcher(const TextBatcher&);
+	~TextBatcher();
+
+	// Lays the strings out at size pixels per em. maxQuads is the number of characters all strings together can show.
+	bool Initialize(ID3D11Device* device, GlyphCache* font, float size, int maxQuads);
+	void Shutdown();
+
+	// Adds a hidden, empty string of up to maxLength characters and returns its handle, or -1 when there is no room.
+	int AddString(int maxLength);
+	// Shows text with its top left corner at (x, y), centered screen coordinates with y pointing up. Returns false
+	// when the text is longer than the string.
+	bool SetString(int handle, const char* text, float x, float y, unsigned int color);
+	void SetVisible(int handle, bool visible);
+
+	// Uploads the quads if anything changed and binds the buffers for the draw.
+	bool Render(RenderContext* deviceContext);
+
+	int GetIndexCount();
+	int GetBaseVertex();
+
+	// Copies the parts of the glyph page the cache wrote since the last upload to the texture of the page.
+	static void UploadGlyphs(RenderContext* deviceContext, GlyphCache* font, ID3D11Resource* texture);
+};
@@ -0,0 +1,140 @@
+#include "TextLayout.h"
+
+static unsigned int PackChannel(float value)
+{
+	if (value < 0.0f)
+	{
+		value = 0.0f;
+	}
+
+	if (value > 1.0f)
+	{
+		value = 1.0f;
+	}
+
+	return (unsigned int)(value * 255.0f + 0.5f);
+}
+
+// The glyph of a character, or of the question mark when the font does not have it.
+static const FontGlyph* FindGlyph(GlyphCache* font, unsigned int codepoint)
+{
+	const FontGlyph* glyph;
+
+	glyph = font->GetGlyph(codepoint);
+	if (!glyph)
+	{
+		glyph = font->GetGlyph('?');
+	}
+
+	return glyph;
+}
+
+unsigned int PackTextColor(float red, float green, float blue, float alpha)
+{
+	return PackChannel(red) | (PackChannel(green) << 8) | (PackChannel(blue) << 16) | (PackChannel(alpha) << 24);
+}
+
+int LayoutText(GlyphCache * font, const char * text, float x, float y, float size, unsigned int color, TextVertex * vertices,
+	int maxQuads)
+{
+	const FontGlyph* glyph;
+	TextVertex* quad;
+	unsigned int codepoint, previous;
+	int quadCount, j;
+	float scale, baseline, left, top, right, bottom;
+
+	quadCount = 0;
+	previous = 0;
+
+	// The metrics are given at the size of the atlas.
+	scale = size / font->GetHeader().pixelSize;
+	baseline = y - font->GetHeader().ascent * scale;
+
+	while (quadCount < maxQuads)
+	{
+		codepoint = DecodeUtf8(text);
+		if (codepoint == 0)
+		{
+			break;
+		}
+
+		glyph = FindGlyph(font, codepoint);
+		if (!glyph)
+		{
+			previous = 0;
+			continue;
+		}
+
+		if (previous)
+		{
+			x += font->GetKerning(previous, codepoint) * scale;
+		}
+		previous = codepoint;
+
+		// Glyphs without an outline only move the pen.
+		if (glyph->width > 0.0f)
+		{
+			left = x + glyph->offsetX * scale;
+			top = baseline + glyph->offsetY * scale;
+			right = left + glyph->width * scale;
+			bottom = top - glyph->height * scale;
+
+			quad = vertices + quadCount * TEXT_QUAD_VERTICES;
+
+			// Top left.
+			quad[0].x = left;
+			quad[0].y = top;
+			quad[0].u = glyph->u0;
+			quad[0].v = glyph->v0;
+
+			// Top right.
+			quad[1].x = right;
+			quad[1].y = top;
+			quad[1].u = glyph->u1;
+			quad[1].v = glyph->v0;
+
+			// Bottom left.
+			quad[2].x = left;
+			quad[2].y = bottom;
+			quad[2].u = glyph->u0;
+			quad[2].v = glyph->v1;
+
+			// Bottom right.
+			quad[3].x = right;
+			quad[3].y = bottom;
+			quad[3].u = glyph->u1;
+			quad[3].v = glyph->v1;
+
+			for (j = 0; j < TEXT_QUAD_VERTICES; j++)
+			{
+				quad[j].z = 0.0f;
+				quad[j].color = color;
+			}
+
+			quadCount++;
+		}
+
+		x += glyph->advance * scale;
+	}
+
+	return quadCount;
+}
+
+void BuildQuadIndices(unsigned short * indices, int quadCount)
+{
+	unsigned short first;
+	int i;
+
+	// Clockwise like the rest of the engine, top left, bottom right, bottom left and top left, top right, bottom right.
+	for (i = 0; i < quadCount; i++)
+	{
+		first = (unsigned short)(i * TEXT_QUAD_VERTICES);
+
+		indices[i * TEXT_QUAD_INDICES + 0] = first + 0;
+		indices[i * TEXT_QUAD_INDICES + 1] = first + 3;
+		indices[i * TEXT_QUAD_INDICES + 2] = first + 2;
+		indices[i * TEXT_QUAD_INDICES + 3] = first + 0;
+		indices[i * TEXT_QUAD_INDICES + 4] = first + 1;
+		indices[i * TEXT_QUAD_INDICES + 5] = first + 3;
+	}
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include "GlyphCache.h"
+#include "Utf8.h"
+
+// Glyph layout of the text batcher. Nothing in here touches Direct3D, so it builds and runs on its own.
+
+// Every quad uses four vertices and the same six indices, offset by four per quad.
+#define TEXT_QUAD_VERTICES 4
+#define TEXT_QUAD_INDICES 6
+
+// Color is packed as RGBA with red in the lowest byte.
+struct TextVertex
+{
+	float x, y, z;
+	float u, v;
+	unsigned int color;
+};
+
+unsigned int PackTextColor(float red, float green, float blue, float alpha);
+
+// Lays the UTF-8 string out at size pixels per em from the top left corner of its line at (x, y), with y pointing
+// up. The glyphs come from the cache, which loads the ones it does not have yet. Kerning pairs of the font are
+// applied and characters the font does not have fall back to a question mark. Writes the top left, top right,
+// bottom left and bottom right corner of at most maxQuads quads and returns how many quads were written.
+int LayoutText(GlyphCache* font, const char* text, float x, float y, float size, unsigned int color, TextVertex* vertices,
+	int maxQuads);
+
+// Fills the indices of quadCount quads in the corner order LayoutText writes.
+void BuildQuadIndices(unsigned short* indices, int quadCount);
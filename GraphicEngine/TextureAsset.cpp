@@ -15,6 +15,7 @@
 
 	bool TextureAsset::load(std::string path, Assets * assets)
 	{
+		PROFILE_ZONE("TextureAsset::load");
 		bool result;
 		int height, width;
 		D3D11_TEXTURE2D_DESC textureDesc;
@@ -53,7 +54,7 @@
 		rowPitch = (width * 4) * sizeof(unsigned char);
 
 		//Copy the tarha image data into the texture
-		assets->GetDeviceContext()->UpdateSubresource(m_texture, 0, NULL, m_targaData, rowPitch, 0);
+		assets->GetRenderContext()->UpdateSubresource(m_texture, 0, NULL, m_targaData, rowPitch, 0);
 
 		//Setup the shader resource view description
 		srvDesc.Format = textureDesc.Format;
@@ -69,7 +70,7 @@
 		}
 
 		// Generate mipmaps for this texture.
-		assets->GetDeviceContext()->GenerateMips(m_textureView);
+		assets->GetRenderContext()->GenerateMips(m_textureView);
 
 		// Release the targa image data now that the image data has been loaded into the texture.
 		delete[] m_targaData;
@@ -114,6 +115,7 @@
 
 	bool TextureAsset::LoadTarga(const char* filepath, int& height, int& width)
 	{
+		PROFILE_ZONE("TextureAsset::LoadTarga");
 		int error, bpp, imageSize, index, i, j, k;
 		FILE* filePtr;
 		unsigned int count;
@@ -0,0 +1,274 @@
+#include "TransformBatch.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+// The compiler emits AVX instructions in any function.
+#define AVX_FUNCTION
+#else
+#include <cpuid.h>
+// Other compilers only emit AVX instructions in functions built for it.
+#define AVX_FUNCTION __attribute__((target("avx")))
+#endif
+#include <immintrin.h>
+#include <atomic>
+
+// Jobs on several threads check it.
+static std::atomic<int> s_vectorPath(-1);
+
+static bool DetectVectorPath()
+{
+#ifdef _MSC_VER
+	int cpuInfo[4];
+	unsigned long long xcrFeatureMask;
+
+	// Check that the cpu supports AVX and that the OS saves the ymm registers.
+	__cpuid(cpuInfo, 1);
+	if ((cpuInfo[2] & (1 << 27)) == 0 || (cpuInfo[2] & (1 << 28)) == 0)
+	{
+		return false;
+	}
+
+	xcrFeatureMask = _xgetbv(0);
+	if ((xcrFeatureMask & 6) != 6)
+	{
+		return false;
+	}
+
+	return true;
+#else
+	// Checks the cpu and that the OS saves the ymm registers as well.
+	return __builtin_cpu_supports("avx") != 0;
+#endif
+}
+
+static void ComputeWorldMatrix(const TransformStreams& streams, int index, XMFLOAT4X4& worldMatrix)
+{
+	float x, y, z, w, x2, y2, z2;
+	float xx2, yy2, zz2, xy2, xz2, yz2, wx2, wy2, wz2;
+	float scaleX, scaleY, scaleZ;
+
+	x = streams.rotationX[index];
+	y = streams.rotationY[index];
+	z = streams.rotationZ[index];
+	w = streams.rotationW[index];
+
+	scaleX = streams.scaleX[index];
+	scaleY = streams.scaleY[index];
+	scaleZ = streams.scaleZ[index];
+
+	// Same products as XMMatrixRotationQuaternion.
+	x2 = x + x;
+	y2 = y + y;
+	z2 = z + z;
+
+	xx2 = x * x2;
+	yy2 = y * y2;
+	zz2 = z * z2;
+	xy2 = x * y2;
+	xz2 = x * z2;
+	yz2 = y * z2;
+	wx2 = w * x2;
+	wy2 = w * y2;
+	wz2 = w * z2;
+
+	worldMatrix._11 = scaleX * ((1.0f - yy2) - zz2);
+	worldMatrix._12 = scaleX * (xy2 + wz2);
+	worldMatrix._13 = scaleX * (xz2 - wy2);
+	worldMatrix._14 = 0.0f;
+
+	worldMatrix._21 = scaleY * (xy2 - wz2);
+	worldMatrix._22 = scaleY * ((1.0f - xx2) - zz2);
+	worldMatrix._23 = scaleY * (yz2 + wx2);
+	worldMatrix._24 = 0.0f;
+
+	worldMatrix._31 = scaleZ * (xz2 + wy2);
+	worldMatrix._32 = scaleZ * (yz2 - wx2);
+	worldMatrix._33 = scaleZ * ((1.0f - xx2) - yy2);
+	worldMatrix._34 = 0.0f;
+
+	worldMatrix._41 = streams.positionX[index];
+	worldMatrix._42 = streams.positionY[index];
+	worldMatrix._43 = streams.positionZ[index];
+	worldMatrix._44 = 1.0f;
+}
+
+// Transposes four vectors of eight lanes into one matrix row for each of the eight objects.
+AVX_FUNCTION static void StoreRows(__m256 a, __m256 b, __m256 c, __m256 d, XMFLOAT4X4* worldMatrices, int row)
+{
+	__m256 t0, t1, t2, t3, u0, u1, u2, u3;
+
+	t0 = _mm256_unpacklo_ps(a, b);
+	t1 = _mm256_unpackhi_ps(a, b);
+	t2 = _mm256_unpacklo_ps(c, d);
+	t3 = _mm256_unpackhi_ps(c, d);
+
+	u0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+	u1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+	u2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+	u3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+
+	_mm_storeu_ps(worldMatrices[0].m[row], _mm256_castps256_ps128(u0));
+	_mm_storeu_ps(worldMatrices[1].m[row], _mm256_castps256_ps128(u1));
+	_mm_storeu_ps(worldMatrices[2].m[row], _mm256_castps256_ps128(u2));
+	_mm_storeu_ps(worldMatrices[3].m[row], _mm256_castps256_ps128(u3));
+	_mm_storeu_ps(worldMatrices[4].m[row], _mm256_extractf128_ps(u0, 1));
+	_mm_storeu_ps(worldMatrices[5].m[row], _mm256_extractf128_ps(u1, 1));
+	_mm_storeu_ps(worldMatrices[6].m[row], _mm256_extractf128_ps(u2, 1));
+	_mm_storeu_ps(worldMatrices[7].m[row], _mm256_extractf128_ps(u3, 1));
+}
+
+AVX_FUNCTION static int ComputeWorldMatricesAVX(const TransformStreams& streams, int first, int count, XMFLOAT4X4* worldMatrices)
+{
+	__m256 x, y, z, w, x2, y2, z2;
+	__m256 xx2, yy2, zz2, xy2, xz2, yz2, wx2, wy2, wz2;
+	__m256 scaleX, scaleY, scaleZ, one, zero;
+	int i, index;
+
+	one = _mm256_set1_ps(1.0f);
+	zero = _mm256_setzero_ps();
+
+	// Process eight objects per iteration, the caller finishes the remainder.
+	for (i = 0; i + 8 <= count; i += 8)
+	{
+		index = first + i;
+
+		x = _mm256_loadu_ps(streams.rotationX + index);
+		y = _mm256_loadu_ps(streams.rotationY + index);
+		z = _mm256_loadu_ps(streams.rotationZ + index);
+		w = _mm256_loadu_ps(streams.rotationW + index);
+
+		scaleX = _mm256_loadu_ps(streams.scaleX + index);
+		scaleY = _mm256_loadu_ps(streams.scaleY + index);
+		scaleZ = _mm256_loadu_ps(streams.scaleZ + index);
+
+		x2 = _mm256_add_ps(x, x);
+		y2 = _mm256_add_ps(y, y);
+		z2 = _mm256_add_ps(z, z);
+
+		xx2 = _mm256_mul_ps(x, x2);
+		yy2 = _mm256_mul_ps(y, y2);
+		zz2 = _mm256_mul_ps(z, z2);
+		xy2 = _mm256_mul_ps(x, y2);
+		xz2 = _mm256_mul_ps(x, z2);
+		yz2 = _mm256_mul_ps(y, z2);
+		wx2 = _mm256_mul_ps(w, x2);
+		wy2 = _mm256_mul_ps(w, y2);
+		wz2 = _mm256_mul_ps(w, z2);
+
+		StoreRows(_mm256_mul_ps(scaleX, _mm256_sub_ps(_mm256_sub_ps(one, yy2), zz2)),
+			_mm256_mul_ps(scaleX, _mm256_add_ps(xy2, wz2)),
+			_mm256_mul_ps(scaleX, _mm256_sub_ps(xz2, wy2)),
+			zero, worldMatrices + i, 0);
+
+		StoreRows(_mm256_mul_ps(scaleY, _mm256_sub_ps(xy2, wz2)),
+			_mm256_mul_ps(scaleY, _mm256_sub_ps(_mm256_sub_ps(one, xx2), zz2)),
+			_mm256_mul_ps(scaleY, _mm256_add_ps(yz2, wx2)),
+			zero, worldMatrices + i, 1);
+
+		StoreRows(_mm256_mul_ps(scaleZ, _mm256_add_ps(xz2, wy2)),
+			_mm256_mul_ps(scaleZ, _mm256_sub_ps(yz2, wx2)),
+			_mm256_mul_ps(scaleZ, _mm256_sub_ps(_mm256_sub_ps(one, xx2), yy2)),
+			zero, worldMatrices + i, 2);
+
+		StoreRows(_mm256_loadu_ps(streams.positionX + index),
+			_mm256_loadu_ps(streams.positionY + index),
+			_mm256_loadu_ps(streams.positionZ + index),
+			one, worldMatrices + i, 3);
+	}
+
+	// Avoid the AVX to SSE transition penalty in the code that follows.
+	_mm256_zeroupper();
+
+	return i;
+}
+
+AVX_FUNCTION static int ComputeWorldViewProjectionMatricesAVX(const XMFLOAT4X4* worldMatrices, int count, CXMMATRIX viewProjectionMatrix,
+	XMFLOAT4X4* worldViewProjectionMatrices)
+{
+	XMFLOAT4X4 viewProjection;
+	__m256 row0, row1, row2, row3, rows, result;
+	int i, j;
+
+	XMStoreFloat4x4(&viewProjection, viewProjectionMatrix);
+
+	// Both 128 bit lanes hold the same view projection row.
+	row0 = _mm256_broadcast_ps((const __m128*)viewProjection.m[0]);
+	row1 = _mm256_broadcast_ps((const __m128*)viewProjection.m[1]);
+	row2 = _mm256_broadcast_ps((const __m128*)viewProjection.m[2]);
+	row3 = _mm256_broadcast_ps((const __m128*)viewProjection.m[3]);
+
+	// Two world matrix rows are transformed at once, in the same order as XMMatrixMultiply.
+	for (i = 0; i < count; i++)
+	{
+		for (j = 0; j < 4; j += 2)
+		{
+			rows = _mm256_loadu_ps(worldMatrices[i].m[j]);
+
+			result = _mm256_add_ps(_mm256_mul_ps(_mm256_permute_ps(rows, _MM_SHUFFLE(0, 0, 0, 0)), row0),
+				_mm256_mul_ps(_mm256_permute_ps(rows, _MM_SHUFFLE(2, 2, 2, 2)), row2));
+			result = _mm256_add_ps(result, _mm256_add_ps(_mm256_mul_ps(_mm256_permute_ps(rows, _MM_SHUFFLE(1, 1, 1, 1)), row1),
+				_mm256_mul_ps(_mm256_permute_ps(rows, _MM_SHUFFLE(3, 3, 3, 3)), row3)));
+
+			_mm256_storeu_ps(worldViewProjectionMatrices[i].m[j], result);
+		}
+	}
+
+	_mm256_zeroupper();
+
+	return count;
+}
+
+void ComputeWorldMatrices(const TransformStreams& streams, int first, int count, XMFLOAT4X4* worldMatrices)
+{
+	int i;
+
+	// Find out once if the vector path can be used on this machine.
+	if (s_vectorPath < 0)
+	{
+		s_vectorPath = DetectVectorPath() ? 1 : 0;
+	}
+
+	i = 0;
+	if (s_vectorPath == 1)
+	{
+		i = ComputeWorldMatricesAVX(streams, first, count, worldMatrices);
+	}
+
+	// Finish the objects that did not fill a full vector.
+	for (; i < count; i++)
+	{
+		ComputeWorldMatrix(streams, first + i, worldMatrices[i]);
+	}
+}
+
+void ComputeWorldViewProjectionMatrices(const XMFLOAT4X4* worldMatrices, int count, CXMMATRIX viewProjectionMatrix,
+	XMFLOAT4X4* worldViewProjectionMatrices)
+{
+	int i;
+
+	if (s_vectorPath < 0)
+	{
+		s_vectorPath = DetectVectorPath() ? 1 : 0;
+	}
+
+	if (s_vectorPath == 1)
+	{
+		ComputeWorldViewProjectionMatricesAVX(worldMatrices, count, viewProjectionMatrix, worldViewProjectionMatrices);
+		return;
+	}
+
+	for (i = 0; i < count; i++)
+	{
+		XMStoreFloat4x4(&worldViewProjectionMatrices[i], XMMatrixMultiply(XMLoadFloat4x4(&worldMatrices[i]), viewProjectionMatrix));
+	}
+}
+
+void SetTransformBatchVectorPath(bool enabled)
+{
+	s_vectorPath = (enabled && DetectVectorPath()) ? 1 : 0;
+}
+
+bool IsTransformBatchVectorPathAvailable()
+{
+	return DetectVectorPath();
+}
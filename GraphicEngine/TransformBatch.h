@@ -0,0 +1,33 @@
+#pragma once
+
+#include <DirectXMath.h>
+using namespace DirectX;
+
+// Structure of arrays view of a set of transforms. Every stream holds one float per object.
+struct TransformStreams
+{
+	float* positionX;
+	float* positionY;
+	float* positionZ;
+	float* rotationX;
+	float* rotationY;
+	float* rotationZ;
+	float* rotationW;
+	float* scaleX;
+	float* scaleY;
+	float* scaleZ;
+};
+
+// Builds scale * rotationQuaternion * translation matrices for objects [first, first + count).
+// The vector path handles eight objects per iteration and the scalar path handles the rest,
+// both follow the operation order of XMMatrixScaling * XMMatrixRotationQuaternion * XMMatrixTranslation
+// so the results match the SSE path of DirectXMath bit for bit. DirectXMath built with FMA rounds differently.
+void ComputeWorldMatrices(const TransformStreams& streams, int first, int count, XMFLOAT4X4* worldMatrices);
+
+// Multiplies count world matrices with a shared view projection matrix, in the order of XMMatrixMultiply.
+void ComputeWorldViewProjectionMatrices(const XMFLOAT4X4* worldMatrices, int count, CXMMATRIX viewProjectionMatrix,
+	XMFLOAT4X4* worldViewProjectionMatrices);
+
+// Force the scalar path, used to compare both paths against each other.
+void SetTransformBatchVectorPath(bool enabled);
+bool IsTransformBatchVectorPathAvailable();
@@ -0,0 +1,525 @@
+#include <algorithm>
+#include "TransformHierarchy.h"
+
+void TransformHierarchy::MarkDirty(int slot)
+{
+	// Every changed slot goes on the list once until the next update.
+	if (!m_dirty[slot])
+	{
+		m_dirty[slot] = 1;
+		m_dirtySlots[m_dirtyCount++] = slot;
+	}
+}
+
+void TransformHierarchy::ScatterStream(float** stream, int* newSlots)
+{
+	float* sorted;
+	int i;
+
+	// Move one component stream into the new slot order.
+	sorted = new float[m_maxNodes];
+	for (i = 0; i < m_nodeCount; i++)
+	{
+		sorted[newSlots[i]] = (*stream)[i];
+	}
+
+	delete[] *stream;
+	*stream = sorted;
+}
+
+void TransformHierarchy::SortBreadthFirst()
+{
+	int* depthStart;
+	int* newSlots;
+	int* parents;
+	int* depths;
+	int* slotToNode;
+	XMFLOAT3* rotations;
+	XMFLOAT4X4* localMatrices;
+	XMFLOAT4X4* worldMatrices;
+	unsigned char* dirty;
+	unsigned int* updateFrames;
+	int* firstChildren;
+	int* nextSiblings;
+	int i, maxDepth, slot, total, count;
+
+	// Find the deepest level so the slots can be counting sorted by depth.
+	maxDepth = 0;
+	for (i = 0; i < m_nodeCount; i++)
+	{
+		if (m_depths[i] > maxDepth)
+		{
+			maxDepth = m_depths[i];
+		}
+	}
+
+	// Count the nodes on every level and turn the counts into start offsets.
+	depthStart = new int[maxDepth + 1];
+	memset(depthStart, 0, sizeof(int) * (maxDepth + 1));
+
+	for (i = 0; i < m_nodeCount; i++)
+	{
+		depthStart[m_depths[i]]++;
+	}
+
+	total = 0;
+	for (i = 0; i <= maxDepth; i++)
+	{
+		count = depthStart[i];
+		depthStart[i] = total;
+		total += count;
+	}
+
+	// Give every slot its new place, keeping the creation order within a level.
+	newSlots = new int[m_nodeCount];
+	for (i = 0; i < m_nodeCount; i++)
+	{
+		newSlots[i] = depthStart[m_depths[i]]++;
+	}
+
+	// Scatter all of the slot data into the new order.
+	parents = new int[m_maxNodes];
+	depths = new int[m_maxNodes];
+	slotToNode = new int[m_maxNodes];
+	rotations = new XMFLOAT3[m_maxNodes];
+	localMatrices = new XMFLOAT4X4[m_maxNodes];
+	worldMatrices = new XMFLOAT4X4[m_maxNodes];
+	dirty = new unsigned char[m_maxNodes];
+	updateFrames = new unsigned int[m_maxNodes];
+	firstChildren = new int[m_maxNodes];
+	nextSiblings = new int[m_maxNodes];
+
+	for (i = 0; i < m_nodeCount; i++)
+	{
+		slot = newSlots[i];
+
+		parents[slot] = (m_parents[i] >= 0) ? newSlots[m_parents[i]] : -1;
+		depths[slot] = m_depths[i];
+		slotToNode[slot] = m_slotToNode[i];
+		rotations[slot] = m_rotations[i];
+		localMatrices[slot] = m_localMatrices[i];
+		worldMatrices[slot] = m_worldMatrices[i];
+		dirty[slot] = m_dirty[i];
+		updateFrames[slot] = m_updateFrames[i];
+		firstChildren[slot] = (m_firstChildren[i] >= 0) ? newSlots[m_firstChildren[i]] : -1;
+		nextSiblings[slot] = (m_nextSiblings[i] >= 0) ? newSlots[m_nextSiblings[i]] : -1;
+
+		m_nodeToSlot[m_slotToNode[i]] = slot;
+	}
+
+	// The changed slots move along with their nodes.
+	for (i = 0; i < m_dirtyCount; i++)
+	{
+		m_dirtySlots[i] = newSlots[m_dirtySlots[i]];
+	}
+
+	delete[] depthStart;
+
+	// The transform streams are scattered one component at a time.
+	ScatterStream(&m_streams.positionX, newSlots);
+	ScatterStream(&m_streams.positionY, newSlots);
+	ScatterStream(&m_streams.positionZ, newSlots);
+	ScatterStream(&m_streams.rotationX, newSlots);
+	ScatterStream(&m_streams.rotationY, newSlots);
+	ScatterStream(&m_streams.rotationZ, newSlots);
+	ScatterStream(&m_streams.rotationW, newSlots);
+	ScatterStream(&m_streams.scaleX, newSlots);
+	ScatterStream(&m_streams.scaleY, newSlots);
+	ScatterStream(&m_streams.scaleZ, newSlots);
+
+	delete[] newSlots;
+
+	// Swap in the sorted arrays.
+	delete[] m_parents;
+	delete[] m_depths;
+	delete[] m_slotToNode;
+	delete[] m_rotations;
+	delete[] m_localMatrices;
+	delete[] m_worldMatrices;
+	delete[] m_dirty;
+	delete[] m_updateFrames;
+	delete[] m_firstChildren;
+	delete[] m_nextSiblings;
+
+	m_parents = parents;
+	m_depths = depths;
+	m_slotToNode = slotToNode;
+	m_rotations = rotations;
+	m_localMatrices = localMatrices;
+	m_worldMatrices = worldMatrices;
+	m_dirty = dirty;
+	m_updateFrames = updateFrames;
+	m_firstChildren = firstChildren;
+	m_nextSiblings = nextSiblings;
+
+	m_sorted = true;
+}
+
+TransformHierarchy::TransformHierarchy()
+{
+	m_maxNodes = 0;
+	m_nodeCount = 0;
+
+	m_parents = 0;
+	m_depths = 0;
+	m_slotToNode = 0;
+	memset(&m_streams, 0, sizeof(m_streams));
+	m_rotations = 0;
+	m_localMatrices = 0;
+	m_worldMatrices = 0;
+	m_dirty = 0;
+	m_updateFrames = 0;
+	m_firstChildren = 0;
+	m_nextSiblings = 0;
+	m_nodeToSlot = 0;
+
+	m_dirtySlots = 0;
+	m_dirtyCount = 0;
+	m_stack = 0;
+	m_frame = 0;
+	m_updatedCount = 0;
+	m_sorted = true;
+}
+
+TransformHierarchy::~TransformHierarchy()
+{
+}
+
+bool TransformHierarchy::Initialize(int maxNodes)
+{
+	//Store the maximum number of nodes
+	m_maxNodes = maxNodes;
+	m_nodeCount = 0;
+
+	//Create the node arrays
+	m_parents = new int[m_maxNodes];
+	m_depths = new int[m_maxNodes];
+	m_slotToNode = new int[m_maxNodes];
+	m_nodeToSlot = new int[m_maxNodes];
+	m_rotations = new XMFLOAT3[m_maxNodes];
+	m_localMatrices = new XMFLOAT4X4[m_maxNodes];
+	m_worldMatrices = new XMFLOAT4X4[m_maxNodes];
+	m_dirty = new unsigned char[m_maxNodes];
+	m_updateFrames = new unsigned int[m_maxNodes];
+	m_firstChildren = new int[m_maxNodes];
+	m_nextSiblings = new int[m_maxNodes];
+	m_dirtySlots = new int[m_maxNodes];
+	m_stack = new int[m_maxNodes];
+	if (!m_parents || !m_depths || !m_slotToNode || !m_nodeToSlot || !m_rotations || !m_localMatrices ||
+		!m_worldMatrices || !m_dirty || !m_updateFrames || !m_firstChildren || !m_nextSiblings || !m_dirtySlots || !m_stack)
+	{
+		return false;
+	}
+
+	//Create the transform streams the batch kernel reads from
+	m_streams.positionX = new float[m_maxNodes];
+	m_streams.positionY = new float[m_maxNodes];
+	m_streams.positionZ = new float[m_maxNodes];
+	m_streams.rotationX = new float[m_maxNodes];
+	m_streams.rotationY = new float[m_maxNodes];
+	m_streams.rotationZ = new float[m_maxNodes];
+	m_streams.rotationW = new float[m_maxNodes];
+	m_streams.scaleX = new float[m_maxNodes];
+	m_streams.scaleY = new float[m_maxNodes];
+	m_streams.scaleZ = new float[m_maxNodes];
+	if (!m_streams.positionX || !m_streams.positionY || !m_streams.positionZ || !m_streams.rotationX || !m_streams.rotationY ||
+		!m_streams.rotationZ || !m_streams.rotationW || !m_streams.scaleX || !m_streams.scaleY || !m_streams.scaleZ)
+	{
+		return false;
+	}
+
+	m_dirtyCount = 0;
+	m_frame = 0;
+	m_updatedCount = 0;
+	m_sorted = true;
+
+	return true;
+}
+
+void TransformHierarchy::Shutdown()
+{
+	// Release the node arrays.
+	delete[] m_parents;
+	delete[] m_depths;
+	delete[] m_slotToNode;
+	delete[] m_nodeToSlot;
+	delete[] m_rotations;
+	delete[] m_localMatrices;
+	delete[] m_worldMatrices;
+	delete[] m_dirty;
+	delete[] m_updateFrames;
+	delete[] m_firstChildren;
+	delete[] m_nextSiblings;
+	delete[] m_dirtySlots;
+	delete[] m_stack;
+
+	// Release the transform streams.
+	delete[] m_streams.positionX;
+	delete[] m_streams.positionY;
+	delete[] m_streams.positionZ;
+	delete[] m_streams.rotationX;
+	delete[] m_streams.rotationY;
+	delete[] m_streams.rotationZ;
+	delete[] m_streams.rotationW;
+	delete[] m_streams.scaleX;
+	delete[] m_streams.scaleY;
+	delete[] m_streams.scaleZ;
+	memset(&m_streams, 0, sizeof(m_streams));
+
+	m_parents = 0;
+	m_depths = 0;
+	m_slotToNode = 0;
+	m_nodeToSlot = 0;
+	m_rotations = 0;
+	m_localMatrices = 0;
+	m_worldMatrices = 0;
+	m_dirty = 0;
+	m_updateFrames = 0;
+	m_firstChildren = 0;
+	m_nextSiblings = 0;
+	m_dirtySlots = 0;
+	m_stack = 0;
+
+	m_dirtyCount = 0;
+	m_nodeCount = 0;
+	m_maxNodes = 0;
+}
+
+int TransformHierarchy::CreateNode(int parentNode)
+{
+	int node, slot, parentSlot;
+
+	//Check that there is room for another node
+	if (m_nodeCount >= m_maxNodes)
+	{
+		return -1;
+	}
+
+	//New nodes always go at the end, after their parent
+	node = m_nodeCount;
+	slot = m_nodeCount;
+	parentSlot = (parentNode >= 0) ? m_nodeToSlot[parentNode] : -1;
+
+	m_parents[slot] = parentSlot;
+	m_depths[slot] = (parentSlot >= 0) ? m_depths[parentSlot] + 1 : 0;
+	m_slotToNode[slot] = node;
+	m_nodeToSlot[node] = slot;
+
+	m_streams.positionX[slot] = 0.0f;
+	m_streams.positionY[slot] = 0.0f;
+	m_streams.positionZ[slot] = 0.0f;
+	m_streams.rotationX[slot] = 0.0f;
+	m_streams.rotationY[slot] = 0.0f;
+	m_streams.rotationZ[slot] = 0.0f;
+	m_streams.rotationW[slot] = 1.0f;
+	m_streams.scaleX[slot] = 1.0f;
+	m_streams.scaleY[slot] = 1.0f;
+	m_streams.scaleZ[slot] = 1.0f;
+	m_rotations[slot] = XMFLOAT3(0.0f, 0.0f, 0.0f);
+	XMStoreFloat4x4(&m_localMatrices[slot], XMMatrixIdentity());
+	XMStoreFloat4x4(&m_worldMatrices[slot], XMMatrixIdentity());
+	m_dirty[slot] = 0;
+	m_updateFrames[slot] = 0;
+
+	//Link the node into the children of its parent
+	m_firstChildren[slot] = -1;
+	m_nextSiblings[slot] = -1;
+	if (parentSlot >= 0)
+	{
+		m_nextSiblings[slot] = m_firstChildren[parentSlot];
+		m_firstChildren[parentSlot] = slot;
+	}
+
+	//A node that is shallower than the last one breaks the breadth first order
+	if (slot > 0 && m_depths[slot] < m_depths[slot - 1])
+	{
+		m_sorted = false;
+	}
+
+	m_nodeCount++;
+
+	MarkDirty(slot);
+
+	return node;
+}
+
+void TransformHierarchy::SetPosition(int node, float positionX, float positionY, float positionZ)
+{
+	int slot = m_nodeToSlot[node];
+
+	m_streams.positionX[slot] = positionX;
+	m_streams.positionY[slot] = positionY;
+	m_streams.positionZ[slot] = positionZ;
+	MarkDirty(slot);
+}
+
+void TransformHierarchy::GetPosition(int node, float & positionX, float & positionY, float & positionZ)
+{
+	int slot = m_nodeToSlot[node];
+
+	positionX = m_streams.positionX[slot];
+	positionY = m_streams.positionY[slot];
+	positionZ = m_streams.positionZ[slot];
+}
+
+void TransformHierarchy::SetRotation(int node, float rotationX, float rotationY, float rotationZ)
+{
+	int slot = m_nodeToSlot[node];
+	XMFLOAT4 quaternion;
+
+	//Keep the euler angles for the getter and store the quaternion for the batch kernel
+	m_rotations[slot] = XMFLOAT3(rotationX, rotationY, rotationZ);
+	XMStoreFloat4(&quaternion, XMQuaternionRotationRollPitchYaw(rotationX, rotationY, rotationZ));
+
+	m_streams.rotationX[slot] = quaternion.x;
+	m_streams.rotationY[slot] = quaternion.y;
+	m_streams.rotationZ[slot] = quaternion.z;
+	m_streams.rotationW[slot] = quaternion.w;
+	MarkDirty(slot);
+}
+
+void TransformHierarchy::GetRotation(int node, float & rotationX, float & rotationY, float & rotationZ)
+{
+	int slot = m_nodeToSlot[node];
+
+	rotationX = m_rotations[slot].x;
+	rotationY = m_rotations[slot].y;
+	rotationZ = m_rotations[slot].z;
+}
+
+void TransformHierarchy::SetScale(int node, float scaleX, float scaleY, float scaleZ)
+{
+	int slot = m_nodeToSlot[node];
+
+	m_streams.scaleX[slot] = scaleX;
+	m_streams.scaleY[slot] = scaleY;
+	m_streams.scaleZ[slot] = scaleZ;
+	MarkDirty(slot);
+}
+
+void TransformHierarchy::GetScale(int node, float & scaleX, float & scaleY, float & scaleZ)
+{
+	int slot = m_nodeToSlot[node];
+
+	scaleX = m_streams.scaleX[slot];
+	scaleY = m_streams.scaleY[slot];
+	scaleZ = m_streams.scaleZ[slot];
+}
+
+void TransformHierarchy::Update()
+{
+	int i, slot;
+
+	//Restore the breadth first order if nodes were added out of order
+	if (!m_sorted)
+	{
+		SortBreadthFirst();
+	}
+
+	m_updatedCount = 0;
+
+	//Nothing changed since the last update so static scenes cost nothing
+	if (m_dirtyCount == 0)
+	{
+		return;
+	}
+
+	m_frame++;
+
+	//In slot order a changed parent comes before its changed children and neighbouring slots form runs
+	std::sort(m_dirtySlots, m_dirtySlots + m_dirtyCount);
+
+	//Rebuild the local matrices of the changed nodes with the batch kernel, the jobs write separate nodes
+	JobSystem::ParallelFor(m_dirtyCount, TRANSFORM_JOB_GRAIN, ComputeLocalMatrices, this);
+
+	//Walk the subtree below every changed node, unless it was already walked below a changed ancestor
+	for (i = 0; i < m_dirtyCount; i++)
+	{
+		slot = m_dirtySlots[i];
+		if (m_updateFrames[slot] != m_frame)
+		{
+			UpdateSubtree(slot);
+		}
+	}
+
+	for (i = 0; i < m_dirtyCount; i++)
+	{
+		m_dirty[m_dirtySlots[i]] = 0;
+	}
+
+	m_dirtyCount = 0;
+}
+
+void TransformHierarchy::UpdateSubtree(int root)
+{
+	XMMATRIX localMatrix, worldMatrix;
+	int top, slot, parent, child;
+
+	//Every node is pushed once, so the stack never holds more than all of them
+	top = 0;
+	m_stack[top++] = root;
+
+	while (top > 0)
+	{
+		slot = m_stack[--top];
+		parent = m_parents[slot];
+		localMatrix = XMLoadFloat4x4(&m_localMatrices[slot]);
+
+		//Concatenate with the parent world matrix
+		if (parent >= 0)
+		{
+			worldMatrix = localMatrix * XMLoadFloat4x4(&m_worldMatrices[parent]);
+		}
+		else
+		{
+			worldMatrix = localMatrix;
+		}
+
+		XMStoreFloat4x4(&m_worldMatrices[slot], worldMatrix);
+		m_updateFrames[slot] = m_frame;
+		m_updatedCount++;
+
+		for (child = m_firstChildren[slot]; child >= 0; child = m_nextSiblings[child])
+		{
+			m_stack[top++] = child;
+		}
+	}
+}
+
+void TransformHierarchy::ComputeLocalMatrices(void * data, int begin, int end)
+{
+	TransformHierarchy* hierarchy;
+	int i, runStart;
+
+	hierarchy = (TransformHierarchy*)data;
+
+	//The range is a part of the sorted list of changed slots, neighbouring slots go to the kernel together
+	i = begin;
+	while (i < end)
+	{
+		runStart = i;
+		i++;
+		while (i < end && hierarchy->m_dirtySlots[i] == hierarchy->m_dirtySlots[i - 1] + 1)
+		{
+			i++;
+		}
+
+		ComputeWorldMatrices(hierarchy->m_streams, hierarchy->m_dirtySlots[runStart], i - runStart,
+			&hierarchy->m_localMatrices[hierarchy->m_dirtySlots[runStart]]);
+	}
+}
+
+XMMATRIX TransformHierarchy::GetWorldMatrix(int node)
+{
+	return XMLoadFloat4x4(&m_worldMatrices[m_nodeToSlot[node]]);
+}
+
+int TransformHierarchy::GetNodeCount()
+{
+	return m_nodeCount;
+}
+
+int TransformHierarchy::GetUpdatedCount()
+{
+	return m_updatedCount;
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <DirectXMath.h>
+#include <string.h>
+using namespace DirectX;
+
+#include "TransformBatch.h"
+#include "JobSystem.h"
+
+// Changed nodes one job rebuilds the local matrices of.
+#define TRANSFORM_JOB_GRAIN 1024
+
+// Parent/child transform storage. Nodes are kept in breadth-first order so that a parent
+// always comes before its children. Changed nodes go on a list, Update() only walks the
+// subtrees below them, so nodes that did not move cost nothing however many there are.
+class TransformHierarchy
+{
+private:
+	int m_maxNodes;
+	int m_nodeCount;
+
+	// Per slot data, indexed in breadth-first order.
+	int* m_parents;
+	int* m_depths;
+	int* m_slotToNode;
+	TransformStreams m_streams;
+	XMFLOAT3* m_rotations;
+	XMFLOAT4X4* m_localMatrices;
+	XMFLOAT4X4* m_worldMatrices;
+	unsigned char* m_dirty;
+	unsigned int* m_updateFrames;
+	// Children of a slot are linked from the first one, -1 ends the list.
+	int* m_firstChildren;
+	int* m_nextSiblings;
+
+	// Node handles stay stable when the slots are reordered.
+	int* m_nodeToSlot;
+
+	// Slots changed since the last update and the stack the subtrees below them are walked with.
+	int* m_dirtySlots;
+	int m_dirtyCount;
+	int* m_stack;
+
+	unsigned int m_frame;
+	int m_updatedCount;
+	bool m_sorted;
+
+	void MarkDirty(int slot);
+	void ScatterStream(float** stream, int* newSlots);
+	void SortBreadthFirst();
+	void UpdateSubtree(int root);
+	static void ComputeLocalMatrices(void* data, int begin, int end);
+public:
+	TransformHierarchy();
+	~TransformHierarchy();
+
+	bool Initialize(int maxNodes);
+	void Shutdown();
+
+	int CreateNode(int parentNode);
+
+	void SetPosition(int node, float positionX, float positionY, float positionZ);
+	void GetPosition(int node, float& positionX, float& positionY, float& positionZ);
+
+	// The angles are stored as a quaternion, the matrix is within 1e-6 per unit of scale of XMMatrixRotationRollPitchYaw.
+	void SetRotation(int node, float rotationX, float rotationY, float rotationZ);
+	void GetRotation(int node, float& rotationX, float& rotationY, float& rotationZ);
+
+	void SetScale(int node, float scaleX, float scaleY, float scaleZ);
+	void GetScale(int node, float& scaleX, float& scaleY, float& scaleZ);
+
+	void Update();
+
+	XMMATRIX GetWorldMatrix(int node);
+
+	int GetNodeCount();
+	int GetUpdatedCount();
+};
@@ -0,0 +1,64 @@
+#pragma once
+#include <atomic>
+
+// Hands the newest of a stream of values from one producer thread to one consumer thread without locks or
+// waiting. The producer writes into a back slot and publishes it, the consumer takes the newest published slot
+// and reads it for as long as it likes. Neither side ever sees the slot the other one works on, a value the
+// consumer did not pick up in time is overwritten by the next one. Nothing in here touches Windows or Direct3D.
+template<typename T>
+class TripleBuffer
+{
+private:
+	// Set on the middle slot when it holds a value the consumer has not taken yet.
+	static const int FRESH = 4;
+	static const int INDEX_MASK = 3;
+
+	T m_slots[3];
+	// Slot between the two threads, with FRESH.
+	std::atomic<int> m_middle;
+	// Only the producer touches the back slot and only the consumer the front slot.
+	int m_back;
+	int m_front;
+public:
+	TripleBuffer()
+		: m_middle(1)
+	{
+		m_back = 0;
+		m_front = 2;
+	}
+
+	// Slot the producer fills, it keeps what was last written to it three publishes ago.
+	T& GetWriteBuffer()
+	{
+		return m_slots[m_back];
+	}
+
+	// Makes the write buffer the newest value and gives the producer the slot it swapped out.
+	void Publish()
+	{
+		// Release so the consumer sees the writes to the slot, acquire so the producer only writes the slot it
+		// gets back once the consumer is done reading it.
+		m_back = m_middle.exchange(m_back | FRESH, std::memory_order_acq_rel) & INDEX_MASK;
+	}
+
+	// Takes the newest published value if there is one the consumer has not taken yet. Returns false and keeps
+	// the read buffer otherwise.
+	bool Acquire()
+	{
+		if (!(m_middle.load(std::memory_order_relaxed) & FRESH))
+		{
+			return false;
+		}
+
+		// The producer may publish in between, then the exchange takes the even newer value.
+		m_front = m_middle.exchange(m_front, std::memory_order_acq_rel) & INDEX_MASK;
+
+		return true;
+	}
+
+	// Value of the last successful Acquire.
+	const T& GetReadBuffer() const
+	{
+		return m_slots[m_front];
+	}
+};
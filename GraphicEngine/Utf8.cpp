@@ -0,0 +1,66 @@
+#include "Utf8.h"
+
+unsigned int DecodeUtf8(const char *& text)
+{
+	const unsigned char* bytes;
+	unsigned int codepoint, minimum;
+	int length, i;
+
+	bytes = (const unsigned char*)text;
+
+	if (bytes[0] == 0)
+	{
+		return 0;
+	}
+
+	// The lead byte gives the length of the sequence and the first bits of the codepoint.
+	if (bytes[0] < 0x80)
+	{
+		text++;
+		return bytes[0];
+	}
+	else if ((bytes[0] & 0xe0) == 0xc0)
+	{
+		length = 2;
+		codepoint = bytes[0] & 0x1f;
+		minimum = 0x80;
+	}
+	else if ((bytes[0] & 0xf0) == 0xe0)
+	{
+		length = 3;
+		codepoint = bytes[0] & 0x0f;
+		minimum = 0x800;
+	}
+	else if ((bytes[0] & 0xf8) == 0xf0)
+	{
+		length = 4;
+		codepoint = bytes[0] & 0x07;
+		minimum = 0x10000;
+	}
+	else
+	{
+		text++;
+		return UTF8_REPLACEMENT;
+	}
+
+	// A continuation byte that is missing, including the end of the string, only costs the lead byte.
+	for (i = 1; i < length; i++)
+	{
+		if ((bytes[i] & 0xc0) != 0x80)
+		{
+			text++;
+			return UTF8_REPLACEMENT;
+		}
+
+		codepoint = (codepoint << 6) | (bytes[i] & 0x3f);
+	}
+
+	text += length;
+
+	if (codepoint < minimum || codepoint > 0x10ffff || (codepoint >= 0xd800 && codepoint <= 0xdfff))
+	{
+		return UTF8_REPLACEMENT;
+	}
+
+	return codepoint;
+}
@@ -0,0 +1,9 @@
+#pragma once
+
+// Codepoint drawn for bytes that are not valid UTF-8.
+#define UTF8_REPLACEMENT 0xfffd
+
+// Reads the codepoint at text and moves text past it. Returns 0 at the end of the string, which text is left
+// pointing at, and UTF8_REPLACEMENT for every byte that does not start a valid sequence, including overlong
+// forms, surrogates and values past U+10FFFF.
+unsigned int DecodeUtf8(const char*& text);
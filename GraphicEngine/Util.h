@@ -1,9 +1,14 @@
 #pragma once
+#ifdef _WIN32
 #ifdef GRAPHIC_EXPORTS  
 #define GRAPHIC_API __declspec(dllexport)   
 #else  
 #define GRAPHIC_API __declspec(dllimport)   
 #endif
+#else
+// Built into the tests directly, nothing is exported.
+#define GRAPHIC_API
+#endif
 
 #include <Windows.h>
 
@@ -0,0 +1,102 @@
+#pragma once
+#include <atomic>
+
+// Chase-Lev work stealing deque of pointers with a fixed capacity, which has to be a power of two. The thread that
+// owns the deque pushes and pops at the bottom, any other thread steals from the top. Only the last item left
+// needs a compare and swap between the owner and a thief. Nothing in here touches Windows or Direct3D.
+template<typename T, int CAPACITY>
+class WorkStealingDeque
+{
+private:
+	static const int INDEX_MASK = CAPACITY - 1;
+
+	std::atomic<T*> m_items[CAPACITY];
+	std::atomic<long long> m_top;
+	std::atomic<long long> m_bottom;
+public:
+	WorkStealingDeque()
+		: m_top(0), m_bottom(0)
+	{
+		static_assert((CAPACITY & (CAPACITY - 1)) == 0, "The capacity has to be a power of two.");
+	}
+
+	// Owner only. Returns false when the deque is full.
+	bool Push(T* item)
+	{
+		long long bottom, top;
+
+		bottom = m_bottom.load(std::memory_order_relaxed);
+		top = m_top.load(std::memory_order_acquire);
+		if (bottom - top >= CAPACITY)
+		{
+			return false;
+		}
+
+		m_items[bottom & INDEX_MASK].store(item, std::memory_order_relaxed);
+
+		// Release so a thief that sees the new bottom also sees the item and what it points to.
+		m_bottom.store(bottom + 1, std::memory_order_release);
+
+		return true;
+	}
+
+	// Owner only. Takes the newest item, returns 0 when the deque is empty.
+	T* Pop()
+	{
+		long long bottom, top;
+		T* item;
+
+		// Claim the bottom item first, a thief that reads the top afterwards then sees it is gone.
+		bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+		m_bottom.store(bottom, std::memory_order_seq_cst);
+		top = m_top.load(std::memory_order_seq_cst);
+
+		if (top > bottom)
+		{
+			// Empty, put the bottom back.
+			m_bottom.store(bottom + 1, std::memory_order_release);
+			return 0;
+		}
+
+		item = m_items[bottom & INDEX_MASK].load(std::memory_order_relaxed);
+
+		// More than one item left, no thief can reach this one.
+		if (top < bottom)
+		{
+			return item;
+		}
+
+		// The last item, whoever moves the top first gets it.
+		if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+		{
+			item = 0;
+		}
+
+		m_bottom.store(bottom + 1, std::memory_order_release);
+
+		return item;
+	}
+
+	// Any thread. Takes the oldest item, returns 0 when the deque is empty or another thread took it first.
+	T* Steal()
+	{
+		long long top, bottom;
+		T* item;
+
+		top = m_top.load(std::memory_order_seq_cst);
+		bottom = m_bottom.load(std::memory_order_seq_cst);
+		if (top >= bottom)
+		{
+			return 0;
+		}
+
+		// The owner cannot write this slot again before the top moved past it, and then the exchange fails.
+		item = m_items[top & INDEX_MASK].load(std::memory_order_relaxed);
+		if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+		{
+			return 0;
+		}
+
+		return item;
+	}
+};
@@ -0,0 +1,156 @@
+#include <vector>
+#include "Test.h"
+#include "AtlasPacker.h"
+
+namespace
+{
+	const int WIDTH = 64;
+	const int HEIGHT = 32;
+
+	unsigned int s_seed = 99;
+
+	int RandomInt(int count)
+	{
+		s_seed = s_seed * 1664525u + 1013904223u;
+		return (int)((s_seed >> 8) % (unsigned int)count);
+	}
+
+	bool Overlaps(const AtlasRect& a, const AtlasRect& b)
+	{
+		return a.x < b.x + b.width && b.x < a.x + a.width && a.y < b.y + b.height && b.y < a.y + a.height;
+	}
+
+	bool Inside(const AtlasRect& rect)
+	{
+		return rect.x >= 0 && rect.y >= 0 && rect.x + rect.width <= WIDTH && rect.y + rect.height <= HEIGHT;
+	}
+
+	// Rectangles of one height share a shelf left to right, other heights open shelves below until the page is full.
+	void TestShelves()
+	{
+		AtlasPacker packer;
+		AtlasRect rect;
+
+		packer.Initialize(WIDTH, HEIGHT);
+
+		CHECK(packer.Allocate(20, 5, rect));
+		CHECK(rect.x == 0 && rect.y == 0 && rect.width == 20 && rect.height == 5);
+
+		// Heights round up to the same shelf.
+		CHECK(packer.Allocate(20, ATLAS_SHELF_ALIGNMENT, rect));
+		CHECK(rect.x == 20 && rect.y == 0);
+		CHECK(packer.GetShelfCount() == 1);
+
+		CHECK(packer.Allocate(10, 12, rect));
+		CHECK(rect.x == 0 && rect.y == ATLAS_SHELF_ALIGNMENT);
+		CHECK(packer.GetShelfCount() == 2);
+
+		// The rest of the first shelf is 24 wide.
+		CHECK(packer.Allocate(24, 3, rect));
+		CHECK(rect.x == 40 && rect.y == 0);
+		CHECK(!packer.Allocate(WIDTH, 16, rect));
+		CHECK(packer.Allocate(WIDTH, 8, rect));
+		CHECK(rect.y == 24);
+		CHECK(!packer.Allocate(1, 1, rect));
+
+		// Nothing that cannot be placed at all.
+		CHECK(!packer.Allocate(0, 4, rect));
+		CHECK(!packer.Allocate(4, 0, rect));
+		CHECK(!packer.Allocate(WIDTH + 1, 4, rect));
+
+		packer.Clear();
+		CHECK(packer.GetShelfCount() == 0);
+		CHECK(packer.Allocate(WIDTH, HEIGHT, rect));
+	}
+
+	// A freed rectangle is handed out again, and free neighbours merge into one span.
+	void TestFree()
+	{
+		AtlasPacker packer;
+		AtlasRect rects[4], rect;
+		int i;
+
+		packer.Initialize(WIDTH, HEIGHT);
+
+		for (i = 0; i < 4; i++)
+		{
+			CHECK(packer.Allocate(16, 8, rects[i]));
+		}
+
+		packer.Free(rects[1]);
+		CHECK(packer.Allocate(16, 8, rect));
+		CHECK(rect.x == rects[1].x && rect.y == rects[1].y);
+
+		// Two neighbours freed in either order take one rectangle of twice the width.
+		packer.Free(rects[2]);
+		packer.Free(rect);
+		CHECK(packer.Allocate(32, 8, rect));
+		CHECK(rect.x == 16 && rect.y == 0);
+		CHECK(packer.GetShelfCount() == 1);
+
+		// With every rectangle back the shelf is one span of the whole width again.
+		packer.Free(rects[0]);
+		packer.Free(rect);
+		packer.Free(rects[3]);
+		CHECK(packer.Allocate(WIDTH, 3, rect));
+		CHECK(rect.y == 0);
+		CHECK(packer.GetShelfCount() == 1);
+
+		// A shelf that is empty again takes lower rectangles as well, instead of opening a shelf of their height.
+		packer.Clear();
+		CHECK(packer.Allocate(WIDTH, 16, rect));
+		packer.Free(rect);
+		CHECK(packer.Allocate(10, 4, rect));
+		CHECK(rect.x == 0 && rect.y == 0);
+		CHECK(packer.GetShelfCount() == 1);
+	}
+
+	// Random allocations and frees never hand out overlapping rectangles or ones outside the page.
+	void TestRandom()
+	{
+		AtlasPacker packer;
+		std::vector<AtlasRect> live;
+		AtlasRect rect;
+		int step, i, allocated;
+
+		packer.Initialize(WIDTH, HEIGHT);
+		allocated = 0;
+
+		for (step = 0; step < 5000; step++)
+		{
+			if (!live.empty() && RandomInt(3) == 0)
+			{
+				i = RandomInt((int)live.size());
+				packer.Free(live[i]);
+				live.erase(live.begin() + i);
+				continue;
+			}
+
+			if (!packer.Allocate(1 + RandomInt(12), 1 + RandomInt(12), rect))
+			{
+				continue;
+			}
+
+			CHECK(Inside(rect));
+			for (i = 0; i < (int)live.size(); i++)
+			{
+				CHECK(!Overlaps(rect, live[i]));
+			}
+
+			live.push_back(rect);
+			allocated++;
+		}
+
+		// The page kept being reused, not just filled once.
+		CHECK(allocated > 1000);
+	}
+}
+
+int main()
+{
+	TestShelves();
+	TestFree();
+	TestRandom();
+
+	return TestResult("AtlasPackerTest");
+}
@@ -0,0 +1,294 @@
+#include <vector>
+#include "Test.h"
+#include "CommandRecorder.h"
+#include "FakeDevice.h"
+#include "NullRenderContext.h"
+
+namespace
+{
+	// A draw as the gpu would see it, with the texture that was bound for it.
+	struct RecordedDraw
+	{
+		unsigned int item;
+		ID3D11ShaderResourceView* texture;
+	};
+
+	class RecordedList : public FakeObject<ID3D11CommandList>
+	{
+	public:
+		std::vector<RecordedDraw> draws;
+	};
+
+	// Keeps the draws a deferred context records in its command lists and plays them back into the draws of the
+	// immediate context, which is what the test compares. A deferred context forgets its state with every
+	// command list, like one of Direct3D.
+	class RecordingContext : public NullRenderContext
+	{
+	private:
+		ID3D11ShaderResourceView* m_texture;
+		std::vector<RecordedList*> m_lists;
+	public:
+		std::vector<RecordedDraw> draws;
+
+		RecordingContext()
+		{
+			m_texture = 0;
+			Initialize();
+		}
+
+		~RecordingContext()
+		{
+			size_t i;
+
+			for (i = 0; i < m_lists.size(); i++)
+			{
+				delete m_lists[i];
+			}
+		}
+
+		void PSSetShaderResources(UINT startSlot, UINT viewCount, ID3D11ShaderResourceView* const* shaderResourceViews) override
+		{
+			NullRenderContext::PSSetShaderResources(startSlot, viewCount, shaderResourceViews);
+			m_texture = shaderResourceViews[0];
+		}
+
+		void DrawIndexed(UINT indexCount, UINT startIndex, INT baseVertex) override
+		{
+			RecordedDraw draw;
+
+			NullRenderContext::DrawIndexed(indexCount, startIndex, baseVertex);
+
+			// The index count carries the item.
+			draw.item = indexCount;
+			draw.texture = m_texture;
+			draws.push_back(draw);
+		}
+
+		HRESULT FinishCommandList(BOOL restoreDeferredContextState, ID3D11CommandList** commandList) override
+		{
+			RecordedList* list;
+
+			list = new RecordedList;
+			list->draws.swap(draws);
+			m_lists.push_back(list);
+			m_texture = 0;
+
+			*commandList = list;
+
+			return S_OK;
+		}
+
+		void ExecuteCommandList(ID3D11CommandList* commandList, BOOL restoreContextState) override
+		{
+			RecordedList* list;
+
+			list = (RecordedList*)commandList;
+			draws.insert(draws.end(), list->draws.begin(), list->draws.end());
+		}
+
+		RenderContext* CreateDeferredContext() override
+		{
+			return new RecordingContext;
+		}
+	};
+
+	struct RecordData
+	{
+		FakeShaderResourceView textures[3];
+		// Item whose chunk fails, -1 for none.
+		int failingItem;
+	};
+
+	// Every item draws once with one of three textures, neighbours often share it.
+	bool RecordItems(void* userData, RenderStateCache* stateCache, const RecordChunk& chunk)
+	{
+		RecordData* data;
+		int i;
+
+		data = (RecordData*)userData;
+
+		for (i = chunk.first; i < chunk.first + chunk.count; i++)
+		{
+			if (i == data->failingItem)
+			{
+				return false;
+			}
+
+			stateCache->SetPSShaderResource(0, &data->textures[(i / 5) % 3]);
+			stateCache->DrawIndexed((unsigned int)i, 0, 0);
+		}
+
+		return true;
+	}
+
+	void TestSplitRecordChunks()
+	{
+		RecordChunk chunks[COMMAND_RECORDER_MAX_WORKERS];
+		int count, maxChunks, minChunkSize, chunkCount, expected, first, smallest, largest, i, chunk;
+		const int minChunkSizes[3] = { 0, 1, COMMAND_RECORDER_MIN_CHUNK };
+
+		CHECK(SplitRecordChunks(0, 4, COMMAND_RECORDER_MIN_CHUNK, chunks) == 0);
+		CHECK(SplitRecordChunks(10, 0, COMMAND_RECORDER_MIN_CHUNK, chunks) == 0);
+
+		for (count = 1; count <= 400; count++)
+		{
+			for (maxChunks = 1; maxChunks <= COMMAND_RECORDER_MAX_WORKERS; maxChunks++)
+			{
+				for (i = 0; i < 3; i++)
+				{
+					minChunkSize = minChunkSizes[i];
+					chunkCount = SplitRecordChunks(count, maxChunks, minChunkSize, chunks);
+
+					// As many chunks as allowed without going under the minimum, and always at least one.
+					expected = minChunkSize > 0 ? count / minChunkSize : count;
+					expected = expected > maxChunks ? maxChunks : expected;
+					expected = expected < 1 ? 1 : expected;
+					CHECK(chunkCount == expected);
+
+					// In order, without gaps, and at most one apart in size.
+					first = 0;
+					smallest = count;
+					largest = 0;
+					for (chunk = 0; chunk < chunkCount; chunk++)
+					{
+						CHECK(chunks[chunk].first == first);
+						first += chunks[chunk].count;
+						smallest = chunks[chunk].count < smallest ? chunks[chunk].count : smallest;
+						largest = chunks[chunk].count > largest ? chunks[chunk].count : largest;
+					}
+
+					CHECK(first == count);
+					CHECK(largest - smallest <= 1);
+					CHECK(chunkCount == 1 || smallest >= minChunkSize);
+				}
+			}
+		}
+	}
+
+	// The immediate context has to see the draws in item order with the right texture, whichever worker recorded them.
+	void TestRecordOrder()
+	{
+		FakeDevice device;
+		RecordingContext immediateContext;
+		CommandRecorder recorder;
+		RecordData data;
+		RecordChunk chunks[COMMAND_RECORDER_MAX_WORKERS];
+		int frame, count, i;
+
+		data.failingItem = -1;
+
+		CHECK(recorder.Initialize(&device, &immediateContext, 4));
+		CHECK(recorder.GetWorkerCount() == 4);
+
+		for (frame = 0; frame < 50; frame++)
+		{
+			count = 1 + frame * 7;
+			immediateContext.draws.clear();
+
+			CHECK(recorder.Record(&immediateContext, count, RecordItems, &data));
+			CHECK(recorder.GetChunkCount() == SplitRecordChunks(count, 4, COMMAND_RECORDER_MIN_CHUNK, chunks));
+
+			// Nothing reaches the immediate context before Execute.
+			CHECK(immediateContext.draws.empty());
+
+			recorder.Execute(&immediateContext);
+
+			CHECK((int)immediateContext.draws.size() == count);
+			for (i = 0; i < (int)immediateContext.draws.size(); i++)
+			{
+				CHECK(immediateContext.draws[i].item == (unsigned int)i);
+				CHECK(immediateContext.draws[i].texture == &data.textures[(i / 5) % 3]);
+			}
+		}
+
+		recorder.Shutdown();
+	}
+
+	// A failed chunk drops the whole frame, the next one records as usual.
+	void TestRecordFailure()
+	{
+		FakeDevice device;
+		RecordingContext immediateContext;
+		CommandRecorder recorder;
+		RecordData data;
+
+		CHECK(recorder.Initialize(&device, &immediateContext, 4));
+
+		data.failingItem = 150;
+		CHECK(!recorder.Record(&immediateContext, 200, RecordItems, &data));
+		CHECK(recorder.GetChunkCount() == 0);
+
+		recorder.Execute(&immediateContext);
+		CHECK(immediateContext.draws.empty());
+
+		data.failingItem = -1;
+		CHECK(recorder.Record(&immediateContext, 200, RecordItems, &data));
+		recorder.Execute(&immediateContext);
+		CHECK(immediateContext.draws.size() == 200);
+
+		recorder.Shutdown();
+	}
+
+	// What the deferred null contexts count reaches the immediate context with their command lists.
+	void TestDeferredCounters()
+	{
+		FakeDevice device;
+		NullRenderContext immediateContext;
+		CommandRecorder recorder;
+		RecordData data;
+		int frame;
+
+		data.failingItem = -1;
+		immediateContext.Initialize();
+
+		CHECK(recorder.Initialize(&device, &immediateContext, 4));
+
+		for (frame = 0; frame < 3; frame++)
+		{
+			immediateContext.ResetCounters();
+
+			CHECK(recorder.Record(&immediateContext, 200, RecordItems, &data));
+			CHECK(immediateContext.GetCounters().draws == 0);
+
+			// Every frame only brings its own draws, the deferred contexts start over with each list.
+			recorder.Execute(&immediateContext);
+			CHECK(immediateContext.GetCounters().draws == 200);
+			CHECK(immediateContext.GetCounters().commandLists == recorder.GetChunkCount());
+			CHECK(immediateContext.GetCounters().stateChanges >= 200 / 5);
+		}
+
+		recorder.Shutdown();
+		immediateContext.Shutdown();
+	}
+
+	void TestNoWorkers()
+	{
+		FakeDevice device;
+		RecordingContext immediateContext;
+		CommandRecorder recorder;
+		RecordData data;
+
+		data.failingItem = -1;
+
+		CHECK(recorder.Initialize(&device, &immediateContext, 0));
+		CHECK(!recorder.Record(&immediateContext, 10, RecordItems, &data));
+
+		recorder.Shutdown();
+	}
+}
+
+int main()
+{
+	JobSystem::Initialize(3);
+
+	TestSplitRecordChunks();
+	TestRecordOrder();
+	TestRecordFailure();
+	TestDeferredCounters();
+	TestNoWorkers();
+
+	JobSystem::Shutdown();
+	Profiler::Shutdown();
+
+	return TestResult("CommandRecorderTest");
+}
@@ -0,0 +1,306 @@
+#include <map>
+#include <vector>
+#include "Test.h"
+#include "ConstantRing.h"
+#include "FakeDevice.h"
+#include "NullRenderContext.h"
+
+namespace
+{
+	const unsigned int RING_SIZE = 16 * CONSTANT_RING_ALIGNMENT;
+	const int DRAWS_PER_FRAME = 5;
+
+	// A draw as the gpu would run it later, with the memory its constants were bound from.
+	struct RecordedDraw
+	{
+		std::vector<unsigned char>* memory;
+		unsigned int offset;
+		unsigned int expected;
+	};
+
+	// Stands in for the driver behind the maps. Every buffer has memory of its own, which a discard map
+	// replaces with new memory while the draws queued before it keep reading the old one, and a no overwrite map
+	// hands out again. A draw reads the memory its buffer has when it is queued, but only runs at the end of the
+	// test, so constants overwritten while a queued draw still needed them show up there.
+	class RingContext : public NullRenderContext
+	{
+	private:
+		std::map<ID3D11Resource*, std::vector<unsigned char>*> m_memory;
+		std::vector<std::vector<unsigned char>*> m_allMemory;
+		ID3D11Resource* m_bound;
+		unsigned int m_boundOffset;
+	public:
+		bool constantOffsets;
+		std::vector<D3D11_MAP> mapTypes;
+		std::vector<RecordedDraw> draws;
+		std::vector<unsigned int> boundCounts;
+
+		RingContext()
+		{
+			m_bound = 0;
+			m_boundOffset = 0;
+			constantOffsets = true;
+			Initialize();
+		}
+
+		~RingContext()
+		{
+			size_t i;
+
+			for (i = 0; i < m_allMemory.size(); i++)
+			{
+				delete m_allMemory[i];
+			}
+		}
+
+		HRESULT Map(ID3D11Resource* resource, UINT subresource, D3D11_MAP mapType, UINT mapFlags,
+			D3D11_MAPPED_SUBRESOURCE* mappedResource) override
+		{
+			D3D11_BUFFER_DESC desc;
+
+			((ID3D11Buffer*)resource)->GetDesc(&desc);
+
+			if (mapType == D3D11_MAP_WRITE_DISCARD || !m_memory.count(resource))
+			{
+				m_allMemory.push_back(new std::vector<unsigned char>(desc.ByteWidth, 0xcd));
+				m_memory[resource] = m_allMemory.back();
+			}
+
+			mapTypes.push_back(mapType);
+			mappedResource->pData = m_memory[resource]->data();
+			mappedResource->RowPitch = desc.ByteWidth;
+			mappedResource->DepthPitch = desc.ByteWidth;
+
+			return S_OK;
+		}
+
+		void VSSetConstantBuffers(UINT startSlot, UINT bufferCount, ID3D11Buffer* const* constantBuffers) override
+		{
+			NullRenderContext::VSSetConstantBuffers(startSlot, bufferCount, constantBuffers);
+
+			m_bound = constantBuffers[0];
+			m_boundOffset = 0;
+			boundCounts.push_back(0);
+		}
+
+		void VSSetConstantBuffers1(UINT startSlot, UINT bufferCount, ID3D11Buffer* const* constantBuffers, const UINT* firstConstants,
+			const UINT* constantCounts) override
+		{
+			NullRenderContext::VSSetConstantBuffers1(startSlot, bufferCount, constantBuffers, firstConstants, constantCounts);
+
+			// Direct3D 11.1 wants ranges that start and are sized at multiples of 16 constants.
+			CHECK(firstConstants[0] % 16 == 0);
+			CHECK(constantCounts[0] % 16 == 0 && constantCounts[0] > 0);
+
+			m_bound = constantBuffers[0];
+			m_boundOffset = firstConstants[0] * 16;
+			boundCounts.push_back(constantCounts[0]);
+		}
+
+		// The index count carries the value the draw has to find at the start of its constants.
+		void DrawIndexed(UINT indexCount, UINT startIndex, INT baseVertex) override
+		{
+			RecordedDraw draw;
+
+			NullRenderContext::DrawIndexed(indexCount, startIndex, baseVertex);
+
+			draw.memory = m_bound ? m_memory[m_bound] : 0;
+			draw.offset = m_boundOffset;
+			draw.expected = indexCount;
+			draws.push_back(draw);
+		}
+
+		bool SupportsConstantOffsets() override
+		{
+			return constantOffsets;
+		}
+
+		// Runs the queued draws.
+		void CheckDraws()
+		{
+			size_t i;
+
+			for (i = 0; i < draws.size(); i++)
+			{
+				CHECK(draws[i].memory != 0);
+				if (draws[i].memory)
+				{
+					CHECK(*(unsigned int*)&(*draws[i].memory)[draws[i].offset] == draws[i].expected);
+				}
+			}
+		}
+	};
+
+	// A frame of draws that each write their own value, the way the engine fills the ring.
+	bool DrawFrame(ConstantRing& ring, RenderStateCache& stateCache, RingContext& context, int frame)
+	{
+		unsigned int offsets[DRAWS_PER_FRAME];
+		unsigned int* constants;
+		int i;
+
+		if (!ring.Map(&context, DRAWS_PER_FRAME * ConstantRing::Align(64)))
+		{
+			return false;
+		}
+
+		for (i = 0; i < DRAWS_PER_FRAME; i++)
+		{
+			constants = (unsigned int*)ring.Allocate(64, offsets[i]);
+			CHECK(constants != 0);
+			if (!constants)
+			{
+				return false;
+			}
+
+			*constants = (unsigned int)(frame * 100 + i);
+		}
+
+		// The reserved range is used up.
+		CHECK(ring.Allocate(1, offsets[0]) == 0);
+
+		ring.Unmap(&context);
+
+		for (i = 0; i < DRAWS_PER_FRAME; i++)
+		{
+			CHECK(ring.BindVS(&stateCache, 0, offsets[i], 64));
+			stateCache.DrawIndexed((unsigned int)(frame * 100 + i), 0, 0);
+		}
+
+		return true;
+	}
+
+	void TestAlign()
+	{
+		CHECK(ConstantRing::Align(0) == 0);
+		CHECK(ConstantRing::Align(1) == CONSTANT_RING_ALIGNMENT);
+		CHECK(ConstantRing::Align(CONSTANT_RING_ALIGNMENT) == CONSTANT_RING_ALIGNMENT);
+		CHECK(ConstantRing::Align(CONSTANT_RING_ALIGNMENT + 1) == 2 * CONSTANT_RING_ALIGNMENT);
+	}
+
+	// A frame is one map, no overwrite while it fits behind the earlier frames and discard when the ring wraps,
+	// and no draw ever finds its constants overwritten.
+	void TestOffsets()
+	{
+		FakeDevice device;
+		RingContext context;
+		RenderStateCache stateCache;
+		ConstantRing ring;
+		unsigned int offset;
+		int frame, framesPerRing;
+		size_t i;
+
+		stateCache.Initialize(&context);
+		CHECK(ring.Initialize(&device, &stateCache, RING_SIZE, 64));
+		CHECK(ring.UsesOffsets());
+
+		framesPerRing = RING_SIZE / (DRAWS_PER_FRAME * CONSTANT_RING_ALIGNMENT);
+
+		for (frame = 0; frame < 20; frame++)
+		{
+			ring.ResetMapCount();
+			CHECK(DrawFrame(ring, stateCache, context, frame));
+			CHECK(ring.GetMapCount() == 1);
+		}
+
+		CHECK(context.mapTypes.size() == 20);
+		for (frame = 0; frame < 20; frame++)
+		{
+			CHECK((context.mapTypes[frame] == D3D11_MAP_WRITE_DISCARD) == (frame > 0 && frame % framesPerRing == 0));
+		}
+
+		for (i = 0; i < context.boundCounts.size(); i++)
+		{
+			CHECK(context.boundCounts[i] == CONSTANT_RING_ALIGNMENT / 16);
+		}
+
+		CHECK(context.draws.size() == 20 * DRAWS_PER_FRAME);
+		context.CheckDraws();
+
+		// Nothing is handed out outside of a map, and a frame larger than the ring does not map at all.
+		CHECK(ring.Allocate(64, offset) == 0);
+		CHECK(!ring.Map(&context, RING_SIZE + 1));
+		CHECK(context.mapTypes.size() == 20);
+
+		ring.Shutdown();
+	}
+
+	// Without offsets the frame is collected in memory and every draw maps its own copy.
+	void TestFallback(bool deviceOffsets, bool contextOffsets)
+	{
+		FakeDevice device;
+		RingContext context;
+		RenderStateCache stateCache;
+		ConstantRing ring;
+		int frame;
+		size_t i;
+
+		device.SetFeatures(deviceOffsets, true);
+		context.constantOffsets = contextOffsets;
+		stateCache.Initialize(&context);
+
+		CHECK(ring.Initialize(&device, &stateCache, RING_SIZE, 64));
+		CHECK(!ring.UsesOffsets());
+
+		for (frame = 0; frame < 10; frame++)
+		{
+			ring.ResetMapCount();
+			CHECK(DrawFrame(ring, stateCache, context, frame));
+			CHECK(ring.GetMapCount() == DRAWS_PER_FRAME);
+		}
+
+		CHECK(context.mapTypes.size() == 10 * DRAWS_PER_FRAME);
+		for (i = 0; i < context.mapTypes.size(); i++)
+		{
+			CHECK(context.mapTypes[i] == D3D11_MAP_WRITE_DISCARD);
+		}
+
+		// Whole buffer binds only.
+		for (i = 0; i < context.boundCounts.size(); i++)
+		{
+			CHECK(context.boundCounts[i] == 0);
+		}
+
+		CHECK(context.draws.size() == 10 * DRAWS_PER_FRAME);
+		context.CheckDraws();
+
+		ring.Shutdown();
+	}
+
+	// A null context leaves the bytes of no overwrite maps to the ring, which counts only the range it reserved.
+	void TestUploadBytes()
+	{
+		FakeDevice device;
+		NullRenderContext context;
+		RenderStateCache stateCache;
+		ConstantRing ring;
+		unsigned int offset;
+
+		context.Initialize();
+		stateCache.Initialize(&context);
+		CHECK(ring.Initialize(&device, &stateCache, RING_SIZE, 64));
+
+		Stats::EndFrame();
+		CHECK(ring.Map(&context, 2 * CONSTANT_RING_ALIGNMENT));
+		CHECK(ring.Allocate(64, offset) != 0);
+		ring.Unmap(&context);
+		Stats::EndFrame();
+
+		CHECK(context.GetCounters().maps == 1);
+		CHECK(context.GetCounters().bytesUploaded == 0);
+		CHECK(Stats::Get(STAT_CONSTANT_BYTES) == 2 * CONSTANT_RING_ALIGNMENT);
+
+		ring.Shutdown();
+		context.Shutdown();
+	}
+}
+
+int main()
+{
+	TestAlign();
+	TestOffsets();
+	TestFallback(false, true);
+	TestFallback(true, false);
+	TestUploadBytes();
+
+	return TestResult("ConstantRingTest");
+}
@@ -0,0 +1,256 @@
+#pragma once
+#include <d3d11.h>
+#include <vector>
+
+// Objects for the stand-in Direct3D interfaces of Platform/d3d11.h. They only know their description, nothing is
+// ever drawn with them, and they live until the device that made them is deleted, so reference counts are kept but
+// never free anything.
+
+// Lets the device delete what it made without knowing the interface of each object.
+class FakeOwned
+{
+public:
+	virtual ~FakeOwned()
+	{
+	}
+};
+
+template<typename Interface>
+class FakeObject : public Interface, public FakeOwned
+{
+private:
+	ULONG m_references;
+public:
+	FakeObject()
+	{
+		m_references = 1;
+	}
+
+	virtual ~FakeObject()
+	{
+	}
+
+	ULONG AddRef() override
+	{
+		return ++m_references;
+	}
+
+	ULONG Release() override
+	{
+		return --m_references;
+	}
+
+	ULONG GetReferences()
+	{
+		return m_references;
+	}
+};
+
+class FakeBuffer : public FakeObject<ID3D11Buffer>
+{
+private:
+	D3D11_BUFFER_DESC m_desc;
+public:
+	FakeBuffer(const D3D11_BUFFER_DESC& desc)
+	{
+		m_desc = desc;
+	}
+
+	void GetType(D3D11_RESOURCE_DIMENSION* resourceDimension) override
+	{
+		*resourceDimension = D3D11_RESOURCE_DIMENSION_BUFFER;
+	}
+
+	void GetDesc(D3D11_BUFFER_DESC* desc) override
+	{
+		*desc = m_desc;
+	}
+};
+
+class FakeTexture2D : public FakeObject<ID3D11Texture2D>
+{
+private:
+	D3D11_TEXTURE2D_DESC m_desc;
+public:
+	FakeTexture2D(const D3D11_TEXTURE2D_DESC& desc)
+	{
+		m_desc = desc;
+	}
+
+	void GetType(D3D11_RESOURCE_DIMENSION* resourceDimension) override
+	{
+		*resourceDimension = D3D11_RESOURCE_DIMENSION_TEXTURE2D;
+	}
+
+	void GetDesc(D3D11_TEXTURE2D_DESC* desc) override
+	{
+		*desc = m_desc;
+	}
+};
+
+typedef FakeObject<ID3D11Query> FakeQuery;
+typedef FakeObject<ID3D11ShaderResourceView> FakeShaderResourceView;
+typedef FakeObject<ID3D11CommandList> FakeCommandList;
+typedef FakeObject<ID3D11UnorderedAccessView> FakeUnorderedAccessView;
+typedef FakeObject<ID3D11InputLayout> FakeInputLayout;
+typedef FakeObject<ID3D11VertexShader> FakeVertexShader;
+typedef FakeObject<ID3D11PixelShader> FakePixelShader;
+typedef FakeObject<ID3D11ComputeShader> FakeComputeShader;
+typedef FakeObject<ID3D11SamplerState> FakeSamplerState;
+typedef FakeObject<ID3D11DepthStencilState> FakeDepthStencilState;
+typedef FakeObject<ID3D11RenderTargetView> FakeRenderTargetView;
+typedef FakeObject<ID3D11DepthStencilView> FakeDepthStencilView;
+
+// Creates the objects the renderers ask for and answers feature checks with what it was set up with.
+class FakeDevice : public FakeObject<ID3D11Device>
+{
+private:
+	std::vector<FakeOwned*> m_objects;
+	bool m_constantOffsets;
+	bool m_driverCommandLists;
+	unsigned int m_largestDynamicBuffer;
+
+	template<typename Object>
+	Object* Keep(Object* object)
+	{
+		m_objects.push_back(object);
+
+		return object;
+	}
+public:
+	FakeDevice()
+	{
+		m_constantOffsets = true;
+		m_driverCommandLists = true;
+		m_largestDynamicBuffer = 0;
+	}
+
+	~FakeDevice()
+	{
+		size_t i;
+
+		for (i = 0; i < m_objects.size(); i++)
+		{
+			delete m_objects[i];
+		}
+	}
+
+	// What CheckFeatureSupport reports for constant buffer offsets and driver command lists.
+	void SetFeatures(bool constantOffsets, bool driverCommandLists)
+	{
+		m_constantOffsets = constantOffsets;
+		m_driverCommandLists = driverCommandLists;
+	}
+
+	HRESULT CreateBuffer(const D3D11_BUFFER_DESC* desc, const D3D11_SUBRESOURCE_DATA* initialData, ID3D11Buffer** buffer) override
+	{
+		*buffer = Keep(new FakeBuffer(*desc));
+
+		if (desc->Usage == D3D11_USAGE_DYNAMIC && desc->ByteWidth > m_largestDynamicBuffer)
+		{
+			m_largestDynamicBuffer = desc->ByteWidth;
+		}
+
+		return S_OK;
+	}
+
+	// Size of the largest buffer that can be mapped, which is the most a map of a NullRenderContext hands out.
+	unsigned int GetLargestDynamicBuffer()
+	{
+		return m_largestDynamicBuffer;
+	}
+
+	HRESULT CreateShaderResourceView(ID3D11Resource* resource, const D3D11_SHADER_RESOURCE_VIEW_DESC* desc,
+		ID3D11ShaderResourceView** shaderResourceView) override
+	{
+		*shaderResourceView = Keep(new FakeShaderResourceView);
+
+		return S_OK;
+	}
+
+	HRESULT CreateUnorderedAccessView(ID3D11Resource* resource, const D3D11_UNORDERED_ACCESS_VIEW_DESC* desc,
+		ID3D11UnorderedAccessView** unorderedAccessView) override
+	{
+		*unorderedAccessView = Keep(new FakeUnorderedAccessView);
+
+		return S_OK;
+	}
+
+	HRESULT CreateInputLayout(const D3D11_INPUT_ELEMENT_DESC* inputElementDescs, UINT numElements, const void* shaderBytecode,
+		SIZE_T bytecodeLength, ID3D11InputLayout** inputLayout) override
+	{
+		*inputLayout = Keep(new FakeInputLayout);
+
+		return S_OK;
+	}
+
+	HRESULT CreateVertexShader(const void* shaderBytecode, SIZE_T bytecodeLength, ID3D11ClassLinkage* classLinkage,
+		ID3D11VertexShader** vertexShader) override
+	{
+		*vertexShader = Keep(new FakeVertexShader);
+
+		return S_OK;
+	}
+
+	HRESULT CreatePixelShader(const void* shaderBytecode, SIZE_T bytecodeLength, ID3D11ClassLinkage* classLinkage,
+		ID3D11PixelShader** pixelShader) override
+	{
+		*pixelShader = Keep(new FakePixelShader);
+
+		return S_OK;
+	}
+
+	HRESULT CreateComputeShader(const void* shaderBytecode, SIZE_T bytecodeLength, ID3D11ClassLinkage* classLinkage,
+		ID3D11ComputeShader** computeShader) override
+	{
+		*computeShader = Keep(new FakeComputeShader);
+
+		return S_OK;
+	}
+
+	HRESULT CreateSamplerState(const D3D11_SAMPLER_DESC* samplerDesc, ID3D11SamplerState** samplerState) override
+	{
+		*samplerState = Keep(new FakeSamplerState);
+
+		return S_OK;
+	}
+
+	HRESULT CreateDepthStencilState(const D3D11_DEPTH_STENCIL_DESC* depthStencilDesc, ID3D11DepthStencilState** depthStencilState) override
+	{
+		*depthStencilState = Keep(new FakeDepthStencilState);
+
+		return S_OK;
+	}
+
+	HRESULT CreateQuery(const D3D11_QUERY_DESC* queryDesc, ID3D11Query** query) override
+	{
+		*query = Keep(new FakeQuery);
+
+		return S_OK;
+	}
+
+	HRESULT CheckFeatureSupport(D3D11_FEATURE feature, void* featureSupportData, UINT featureSupportDataSize) override
+	{
+		D3D11_FEATURE_DATA_D3D11_OPTIONS* options;
+		D3D11_FEATURE_DATA_THREADING* threading;
+
+		if (feature == D3D11_FEATURE_D3D11_OPTIONS && featureSupportDataSize == sizeof(D3D11_FEATURE_DATA_D3D11_OPTIONS))
+		{
+			options = (D3D11_FEATURE_DATA_D3D11_OPTIONS*)featureSupportData;
+			memset(options, 0, sizeof(*options));
+			options->ConstantBufferOffsetting = m_constantOffsets;
+			options->MapNoOverwriteOnDynamicConstantBuffer = m_constantOffsets;
+			return S_OK;
+		}
+
+		if (feature == D3D11_FEATURE_THREADING && featureSupportDataSize == sizeof(D3D11_FEATURE_DATA_THREADING))
+		{
+			threading = (D3D11_FEATURE_DATA_THREADING*)featureSupportData;
+			threading->DriverConcurrentCreates = TRUE;
+			threading->DriverCommandLists = m_driverCommandLists;
+			return S_OK;
+		}
+
+		return E_FAIL;
+	}
+};
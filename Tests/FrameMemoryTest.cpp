@@ -0,0 +1,227 @@
+#include <string.h>
+#include <atomic>
+#include <thread>
+#include "Test.h"
+#include "FrameMemory.h"
+#include "HeapCounter.h"
+
+namespace
+{
+	const size_t BLOCK_SIZE = 1024;
+
+	// Fills a block with a value that belongs to its frame, so memory a later frame reused shows up.
+	unsigned char* AllocateBlock(unsigned int frame)
+	{
+		unsigned char* block;
+
+		block = (unsigned char*)FrameMemory::Allocate(BLOCK_SIZE, 16, frame);
+		if (block)
+		{
+			memset(block, (int)(frame + 1), BLOCK_SIZE);
+		}
+
+		return block;
+	}
+
+	bool IsIntact(const unsigned char* block, unsigned int frame)
+	{
+		size_t i;
+
+		for (i = 0; i < BLOCK_SIZE; i++)
+		{
+			if (block[i] != (unsigned char)(frame + 1))
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	bool Overlaps(const unsigned char* a, const unsigned char* b)
+	{
+		return a < b + BLOCK_SIZE && b < a + BLOCK_SIZE;
+	}
+
+	// Allocations move forward and are aligned, a full arena hands out nothing until Reset.
+	void TestArena()
+	{
+		FrameArena arena;
+		unsigned char* first;
+		unsigned char* second;
+
+		CHECK(arena.Allocate(1, 1) == 0);
+		CHECK(arena.Initialize(256));
+
+		first = (unsigned char*)arena.Allocate(3, 1);
+		second = (unsigned char*)arena.Allocate(16, 64);
+		CHECK(first != 0 && second != 0);
+		CHECK(((size_t)second & 63) == 0);
+		CHECK(second >= first + 3);
+		CHECK(arena.Contains(first) && arena.Contains(second + 15));
+		CHECK(!arena.Contains(first + 256));
+
+		// Too large for what is left, the arena stays as it was.
+		CHECK(arena.Allocate(256, 1) == 0);
+		CHECK(arena.GetUsed() == (size_t)(second + 16 - first));
+
+		arena.Reset();
+		CHECK(arena.GetUsed() == 0);
+		CHECK(arena.GetPeak() >= 19);
+		CHECK(arena.Allocate(256, 1) == first);
+		CHECK(arena.Allocate(1, 1) == 0);
+
+		arena.Shutdown();
+		CHECK(arena.GetSize() == 0);
+	}
+
+	// Memory of a frame stays while the next one is filled and is only reused once its frame ended.
+	void TestDoubleBuffer()
+	{
+		unsigned char* frame0;
+		unsigned char* frame1;
+		unsigned char* frame2;
+		unsigned char* frame3;
+
+		frame0 = AllocateBlock(100);
+		frame1 = AllocateBlock(101);
+		CHECK(frame0 != 0 && frame1 != 0);
+		CHECK(!Overlaps(frame0, frame1));
+
+		// Neither frame ended, so the next one has to share the arena of the newest.
+		frame2 = AllocateBlock(102);
+		CHECK(frame2 != 0);
+		CHECK(!Overlaps(frame2, frame0) && !Overlaps(frame2, frame1));
+		CHECK(IsIntact(frame0, 100) && IsIntact(frame1, 101));
+
+		// Once frame 100 ended frame 103 starts its arena over, the frames in the other one are left alone.
+		FrameMemory::EndFrame(100);
+		frame3 = AllocateBlock(103);
+		CHECK(frame3 == frame0);
+		CHECK(IsIntact(frame1, 101) && IsIntact(frame2, 102));
+
+		// Frame 102 ended along with 101, so frame 104 gets their arena.
+		FrameMemory::EndFrame(102);
+		CHECK(AllocateBlock(104) == frame1);
+		CHECK(IsIntact(frame3, 103));
+
+		FrameMemory::EndFrame(104);
+	}
+
+	// The frames that end are the ones of another thread, the caller stays on its frame until it names a newer one.
+	void TestFrameOfCaller()
+	{
+		unsigned char* first;
+		unsigned char* second;
+		unsigned int frame;
+
+		first = AllocateBlock(200);
+		for (frame = 200; frame < 210; frame++)
+		{
+			FrameMemory::EndFrame(frame);
+		}
+
+		second = AllocateBlock(200);
+		CHECK(first != 0 && second != 0);
+		CHECK(!Overlaps(first, second));
+		CHECK(IsIntact(first, 200));
+
+		FrameMemory::EndFrame(210);
+	}
+
+	// What does not fit the arena comes from the heap and is counted, what fits does not touch the heap.
+	void TestOverflow()
+	{
+		long long heapStart;
+
+		CHECK(FrameMemory::Allocate(FRAME_MEMORY_ARENA_SIZE + 1, 1, 300) == 0);
+
+		Stats::EndFrame();
+		heapStart = HeapCounter::GetAllocations();
+		{
+			FrameVector<int> small(FrameAllocator<int>(300));
+			small.resize(1000);
+			CHECK(FrameMemory::Contains(small.data()));
+		}
+		CHECK(HeapCounter::GetAllocations() == heapStart);
+
+		{
+			FrameVector<unsigned char> large(FrameAllocator<unsigned char>(300));
+			large.resize(FRAME_MEMORY_ARENA_SIZE + 1);
+			CHECK(!FrameMemory::Contains(large.data()));
+		}
+		CHECK(HeapCounter::GetAllocations() == heapStart + 1);
+
+		Stats::EndFrame();
+		CHECK(Stats::Get(STAT_FRAME_OVERFLOWS) == 1);
+		CHECK(Stats::Get(STAT_FRAME_BYTES) >= 1000 * (long long)sizeof(int));
+
+		FrameMemory::EndFrame(300);
+	}
+
+	struct RestartThread
+	{
+		std::atomic<int> step;
+		int failures;
+	};
+
+	// Allocates, then waits for the main thread to shut the frame memory down and allocates again.
+	void AllocateAcrossRestart(RestartThread* restart)
+	{
+		unsigned char* block;
+		int round;
+
+		for (round = 0; round < 3; round++)
+		{
+			block = AllocateBlock((unsigned int)round);
+			restart->failures += block && FrameMemory::Contains(block) && IsIntact(block, (unsigned int)round) ? 0 : 1;
+			restart->step.store(round * 2 + 1);
+
+			while (restart->step.load() != round * 2 + 2)
+			{
+				std::this_thread::yield();
+			}
+		}
+	}
+
+	// A thread that allocated before a Shutdown gets new arenas instead of the freed ones.
+	void TestRestart()
+	{
+		RestartThread restart;
+		std::thread thread;
+		int round;
+
+		restart.step.store(0);
+		restart.failures = 0;
+
+		thread = std::thread(AllocateAcrossRestart, &restart);
+
+		for (round = 0; round < 3; round++)
+		{
+			while (restart.step.load() != round * 2 + 1)
+			{
+				std::this_thread::yield();
+			}
+
+			FrameMemory::Shutdown();
+			restart.step.store(round * 2 + 2);
+		}
+
+		thread.join();
+
+		CHECK(restart.failures == 0);
+	}
+}
+
+int main()
+{
+	TestArena();
+	TestDoubleBuffer();
+	TestFrameOfCaller();
+	TestOverflow();
+	TestRestart();
+
+	FrameMemory::Shutdown();
+
+	return TestResult("FrameMemoryTest");
+}
@@ -0,0 +1,206 @@
+#include <map>
+#include <string.h>
+#include "Test.h"
+#include "GlyphCache.h"
+
+namespace
+{
+	// A glyph of 7 by 7 pixels takes 8 by 8 of the page with its gap, so a page of 32 by 16 holds exactly eight.
+	const int GLYPH_SIZE = 7;
+	const int PAGE_WIDTH = 32;
+	const int PAGE_HEIGHT = 16;
+	const int PAGE_GLYPHS = 8;
+
+	// Glyphs filled with their codepoint, counting how often each one is loaded. The font has no Z.
+	class CountingGlyphLoader : public GlyphLoader
+	{
+	public:
+		std::map<unsigned int, int> loads;
+
+		bool LoadGlyph(unsigned int codepoint, GlyphBitmap& glyph) override
+		{
+			loads[codepoint]++;
+
+			if (codepoint == 'Z')
+			{
+				return false;
+			}
+
+			memset(&glyph.metrics, 0, sizeof(glyph.metrics));
+			glyph.metrics.advance = (float)GLYPH_SIZE;
+
+			if (codepoint == ' ')
+			{
+				glyph.width = 0;
+				glyph.height = 0;
+				glyph.pixels.clear();
+				return true;
+			}
+
+			glyph.metrics.width = (float)GLYPH_SIZE;
+			glyph.metrics.height = (float)GLYPH_SIZE;
+			glyph.width = GLYPH_SIZE;
+			glyph.height = GLYPH_SIZE;
+			glyph.pixels.assign(GLYPH_SIZE * GLYPH_SIZE, (unsigned char)codepoint);
+
+			return true;
+		}
+
+		float GetKerning(unsigned int first, unsigned int second) override
+		{
+			return 0.0f;
+		}
+	};
+
+	void InitializeCache(GlyphCache& cache, GlyphLoader* loader)
+	{
+		FontTableHeader header;
+
+		memset(&header, 0, sizeof(header));
+		header.pixelSize = 16.0f;
+
+		cache.Initialize(loader, header, PAGE_WIDTH, PAGE_HEIGHT);
+	}
+
+	// The glyph is in the page where its u and v say, with a cleared gap right of and below it.
+	void CheckPage(GlyphCache& cache, const FontGlyph* glyph)
+	{
+		const unsigned char* page;
+		int x, y, left, top;
+
+		page = cache.GetPage();
+		left = (int)(glyph->u0 * PAGE_WIDTH + 0.5f);
+		top = (int)(glyph->v0 * PAGE_HEIGHT + 0.5f);
+
+		CHECK(glyph->u1 - glyph->u0 == (float)GLYPH_SIZE / PAGE_WIDTH);
+		CHECK(glyph->v1 - glyph->v0 == (float)GLYPH_SIZE / PAGE_HEIGHT);
+
+		for (y = 0; y <= GLYPH_SIZE; y++)
+		{
+			for (x = 0; x <= GLYPH_SIZE; x++)
+			{
+				CHECK(page[(top + y) * PAGE_WIDTH + left + x] == (x < GLYPH_SIZE && y < GLYPH_SIZE ? glyph->codepoint : 0));
+			}
+		}
+	}
+
+	// Glyphs are loaded once, written to the page and reported dirty, missing ones are only asked for once.
+	void TestLoad()
+	{
+		CountingGlyphLoader loader;
+		GlyphCache cache;
+		const FontGlyph* glyph;
+
+		InitializeCache(cache, &loader);
+
+		glyph = cache.GetGlyph('A');
+		CHECK(glyph && glyph->codepoint == 'A');
+		CHECK(cache.GetGlyph('A') == glyph);
+		CHECK(loader.loads['A'] == 1);
+		CheckPage(cache, glyph);
+
+		CHECK(cache.GetDirty().size() == 1);
+		CHECK(cache.GetDirty()[0].width == GLYPH_SIZE + 1 && cache.GetDirty()[0].height == GLYPH_SIZE + 1);
+		cache.ClearDirty();
+		CHECK(cache.GetDirty().empty());
+
+		// A space takes no room and writes nothing.
+		glyph = cache.GetGlyph(' ');
+		CHECK(glyph && glyph->width == 0.0f);
+		CHECK(cache.GetDirty().empty());
+
+		CHECK(cache.GetGlyph('Z') == 0);
+		CHECK(cache.GetGlyph('Z') == 0);
+		CHECK(loader.loads['Z'] == 1);
+
+		CHECK(cache.GetGlyphCount() == 2);
+
+		cache.Shutdown();
+	}
+
+	// A full page makes room by evicting the glyph that was used longest ago, and using a glyph makes it new again.
+	void TestLeastRecentlyUsed()
+	{
+		CountingGlyphLoader loader;
+		GlyphCache cache;
+		const FontGlyph* glyph;
+		AtlasRect evicted;
+		int i;
+
+		InitializeCache(cache, &loader);
+
+		for (i = 0; i < PAGE_GLYPHS; i++)
+		{
+			CHECK(cache.GetGlyph('A' + i) != 0);
+		}
+		CHECK(cache.GetEvictionCount() == 0);
+
+		cache.BeginFrame();
+		cache.ClearDirty();
+
+		// A is used again, so B is the oldest.
+		CHECK(cache.GetGlyph('A') != 0);
+		glyph = cache.GetGlyph('I');
+		CHECK(glyph != 0);
+		CHECK(cache.GetEvictionCount() == 1);
+		CHECK(cache.GetGlyphCount() == PAGE_GLYPHS);
+
+		// I took the place of B and cleared whatever B left there.
+		evicted = cache.GetDirty()[0];
+		CHECK(evicted.x == GLYPH_SIZE + 1 && evicted.y == 0);
+		CheckPage(cache, glyph);
+
+		// B comes back from the loader and pushes out C.
+		CHECK(cache.GetGlyph('B') != 0);
+		CHECK(loader.loads['B'] == 2);
+		CHECK(loader.loads['A'] == 1);
+		CHECK(cache.GetEvictionCount() == 2);
+		CHECK(cache.GetGlyph('A') != 0);
+		CHECK(loader.loads['A'] == 1);
+
+		cache.Shutdown();
+	}
+
+	// Glyphs of the current frame stay, so when the page is full of them there is no glyph instead.
+	void TestCurrentFrame()
+	{
+		CountingGlyphLoader loader;
+		GlyphCache cache;
+		int i;
+
+		InitializeCache(cache, &loader);
+
+		for (i = 0; i < PAGE_GLYPHS; i++)
+		{
+			CHECK(cache.GetGlyph('A' + i) != 0);
+		}
+
+		CHECK(cache.GetGlyph('I') == 0);
+		CHECK(cache.GetEvictionCount() == 0);
+		CHECK(cache.GetGlyphCount() == PAGE_GLYPHS);
+
+		// The next frame can evict them again.
+		cache.BeginFrame();
+		CHECK(cache.GetGlyph('I') != 0);
+		CHECK(cache.GetEvictionCount() == 1);
+
+		// Used this frame, the rest can go one by one.
+		for (i = 0; i < PAGE_GLYPHS - 1; i++)
+		{
+			CHECK(cache.GetGlyph('J' + i) != 0);
+		}
+		CHECK(cache.GetEvictionCount() == PAGE_GLYPHS);
+		CHECK(cache.GetGlyph('R') == 0);
+
+		cache.Shutdown();
+	}
+}
+
+int main()
+{
+	TestLoad();
+	TestLeastRecentlyUsed();
+	TestCurrentFrame();
+
+	return TestResult("GlyphCacheTest");
+}
@@ -0,0 +1,263 @@
+#include <map>
+#include <string.h>
+#include "Test.h"
+#include "GpuTimer.h"
+#include "FakeDevice.h"
+#include "NullRenderContext.h"
+
+namespace
+{
+	// Ticks per second of the fake clock, a tick is a millisecond.
+	const UINT64 FREQUENCY = 1000;
+
+	// Stands in for the gpu behind the queries. A query ended in one frame has its data only a number of frames
+	// later, and the timestamps come from a clock the test sets, so the times the timer reads back are known.
+	class QueryContext : public NullRenderContext
+	{
+	private:
+		struct Ended
+		{
+			UINT64 time;
+			int frame;
+		};
+
+		std::map<ID3D11Asynchronous*, Ended> m_ended;
+	public:
+		int frame;
+		int latency;
+		UINT64 clock;
+		bool disjoint;
+		int reads;
+
+		QueryContext()
+		{
+			frame = 0;
+			latency = 1;
+			clock = 0;
+			disjoint = false;
+			reads = 0;
+			Initialize();
+		}
+
+		void End(ID3D11Asynchronous* async) override
+		{
+			Ended ended;
+
+			NullRenderContext::End(async);
+
+			ended.time = clock;
+			ended.frame = frame;
+			m_ended[async] = ended;
+		}
+
+		HRESULT GetData(ID3D11Asynchronous* async, void* data, UINT dataSize, UINT getDataFlags) override
+		{
+			D3D11_QUERY_DATA_TIMESTAMP_DISJOINT* disjointData;
+			std::map<ID3D11Asynchronous*, Ended>::iterator it;
+
+			// The timer must never make the cpu wait for the gpu.
+			CHECK(getDataFlags == D3D11_ASYNC_GETDATA_DONOTFLUSH);
+
+			it = m_ended.find(async);
+			if (it == m_ended.end() || frame - it->second.frame < latency)
+			{
+				return S_FALSE;
+			}
+
+			reads++;
+
+			if (dataSize == sizeof(D3D11_QUERY_DATA_TIMESTAMP_DISJOINT))
+			{
+				disjointData = (D3D11_QUERY_DATA_TIMESTAMP_DISJOINT*)data;
+				disjointData->Frequency = FREQUENCY;
+				disjointData->Disjoint = disjoint ? TRUE : FALSE;
+
+				return S_OK;
+			}
+
+			*(UINT64*)data = it->second.time;
+
+			return S_OK;
+		}
+	};
+
+	// A frame with a scope of 2 ms and one of 3 ms plus the frame number, so every frame has times of its own.
+	void TimeFrame(GpuTimer& timer, QueryContext& context)
+	{
+		int scope;
+
+		timer.BeginFrame(&context);
+
+		scope = timer.BeginScope(&context, "Geometry");
+		context.clock += 2 + context.frame;
+		timer.EndScope(&context, scope);
+
+		scope = timer.BeginScope(&context, "Post");
+		context.clock += 3 + context.frame;
+		timer.EndScope(&context, scope);
+
+		timer.EndFrame(&context);
+		context.frame++;
+	}
+
+	void CheckResults(GpuTimer& timer, int frame)
+	{
+		ProfileSummary results[GPU_TIMER_MAX_SCOPES];
+		int count;
+
+		count = timer.GetResults(results, GPU_TIMER_MAX_SCOPES);
+		CHECK(count == 2);
+		if (count != 2)
+		{
+			return;
+		}
+
+		CHECK(strcmp(results[0].name, "Geometry") == 0);
+		CHECK(strcmp(results[1].name, "Post") == 0);
+		CHECK_NEAR(results[0].time, 2.0f + (float)frame, 1e-4f);
+		CHECK_NEAR(results[1].time, 3.0f + (float)frame, 1e-4f);
+		CHECK(results[0].calls == 1);
+	}
+
+	// Whatever the latency up to the length of the ring, every frame is read back exactly that many frames late.
+	void TestLatency()
+	{
+		FakeDevice device;
+		ProfileSummary results[GPU_TIMER_MAX_SCOPES];
+		int latency, i;
+
+		for (latency = 1; latency < GPU_TIMER_FRAMES; latency++)
+		{
+			QueryContext context;
+			GpuTimer timer;
+
+			CHECK(timer.Initialize(&device));
+			context.latency = latency;
+
+			// Nothing has been read yet by a new timer.
+			CHECK(timer.GetResults(results, GPU_TIMER_MAX_SCOPES) == 0);
+
+			for (i = 0; i < 20; i++)
+			{
+				TimeFrame(timer, context);
+
+				// BeginFrame reads the frame that is done by then.
+				if (i >= latency)
+				{
+					CheckResults(timer, i - latency);
+				}
+			}
+
+			CHECK(timer.GetDroppedFrames() == 0);
+			timer.Shutdown();
+		}
+	}
+
+	// A gpu further behind than the ring is long loses frames instead of stalling, and they are counted.
+	void TestDroppedFrames()
+	{
+		FakeDevice device;
+		QueryContext context;
+		GpuTimer timer;
+		ProfileSummary results[GPU_TIMER_MAX_SCOPES];
+		int i;
+
+		CHECK(timer.Initialize(&device));
+
+		context.latency = GPU_TIMER_FRAMES + 1;
+		for (i = 0; i < 10; i++)
+		{
+			TimeFrame(timer, context);
+		}
+
+		// The first frame that found its slot still in use was the one after the ring filled up.
+		CHECK(timer.GetDroppedFrames() == 10 - GPU_TIMER_FRAMES);
+		CHECK(timer.GetResults(results, GPU_TIMER_MAX_SCOPES) == 0);
+
+		// Once the gpu catches up the frames still in the ring come back.
+		context.latency = 1;
+		TimeFrame(timer, context);
+		CheckResults(timer, 10 - 1);
+		CHECK(timer.GetDroppedFrames() == 10 - GPU_TIMER_FRAMES);
+
+		timer.Shutdown();
+	}
+
+	// A frame during which the clock changed keeps the results of the frame before it.
+	void TestDisjoint()
+	{
+		FakeDevice device;
+		QueryContext context;
+		GpuTimer timer;
+
+		CHECK(timer.Initialize(&device));
+
+		TimeFrame(timer, context);
+		TimeFrame(timer, context);
+		CheckResults(timer, 0);
+
+		context.disjoint = true;
+		TimeFrame(timer, context);
+		CheckResults(timer, 0);
+
+		context.disjoint = false;
+		TimeFrame(timer, context);
+		CheckResults(timer, 2);
+
+		timer.Shutdown();
+	}
+
+	// Scopes past the maximum are ignored, and so are scopes outside of a frame.
+	void TestScopeLimit()
+	{
+		FakeDevice device;
+		QueryContext context;
+		GpuTimer timer;
+		ProfileSummary results[GPU_TIMER_MAX_SCOPES + 1];
+		int scopes[GPU_TIMER_MAX_SCOPES + 1];
+		int i, ends;
+
+		CHECK(timer.Initialize(&device));
+
+		CHECK(timer.BeginScope(&context, "Outside") == -1);
+
+		timer.BeginFrame(&context);
+		for (i = 0; i < GPU_TIMER_MAX_SCOPES + 1; i++)
+		{
+			scopes[i] = timer.BeginScope(&context, "Scope");
+		}
+
+		for (i = 0; i < GPU_TIMER_MAX_SCOPES; i++)
+		{
+			CHECK(scopes[i] == i);
+		}
+		CHECK(scopes[GPU_TIMER_MAX_SCOPES] == -1);
+
+		ends = context.GetCounters().calls;
+		timer.EndScope(&context, -1);
+		CHECK(context.GetCounters().calls == ends);
+
+		for (i = 0; i < GPU_TIMER_MAX_SCOPES; i++)
+		{
+			timer.EndScope(&context, scopes[i]);
+		}
+		timer.EndFrame(&context);
+		context.frame++;
+
+		timer.BeginFrame(&context);
+		CHECK(timer.GetResults(results, GPU_TIMER_MAX_SCOPES + 1) == GPU_TIMER_MAX_SCOPES);
+		CHECK(context.reads == 1 + 2 * GPU_TIMER_MAX_SCOPES);
+
+		timer.Shutdown();
+	}
+}
+
+int main()
+{
+	TestLatency();
+	TestDroppedFrames();
+	TestDisjoint();
+	TestScopeLimit();
+
+	return TestResult("GpuTimerTest");
+}
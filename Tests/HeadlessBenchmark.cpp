@@ -0,0 +1,1081 @@
+#include "HeadlessBenchmark.h"
+#include "BenchmarkStats.h"
+#include "FrameMemory.h"
+#include "HeapCounter.h"
+#include "JobSystem.h"
+#include "Stats.h"
+#include <stdio.h>
+
+namespace
+{
+	// Vertex and index sizes of the meshes, they are never loaded so the buffers only have the size of a sphere.
+	const int MESH_VERTEX_STRIDE = 32;
+	const int MESH_VERTEX_COUNT = 1024;
+	const int MESH_INDEX_COUNT = 2880;
+
+	// Point lights the engine scatters through the model field.
+	const int POINT_LIGHT_COUNT = 256;
+
+	// Glyph boxes of the font, in pixels at its size.
+	const int GLYPH_WIDTH = 20;
+	const int GLYPH_HEIGHT = 28;
+	const float TEXT_SIZE = 16.0f;
+}
+
+bool HeadlessBenchmark::BoxGlyphLoader::LoadGlyph(unsigned int codepoint, GlyphBitmap & glyph)
+{
+	if (codepoint < 32 || codepoint > 126)
+	{
+		return false;
+	}
+
+	glyph.metrics.codepoint = codepoint;
+	glyph.metrics.u0 = glyph.metrics.v0 = glyph.metrics.u1 = glyph.metrics.v1 = 0.0f;
+	glyph.metrics.offsetX = 2.0f;
+	glyph.metrics.offsetY = (float)GLYPH_HEIGHT;
+	glyph.metrics.width = (float)GLYPH_WIDTH;
+	glyph.metrics.height = (float)GLYPH_HEIGHT;
+	glyph.metrics.advance = (float)GLYPH_WIDTH + 4.0f;
+
+	// Spaces have no outline and take no room in the page.
+	if (codepoint == ' ')
+	{
+		glyph.width = 0;
+		glyph.height = 0;
+		glyph.pixels.clear();
+		return true;
+	}
+
+	glyph.width = GLYPH_WIDTH;
+	glyph.height = GLYPH_HEIGHT;
+	glyph.pixels.assign(GLYPH_WIDTH * GLYPH_HEIGHT, (unsigned char)codepoint);
+
+	return true;
+}
+
+float HeadlessBenchmark::BoxGlyphLoader::GetKerning(unsigned int first, unsigned int second)
+{
+	return 0.0f;
+}
+
+HeadlessBenchmark::HeadlessBenchmark()
+{
+	m_frameCount = 0;
+
+	m_device = 0;
+	m_renderContext = 0;
+	m_stateCache = 0;
+	memset(&m_targets, 0, sizeof(m_targets));
+	m_renderTarget = 0;
+	m_depthStencil = 0;
+	m_fontTexture = 0;
+	m_fontView = 0;
+	m_spriteView = 0;
+	m_baselineConstants = 0;
+	m_inputLayout = 0;
+	m_vertexShader = 0;
+	m_pixelShader = 0;
+
+	m_ModelList = 0;
+	m_Transforms = 0;
+	m_modelNodes = 0;
+	m_modelMeshes = 0;
+	m_modelTextures = 0;
+	m_extraNodes = 0;
+	m_extraNodeCount = 0;
+
+	m_Camera = 0;
+	m_Light = 0;
+	m_FrameBuilder = 0;
+	m_RenderQueue = 0;
+	m_Renderer = 0;
+	m_DebugDraw = 0;
+	m_GpuTimer = 0;
+
+	m_Font = 0;
+	m_Text = 0;
+	m_FontShader = 0;
+	m_SpriteBatch = 0;
+
+	m_timerFrequency = 1;
+	memset(&m_frameTimings, 0, sizeof(m_frameTimings));
+
+	m_heapAllocations = 0;
+	m_allocatingFrames = 0;
+	m_frameBytes = 0;
+	m_frameOverflows = 0;
+	m_nodesUpdated = 0;
+}
+
+HeadlessBenchmark::HeadlessBenchmark(const HeadlessBenchmark & other)
+{
+}
+
+HeadlessBenchmark::~HeadlessBenchmark()
+{
+}
+
+bool HeadlessBenchmark::Initialize(const char * sceneFile, int modelCount, int extraNodeCount, int frameCount)
+{
+	D3D11_BUFFER_DESC bufferDesc;
+	bool result;
+
+	m_sceneName = sceneFile ? sceneFile : "demo";
+	m_frameCount = frameCount;
+
+	QueryPerformanceFrequency((LARGE_INTEGER*)&m_timerFrequency);
+
+	//Create the device and the counting render context the frames are submitted to
+	m_device = new FakeDevice;
+	if (!m_device)
+	{
+		return false;
+	}
+
+	m_renderContext = new NullRenderContext;
+	if (!m_renderContext)
+	{
+		return false;
+	}
+
+	m_renderContext->Initialize();
+
+	m_stateCache = new RenderStateCache;
+	if (!m_stateCache)
+	{
+		return false;
+	}
+
+	m_stateCache->Initialize(m_renderContext);
+
+	//The scene comes first, the render queue and the instancing are sized to its models like in the engine
+	result = InitializeScene(sceneFile, modelCount, extraNodeCount);
+	if (!result)
+	{
+		return false;
+	}
+
+	//The baseline maps the constants of every draw on their own and binds its own shaders
+	bufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+	bufferDesc.ByteWidth = sizeof(InstanceData);
+	bufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+	bufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+	bufferDesc.MiscFlags = 0;
+	bufferDesc.StructureByteStride = 0;
+	m_device->CreateBuffer(&bufferDesc, NULL, &m_baselineConstants);
+
+	m_device->CreateInputLayout(NULL, 0, NULL, 0, &m_inputLayout);
+	m_device->CreateVertexShader(NULL, 0, NULL, &m_vertexShader);
+	m_device->CreatePixelShader(NULL, 0, NULL, &m_pixelShader);
+
+	result = InitializeRenderer();
+	if (!result)
+	{
+		return false;
+	}
+
+	result = InitializeOverlay();
+	if (!result)
+	{
+		return false;
+	}
+
+	//Maps hand out scratch memory, have it ready for the largest buffer before the frames are counted
+	result = m_renderContext->ReserveScratch(m_device->GetLargestDynamicBuffer());
+	if (!result)
+	{
+		return false;
+	}
+
+	m_timings.reserve(m_frameCount);
+	m_counters.reserve(m_frameCount);
+	m_baselineCounters.reserve(m_frameCount);
+
+	return true;
+}
+
+bool HeadlessBenchmark::InitializeScene(const char * sceneFile, int modelCount, int extraNodeCount)
+{
+	std::map<std::string, int> meshes, textures;
+	float positionX, positionY, positionZ;
+	XMFLOAT4 color;
+	bool result;
+	int i;
+
+	m_ModelList = new ModelList;
+	if (!m_ModelList)
+	{
+		return false;
+	}
+
+	if (sceneFile)
+	{
+		result = m_ModelList->Initialize(sceneFile);
+	}
+	else
+	{
+		result = m_ModelList->Initialize(modelCount);
+	}
+	if (!result)
+	{
+		return false;
+	}
+
+	m_Transforms = new TransformHierarchy;
+	if (!m_Transforms)
+	{
+		return false;
+	}
+
+	result = m_Transforms->Initialize(m_ModelList->GetModelCount() + extraNodeCount);
+	if (!result)
+	{
+		return false;
+	}
+
+	m_modelNodes = new int[m_ModelList->GetModelCount()];
+	m_modelMeshes = new int[m_ModelList->GetModelCount()];
+	m_modelTextures = new int[m_ModelList->GetModelCount()];
+	if (!m_modelNodes || !m_modelMeshes || !m_modelTextures)
+	{
+		return false;
+	}
+
+	//Models that share a file share a mesh, the random demo only has one
+	m_meshes.reserve(m_ModelList->GetModelCount());
+	for (i = 0; i < m_ModelList->GetModelCount(); i++)
+	{
+		m_ModelList->GetData(i, positionX, positionY, positionZ, color);
+
+		m_modelNodes[i] = m_Transforms->CreateNode(-1);
+		m_Transforms->SetPosition(m_modelNodes[i], positionX, positionY, positionZ);
+
+		m_modelMeshes[i] = FindMesh(m_ModelList->GetModelPath(i), meshes);
+		m_modelTextures[i] = FindTexture(m_ModelList->GetTexturePath(i), textures);
+		if (m_modelMeshes[i] < 0 || m_modelTextures[i] < 0)
+		{
+			return false;
+		}
+	}
+
+	//The extra nodes fill a tree level by level, so the children of node i are the ones after i times the children
+	m_extraNodeCount = extraNodeCount;
+	if (m_extraNodeCount > 0)
+	{
+		m_extraNodes = new int[m_extraNodeCount];
+		if (!m_extraNodes)
+		{
+			return false;
+		}
+
+		for (i = 0; i < m_extraNodeCount; i++)
+		{
+			m_extraNodes[i] = m_Transforms->CreateNode(i > 0 ? m_extraNodes[(i - 1) / HEADLESS_BENCHMARK_NODE_CHILDREN] : -1);
+			m_Transforms->SetPosition(m_extraNodes[i], (float)(i % 7) - 3.0f, 1.0f, (float)(i % 5) - 2.0f);
+		}
+	}
+
+	//Frustum culling and the snapshot of every frame, the same as in Graphics
+	m_FrameBuilder = new FrameBuilder;
+	if (!m_FrameBuilder)
+	{
+		return false;
+	}
+
+	result = m_FrameBuilder->Initialize(m_ModelList, m_Transforms, m_modelNodes, HEADLESS_BENCHMARK_DEPTH);
+	if (!result)
+	{
+		return false;
+	}
+
+	m_RenderQueue = new RenderQueue;
+	if (!m_RenderQueue)
+	{
+		return false;
+	}
+
+	result = m_RenderQueue->Initialize(m_ModelList->GetModelCount());
+	if (!result)
+	{
+		return false;
+	}
+
+	return true;
+}
+
+bool HeadlessBenchmark::InitializeRenderer()
+{
+	D3D11_DEPTH_STENCIL_DESC depthStencilDesc;
+	bool result;
+
+	//Base view of the overlay, then the camera moves to the start of its path
+	m_Camera = new Camera;
+	if (!m_Camera)
+	{
+		return false;
+	}
+
+	m_Camera->SetPosition(0.0f, 0.0f, -1.0f);
+	m_Camera->Render();
+	m_Camera->SetBaseViewToCurrent();
+	m_Camera->SetPosition(0.0f, 0.0f, -5.0f);
+
+	//The directional light of the engine
+	m_Light = new Light;
+	if (!m_Light)
+	{
+		return false;
+	}
+
+	m_Light->SetAmbientColor(0.15f, 0.15f, 0.15f, 1.0f);
+	m_Light->SetDiffuseColor(1.0f, 1.0f, 1.0f, 1.0f);
+	m_Light->SetDirection(1.0f, 0.0f, 1.0f);
+	m_Light->SetSpecularColor(1.0f, 1.0f, 1.0f, 1.0f);
+	m_Light->SetSpecularPower(32.0f);
+
+	//Targets of the back buffer and the depth buffer the renderer draws into
+	m_renderTarget = new FakeRenderTargetView;
+	m_depthStencil = new FakeDepthStencilView;
+	if (!m_renderTarget || !m_depthStencil)
+	{
+		return false;
+	}
+
+	memset(&depthStencilDesc, 0, sizeof(depthStencilDesc));
+	depthStencilDesc.DepthEnable = true;
+	depthStencilDesc.DepthWriteMask = D3D11_DEPTH_WRITE_MASK_ALL;
+	depthStencilDesc.DepthFunc = D3D11_COMPARISON_LESS;
+
+	m_targets.renderTarget = m_renderTarget;
+	m_targets.depthStencil = m_depthStencil;
+	m_device->CreateShaderResourceView(NULL, NULL, &m_targets.depthView);
+	m_device->CreateDepthStencilState(&depthStencilDesc, &m_targets.depthState);
+
+	m_GpuTimer = new GpuTimer;
+	if (!m_GpuTimer)
+	{
+		return false;
+	}
+
+	result = m_GpuTimer->Initialize(m_device);
+	if (!result)
+	{
+		return false;
+	}
+
+	//The forward+ renderer with the lights of the engine
+	m_Renderer = new ForwardRenderer;
+	if (!m_Renderer)
+	{
+		return false;
+	}
+
+	result = m_Renderer->Initialize(m_device, m_stateCache, NULL, HEADLESS_BENCHMARK_WIDTH, HEADLESS_BENCHMARK_HEIGHT,
+		HEADLESS_BENCHMARK_NEAR, HEADLESS_BENCHMARK_DEPTH, m_RenderQueue->GetMaxDraws());
+	if (!result)
+	{
+		return false;
+	}
+
+	m_Renderer->SetGpuTimer(m_GpuTimer);
+
+	result = m_Renderer->GetLightManager()->AddRandomLights(POINT_LIGHT_COUNT);
+	if (!result)
+	{
+		return false;
+	}
+
+	m_DebugDraw = new DebugDrawRenderer;
+	if (!m_DebugDraw)
+	{
+		return false;
+	}
+
+	result = m_DebugDraw->Initialize(m_device, NULL);
+	if (!result)
+	{
+		return false;
+	}
+
+	return true;
+}
+
+bool HeadlessBenchmark::InitializeOverlay()
+{
+	D3D11_TEXTURE2D_DESC textureDesc;
+	FontTableHeader fontHeader;
+	bool result;
+	int i;
+
+	//Glyph page of the overlay font
+	memset(&fontHeader, 0, sizeof(fontHeader));
+	fontHeader.magic = FONT_TABLE_MAGIC;
+	fontHeader.version = FONT_TABLE_VERSION;
+	fontHeader.pixelSize = 32.0f;
+	fontHeader.lineHeight = 36.0f;
+	fontHeader.ascent = 28.0f;
+	fontHeader.distanceRange = 4.0f;
+
+	m_Font = new GlyphCache;
+	if (!m_Font)
+	{
+		return false;
+	}
+
+	m_Font->Initialize(&m_glyphLoader, fontHeader, 512, 512);
+
+	memset(&textureDesc, 0, sizeof(textureDesc));
+	textureDesc.Width = 512;
+	textureDesc.Height = 512;
+	textureDesc.MipLevels = 1;
+	textureDesc.ArraySize = 1;
+	textureDesc.Format = DXGI_FORMAT_R8_UNORM;
+	textureDesc.SampleDesc.Count = 1;
+
+	m_fontTexture = new FakeTexture2D(textureDesc);
+	if (!m_fontTexture)
+	{
+		return false;
+	}
+
+	m_device->CreateShaderResourceView(m_fontTexture, NULL, &m_fontView);
+	m_device->CreateShaderResourceView(NULL, NULL, &m_spriteView);
+
+	//The overlay lines are strings of the text batcher, drawn with the font shader like the Text of the engine
+	m_Text = new TextBatcher;
+	if (!m_Text)
+	{
+		return false;
+	}
+
+	result = m_Text->Initialize(m_device, m_Font, TEXT_SIZE, HEADLESS_BENCHMARK_TEXT_LINES * HEADLESS_BENCHMARK_TEXT_LENGTH);
+	if (!result)
+	{
+		return false;
+	}
+
+	for (i = 0; i < HEADLESS_BENCHMARK_TEXT_LINES; i++)
+	{
+		m_textStrings[i] = m_Text->AddString(HEADLESS_BENCHMARK_TEXT_LENGTH);
+		if (m_textStrings[i] < 0)
+		{
+			return false;
+		}
+	}
+
+	m_FontShader = new FontShader;
+	if (!m_FontShader)
+	{
+		return false;
+	}
+
+	result = m_FontShader->Initialize(m_device, NULL);
+	if (!result)
+	{
+		return false;
+	}
+
+	m_SpriteBatch = new SpriteBatch;
+	if (!m_SpriteBatch)
+	{
+		return false;
+	}
+
+	result = m_SpriteBatch->Initialize(m_device, NULL, HEADLESS_BENCHMARK_WIDTH, HEADLESS_BENCHMARK_HEIGHT, SPRITE_BATCH_MAX_SPRITES);
+	if (!result)
+	{
+		return false;
+	}
+
+	return true;
+}
+
+int HeadlessBenchmark::FindMesh(const std::string & path, std::map<std::string, int>& meshes)
+{
+	std::map<std::string, int>::iterator found;
+	D3D11_BUFFER_DESC bufferDesc;
+	MeshBuffers mesh;
+
+	found = meshes.find(path);
+	if (found != meshes.end())
+	{
+		return found->second;
+	}
+
+	bufferDesc.Usage = D3D11_USAGE_DEFAULT;
+	bufferDesc.CPUAccessFlags = 0;
+	bufferDesc.MiscFlags = 0;
+	bufferDesc.StructureByteStride = 0;
+
+	bufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+	bufferDesc.ByteWidth = MESH_VERTEX_STRIDE * MESH_VERTEX_COUNT;
+	m_device->CreateBuffer(&bufferDesc, NULL, &mesh.vertexBuffer);
+	mesh.vertexStride = MESH_VERTEX_STRIDE;
+
+	//Positions only for the depth pre-pass, like ModelAsset
+	bufferDesc.ByteWidth = sizeof(XMFLOAT3) * MESH_VERTEX_COUNT;
+	m_device->CreateBuffer(&bufferDesc, NULL, &mesh.positionBuffer);
+	mesh.positionStride = sizeof(XMFLOAT3);
+
+	bufferDesc.BindFlags = D3D11_BIND_INDEX_BUFFER;
+	bufferDesc.ByteWidth = sizeof(unsigned int) * MESH_INDEX_COUNT;
+	m_device->CreateBuffer(&bufferDesc, NULL, &mesh.indexBuffer);
+	mesh.indexFormat = DXGI_FORMAT_R32_UINT;
+
+	m_meshes.push_back(mesh);
+	meshes[path] = (int)m_meshes.size() - 1;
+
+	return (int)m_meshes.size() - 1;
+}
+
+int HeadlessBenchmark::FindTexture(const std::string & path, std::map<std::string, int>& textures)
+{
+	std::map<std::string, int>::iterator found;
+	ID3D11ShaderResourceView* texture;
+
+	found = textures.find(path);
+	if (found != textures.end())
+	{
+		return found->second;
+	}
+
+	m_device->CreateShaderResourceView(NULL, NULL, &texture);
+
+	m_textures.push_back(texture);
+	textures[path] = (int)m_textures.size() - 1;
+
+	return (int)m_textures.size() - 1;
+}
+
+void HeadlessBenchmark::Shutdown()
+{
+	if (m_SpriteBatch)
+	{
+		m_SpriteBatch->Shutdown();
+		delete m_SpriteBatch;
+		m_SpriteBatch = 0;
+	}
+
+	if (m_FontShader)
+	{
+		m_FontShader->Shutdown();
+		delete m_FontShader;
+		m_FontShader = 0;
+	}
+
+	if (m_Text)
+	{
+		m_Text->Shutdown();
+		delete m_Text;
+		m_Text = 0;
+	}
+
+	if (m_Font)
+	{
+		m_Font->Shutdown();
+		delete m_Font;
+		m_Font = 0;
+	}
+
+	if (m_DebugDraw)
+	{
+		m_DebugDraw->Shutdown();
+		delete m_DebugDraw;
+		m_DebugDraw = 0;
+	}
+
+	if (m_Renderer)
+	{
+		m_Renderer->Shutdown();
+		delete m_Renderer;
+		m_Renderer = 0;
+	}
+
+	if (m_GpuTimer)
+	{
+		m_GpuTimer->Shutdown();
+		delete m_GpuTimer;
+		m_GpuTimer = 0;
+	}
+
+	if (m_RenderQueue)
+	{
+		m_RenderQueue->Shutdown();
+		delete m_RenderQueue;
+		m_RenderQueue = 0;
+	}
+
+	if (m_FrameBuilder)
+	{
+		m_FrameBuilder->Shutdown();
+		delete m_FrameBuilder;
+		m_FrameBuilder = 0;
+	}
+
+	if (m_Light)
+	{
+		delete m_Light;
+		m_Light = 0;
+	}
+
+	if (m_Camera)
+	{
+		delete m_Camera;
+		m_Camera = 0;
+	}
+
+	if (m_modelTextures)
+	{
+		delete[] m_modelTextures;
+		m_modelTextures = 0;
+	}
+
+	if (m_modelMeshes)
+	{
+		delete[] m_modelMeshes;
+		m_modelMeshes = 0;
+	}
+
+	if (m_modelNodes)
+	{
+		delete[] m_modelNodes;
+		m_modelNodes = 0;
+	}
+
+	if (m_extraNodes)
+	{
+		delete[] m_extraNodes;
+		m_extraNodes = 0;
+	}
+
+	if (m_Transforms)
+	{
+		m_Transforms->Shutdown();
+		delete m_Transforms;
+		m_Transforms = 0;
+	}
+
+	if (m_ModelList)
+	{
+		m_ModelList->Shutdown();
+		delete m_ModelList;
+		m_ModelList = 0;
+	}
+
+	m_textures.clear();
+	m_meshes.clear();
+
+	if (m_stateCache)
+	{
+		m_stateCache->Shutdown();
+		delete m_stateCache;
+		m_stateCache = 0;
+	}
+
+	if (m_renderContext)
+	{
+		m_renderContext->Shutdown();
+		delete m_renderContext;
+		m_renderContext = 0;
+	}
+
+	delete m_fontTexture;
+	delete m_depthStencil;
+	delete m_renderTarget;
+	m_fontTexture = 0;
+	m_depthStencil = 0;
+	m_renderTarget = 0;
+	memset(&m_targets, 0, sizeof(m_targets));
+
+	//The device owns the buffers, views, states and shaders
+	if (m_device)
+	{
+		delete m_device;
+		m_device = 0;
+	}
+}
+
+void HeadlessBenchmark::MoveCamera(int frame, float & rotationY)
+{
+	float t;
+
+	//Turn once around while pulling back from the start position and returning to it, like the engine benchmark
+	t = m_frameCount > 1 ? (float)frame / (float)(m_frameCount - 1) : 0.0f;
+
+	rotationY = t * 360.0f;
+	m_Camera->SetPosition(0.0f, 0.0f, -5.0f - sinf(t * XM_PI) * 10.0f);
+}
+
+bool HeadlessBenchmark::Run()
+{
+	float rotationY, rotation;
+	long long heapStart, heapEnd;
+	bool result;
+	int i;
+
+	rotation = 0.0f;
+
+	for (i = 0; i < HEADLESS_BENCHMARK_WARMUP_FRAMES + m_frameCount; i++)
+	{
+		//Warmup frames stay at the start of the path
+		MoveCamera(i < HEADLESS_BENCHMARK_WARMUP_FRAMES ? 0 : i - HEADLESS_BENCHMARK_WARMUP_FRAMES, rotationY);
+
+		//The models spin as fast as in the engine
+		rotation += ((float)XM_PI / 5000.0f) * HEADLESS_BENCHMARK_FRAME_TIME;
+
+		m_renderContext->ResetCounters();
+
+		//Count only what the frame itself allocates, not the results kept below
+		heapStart = HeapCounter::GetAllocations();
+		result = Frame(i, rotationY, rotation);
+		heapEnd = HeapCounter::GetAllocations();
+		if (!result)
+		{
+			return false;
+		}
+
+		Stats::EndFrame();
+		FrameMemory::EndFrame((unsigned int)i);
+
+		if (i < HEADLESS_BENCHMARK_WARMUP_FRAMES)
+		{
+			continue;
+		}
+
+		m_timings.push_back(m_frameTimings);
+		m_counters.push_back(m_renderContext->GetCounters());
+
+		m_heapAllocations += heapEnd - heapStart;
+		if (heapEnd != heapStart)
+		{
+			m_allocatingFrames++;
+		}
+		m_frameBytes += Stats::Get(STAT_FRAME_BYTES);
+		m_frameOverflows += Stats::Get(STAT_FRAME_OVERFLOWS);
+		m_nodesUpdated += m_Transforms->GetUpdatedCount();
+
+		m_renderContext->ResetCounters();
+		result = SubmitBaseline();
+		if (!result)
+		{
+			return false;
+		}
+
+		m_baselineCounters.push_back(m_renderContext->GetCounters());
+	}
+
+	return true;
+}
+
+bool HeadlessBenchmark::Frame(int frame, float rotationY, float rotation)
+{
+	XMMATRIX worldMatrix, viewMatrix, projectionMatrix;
+	INT64 frameStart, phaseStart;
+	bool result;
+
+	QueryPerformanceCounter((LARGE_INTEGER*)&frameStart);
+	phaseStart = frameStart;
+
+	projectionMatrix = XMMatrixPerspectiveFovLH(XM_PIDIV4, (float)HEADLESS_BENCHMARK_WIDTH / (float)HEADLESS_BENCHMARK_HEIGHT,
+		HEADLESS_BENCHMARK_NEAR, HEADLESS_BENCHMARK_DEPTH);
+
+	//The simulation step of Graphics::Update
+	Update(rotationY, rotation, (unsigned int)frame, projectionMatrix);
+	m_frameTimings.cull = ElapsedTime(phaseStart);
+
+	Stats::Add(STAT_OBJECTS_VISIBLE, m_snapshot.objectsVisible);
+	Stats::Add(STAT_OBJECTS_CULLED, m_snapshot.objectsCulled);
+
+	//No assets stream in, in the engine this phase only checks and uploads them
+	m_frameTimings.upload = 0.0f;
+
+	//The submission of Graphics::Render
+	m_GpuTimer->BeginFrame(m_renderContext);
+
+	worldMatrix = XMMatrixIdentity();
+	m_Camera->GetViewMatrix(viewMatrix);
+
+	FrameBuilder::QueueModels(m_snapshot, this, m_RenderQueue);
+	m_frameTimings.sort = ElapsedTime(phaseStart);
+
+	result = m_Renderer->Render(m_stateCache, m_targets, m_RenderQueue, m_Camera, m_Light, projectionMatrix);
+	if (!result)
+	{
+		return false;
+	}
+	m_frameTimings.submit = ElapsedTime(phaseStart);
+
+	//Debug lines, the depth tested ones and then the overlay. They are not part of any phase, like in the engine
+	result = m_DebugDraw->Upload(m_renderContext, m_snapshot.debugDepthTested, m_snapshot.debugOverlay);
+	if (!result)
+	{
+		return false;
+	}
+
+	result = m_DebugDraw->Render(m_renderContext, true, worldMatrix, viewMatrix, projectionMatrix);
+	if (!result)
+	{
+		return false;
+	}
+
+	result = m_DebugDraw->Render(m_renderContext, false, worldMatrix, viewMatrix, projectionMatrix);
+	if (!result)
+	{
+		return false;
+	}
+
+	ElapsedTime(phaseStart);
+	result = Overlay(frame);
+	if (!result)
+	{
+		return false;
+	}
+	m_frameTimings.text = ElapsedTime(phaseStart);
+
+	m_GpuTimer->EndFrame(m_renderContext);
+
+	m_frameTimings.total = ElapsedTime(frameStart);
+
+	return true;
+}
+
+void HeadlessBenchmark::Update(float rotationY, float rotation, unsigned int frame, XMMATRIX projectionMatrix)
+{
+	XMMATRIX viewMatrix;
+	int modelCount, index, firstLeaf;
+
+	m_Camera->SetRotation(0.0f, rotationY, 0.0f);
+	m_Camera->Render();
+	m_Camera->GetViewMatrix(viewMatrix);
+
+	//The random demo models spin like in the engine, the models of a scene file stay where they are
+	modelCount = m_ModelList->GetModelCount();
+	if (m_sceneName == "demo")
+	{
+		for (index = 0; index < modelCount; index++)
+		{
+			m_Transforms->SetRotation(m_modelNodes[index], 0.0f, rotation, 0.0f);
+		}
+	}
+
+	//A few leaves of the extra nodes move, the update has to leave the rest of the tree alone
+	firstLeaf = (m_extraNodeCount + HEADLESS_BENCHMARK_NODE_CHILDREN - 2) / HEADLESS_BENCHMARK_NODE_CHILDREN;
+	for (index = firstLeaf; index < m_extraNodeCount; index += HEADLESS_BENCHMARK_MOVING_NODES)
+	{
+		m_Transforms->SetRotation(m_extraNodes[index], 0.0f, rotation, 0.0f);
+	}
+
+	//Update the transforms, cull the models and collect the debug lines
+	m_FrameBuilder->Build(viewMatrix, projectionMatrix, m_Renderer->GetLightManager(), frame, m_snapshot);
+
+	m_snapshot.cameraPosition = m_Camera->GetPosition();
+	m_snapshot.cameraRotation = m_Camera->GetRotation();
+	m_snapshot.modelRotation = rotation;
+	m_snapshot.frame = frame;
+}
+
+bool HeadlessBenchmark::Overlay(int frame)
+{
+	XMMATRIX worldMatrix, baseViewMatrix, orthoMatrix;
+	SpriteRect spriteRect, spriteUV;
+	char line[HEADLESS_BENCHMARK_TEXT_LENGTH];
+	float top;
+	bool result;
+	int i;
+
+	worldMatrix = XMMatrixIdentity();
+	baseViewMatrix = m_Camera->GetBaseViewMatrix();
+	orthoMatrix = XMMatrixOrthographicLH((float)HEADLESS_BENCHMARK_WIDTH, (float)HEADLESS_BENCHMARK_HEIGHT, HEADLESS_BENCHMARK_NEAR,
+		HEADLESS_BENCHMARK_DEPTH);
+
+	//The hud sprite goes behind the text
+	m_SpriteBatch->Begin();
+
+	spriteRect.x = 325.0f;
+	spriteRect.y = 25.0f;
+	spriteRect.width = 100.0f;
+	spriteRect.height = 100.0f;
+	spriteUV.x = 0.0f;
+	spriteUV.y = 0.0f;
+	spriteUV.width = 1.0f;
+	spriteUV.height = 1.0f;
+	m_SpriteBatch->Draw(m_spriteView, spriteRect, spriteUV, PackTextColor(1.0f, 1.0f, 1.0f, 1.0f));
+
+	result = m_SpriteBatch->End(m_renderContext, worldMatrix, baseViewMatrix, orthoMatrix);
+	if (!result)
+	{
+		return false;
+	}
+
+	//Set the overlay lines, most of them change every frame
+	top = (float)HEADLESS_BENCHMARK_HEIGHT / 2.0f - 10.0f;
+	for (i = 0; i < HEADLESS_BENCHMARK_TEXT_LINES; i++)
+	{
+		switch (i)
+		{
+		case 0:
+			snprintf(line, sizeof(line), "Frame %d", frame);
+			break;
+		case 1:
+			snprintf(line, sizeof(line), "Visible %d Culled %d", m_snapshot.objectsVisible, m_snapshot.objectsCulled);
+			break;
+		case 2:
+			snprintf(line, sizeof(line), "Draws %d Lights %d", m_renderContext->GetCounters().draws, m_Renderer->GetPointLightCount());
+			break;
+		case 3:
+			snprintf(line, sizeof(line), "Cull %.3fms Sort %.3fms", m_frameTimings.cull, m_frameTimings.sort);
+			break;
+		case 4:
+			snprintf(line, sizeof(line), "Submit %.3fms Total %.3fms", m_frameTimings.submit, m_frameTimings.total);
+			break;
+		default:
+			snprintf(line, sizeof(line), "Line %d of the overlay", i);
+			break;
+		}
+
+		result = m_Text->SetString(m_textStrings[i], line, -(float)HEADLESS_BENCHMARK_WIDTH / 2.0f + 10.0f, top - 20.0f * (float)i,
+			PackTextColor(1.0f, 1.0f, 1.0f, 1.0f));
+		if (!result)
+		{
+			return false;
+		}
+	}
+
+	//Draw the text the way Text::Render does, the Text class itself loads its font from the files of Windows
+	result = m_Text->Render(m_renderContext);
+	if (!result)
+	{
+		return false;
+	}
+
+	TextBatcher::UploadGlyphs(m_renderContext, m_Font, m_fontTexture);
+
+	if (m_Text->GetIndexCount() > 0)
+	{
+		result = m_FontShader->Render(m_renderContext, m_Text->GetIndexCount(), m_Text->GetBaseVertex(), worldMatrix, baseViewMatrix,
+			orthoMatrix, m_fontView);
+		if (!result)
+		{
+			return false;
+		}
+	}
+
+	m_Font->BeginFrame();
+
+	return true;
+}
+
+bool HeadlessBenchmark::SubmitBaseline()
+{
+	D3D11_MAPPED_SUBRESOURCE mappedResource;
+	InstanceData* instance;
+	const VisibleModel* visible;
+	ID3D11ShaderResourceView* texture;
+	HRESULT result;
+	MeshBuffers* mesh;
+	UINT stride, offset;
+	int index;
+
+	offset = 0;
+
+	//Every model sets everything it needs, whatever the model before it left bound
+	for (index = 0; index < (int)m_snapshot.visibleModels.size(); index++)
+	{
+		visible = &m_snapshot.visibleModels[index];
+		mesh = &m_meshes[m_modelMeshes[visible->index]];
+		stride = mesh->vertexStride;
+
+		m_renderContext->IASetVertexBuffers(0, 1, &mesh->vertexBuffer, &stride, &offset);
+		m_renderContext->IASetIndexBuffer(mesh->indexBuffer, mesh->indexFormat, 0);
+		m_renderContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+
+		result = m_renderContext->Map(m_baselineConstants, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
+		if (FAILED(result))
+		{
+			return false;
+		}
+
+		instance = (InstanceData*)mappedResource.pData;
+		instance->worldMatrix = visible->worldMatrix;
+		instance->color = visible->color;
+		m_renderContext->Unmap(m_baselineConstants, 0);
+
+		m_renderContext->VSSetConstantBuffers(1, 1, &m_baselineConstants);
+		texture = m_textures[m_modelTextures[visible->index]];
+		m_renderContext->PSSetShaderResources(0, 1, &texture);
+		m_renderContext->IASetInputLayout(m_inputLayout);
+		m_renderContext->VSSetShader(m_vertexShader, NULL, 0);
+		m_renderContext->PSSetShader(m_pixelShader, NULL, 0);
+
+		m_renderContext->DrawIndexed(MESH_INDEX_COUNT, 0, 0);
+	}
+
+	return true;
+}
+
+bool HeadlessBenchmark::GetDraw(int model, DrawCall & draw, unsigned int & meshID, unsigned int & textureID)
+{
+	//The meshes and textures of the benchmark stay for the whole run
+	draw.mesh = &m_meshes[m_modelMeshes[model]];
+	draw.texture = m_textures[m_modelTextures[model]];
+	draw.indexCount = MESH_INDEX_COUNT;
+	meshID = (unsigned int)m_modelMeshes[model];
+	textureID = (unsigned int)m_modelTextures[model];
+
+	return true;
+}
+
+float HeadlessBenchmark::ElapsedTime(INT64 & start)
+{
+	INT64 currentTime;
+	float elapsed;
+
+	//Milliseconds since start, which then moves on to now for the next phase
+	QueryPerformanceCounter((LARGE_INTEGER*)&currentTime);
+	elapsed = (float)((double)(currentTime - start) * 1000.0 / (double)m_timerFrequency);
+	start = currentTime;
+
+	return elapsed;
+}
+
+bool HeadlessBenchmark::WriteResults(const char * filename)
+{
+	std::ofstream fout;
+	double frames;
+
+	fout.open(filename);
+	if (fout.fail())
+	{
+		return false;
+	}
+
+	//All times are in milliseconds
+	fout << "{\n";
+	fout << "\t\"scene\": \"" << BenchmarkStats::Escape(m_sceneName) << "\",\n";
+	fout << "\t\"backend\": \"null\",\n";
+	fout << "\t\"models\": " << m_ModelList->GetModelCount() << ",\n";
+	fout << "\t\"transformNodes\": " << m_Transforms->GetNodeCount() << ",\n";
+	fout << "\t\"workers\": " << JobSystem::GetWorkerCount() << ",\n";
+	fout << "\t\"frames\": " << m_timings.size() << ",\n";
+	fout << "\t\"warmupFrames\": " << HEADLESS_BENCHMARK_WARMUP_FRAMES << ",\n";
+	fout << "\t\"width\": " << HEADLESS_BENCHMARK_WIDTH << ",\n";
+	fout << "\t\"height\": " << HEADLESS_BENCHMARK_HEIGHT << ",\n";
+	BenchmarkStats::WritePhases(fout, m_timings);
+	BenchmarkStats::WriteSubmission(fout, "submission", m_counters, false);
+	BenchmarkStats::WriteSubmission(fout, "baselineSubmission", m_baselineCounters, false);
+	BenchmarkStats::WriteMemory(fout, (int)m_timings.size(), m_heapAllocations, m_allocatingFrames, m_frameBytes, m_frameOverflows,
+		false);
+
+	frames = m_timings.empty() ? 1.0 : (double)m_timings.size();
+	fout << "\t\"transformsUpdated\": " << (double)m_nodesUpdated / frames << "\n";
+	fout << "}\n";
+
+	fout.close();
+
+	return !fout.fail();
+}
+
+int HeadlessBenchmark::GetAllocatingFrames()
+{
+	return m_allocatingFrames;
+}
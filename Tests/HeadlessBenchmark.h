@@ -0,0 +1,155 @@
+#pragma once
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+#include "Camera.h"
+#include "DebugDrawRenderer.h"
+#include "FakeDevice.h"
+#include "FontShader.h"
+#include "ForwardRenderer.h"
+#include "FrameBuilder.h"
+#include "FrameSnapshot.h"
+#include "FrameTimings.h"
+#include "GlyphCache.h"
+#include "GpuTimer.h"
+#include "Light.h"
+#include "ModelList.h"
+#include "NullRenderContext.h"
+#include "RenderQueue.h"
+#include "RenderStateCache.h"
+#include "SpriteBatch.h"
+#include "TextBatcher.h"
+#include "TransformHierarchy.h"
+
+#define HEADLESS_BENCHMARK_WIDTH 1280
+#define HEADLESS_BENCHMARK_HEIGHT 720
+#define HEADLESS_BENCHMARK_NEAR 0.1f
+#define HEADLESS_BENCHMARK_DEPTH 1000.0f
+
+// Frames at the start that are left out of the results, they fill the glyph cache and warm the caches.
+#define HEADLESS_BENCHMARK_WARMUP_FRAMES 10
+
+// Frame time the models spin with every frame, so the animation is the same no matter how fast it runs.
+#define HEADLESS_BENCHMARK_FRAME_TIME 16.0f
+
+// Models of the demo scene when no scene file is given, like the engine.
+#define HEADLESS_BENCHMARK_DEMO_MODELS 50
+
+// Extra transform nodes hang in a tree of this many children per node. One leaf in HEADLESS_BENCHMARK_MOVING_NODES
+// moves every frame and the rest stay where they are, like the props of a level around a few animated ones.
+#define HEADLESS_BENCHMARK_NODE_CHILDREN 4
+#define HEADLESS_BENCHMARK_MOVING_NODES 100
+
+// Overlay lines laid out every frame.
+#define HEADLESS_BENCHMARK_TEXT_LINES 8
+#define HEADLESS_BENCHMARK_TEXT_LENGTH 64
+
+// Runs the cpu side of the engine frame without Windows or Direct3D. The frame is built by the FrameBuilder of the
+// engine and drawn by its ForwardRenderer, DebugDrawRenderer, SpriteBatch and TextBatcher into a NullRenderContext,
+// the device objects are fakes that only know their size and the shaders compile to nothing. Only the Text class and
+// the depth and blend toggles of D3D are left out, they need the font files and the real device. The cpu time of every
+// phase goes to a JSON file as percentiles, in the format of the engine benchmark, so runs on different builds and
+// machines can be compared. Gpu times need the engine benchmark on Windows. After every measured frame the visible
+// models are submitted once more without the timings, in model order and with all of their state set straight on the
+// render context, the way the engine drew before the queue, the batches and the state cache. Its counters are the
+// baseline the submission counters compare to, less the passes of the forward renderer and the overlay.
+class HeadlessBenchmark : public DrawSource
+{
+private:
+	// Font without a file, every printable character is a box of the same size.
+	class BoxGlyphLoader : public GlyphLoader
+	{
+	public:
+		bool LoadGlyph(unsigned int codepoint, GlyphBitmap& glyph) override;
+		float GetKerning(unsigned int first, unsigned int second) override;
+	};
+
+	std::string m_sceneName;
+	int m_frameCount;
+
+	FakeDevice* m_device;
+	NullRenderContext* m_renderContext;
+	RenderStateCache* m_stateCache;
+	// The device keeps what it created, the targets and the glyph page are made here.
+	RenderTargets m_targets;
+	FakeRenderTargetView* m_renderTarget;
+	FakeDepthStencilView* m_depthStencil;
+	FakeTexture2D* m_fontTexture;
+	ID3D11ShaderResourceView* m_fontView;
+	ID3D11ShaderResourceView* m_spriteView;
+	ID3D11Buffer* m_baselineConstants;
+	ID3D11InputLayout* m_inputLayout;
+	ID3D11VertexShader* m_vertexShader;
+	ID3D11PixelShader* m_pixelShader;
+
+	ModelList* m_ModelList;
+	TransformHierarchy* m_Transforms;
+	int* m_modelNodes;
+	int* m_modelMeshes;
+	int* m_modelTextures;
+	int* m_extraNodes;
+	int m_extraNodeCount;
+	// Reserved for every model up front, the draws point at their mesh.
+	std::vector<MeshBuffers> m_meshes;
+	std::vector<ID3D11ShaderResourceView*> m_textures;
+
+	Camera* m_Camera;
+	Light* m_Light;
+	FrameBuilder* m_FrameBuilder;
+	RenderQueue* m_RenderQueue;
+	ForwardRenderer* m_Renderer;
+	DebugDrawRenderer* m_DebugDraw;
+	GpuTimer* m_GpuTimer;
+	FrameSnapshot m_snapshot;
+
+	BoxGlyphLoader m_glyphLoader;
+	GlyphCache* m_Font;
+	TextBatcher* m_Text;
+	FontShader* m_FontShader;
+	SpriteBatch* m_SpriteBatch;
+	int m_textStrings[HEADLESS_BENCHMARK_TEXT_LINES];
+
+	INT64 m_timerFrequency;
+	FrameTimings m_frameTimings;
+
+	std::vector<FrameTimings> m_timings;
+	std::vector<NullRenderCounters> m_counters;
+	std::vector<NullRenderCounters> m_baselineCounters;
+	// Totals over the measured frames.
+	long long m_heapAllocations;
+	int m_allocatingFrames;
+	long long m_frameBytes;
+	long long m_frameOverflows;
+	long long m_nodesUpdated;
+
+	bool InitializeScene(const char* sceneFile, int modelCount, int extraNodeCount);
+	int FindMesh(const std::string& path, std::map<std::string, int>& meshes);
+	int FindTexture(const std::string& path, std::map<std::string, int>& textures);
+
+	bool InitializeRenderer();
+	bool InitializeOverlay();
+
+	void MoveCamera(int frame, float& rotationY);
+	bool Frame(int frame, float rotationY, float rotation);
+	void Update(float rotationY, float rotation, unsigned int frame, XMMATRIX projectionMatrix);
+	bool Overlay(int frame);
+	bool SubmitBaseline();
+
+	bool GetDraw(int model, DrawCall& draw, unsigned int& meshID, unsigned int& textureID) override;
+	float ElapsedTime(INT64& start);
+public:
+	HeadlessBenchmark();
+	HeadlessBenchmark(const HeadlessBenchmark& other);
+	~HeadlessBenchmark();
+
+	// A scene file of 0 runs the demo of modelCount random models. The extra nodes only go through the transform update.
+	bool Initialize(const char* sceneFile, int modelCount, int extraNodeCount, int frameCount);
+	void Shutdown();
+
+	bool Run();
+	bool WriteResults(const char* filename);
+
+	// Measured frames that allocated on the heap, a steady frame of the engine must not.
+	int GetAllocatingFrames();
+};
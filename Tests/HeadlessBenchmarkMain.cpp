@@ -0,0 +1,115 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "HeadlessBenchmark.h"
+#include "DebugDraw.h"
+#include "FrameMemory.h"
+#include "JobSystem.h"
+#include "Profiler.h"
+#include "Stats.h"
+
+//Runs the headless benchmark for "[-scene file] [-models count] [-nodes count] [-frames count] [-workers count] [-out file]
+//[-trace file] [-stats file] [-debug 1]", without a scene file it runs the demo of random models. It fails when a measured
+//frame allocated on the heap, debug 1 draws the debug lines of the engine so their frames are checked as well
+int main(int argc, char* argv[])
+{
+	HeadlessBenchmark* benchmark;
+	const char* scene;
+	const char* output;
+	const char* trace;
+	int modelCount, nodeCount, frameCount, workerCount, i;
+	bool result;
+
+	scene = 0;
+	output = "benchmark.json";
+	trace = 0;
+	modelCount = HEADLESS_BENCHMARK_DEMO_MODELS;
+	nodeCount = 0;
+	frameCount = 1000;
+	workerCount = JobSystem::GetDefaultWorkerCount();
+
+	for (i = 1; i + 1 < argc; i += 2)
+	{
+		if (strcmp(argv[i], "-scene") == 0)
+		{
+			scene = argv[i + 1];
+		}
+		else if (strcmp(argv[i], "-models") == 0)
+		{
+			modelCount = atoi(argv[i + 1]);
+		}
+		else if (strcmp(argv[i], "-nodes") == 0)
+		{
+			nodeCount = atoi(argv[i + 1]);
+		}
+		else if (strcmp(argv[i], "-frames") == 0)
+		{
+			frameCount = atoi(argv[i + 1]);
+		}
+		else if (strcmp(argv[i], "-workers") == 0)
+		{
+			workerCount = atoi(argv[i + 1]);
+		}
+		else if (strcmp(argv[i], "-out") == 0)
+		{
+			output = argv[i + 1];
+		}
+		else if (strcmp(argv[i], "-trace") == 0)
+		{
+			trace = argv[i + 1];
+		}
+		else if (strcmp(argv[i], "-stats") == 0)
+		{
+			Stats::OpenCsv(argv[i + 1]);
+		}
+		else if (strcmp(argv[i], "-debug") == 0)
+		{
+			DebugDraw::SetEnabled(atoi(argv[i + 1]) != 0);
+		}
+	}
+
+	JobSystem::Initialize(workerCount > 0 ? workerCount : 0);
+	Profiler::SetEnabled(trace != 0);
+
+	benchmark = new HeadlessBenchmark;
+	if (!benchmark)
+	{
+		return 1;
+	}
+
+	//Run the camera path and write the results
+	result = benchmark->Initialize(scene, modelCount > 0 ? modelCount : 1, nodeCount > 0 ? nodeCount : 0, frameCount > 0 ? frameCount : 1);
+	if (result)
+	{
+		result = benchmark->Run();
+	}
+
+	if (result)
+	{
+		result = benchmark->WriteResults(output);
+	}
+
+	if (result && trace)
+	{
+		result = Profiler::WriteChromeTrace(trace);
+	}
+
+	//The results are written either way, so the file shows how much the frames allocated
+	if (result && benchmark->GetAllocatingFrames() > 0)
+	{
+		fprintf(stderr, "%d of the measured frames allocated on the heap\n", benchmark->GetAllocatingFrames());
+		result = false;
+	}
+
+	benchmark->Shutdown();
+	delete benchmark;
+	benchmark = 0;
+
+	JobSystem::Shutdown();
+	Profiler::Shutdown();
+	DebugDraw::Shutdown();
+	FrameMemory::Shutdown();
+	Stats::CloseCsv();
+
+	return result ? 0 : 1;
+}
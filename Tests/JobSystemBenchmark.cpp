@@ -0,0 +1,140 @@
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include <Windows.h>
+#include "JobSystem.h"
+
+namespace
+{
+	const int WARMUP_FRAMES = 10;
+
+	std::atomic<long long> s_items(0);
+
+	// As little work as a job can do, so the times are the cost of the job system.
+	void CountItems(void* data, int begin, int end)
+	{
+		s_items.fetch_add(end - begin, std::memory_order_relaxed);
+	}
+
+	float Percentile(const std::vector<float>& sortedValues, float percentile)
+	{
+		int rank;
+
+		rank = (int)ceilf(percentile / 100.0f * (float)sortedValues.size()) - 1;
+		rank = rank < 0 ? 0 : (rank > (int)sortedValues.size() - 1 ? (int)sortedValues.size() - 1 : rank);
+
+		return sortedValues.empty() ? 0.0f : sortedValues[rank];
+	}
+
+	void WriteTimes(std::ofstream& fout, const char* name, std::vector<float>& times, int jobCount, bool last)
+	{
+		double sum;
+		size_t i;
+
+		std::sort(times.begin(), times.end());
+
+		sum = 0.0;
+		for (i = 0; i < times.size(); i++)
+		{
+			sum += times[i];
+		}
+
+		fout << "\t\"" << name << "\": { \"mean\": " << sum / times.size() << ", \"p50\": " << Percentile(times, 50.0f) <<
+			", \"p99\": " << Percentile(times, 99.0f) << ", \"max\": " << times.back() << ", \"nsPerJob\": " <<
+			sum / times.size() * 1000000.0 / jobCount << " }" << (last ? "\n" : ",\n");
+	}
+}
+
+//Times the job system for "[-workers count] [-jobs count] [-frames count] [-out file]". Every frame runs a loop of
+//single item jobs, which splits down to one job per item, and as many single jobs started one by one and waited for
+int main(int argc, char* argv[])
+{
+	std::vector<float> loopTimes, runTimes;
+	std::ofstream fout;
+	JobCounter counter(0);
+	INT64 frequency, start, end;
+	const char* output;
+	int workerCount, jobCount, frameCount, i, j;
+
+	workerCount = JobSystem::GetDefaultWorkerCount();
+	jobCount = 10000;
+	frameCount = 200;
+	output = "job_system.json";
+
+	for (i = 1; i + 1 < argc; i += 2)
+	{
+		if (strcmp(argv[i], "-workers") == 0)
+		{
+			workerCount = atoi(argv[i + 1]);
+		}
+		else if (strcmp(argv[i], "-jobs") == 0)
+		{
+			jobCount = atoi(argv[i + 1]);
+		}
+		else if (strcmp(argv[i], "-frames") == 0)
+		{
+			frameCount = atoi(argv[i + 1]);
+		}
+		else if (strcmp(argv[i], "-out") == 0)
+		{
+			output = argv[i + 1];
+		}
+	}
+
+	workerCount = workerCount > 0 ? workerCount : 0;
+	jobCount = jobCount > 0 ? jobCount : 1;
+	frameCount = frameCount > 0 ? frameCount : 1;
+
+	JobSystem::Initialize(workerCount);
+	QueryPerformanceFrequency((LARGE_INTEGER*)&frequency);
+
+	for (i = 0; i < WARMUP_FRAMES + frameCount; i++)
+	{
+		QueryPerformanceCounter((LARGE_INTEGER*)&start);
+		JobSystem::ParallelFor(jobCount, 1, CountItems, 0);
+		QueryPerformanceCounter((LARGE_INTEGER*)&end);
+
+		if (i >= WARMUP_FRAMES)
+		{
+			loopTimes.push_back((float)((double)(end - start) * 1000.0 / (double)frequency));
+		}
+
+		QueryPerformanceCounter((LARGE_INTEGER*)&start);
+		for (j = 0; j < jobCount; j++)
+		{
+			JobSystem::Run(CountItems, 0, &counter);
+		}
+		JobSystem::Wait(&counter);
+		QueryPerformanceCounter((LARGE_INTEGER*)&end);
+
+		if (i >= WARMUP_FRAMES)
+		{
+			runTimes.push_back((float)((double)(end - start) * 1000.0 / (double)frequency));
+		}
+	}
+
+	//All times are in milliseconds
+	fout.open(output);
+	fout << "{\n";
+	fout << "\t\"workers\": " << JobSystem::GetWorkerCount() << ",\n";
+	fout << "\t\"jobs\": " << jobCount << ",\n";
+	fout << "\t\"frames\": " << frameCount << ",\n";
+	WriteTimes(fout, "parallelFor", loopTimes, jobCount, false);
+	WriteTimes(fout, "run", runTimes, jobCount, true);
+	fout << "}\n";
+	fout.close();
+
+	JobSystem::Shutdown();
+
+	//Every item of every frame has to have run
+	if (s_items.load() != (long long)jobCount * 2 * (WARMUP_FRAMES + frameCount))
+	{
+		return 1;
+	}
+
+	return fout.fail() ? 1 : 0;
+}
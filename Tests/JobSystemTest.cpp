@@ -0,0 +1,249 @@
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "Test.h"
+#include "JobSystem.h"
+
+namespace
+{
+	const int WORKERS = 3;
+
+	struct CountData
+	{
+		std::atomic<int>* counts;
+	};
+
+	// Counts every item of the range, so items that run twice or never show up.
+	void CountItems(void* data, int begin, int end)
+	{
+		CountData* countData;
+		int i;
+
+		countData = (CountData*)data;
+		for (i = begin; i < end; i++)
+		{
+			countData->counts[i].fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+
+	// A single job per item, the data points at the count of the item itself. A job copied from a slot that was
+	// already reused runs the item of another job.
+	void CountOne(void* data, int begin, int end)
+	{
+		CHECK(begin == 0 && end == 1);
+		((std::atomic<int>*)data)->fetch_add(1, std::memory_order_relaxed);
+	}
+
+	struct NestedData
+	{
+		std::atomic<int>* counts;
+		int innerCount;
+	};
+
+	// Every item starts a loop of its own and waits for it inside of a job.
+	void RunInnerLoop(void* data, int begin, int end)
+	{
+		NestedData* nested;
+		CountData countData;
+		int i;
+
+		nested = (NestedData*)data;
+		for (i = begin; i < end; i++)
+		{
+			countData.counts = nested->counts + i * nested->innerCount;
+			JobSystem::ParallelFor(nested->innerCount, 1, CountItems, &countData);
+		}
+	}
+
+	int CountMismatches(const std::vector<std::atomic<int> >& counts, int expected)
+	{
+		int mismatches;
+		size_t i;
+
+		mismatches = 0;
+		for (i = 0; i < counts.size(); i++)
+		{
+			mismatches += counts[i].load() != expected ? 1 : 0;
+		}
+
+		return mismatches;
+	}
+
+	void ResetCounts(std::vector<std::atomic<int> >& counts)
+	{
+		size_t i;
+
+		for (i = 0; i < counts.size(); i++)
+		{
+			counts[i].store(0);
+		}
+	}
+
+	// Every item of a loop runs exactly once, whatever the count and the grain size.
+	void TestParallelFor()
+	{
+		std::vector<std::atomic<int> > counts(100000);
+		CountData countData;
+		const int itemCounts[5] = { 1, 2, 7, 1000, 100000 };
+		const int grainSizes[4] = { 0, 1, 16, 5000 };
+		int i, j, round;
+
+		countData.counts = counts.data();
+
+		for (round = 0; round < 5; round++)
+		{
+			for (i = 0; i < 5; i++)
+			{
+				for (j = 0; j < 4; j++)
+				{
+					ResetCounts(counts);
+					JobSystem::ParallelFor(itemCounts[i], grainSizes[j], CountItems, &countData);
+
+					// Only the items past the count are left at zero.
+					CHECK(CountMismatches(counts, 1) == (int)counts.size() - itemCounts[i]);
+					CHECK(counts[itemCounts[i] - 1].load() == 1);
+				}
+			}
+		}
+
+		// Nothing to do returns right away.
+		ResetCounts(counts);
+		JobSystem::ParallelFor(0, 1, CountItems, &countData);
+		CHECK(CountMismatches(counts, 0) == 0);
+	}
+
+	// Jobs that start loops and wait for them inside of other jobs.
+	void TestNested()
+	{
+		std::vector<std::atomic<int> > counts(64 * 256);
+		NestedData nested;
+
+		nested.counts = counts.data();
+		nested.innerCount = 256;
+
+		JobSystem::ParallelFor(64, 1, RunInnerLoop, &nested);
+
+		CHECK(CountMismatches(counts, 1) == 0);
+	}
+
+	// Far more single jobs than the deques and the rings hold, so the rings go round many times while thieves copy
+	// jobs out of them.
+	void TestManyJobs()
+	{
+		std::vector<std::atomic<int> > counts(JOB_SYSTEM_MAX_JOBS * 16);
+		JobCounter counter(0);
+		int round, i;
+
+		for (round = 0; round < 10; round++)
+		{
+			ResetCounts(counts);
+
+			for (i = 0; i < (int)counts.size(); i++)
+			{
+				JobSystem::Run(CountOne, &counts[i], &counter);
+			}
+
+			JobSystem::Wait(&counter);
+
+			CHECK(counter.load() == 0);
+			CHECK(CountMismatches(counts, 1) == 0);
+		}
+	}
+
+	struct RestartThread
+	{
+		std::atomic<int> step;
+		std::vector<std::atomic<int> > counts;
+
+		RestartThread()
+			: step(0), counts(10000)
+		{
+		}
+	};
+
+	// Runs a loop, then waits for the main thread to restart the job system and runs another one. The deque it
+	// got in the first run is gone by then.
+	void UseJobsAcrossRestart(RestartThread* restart)
+	{
+		CountData countData;
+		int round;
+
+		countData.counts = restart->counts.data();
+
+		for (round = 0; round < 3; round++)
+		{
+			JobSystem::ParallelFor((int)restart->counts.size(), 16, CountItems, &countData);
+			restart->step.store(round * 2 + 1);
+
+			while (restart->step.load() != round * 2 + 2)
+			{
+				std::this_thread::yield();
+			}
+		}
+	}
+
+	// A thread that used the job system before a restart gets a new deque instead of the freed one.
+	void TestRestart()
+	{
+		RestartThread restart;
+		std::thread thread;
+		int round;
+
+		thread = std::thread(UseJobsAcrossRestart, &restart);
+
+		for (round = 0; round < 3; round++)
+		{
+			while (restart.step.load() != round * 2 + 1)
+			{
+				std::this_thread::yield();
+			}
+
+			JobSystem::Shutdown();
+			JobSystem::Initialize(WORKERS);
+			restart.step.store(round * 2 + 2);
+		}
+
+		thread.join();
+
+		CHECK(CountMismatches(restart.counts, 3) == 0);
+	}
+
+	// Without workers everything runs on the calling thread.
+	void TestNoWorkers()
+	{
+		std::vector<std::atomic<int> > counts(1000);
+		CountData countData;
+		JobCounter counter(0);
+
+		JobSystem::Shutdown();
+		JobSystem::Initialize(0);
+		CHECK(JobSystem::GetWorkerCount() == 0);
+
+		countData.counts = counts.data();
+		JobSystem::ParallelFor(1000, 10, CountItems, &countData);
+		JobSystem::Run(CountOne, &counts[0], &counter);
+		CHECK(counter.load() == 0);
+
+		CHECK(counts[0].load() == 2);
+		CHECK(CountMismatches(counts, 1) == 1);
+
+		JobSystem::Shutdown();
+		JobSystem::Initialize(WORKERS);
+	}
+}
+
+int main()
+{
+	JobSystem::Initialize(WORKERS);
+	CHECK(JobSystem::GetWorkerCount() == WORKERS);
+
+	TestParallelFor();
+	TestNested();
+	TestManyJobs();
+	TestRestart();
+	TestNoWorkers();
+
+	JobSystem::Shutdown();
+
+	return TestResult("JobSystemTest");
+}
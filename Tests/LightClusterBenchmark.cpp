@@ -0,0 +1,139 @@
+#include <algorithm>
+#include <fstream>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include <Windows.h>
+#include "LightClusters.h"
+
+namespace
+{
+	const int WIDTH = 1280;
+	const int HEIGHT = 720;
+	const float NEAR_PLANE = 0.1f;
+	const float FAR_PLANE = 1000.0f;
+	const int WARMUP_FRAMES = 10;
+
+	unsigned int s_seed = 1;
+
+	float Random(float low, float high)
+	{
+		s_seed = s_seed * 1664525u + 1013904223u;
+		return low + (high - low) * (float)(s_seed >> 8) / (float)(1u << 24);
+	}
+
+	float Percentile(const std::vector<float>& sortedValues, float percentile)
+	{
+		int rank;
+
+		rank = (int)ceilf(percentile / 100.0f * (float)sortedValues.size()) - 1;
+		rank = rank < 0 ? 0 : (rank > (int)sortedValues.size() - 1 ? (int)sortedValues.size() - 1 : rank);
+
+		return sortedValues.empty() ? 0.0f : sortedValues[rank];
+	}
+}
+
+//Times LightClusterBuilder::Build for "[-lights count] [-frames count] [-out file]". The lights are spread through
+//a city sized block around a camera that turns once around, like the camera path of the other benchmarks
+int main(int argc, char* argv[])
+{
+	LightClusterBuilder* clusters;
+	std::vector<PointLight> lights;
+	std::vector<float> times;
+	std::ofstream fout;
+	XMMATRIX viewMatrix, projectionMatrix;
+	INT64 frequency, start, end;
+	const char* output;
+	double sum, indices;
+	int lightCount, frameCount, overflows, i;
+	float angle;
+
+	lightCount = 1000;
+	frameCount = 500;
+	output = "light_clusters.json";
+
+	for (i = 1; i + 1 < argc; i += 2)
+	{
+		if (strcmp(argv[i], "-lights") == 0)
+		{
+			lightCount = atoi(argv[i + 1]);
+		}
+		else if (strcmp(argv[i], "-frames") == 0)
+		{
+			frameCount = atoi(argv[i + 1]);
+		}
+		else if (strcmp(argv[i], "-out") == 0)
+		{
+			output = argv[i + 1];
+		}
+	}
+
+	lightCount = lightCount > 0 ? lightCount : 1;
+	frameCount = frameCount > 0 ? frameCount : 1;
+
+	clusters = new LightClusterBuilder;
+	if (!clusters || !clusters->Initialize(WIDTH, HEIGHT, NEAR_PLANE, FAR_PLANE, lightCount))
+	{
+		return 1;
+	}
+
+	lights.resize(lightCount);
+	for (i = 0; i < lightCount; i++)
+	{
+		lights[i].position = XMFLOAT3(Random(-200.0f, 200.0f), Random(0.0f, 20.0f), Random(-200.0f, 200.0f));
+		lights[i].range = Random(1.0f, 8.0f);
+		lights[i].color = XMFLOAT3(1.0f, 1.0f, 1.0f);
+		lights[i].intensity = 1.0f;
+		lights[i].direction = XMFLOAT3(0.0f, 0.0f, 1.0f);
+		lights[i].spotCosine = LIGHT_POINT_SPOT_COSINE;
+	}
+
+	projectionMatrix = XMMatrixPerspectiveFovLH(XM_PIDIV4, (float)WIDTH / (float)HEIGHT, NEAR_PLANE, FAR_PLANE);
+	QueryPerformanceFrequency((LARGE_INTEGER*)&frequency);
+
+	sum = 0.0;
+	indices = 0.0;
+	overflows = 0;
+
+	for (i = 0; i < WARMUP_FRAMES + frameCount; i++)
+	{
+		angle = (float)i / (float)(WARMUP_FRAMES + frameCount) * XM_2PI;
+		viewMatrix = XMMatrixLookToLH(XMVectorSet(0.0f, 10.0f, 0.0f, 1.0f), XMVectorSet(sinf(angle), 0.0f, cosf(angle), 0.0f),
+			XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+
+		QueryPerformanceCounter((LARGE_INTEGER*)&start);
+		clusters->Build(lights.data(), lightCount, viewMatrix, projectionMatrix);
+		QueryPerformanceCounter((LARGE_INTEGER*)&end);
+
+		if (i < WARMUP_FRAMES)
+		{
+			continue;
+		}
+
+		times.push_back((float)((double)(end - start) * 1000.0 / (double)frequency));
+		sum += times.back();
+		indices += clusters->GetLightIndexCount();
+		overflows += clusters->HasOverflowed() ? 1 : 0;
+	}
+
+	std::sort(times.begin(), times.end());
+
+	//All times are in milliseconds
+	fout.open(output);
+	fout << "{\n";
+	fout << "\t\"lights\": " << lightCount << ",\n";
+	fout << "\t\"clusters\": " << clusters->GetClusterCount() << ",\n";
+	fout << "\t\"frames\": " << frameCount << ",\n";
+	fout << "\t\"build\": { \"mean\": " << sum / frameCount << ", \"p50\": " << Percentile(times, 50.0f) << ", \"p90\": " <<
+		Percentile(times, 90.0f) << ", \"p99\": " << Percentile(times, 99.0f) << ", \"max\": " << times.back() << " },\n";
+	fout << "\t\"lightIndices\": " << indices / frameCount << ",\n";
+	fout << "\t\"overflowFrames\": " << overflows << "\n";
+	fout << "}\n";
+	fout.close();
+
+	clusters->Shutdown();
+	delete clusters;
+	clusters = 0;
+
+	return fout.fail() ? 1 : 0;
+}
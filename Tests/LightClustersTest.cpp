@@ -0,0 +1,254 @@
+#include <math.h>
+#include <vector>
+#include "Test.h"
+#include "LightClusters.h"
+
+namespace
+{
+	const int WIDTH = 1280;
+	const int HEIGHT = 720;
+	const float NEAR_PLANE = 0.1f;
+	const float FAR_PLANE = 1000.0f;
+
+	unsigned int s_seed = 4242;
+
+	float Random(float low, float high)
+	{
+		s_seed = s_seed * 1664525u + 1013904223u;
+		return low + (high - low) * (float)(s_seed >> 8) / (float)(1u << 24);
+	}
+
+	PointLight Light(float x, float y, float z, float range)
+	{
+		PointLight light;
+
+		light.position = XMFLOAT3(x, y, z);
+		light.range = range;
+		light.color = XMFLOAT3(1.0f, 1.0f, 1.0f);
+		light.intensity = 1.0f;
+		light.direction = XMFLOAT3(0.0f, 0.0f, 1.0f);
+		light.spotCosine = LIGHT_POINT_SPOT_COSINE;
+
+		return light;
+	}
+
+	XMMATRIX Projection()
+	{
+		return XMMatrixPerspectiveFovLH(XM_PIDIV4, (float)WIDTH / (float)HEIGHT, NEAR_PLANE, FAR_PLANE);
+	}
+
+	bool ClusterHasLight(LightClusterBuilder& clusters, int cluster, unsigned int light)
+	{
+		const unsigned int* ranges;
+		unsigned int i;
+
+		ranges = clusters.GetClusterRanges();
+		for (i = 0; i < ranges[cluster * 2 + 1]; i++)
+		{
+			if (clusters.GetLightIndices()[ranges[cluster * 2] + i] == light)
+			{
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	// Cluster of a view space point, found the way the pixel shader finds it.
+	int FindCluster(LightClusterBuilder& clusters, const XMFLOAT3& point, const XMFLOAT4X4& projection)
+	{
+		XMFLOAT2 sliceParameters;
+		float x, y;
+		int tileX, tileY, slice;
+
+		x = (projection._11 * point.x / point.z + 1.0f) * 0.5f * (float)WIDTH;
+		y = (1.0f - projection._22 * point.y / point.z) * 0.5f * (float)HEIGHT;
+		if (x < 0.0f || x >= (float)WIDTH || y < 0.0f || y >= (float)HEIGHT || point.z < NEAR_PLANE || point.z >= FAR_PLANE)
+		{
+			return -1;
+		}
+
+		sliceParameters = clusters.GetSliceParameters();
+		slice = (int)floorf(log2f(point.z) * sliceParameters.x + sliceParameters.y);
+		slice = slice < 0 ? 0 : (slice >= LIGHT_CLUSTER_SLICES ? LIGHT_CLUSTER_SLICES - 1 : slice);
+		tileX = (int)x / LIGHT_CLUSTER_TILE_SIZE;
+		tileY = (int)y / LIGHT_CLUSTER_TILE_SIZE;
+
+		return (slice * clusters.GetTilesY() + tileY) * clusters.GetTilesX() + tileX;
+	}
+
+	void TestLayout()
+	{
+		LightClusterBuilder clusters;
+
+		CHECK(clusters.Initialize(WIDTH, HEIGHT, NEAR_PLANE, FAR_PLANE, 16));
+		CHECK(clusters.GetTilesX() == 20);
+		CHECK(clusters.GetTilesY() == 12);
+		CHECK(clusters.GetClusterCount() == 20 * 12 * LIGHT_CLUSTER_SLICES);
+
+		// The first slice starts at the near plane and the last one ends at the far plane.
+		CHECK_NEAR(log2f(NEAR_PLANE) * clusters.GetSliceParameters().x + clusters.GetSliceParameters().y, 0.0f, 1e-4f);
+		CHECK_NEAR(log2f(FAR_PLANE) * clusters.GetSliceParameters().x + clusters.GetSliceParameters().y, (float)LIGHT_CLUSTER_SLICES, 1e-4f);
+
+		clusters.Shutdown();
+	}
+
+	// A small light in the middle of the screen, one behind the camera and one past the far plane.
+	void TestSingleLights()
+	{
+		LightClusterBuilder clusters;
+		XMFLOAT4X4 projection;
+		std::vector<PointLight> lights;
+		int cluster, total;
+
+		XMStoreFloat4x4(&projection, Projection());
+		CHECK(clusters.Initialize(WIDTH, HEIGHT, NEAR_PLANE, FAR_PLANE, 16));
+
+		lights.push_back(Light(0.5f, 0.5f, 20.0f, 0.1f));
+		lights.push_back(Light(0.0f, 0.0f, -20.0f, 1.0f));
+		lights.push_back(Light(0.0f, 0.0f, 2000.0f, 1.0f));
+
+		clusters.Build(lights.data(), (int)lights.size(), XMMatrixIdentity(), Projection());
+
+		cluster = FindCluster(clusters, XMFLOAT3(0.5f, 0.5f, 20.0f), projection);
+		CHECK(cluster >= 0 && ClusterHasLight(clusters, cluster, 0));
+
+		// It covers one tile and one slice, or two of either where it sits on a boundary.
+		total = clusters.GetLightIndexCount();
+		CHECK(total >= 1 && total <= 4);
+		CHECK(!clusters.HasOverflowed());
+		CHECK(clusters.GetDroppedIndexCount() == 0);
+
+		clusters.Shutdown();
+	}
+
+	// Every visible point inside a light has to find the light in its cluster, or the pixel there misses it.
+	void TestConservative()
+	{
+		LightClusterBuilder clusters;
+		XMFLOAT4X4 projection;
+		XMFLOAT3 point;
+		std::vector<PointLight> lights;
+		float length;
+		int i, j, cluster, tested;
+
+		XMStoreFloat4x4(&projection, Projection());
+		CHECK(clusters.Initialize(WIDTH, HEIGHT, NEAR_PLANE, FAR_PLANE, 64));
+
+		for (i = 0; i < 64; i++)
+		{
+			lights.push_back(Light(Random(-30.0f, 30.0f), Random(-20.0f, 20.0f), Random(-5.0f, 80.0f), Random(0.5f, 8.0f)));
+		}
+
+		clusters.Build(lights.data(), (int)lights.size(), XMMatrixIdentity(), Projection());
+
+		tested = 0;
+		for (i = 0; i < (int)lights.size(); i++)
+		{
+			for (j = 0; j < 200; j++)
+			{
+				// A point on or inside the sphere.
+				point = XMFLOAT3(Random(-1.0f, 1.0f), Random(-1.0f, 1.0f), Random(-1.0f, 1.0f));
+				length = sqrtf(point.x * point.x + point.y * point.y + point.z * point.z);
+				if (length > 1.0f || length == 0.0f)
+				{
+					continue;
+				}
+
+				point.x = lights[i].position.x + point.x * lights[i].range;
+				point.y = lights[i].position.y + point.y * lights[i].range;
+				point.z = lights[i].position.z + point.z * lights[i].range;
+
+				cluster = FindCluster(clusters, point, projection);
+				if (cluster < 0)
+				{
+					continue;
+				}
+
+				CHECK(ClusterHasLight(clusters, cluster, i));
+				tested++;
+			}
+		}
+
+		CHECK(tested > 1000);
+
+		clusters.Shutdown();
+	}
+
+	// Four lights go through the SSE path and a single one through the scalar path, both have to agree.
+	void TestVectorPath()
+	{
+		LightClusterBuilder all, single;
+		std::vector<PointLight> lights;
+		std::vector<std::vector<bool> > expected;
+		int i, cluster;
+
+		CHECK(all.Initialize(WIDTH, HEIGHT, NEAR_PLANE, FAR_PLANE, 16));
+		CHECK(single.Initialize(WIDTH, HEIGHT, NEAR_PLANE, FAR_PLANE, 16));
+
+		for (i = 0; i < 16; i++)
+		{
+			lights.push_back(Light(Random(-40.0f, 40.0f), Random(-20.0f, 20.0f), Random(-10.0f, 200.0f), Random(0.5f, 20.0f)));
+		}
+
+		all.Build(lights.data(), (int)lights.size(), XMMatrixTranslation(1.0f, -2.0f, 5.0f), Projection());
+
+		for (i = 0; i < (int)lights.size(); i++)
+		{
+			single.Build(&lights[i], 1, XMMatrixTranslation(1.0f, -2.0f, 5.0f), Projection());
+
+			for (cluster = 0; cluster < all.GetClusterCount(); cluster++)
+			{
+				CHECK(ClusterHasLight(all, cluster, i) == (single.GetClusterRanges()[cluster * 2 + 1] == 1));
+			}
+		}
+
+		all.Shutdown();
+		single.Shutdown();
+	}
+
+	// Lights that cover every cluster fill the index list, the ranges have to stay inside of it.
+	void TestOverflow()
+	{
+		LightClusterBuilder clusters;
+		std::vector<PointLight> lights;
+		const unsigned int* ranges;
+		int i, lightCount;
+
+		lightCount = LIGHT_CLUSTER_MAX_INDICES / (20 * 12 * LIGHT_CLUSTER_SLICES) + 2;
+		CHECK(clusters.Initialize(WIDTH, HEIGHT, NEAR_PLANE, FAR_PLANE, lightCount));
+
+		for (i = 0; i < lightCount; i++)
+		{
+			lights.push_back(Light(0.0f, 0.0f, 0.0f, 2000.0f));
+		}
+
+		clusters.Build(lights.data(), lightCount, XMMatrixIdentity(), Projection());
+
+		CHECK(clusters.HasOverflowed());
+		CHECK(clusters.GetLightIndexCount() == LIGHT_CLUSTER_MAX_INDICES);
+		CHECK(clusters.GetDroppedIndexCount() == lightCount * clusters.GetClusterCount() - LIGHT_CLUSTER_MAX_INDICES);
+
+		ranges = clusters.GetClusterRanges();
+		for (i = 0; i < clusters.GetClusterCount(); i++)
+		{
+			CHECK(ranges[i * 2] + ranges[i * 2 + 1] <= LIGHT_CLUSTER_MAX_INDICES);
+		}
+
+		// The first clusters still got every light.
+		CHECK(ranges[1] == (unsigned int)lightCount);
+
+		clusters.Shutdown();
+	}
+}
+
+int main()
+{
+	TestLayout();
+	TestSingleLights();
+	TestConservative();
+	TestVectorPath();
+	TestOverflow();
+
+	return TestResult("LightClustersTest");
+}
@@ -0,0 +1,193 @@
+#include <vector>
+#include "Test.h"
+#include "LightCulling.h"
+
+namespace
+{
+	// Four by two tiles, the projection has _11 = 0.5 and _22 = 1, so a tile is half a unit of x and y per unit of z.
+	const int WIDTH = 64;
+	const int HEIGHT = 32;
+	const float NEAR_PLANE = 1.0f;
+	const float FAR_PLANE = 100.0f;
+
+	struct Scene
+	{
+		XMMATRIX projectionMatrix;
+		XMFLOAT4 projection;
+		std::vector<float> depth;
+		std::vector<float> tileMinDepth;
+		std::vector<float> tileMaxDepth;
+		std::vector<unsigned int> tileLightIndices;
+		int tilesX;
+		int tilesY;
+	};
+
+	// Depth buffer value of a view space depth.
+	float DepthOf(const Scene& scene, float viewDepth)
+	{
+		return scene.projection.z + scene.projection.w / viewDepth;
+	}
+
+	// View space point at the middle of a tile.
+	XMFLOAT3 TileCenter(const Scene& scene, int tileX, int tileY, float viewDepth)
+	{
+		float x, y;
+
+		x = ((float)tileX + 0.5f) * (float)LIGHT_TILE_SIZE / (float)WIDTH * 2.0f - 1.0f;
+		y = 1.0f - ((float)tileY + 0.5f) * (float)LIGHT_TILE_SIZE / (float)HEIGHT * 2.0f;
+
+		return XMFLOAT3(x * viewDepth / scene.projection.x, y * viewDepth / scene.projection.y, viewDepth);
+	}
+
+	PointLight Light(const XMFLOAT3& position, float range)
+	{
+		PointLight light;
+
+		light.position = position;
+		light.range = range;
+		light.color = XMFLOAT3(1.0f, 1.0f, 1.0f);
+		light.intensity = 1.0f;
+		light.direction = XMFLOAT3(0.0f, 0.0f, 1.0f);
+		light.spotCosine = LIGHT_POINT_SPOT_COSINE;
+
+		return light;
+	}
+
+	// Everything is at depth 10 except the last tile, which has a pixel at 5 and one at 50.
+	void CreateScene(Scene& scene)
+	{
+		scene.projectionMatrix = XMMatrixPerspectiveFovLH(XM_PIDIV2, 2.0f, NEAR_PLANE, FAR_PLANE);
+		scene.projection = GetLightTileProjection(scene.projectionMatrix);
+		scene.tilesX = GetLightTileCount(WIDTH);
+		scene.tilesY = GetLightTileCount(HEIGHT);
+
+		scene.depth.assign(WIDTH * HEIGHT, DepthOf(scene, 10.0f));
+		scene.depth[(HEIGHT - 1) * WIDTH + WIDTH - 1] = DepthOf(scene, 5.0f);
+		scene.depth[(HEIGHT - 2) * WIDTH + WIDTH - 2] = DepthOf(scene, 50.0f);
+
+		scene.tileMinDepth.resize(scene.tilesX * scene.tilesY);
+		scene.tileMaxDepth.resize(scene.tilesX * scene.tilesY);
+		scene.tileLightIndices.assign(scene.tilesX * scene.tilesY * LIGHT_TILE_STRIDE, 0xffffffff);
+
+		ComputeTileDepthBounds(scene.depth.data(), WIDTH, HEIGHT, scene.tileMinDepth.data(), scene.tileMaxDepth.data());
+	}
+
+	void Bin(Scene& scene, const std::vector<PointLight>& lights)
+	{
+		BinLightsToTiles(lights.data(), (int)lights.size(), XMMatrixIdentity(), scene.projection, scene.tileMinDepth.data(),
+			scene.tileMaxDepth.data(), WIDTH, HEIGHT, scene.tileLightIndices.data());
+	}
+
+	// The light list the compute shader writes for a tile, count first and sorted like the reference sorts it.
+	void CheckTile(const Scene& scene, int tileX, int tileY, const std::vector<unsigned int>& expected)
+	{
+		const unsigned int* tile;
+		size_t i;
+
+		tile = &scene.tileLightIndices[(tileY * scene.tilesX + tileX) * LIGHT_TILE_STRIDE];
+
+		CHECK(tile[0] == expected.size());
+		for (i = 0; i < expected.size() && i < tile[0]; i++)
+		{
+			CHECK(tile[1 + i] == expected[i]);
+		}
+	}
+
+	void TestTileCount()
+	{
+		CHECK(GetLightTileCount(64) == 4);
+		CHECK(GetLightTileCount(65) == 5);
+		CHECK(GetLightTileCount(1) == 1);
+	}
+
+	void TestDepthBounds()
+	{
+		Scene scene;
+		int tile;
+
+		CreateScene(scene);
+
+		for (tile = 0; tile < scene.tilesX * scene.tilesY - 1; tile++)
+		{
+			CHECK(scene.tileMinDepth[tile] == DepthOf(scene, 10.0f));
+			CHECK(scene.tileMaxDepth[tile] == DepthOf(scene, 10.0f));
+		}
+
+		CHECK(scene.tileMinDepth[tile] == DepthOf(scene, 5.0f));
+		CHECK(scene.tileMaxDepth[tile] == DepthOf(scene, 50.0f));
+	}
+
+	void TestBinning()
+	{
+		Scene scene;
+		std::vector<PointLight> lights;
+		XMFLOAT3 position;
+		int tileX, tileY;
+
+		CreateScene(scene);
+
+		// 0: small light in the middle of the first tile.
+		lights.push_back(Light(TileCenter(scene, 0, 0, 10.0f), 0.5f));
+		// 1: same tile, but far behind the surfaces of it.
+		lights.push_back(Light(TileCenter(scene, 0, 0, 30.0f), 1.0f));
+		// 2: on the edge between the second and third tile of the top row.
+		position = TileCenter(scene, 1, 0, 10.0f);
+		position.x += 5.0f;
+		lights.push_back(Light(position, 0.5f));
+		// 3: behind the depth 10 surfaces but in front of the 50 pixel of the last tile.
+		lights.push_back(Light(TileCenter(scene, 3, 1, 30.0f), 1.0f));
+		// 4: reaches every tile.
+		lights.push_back(Light(XMFLOAT3(0.0f, 0.0f, 10.0f), 100.0f));
+		// 5: behind the camera.
+		lights.push_back(Light(XMFLOAT3(0.0f, 0.0f, -10.0f), 1.0f));
+
+		Bin(scene, lights);
+
+		CheckTile(scene, 0, 0, std::vector<unsigned int>{ 0, 4 });
+		CheckTile(scene, 1, 0, std::vector<unsigned int>{ 2, 4 });
+		CheckTile(scene, 2, 0, std::vector<unsigned int>{ 2, 4 });
+		CheckTile(scene, 3, 0, std::vector<unsigned int>{ 4 });
+		CheckTile(scene, 3, 1, std::vector<unsigned int>{ 3, 4 });
+
+		for (tileY = 1, tileX = 0; tileX < 3; tileX++)
+		{
+			CheckTile(scene, tileX, tileY, std::vector<unsigned int>{ 4 });
+		}
+	}
+
+	// Tiles keep the first LIGHT_MAX_PER_TILE lights that touch them.
+	void TestOverflow()
+	{
+		Scene scene;
+		std::vector<PointLight> lights;
+		std::vector<unsigned int> expected;
+		int i;
+
+		CreateScene(scene);
+
+		for (i = 0; i < LIGHT_MAX_PER_TILE + 10; i++)
+		{
+			lights.push_back(Light(XMFLOAT3(0.0f, 0.0f, 10.0f), 100.0f));
+		}
+
+		for (i = 0; i < LIGHT_MAX_PER_TILE; i++)
+		{
+			expected.push_back(i);
+		}
+
+		Bin(scene, lights);
+
+		CheckTile(scene, 0, 0, expected);
+		CheckTile(scene, 3, 1, expected);
+	}
+}
+
+int main()
+{
+	TestTileCount();
+	TestDepthBounds();
+	TestBinning();
+	TestOverflow();
+
+	return TestResult("LightCullingTest");
+}
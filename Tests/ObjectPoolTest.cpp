@@ -0,0 +1,160 @@
+#include <vector>
+#include "Test.h"
+#include "ObjectPool.h"
+
+namespace
+{
+	int s_alive = 0;
+
+	// Counts the objects that were constructed and not destroyed yet.
+	struct Counted
+	{
+		int value;
+
+		Counted()
+		{
+			value = 0;
+			s_alive++;
+		}
+
+		~Counted()
+		{
+			s_alive--;
+		}
+	};
+
+	// A freed object is gone for every handle to it, also once its slot holds another object.
+	void TestStaleHandles()
+	{
+		ObjectPool<Counted> pool;
+		Handle<Counted> first, second, reused, none;
+
+		CHECK(pool.Initialize(4));
+		CHECK(!none.IsValid());
+		CHECK(pool.Get(none) == 0);
+
+		first = pool.Allocate();
+		second = pool.Allocate();
+		CHECK(first.IsValid() && second.IsValid());
+		CHECK(first != second);
+		CHECK(pool.Get(first) != 0 && pool.Get(second) != 0);
+		CHECK(s_alive == 2);
+
+		pool.Get(first)->value = 1;
+		pool.Free(first);
+		CHECK(pool.Get(first) == 0);
+		CHECK(pool.GetAt((int)first.index) == 0);
+		CHECK(pool.GetCount() == 1);
+		CHECK(s_alive == 1);
+
+		// The slot comes back with another generation, the old handle stays stale.
+		reused = pool.Allocate();
+		CHECK(reused.index == first.index);
+		CHECK(reused.generation != first.generation);
+		CHECK(pool.Get(first) == 0);
+		CHECK(pool.Get(reused) != 0 && pool.Get(reused)->value == 0);
+
+		// Freeing through a stale handle leaves the new object alone.
+		pool.Free(first);
+		CHECK(pool.Get(reused) != 0);
+		CHECK(pool.GetCount() == 2);
+		CHECK(s_alive == 2);
+
+		// An index past the slots is no object either.
+		none.index = 100;
+		none.generation = 1;
+		CHECK(pool.Get(none) == 0);
+
+		pool.Shutdown();
+		CHECK(s_alive == 0);
+		CHECK(pool.Get(second) == 0);
+	}
+
+	// Freed slots are taken again before untouched ones, the last one freed first.
+	void TestFreeList()
+	{
+		ObjectPool<Counted> pool;
+		Handle<Counted> handles[4];
+		int i;
+
+		CHECK(pool.Initialize(4));
+
+		// The first objects sit next to each other.
+		for (i = 0; i < 4; i++)
+		{
+			handles[i] = pool.Allocate();
+			CHECK(handles[i].index == (unsigned int)i);
+		}
+		CHECK(pool.Get(handles[1]) == pool.Get(handles[0]) + 1);
+
+		pool.Free(handles[1]);
+		pool.Free(handles[3]);
+		CHECK(pool.Allocate().index == 3);
+		CHECK(pool.Allocate().index == 1);
+		CHECK(pool.GetCount() == 4);
+		CHECK(pool.GetCapacity() == 4);
+
+		pool.Shutdown();
+		CHECK(s_alive == 0);
+	}
+
+	// A full pool adds a block, the objects already handed out stay where they are.
+	void TestGrow()
+	{
+		ObjectPool<Counted> pool;
+		std::vector<Handle<Counted> > handles;
+		std::vector<Counted*> objects;
+		int i, found;
+
+		CHECK(pool.Initialize(3));
+		CHECK(pool.GetCapacity() == 3);
+
+		for (i = 0; i < 10; i++)
+		{
+			handles.push_back(pool.Allocate());
+			CHECK(handles.back().IsValid());
+			objects.push_back(pool.Get(handles.back()));
+			objects.back()->value = i;
+		}
+
+		CHECK(pool.GetCapacity() == 12);
+		CHECK(pool.GetCount() == 10);
+		CHECK(s_alive == 10);
+
+		for (i = 0; i < 10; i++)
+		{
+			CHECK(pool.Get(handles[i]) == objects[i]);
+			CHECK(objects[i]->value == i);
+		}
+
+		// Going over the slots finds every object once.
+		found = 0;
+		for (i = 0; i < pool.GetCapacity(); i++)
+		{
+			found += pool.GetAt(i) ? 1 : 0;
+		}
+		CHECK(found == 10);
+
+		// Slots freed in a later block are reused before the pool grows again.
+		pool.Free(handles[7]);
+		CHECK(pool.Allocate().index == handles[7].index);
+		CHECK(pool.GetCapacity() == 12);
+
+		pool.Shutdown();
+		CHECK(s_alive == 0);
+		CHECK(pool.GetCapacity() == 0);
+
+		// A pool without blocks hands out nothing.
+		CHECK(!pool.Initialize(0));
+		CHECK(!pool.Allocate().IsValid());
+	}
+}
+
+int main()
+{
+	TestStaleHandles();
+	TestFreeList();
+	TestGrow();
+
+	return TestResult("ObjectPoolTest");
+}
@@ -0,0 +1,92 @@
+#pragma once
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+// Stand-in for the few Windows types and calls the portable parts of the engine use, so they build on other
+// platforms. The performance counter ticks in nanoseconds.
+
+typedef int BOOL;
+typedef int INT;
+typedef unsigned int UINT;
+typedef unsigned char UINT8;
+typedef int64_t INT64;
+typedef uint64_t UINT64;
+typedef float FLOAT;
+typedef long HRESULT;
+typedef unsigned long ULONG;
+typedef unsigned long DWORD;
+typedef size_t SIZE_T;
+typedef uintptr_t UINT_PTR;
+typedef wchar_t WCHAR;
+typedef const char* LPCSTR;
+typedef const wchar_t* LPCWSTR;
+
+struct HWND__;
+typedef HWND__* HWND;
+
+struct GUID
+{
+	uint32_t Data1;
+	uint16_t Data2;
+	uint16_t Data3;
+	uint8_t Data4[8];
+};
+
+typedef const GUID& REFGUID;
+typedef const GUID& REFIID;
+
+// COM methods use the default calling convention outside of Windows.
+#define STDMETHODCALLTYPE
+
+#define TRUE 1
+#define FALSE 0
+
+#define S_OK ((HRESULT)0)
+#define S_FALSE ((HRESULT)1)
+#define E_FAIL ((HRESULT)0x80004005L)
+#define E_OUTOFMEMORY ((HRESULT)0x8007000EL)
+#define E_NOINTERFACE ((HRESULT)0x80004002L)
+#define SUCCEEDED(result) (((HRESULT)(result)) >= 0)
+#define FAILED(result) (((HRESULT)(result)) < 0)
+
+#define MB_OK 0x0
+
+#define ZeroMemory(destination, length) memset((destination), 0, (length))
+
+union LARGE_INTEGER
+{
+	INT64 QuadPart;
+};
+
+inline BOOL QueryPerformanceCounter(LARGE_INTEGER* counter)
+{
+	timespec time;
+
+	clock_gettime(CLOCK_MONOTONIC, &time);
+	counter->QuadPart = (INT64)time.tv_sec * 1000000000 + time.tv_nsec;
+
+	return TRUE;
+}
+
+inline BOOL QueryPerformanceFrequency(LARGE_INTEGER* frequency)
+{
+	frequency->QuadPart = 1000000000;
+
+	return TRUE;
+}
+
+inline DWORD GetCurrentThreadId()
+{
+	return (DWORD)(uintptr_t)pthread_self();
+}
+
+// There is no window to show the box in, the message goes to stderr.
+inline int MessageBox(HWND window, LPCWSTR text, LPCWSTR caption, UINT type)
+{
+	fprintf(stderr, "%ls: %ls\n", caption, text);
+
+	return 0;
+}
@@ -0,0 +1,444 @@
+#pragma once
+#include <Windows.h>
+
+// Stand-in for the part of the Direct3D 11 interface the portable parts of the engine use: the types that appear
+// in the RenderContext interface, and the device and resource calls the renderers make to create what they draw with.
+// The interfaces only declare what is called through them, tests implement them with fakes.
+
+enum DXGI_FORMAT
+{
+	DXGI_FORMAT_UNKNOWN = 0,
+	DXGI_FORMAT_R32G32B32A32_FLOAT = 2,
+	DXGI_FORMAT_R32G32B32_FLOAT = 6,
+	DXGI_FORMAT_R32G32_FLOAT = 16,
+	DXGI_FORMAT_R8G8B8A8_UNORM = 28,
+	DXGI_FORMAT_R32_UINT = 42,
+	DXGI_FORMAT_R16_UINT = 57,
+	DXGI_FORMAT_R8_UNORM = 61
+};
+
+struct DXGI_SAMPLE_DESC
+{
+	UINT Count;
+	UINT Quality;
+};
+
+enum D3D11_PRIMITIVE_TOPOLOGY
+{
+	D3D11_PRIMITIVE_TOPOLOGY_UNDEFINED = 0,
+	D3D11_PRIMITIVE_TOPOLOGY_POINTLIST = 1,
+	D3D11_PRIMITIVE_TOPOLOGY_LINELIST = 2,
+	D3D11_PRIMITIVE_TOPOLOGY_LINESTRIP = 3,
+	D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST = 4,
+	D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP = 5
+};
+
+enum D3D11_RESOURCE_DIMENSION
+{
+	D3D11_RESOURCE_DIMENSION_UNKNOWN = 0,
+	D3D11_RESOURCE_DIMENSION_BUFFER = 1,
+	D3D11_RESOURCE_DIMENSION_TEXTURE1D = 2,
+	D3D11_RESOURCE_DIMENSION_TEXTURE2D = 3,
+	D3D11_RESOURCE_DIMENSION_TEXTURE3D = 4
+};
+
+enum D3D11_USAGE
+{
+	D3D11_USAGE_DEFAULT = 0,
+	D3D11_USAGE_IMMUTABLE = 1,
+	D3D11_USAGE_DYNAMIC = 2,
+	D3D11_USAGE_STAGING = 3
+};
+
+enum D3D11_BIND_FLAG
+{
+	D3D11_BIND_VERTEX_BUFFER = 0x1,
+	D3D11_BIND_INDEX_BUFFER = 0x2,
+	D3D11_BIND_CONSTANT_BUFFER = 0x4,
+	D3D11_BIND_SHADER_RESOURCE = 0x8,
+	D3D11_BIND_UNORDERED_ACCESS = 0x80
+};
+
+enum D3D11_CPU_ACCESS_FLAG
+{
+	D3D11_CPU_ACCESS_WRITE = 0x10000,
+	D3D11_CPU_ACCESS_READ = 0x20000
+};
+
+enum D3D11_RESOURCE_MISC_FLAG
+{
+	D3D11_RESOURCE_MISC_BUFFER_STRUCTURED = 0x40
+};
+
+enum D3D11_MAP
+{
+	D3D11_MAP_READ = 1,
+	D3D11_MAP_WRITE = 2,
+	D3D11_MAP_READ_WRITE = 3,
+	D3D11_MAP_WRITE_DISCARD = 4,
+	D3D11_MAP_WRITE_NO_OVERWRITE = 5
+};
+
+enum D3D11_QUERY
+{
+	D3D11_QUERY_EVENT = 0,
+	D3D11_QUERY_OCCLUSION = 1,
+	D3D11_QUERY_TIMESTAMP = 2,
+	D3D11_QUERY_TIMESTAMP_DISJOINT = 3
+};
+
+enum D3D11_ASYNC_GETDATA_FLAG
+{
+	D3D11_ASYNC_GETDATA_DONOTFLUSH = 0x1
+};
+
+enum D3D11_FEATURE
+{
+	D3D11_FEATURE_THREADING = 0,
+	D3D11_FEATURE_D3D11_OPTIONS = 7
+};
+
+enum D3D11_CLEAR_FLAG
+{
+	D3D11_CLEAR_DEPTH = 0x1,
+	D3D11_CLEAR_STENCIL = 0x2
+};
+
+enum D3D11_INPUT_CLASSIFICATION
+{
+	D3D11_INPUT_PER_VERTEX_DATA = 0,
+	D3D11_INPUT_PER_INSTANCE_DATA = 1
+};
+
+#define D3D11_APPEND_ALIGNED_ELEMENT 0xffffffff
+
+enum D3D11_FILTER
+{
+	D3D11_FILTER_MIN_MAG_MIP_POINT = 0,
+	D3D11_FILTER_MIN_MAG_MIP_LINEAR = 0x15
+};
+
+enum D3D11_TEXTURE_ADDRESS_MODE
+{
+	D3D11_TEXTURE_ADDRESS_WRAP = 1,
+	D3D11_TEXTURE_ADDRESS_MIRROR = 2,
+	D3D11_TEXTURE_ADDRESS_CLAMP = 3
+};
+
+enum D3D11_COMPARISON_FUNC
+{
+	D3D11_COMPARISON_NEVER = 1,
+	D3D11_COMPARISON_LESS = 2,
+	D3D11_COMPARISON_EQUAL = 3,
+	D3D11_COMPARISON_LESS_EQUAL = 4,
+	D3D11_COMPARISON_GREATER = 5,
+	D3D11_COMPARISON_NOT_EQUAL = 6,
+	D3D11_COMPARISON_GREATER_EQUAL = 7,
+	D3D11_COMPARISON_ALWAYS = 8
+};
+
+#define D3D11_FLOAT32_MAX 3.402823466e+38f
+
+enum D3D11_DEPTH_WRITE_MASK
+{
+	D3D11_DEPTH_WRITE_MASK_ZERO = 0,
+	D3D11_DEPTH_WRITE_MASK_ALL = 1
+};
+
+enum D3D11_SRV_DIMENSION
+{
+	D3D11_SRV_DIMENSION_UNKNOWN = 0,
+	D3D11_SRV_DIMENSION_BUFFER = 1,
+	D3D11_SRV_DIMENSION_TEXTURE2D = 4
+};
+
+enum D3D11_UAV_DIMENSION
+{
+	D3D11_UAV_DIMENSION_UNKNOWN = 0,
+	D3D11_UAV_DIMENSION_BUFFER = 1
+};
+
+struct D3D11_VIEWPORT
+{
+	FLOAT TopLeftX;
+	FLOAT TopLeftY;
+	FLOAT Width;
+	FLOAT Height;
+	FLOAT MinDepth;
+	FLOAT MaxDepth;
+};
+
+struct D3D11_BOX
+{
+	UINT left;
+	UINT top;
+	UINT front;
+	UINT right;
+	UINT bottom;
+	UINT back;
+};
+
+struct D3D11_MAPPED_SUBRESOURCE
+{
+	void* pData;
+	UINT RowPitch;
+	UINT DepthPitch;
+};
+
+struct D3D11_SUBRESOURCE_DATA
+{
+	const void* pSysMem;
+	UINT SysMemPitch;
+	UINT SysMemSlicePitch;
+};
+
+struct D3D11_BUFFER_DESC
+{
+	UINT ByteWidth;
+	D3D11_USAGE Usage;
+	UINT BindFlags;
+	UINT CPUAccessFlags;
+	UINT MiscFlags;
+	UINT StructureByteStride;
+};
+
+struct D3D11_TEXTURE2D_DESC
+{
+	UINT Width;
+	UINT Height;
+	UINT MipLevels;
+	UINT ArraySize;
+	DXGI_FORMAT Format;
+	DXGI_SAMPLE_DESC SampleDesc;
+	D3D11_USAGE Usage;
+	UINT BindFlags;
+	UINT CPUAccessFlags;
+	UINT MiscFlags;
+};
+
+struct D3D11_INPUT_ELEMENT_DESC
+{
+	LPCSTR SemanticName;
+	UINT SemanticIndex;
+	DXGI_FORMAT Format;
+	UINT InputSlot;
+	UINT AlignedByteOffset;
+	D3D11_INPUT_CLASSIFICATION InputSlotClass;
+	UINT InstanceDataStepRate;
+};
+
+struct D3D11_SAMPLER_DESC
+{
+	D3D11_FILTER Filter;
+	D3D11_TEXTURE_ADDRESS_MODE AddressU;
+	D3D11_TEXTURE_ADDRESS_MODE AddressV;
+	D3D11_TEXTURE_ADDRESS_MODE AddressW;
+	FLOAT MipLODBias;
+	UINT MaxAnisotropy;
+	D3D11_COMPARISON_FUNC ComparisonFunc;
+	FLOAT BorderColor[4];
+	FLOAT MinLOD;
+	FLOAT MaxLOD;
+};
+
+struct D3D11_DEPTH_STENCIL_DESC
+{
+	BOOL DepthEnable;
+	D3D11_DEPTH_WRITE_MASK DepthWriteMask;
+	D3D11_COMPARISON_FUNC DepthFunc;
+	BOOL StencilEnable;
+};
+
+struct D3D11_BUFFER_SRV
+{
+	UINT FirstElement;
+	UINT NumElements;
+};
+
+struct D3D11_TEX2D_SRV
+{
+	UINT MostDetailedMip;
+	UINT MipLevels;
+};
+
+struct D3D11_SHADER_RESOURCE_VIEW_DESC
+{
+	DXGI_FORMAT Format;
+	D3D11_SRV_DIMENSION ViewDimension;
+	union
+	{
+		D3D11_BUFFER_SRV Buffer;
+		D3D11_TEX2D_SRV Texture2D;
+	};
+};
+
+struct D3D11_BUFFER_UAV
+{
+	UINT FirstElement;
+	UINT NumElements;
+	UINT Flags;
+};
+
+struct D3D11_UNORDERED_ACCESS_VIEW_DESC
+{
+	DXGI_FORMAT Format;
+	D3D11_UAV_DIMENSION ViewDimension;
+	union
+	{
+		D3D11_BUFFER_UAV Buffer;
+	};
+};
+
+struct D3D11_QUERY_DESC
+{
+	D3D11_QUERY Query;
+	UINT MiscFlags;
+};
+
+struct D3D11_QUERY_DATA_TIMESTAMP_DISJOINT
+{
+	UINT64 Frequency;
+	BOOL Disjoint;
+};
+
+struct D3D11_FEATURE_DATA_THREADING
+{
+	BOOL DriverConcurrentCreates;
+	BOOL DriverCommandLists;
+};
+
+struct D3D11_FEATURE_DATA_D3D11_OPTIONS
+{
+	BOOL OutputMergerLogicOp;
+	BOOL UAVOnlyRenderingForcedSampleCount;
+	BOOL DiscardAPIsSeenByDriver;
+	BOOL FlagsForUpdateAndCopySeenByDriver;
+	BOOL ClearView;
+	BOOL CopyWithOverlap;
+	BOOL ConstantBufferPartialUpdate;
+	BOOL ConstantBufferOffsetting;
+	BOOL MapNoOverwriteOnDynamicConstantBuffer;
+	BOOL MapNoOverwriteOnDynamicBufferSRV;
+	BOOL MultisampleRTVWithForcedSampleCountOne;
+	BOOL SAD4ShaderInstructions;
+	BOOL ExtendedDoublesShaderInstructions;
+	BOOL ExtendedResourceSharing;
+};
+
+struct IUnknown
+{
+	virtual ULONG AddRef() = 0;
+	virtual ULONG Release() = 0;
+};
+
+struct ID3D11DeviceChild : IUnknown
+{
+};
+
+struct ID3D11Resource : ID3D11DeviceChild
+{
+	virtual void GetType(D3D11_RESOURCE_DIMENSION* resourceDimension) = 0;
+};
+
+struct ID3D11Buffer : ID3D11Resource
+{
+	virtual void GetDesc(D3D11_BUFFER_DESC* desc) = 0;
+};
+
+struct ID3D11Texture2D : ID3D11Resource
+{
+	virtual void GetDesc(D3D11_TEXTURE2D_DESC* desc) = 0;
+};
+
+struct ID3D11View : ID3D11DeviceChild
+{
+};
+
+struct ID3D11ShaderResourceView : ID3D11View
+{
+};
+
+struct ID3D11RenderTargetView : ID3D11View
+{
+};
+
+struct ID3D11DepthStencilView : ID3D11View
+{
+};
+
+struct ID3D11UnorderedAccessView : ID3D11View
+{
+};
+
+struct ID3D11InputLayout : ID3D11DeviceChild
+{
+};
+
+struct ID3D11VertexShader : ID3D11DeviceChild
+{
+};
+
+struct ID3D11PixelShader : ID3D11DeviceChild
+{
+};
+
+struct ID3D11ComputeShader : ID3D11DeviceChild
+{
+};
+
+struct ID3D11ClassInstance : ID3D11DeviceChild
+{
+};
+
+struct ID3D11ClassLinkage : ID3D11DeviceChild
+{
+};
+
+struct ID3D11SamplerState : ID3D11DeviceChild
+{
+};
+
+struct ID3D11BlendState : ID3D11DeviceChild
+{
+};
+
+struct ID3D11DepthStencilState : ID3D11DeviceChild
+{
+};
+
+struct ID3D11RasterizerState : ID3D11DeviceChild
+{
+};
+
+struct ID3D11Asynchronous : ID3D11DeviceChild
+{
+};
+
+struct ID3D11Query : ID3D11Asynchronous
+{
+};
+
+struct ID3D11CommandList : ID3D11DeviceChild
+{
+};
+
+struct ID3D11Device : IUnknown
+{
+	virtual HRESULT CreateBuffer(const D3D11_BUFFER_DESC* desc, const D3D11_SUBRESOURCE_DATA* initialData, ID3D11Buffer** buffer) = 0;
+	virtual HRESULT CreateShaderResourceView(ID3D11Resource* resource, const D3D11_SHADER_RESOURCE_VIEW_DESC* desc,
+		ID3D11ShaderResourceView** shaderResourceView) = 0;
+	virtual HRESULT CreateUnorderedAccessView(ID3D11Resource* resource, const D3D11_UNORDERED_ACCESS_VIEW_DESC* desc,
+		ID3D11UnorderedAccessView** unorderedAccessView) = 0;
+	virtual HRESULT CreateInputLayout(const D3D11_INPUT_ELEMENT_DESC* inputElementDescs, UINT numElements, const void* shaderBytecode,
+		SIZE_T bytecodeLength, ID3D11InputLayout** inputLayout) = 0;
+	virtual HRESULT CreateVertexShader(const void* shaderBytecode, SIZE_T bytecodeLength, ID3D11ClassLinkage* classLinkage,
+		ID3D11VertexShader** vertexShader) = 0;
+	virtual HRESULT CreatePixelShader(const void* shaderBytecode, SIZE_T bytecodeLength, ID3D11ClassLinkage* classLinkage,
+		ID3D11PixelShader** pixelShader) = 0;
+	virtual HRESULT CreateComputeShader(const void* shaderBytecode, SIZE_T bytecodeLength, ID3D11ClassLinkage* classLinkage,
+		ID3D11ComputeShader** computeShader) = 0;
+	virtual HRESULT CreateSamplerState(const D3D11_SAMPLER_DESC* samplerDesc, ID3D11SamplerState** samplerState) = 0;
+	virtual HRESULT CreateDepthStencilState(const D3D11_DEPTH_STENCIL_DESC* depthStencilDesc, ID3D11DepthStencilState** depthStencilState) = 0;
+	virtual HRESULT CreateQuery(const D3D11_QUERY_DESC* queryDesc, ID3D11Query** query) = 0;
+	virtual HRESULT CheckFeatureSupport(D3D11_FEATURE feature, void* featureSupportData, UINT featureSupportDataSize) = 0;
+};
@@ -0,0 +1,80 @@
+#pragma once
+#include <d3d11.h>
+
+// Stand-in for the shader compiler. Nothing is compiled outside of Windows, D3DCompileFromFile hands back an empty
+// blob without opening the file, which is all the fake devices need to create a shader from.
+
+struct ID3D10Blob : IUnknown
+{
+	virtual void* GetBufferPointer() = 0;
+	virtual SIZE_T GetBufferSize() = 0;
+};
+
+typedef ID3D10Blob ID3DBlob;
+
+struct ID3DInclude;
+
+struct D3D_SHADER_MACRO
+{
+	LPCSTR Name;
+	LPCSTR Definition;
+};
+
+#define D3D_COMPILE_STANDARD_FILE_INCLUDE ((ID3DInclude*)(UINT_PTR)1)
+#define D3D10_SHADER_ENABLE_STRICTNESS (1 << 11)
+
+// Unlike the fake device objects a blob is freed by its last Release, the engine never hands it to anyone.
+class StandInBlob : public ID3D10Blob
+{
+private:
+	ULONG m_references;
+public:
+	StandInBlob()
+	{
+		m_references = 1;
+	}
+
+	virtual ~StandInBlob()
+	{
+	}
+
+	ULONG AddRef() override
+	{
+		return ++m_references;
+	}
+
+	ULONG Release() override
+	{
+		ULONG references;
+
+		references = --m_references;
+		if (references == 0)
+		{
+			delete this;
+		}
+
+		return references;
+	}
+
+	void* GetBufferPointer() override
+	{
+		return 0;
+	}
+
+	SIZE_T GetBufferSize() override
+	{
+		return 0;
+	}
+};
+
+inline HRESULT D3DCompileFromFile(LPCWSTR fileName, const D3D_SHADER_MACRO* defines, ID3DInclude* include, LPCSTR entrypoint,
+	LPCSTR target, UINT flags1, UINT flags2, ID3DBlob** code, ID3DBlob** errorMessages)
+{
+	*code = new StandInBlob;
+	if (errorMessages)
+	{
+		*errorMessages = 0;
+	}
+
+	return S_OK;
+}
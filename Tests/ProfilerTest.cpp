@@ -0,0 +1,208 @@
+#include <stdio.h>
+#include <atomic>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include "Test.h"
+#include "Profiler.h"
+
+namespace
+{
+	const char* const OUTER_ZONE = "Outer";
+	const char* const INNER_ZONE = "Inner";
+	const char* const WORKER_ZONE = "Worker";
+
+	// Calls of a zone in the summary of the last frame, 0 when it is not in there.
+	int GetCalls(const char* name)
+	{
+		ProfileSummary summary[PROFILER_MAX_SUMMARY];
+		int count, i;
+
+		count = Profiler::GetSummary(summary, PROFILER_MAX_SUMMARY);
+		for (i = 0; i < count; i++)
+		{
+			if (summary[i].name == name)
+			{
+				return summary[i].calls;
+			}
+		}
+
+		return 0;
+	}
+
+	// A frame only sums up the zones that ended during it, nested zones keep their depth.
+	void TestSummary()
+	{
+		ProfileSummary summary[PROFILER_MAX_SUMMARY];
+		int count, i;
+
+		Profiler::SetEnabled(true);
+
+		{
+			ProfileZone outer(OUTER_ZONE);
+			for (i = 0; i < 3; i++)
+			{
+				ProfileZone inner(INNER_ZONE);
+			}
+		}
+
+		Profiler::EndFrame();
+		CHECK(GetCalls(OUTER_ZONE) == 1);
+		CHECK(GetCalls(INNER_ZONE) == 3);
+
+		count = Profiler::GetSummary(summary, PROFILER_MAX_SUMMARY);
+		CHECK(count == 2);
+		for (i = 0; i < count; i++)
+		{
+			CHECK(summary[i].depth == (summary[i].name == INNER_ZONE ? 1 : 0));
+		}
+
+		Profiler::EndFrame();
+		CHECK(Profiler::GetSummary(summary, PROFILER_MAX_SUMMARY) == 0);
+
+		// Disabled zones are not recorded at all.
+		Profiler::SetEnabled(false);
+		{
+			ProfileZone outer(OUTER_ZONE);
+		}
+		Profiler::SetEnabled(true);
+		Profiler::EndFrame();
+		CHECK(GetCalls(OUTER_ZONE) == 0);
+
+		Profiler::Shutdown();
+	}
+
+	// Records nested zones until it is told to stop, wrapping its ring many times.
+	void RecordUntilStopped(std::atomic<bool>* stop)
+	{
+		int i;
+
+		while (!stop->load())
+		{
+			ProfileZone outer(OUTER_ZONE);
+			for (i = 0; i < 4; i++)
+			{
+				ProfileZone inner(INNER_ZONE);
+			}
+		}
+	}
+
+	// The summary and the trace are read while another thread keeps recording, zones it overwrites meanwhile
+	// are left out instead of being read half written.
+	void TestReadWhileRecording()
+	{
+		ProfileSummary summary[PROFILER_MAX_SUMMARY];
+		std::atomic<bool> stop;
+		std::thread thread;
+		std::ifstream fin;
+		std::stringstream trace;
+		int frame, count, i;
+
+		stop.store(false);
+		Profiler::SetEnabled(true);
+
+		thread = std::thread(RecordUntilStopped, &stop);
+
+		for (frame = 0; frame < 20; frame++)
+		{
+			std::this_thread::yield();
+			Profiler::EndFrame();
+
+			count = Profiler::GetSummary(summary, PROFILER_MAX_SUMMARY);
+			CHECK(count <= 2);
+			for (i = 0; i < count; i++)
+			{
+				CHECK(summary[i].name == OUTER_ZONE || summary[i].name == INNER_ZONE);
+				CHECK(summary[i].depth == (summary[i].name == INNER_ZONE ? 1 : 0));
+				CHECK(summary[i].time >= 0.0f);
+				CHECK(summary[i].calls <= PROFILER_RING_SIZE);
+			}
+
+			if (frame % 5 == 0)
+			{
+				CHECK(Profiler::WriteChromeTrace("ProfilerTest.json"));
+			}
+		}
+
+		stop.store(true);
+		thread.join();
+
+		// Every zone in the trace is one of the two and none of them ends before it started.
+		fin.open("ProfilerTest.json");
+		CHECK(!fin.fail());
+		trace << fin.rdbuf();
+		fin.close();
+		remove("ProfilerTest.json");
+
+		CHECK(trace.str().find("\"name\":\"Outer\"") != std::string::npos);
+		CHECK(trace.str().find("\"dur\":-") == std::string::npos);
+
+		Profiler::Shutdown();
+	}
+
+	struct RestartThread
+	{
+		std::atomic<int> step;
+	};
+
+	// Records a zone, then waits for the main thread to shut the profiler down and records again.
+	void RecordAcrossRestart(RestartThread* restart)
+	{
+		int round;
+
+		for (round = 0; round < 3; round++)
+		{
+			{
+				ProfileZone zone(WORKER_ZONE);
+			}
+			restart->step.store(round * 2 + 1);
+
+			while (restart->step.load() != round * 2 + 2)
+			{
+				std::this_thread::yield();
+			}
+		}
+	}
+
+	// A thread that recorded before a Shutdown gets a new ring instead of writing into the freed one.
+	void TestRestart()
+	{
+		RestartThread restart;
+		std::thread thread;
+		int round;
+
+		restart.step.store(0);
+		Profiler::SetEnabled(true);
+
+		thread = std::thread(RecordAcrossRestart, &restart);
+
+		for (round = 0; round < 3; round++)
+		{
+			while (restart.step.load() != round * 2 + 1)
+			{
+				std::this_thread::yield();
+			}
+
+			Profiler::EndFrame();
+			CHECK(GetCalls(WORKER_ZONE) == 1);
+
+			Profiler::Shutdown();
+			Profiler::SetEnabled(true);
+			restart.step.store(round * 2 + 2);
+		}
+
+		thread.join();
+
+		Profiler::Shutdown();
+	}
+}
+
+int main()
+{
+	TestSummary();
+	TestReadWhileRecording();
+	TestRestart();
+
+	return TestResult("ProfilerTest");
+}
@@ -0,0 +1,249 @@
+#include <algorithm>
+#include <vector>
+#include "Test.h"
+#include "InstanceBatcher.h"
+#include "RenderQueue.h"
+
+namespace
+{
+	const float SCREEN_DEPTH = 1000.0f;
+
+	unsigned int s_seed = 777;
+
+	unsigned int RandomInt(unsigned int count)
+	{
+		s_seed = s_seed * 1664525u + 1013904223u;
+		return (s_seed >> 8) % count;
+	}
+
+	// Meshes and textures are only compared by their address, any distinct pointers do.
+	const MeshBuffers* Mesh(int index)
+	{
+		static MeshBuffers meshes[16];
+		return &meshes[index];
+	}
+
+	ID3D11ShaderResourceView* Texture(int index)
+	{
+		static char textures[16];
+		return (ID3D11ShaderResourceView*)&textures[index];
+	}
+
+	DrawCall Draw(int mesh, int texture, float depth, int id)
+	{
+		DrawCall draw;
+
+		memset(&draw, 0, sizeof(draw));
+		draw.mesh = Mesh(mesh);
+		draw.texture = Texture(texture);
+		draw.indexCount = 36;
+		draw.key = RenderQueue::MakeKey(0, 0, mesh, texture, depth);
+		// The color carries an id so the test can find the draw again.
+		draw.color = XMFLOAT4((float)id, depth, 0.0f, 0.0f);
+
+		return draw;
+	}
+
+	void TestViewDepth()
+	{
+		XMMATRIX viewMatrix;
+
+		viewMatrix = XMMatrixLookAtLH(XMVectorSet(0.0f, 0.0f, -10.0f, 1.0f), XMVectorSet(0.0f, 0.0f, 0.0f, 1.0f),
+			XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+
+		CHECK_NEAR(RenderQueue::ComputeViewDepth(XMVectorSet(0.0f, 0.0f, 0.0f, 1.0f), viewMatrix, SCREEN_DEPTH), 10.0f / SCREEN_DEPTH, 1e-6f);
+		CHECK_NEAR(RenderQueue::ComputeViewDepth(XMVectorSet(5.0f, 3.0f, 90.0f, 1.0f), viewMatrix, SCREEN_DEPTH), 100.0f / SCREEN_DEPTH, 1e-6f);
+		CHECK(RenderQueue::ComputeViewDepth(XMVectorSet(0.0f, 0.0f, -20.0f, 1.0f), viewMatrix, SCREEN_DEPTH) < 0.0f);
+	}
+
+	void TestKeyDepth()
+	{
+		unsigned long long key;
+
+		// Depth is in the lowest bits and clamped to [0, 1].
+		CHECK(RenderQueue::GetKeyDepth(RenderQueue::MakeKey(3, 2, 1, 7, 0.0f)) == 0);
+		CHECK(RenderQueue::GetKeyDepth(RenderQueue::MakeKey(3, 2, 1, 7, 1.0f)) == (1u << RENDER_KEY_DEPTH_BITS) - 1);
+		CHECK(RenderQueue::GetKeyDepth(RenderQueue::MakeKey(3, 2, 1, 7, -5.0f)) == 0);
+		CHECK(RenderQueue::GetKeyDepth(RenderQueue::MakeKey(3, 2, 1, 7, 5.0f)) == (1u << RENDER_KEY_DEPTH_BITS) - 1);
+		CHECK(RenderQueue::GetKeyDepth(RenderQueue::MakeKey(3, 2, 1, 7, nanf(""))) == 0);
+		CHECK(RenderQueue::MakeKey(3, 2, 1, 7, nanf("")) == RenderQueue::MakeKey(3, 2, 1, 7, 0.0f));
+		CHECK(RenderQueue::GetKeyDepth(RenderQueue::MakeKey(0, 0, 0, 0, 0.25f)) < RenderQueue::GetKeyDepth(RenderQueue::MakeKey(0, 0, 0, 0, 0.2501f)));
+
+		// State bits always win over depth.
+		CHECK(RenderQueue::MakeKey(0, 0, 0, 1, 0.9f) > RenderQueue::MakeKey(0, 0, 0, 0, 0.1f));
+		CHECK(RenderQueue::MakeKey(0, 0, 1, 0, 0.0f) > RenderQueue::MakeKey(0, 0, 0, 65535, 1.0f));
+		CHECK(RenderQueue::MakeKey(1, 0, 0, 0, 0.0f) > RenderQueue::MakeKey(0, 255, 4095, 65535, 1.0f));
+
+		// Ids beyond their field do not spill into the next one.
+		key = RenderQueue::MakeKey(0, 0, 1 << RENDER_KEY_MESH_BITS, 0, 0.0f);
+		CHECK(key == RenderQueue::MakeKey(0, 0, 0, 0, 0.0f));
+	}
+
+	// Draws end up grouped by state and front to back within a state, equal keys keep the order they were added in.
+	void TestQueueSort()
+	{
+		RenderQueue queue;
+		std::vector<DrawCall> draws;
+		int i;
+
+		CHECK(queue.Initialize(300));
+
+		for (i = 0; i < 300; i++)
+		{
+			draws.push_back(Draw(RandomInt(3), RandomInt(2), (float)RandomInt(50) / 50.0f, i));
+			CHECK(queue.Add(draws.back()));
+		}
+		CHECK(!queue.Add(draws[0]));
+
+		queue.Sort();
+
+		CHECK(queue.GetDrawCount() == 300);
+		for (i = 1; i < queue.GetDrawCount(); i++)
+		{
+			const DrawCall& previous = queue.GetDraw(i - 1);
+			const DrawCall& draw = queue.GetDraw(i);
+
+			CHECK(previous.key <= draw.key);
+			if (previous.key == draw.key)
+			{
+				CHECK(previous.color.x < draw.color.x);
+			}
+		}
+
+		queue.Shutdown();
+	}
+
+	// Batches are the runs of one state, each one starting at its nearest draw, and the depth order puts the
+	// batches front to back by that draw without moving them.
+	void TestBatchDepthOrder()
+	{
+		RenderQueue queue;
+		InstanceBatcher batcher;
+		std::vector<unsigned int> depths;
+		int i, mesh, texture, instances;
+
+		CHECK(queue.Initialize(64));
+		CHECK(batcher.Initialize(64));
+
+		// Mesh 0 is far away, mesh 1 is near, mesh 2 is in between and texture 1 of it is nearest of all.
+		queue.Add(Draw(0, 0, 0.9f, 0));
+		queue.Add(Draw(1, 0, 0.3f, 1));
+		queue.Add(Draw(0, 0, 0.8f, 2));
+		queue.Add(Draw(2, 0, 0.5f, 3));
+		queue.Add(Draw(1, 0, 0.2f, 4));
+		queue.Add(Draw(2, 1, 0.05f, 5));
+		queue.Add(Draw(2, 0, 0.6f, 6));
+		queue.Sort();
+
+		batcher.Build(&queue);
+		batcher.SortByDepth();
+
+		CHECK(batcher.GetBatchCount() == 4);
+		CHECK(batcher.GetInstanceCount() == 7);
+
+		// In state order the batches are mesh 0, mesh 1, mesh 2 texture 0 and mesh 2 texture 1.
+		instances = 0;
+		for (i = 0; i < batcher.GetBatchCount(); i++)
+		{
+			const InstanceBatch& batch = batcher.GetBatch(i);
+
+			CHECK(batch.firstInstance == instances);
+			CHECK(batch.depth == RenderQueue::GetKeyDepth(queue.GetDraw(batch.firstDraw).key));
+			instances += batch.instanceCount;
+		}
+
+		CHECK(batcher.GetBatch(0).instanceCount == 2);
+		CHECK(batcher.GetBatch(1).instanceCount == 2);
+		CHECK(batcher.GetBatch(2).instanceCount == 2);
+		CHECK(batcher.GetBatch(3).instanceCount == 1);
+
+		// The instances of a batch are front to back, so its first one is the nearest.
+		CHECK(batcher.GetInstances()[0].color.x == 2.0f);
+		CHECK(batcher.GetInstances()[2].color.x == 4.0f);
+
+		// Front to back: mesh 2 texture 1, mesh 1, mesh 2 texture 0, mesh 0.
+		CHECK(batcher.GetDepthOrderedBatch(0) == 3);
+		CHECK(batcher.GetDepthOrderedBatch(1) == 1);
+		CHECK(batcher.GetDepthOrderedBatch(2) == 2);
+		CHECK(batcher.GetDepthOrderedBatch(3) == 0);
+
+		// Many batches with random depths come out in the same order as a stable sort of their depths.
+		queue.Clear();
+		for (i = 0; i < 64; i++)
+		{
+			mesh = i % 8;
+			texture = i / 8;
+			queue.Add(Draw(mesh, texture, (float)RandomInt(1000) / 1000.0f, i));
+		}
+		queue.Sort();
+		batcher.Build(&queue);
+		batcher.SortByDepth();
+
+		CHECK(batcher.GetBatchCount() == 64);
+		for (i = 0; i < batcher.GetBatchCount(); i++)
+		{
+			depths.push_back(batcher.GetBatch(i).depth);
+		}
+		std::stable_sort(depths.begin(), depths.end());
+
+		for (i = 0; i < batcher.GetBatchCount(); i++)
+		{
+			CHECK(batcher.GetBatch(batcher.GetDepthOrderedBatch(i)).depth == depths[i]);
+			if (i > 0 && batcher.GetBatch(batcher.GetDepthOrderedBatch(i)).depth == batcher.GetBatch(batcher.GetDepthOrderedBatch(i - 1)).depth)
+			{
+				CHECK(batcher.GetDepthOrderedBatch(i) > batcher.GetDepthOrderedBatch(i - 1));
+			}
+		}
+
+		batcher.Shutdown();
+		queue.Shutdown();
+	}
+
+	// A batcher sized to the queue takes every draw of it, a smaller one counts the draws it leaves out.
+	void TestBatchDropped()
+	{
+		RenderQueue queue;
+		InstanceBatcher batcher, small;
+		int i;
+
+		CHECK(queue.Initialize(40));
+		CHECK(queue.GetMaxDraws() == 40);
+		CHECK(batcher.Initialize(queue.GetMaxDraws()));
+		CHECK(small.Initialize(30));
+
+		for (i = 0; i < 40; i++)
+		{
+			queue.Add(Draw(i % 2, 0, (float)i / 40.0f, i));
+		}
+		queue.Sort();
+
+		batcher.Build(&queue);
+		CHECK(batcher.GetInstanceCount() == 40);
+		CHECK(batcher.GetDroppedCount() == 0);
+
+		small.Build(&queue);
+		CHECK(small.GetInstanceCount() == 30);
+		CHECK(small.GetDroppedCount() == 10);
+
+		// The count belongs to the last Build.
+		queue.Clear();
+		queue.Add(Draw(0, 0, 0.5f, 0));
+		small.Build(&queue);
+		CHECK(small.GetDroppedCount() == 0);
+
+		small.Shutdown();
+		batcher.Shutdown();
+		queue.Shutdown();
+	}
+}
+
+int main()
+{
+	TestViewDepth();
+	TestKeyDepth();
+	TestQueueSort();
+	TestBatchDepthOrder();
+	TestBatchDropped();
+
+	return TestResult("RenderQueueTest");
+}
@@ -0,0 +1,165 @@
+#include <vector>
+#include "Test.h"
+#include "SpriteList.h"
+
+namespace
+{
+	const int SCREEN_WIDTH = 800;
+	const int SCREEN_HEIGHT = 600;
+
+	unsigned int s_seed = 31;
+
+	int RandomInt(int count)
+	{
+		s_seed = s_seed * 1664525u + 1013904223u;
+		return (int)((s_seed >> 8) % (unsigned int)count);
+	}
+
+	// Textures are only compared by their address, any distinct pointers do.
+	ID3D11ShaderResourceView* Texture(int index)
+	{
+		static char textures[8];
+		return (ID3D11ShaderResourceView*)&textures[index];
+	}
+
+	SpriteRect Rect(float x, float y, float width, float height)
+	{
+		SpriteRect rect;
+
+		rect.x = x;
+		rect.y = y;
+		rect.width = width;
+		rect.height = height;
+
+		return rect;
+	}
+
+	// Pixels from the top left corner become the centered, y up space of the text.
+	void TestQuad()
+	{
+		SpriteList sprites;
+		TextVertex vertices[TEXT_QUAD_VERTICES];
+		int i;
+
+		sprites.Initialize(4);
+		CHECK(sprites.Add(Texture(0), Rect(10.0f, 20.0f, 30.0f, 40.0f), Rect(0.25f, 0.5f, 0.25f, 0.5f), 0x12345678));
+
+		CHECK(sprites.Build(SCREEN_WIDTH, SCREEN_HEIGHT, vertices) == 1);
+
+		CHECK(vertices[0].x == -390.0f && vertices[0].y == 280.0f);
+		CHECK(vertices[1].x == -360.0f && vertices[1].y == 280.0f);
+		CHECK(vertices[2].x == -390.0f && vertices[2].y == 240.0f);
+		CHECK(vertices[3].x == -360.0f && vertices[3].y == 240.0f);
+
+		CHECK(vertices[0].u == 0.25f && vertices[0].v == 0.5f);
+		CHECK(vertices[1].u == 0.5f && vertices[1].v == 0.5f);
+		CHECK(vertices[2].u == 0.25f && vertices[2].v == 1.0f);
+		CHECK(vertices[3].u == 0.5f && vertices[3].v == 1.0f);
+
+		for (i = 0; i < TEXT_QUAD_VERTICES; i++)
+		{
+			CHECK(vertices[i].z == 0.0f);
+			CHECK(vertices[i].color == 0x12345678);
+		}
+	}
+
+	// Sprites end up with one run per texture, in the order they were added within a run.
+	void TestSort()
+	{
+		SpriteList sprites;
+		std::vector<TextVertex> vertices;
+		std::vector<bool> seen;
+		int i, run, quadCount, quad;
+
+		sprites.Initialize(500);
+		vertices.resize(500 * TEXT_QUAD_VERTICES);
+
+		// The color carries the order the sprite was added in.
+		for (i = 0; i < 500; i++)
+		{
+			CHECK(sprites.Add(Texture(RandomInt(5)), Rect((float)i, 0.0f, 1.0f, 1.0f), Rect(0.0f, 0.0f, 1.0f, 1.0f), (unsigned int)i));
+		}
+
+		CHECK(sprites.Build(SCREEN_WIDTH, SCREEN_HEIGHT, vertices.data()) == 500);
+		CHECK(sprites.GetRunCount() == 5);
+
+		quadCount = 0;
+		seen.assign(5, false);
+		for (run = 0; run < sprites.GetRunCount(); run++)
+		{
+			const SpriteRun& spriteRun = sprites.GetRun(run);
+
+			CHECK(spriteRun.firstQuad == quadCount);
+			CHECK(spriteRun.quadCount > 0);
+			quadCount += spriteRun.quadCount;
+
+			for (i = 0; i < 5; i++)
+			{
+				if (spriteRun.texture == Texture(i))
+				{
+					CHECK(!seen[i]);
+					seen[i] = true;
+				}
+			}
+
+			for (quad = spriteRun.firstQuad + 1; quad < spriteRun.firstQuad + spriteRun.quadCount; quad++)
+			{
+				CHECK(vertices[(quad - 1) * TEXT_QUAD_VERTICES].color < vertices[quad * TEXT_QUAD_VERTICES].color);
+			}
+		}
+
+		CHECK(quadCount == 500);
+		CHECK(seen[0] && seen[1] && seen[2] && seen[3] && seen[4]);
+
+		// A list of one texture is one run however often it is built.
+		sprites.Clear();
+		CHECK(sprites.Build(SCREEN_WIDTH, SCREEN_HEIGHT, vertices.data()) == 0);
+		CHECK(sprites.GetRunCount() == 0);
+
+		for (i = 0; i < 10; i++)
+		{
+			sprites.Add(Texture(3), Rect(0.0f, 0.0f, 1.0f, 1.0f), Rect(0.0f, 0.0f, 1.0f, 1.0f), 0);
+		}
+
+		for (i = 0; i < 2; i++)
+		{
+			CHECK(sprites.Build(SCREEN_WIDTH, SCREEN_HEIGHT, vertices.data()) == 10);
+			CHECK(sprites.GetRunCount() == 1);
+			CHECK(sprites.GetRun(0).texture == Texture(3) && sprites.GetRun(0).quadCount == 10);
+		}
+	}
+
+	// Sprites past the maximum are dropped and counted until the next Clear.
+	void TestDropped()
+	{
+		SpriteList sprites;
+		TextVertex vertices[4 * TEXT_QUAD_VERTICES];
+		int i;
+
+		sprites.Initialize(4);
+
+		for (i = 0; i < 6; i++)
+		{
+			CHECK(sprites.Add(Texture(i % 2), Rect(0.0f, 0.0f, 1.0f, 1.0f), Rect(0.0f, 0.0f, 1.0f, 1.0f), 0) == (i < 4));
+		}
+
+		CHECK(sprites.GetSpriteCount() == 4);
+		CHECK(sprites.GetDroppedCount() == 2);
+		CHECK(sprites.Build(SCREEN_WIDTH, SCREEN_HEIGHT, vertices) == 4);
+		CHECK(sprites.GetRunCount() == 2);
+
+		sprites.Clear();
+		CHECK(sprites.GetSpriteCount() == 0);
+		CHECK(sprites.GetDroppedCount() == 0);
+		CHECK(sprites.GetRunCount() == 0);
+	}
+}
+
+int main()
+{
+	TestQuad();
+	TestSort();
+	TestDropped();
+
+	return TestResult("SpriteListTest");
+}
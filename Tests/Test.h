@@ -0,0 +1,47 @@
+#pragma once
+#include <math.h>
+#include <stdio.h>
+
+// Checks for the test executables. A failed check prints where it failed and the test goes on, main returns the
+// number of failed checks so ctest sees the failure.
+
+inline int& TestFailures()
+{
+	static int failures = 0;
+	return failures;
+}
+
+#define CHECK(condition) \
+	do \
+	{ \
+		if (!(condition)) \
+		{ \
+			printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+			TestFailures()++; \
+		} \
+	} while (0)
+
+#define CHECK_NEAR(a, b, tolerance) \
+	do \
+	{ \
+		double checkA = (double)(a), checkB = (double)(b); \
+		if (!(fabs(checkA - checkB) <= (double)(tolerance))) \
+		{ \
+			printf("%s:%d: CHECK_NEAR(%s, %s) failed, %g and %g differ by more than %g\n", __FILE__, __LINE__, #a, #b, \
+				checkA, checkB, (double)(tolerance)); \
+			TestFailures()++; \
+		} \
+	} while (0)
+
+// Prints the result of the executable and returns what main should return.
+inline int TestResult(const char* name)
+{
+	if (TestFailures() > 0)
+	{
+		printf("%s: %d checks failed\n", name, TestFailures());
+		return 1;
+	}
+
+	printf("%s: passed\n", name);
+	return 0;
+}
@@ -0,0 +1,259 @@
+#include <string.h>
+#include "Test.h"
+#include "TextLayout.h"
+
+namespace
+{
+	// Every glyph is 8 by 12 pixels with the same metrics, the loader knows the capitals, the question mark, the
+	// space and e with acute. A and V kern by -2.
+	class TestGlyphLoader : public GlyphLoader
+	{
+	public:
+		bool hasQuestionMark;
+
+		TestGlyphLoader()
+		{
+			hasQuestionMark = true;
+		}
+
+		bool LoadGlyph(unsigned int codepoint, GlyphBitmap& glyph) override
+		{
+			if (!(codepoint >= 'A' && codepoint <= 'Z') && !(codepoint == '?' && hasQuestionMark) && codepoint != ' ' &&
+				codepoint != 0xe9)
+			{
+				return false;
+			}
+
+			memset(&glyph.metrics, 0, sizeof(glyph.metrics));
+			glyph.metrics.offsetX = 1.0f;
+			glyph.metrics.offsetY = 10.0f;
+			glyph.metrics.advance = 10.0f;
+
+			if (codepoint == ' ')
+			{
+				glyph.width = 0;
+				glyph.height = 0;
+				glyph.pixels.clear();
+				return true;
+			}
+
+			glyph.metrics.width = 8.0f;
+			glyph.metrics.height = 12.0f;
+			glyph.width = 8;
+			glyph.height = 12;
+			glyph.pixels.assign(8 * 12, (unsigned char)codepoint);
+
+			return true;
+		}
+
+		float GetKerning(unsigned int first, unsigned int second) override
+		{
+			return first == 'A' && second == 'V' ? -2.0f : 0.0f;
+		}
+	};
+
+	// The metrics are at 20 pixels per em, the tests lay out at 40 so every metric doubles.
+	void InitializeFont(GlyphCache& font, GlyphLoader* loader)
+	{
+		FontTableHeader header;
+
+		memset(&header, 0, sizeof(header));
+		header.pixelSize = 20.0f;
+		header.lineHeight = 24.0f;
+		header.ascent = 16.0f;
+
+		font.Initialize(loader, header, 128, 128);
+	}
+
+	// Left edge of every quad, the glyphs are 8 wide so right is 16 further at size 40.
+	void CheckLefts(const TextVertex* vertices, int quadCount, const float* lefts)
+	{
+		int i;
+
+		for (i = 0; i < quadCount; i++)
+		{
+			CHECK_NEAR(vertices[i * TEXT_QUAD_VERTICES].x, lefts[i], 1e-4f);
+			CHECK_NEAR(vertices[i * TEXT_QUAD_VERTICES + 1].x, lefts[i] + 16.0f, 1e-4f);
+		}
+	}
+
+	void TestPackColor()
+	{
+		CHECK(PackTextColor(1.0f, 0.0f, 0.0f, 1.0f) == 0xff0000ff);
+		CHECK(PackTextColor(0.0f, 1.0f, 0.0f, 0.0f) == 0x0000ff00);
+		CHECK(PackTextColor(0.0f, 0.0f, 1.0f, 0.0f) == 0x00ff0000);
+		CHECK(PackTextColor(0.5f, 0.0f, 0.0f, 0.0f) == 0x00000080);
+
+		// Channels are clamped to [0, 1].
+		CHECK(PackTextColor(-1.0f, 2.0f, 0.0f, 5.0f) == 0xff00ff00);
+	}
+
+	// The corners of a quad are top left, top right, bottom left and bottom right, with y pointing up.
+	void TestQuad()
+	{
+		TestGlyphLoader loader;
+		GlyphCache font;
+		TextVertex vertices[4 * TEXT_QUAD_VERTICES];
+		const FontGlyph* glyph;
+		unsigned int color;
+		int i;
+
+		InitializeFont(font, &loader);
+		color = PackTextColor(1.0f, 0.5f, 0.25f, 1.0f);
+
+		CHECK(LayoutText(&font, "A", 100.0f, 200.0f, 40.0f, color, vertices, 4) == 1);
+
+		// The baseline is the ascent below the top of the line, 32 at size 40, and the quad reaches 20 above it.
+		CHECK_NEAR(vertices[0].x, 102.0f, 1e-4f);
+		CHECK_NEAR(vertices[0].y, 188.0f, 1e-4f);
+		CHECK_NEAR(vertices[1].x, 118.0f, 1e-4f);
+		CHECK_NEAR(vertices[1].y, 188.0f, 1e-4f);
+		CHECK_NEAR(vertices[2].x, 102.0f, 1e-4f);
+		CHECK_NEAR(vertices[2].y, 164.0f, 1e-4f);
+		CHECK_NEAR(vertices[3].x, 118.0f, 1e-4f);
+		CHECK_NEAR(vertices[3].y, 164.0f, 1e-4f);
+
+		glyph = font.GetGlyph('A');
+		CHECK(vertices[0].u == glyph->u0 && vertices[0].v == glyph->v0);
+		CHECK(vertices[1].u == glyph->u1 && vertices[1].v == glyph->v0);
+		CHECK(vertices[2].u == glyph->u0 && vertices[2].v == glyph->v1);
+		CHECK(vertices[3].u == glyph->u1 && vertices[3].v == glyph->v1);
+
+		for (i = 0; i < TEXT_QUAD_VERTICES; i++)
+		{
+			CHECK(vertices[i].z == 0.0f);
+			CHECK(vertices[i].color == color);
+		}
+
+		font.Shutdown();
+	}
+
+	// The pen moves by the advance, kerning pairs pull glyphs together and spaces move the pen without a quad.
+	void TestPen()
+	{
+		TestGlyphLoader loader;
+		GlyphCache font;
+		TextVertex vertices[8 * TEXT_QUAD_VERTICES];
+		const float plain[3] = { 102.0f, 122.0f, 142.0f };
+		const float kerned[3] = { 102.0f, 118.0f, 138.0f };
+		const float spaced[2] = { 102.0f, 142.0f };
+
+		InitializeFont(font, &loader);
+
+		CHECK(LayoutText(&font, "ABC", 100.0f, 200.0f, 40.0f, 0, vertices, 8) == 3);
+		CheckLefts(vertices, 3, plain);
+
+		CHECK(LayoutText(&font, "AVA", 100.0f, 200.0f, 40.0f, 0, vertices, 8) == 3);
+		CheckLefts(vertices, 3, kerned);
+
+		CHECK(LayoutText(&font, "A B", 100.0f, 200.0f, 40.0f, 0, vertices, 8) == 2);
+		CheckLefts(vertices, 2, spaced);
+
+		CHECK(LayoutText(&font, "", 100.0f, 200.0f, 40.0f, 0, vertices, 8) == 0);
+
+		font.Shutdown();
+	}
+
+	// Multi byte characters are decoded, and characters the font does not have and broken UTF-8 draw the question mark.
+	void TestFallback()
+	{
+		TestGlyphLoader loader;
+		GlyphCache font;
+		TextVertex vertices[8 * TEXT_QUAD_VERTICES];
+		const FontGlyph* question;
+		const FontGlyph* acute;
+		const float lefts[4] = { 102.0f, 122.0f, 142.0f, 162.0f };
+
+		InitializeFont(font, &loader);
+
+		CHECK(LayoutText(&font, "\xc3\xa9~\xff" "A", 100.0f, 200.0f, 40.0f, 0, vertices, 8) == 4);
+		CheckLefts(vertices, 4, lefts);
+
+		acute = font.GetGlyph(0xe9);
+		question = font.GetGlyph('?');
+		CHECK(vertices[0].u == acute->u0 && vertices[0].v == acute->v0);
+		CHECK(vertices[1 * TEXT_QUAD_VERTICES].u == question->u0 && vertices[1 * TEXT_QUAD_VERTICES].v == question->v0);
+		CHECK(vertices[2 * TEXT_QUAD_VERTICES].u == question->u0 && vertices[2 * TEXT_QUAD_VERTICES].v == question->v0);
+
+		font.Shutdown();
+
+		// Without a question mark the character is skipped and does not move the pen.
+		loader.hasQuestionMark = false;
+		InitializeFont(font, &loader);
+
+		CHECK(LayoutText(&font, "A~B", 100.0f, 200.0f, 40.0f, 0, vertices, 8) == 2);
+		CheckLefts(vertices, 2, lefts);
+
+		font.Shutdown();
+	}
+
+	// Layout stops at maxQuads and leaves the vertices past them alone.
+	void TestMaxQuads()
+	{
+		TestGlyphLoader loader;
+		GlyphCache font;
+		TextVertex vertices[4 * TEXT_QUAD_VERTICES];
+
+		InitializeFont(font, &loader);
+		memset(vertices, 0, sizeof(vertices));
+
+		CHECK(LayoutText(&font, "ABCDEF", 100.0f, 200.0f, 40.0f, 0, vertices, 3) == 3);
+		CHECK(vertices[3 * TEXT_QUAD_VERTICES].x == 0.0f);
+		CHECK(LayoutText(&font, "ABCDEF", 100.0f, 200.0f, 40.0f, 0, vertices, 0) == 0);
+
+		font.Shutdown();
+	}
+
+	// Both triangles of a quad are clockwise with y pointing up and together use the four corners of their own quad.
+	void TestQuadIndices()
+	{
+		TextVertex vertices[3 * TEXT_QUAD_VERTICES];
+		unsigned short indices[3 * TEXT_QUAD_INDICES];
+		const TextVertex* a;
+		const TextVertex* b;
+		const TextVertex* c;
+		TestGlyphLoader loader;
+		GlyphCache font;
+		int quad, triangle, used, i;
+
+		InitializeFont(font, &loader);
+
+		CHECK(LayoutText(&font, "ABC", 0.0f, 0.0f, 20.0f, 0, vertices, 3) == 3);
+		BuildQuadIndices(indices, 3);
+
+		for (quad = 0; quad < 3; quad++)
+		{
+			used = 0;
+			for (i = 0; i < TEXT_QUAD_INDICES; i++)
+			{
+				CHECK(indices[quad * TEXT_QUAD_INDICES + i] / TEXT_QUAD_VERTICES == quad);
+				used |= 1 << (indices[quad * TEXT_QUAD_INDICES + i] % TEXT_QUAD_VERTICES);
+			}
+			CHECK(used == 15);
+
+			for (triangle = 0; triangle < 2; triangle++)
+			{
+				a = &vertices[indices[quad * TEXT_QUAD_INDICES + triangle * 3]];
+				b = &vertices[indices[quad * TEXT_QUAD_INDICES + triangle * 3 + 1]];
+				c = &vertices[indices[quad * TEXT_QUAD_INDICES + triangle * 3 + 2]];
+
+				// A negative cross product is clockwise.
+				CHECK((b->x - a->x) * (c->y - a->y) - (b->y - a->y) * (c->x - a->x) < 0.0f);
+			}
+		}
+
+		font.Shutdown();
+	}
+}
+
+int main()
+{
+	TestPackColor();
+	TestQuad();
+	TestPen();
+	TestFallback();
+	TestMaxQuads();
+	TestQuadIndices();
+
+	return TestResult("TextLayoutTest");
+}
@@ -0,0 +1,206 @@
+#include <string.h>
+#include <vector>
+#include "Test.h"
+#include "TransformBatch.h"
+
+namespace
+{
+	// Enough objects for a few full vectors and a remainder for the scalar path.
+	const int OBJECT_COUNT = 37;
+
+	// Largest difference per unit of scale between the matrix of a quaternion made from euler angles and the matrix
+	// XMMatrixRotationRollPitchYaw builds from the same angles.
+	const float EULER_TOLERANCE = 1e-6f;
+
+	struct Objects
+	{
+		std::vector<float> streams[10];
+		std::vector<XMFLOAT3> angles;
+		TransformStreams view;
+	};
+
+	unsigned int s_seed = 12345;
+
+	float Random(float low, float high)
+	{
+		s_seed = s_seed * 1664525u + 1013904223u;
+		return low + (high - low) * (float)(s_seed >> 8) / (float)(1u << 24);
+	}
+
+	void CreateObjects(Objects& objects)
+	{
+		XMFLOAT4 quaternion;
+		XMFLOAT3 angles;
+		int i, j;
+
+		for (j = 0; j < 10; j++)
+		{
+			objects.streams[j].resize(OBJECT_COUNT);
+		}
+		objects.angles.resize(OBJECT_COUNT);
+
+		for (i = 0; i < OBJECT_COUNT; i++)
+		{
+			angles = XMFLOAT3(Random(-XM_PI, XM_PI), Random(-XM_PI, XM_PI), Random(-XM_PI, XM_PI));
+			XMStoreFloat4(&quaternion, XMQuaternionRotationRollPitchYaw(angles.x, angles.y, angles.z));
+
+			objects.angles[i] = angles;
+			objects.streams[0][i] = Random(-100.0f, 100.0f);
+			objects.streams[1][i] = Random(-100.0f, 100.0f);
+			objects.streams[2][i] = Random(-100.0f, 100.0f);
+			objects.streams[3][i] = quaternion.x;
+			objects.streams[4][i] = quaternion.y;
+			objects.streams[5][i] = quaternion.z;
+			objects.streams[6][i] = quaternion.w;
+			objects.streams[7][i] = Random(0.5f, 4.0f);
+			objects.streams[8][i] = Random(0.5f, 4.0f);
+			objects.streams[9][i] = Random(0.5f, 4.0f);
+		}
+
+		objects.view.positionX = objects.streams[0].data();
+		objects.view.positionY = objects.streams[1].data();
+		objects.view.positionZ = objects.streams[2].data();
+		objects.view.rotationX = objects.streams[3].data();
+		objects.view.rotationY = objects.streams[4].data();
+		objects.view.rotationZ = objects.streams[5].data();
+		objects.view.rotationW = objects.streams[6].data();
+		objects.view.scaleX = objects.streams[7].data();
+		objects.view.scaleY = objects.streams[8].data();
+		objects.view.scaleZ = objects.streams[9].data();
+	}
+
+	XMMATRIX ScaleRotation(const Objects& objects, int i, CXMMATRIX rotation)
+	{
+		return XMMatrixScaling(objects.view.scaleX[i], objects.view.scaleY[i], objects.view.scaleZ[i]) * rotation *
+			XMMatrixTranslation(objects.view.positionX[i], objects.view.positionY[i], objects.view.positionZ[i]);
+	}
+
+	// The kernel has to give exactly what the DirectXMath calls it replaces give.
+	void CheckQuaternionMatrices(const Objects& objects, const XMFLOAT4X4* matrices)
+	{
+		XMFLOAT4X4 expected;
+		int i, row, column;
+
+		for (i = 0; i < OBJECT_COUNT; i++)
+		{
+			XMStoreFloat4x4(&expected, ScaleRotation(objects, i, XMMatrixRotationQuaternion(XMVectorSet(objects.view.rotationX[i],
+				objects.view.rotationY[i], objects.view.rotationZ[i], objects.view.rotationW[i]))));
+
+			for (row = 0; row < 4; row++)
+			{
+				for (column = 0; column < 4; column++)
+				{
+					CHECK(matrices[i].m[row][column] == expected.m[row][column]);
+				}
+			}
+		}
+	}
+
+	void TestWorldMatrices()
+	{
+		Objects objects;
+		XMFLOAT4X4 scalar[OBJECT_COUNT], vector[OBJECT_COUNT];
+
+		CreateObjects(objects);
+
+		SetTransformBatchVectorPath(false);
+		ComputeWorldMatrices(objects.view, 0, OBJECT_COUNT, scalar);
+		CheckQuaternionMatrices(objects, scalar);
+
+		if (!IsTransformBatchVectorPathAvailable())
+		{
+			printf("TransformBatchTest: no AVX, only the scalar path was tested\n");
+			return;
+		}
+
+		SetTransformBatchVectorPath(true);
+		ComputeWorldMatrices(objects.view, 0, OBJECT_COUNT, vector);
+		CheckQuaternionMatrices(objects, vector);
+		CHECK(memcmp(scalar, vector, sizeof(scalar)) == 0);
+
+		// A range that starts in the middle of the streams.
+		ComputeWorldMatrices(objects.view, 5, 16, vector);
+		CHECK(memcmp(scalar + 5, vector, sizeof(XMFLOAT4X4) * 16) == 0);
+	}
+
+	// The hierarchy stores euler angles as a quaternion, so its matrices are close to but not exactly the euler ones.
+	void TestEulerTolerance()
+	{
+		Objects objects;
+		XMFLOAT4X4 matrices[OBJECT_COUNT], expected;
+		float scale[4];
+		int i, row, column;
+
+		CreateObjects(objects);
+
+		SetTransformBatchVectorPath(true);
+		ComputeWorldMatrices(objects.view, 0, OBJECT_COUNT, matrices);
+
+		for (i = 0; i < OBJECT_COUNT; i++)
+		{
+			XMStoreFloat4x4(&expected, ScaleRotation(objects, i, XMMatrixRotationRollPitchYaw(objects.angles[i].x,
+				objects.angles[i].y, objects.angles[i].z)));
+
+			scale[0] = objects.view.scaleX[i];
+			scale[1] = objects.view.scaleY[i];
+			scale[2] = objects.view.scaleZ[i];
+			scale[3] = 0.0f;
+
+			for (row = 0; row < 4; row++)
+			{
+				for (column = 0; column < 4; column++)
+				{
+					CHECK_NEAR(matrices[i].m[row][column], expected.m[row][column], EULER_TOLERANCE * scale[row]);
+				}
+			}
+		}
+	}
+
+	void TestWorldViewProjectionMatrices()
+	{
+		Objects objects;
+		XMFLOAT4X4 world[OBJECT_COUNT], scalar[OBJECT_COUNT], vector[OBJECT_COUNT], expected;
+		XMMATRIX viewProjection;
+		int i, row, column;
+
+		CreateObjects(objects);
+		ComputeWorldMatrices(objects.view, 0, OBJECT_COUNT, world);
+
+		viewProjection = XMMatrixLookAtLH(XMVectorSet(3.0f, 4.0f, -10.0f, 1.0f), XMVectorSet(0.0f, 0.0f, 0.0f, 1.0f),
+			XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f)) * XMMatrixPerspectiveFovLH(XM_PIDIV4, 16.0f / 9.0f, 0.1f, 1000.0f);
+
+		SetTransformBatchVectorPath(false);
+		ComputeWorldViewProjectionMatrices(world, OBJECT_COUNT, viewProjection, scalar);
+
+		for (i = 0; i < OBJECT_COUNT; i++)
+		{
+			XMStoreFloat4x4(&expected, XMMatrixMultiply(XMLoadFloat4x4(&world[i]), viewProjection));
+
+			for (row = 0; row < 4; row++)
+			{
+				for (column = 0; column < 4; column++)
+				{
+					CHECK(scalar[i].m[row][column] == expected.m[row][column]);
+				}
+			}
+		}
+
+		if (!IsTransformBatchVectorPathAvailable())
+		{
+			return;
+		}
+
+		SetTransformBatchVectorPath(true);
+		ComputeWorldViewProjectionMatrices(world, OBJECT_COUNT, viewProjection, vector);
+		CHECK(memcmp(scalar, vector, sizeof(scalar)) == 0);
+	}
+}
+
+int main()
+{
+	TestWorldMatrices();
+	TestEulerTolerance();
+	TestWorldViewProjectionMatrices();
+
+	return TestResult("TransformBatchTest");
+}
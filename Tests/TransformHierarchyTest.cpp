@@ -0,0 +1,174 @@
+#include "Test.h"
+#include "TransformHierarchy.h"
+
+namespace
+{
+	// The batch kernel builds the rotation from a quaternion, which is a few ulps off the euler matrix.
+	const float MATRIX_TOLERANCE = 1e-5f;
+
+	XMMATRIX LocalMatrix(float positionX, float rotationY, float scale)
+	{
+		return XMMatrixScaling(scale, scale, scale) * XMMatrixRotationRollPitchYaw(0.0f, rotationY, 0.0f) *
+			XMMatrixTranslation(positionX, 0.0f, 0.0f);
+	}
+
+	void CheckMatrix(const XMMATRIX& matrix, const XMMATRIX& expected)
+	{
+		XMFLOAT4X4 a, b;
+		int row, column;
+
+		XMStoreFloat4x4(&a, matrix);
+		XMStoreFloat4x4(&b, expected);
+
+		for (row = 0; row < 4; row++)
+		{
+			for (column = 0; column < 4; column++)
+			{
+				CHECK_NEAR(a.m[row][column], b.m[row][column], MATRIX_TOLERANCE);
+			}
+		}
+	}
+
+	// root - a - a0
+	//      |   - a1
+	//      - b - b0
+	void TestDirtySubtrees()
+	{
+		TransformHierarchy hierarchy;
+		int root, a, a0, a1, b, b0;
+
+		CHECK(hierarchy.Initialize(16));
+
+		root = hierarchy.CreateNode(-1);
+		a = hierarchy.CreateNode(root);
+		b = hierarchy.CreateNode(root);
+		a0 = hierarchy.CreateNode(a);
+		a1 = hierarchy.CreateNode(a);
+		b0 = hierarchy.CreateNode(b);
+
+		hierarchy.SetPosition(root, 1.0f, 0.0f, 0.0f);
+		hierarchy.SetPosition(a, 2.0f, 0.0f, 0.0f);
+		hierarchy.SetRotation(a, 0.0f, 0.5f, 0.0f);
+		hierarchy.SetScale(a0, 2.0f, 2.0f, 2.0f);
+		hierarchy.SetPosition(a0, 3.0f, 0.0f, 0.0f);
+		hierarchy.SetPosition(b0, 4.0f, 0.0f, 0.0f);
+
+		// Everything is new, so everything is updated once.
+		hierarchy.Update();
+		CHECK(hierarchy.GetUpdatedCount() == 6);
+		CheckMatrix(hierarchy.GetWorldMatrix(a0), LocalMatrix(3.0f, 0.0f, 2.0f) * LocalMatrix(2.0f, 0.5f, 1.0f) * LocalMatrix(1.0f, 0.0f, 1.0f));
+
+		// Nothing moved.
+		hierarchy.Update();
+		CHECK(hierarchy.GetUpdatedCount() == 0);
+
+		// A leaf only updates itself.
+		hierarchy.SetPosition(b0, 5.0f, 0.0f, 0.0f);
+		hierarchy.Update();
+		CHECK(hierarchy.GetUpdatedCount() == 1);
+		CheckMatrix(hierarchy.GetWorldMatrix(b0), LocalMatrix(5.0f, 0.0f, 1.0f) * LocalMatrix(1.0f, 0.0f, 1.0f));
+
+		// A parent updates its subtree and nothing else, also when a child in it changed too.
+		hierarchy.SetRotation(a, 0.0f, 1.0f, 0.0f);
+		hierarchy.SetPosition(a1, 6.0f, 0.0f, 0.0f);
+		hierarchy.Update();
+		CHECK(hierarchy.GetUpdatedCount() == 3);
+		CheckMatrix(hierarchy.GetWorldMatrix(a1), LocalMatrix(6.0f, 0.0f, 1.0f) * LocalMatrix(2.0f, 1.0f, 1.0f) * LocalMatrix(1.0f, 0.0f, 1.0f));
+		CheckMatrix(hierarchy.GetWorldMatrix(b0), LocalMatrix(5.0f, 0.0f, 1.0f) * LocalMatrix(1.0f, 0.0f, 1.0f));
+
+		// The root moves everything.
+		hierarchy.SetPosition(root, -1.0f, 0.0f, 0.0f);
+		hierarchy.Update();
+		CHECK(hierarchy.GetUpdatedCount() == 6);
+		CheckMatrix(hierarchy.GetWorldMatrix(a0), LocalMatrix(3.0f, 0.0f, 2.0f) * LocalMatrix(2.0f, 1.0f, 1.0f) * LocalMatrix(-1.0f, 0.0f, 1.0f));
+
+		hierarchy.Shutdown();
+	}
+
+	// Nodes added under an old parent after deeper ones break the breadth first order, the handles have to survive
+	// the sort that restores it.
+	void TestOutOfOrderCreation()
+	{
+		TransformHierarchy hierarchy;
+		int root, child, grandChild, late, lateChild;
+
+		CHECK(hierarchy.Initialize(8));
+
+		root = hierarchy.CreateNode(-1);
+		child = hierarchy.CreateNode(root);
+		grandChild = hierarchy.CreateNode(child);
+		late = hierarchy.CreateNode(root);
+		lateChild = hierarchy.CreateNode(late);
+
+		hierarchy.SetPosition(root, 1.0f, 0.0f, 0.0f);
+		hierarchy.SetPosition(grandChild, 2.0f, 0.0f, 0.0f);
+		hierarchy.SetPosition(late, 3.0f, 0.0f, 0.0f);
+		hierarchy.SetRotation(late, 0.0f, 0.25f, 0.0f);
+		hierarchy.SetPosition(lateChild, 4.0f, 0.0f, 0.0f);
+		hierarchy.Update();
+
+		CheckMatrix(hierarchy.GetWorldMatrix(grandChild), LocalMatrix(3.0f, 0.0f, 1.0f));
+		CheckMatrix(hierarchy.GetWorldMatrix(lateChild), LocalMatrix(4.0f, 0.0f, 1.0f) * LocalMatrix(3.0f, 0.25f, 1.0f) * LocalMatrix(1.0f, 0.0f, 1.0f));
+
+		// The children lists were moved along with the slots.
+		hierarchy.SetPosition(late, 5.0f, 0.0f, 0.0f);
+		hierarchy.Update();
+		CHECK(hierarchy.GetUpdatedCount() == 2);
+		CheckMatrix(hierarchy.GetWorldMatrix(lateChild), LocalMatrix(4.0f, 0.0f, 1.0f) * LocalMatrix(5.0f, 0.25f, 1.0f) * LocalMatrix(1.0f, 0.0f, 1.0f));
+
+		hierarchy.Shutdown();
+	}
+
+	// Enough changed nodes for several jobs, with gaps so the kernel gets runs of different lengths.
+	void TestManyNodes()
+	{
+		TransformHierarchy hierarchy;
+		int nodes[4 * TRANSFORM_JOB_GRAIN];
+		int i, count, changed;
+
+		count = 4 * TRANSFORM_JOB_GRAIN;
+		CHECK(hierarchy.Initialize(count));
+
+		for (i = 0; i < count; i++)
+		{
+			nodes[i] = hierarchy.CreateNode(i > 0 ? nodes[(i - 1) / 4] : -1);
+			hierarchy.SetPosition(nodes[i], 1.0f, 0.0f, 0.0f);
+		}
+		hierarchy.Update();
+		CHECK(hierarchy.GetUpdatedCount() == count);
+
+		// Only leaves, every one of them updates itself alone.
+		changed = 0;
+		for (i = count / 2; i < count; i++)
+		{
+			if (i % 3 != 0)
+			{
+				hierarchy.SetRotation(nodes[i], 0.0f, (float)i * 0.01f, 0.0f);
+				changed++;
+			}
+		}
+		hierarchy.Update();
+		CHECK(hierarchy.GetUpdatedCount() == changed);
+
+		for (i = count / 2; i < count; i += 97)
+		{
+			CheckMatrix(hierarchy.GetWorldMatrix(nodes[i]), LocalMatrix(1.0f, (i % 3 != 0) ? (float)i * 0.01f : 0.0f, 1.0f) *
+				hierarchy.GetWorldMatrix(nodes[(i - 1) / 4]));
+		}
+
+		hierarchy.Shutdown();
+	}
+}
+
+int main()
+{
+	JobSystem::Initialize(2);
+
+	TestDirtySubtrees();
+	TestOutOfOrderCreation();
+	TestManyNodes();
+
+	JobSystem::Shutdown();
+
+	return TestResult("TransformHierarchyTest");
+}
@@ -0,0 +1,118 @@
+#include <thread>
+#include <vector>
+#include "Test.h"
+#include "TripleBuffer.h"
+
+namespace
+{
+	const int PUBLISHES = 200000;
+	const int PAYLOAD = 64;
+
+	// A value large enough that a torn read shows up as a payload that does not match its sequence.
+	struct Value
+	{
+		int sequence;
+		int payload[PAYLOAD];
+	};
+
+	void Produce(TripleBuffer<Value>* buffer)
+	{
+		int sequence, i;
+
+		for (sequence = 1; sequence <= PUBLISHES; sequence++)
+		{
+			Value& value = buffer->GetWriteBuffer();
+
+			value.sequence = sequence;
+			for (i = 0; i < PAYLOAD; i++)
+			{
+				value.payload[i] = sequence * PAYLOAD + i;
+			}
+
+			buffer->Publish();
+		}
+	}
+
+	// On one thread the consumer sees exactly the newest value and nothing twice.
+	void TestSingleThread()
+	{
+		TripleBuffer<int> buffer;
+
+		CHECK(!buffer.Acquire());
+
+		buffer.GetWriteBuffer() = 1;
+		buffer.Publish();
+		CHECK(buffer.Acquire());
+		CHECK(buffer.GetReadBuffer() == 1);
+		CHECK(!buffer.Acquire());
+		CHECK(buffer.GetReadBuffer() == 1);
+
+		// Values the consumer did not take in time are skipped.
+		buffer.GetWriteBuffer() = 2;
+		buffer.Publish();
+		buffer.GetWriteBuffer() = 3;
+		buffer.Publish();
+		CHECK(buffer.Acquire());
+		CHECK(buffer.GetReadBuffer() == 3);
+
+		// The producer never gets the slot the consumer reads.
+		buffer.GetWriteBuffer() = 4;
+		CHECK(buffer.GetReadBuffer() == 3);
+		buffer.Publish();
+		buffer.GetWriteBuffer() = 5;
+		CHECK(buffer.GetReadBuffer() == 3);
+	}
+
+	// A producer and a consumer hammer the buffer. Every value read has to be whole and newer than the one before.
+	// Built with DARKSTAR_TSAN this is the test ThreadSanitizer checks the memory orders of the buffer with.
+	void TestThreads()
+	{
+		TripleBuffer<Value>* buffer;
+		std::thread producer;
+		int last, taken, torn, backwards, i;
+
+		buffer = new TripleBuffer<Value>;
+
+		producer = std::thread(Produce, buffer);
+
+		last = 0;
+		taken = 0;
+		torn = 0;
+		backwards = 0;
+		while (last < PUBLISHES)
+		{
+			if (!buffer->Acquire())
+			{
+				std::this_thread::yield();
+				continue;
+			}
+
+			const Value& value = buffer->GetReadBuffer();
+
+			for (i = 0; i < PAYLOAD; i++)
+			{
+				torn += value.payload[i] != value.sequence * PAYLOAD + i ? 1 : 0;
+			}
+
+			backwards += value.sequence <= last ? 1 : 0;
+			last = value.sequence;
+			taken++;
+		}
+
+		producer.join();
+
+		CHECK(torn == 0);
+		CHECK(backwards == 0);
+		CHECK(taken > 0);
+
+		delete buffer;
+	}
+}
+
+int main()
+{
+	TestSingleThread();
+	TestThreads();
+
+	return TestResult("TripleBufferTest");
+}